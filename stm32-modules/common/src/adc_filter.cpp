@@ -0,0 +1,47 @@
+#include "core/adc_filter.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+AdcFilter::AdcFilter(Mode mode, double iir_alpha)
+    : _mode(mode), _alpha(std::clamp(iir_alpha, 0.0, 1.0)) {}
+
+auto AdcFilter::update(uint16_t reading) -> uint16_t {
+    switch (_mode) {
+        case Mode::MEDIAN:
+            _window.at(_window_next) = reading;
+            _window_next = (_window_next + 1) % MEDIAN_WINDOW;
+            _window_count = std::min(_window_count + 1, MEDIAN_WINDOW);
+            return median();
+        case Mode::IIR:
+            if (!_iir_started) {
+                _iir_started = true;
+                _iir_value = reading;
+            } else {
+                _iir_value += _alpha * (reading - _iir_value);
+            }
+            return static_cast<uint16_t>(std::lround(_iir_value));
+        case Mode::NONE:
+        default:
+            return reading;
+    }
+}
+
+auto AdcFilter::reset() -> void {
+    _window_count = 0;
+    _window_next = 0;
+    _iir_started = false;
+}
+
+auto AdcFilter::median() const -> uint16_t {
+    // The window is tiny, so a plain insertion sort does
+    auto sorted = _window;
+    for (size_t i = 1; i < _window_count; ++i) {
+        for (size_t j = i; (j > 0) && (sorted.at(j - 1) > sorted.at(j)); --j) {
+            std::swap(sorted.at(j - 1), sorted.at(j));
+        }
+    }
+    // With an even count (only while the window fills) take the lower one
+    return sorted.at((_window_count - 1) / 2);
+}
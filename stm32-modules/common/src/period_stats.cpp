@@ -0,0 +1,60 @@
+#include "core/period_stats.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+PeriodStats::PeriodStats(uint32_t nominal_us) : _nominal_us(nominal_us) {}
+
+auto PeriodStats::add(uint32_t timestamp_us) -> void {
+    if (!_started) {
+        _started = true;
+        _last_us = timestamp_us;
+        return;
+    }
+    // Unsigned subtraction takes care of the counter wrapping
+    const uint32_t interval = timestamp_us - _last_us;
+    _last_us = timestamp_us;
+    ++_count;
+    if (_count == 1) {
+        _min_us = interval;
+        _max_us = interval;
+    } else {
+        _min_us = std::min(_min_us, interval);
+        _max_us = std::max(_max_us, interval);
+    }
+    const double delta = static_cast<double>(interval) - _mean_us;
+    _mean_us += delta / static_cast<double>(_count);
+    _m2 += delta * (static_cast<double>(interval) - _mean_us);
+}
+
+auto PeriodStats::reset() -> void {
+    _count = 0;
+    _mean_us = 0;
+    _m2 = 0;
+    _min_us = 0;
+    _max_us = 0;
+}
+
+auto PeriodStats::count() const -> uint32_t { return _count; }
+
+auto PeriodStats::mean_us() const -> double { return _mean_us; }
+
+auto PeriodStats::stddev_us() const -> double {
+    if (_count < 2) {
+        return 0;
+    }
+    return std::sqrt(_m2 / static_cast<double>(_count - 1));
+}
+
+auto PeriodStats::min_us() const -> uint32_t { return _min_us; }
+
+auto PeriodStats::max_us() const -> uint32_t { return _max_us; }
+
+auto PeriodStats::peak_jitter_us() const -> uint32_t {
+    if (_count == 0) {
+        return 0;
+    }
+    const uint32_t late = (_max_us > _nominal_us) ? _max_us - _nominal_us : 0;
+    const uint32_t early = (_min_us < _nominal_us) ? _nominal_us - _min_us : 0;
+    return std::max(late, early);
+}
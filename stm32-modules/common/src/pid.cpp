@@ -63,3 +63,9 @@ auto PID::arm_integrator_reset(double error) -> void {
         _reset_trigger = FALLING;
     }
 }
+
+auto PID::set_windup_limits(double windup_limit_high, double windup_limit_low)
+    -> void {
+    _windup_limit_high = windup_limit_high;
+    _windup_limit_low = windup_limit_low;
+}
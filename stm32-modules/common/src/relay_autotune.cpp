@@ -0,0 +1,119 @@
+#include "core/relay_autotune.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+// Tyreus-Luyben tuning rule constants
+static constexpr double TL_GAIN_DIVISOR = 2.2;
+static constexpr double TL_INTEGRAL_PERIOD_RATIO = 2.2;
+static constexpr double TL_DERIVATIVE_PERIOD_DIVISOR = 6.3;
+
+RelayAutotune::RelayAutotune(double setpoint, double output_high,
+                             double output_low, double hysteresis,
+                             double sampletime, uint8_t cycles,
+                             double timeout_s)
+    : _setpoint(setpoint),
+      _output_high(output_high),
+      _output_low(output_low),
+      _hysteresis(hysteresis),
+      _sampletime(sampletime),
+      _cycles(std::max(cycles, static_cast<uint8_t>(1))),
+      _timeout_s(timeout_s) {}
+
+auto RelayAutotune::update(double input) -> double {
+    if (_status != Status::RUNNING) {
+        return output();
+    }
+    _elapsed_s += _sampletime;
+    _cycle_max = std::max(_cycle_max, input);
+    _cycle_min = std::min(_cycle_min, input);
+
+    if (_relay_high && (input > _setpoint + _hysteresis)) {
+        // The high->low switch is the boundary between cycles
+        _relay_high = false;
+        finish_cycle();
+        _cycle_max = input;
+        _cycle_min = input;
+    } else if (!_relay_high && (input < _setpoint - _hysteresis)) {
+        _relay_high = true;
+    }
+
+    if ((_status == Status::RUNNING) && (_elapsed_s > _timeout_s)) {
+        _status = Status::FAILED;
+    }
+    return output();
+}
+
+auto RelayAutotune::finish_cycle() -> void {
+    // Nothing before the first overshoot is a cycle
+    if (_last_switch_s >= 0) {
+        // The first full cycle swings further than the limit cycle, since
+        // its undershoot answers the overshoot of the approach, so it's
+        // counted but not averaged
+        if (_cycles_completed > 0) {
+            _period_sum += _elapsed_s - _last_switch_s;
+            _amplitude_sum += (_cycle_max - _cycle_min) / 2.0;
+        }
+        ++_cycles_completed;
+        if (_cycles_completed > _cycles) {
+            _status = (ultimate_gain() > 0) ? Status::DONE : Status::FAILED;
+        }
+    }
+    _last_switch_s = _elapsed_s;
+}
+
+auto RelayAutotune::status() const -> Status { return _status; }
+
+auto RelayAutotune::setpoint() const -> double { return _setpoint; }
+
+auto RelayAutotune::output() const -> double {
+    if (_status != Status::RUNNING) {
+        return 0.0;
+    }
+    return _relay_high ? _output_high : _output_low;
+}
+
+auto RelayAutotune::cycles_completed() const -> uint8_t {
+    return _cycles_completed;
+}
+
+auto RelayAutotune::ultimate_gain() const -> double {
+    if ((_cycles_completed <= 1) || (_amplitude_sum <= 0)) {
+        return 0.0;
+    }
+    // Describing function of a relay with hysteresis: the oscillation
+    // amplitude seen by the relay is reduced by the deadband
+    const double amplitude = _amplitude_sum / (_cycles_completed - 1);
+    const double effective_sq =
+        amplitude * amplitude - _hysteresis * _hysteresis;
+    if (effective_sq <= 0) {
+        return 0.0;
+    }
+    const double relay_amplitude = (_output_high - _output_low) / 2.0;
+    return (4.0 * relay_amplitude) /
+           (std::numbers::pi * std::sqrt(effective_sq));
+}
+
+auto RelayAutotune::ultimate_period() const -> double {
+    if (_cycles_completed <= 1) {
+        return 0.0;
+    }
+    return _period_sum / (_cycles_completed - 1);
+}
+
+auto RelayAutotune::kp() const -> double {
+    return ultimate_gain() / TL_GAIN_DIVISOR;
+}
+
+auto RelayAutotune::ki() const -> double {
+    const double period = ultimate_period();
+    if (period <= 0) {
+        return 0.0;
+    }
+    return kp() / (TL_INTEGRAL_PERIOD_RATIO * period);
+}
+
+auto RelayAutotune::kd() const -> double {
+    return kp() * ultimate_period() / TL_DERIVATIVE_PERIOD_DIVISOR;
+}
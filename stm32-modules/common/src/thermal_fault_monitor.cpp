@@ -0,0 +1,101 @@
+#include "core/thermal_fault_monitor.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+ThermalFaultMonitor::ThermalFaultMonitor(const Limits& limits,
+                                         double sampletime)
+    : _limits(limits), _sampletime(sampletime) {}
+
+auto ThermalFaultMonitor::update(double temp_c, double target_c,
+                                 double output) -> Fault {
+    return update(temp_c, target_c, output, output);
+}
+
+auto ThermalFaultMonitor::update(double temp_c, double target_c,
+                                 double output, double coupled_output)
+    -> Fault {
+    if (_fault != Fault::NONE) {
+        return _fault;
+    }
+    int8_t drive = 0;
+    if ((output >= _limits.drive_threshold) &&
+        (target_c - temp_c > _limits.target_band_c)) {
+        drive = 1;
+    } else if ((output <= -_limits.drive_threshold) &&
+               (temp_c - target_c > _limits.target_band_c)) {
+        drive = -1;
+    }
+    check_response(temp_c, drive);
+    if (_fault == Fault::NONE) {
+        check_runaway(temp_c, std::max(output, coupled_output));
+    }
+    return _fault;
+}
+
+auto ThermalFaultMonitor::check_response(double temp_c, int8_t drive) -> void {
+    if (drive != _drive) {
+        // Each time the element is newly driven it has one window to show
+        // that it is following the output
+        _drive = drive;
+        _responded = (drive == 0);
+        _response_start_c = temp_c;
+        _response_elapsed_s = 0;
+        return;
+    }
+    if (_responded) {
+        return;
+    }
+    _response_elapsed_s += _sampletime;
+    if ((temp_c - _response_start_c) * drive >= _limits.min_response_c) {
+        // Once it has moved, staying saturated (e.g. at a setpoint the
+        // element can't quite reach) is not a fault
+        _responded = true;
+    } else if (_response_elapsed_s >= _limits.window_s) {
+        _fault = Fault::NO_RESPONSE;
+    }
+}
+
+auto ThermalFaultMonitor::check_runaway(double temp_c, double output) -> void {
+    if (output > 0) {
+        _undriven_elapsed_s = -1;
+        return;
+    }
+    if (_undriven_elapsed_s < 0) {
+        _undriven_elapsed_s = 0;
+    } else {
+        _undriven_elapsed_s += _sampletime;
+    }
+    if (_undriven_elapsed_s <= _limits.window_s) {
+        // Still coasting on heat that was already in the element
+        _runaway_start_c = temp_c;
+        _runaway_window_s = 0;
+        return;
+    }
+    _runaway_window_s += _sampletime;
+    _runaway_start_c = std::min(_runaway_start_c, temp_c);
+    if (temp_c - _runaway_start_c > _limits.max_undriven_rise_c) {
+        _fault = Fault::RUNAWAY;
+    } else if (_runaway_window_s >= _limits.window_s) {
+        _runaway_start_c = temp_c;
+        _runaway_window_s = 0;
+    }
+}
+
+auto ThermalFaultMonitor::reset() -> void {
+    _fault = Fault::NONE;
+    _drive = 0;
+    _responded = true;
+    _response_start_c = 0;
+    _response_elapsed_s = 0;
+    _undriven_elapsed_s = -1;
+    _runaway_start_c = 0;
+    _runaway_window_s = 0;
+}
+
+auto ThermalFaultMonitor::fault() const -> Fault { return _fault; }
+
+auto ThermalFaultMonitor::pair_plausible(double a_c, double b_c,
+                                         double max_delta_c) -> bool {
+    return std::abs(a_c - b_c) <= max_delta_c;
+}
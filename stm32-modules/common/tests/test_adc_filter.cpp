@@ -0,0 +1,84 @@
+#include <cstdint>
+#include <vector>
+
+#include "catch2/catch.hpp"
+#include "core/adc_filter.hpp"
+
+SCENARIO("adc filter") {
+    GIVEN("a pass-through filter") {
+        auto filter = AdcFilter(AdcFilter::Mode::NONE, 0.5);
+        THEN("readings come out untouched") {
+            REQUIRE(filter.update(100) == 100);
+            REQUIRE(filter.update(5000) == 5000);
+            REQUIRE(filter.update(7) == 7);
+        }
+    }
+    GIVEN("a median filter") {
+        auto filter = AdcFilter(AdcFilter::Mode::MEDIAN, 0.5);
+        WHEN("a single reading spikes") {
+            std::vector<uint16_t> out;
+            for (uint16_t reading : {1000, 1002, 9000, 1001, 999}) {
+                out.push_back(filter.update(reading));
+            }
+            THEN("the spike is removed") {
+                for (auto value : out) {
+                    REQUIRE(value >= 999);
+                    REQUIRE(value <= 1002);
+                }
+            }
+        }
+        WHEN("the reading steps") {
+            std::vector<uint16_t> out;
+            for (uint16_t reading : {1000, 1000, 1000, 2000, 2000, 2000}) {
+                out.push_back(filter.update(reading));
+            }
+            THEN("the step comes through one reading late") {
+                REQUIRE(out.at(3) == 1000);
+                REQUIRE(out.at(4) == 2000);
+                REQUIRE(out.at(5) == 2000);
+            }
+        }
+        WHEN("the filter is reset") {
+            filter.update(1000);
+            filter.update(1000);
+            filter.reset();
+            THEN("the next reading comes straight through") {
+                REQUIRE(filter.update(3000) == 3000);
+            }
+        }
+    }
+    GIVEN("an IIR filter") {
+        constexpr double alpha = 0.25;
+        auto filter = AdcFilter(AdcFilter::Mode::IIR, alpha);
+        THEN("the first reading sets the output") {
+            REQUIRE(filter.update(1000) == 1000);
+            AND_WHEN("the reading steps") {
+                auto first = filter.update(2000);
+                THEN("the output moves by alpha of the step") {
+                    REQUIRE(first == 1250);
+                }
+                AND_WHEN("the step persists") {
+                    uint16_t out = first;
+                    for (int i = 0; i < 50; ++i) {
+                        out = filter.update(2000);
+                    }
+                    THEN("the output settles on it") { REQUIRE(out == 2000); }
+                }
+            }
+        }
+        WHEN("the readings are noisy") {
+            uint16_t low = UINT16_MAX;
+            uint16_t high = 0;
+            for (int i = 0; i < 100; ++i) {
+                auto out = filter.update((i % 2 == 0) ? 900 : 1100);
+                if (i > 20) {
+                    low = std::min(low, out);
+                    high = std::max(high, out);
+                }
+            }
+            THEN("the output swings much less than the input") {
+                REQUIRE(high - low < 100);
+            }
+        }
+    }
+}
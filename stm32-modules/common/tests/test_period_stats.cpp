@@ -0,0 +1,79 @@
+#include <array>
+#include <cstdint>
+
+#include "catch2/catch.hpp"
+#include "core/period_stats.hpp"
+
+SCENARIO("period stats") {
+    constexpr uint32_t nominal = 50000;
+    auto stats = PeriodStats(nominal);
+    GIVEN("no events") {
+        THEN("everything reads zero") {
+            REQUIRE(stats.count() == 0);
+            REQUIRE(stats.mean_us() == 0);
+            REQUIRE(stats.stddev_us() == 0);
+            REQUIRE(stats.peak_jitter_us() == 0);
+        }
+    }
+    GIVEN("a single event") {
+        stats.add(1000);
+        THEN("no interval has been recorded yet") {
+            REQUIRE(stats.count() == 0);
+        }
+    }
+    GIVEN("events exactly on the nominal period") {
+        uint32_t now = 1000;
+        for (int i = 0; i < 10; ++i) {
+            stats.add(now);
+            now += nominal;
+        }
+        THEN("there is no jitter") {
+            REQUIRE(stats.count() == 9);
+            REQUIRE(stats.mean_us() == nominal);
+            REQUIRE(stats.stddev_us() == 0);
+            REQUIRE(stats.min_us() == nominal);
+            REQUIRE(stats.max_us() == nominal);
+            REQUIRE(stats.peak_jitter_us() == 0);
+        }
+    }
+    GIVEN("events that arrive early and late") {
+        constexpr std::array<uint32_t, 4> intervals{49000, 51000, 50500,
+                                                    49500};
+        uint32_t now = 0;
+        stats.add(now);
+        for (auto interval : intervals) {
+            now += interval;
+            stats.add(now);
+        }
+        THEN("the statistics describe the intervals") {
+            REQUIRE(stats.count() == intervals.size());
+            REQUIRE_THAT(stats.mean_us(),
+                         Catch::Matchers::WithinAbs(nominal, 0.01));
+            // Sample standard deviation of +-1000, +-500
+            REQUIRE_THAT(stats.stddev_us(),
+                         Catch::Matchers::WithinAbs(912.87, 0.01));
+            REQUIRE(stats.min_us() == 49000);
+            REQUIRE(stats.max_us() == 51000);
+            REQUIRE(stats.peak_jitter_us() == 1000);
+        }
+        WHEN("the stats are reset") {
+            stats.reset();
+            stats.add(now + nominal + 200);
+            THEN("only intervals after the reset count") {
+                REQUIRE(stats.count() == 1);
+                REQUIRE(stats.mean_us() == nominal + 200);
+                REQUIRE(stats.peak_jitter_us() == 200);
+            }
+        }
+    }
+    GIVEN("a timestamp counter that wraps between events") {
+        constexpr uint32_t before_wrap = UINT32_MAX - 10000;
+        stats.add(before_wrap);
+        stats.add(before_wrap + nominal);
+        THEN("the interval is still the nominal period") {
+            REQUIRE(stats.count() == 1);
+            REQUIRE(stats.min_us() == nominal);
+            REQUIRE(stats.peak_jitter_us() == 0);
+        }
+    }
+}
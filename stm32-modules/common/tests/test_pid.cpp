@@ -190,6 +190,22 @@ SCENARIO("PID controller") {
             }
         }
 
+        WHEN("narrowing the windup limits partway through") {
+            std::vector<float> results(8);
+            for (size_t i = 0; i < results.size(); ++i) {
+                if (i == 4) {
+                    p.set_windup_limits(10, -12);
+                }
+                results[i] = p.compute(3);
+            }
+            THEN("the result should clip at the new bound from then on") {
+                std::vector<float> intended = {6, 12, 16, 16, 10, 10, 10, 10};
+                REQUIRE_THAT(results, Catch::Matchers::Equals(intended));
+                REQUIRE(p.windup_limit_high() == 10);
+                REQUIRE(p.windup_limit_low() == -12);
+            }
+        }
+
         WHEN("alternating input signs") {
             std::vector<float> results(6);
             std::vector<float> inputs = {5, 10, -8, -5, -2, 6};
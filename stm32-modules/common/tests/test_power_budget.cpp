@@ -0,0 +1,85 @@
+#include "catch2/catch.hpp"
+#include "core/power_budget.hpp"
+
+SCENARIO("power budget allocation") {
+    GIVEN("a 100W budget shared by a 60W and an 80W consumer") {
+        auto budget = PowerBudget<2>(100, {60, 80});
+        WHEN("nothing is drawing power") {
+            THEN("both consumers may use full output") {
+                REQUIRE(budget.ceiling(0) == 1.0);
+                REQUIRE(budget.ceiling(1) == 1.0);
+                REQUIRE(budget.demand(0) == 0.0);
+            }
+        }
+        WHEN("the first consumer draws full power") {
+            budget.set_demand(0, 1.0);
+            THEN("the second gets what is left") {
+                REQUIRE(budget.ceiling(0) == 1.0);
+                REQUIRE_THAT(budget.ceiling(1),
+                             Catch::Matchers::WithinAbs(0.5, 0.001));
+            }
+            AND_WHEN("the first consumer backs off") {
+                budget.set_demand(0, 0.25);
+                THEN("the second gets more room") {
+                    REQUIRE_THAT(budget.ceiling(1),
+                                 Catch::Matchers::WithinAbs(1.0, 0.001));
+                }
+            }
+        }
+        WHEN("the second consumer draws full power") {
+            budget.set_demand(1, 1.0);
+            THEN("the first consumer is not limited by it") {
+                REQUIRE(budget.ceiling(0) == 1.0);
+            }
+        }
+        WHEN("a consumer publishes a negative or too-large demand") {
+            budget.set_demand(0, -0.5);
+            THEN("the magnitude is used") {
+                REQUIRE_THAT(budget.demand(0),
+                             Catch::Matchers::WithinAbs(0.5, 0.001));
+                REQUIRE_THAT(budget.ceiling(1),
+                             Catch::Matchers::WithinAbs(70.0 / 80.0, 0.001));
+            }
+            AND_WHEN("publishing more than full output") {
+                budget.set_demand(0, 3.0);
+                THEN("the demand is capped at full output") {
+                    REQUIRE(budget.demand(0) == 1.0);
+                }
+            }
+        }
+    }
+    GIVEN("a budget smaller than its first consumer") {
+        auto budget = PowerBudget<3>(50, {60, 20, 20});
+        WHEN("the first consumer draws full power") {
+            budget.set_demand(0, 1.0);
+            THEN("it is still capped by the supply") {
+                REQUIRE_THAT(budget.ceiling(0),
+                             Catch::Matchers::WithinAbs(50.0 / 60.0, 0.001));
+            }
+            THEN("the others get nothing") {
+                REQUIRE(budget.ceiling(1) == 0.0);
+                REQUIRE(budget.ceiling(2) == 0.0);
+            }
+        }
+    }
+    GIVEN("a budget built without a supply figure") {
+        auto budget = PowerBudget<2>({60, 80});
+        WHEN("both consumers draw full power") {
+            budget.set_demand(0, 1.0);
+            budget.set_demand(1, 1.0);
+            THEN("neither is limited") {
+                REQUIRE(budget.ceiling(0) == 1.0);
+                REQUIRE(budget.ceiling(1) == 1.0);
+                REQUIRE(budget.demand(1) == 1.0);
+            }
+        }
+        WHEN("a supply figure is applied later") {
+            budget.set_supply(100);
+            budget.set_demand(0, 1.0);
+            THEN("the second consumer gets what is left") {
+                REQUIRE_THAT(budget.ceiling(1),
+                             Catch::Matchers::WithinAbs(0.5, 0.001));
+            }
+        }
+    }
+}
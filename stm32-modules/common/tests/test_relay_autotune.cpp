@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <deque>
+
+#include "catch2/catch.hpp"
+#include "core/pid.hpp"
+#include "core/relay_autotune.hpp"
+
+/**
+ * First order plus dead time heater: the temperature approaches
+ * ambient + gain * output with the given time constant, and output changes
+ * only show up after the dead time has elapsed.
+ */
+struct FOPDTPlant {
+    double gain;
+    double time_constant;
+    double ambient;
+    double temp;
+    std::deque<double> delayed;
+
+    FOPDTPlant(double gain, double time_constant, double dead_time,
+               double ambient, double sampletime)
+        : gain(gain),
+          time_constant(time_constant),
+          ambient(ambient),
+          temp(ambient),
+          delayed(static_cast<size_t>(dead_time / sampletime), 0.0) {}
+
+    auto step(double output, double sampletime) -> double {
+        delayed.push_back(output);
+        const double applied = delayed.front();
+        delayed.pop_front();
+        temp += (ambient + gain * applied - temp) * sampletime / time_constant;
+        return temp;
+    }
+};
+
+SCENARIO("relay autotuning") {
+    constexpr double sampletime = 0.1;
+    GIVEN("a heater that can reach the setpoint") {
+        // Ultimate frequency w solves atan(w * 100) + w * 10 = pi, so the
+        // ultimate period is about 38.5s and the ultimate gain about 0.164
+        auto plant = FOPDTPlant(100.0, 100.0, 10.0, 25.0, sampletime);
+        auto tuner = RelayAutotune(60.0, 1.0, 0.0, 0.2, sampletime);
+        WHEN("running the tuner until it finishes") {
+            double output = tuner.update(plant.temp);
+            THEN("it starts by driving the relay high") {
+                REQUIRE(output == 1.0);
+            }
+            while (tuner.status() == RelayAutotune::Status::RUNNING) {
+                output = tuner.update(plant.step(output, sampletime));
+            }
+            THEN("it identifies the ultimate gain and period") {
+                REQUIRE(tuner.status() == RelayAutotune::Status::DONE);
+                REQUIRE(tuner.cycles_completed() ==
+                        RelayAutotune::DEFAULT_CYCLES + 1);
+                REQUIRE_THAT(tuner.ultimate_period(),
+                             Catch::Matchers::WithinRel(38.5, 0.25));
+                REQUIRE_THAT(tuner.ultimate_gain(),
+                             Catch::Matchers::WithinRel(0.164, 0.25));
+                REQUIRE(tuner.output() == 0.0);
+            }
+            THEN("the suggested gains control the plant without much "
+                 "overshoot") {
+                auto pid = PID(tuner.kp(), tuner.ki(), tuner.kd(), sampletime,
+                               1.0, -1.0);
+                auto fresh = FOPDTPlant(100.0, 100.0, 10.0, 25.0, sampletime);
+                pid.arm_integrator_reset(60.0 - fresh.temp);
+                double peak = fresh.temp;
+                double power = 0;
+                constexpr double settle_seconds = 600;
+                for (int i = 0; i < settle_seconds / sampletime; ++i) {
+                    power = std::clamp(pid.compute(60.0 - fresh.temp), 0.0,
+                                       1.0);
+                    peak = std::max(peak, fresh.step(power, sampletime));
+                }
+                REQUIRE_THAT(fresh.temp, Catch::Matchers::WithinAbs(60.0, 0.5));
+                REQUIRE(peak < 60.0 + 0.1 * (60.0 - 25.0));
+            }
+        }
+    }
+    GIVEN("a heater too weak to reach the setpoint") {
+        auto plant = FOPDTPlant(20.0, 100.0, 10.0, 25.0, sampletime);
+        auto tuner = RelayAutotune(60.0, 1.0, 0.0, 0.2, sampletime,
+                                   RelayAutotune::DEFAULT_CYCLES, 120.0);
+        WHEN("running the tuner") {
+            double output = tuner.update(plant.temp);
+            while (tuner.status() == RelayAutotune::Status::RUNNING) {
+                output = tuner.update(plant.step(output, sampletime));
+            }
+            THEN("it times out and turns the output off") {
+                REQUIRE(tuner.status() == RelayAutotune::Status::FAILED);
+                REQUIRE(tuner.output() == 0.0);
+                REQUIRE(tuner.kp() == 0.0);
+            }
+        }
+    }
+    GIVEN("a tuner started above the setpoint") {
+        auto tuner = RelayAutotune(60.0, 1.0, -1.0, 0.2, sampletime);
+        WHEN("updating with a hot reading") {
+            auto output = tuner.update(70.0);
+            THEN("the relay switches low right away") {
+                REQUIRE(output == -1.0);
+                REQUIRE(tuner.cycles_completed() == 0);
+            }
+        }
+    }
+}
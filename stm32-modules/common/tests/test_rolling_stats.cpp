@@ -0,0 +1,64 @@
+#include "catch2/catch.hpp"
+#include "core/rolling_stats.hpp"
+
+SCENARIO("rolling stats") {
+    auto stats = RollingStats<4>();
+    GIVEN("no readings") {
+        THEN("everything reads zero") {
+            REQUIRE(stats.count() == 0);
+            REQUIRE(stats.mean() == 0);
+            REQUIRE(stats.stddev() == 0);
+            REQUIRE(stats.variance() == 0);
+            REQUIRE(stats.min() == 0);
+            REQUIRE(stats.max() == 0);
+        }
+    }
+    GIVEN("a partly filled window") {
+        stats.add(1.0);
+        stats.add(3.0);
+        THEN("only the readings so far count") {
+            REQUIRE(stats.count() == 2);
+            REQUIRE_THAT(stats.mean(), Catch::Matchers::WithinAbs(2.0, 1e-9));
+            REQUIRE_THAT(stats.stddev(),
+                         Catch::Matchers::WithinAbs(1.41421356, 1e-6));
+        }
+    }
+    GIVEN("more readings than the window holds") {
+        for (double value : {100.0, 100.0, 1.0, 2.0, 3.0, 4.0}) {
+            stats.add(value);
+        }
+        THEN("only the latest window counts") {
+            REQUIRE(stats.count() == 4);
+            REQUIRE_THAT(stats.mean(), Catch::Matchers::WithinAbs(2.5, 1e-9));
+            REQUIRE_THAT(stats.stddev(),
+                         Catch::Matchers::WithinAbs(1.29099445, 1e-6));
+            REQUIRE_THAT(stats.variance(),
+                         Catch::Matchers::WithinAbs(1.66666667, 1e-6));
+            REQUIRE(stats.min() == 1.0);
+            REQUIRE(stats.max() == 4.0);
+        }
+        THEN("a shorter window covers only the latest readings") {
+            REQUIRE(stats.count(2) == 2);
+            REQUIRE_THAT(stats.mean(2), Catch::Matchers::WithinAbs(3.5, 1e-9));
+            REQUIRE_THAT(stats.variance(2),
+                         Catch::Matchers::WithinAbs(0.5, 1e-9));
+            REQUIRE(stats.min(2) == 3.0);
+            REQUIRE(stats.max(2) == 4.0);
+        }
+        THEN("a longer window than is kept covers the whole window") {
+            REQUIRE(stats.count(10) == 4);
+            REQUIRE_THAT(stats.mean(10),
+                         Catch::Matchers::WithinAbs(2.5, 1e-9));
+        }
+        WHEN("the stats are reset") {
+            stats.reset();
+            THEN("the window is empty") { REQUIRE(stats.count() == 0); }
+        }
+    }
+    GIVEN("a steady signal") {
+        for (int i = 0; i < 10; ++i) {
+            stats.add(42.0);
+        }
+        THEN("there is no noise") { REQUIRE(stats.stddev() == 0); }
+    }
+}
@@ -0,0 +1,62 @@
+#include <atomic>
+#include <chrono>
+#include <stop_token>
+#include <thread>
+
+#include "catch2/catch.hpp"
+#include "simulator/sim_clock.hpp"
+
+using namespace std::chrono_literals;
+using sim_clock::SimClock;
+
+namespace {
+// Wait on the real clock for a flag set by another thread, giving up well
+// before a broken clock could hang the test run
+auto eventually(const std::atomic<bool>& flag) -> bool {
+    const auto give_up = std::chrono::steady_clock::now() + 5s;
+    while (!flag.load() && (std::chrono::steady_clock::now() < give_up)) {
+        std::this_thread::sleep_for(1ms);
+    }
+    return flag.load();
+}
+}  // namespace
+
+SCENARIO("simulator clock running as fast as possible") {
+    GIVEN("a clock with two threads taking part") {
+        SimClock clock;
+        clock.set_speed(SimClock::AS_FAST_AS_POSSIBLE);
+        clock.add_participant();
+        clock.add_participant();
+        std::atomic<bool> first_woke = false;
+        std::atomic<bool> second_woke = false;
+        auto first_woke_at = SimClock::duration(0);
+        auto second_woke_at = SimClock::duration(0);
+        auto first = std::jthread([&](const std::stop_token& st) {
+            clock.sleep_until(10ms, st);
+            first_woke_at = clock.now();
+            first_woke = true;
+            clock.remove_participant();
+        });
+        WHEN("only one of them is waiting") {
+            std::this_thread::sleep_for(50ms);
+            THEN("the clock stands still") {
+                REQUIRE(!first_woke.load());
+                REQUIRE(clock.now() == SimClock::duration(0));
+            }
+        }
+        WHEN("the other waits for a later time") {
+            auto second = std::jthread([&](const std::stop_token& st) {
+                clock.sleep_until(30ms, st);
+                second_woke_at = clock.now();
+                second_woke = true;
+                clock.remove_participant();
+            });
+            THEN("the clock jumps to each deadline in turn") {
+                REQUIRE(eventually(first_woke));
+                REQUIRE(first_woke_at == SimClock::duration(10ms));
+                REQUIRE(eventually(second_woke));
+                REQUIRE(second_woke_at == SimClock::duration(30ms));
+            }
+        }
+    }
+}
@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <deque>
+
+#include "catch2/catch.hpp"
+#include "core/pid.hpp"
+#include "core/thermal_fault_monitor.hpp"
+
+using Fault = ThermalFaultMonitor::Fault;
+
+/**
+ * First order heater with a short transport lag, so that the temperature
+ * keeps climbing for a moment after the output is cut.
+ */
+struct LaggedHeater {
+    static constexpr double GAIN = 100.0;
+    static constexpr double TIME_CONSTANT = 60.0;
+    static constexpr double AMBIENT = 25.0;
+    double temp = AMBIENT;
+    std::deque<double> delayed;
+
+    LaggedHeater(double dead_time, double sampletime)
+        : delayed(static_cast<size_t>(dead_time / sampletime), 0.0) {}
+
+    auto step(double output, double sampletime) -> double {
+        delayed.push_back(output);
+        const double applied = delayed.front();
+        delayed.pop_front();
+        temp += (AMBIENT + GAIN * applied - temp) * sampletime / TIME_CONSTANT;
+        return temp;
+    }
+};
+
+SCENARIO("thermal fault monitor") {
+    constexpr double sampletime = 0.1;
+    constexpr auto limits =
+        ThermalFaultMonitor::Limits{.window_s = 20.0,
+                                    .drive_threshold = 0.5,
+                                    .target_band_c = 3.0,
+                                    .min_response_c = 2.0,
+                                    .max_undriven_rise_c = 2.0};
+    auto monitor = ThermalFaultMonitor(limits, sampletime);
+    GIVEN("a healthy heater under closed loop control") {
+        auto plant = LaggedHeater(3.0, sampletime);
+        auto pid = PID(0.2, 0.005, 0, sampletime, 1.0, 0.0);
+        constexpr double target = 80.0;
+        WHEN("ramping to the target and holding it") {
+            auto worst = Fault::NONE;
+            double output = 0;
+            for (int i = 0; i < 600.0 / sampletime; ++i) {
+                output =
+                    std::clamp(pid.compute(target - plant.temp), 0.0, 1.0);
+                plant.step(output, sampletime);
+                auto fault = monitor.update(plant.temp, target, output);
+                worst = std::max(worst, fault);
+            }
+            THEN("no fault is raised") {
+                REQUIRE_THAT(plant.temp,
+                             Catch::Matchers::WithinAbs(target, 1.0));
+                REQUIRE(worst == Fault::NONE);
+            }
+        }
+        WHEN("the target is one the heater can't quite reach") {
+            constexpr double unreachable =
+                LaggedHeater::AMBIENT + LaggedHeater::GAIN + 10.0;
+            auto fault = Fault::NONE;
+            for (int i = 0; i < 900.0 / sampletime; ++i) {
+                plant.step(1.0, sampletime);
+                fault = monitor.update(plant.temp, unreachable, 1.0);
+            }
+            THEN("sitting at full power short of it is not a fault") {
+                REQUIRE(plant.temp < unreachable - limits.target_band_c);
+                REQUIRE(fault == Fault::NONE);
+            }
+        }
+    }
+    GIVEN("a thermistor that is no longer touching the heater") {
+        WHEN("driving full power with the reading stuck at ambient") {
+            double elapsed = 0;
+            auto fault = Fault::NONE;
+            while ((fault == Fault::NONE) && (elapsed < 120)) {
+                fault = monitor.update(25.0, 80.0, 1.0);
+                elapsed += sampletime;
+            }
+            THEN("no response is flagged after one window") {
+                REQUIRE(fault == Fault::NO_RESPONSE);
+                REQUIRE_THAT(elapsed, Catch::Matchers::WithinAbs(
+                                          limits.window_s, 2 * sampletime));
+                AND_THEN("the fault stays latched until reset") {
+                    REQUIRE(monitor.update(80.0, 80.0, 0.0) ==
+                            Fault::NO_RESPONSE);
+                    monitor.reset();
+                    REQUIRE(monitor.fault() == Fault::NONE);
+                }
+            }
+        }
+        WHEN("the reading drops away from a target that was being held") {
+            for (int i = 0; i < 100; ++i) {
+                REQUIRE(monitor.update(80.0, 80.0, 0.3) == Fault::NONE);
+            }
+            auto fault = Fault::NONE;
+            for (int i = 0; i < (limits.window_s + 1) / sampletime; ++i) {
+                fault = monitor.update(25.0, 80.0, 1.0);
+            }
+            THEN("no response is flagged") {
+                REQUIRE(fault == Fault::NO_RESPONSE);
+            }
+        }
+    }
+    GIVEN("a cooler driven towards a colder target") {
+        WHEN("the temperature follows") {
+            double temp = 60.0;
+            auto fault = Fault::NONE;
+            for (int i = 0; i < 60.0 / sampletime; ++i) {
+                temp -= 0.2 * sampletime;
+                fault = monitor.update(temp, 4.0, -1.0);
+            }
+            THEN("no fault is raised") { REQUIRE(fault == Fault::NONE); }
+        }
+        WHEN("the temperature climbs instead") {
+            double temp = 60.0;
+            double elapsed = 0;
+            auto fault = Fault::NONE;
+            while ((fault == Fault::NONE) && (elapsed < 120)) {
+                temp += 0.2 * sampletime;
+                fault = monitor.update(temp, 4.0, -1.0);
+                elapsed += sampletime;
+            }
+            THEN("no response is flagged first") {
+                REQUIRE(fault == Fault::NO_RESPONSE);
+            }
+        }
+    }
+    GIVEN("a heater that is stuck on") {
+        auto plant = LaggedHeater(3.0, sampletime);
+        WHEN("the loop has turned it off but it keeps heating") {
+            double elapsed = 0;
+            auto fault = Fault::NONE;
+            while ((fault == Fault::NONE) && (elapsed < 120)) {
+                plant.step(1.0, sampletime);
+                fault = monitor.update(plant.temp, 40.0, 0.0);
+                elapsed += sampletime;
+            }
+            THEN("a runaway is flagged soon after the grace period") {
+                REQUIRE(fault == Fault::RUNAWAY);
+                REQUIRE(elapsed > limits.window_s);
+                REQUIRE(elapsed < limits.window_s + 5.0);
+            }
+        }
+    }
+    GIVEN("a zone sharing a block with zones that are heating") {
+        WHEN("its own output is backed off while the block heats it") {
+            auto fault = Fault::NONE;
+            double temp = 40.0;
+            for (int i = 0; i < 3 * limits.window_s / sampletime; ++i) {
+                temp += 0.5 * sampletime;
+                fault = std::max(fault,
+                                 monitor.update(temp, 90.0, -0.5, 1.0));
+            }
+            THEN("the rise is not mistaken for a runaway") {
+                REQUIRE(fault == Fault::NONE);
+            }
+        }
+        WHEN("nothing in the block is heating and it still rises") {
+            auto fault = Fault::NONE;
+            double temp = 40.0;
+            for (int i = 0; i < 3 * limits.window_s / sampletime; ++i) {
+                temp += 0.5 * sampletime;
+                fault = std::max(fault,
+                                 monitor.update(temp, 90.0, -0.5, 0.0));
+            }
+            THEN("a runaway is flagged") { REQUIRE(fault == Fault::RUNAWAY); }
+        }
+    }
+    GIVEN("a heater that coasts up after being turned off") {
+        auto plant = LaggedHeater(3.0, sampletime);
+        for (int i = 0; i < 30.0 / sampletime; ++i) {
+            plant.step(1.0, sampletime);
+            REQUIRE(monitor.update(plant.temp, 80.0, 1.0) == Fault::NONE);
+        }
+        WHEN("the output is cut") {
+            auto worst = Fault::NONE;
+            for (int i = 0; i < 120.0 / sampletime; ++i) {
+                plant.step(0.0, sampletime);
+                worst = std::max(worst,
+                                 monitor.update(plant.temp, plant.temp, 0.0));
+            }
+            THEN("the thermal lag is not mistaken for a runaway") {
+                REQUIRE(worst == Fault::NONE);
+            }
+        }
+    }
+    GIVEN("paired thermistors") {
+        THEN("readings close together are plausible") {
+            REQUIRE(ThermalFaultMonitor::pair_plausible(50.0, 52.0, 5.0));
+            REQUIRE(ThermalFaultMonitor::pair_plausible(52.0, 50.0, 5.0));
+        }
+        THEN("readings far apart are not") {
+            REQUIRE(!ThermalFaultMonitor::pair_plausible(50.0, 25.0, 5.0));
+            REQUIRE(!ThermalFaultMonitor::pair_plausible(25.0, 50.0, 5.0));
+        }
+    }
+}
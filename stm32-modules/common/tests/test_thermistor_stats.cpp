@@ -0,0 +1,70 @@
+#include "catch2/catch.hpp"
+#include "core/thermistor_stats.hpp"
+
+SCENARIO("thermistor stats") {
+    auto stats = ThermistorStats<4>();
+    GIVEN("no conversions") {
+        THEN("everything reads zero") {
+            REQUIRE(stats.count() == 0);
+            REQUIRE(stats.invalid() == 0);
+            REQUIRE(stats.total() == 0);
+            REQUIRE(stats.total_invalid() == 0);
+            REQUIRE(stats.drift() == 0);
+        }
+    }
+    GIVEN("a mix of valid and invalid conversions") {
+        stats.add(20.0);
+        stats.add_invalid();
+        stats.add(24.0);
+        THEN("the window statistics only cover valid readings") {
+            REQUIRE(stats.count() == 2);
+            REQUIRE(stats.min() == 20.0);
+            REQUIRE(stats.max() == 24.0);
+            REQUIRE_THAT(stats.mean(), Catch::Matchers::WithinAbs(22, 1e-9));
+            REQUIRE_THAT(stats.variance(),
+                         Catch::Matchers::WithinAbs(8, 1e-9));
+        }
+        THEN("the invalid conversion is counted") {
+            REQUIRE(stats.invalid() == 1);
+            REQUIRE(stats.total() == 3);
+            REQUIRE(stats.total_invalid() == 1);
+        }
+        THEN("a shorter window covers only the latest conversions") {
+            REQUIRE(stats.count(1) == 1);
+            REQUIRE(stats.mean(1) == 24.0);
+            REQUIRE(stats.invalid(1) == 0);
+            REQUIRE(stats.invalid(2) == 1);
+        }
+        WHEN("enough valid conversions follow to push it out of the window") {
+            for (int i = 0; i < 4; ++i) {
+                stats.add(22.0);
+            }
+            THEN("only the lifetime count remembers it") {
+                REQUIRE(stats.invalid() == 0);
+                REQUIRE(stats.total() == 7);
+                REQUIRE(stats.total_invalid() == 1);
+            }
+        }
+    }
+    GIVEN("a sensor that reads steadily after boot") {
+        for (int i = 0; i < 4; ++i) {
+            stats.add(25.0);
+        }
+        THEN("there is no drift yet") { REQUIRE(stats.drift() == 0); }
+        WHEN("its readings creep up") {
+            for (int i = 0; i < 4; ++i) {
+                stats.add(25.5);
+            }
+            THEN("the drift is measured from the first full window") {
+                REQUIRE_THAT(stats.drift(),
+                             Catch::Matchers::WithinAbs(0.5, 1e-9));
+            }
+        }
+    }
+    GIVEN("a partly filled window") {
+        stats.add(30.0);
+        THEN("there is no baseline to drift from") {
+            REQUIRE(stats.drift() == 0);
+        }
+    }
+}
@@ -5,30 +5,49 @@
 #include "stm32f3xx_hal_adc_ex.h"
 #include "stm32f3xx_hal_gpio.h"
 #include "stm32f3xx_hal_cortex.h"
+#include "stm32f3xx_hal_dma.h"
 #include "stm32f3xx_hal_tim.h"
 #include "stm32f3xx_ll_tim.h"
 
 #include "heater_hardware.h"
 
 static void init_error(void);
-static void adc_setup(ADC_HandleTypeDef* adc);
+static void adc_setup(ADC_HandleTypeDef* adc, DMA_HandleTypeDef* dma);
 static void gpio_setup(void);
-static ntc_selection next_channel(ntc_selection from_which);
+static uint16_t average_samples(const uint16_t* samples, size_t channel);
 static void tim_setup(TIM_HandleTypeDef* tim);
 
+// Each control period, ADC3 scans the NTCs as one regular sequence with the
+// DMA moving the samples out. The sequence goes through every channel once,
+// NTC_OVERSAMPLE times over, and the samples for each channel are averaged
+// when it's done. The F303 ADC has no hardware oversampler, so this is how
+// we get one; it's capped by the 16 ranks in a regular sequence.
+#define NTC_CHANNEL_COUNT (3)
+#define NTC_OVERSAMPLE (4)
+#define NTC_SAMPLE_COUNT (NTC_CHANNEL_COUNT * NTC_OVERSAMPLE)
+_Static_assert(NTC_SAMPLE_COUNT <= 16,
+               "The regular sequence has room for 16 conversions");
+
+// Scan order within each pass of the sequence
+static const ntc_selection ntc_channels[NTC_CHANNEL_COUNT] = {
+    NTC_PAD_A, NTC_PAD_B, NTC_ONBOARD,
+};
+
 typedef struct {
-    ntc_selection reading_which;
     conversion_results results;
+    uint16_t samples[NTC_SAMPLE_COUNT];
     ADC_HandleTypeDef ntc_adc;
+    DMA_HandleTypeDef ntc_dma;
     TIM_HandleTypeDef pad_tim;
     TIM_OC_InitTypeDef pwm_config;
     bool heater_started;
 } hw_internal;
 
 hw_internal _internals = {
-.reading_which = NTC_PAD_A,
 .results = {0, 0, 0},
+.samples = {},
 .ntc_adc = {},
+.ntc_dma = {},
 .pad_tim = {},
 .pwm_config = {
 .OCMode = TIM_OCMODE_PWM1,
@@ -58,6 +77,8 @@ heater_hardware *HEATER_HW_HANDLE = NULL;
 #define HEATER_PAD_ENABLE_PIN (1<<14)
 #define HEATER_PAD_ENABLE_TIM_CHANNEL TIM_CHANNEL_3
 #define HEATER_PAD_LL_SETCOMPARE LL_TIM_OC_SetCompareCH3
+#define NTC_DMA_CHANNEL DMA2_Channel5
+#define NTC_DMA_IRQ DMA2_Channel5_IRQn
 
 
 static void gpio_setup(void) {
@@ -93,21 +114,54 @@ static void gpio_setup(void) {
     HAL_GPIO_Init(HEATER_PAD_ENABLE_PORT, &gpio_init);
 }
 
-static void adc_setup(ADC_HandleTypeDef* adc) {
+static void adc_setup(ADC_HandleTypeDef* adc, DMA_HandleTypeDef* dma) {
+    dma->Instance = NTC_DMA_CHANNEL;
+    dma->Init.Direction = DMA_PERIPH_TO_MEMORY;
+    dma->Init.PeriphInc = DMA_PINC_DISABLE;
+    dma->Init.MemInc = DMA_MINC_ENABLE;
+    dma->Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+    dma->Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+    // One scan per start; the channel stops after the last sample
+    dma->Init.Mode = DMA_NORMAL;
+    dma->Init.Priority = DMA_PRIORITY_LOW;
+    if (HAL_OK != HAL_DMA_Init(dma)) {
+        init_error();
+    }
+    __HAL_LINKDMA(adc, DMA_Handle, *dma);
+
     adc->Instance = ADC3;
     adc->Init.ClockPrescaler = ADC_CLOCK_SYNC_PCLK_DIV1;
     adc->Init.Resolution = ADC_RESOLUTION_12B;
     adc->Init.DataAlign = ADC_DATAALIGN_RIGHT;
-    adc->Init.ScanConvMode = ADC_SCAN_DISABLE;
+    adc->Init.ScanConvMode = ADC_SCAN_ENABLE;
     adc->Init.ContinuousConvMode = DISABLE;
-    adc->Init.NbrOfConversion = 1;
-    adc->Init.DiscontinuousConvMode = ENABLE;
+    adc->Init.NbrOfConversion = NTC_SAMPLE_COUNT;
+    adc->Init.DiscontinuousConvMode = DISABLE;
     adc->Init.ExternalTrigConv = ADC_SOFTWARE_START;
+    adc->Init.EOCSelection = ADC_EOC_SEQ_CONV;
     adc->Init.DMAContinuousRequests = DISABLE;
+    adc->Init.Overrun = ADC_OVR_DATA_OVERWRITTEN;
     if (HAL_OK != HAL_ADC_Init(adc)) {
         init_error();
     }
 
+    // The sequence never changes, so set it up once here rather than
+    // between conversions
+    ADC_ChannelConfTypeDef channel_conf = {
+        .SingleDiff = ADC_SINGLE_ENDED,
+        .OffsetNumber = ADC_OFFSET_NONE,
+        .Offset = 0,
+        .SamplingTime = ADC_SAMPLETIME_601CYCLES_5,
+    };
+    for (size_t rank = 0; rank < NTC_SAMPLE_COUNT; ++rank) {
+        channel_conf.Channel = ntc_channels[rank % NTC_CHANNEL_COUNT];
+        // Regular ranks on the F3 are just numbered from 1
+        channel_conf.Rank = ADC_REGULAR_RANK_1 + rank;
+        if (HAL_OK != HAL_ADC_ConfigChannel(adc, &channel_conf)) {
+            init_error();
+        }
+    }
+
     HAL_ADCEx_Calibration_Start(adc, ADC_SINGLE_ENDED);
 }
 
@@ -136,18 +190,21 @@ static void tim_setup(TIM_HandleTypeDef* tim) {
 void heater_hardware_setup(heater_hardware* hardware) {
     HEATER_HW_HANDLE = hardware;
     hardware->hardware_internal = (void*)&_internals;
-    _internals.reading_which = NTC_PAD_A;
     __HAL_RCC_GPIOB_CLK_ENABLE();
     __HAL_RCC_GPIOD_CLK_ENABLE();
     __HAL_RCC_GPIOE_CLK_ENABLE();
     __HAL_RCC_ADC34_CLK_ENABLE();
+    __HAL_RCC_DMA2_CLK_ENABLE();
     __HAL_RCC_TIM4_CLK_ENABLE();
     gpio_setup();
-    adc_setup(&_internals.ntc_adc);
+    adc_setup(&_internals.ntc_adc, &_internals.ntc_dma);
     tim_setup(&_internals.pad_tim);
+    // The ADC interrupt only reports overruns now; completion comes from
+    // the DMA
     HAL_NVIC_SetPriority(ADC3_IRQn, 10, 0);
     HAL_NVIC_EnableIRQ(ADC3_IRQn);
-    HAL_ADC_Start(&_internals.ntc_adc);
+    HAL_NVIC_SetPriority(NTC_DMA_IRQ, 10, 0);
+    HAL_NVIC_EnableIRQ(NTC_DMA_IRQ);
 }
 
 void heater_hardware_teardown(heater_hardware* hardware) {
@@ -156,26 +213,20 @@ void heater_hardware_teardown(heater_hardware* hardware) {
         return;
     }
     HAL_NVIC_DisableIRQ(ADC3_IRQn);
-    HAL_ADC_Stop(&internal->ntc_adc);
+    HAL_NVIC_DisableIRQ(NTC_DMA_IRQ);
+    HAL_ADC_Stop_DMA(&internal->ntc_adc);
     __HAL_RCC_ADC34_CLK_DISABLE();
 }
 
 void heater_hardware_begin_conversions(heater_hardware* hardware) {
-    ADC_ChannelConfTypeDef channel_conf = {
-        .Channel = NTC_PAD_A,
-        .Rank = ADC_REGULAR_RANK_1,
-        .SamplingTime = ADC_SAMPLETIME_601CYCLES_5,
-    };
     hw_internal* internal = (hw_internal*)hardware->hardware_internal;
     if (!internal) {
         init_error();
     }
-    internal->reading_which = NTC_PAD_A;
-    if (HAL_OK != HAL_ADC_ConfigChannel(&internal->ntc_adc, &channel_conf)) {
-        init_error();
-    }
-
-    HAL_ADC_Start_IT(&internal->ntc_adc);
+    // If the last scan somehow hasn't finished this fails, and the results
+    // of that scan still arrive
+    HAL_ADC_Start_DMA(&internal->ntc_adc, (uint32_t*)internal->samples,
+                      NTC_SAMPLE_COUNT);
 }
 
 bool heater_hardware_sense_power_good() {
@@ -230,19 +281,22 @@ void ADC3_IRQHandler(void) {
     }
 }
 
-static ntc_selection next_channel(ntc_selection from_which) {
-    switch (from_which) {
-        case NTC_PAD_A:
-            return NTC_PAD_B;
-        case NTC_PAD_B:
-            return NTC_ONBOARD;
-        case NTC_ONBOARD:
-            return NTC_PAD_A;
-        default:
-            return NTC_PAD_A;
+void DMA2_Channel5_IRQHandler(void) {
+    if (HEATER_HW_HANDLE && HEATER_HW_HANDLE->hardware_internal) {
+        hw_internal* internal = (hw_internal*)HEATER_HW_HANDLE->hardware_internal;
+        HAL_DMA_IRQHandler(&internal->ntc_dma);
+    }
+}
+
+static uint16_t average_samples(const uint16_t* samples, size_t channel) {
+    uint32_t sum = 0;
+    for (size_t pass = 0; pass < NTC_OVERSAMPLE; ++pass) {
+        sum += samples[pass * NTC_CHANNEL_COUNT + channel];
     }
+    return (uint16_t)((sum + (NTC_OVERSAMPLE / 2)) / NTC_OVERSAMPLE);
 }
 
+// Called from the DMA interrupt once the whole sequence is in samples
 void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef* hadc) {
     if (!HEATER_HW_HANDLE || !HEATER_HW_HANDLE->hardware_internal) {
         return;
@@ -252,35 +306,11 @@ void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef* hadc) {
         return;
     }
 
-    ntc_selection which = internal->reading_which;
-    internal->reading_which = next_channel(which);
-
-    ADC_ChannelConfTypeDef channel_conf = {
-      .Channel = internal->reading_which,
-      .Rank = ADC_REGULAR_RANK_1,
-      .SamplingTime = ADC_SAMPLETIME_601CYCLES_5,
-    };
-    switch(which) {
-        case NTC_PAD_A: {
-            internal->results.pad_a_val = HAL_ADC_GetValue(&internal->ntc_adc);
-            if (HAL_OK != HAL_ADC_ConfigChannel(&internal->ntc_adc, &channel_conf)) {
-                init_error();
-            }
-            HAL_ADC_Start_IT(&internal->ntc_adc);
-            break;}
-        case NTC_PAD_B: {
-            internal->results.pad_b_val = HAL_ADC_GetValue(&internal->ntc_adc);
-            if (HAL_OK != HAL_ADC_ConfigChannel(&internal->ntc_adc, &channel_conf)) {
-                init_error();
-            }
-            HAL_ADC_Start_IT(&internal->ntc_adc);
-            break;}
-        case NTC_ONBOARD: {
-            internal->results.onboard_val = HAL_ADC_GetValue(&internal->ntc_adc);
-            if (HEATER_HW_HANDLE->conversions_complete) {
-                HEATER_HW_HANDLE->conversions_complete(&internal->results);
-            }
-            break;}
+    internal->results.pad_a_val = average_samples(internal->samples, 0);
+    internal->results.pad_b_val = average_samples(internal->samples, 1);
+    internal->results.onboard_val = average_samples(internal->samples, 2);
+    if (HEATER_HW_HANDLE->conversions_complete) {
+        HEATER_HW_HANDLE->conversions_complete(&internal->results);
     }
 }
 
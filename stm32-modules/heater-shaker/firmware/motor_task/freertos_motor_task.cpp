@@ -16,6 +16,7 @@ extern "C" {
 #include "mc_interface.h"
 #include "mc_tasks.h"
 #include "mc_tuning.h"
+#include "parameters_conversion.h"
 #include "stm32f3xx_hal.h"
 }
 #pragma GCC diagnostic pop
@@ -64,6 +65,38 @@ StaticTask_t control_task_data;
 // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
 static MotorTaskFreeRTOS _local_task;
 
+// Armed by the motor task while homing, moving the plate lock, changing
+// speed or running a shake program, counted down by the control task
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+static MotorWakeup _homing_wakeup;
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+static MotorWakeup _plate_lock_timeout;
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+static MotorWakeup _speed_profile_wakeup;
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+static MotorWakeup _shake_program_wakeup;
+// Armed and triggered by the motor task, filled by the control task
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+static motor_telemetry::MotorCapture _motor_capture;
+
+// One FOC pass per regulation period of the PWM, and one control task pass
+// per millisecond tick
+static constexpr uint32_t HIGH_FREQUENCY_PERIOD_CYCLES =
+    SYSCLK_FREQ * REGULATION_EXECUTION_RATE / PWM_FREQUENCY;
+static constexpr uint32_t MEDIUM_FREQUENCY_PERIOD_CYCLES =
+    SYSCLK_FREQ / SYS_TICK_FREQUENCY;
+// Filled by the ADC interrupt and the control task, read by the motor task
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+static loop_timing::LoopStats _high_frequency_timing(
+    HIGH_FREQUENCY_PERIOD_CYCLES);
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+static loop_timing::LoopStats _medium_frequency_timing(
+    MEDIUM_FREQUENCY_PERIOD_CYCLES);
+
+extern "C" void motor_hardware_record_foc_cycles(uint32_t cycles) {
+    _high_frequency_timing.record(cycles);
+}
+
 static void handle_plate_lock(const optical_switch_results *results) {
     if (results == nullptr) {
         return;
@@ -73,13 +106,34 @@ static void handle_plate_lock(const optical_switch_results *results) {
             .open = results->open, .closed = results->closed})));
 }
 
+static auto capture_sample(motor_hardware_handles *handles)
+    -> motor_telemetry::Sample {
+    // The bus voltage sensor reports in u16Volts, where a full scale 65536
+    // is ConversionFactor volts
+    constexpr uint32_t MV_PER_V = 1000;
+    constexpr uint32_t U16_FULL_SCALE = 65536;
+    const auto &bus = RealBusVoltageSensorParamsM1._Super;
+    const uint32_t bus_mv = static_cast<uint32_t>(bus.AvBusVoltage_d) *
+                            bus.ConversionFactor * MV_PER_V / U16_FULL_SCALE;
+    return motor_telemetry::Sample{
+        .rpm = MotorPolicy::current_rpm(handles),
+        .setpoint_rpm = static_cast<int16_t>(
+            -MCI_GetMecSpeedRefUnit(handles->mci[0]) * _RPM / _01HZ),
+        .iq = MCI_GetIqd(handles->mci[0]).q,
+        .bus_mv = static_cast<uint16_t>(bus_mv)};
+}
+
 // Actual function that runs inside the task
 void run(void *param) {
     static_cast<void>(param);
     memset(&_local_task.handles, 0, sizeof(_local_task.handles));
     _local_task.handles.plate_lock_complete = handle_plate_lock;
     motor_hardware_setup(&_local_task.handles);
-    auto policy = MotorPolicy(&_local_task.handles);
+    auto policy = MotorPolicy(&_local_task.handles, &_homing_wakeup,
+                              &_plate_lock_timeout, &_speed_profile_wakeup,
+                              &_shake_program_wakeup, &_motor_capture,
+                              &_high_frequency_timing,
+                              &_medium_frequency_timing);
     auto &queue = _task.get_message_queue();
     // ensure plate lock closed via message at startup (needed for homing)
     auto message1 = messages::ClosePlateLockMessage{.from_startup = true};
@@ -94,12 +148,35 @@ void run_control_task(void *param) {
     static_cast<void>(param);
     while (true) {
         vTaskDelay(1);
+        const uint32_t start_cycles = DWT->CYCCNT;
         uint16_t code = MC_RunMotorControlTasks();
+        _medium_frequency_timing.record(DWT->CYCCNT - start_cycles);
+        if (_motor_capture.sample_due()) {
+            _motor_capture.record(capture_sample(&_local_task.handles));
+        }
+        auto &queue = _task.get_message_queue();
         if (code != 0) {
-            auto &queue = _task.get_message_queue();
             static_cast<void>(queue.try_send(messages::MotorMessage(
                 messages::MotorSystemErrorMessage{.errors = code})));
         }
+        if (_homing_wakeup.tick(&_local_task.handles)) {
+            static_cast<void>(queue.try_send(messages::MotorMessage(
+                messages::CheckHomingStatusMessage{})));
+        }
+        if (_plate_lock_timeout.tick(&_local_task.handles)) {
+            static_cast<void>(queue.try_send(messages::MotorMessage(
+                messages::PlateLockTimeoutMessage{})));
+        }
+        if (_speed_profile_wakeup.tick(&_local_task.handles)) {
+            static_cast<void>(queue.try_send(messages::MotorMessage(
+                messages::SpeedProfileStepMessage{})));
+        }
+        uint32_t generation = 0;
+        if (_shake_program_wakeup.tick(&_local_task.handles, &generation)) {
+            static_cast<void>(queue.try_send(
+                messages::MotorMessage(messages::ShakeProgramStepMessage{
+                    .generation = generation})));
+        }
     }
 }
 
@@ -15,6 +15,9 @@ extern "C" {
 
 static void Error_Handler();
 
+// The page before the serial number's, at the end of flash
+#define SKIP_BANDS_PAGE_ADDRESS (0x0807F000U)
+
 motor_hardware_handles *MOTOR_HW_HANDLE = NULL;
 
 static void MX_NVIC_Init(void)
@@ -808,8 +811,16 @@ void HAL_TIM_Base_MspDeInit(TIM_HandleTypeDef* htim_base)
 
 }
 
+// The DWT cycle counter times the motor control loops
+static void CycleCounter_Init(void) {
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
 void motor_hardware_setup(motor_hardware_handles* handles) {
   MOTOR_HW_HANDLE = handles;
+  CycleCounter_Init();
   MX_GPIO_Init();
   MX_ADC1_Init(&handles->adc1);
   MX_ADC2_Init(&handles->adc2);
@@ -945,6 +956,34 @@ bool motor_hardware_plate_lock_sensor_read(uint16_t GPIO_Pin)
   }
 }
 
+bool motor_hardware_skip_bands_write(const uint64_t* words, size_t count)
+{
+  FLASH_EraseInitTypeDef page_to_erase = {.TypeErase = FLASH_TYPEERASE_PAGES,
+                                          .PageAddress = SKIP_BANDS_PAGE_ADDRESS,
+                                          .NbPages = 1};
+  uint32_t page_error = 0;
+  HAL_StatusTypeDef status = HAL_FLASH_Unlock();
+  if (status != HAL_OK) {
+    return false;
+  }
+  status = HAL_FLASHEx_Erase(&page_to_erase, &page_error);
+  for (size_t i = 0; (i < count) && (status == HAL_OK); ++i) {
+    status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_DOUBLEWORD,
+                               SKIP_BANDS_PAGE_ADDRESS + (i * sizeof(uint64_t)),
+                               words[i]);
+  }
+  // Lock again even if the write failed
+  if (HAL_FLASH_Lock() != HAL_OK) {
+    return false;
+  }
+  return (status == HAL_OK);
+}
+
+void motor_hardware_skip_bands_read(uint64_t* words, size_t count)
+{
+  memcpy(words, (const void*)SKIP_BANDS_PAGE_ADDRESS, count * sizeof(uint64_t));
+}
+
 void Error_Handler() {
   while (true) {}
 }
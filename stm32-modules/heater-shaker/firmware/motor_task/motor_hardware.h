@@ -37,6 +37,15 @@ bool motor_hardware_plate_lock_sensor_read(uint16_t GPIO_Pin);
 
 void HAL_TIM_MspPostInit(TIM_HandleTypeDef* htim);
 
+// Called from the ADC interrupt with the CPU cycles the FOC current loop
+// took, counted by the DWT cycle counter; the motor task provides it
+void motor_hardware_record_foc_cycles(uint32_t cycles);
+
+// The skip band table lives in the page of flash below the serial number's.
+// Writing erases the page first, which stalls the CPU for a while.
+bool motor_hardware_skip_bands_write(const uint64_t* words, size_t count);
+void motor_hardware_skip_bands_read(uint64_t* words, size_t count);
+
 #define MC_HAL_IS_USED
 
 // Drive and current sense pins
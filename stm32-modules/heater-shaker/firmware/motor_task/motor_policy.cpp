@@ -18,8 +18,62 @@
 
 using namespace errors;
 
-MotorPolicy::MotorPolicy(motor_hardware_handles* handles)
-    : hw_handles(handles) {}
+auto MotorWakeup::arm(uint16_t ticks, int16_t low, int16_t high,
+                      uint32_t tag) -> void {
+    taskENTER_CRITICAL();
+    armed = true;
+    ticks_left = ticks;
+    low_rpm = low;
+    high_rpm = high;
+    this->tag = tag;
+    taskEXIT_CRITICAL();
+}
+
+auto MotorWakeup::disarm() -> void {
+    taskENTER_CRITICAL();
+    armed = false;
+    taskEXIT_CRITICAL();
+}
+
+auto MotorWakeup::tick(motor_hardware_handles* handles, uint32_t* fired_tag)
+    -> bool {
+    bool fire = false;
+    taskENTER_CRITICAL();
+    if (armed) {
+        if (ticks_left > 0) {
+            --ticks_left;
+        }
+        if (ticks_left == 0) {
+            fire = true;
+        } else if (low_rpm < high_rpm) {
+            const auto rpm = MotorPolicy::current_rpm(handles);
+            fire = (rpm > low_rpm) && (rpm < high_rpm);
+        }
+        armed = !fire;
+        if (fire && (fired_tag != nullptr)) {
+            *fired_tag = tag;
+        }
+    }
+    taskEXIT_CRITICAL();
+    return fire;
+}
+
+MotorPolicy::MotorPolicy(motor_hardware_handles* handles,
+                         MotorWakeup* homing_wakeup,
+                         MotorWakeup* plate_lock_timeout,
+                         MotorWakeup* speed_profile_wakeup,
+                         MotorWakeup* shake_program_wakeup,
+                         motor_telemetry::MotorCapture* capture,
+                         loop_timing::LoopStats* high_frequency_timing,
+                         loop_timing::LoopStats* medium_frequency_timing)
+    : hw_handles(handles),
+      homing_wakeup(homing_wakeup),
+      plate_lock_timeout(plate_lock_timeout),
+      speed_profile_wakeup(speed_profile_wakeup),
+      shake_program_wakeup(shake_program_wakeup),
+      capture(capture),
+      high_frequency_timing(high_frequency_timing),
+      medium_frequency_timing(medium_frequency_timing) {}
 
 auto MotorPolicy::homing_solenoid_disengage() -> void {
     motor_hardware_solenoid_release(&hw_handles->dac1);
@@ -47,31 +101,95 @@ auto MotorPolicy::set_rpm(int16_t rpm) -> ErrorCode {
         stop();
         return ErrorCode::NO_ERROR;
     }
-    if (rpm > MAX_APPLICATION_SPEED_RPM || rpm < MIN_APPLICATION_SPEED_RPM) {
-        return ErrorCode::MOTOR_ILLEGAL_SPEED;
+    auto error = validate_rpm(rpm);
+    if (error != ErrorCode::NO_ERROR) {
+        return error;
     }
     const int16_t current_speed = get_current_rpm();
-    const int16_t command_01hz = rpm * _01HZ / _RPM;
     const uint32_t speed_diff = std::abs(rpm - current_speed);
     const uint32_t uncapped_ramp_time_ms = speed_diff / ramp_rate_rpm_per_ms;
     const uint16_t ramp_time_ms = std::max(
         static_cast<uint16_t>(uncapped_ramp_time_ms), static_cast<uint16_t>(1));
+    start_ramp(rpm, ramp_time_ms);
+    return ErrorCode::NO_ERROR;
+}
+
+// NOLINTNEXTLINE(readability-convert-member-functions-to-static)
+auto MotorPolicy::validate_rpm(int16_t rpm) const -> ErrorCode {
+    if (rpm > MAX_APPLICATION_SPEED_RPM || rpm < MIN_APPLICATION_SPEED_RPM) {
+        return ErrorCode::MOTOR_ILLEGAL_SPEED;
+    }
+    return ErrorCode::NO_ERROR;
+}
+
+auto MotorPolicy::set_rpm_segment(int16_t rpm, uint16_t ramp_ticks)
+    -> ErrorCode {
+    auto error = validate_rpm(rpm);
+    if (error != ErrorCode::NO_ERROR) {
+        return error;
+    }
+    // Ticks are milliseconds
+    start_ramp(rpm, std::max(ramp_ticks, static_cast<uint16_t>(1)));
+    return ErrorCode::NO_ERROR;
+}
+
+auto MotorPolicy::start_ramp(int16_t rpm, uint16_t ramp_time_ms) -> void {
+    const int16_t command_01hz = rpm * _01HZ / _RPM;
     MCI_ExecSpeedRamp(hw_handles->mci[0], -command_01hz, ramp_time_ms);
     if (MCI_GetSTMState(hw_handles->mci[0]) == IDLE) {
         MCI_StartMotor(hw_handles->mci[0]);
     }
-    return ErrorCode::NO_ERROR;
 }
 
 auto MotorPolicy::stop() -> void { MCI_StopMotor(hw_handles->mci[0]); }
 
-auto MotorPolicy::get_current_rpm() const -> int16_t {
-    if (IDLE != MCI_GetSTMState(hw_handles->mci[0])) {
-        return -MCI_GetAvrgMecSpeedUnit(hw_handles->mci[0]) * _RPM / _01HZ;
+auto MotorPolicy::motor_capture() -> motor_telemetry::MotorCapture& {
+    return *capture;
+}
+
+// The FOC interrupt runs above the priority FreeRTOS critical sections
+// mask, so the statistics are read and reset with interrupts off entirely
+auto MotorPolicy::get_loop_timing() const -> loop_timing::MotorLoopTiming {
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    auto timing = loop_timing::MotorLoopTiming{
+        .high_frequency = high_frequency_timing->summary(),
+        .medium_frequency = medium_frequency_timing->summary()};
+    __set_PRIMASK(primask);
+    return timing;
+}
+
+auto MotorPolicy::reset_loop_timing() -> void {
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    high_frequency_timing->reset();
+    medium_frequency_timing->reset();
+    __set_PRIMASK(primask);
+}
+
+auto MotorPolicy::read_skip_bands() const
+    -> skip_bands::MotorSkipBands::Stored {
+    skip_bands::MotorSkipBands::Stored words{};
+    motor_hardware_skip_bands_read(words.data(), words.size());
+    return words;
+}
+
+auto MotorPolicy::write_skip_bands(
+    const skip_bands::MotorSkipBands::Stored& words) -> bool {
+    return motor_hardware_skip_bands_write(words.data(), words.size());
+}
+
+auto MotorPolicy::current_rpm(motor_hardware_handles* handles) -> int16_t {
+    if (IDLE != MCI_GetSTMState(handles->mci[0])) {
+        return -MCI_GetAvrgMecSpeedUnit(handles->mci[0]) * _RPM / _01HZ;
     }
     return 0;
 }
 
+auto MotorPolicy::get_current_rpm() const -> int16_t {
+    return current_rpm(hw_handles);
+}
+
 auto MotorPolicy::get_target_rpm() const -> int16_t {
     if (IDLE != MCI_GetSTMState(hw_handles->mci[0])) {
         return -MCI_GetMecSpeedRefUnit(hw_handles->mci[0]) * _RPM / _01HZ;
@@ -80,9 +198,9 @@ auto MotorPolicy::get_target_rpm() const -> int16_t {
 }
 
 auto MotorPolicy::set_ramp_rate(int32_t rpm_per_s) -> ErrorCode {
-    if (rpm_per_s > MAX_RAMP_RATE_RPM_PER_S ||
-        rpm_per_s < MIN_RAMP_RATE_RPM_PER_S) {
-        return ErrorCode::MOTOR_ILLEGAL_RAMP_RATE;
+    auto error = validate_ramp_rate(rpm_per_s);
+    if (error != ErrorCode::NO_ERROR) {
+        return error;
     }
     ramp_rate_rpm_per_ms =
         // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
@@ -90,9 +208,50 @@ auto MotorPolicy::set_ramp_rate(int32_t rpm_per_s) -> ErrorCode {
     return ErrorCode::NO_ERROR;
 }
 
+// NOLINTNEXTLINE(readability-convert-member-functions-to-static)
+auto MotorPolicy::validate_ramp_rate(int32_t rpm_per_s) const -> ErrorCode {
+    if (rpm_per_s > MAX_RAMP_RATE_RPM_PER_S ||
+        rpm_per_s < MIN_RAMP_RATE_RPM_PER_S) {
+        return ErrorCode::MOTOR_ILLEGAL_RAMP_RATE;
+    }
+    return ErrorCode::NO_ERROR;
+}
+
 // NOLINTNEXTLINE(readability-convert-member-functions-to-static)
 auto MotorPolicy::delay_ticks(uint16_t ticks) -> void { vTaskDelay(ticks); }
 
+auto MotorPolicy::homing_wakeup_arm(uint16_t ticks, int16_t low_rpm,
+                                    int16_t high_rpm) -> void {
+    homing_wakeup->arm(ticks, low_rpm, high_rpm);
+}
+
+auto MotorPolicy::homing_wakeup_disarm() -> void { homing_wakeup->disarm(); }
+
+auto MotorPolicy::speed_profile_wakeup_arm(uint16_t ticks) -> void {
+    speed_profile_wakeup->arm(ticks, 0, 0);
+}
+
+auto MotorPolicy::speed_profile_wakeup_disarm() -> void {
+    speed_profile_wakeup->disarm();
+}
+
+auto MotorPolicy::shake_program_wakeup_arm(uint16_t ticks,
+                                           uint32_t generation) -> void {
+    shake_program_wakeup->arm(ticks, 0, 0, generation);
+}
+
+auto MotorPolicy::shake_program_wakeup_disarm() -> void {
+    shake_program_wakeup->disarm();
+}
+
+auto MotorPolicy::plate_lock_timeout_arm(uint16_t ticks) -> void {
+    plate_lock_timeout->arm(ticks, 0, 0);
+}
+
+auto MotorPolicy::plate_lock_timeout_disarm() -> void {
+    plate_lock_timeout->disarm();
+}
+
 // NOLINTNEXTLINE(readability-convert-member-functions-to-static)
 auto MotorPolicy::plate_lock_set_power(float power) -> void {
     motor_hardware_plate_lock_on(&hw_handles->tim3, power);
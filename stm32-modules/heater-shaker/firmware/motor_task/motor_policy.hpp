@@ -3,6 +3,9 @@
 #include <cstdint>
 
 #include "heater-shaker/errors.hpp"
+#include "heater-shaker/loop_timing.hpp"
+#include "heater-shaker/motor_telemetry.hpp"
+#include "heater-shaker/skip_bands.hpp"
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wvolatile"
@@ -12,35 +15,101 @@
 #include "stm32f3xx_hal.h"
 #pragma GCC diagnostic pop
 
+/*
+ * A one-shot wakeup for the motor task, armed by the motor task through its
+ * policy and counted down every tick by the motor control task, which sends
+ * the motor task a message when it fires. It can also fire early once the
+ * motor speed is inside a range. The two tasks run at different
+ * priorities, so it's only touched inside critical sections.
+ */
+class MotorWakeup {
+  public:
+    // The tag is handed back by tick() when the wakeup fires
+    auto arm(uint16_t ticks, int16_t low, int16_t high, uint32_t tag = 0)
+        -> void;
+    auto disarm() -> void;
+    // Count down one tick; true, once, when the wakeup fires
+    auto tick(motor_hardware_handles* handles, uint32_t* fired_tag = nullptr)
+        -> bool;
+
+  private:
+    bool armed = false;
+    uint16_t ticks_left = 0;
+    int16_t low_rpm = 0;
+    int16_t high_rpm = 0;
+    uint32_t tag = 0;
+};
+
 class MotorPolicy {
   public:
     static constexpr int32_t DEFAULT_RAMP_RATE_RPM_PER_S = 1000;
     static constexpr int32_t MAX_RAMP_RATE_RPM_PER_S = 20000;
     static constexpr int32_t MIN_RAMP_RATE_RPM_PER_S = 1;
     MotorPolicy() = delete;
-    explicit MotorPolicy(motor_hardware_handles* handles);
+    MotorPolicy(motor_hardware_handles* handles, MotorWakeup* homing_wakeup,
+                MotorWakeup* plate_lock_timeout,
+                MotorWakeup* speed_profile_wakeup,
+                MotorWakeup* shake_program_wakeup,
+                motor_telemetry::MotorCapture* capture,
+                loop_timing::LoopStats* high_frequency_timing,
+                loop_timing::LoopStats* medium_frequency_timing);
+    [[nodiscard]] static auto current_rpm(motor_hardware_handles* handles)
+        -> int16_t;
     auto set_rpm(int16_t rpm) -> errors::ErrorCode;
+    [[nodiscard]] auto validate_rpm(int16_t rpm) const -> errors::ErrorCode;
+    auto set_rpm_segment(int16_t rpm, uint16_t ramp_ticks)
+        -> errors::ErrorCode;
     auto set_pid_constants(double kp, double ki, double kd) -> void;
     [[nodiscard]] auto get_current_rpm() const -> int16_t;
     [[nodiscard]] auto get_target_rpm() const -> int16_t;
     auto stop() -> void;
     auto set_ramp_rate(int32_t rpm_per_s) -> errors::ErrorCode;
+    [[nodiscard]] auto validate_ramp_rate(int32_t rpm_per_s) const
+        -> errors::ErrorCode;
 
     auto homing_solenoid_disengage() -> void;
     auto homing_solenoid_engage(uint16_t current_ma) -> void;
 
     auto delay_ticks(uint16_t ticks) -> void;
 
+    auto homing_wakeup_arm(uint16_t ticks, int16_t low_rpm, int16_t high_rpm)
+        -> void;
+    auto homing_wakeup_disarm() -> void;
+    auto speed_profile_wakeup_arm(uint16_t ticks) -> void;
+    auto speed_profile_wakeup_disarm() -> void;
+    auto shake_program_wakeup_arm(uint16_t ticks, uint32_t generation)
+        -> void;
+    auto shake_program_wakeup_disarm() -> void;
+    auto plate_lock_timeout_arm(uint16_t ticks) -> void;
+    auto plate_lock_timeout_disarm() -> void;
+
     auto plate_lock_set_power(float power) -> void;
     auto plate_lock_disable() -> void;
     auto plate_lock_brake() -> void;
     auto plate_lock_open_sensor_read() -> bool;
     auto plate_lock_closed_sensor_read() -> bool;
 
+    auto motor_capture() -> motor_telemetry::MotorCapture&;
+    [[nodiscard]] auto get_loop_timing() const -> loop_timing::MotorLoopTiming;
+    auto reset_loop_timing() -> void;
+    [[nodiscard]] auto read_skip_bands() const
+        -> skip_bands::MotorSkipBands::Stored;
+    auto write_skip_bands(const skip_bands::MotorSkipBands::Stored& words)
+        -> bool;
+
   private:
+    auto start_ramp(int16_t rpm, uint16_t ramp_time_ms) -> void;
+
     static constexpr uint16_t MAX_SOLENOID_CURRENT_MA = 330;
     double ramp_rate_rpm_per_ms =
         // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
         static_cast<double>(DEFAULT_RAMP_RATE_RPM_PER_S) / 1000.0;
     motor_hardware_handles* hw_handles;
+    MotorWakeup* homing_wakeup;
+    MotorWakeup* plate_lock_timeout;
+    MotorWakeup* speed_profile_wakeup;
+    MotorWakeup* shake_program_wakeup;
+    motor_telemetry::MotorCapture* capture;
+    loop_timing::LoopStats* high_frequency_timing;
+    loop_timing::LoopStats* medium_frequency_timing;
 };
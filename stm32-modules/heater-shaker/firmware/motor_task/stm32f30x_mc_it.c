@@ -53,7 +53,9 @@ void ADC1_2_IRQHandler(void)
   // Clear Flags M1
   LL_ADC_ClearFlag_JEOS( ADC1 );
 
+  const uint32_t start_cycles = DWT->CYCCNT;
   TSK_HighFrequencyTask();
+  motor_hardware_record_foc_cycles(DWT->CYCCNT - start_cycles);
 }
 
 /**
@@ -83,6 +83,23 @@ def get_temperature(ser: serial.Serial) -> Tuple[float, float]:
     return float(match.group('current')), float(match.group('target'))
 
 
+_THERMISTOR_STATS_RE = re.compile('^M105.S T:(?P<t>.+) N:(?P<n>.+) MIN:(?P<min>.+) MAX:(?P<max>.+) AVG:(?P<mean>.+) VAR:(?P<variance>.+) INV:(?P<invalid>.+) TOT:(?P<total>.+) TINV:(?P<total_invalid>.+) DR:(?P<drift>.+) OK\n')
+# Get the health statistics of one thermistor (0 pad A, 1 pad B, 2 board): the
+# readings in the window and their min, max, mean and variance, the invalid
+# conversions in the window and since boot, and the drift since boot. A window
+# covers only that many of the most recent readings, up to the 64 kept.
+def get_thermistor_stats(ser: serial.Serial, thermistor: int,
+                         window: Optional[int] = None) -> Dict[str, float]:
+    window_arg = f' W{window}' if window else ''
+    ser.write(f'M105.S {thermistor}{window_arg}\n'.encode())
+    res = ser.readline()
+    guard_error(res, b'M105.S')
+    match = re.match(_THERMISTOR_STATS_RE, res.decode())
+    counts = ('n', 'invalid', 'total', 'total_invalid')
+    return {key: (int(value) if key in counts else float(value))
+            for key, value in match.groupdict().items() if key != 't'}
+
+
 def set_speed_pid(ser: serial.Serial,
                   kp: float, ki: float, kd: float):
     print(f'Overriding motor PID constants to kp={kp}, ki={ki}, kd={kd}')
@@ -97,6 +114,33 @@ def set_heater_pid(ser: serial.Serial,
     guard_error(ser.readline(), b'M301')
 
 
+_LOOP_TIMING_RE = re.compile('^M123.D HN:(?P<hn>\\d+) HMIN:(?P<hmin>\\d+) HMAX:(?P<hmax>\\d+) HAVG:(?P<havg>\\d+) HP:(?P<hp>\\d+) HOV:(?P<hov>\\d+) HLD:(?P<hld>.+) MN:(?P<mn>\\d+) MMIN:(?P<mmin>\\d+) MMAX:(?P<mmax>\\d+) MAVG:(?P<mavg>\\d+) MP:(?P<mp>\\d+) MOV:(?P<mov>\\d+) MLD:(?P<mld>.+) OK\n')
+# Get the execution time of the motor control loops in CPU cycles: the FOC
+# current loop (h*) and the control task pass (m*). Each has the passes
+# timed, the min, max and mean pass, the period, the overruns and the mean
+# pass as a percentage of the period. Optionally reset them after reading.
+def get_loop_timing(ser: serial.Serial, reset: bool = False) -> Dict[str, float]:
+    ser.write(('M123.D R\n' if reset else 'M123.D\n').encode())
+    res = ser.readline()
+    guard_error(res, b'M123.D')
+    match = re.match(_LOOP_TIMING_RE, res.decode())
+    return {key: (float(value) if key.endswith('ld') else int(value))
+            for key, value in match.groupdict().items()}
+
+
+_AUTOTUNE_RE = re.compile('^M303 P:(?P<kp>.+) I:(?P<ki>.+) D:(?P<kd>.+) OK\n')
+def autotune_heater_pid(ser: serial.Serial,
+                        target: float) -> Tuple[float, float, float]:
+    # The firmware applies the new constants and only responds once the
+    # tune is over, which can take several minutes
+    print(f'Autotuning heater PID constants around {target}C')
+    ser.write(f'M303 S{target}\n'.encode())
+    res = ser.readline()
+    guard_error(res, b'M303')
+    match = re.match(_AUTOTUNE_RE, res.decode())
+    return float(match.group('kp')), float(match.group('ki')), float(match.group('kd'))
+
+
 def stable(data: List[Tuple[float, float]],
            target: float,
            criterion: float,
@@ -191,6 +235,77 @@ def set_acceleration(ser: serial.Serial, acceleration: float):
     guard_error(res, b'M204')
 
 
+def set_jerk(ser: serial.Serial, jerk: int):
+    print(f'Setting jerk limit to {jerk}RPM/s^2')
+    ser.write(f'M205 J{jerk}\n'.encode())
+    res = ser.readline()
+    guard_error(res, b'M205')
+
+
+def add_shake_segment(ser: serial.Serial, rpm: int, ramp: int, dwell_ms: int,
+                      repeats: int = 0):
+    print(f'Adding shake segment: {rpm}RPM at {ramp}RPM/s for {dwell_ms}ms')
+    ser.write(f'M3.P S{rpm} A{ramp} D{dwell_ms} R{repeats}\n'.encode())
+    res = ser.readline()
+    guard_error(res, b'M3.P')
+
+
+def add_skip_band(ser: serial.Serial, low: int, high: int):
+    print(f'Adding skip band: {low}-{high}RPM')
+    ser.write(f'M3.B L{low} H{high}\n'.encode())
+    res = ser.readline()
+    guard_error(res, b'M3.B')
+
+
+def clear_skip_bands(ser: serial.Serial):
+    print('Clearing skip bands')
+    ser.write('M3.B C\n'.encode())
+    res = ser.readline()
+    guard_error(res, b'M3.B')
+
+
+def get_skip_bands(ser: serial.Serial) -> List[Tuple[int, int]]:
+    ser.write('M3.B\n'.encode())
+    res = ser.readline()
+    guard_error(res, b'M3.B')
+    return [tuple(int(edge) for edge in band.split('-'))
+            for band in res.decode().split()[1:-1]]
+
+
+def run_shake_program(ser: serial.Serial):
+    print('Running shake program')
+    ser.write('M3.S\n'.encode())
+    res = ser.readline()
+    guard_error(res, b'M3.S')
+
+
+def arm_motor_capture(ser: serial.Serial, period_ms: int, post_trigger: int):
+    print(f'Arming motor capture: every {period_ms}ms, {post_trigger} after trigger')
+    ser.write(f'M125.A P{period_ms} N{post_trigger}\n'.encode())
+    res = ser.readline()
+    guard_error(res, b'M125.A')
+
+
+_CAPTURE_RE = re.compile('^M125 S:(?P<status>\\w+) P:(?P<period>\\d+) N:(?P<count>\\d+) T:(?P<trigger>\\d+) I:(?P<start>\\d+) D:(?P<samples>.*)OK\n')
+# Read back a finished motor capture a page at a time. Returns the index of
+# the first sample after the trigger and the samples, oldest first, as
+# (rpm, setpoint rpm, Iq, bus mV); None if the capture isn't done yet.
+def get_motor_capture(ser: serial.Serial) -> Optional[Tuple[int, List[Tuple[int, int, int, int]]]]:
+    samples: List[Tuple[int, int, int, int]] = []
+    while True:
+        ser.write(f'M125 I{len(samples)}\n'.encode())
+        res = ser.readline()
+        guard_error(res, b'M125')
+        match = re.match(_CAPTURE_RE, res.decode())
+        if match.group('status') != 'DONE':
+            return None
+        page = [tuple(int(v) for v in sample.split(','))
+                for sample in match.group('samples').split()]
+        samples.extend(page)
+        if not page or len(samples) >= int(match.group('count')):
+            return int(match.group('trigger')), samples
+
+
 
 
 def plot_data(data: List[Tuple[float, float]], config: RunConfig):
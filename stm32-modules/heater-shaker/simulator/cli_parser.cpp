@@ -3,7 +3,9 @@
 #include <boost/program_options.hpp>
 #include <iostream>
 #include <memory>
+#include <vector>
 
+#include "simulator/sim_clock.hpp"
 #include "simulator/sim_driver.hpp"
 #include "simulator/socket_sim_driver.hpp"
 #include "simulator/stdin_sim_driver.hpp"
@@ -14,7 +16,8 @@ using namespace cli_parser;
     boost::program_options::options_description desc) {
     std::cerr
         << std::endl
-        << "ERROR: You must provide either the --stdin OR the --socket option."
+        << "ERROR: You must provide one of the --stdin, --socket or --listen "
+           "options."
         << std::endl
         << std::endl;
     std::cerr << desc << std::endl;
@@ -24,8 +27,8 @@ using namespace cli_parser;
 [[noreturn]] void both_drivers_specified_error(
     boost::program_options::options_description desc) {
     std::cerr << std::endl
-              << "ERROR: You may only provide either the --stdin OR the "
-                 "--socket option, not both."
+              << "ERROR: You may only provide one of the --stdin, --socket "
+                 "or --listen options."
               << std::endl
               << std::endl;
     std::cerr << desc << std::endl;
@@ -35,16 +38,45 @@ using namespace cli_parser;
 [[noreturn]] void neither_driver_error(
     boost::program_options::options_description desc) {
     std::cerr << std::endl
-              << "ERROR: Neither --socket or --stdin was specified";
+              << "ERROR: None of --socket, --listen or --stdin was specified";
     std::cerr << desc << std::endl;
     exit(1);
 }
 
-std::shared_ptr<sim_driver::SimDriver> cli_parser::get_sim_driver(
-    int num_args, char* args[]) {
+[[noreturn]] void bad_speed_error(
+    boost::program_options::options_description desc) {
+    std::cerr << std::endl
+              << "ERROR: --speed must be more than 0. Use "
+                 "--as-fast-as-possible to run without real time."
+              << std::endl
+              << std::endl;
+    std::cerr << desc << std::endl;
+    exit(1);
+}
+
+[[noreturn]] void bad_fleet_error(
+    boost::program_options::options_description desc) {
+    std::cerr << std::endl
+              << "ERROR: --modules and --workers must be at least 1, and "
+                 "more than one module needs the --socket or --listen option."
+              << std::endl
+              << std::endl;
+    std::cerr << desc << std::endl;
+    exit(1);
+}
+
+SimOptions cli_parser::get_sim_options(int num_args, char* args[]) {
     bool use_stdin = false;
     bool use_socket = false;
+    bool use_listen = false;
     bool options_specified = num_args > 1;
+    double heater_noise_c = 0;
+    double speed = 1;
+    bool afap = false;
+    bool cooperative = false;
+    uint32_t seed = 0;
+    uint32_t modules = 1;
+    uint32_t workers = 1;
 
     boost::program_options::options_description desc("Allowed options");
     desc.add_options()("help", "Show this help message")(
@@ -52,7 +84,30 @@ std::shared_ptr<sim_driver::SimDriver> cli_parser::get_sim_driver(
         "Use stdin to provide G-Codes")("socket",
                                         boost::program_options::value<
                                             std::string>(),
-                                        "Use socket to provide G-Codes");
+                                        "Use socket to provide G-Codes")(
+        "listen", boost::program_options::value<int>(),
+        "Listen on this port for a client to provide G-Codes, one at a time")(
+        "heater-noise",
+        boost::program_options::value<double>(&heater_noise_c),
+        "Standard deviation of the noise on simulated heater thermistor "
+        "readings, in degrees C")(
+        "speed", boost::program_options::value<double>(&speed),
+        "Run the simulator clock this many times faster than real time")(
+        "as-fast-as-possible", boost::program_options::bool_switch(&afap),
+        "Run the simulator clock as fast as possible, jumping ahead whenever "
+        "every task is waiting")(
+        "cooperative", boost::program_options::bool_switch(&cooperative),
+        "Run every task on one thread, stepping whichever is ready in an "
+        "order picked from --seed, instead of each on its own thread")(
+        "seed", boost::program_options::value<uint32_t>(&seed),
+        "Seed for the order --cooperative steps ready tasks in")(
+        "modules", boost::program_options::value<uint32_t>(&modules),
+        "Simulate this many modules, the first on the --socket or --listen "
+        "port and each after it on the next port up. Implies "
+        "--cooperative")(
+        "workers", boost::program_options::value<uint32_t>(&workers),
+        "Share out the modules between this many scheduler threads. "
+        "Implies --cooperative");
 
     boost::program_options::variables_map vm;
     /*
@@ -75,18 +130,56 @@ std::shared_ptr<sim_driver::SimDriver> cli_parser::get_sim_driver(
     if (vm.count("socket")) {
         use_socket = true;
     }
+    if (vm.count("listen")) {
+        use_listen = true;
+    }
     if (num_args <= 1) {
         no_options_specified_error(desc);
     }
-    if (use_stdin && use_socket) {
+    if ((use_stdin + use_socket + use_listen) > 1) {
         both_drivers_specified_error(desc);
     }
+    if ((modules == 0) || (workers == 0) || ((modules > 1) && use_stdin)) {
+        bad_fleet_error(desc);
+    }
+    if ((modules > 1) || (workers > 1)) {
+        cooperative = true;
+    }
+    if (afap) {
+        speed = sim_clock::SimClock::AS_FAST_AS_POSSIBLE;
+    } else if (speed <= 0) {
+        bad_speed_error(desc);
+    }
 
     if (use_stdin) {
-        return std::make_shared<stdin_sim_driver::StdinSimDriver>();
-    } else if (use_socket) {
-        return std::make_shared<socket_sim_driver::SocketSimDriver>(
-            vm["socket"].as<std::string>());
+        return SimOptions{
+            .drivers = {std::make_shared<stdin_sim_driver::StdinSimDriver>()},
+            .heater_noise_c = heater_noise_c,
+            .speed = speed,
+            .cooperative = cooperative,
+            .seed = seed,
+            .workers = workers};
+    } else if (use_socket || use_listen) {
+        auto drivers = std::vector<std::shared_ptr<sim_driver::SimDriver>>();
+        for (uint32_t module = 0; module < modules; ++module) {
+            if (use_listen) {
+                drivers.push_back(
+                    std::make_shared<socket_sim_driver::SocketSimDriver>(
+                        socket_sim_driver::Listen{vm["listen"].as<int>()},
+                        module));
+            } else {
+                drivers.push_back(
+                    std::make_shared<socket_sim_driver::SocketSimDriver>(
+                        vm["socket"].as<std::string>(), module));
+            }
+        }
+        return SimOptions{
+            .drivers = std::move(drivers),
+            .heater_noise_c = heater_noise_c,
+            .speed = speed,
+            .cooperative = cooperative,
+            .seed = seed,
+            .workers = workers};
     } else {
         neither_driver_error(desc);
     }
@@ -29,6 +29,7 @@ auto run(std::stop_token st, std::shared_ptr<TaskControlBlock> tcb,
         try {
             auto wrote_to = tcb->task.run_once(buffer.begin(), buffer.end());
             driver->write(std::string(buffer.begin(), wrote_to));
+            driver->comms_finished();
         } catch (const SimCommTask::Queue::StopDuringMsgWait sdmw) {
             return;
         }
@@ -42,6 +43,22 @@ auto comm_thread::build(std::shared_ptr<sim_driver::SimDriver>&& driver)
                        &tcb->task};
 }
 
+auto comm_thread::build(std::shared_ptr<sim_driver::SimDriver>&& driver,
+                        scheduler::Scheduler& scheduler)
+    -> tasks::Task<std::unique_ptr<std::jthread>, comm_thread::SimCommTask> {
+    auto tcb = std::make_shared<TaskControlBlock>();
+    auto buffer = std::make_shared<std::string>(1024, 'c');
+    tcb->queue.set_cooperative();
+    scheduler.add_task(
+        [tcb]() { return tcb->queue.has_message(); },
+        [tcb, buffer, driver]() {
+            auto wrote_to = tcb->task.run_once(buffer->begin(), buffer->end());
+            driver->write(std::string(buffer->begin(), wrote_to));
+            driver->comms_finished();
+        });
+    return tasks::Task{std::unique_ptr<std::jthread>(), &tcb->task};
+}
+
 void comm_thread::handle_input(std::shared_ptr<sim_driver::SimDriver>&& driver,
                                tasks::Tasks<SimulatorMessageQueue>& tasks) {
     driver->read(tasks);
@@ -1,7 +1,10 @@
 #include "simulator/heater_thread.hpp"
 
+#include <chrono>
 #include <cstdint>
 #include <memory>
+#include <mutex>
+#include <random>
 #include <stop_token>
 #include <thread>
 
@@ -9,64 +12,138 @@
 #include "heater-shaker/heater_task.hpp"
 #include "heater-shaker/messages.hpp"
 #include "heater-shaker/tasks.hpp"
+#include "simulator/heater_model.hpp"
+#include "simulator/sim_clock.hpp"
 #include "thermistor_lookups.hpp"
 
+using namespace heater_thread;
+
+// The plate model, shared between the task's policy, which sets its power,
+// and the acquisition thread, which steps it and reads the thermistors
+class SimPlate {
+  public:
+    explicit SimPlate(double noise_c)
+        : model(SimHeaterTask::CONTROL_PERIOD_S),
+          converter(SimHeaterTask::THERMISTOR_CIRCUIT_BIAS_RESISTANCE_KOHM,
+                    SimHeaterTask::ADC_BIT_DEPTH),
+          noise_c(noise_c) {}
+
+    auto set_power(double power) -> void {
+        auto lock = std::lock_guard(mutex);
+        model.set_power(power);
+    }
+
+    auto step() -> messages::TemperatureConversionComplete {
+        auto lock = std::lock_guard(mutex);
+        model.step();
+        return messages::TemperatureConversionComplete{
+            .pad_a = converter.backconvert(model.plate_c() + noise()),
+            .pad_b = converter.backconvert(model.plate_c() + noise()),
+            .board = converter.backconvert(model.board_c() + noise())};
+    }
+
+  private:
+    auto noise() -> double {
+        if (noise_c <= 0) {
+            return 0;
+        }
+        return std::normal_distribution<double>(0, noise_c)(generator);
+    }
+
+    std::mutex mutex{};
+    heater_model::PlateModel model;
+    thermistor_conversion::Conversion<lookups::NTCG104ED104DTDSX> converter;
+    double noise_c;
+    // Fixed seed, so runs with noise are repeatable
+    std::mt19937 generator{};
+};
+
 struct SimHeaterPolicy {
+    explicit SimHeaterPolicy(std::shared_ptr<SimPlate> plate)
+        : plate(std::move(plate)) {}
     [[nodiscard]] auto power_good() const -> bool { return true; }
     [[nodiscard]] auto try_reset_power_good() -> bool { return true; };
     auto set_power_output(double relative_power) -> void {
         power = relative_power;
+        plate->set_power(power);
     };
-    auto disable_power_output() -> void { power = 0; }
+    auto disable_power_output() -> void {
+        power = 0;
+        plate->set_power(power);
+    }
 
   private:
+    std::shared_ptr<SimPlate> plate;
     double power = 0;
 };
 
 struct heater_thread::TaskControlBlock {
-    TaskControlBlock()
-        : queue(SimHeaterTask::Queue()), task(SimHeaterTask(queue)) {}
+    explicit TaskControlBlock(double noise_c)
+        : queue(SimHeaterTask::Queue()),
+          task(SimHeaterTask(queue)),
+          plate(std::make_shared<SimPlate>(noise_c)) {}
     SimHeaterTask::Queue queue;
     SimHeaterTask task;
+    std::shared_ptr<SimPlate> plate;
 };
 
+// Stands in for the ADC: steps the plate once every control period and
+// sends the task the readings
+auto acquire_once(const std::shared_ptr<heater_thread::TaskControlBlock>& tcb)
+    -> void {
+    static_cast<void>(
+        tcb->queue.try_send(messages::HeaterMessage(tcb->plate->step())));
+}
+
+auto acquire(std::stop_token st,
+             std::shared_ptr<heater_thread::TaskControlBlock> tcb) -> void {
+    auto& clock = sim_clock::clock();
+    const auto period =
+        std::chrono::milliseconds(SimHeaterTask::CONTROL_PERIOD_TICKS);
+    auto next = clock.now();
+    while (true) {
+        next += period;
+        clock.sleep_until(next, st);
+        if (st.stop_requested()) {
+            break;
+        }
+        acquire_once(tcb);
+    }
+    clock.remove_participant();
+}
+
 auto run(std::stop_token st,
          std::shared_ptr<heater_thread::TaskControlBlock> tcb) -> void {
-    auto policy = SimHeaterPolicy();
-    auto converter = thermistor_conversion::Conversion<
-        lookups::NTCG104ED104DTDSX>(
-        heater_thread::SimHeaterTask::THERMISTOR_CIRCUIT_BIAS_RESISTANCE_KOHM,
-        heater_thread::SimHeaterTask::ADC_BIT_DEPTH);
+    auto policy = SimHeaterPolicy(tcb->plate);
     tcb->queue.set_stop_token(st);
-    auto conversion_message = messages::TemperatureConversionComplete{
-        .pad_a = converter.backconvert(25.0),
-        .pad_b = converter.backconvert(25.0),
-        .board = converter.backconvert(30),
-    };
-    tcb->queue.get_backing_queue().push(
-        messages::HeaterMessage(conversion_message));
+    // Stopped and joined when this returns
+    sim_clock::clock().add_participant();
+    auto acquisition = std::jthread(acquire, tcb);
     while (!st.stop_requested()) {
-        auto last_setpoint = tcb->task.get_setpoint();
         try {
             tcb->task.run_once(policy);
         } catch (const heater_thread::SimHeaterTask::Queue::StopDuringMsgWait&
                      sdmw) {
             return;
         }
-        auto new_setpoint = tcb->task.get_setpoint();
-        if (last_setpoint != new_setpoint) {
-            auto conversion_message = messages::TemperatureConversionComplete{
-                .pad_a = converter.backconvert(tcb->task.get_setpoint()),
-                .pad_b = converter.backconvert(tcb->task.get_setpoint()),
-                .board = converter.backconvert(30)};
-            tcb->queue.get_backing_queue().push(
-                messages::HeaterMessage(conversion_message));
-        }
     }
 }
 
-auto heater_thread::build()
+auto heater_thread::build(double noise_c)
     -> tasks::Task<std::unique_ptr<std::jthread>, SimHeaterTask> {
-    auto tcb = std::make_shared<TaskControlBlock>();
+    auto tcb = std::make_shared<TaskControlBlock>(noise_c);
     return tasks::Task(std::make_unique<std::jthread>(run, tcb), &tcb->task);
 }
+
+auto heater_thread::build(scheduler::Scheduler& scheduler, double noise_c)
+    -> tasks::Task<std::unique_ptr<std::jthread>, SimHeaterTask> {
+    auto tcb = std::make_shared<TaskControlBlock>(noise_c);
+    auto policy = std::make_shared<SimHeaterPolicy>(tcb->plate);
+    tcb->queue.set_cooperative();
+    scheduler.add_task([tcb]() { return tcb->queue.has_message(); },
+                       [tcb, policy]() { tcb->task.run_once(*policy); });
+    scheduler.add_periodic(
+        std::chrono::milliseconds(SimHeaterTask::CONTROL_PERIOD_TICKS),
+        [tcb]() { acquire_once(tcb); });
+    return tasks::Task(std::unique_ptr<std::jthread>(), &tcb->task);
+}
@@ -1,13 +1,21 @@
 #include "simulator/motor_thread.hpp"
 
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <stop_token>
 #include <thread>
 
 #include "heater-shaker/errors.hpp"
+#include "heater-shaker/loop_timing.hpp"
 #include "heater-shaker/motor_task.hpp"
+#include "heater-shaker/motor_telemetry.hpp"
+#include "heater-shaker/skip_bands.hpp"
 #include "heater-shaker/tasks.hpp"
+#include "simulator/sim_clock.hpp"
 
 using namespace motor_thread;
 
@@ -16,11 +24,23 @@ struct SimMotorPolicy {
     static constexpr int32_t MAX_RAMP_RATE_RPM_PER_S = 20000;
     static constexpr int32_t MIN_RAMP_RATE_RPM_PER_S = 1;
 
+    explicit SimMotorPolicy(SimMotorTask::Queue* queue) : queue(queue) {}
+
     auto set_rpm(int16_t rpm) -> errors::ErrorCode {
         rpm_setpoint = rpm;
         rpm_current = rpm;
+        capture_sample();
         return errors::ErrorCode::NO_ERROR;
     };
+    [[nodiscard]] auto validate_rpm(int16_t rpm) const -> errors::ErrorCode {
+        static_cast<void>(rpm);
+        return errors::ErrorCode::NO_ERROR;
+    }
+    auto set_rpm_segment(int16_t rpm, uint16_t ramp_ticks)
+        -> errors::ErrorCode {
+        static_cast<void>(ramp_ticks);
+        return set_rpm(rpm);
+    }
     [[nodiscard]] auto get_current_rpm() const -> int16_t {
         return rpm_current;
     }
@@ -36,6 +56,30 @@ struct SimMotorPolicy {
     auto stop() -> void {
         rpm_setpoint = 0;
         rpm_current = 0;
+        capture_sample();
+    }
+
+    auto motor_capture() -> motor_telemetry::MotorCapture& { return capture; }
+
+    // Nothing in the simulator runs on a deadline
+    [[nodiscard]] auto get_loop_timing() const
+        -> loop_timing::MotorLoopTiming {
+        return loop_timing::MotorLoopTiming{};
+    }
+
+    auto reset_loop_timing() -> void {}
+
+    // There's no flash in the simulator, so skip bands last as long as the
+    // process does
+    [[nodiscard]] auto read_skip_bands() const
+        -> skip_bands::MotorSkipBands::Stored {
+        return stored_skip_bands;
+    }
+
+    auto write_skip_bands(const skip_bands::MotorSkipBands::Stored& words)
+        -> bool {
+        stored_skip_bands = words;
+        return true;
     }
 
     auto set_ramp_rate(int32_t rpm_per_s) -> errors::ErrorCode {
@@ -43,6 +87,12 @@ struct SimMotorPolicy {
         return errors::ErrorCode::NO_ERROR;
     }
 
+    [[nodiscard]] auto validate_ramp_rate(int32_t rpm_per_s) const
+        -> errors::ErrorCode {
+        static_cast<void>(rpm_per_s);
+        return errors::ErrorCode::NO_ERROR;
+    }
+
     auto homing_solenoid_disengage() const -> void {}
 
     auto homing_solenoid_engage(uint16_t current_ma) const -> void {
@@ -51,6 +101,51 @@ struct SimMotorPolicy {
 
     auto delay_ticks(uint16_t ticks) -> void { static_cast<void>(ticks); }
 
+    // The simulated motor reaches its target speed at once, so the speed
+    // is always in range when a homing wakeup goes off
+    auto homing_wakeup_arm(uint16_t ticks, int16_t low_rpm, int16_t high_rpm)
+        -> void {
+        static_cast<void>(low_rpm);
+        static_cast<void>(high_rpm);
+        arm(HOMING, ticks, messages::CheckHomingStatusMessage{});
+    }
+
+    auto homing_wakeup_disarm() -> void { disarm(HOMING); }
+
+    auto speed_profile_wakeup_arm(uint16_t ticks) -> void {
+        arm(SPEED_PROFILE, ticks, messages::SpeedProfileStepMessage{});
+    }
+
+    auto speed_profile_wakeup_disarm() -> void { disarm(SPEED_PROFILE); }
+
+    auto shake_program_wakeup_arm(uint16_t ticks, uint32_t generation)
+        -> void {
+        arm(SHAKE_PROGRAM, ticks,
+            messages::ShakeProgramStepMessage{.generation = generation});
+    }
+
+    auto shake_program_wakeup_disarm() -> void { disarm(SHAKE_PROGRAM); }
+
+    /** When the next armed wakeup is due on the simulator clock.*/
+    [[nodiscard]] auto next_wakeup() const -> sim_clock::SimClock::duration {
+        auto next = sim_clock::SimClock::FOREVER;
+        for (const auto& wakeup : wakeups) {
+            next = std::min(next, wakeup.due);
+        }
+        return next;
+    }
+
+    /** Send the task the message of every wakeup that's due.*/
+    auto fire_wakeups() -> void {
+        const auto now = sim_clock::clock().now();
+        for (auto& wakeup : wakeups) {
+            if (wakeup.due <= now) {
+                wakeup.due = sim_clock::SimClock::FOREVER;
+                static_cast<void>(queue->try_send(wakeup.message));
+            }
+        }
+    }
+
     auto plate_lock_set_power(float power) -> void {
         sim_plate_lock_power = power;
         sim_plate_lock_enabled = true;
@@ -73,6 +168,17 @@ struct SimMotorPolicy {
 
     auto plate_lock_braked() const -> bool { return sim_plate_lock_braked; }
 
+    // The simulated plate lock gets where it's going at once, so the limit
+    // switch for the direction it was driven trips as soon as a move starts
+    auto plate_lock_timeout_arm(uint16_t ticks) -> void {
+        static_cast<void>(ticks);
+        static_cast<void>(queue->try_send(messages::PlateLockComplete{
+            .open = (sim_plate_lock_power < 0.0),
+            .closed = (sim_plate_lock_power > 0.0)}));
+    }
+
+    auto plate_lock_timeout_disarm() -> void {}
+
     auto plate_lock_open_sensor_read() const -> bool {
         if (!sim_plate_lock_braked) {
             return false;
@@ -90,12 +196,50 @@ struct SimMotorPolicy {
     }
 
   private:
+    // The firmware's wakeups are timers that post a message to the task once
+    // they run out; here they run out on the simulator clock
+    enum WakeupId : size_t {
+        HOMING = 0,
+        SPEED_PROFILE = 1,
+        SHAKE_PROGRAM = 2,
+        WAKEUP_COUNT = 3,
+    };
+    struct Wakeup {
+        sim_clock::SimClock::duration due = sim_clock::SimClock::FOREVER;
+        messages::MotorMessage message{};
+    };
+
+    auto arm(WakeupId id, uint16_t ticks, const messages::MotorMessage& message)
+        -> void {
+        wakeups.at(id) = Wakeup{
+            .due = sim_clock::clock().now() + std::chrono::milliseconds(ticks),
+            .message = message};
+    }
+
+    auto disarm(WakeupId id) -> void {
+        wakeups.at(id).due = sim_clock::SimClock::FOREVER;
+    }
+
+    // There's no control loop ticking in the simulator, and the speed only
+    // changes when it's commanded to, so record a sample on every change
+    auto capture_sample() -> void {
+        capture.record(motor_telemetry::Sample{.rpm = rpm_current,
+                                               .setpoint_rpm = rpm_setpoint,
+                                               .iq = 0,
+                                               .bus_mv = SIM_BUS_MV});
+    }
+
+    static constexpr uint16_t SIM_BUS_MV = 24000;
+    SimMotorTask::Queue* queue;
     int16_t rpm_setpoint = 0;
     int16_t rpm_current = 0;
     int32_t ramp_rate = DEFAULT_RAMP_RATE_RPM_PER_S;
     float sim_plate_lock_power = 0;
     bool sim_plate_lock_enabled = false;
     bool sim_plate_lock_braked = false;
+    motor_telemetry::MotorCapture capture{};
+    skip_bands::MotorSkipBands::Stored stored_skip_bands{};
+    std::array<Wakeup, WAKEUP_COUNT> wakeups{};
 };
 
 struct motor_thread::TaskControlBlock {
@@ -105,10 +249,21 @@ struct motor_thread::TaskControlBlock {
     SimMotorTask task;
 };
 
+// Only run the task once it has a message, so that waiting for one can be
+// cut short by a wakeup coming due
 auto run(std::stop_token st, std::shared_ptr<TaskControlBlock> tcb) -> void {
-    auto policy = SimMotorPolicy();
+    auto policy = SimMotorPolicy(&tcb->queue);
+    const std::function<bool()> has_message = [&tcb]() {
+        return tcb->queue.has_message();
+    };
     tcb->queue.set_stop_token(st);
     while (!st.stop_requested()) {
+        policy.fire_wakeups();
+        if (!tcb->queue.has_message()) {
+            static_cast<void>(sim_clock::clock().wait_until(
+                policy.next_wakeup(), has_message, st));
+            continue;
+        }
         try {
             tcb->task.run_once(policy);
         } catch (const SimMotorTask::Queue::StopDuringMsgWait& sdmw) {
@@ -122,3 +277,15 @@ auto motor_thread::build()
     auto tcb = std::make_shared<TaskControlBlock>();
     return tasks::Task{std::make_unique<std::jthread>(run, tcb), &tcb->task};
 }
+
+auto motor_thread::build(scheduler::Scheduler& scheduler)
+    -> tasks::Task<std::unique_ptr<std::jthread>, SimMotorTask> {
+    auto tcb = std::make_shared<TaskControlBlock>();
+    auto policy = std::make_shared<SimMotorPolicy>(&tcb->queue);
+    tcb->queue.set_cooperative();
+    scheduler.add_task([tcb]() { return tcb->queue.has_message(); },
+                       [tcb, policy]() { tcb->task.run_once(*policy); });
+    scheduler.add_timer([policy]() { return policy->next_wakeup(); },
+                        [policy]() { policy->fire_wakeups(); });
+    return tasks::Task{std::unique_ptr<std::jthread>(), &tcb->task};
+}
@@ -84,3 +84,13 @@ auto system_thread::build()
     auto tcb = std::make_shared<TaskControlBlock>();
     return tasks::Task(std::make_unique<std::jthread>(run, tcb), &tcb->task);
 }
+
+auto system_thread::build(scheduler::Scheduler& scheduler)
+    -> tasks::Task<std::unique_ptr<std::jthread>, SimSystemTask> {
+    auto tcb = std::make_shared<TaskControlBlock>();
+    auto policy = std::make_shared<SimSystemPolicy>();
+    tcb->queue.set_cooperative();
+    scheduler.add_task([tcb]() { return tcb->queue.has_message(); },
+                       [tcb, policy]() { tcb->task.run_once(*policy); });
+    return tasks::Task(std::unique_ptr<std::jthread>(), &tcb->task);
+}
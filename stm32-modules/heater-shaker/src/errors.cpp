@@ -31,6 +31,24 @@ const char* const MOTOR_NOT_STOPPED =
 const char* const PLATE_LOCK_TIMEOUT = "ERR125:plate lock:timeout\n";
 const char* const PLATE_LOCK_NOT_CLOSED =
     "ERR126:main motor:plate lock not closed (required)\n";
+const char* const MOTOR_ILLEGAL_JERK = "ERR127:main motor:illegal jerk\n";
+const char* const MOTOR_PROGRAM_FULL = "ERR128:main motor:shake program full\n";
+const char* const MOTOR_PROGRAM_EMPTY =
+    "ERR129:main motor:shake program empty\n";
+const char* const MOTOR_BAD_CAPTURE_SETTINGS =
+    "ERR130:main motor:bad capture settings\n";
+const char* const MOTOR_CAPTURE_NOT_ARMED =
+    "ERR131:main motor:capture not armed\n";
+const char* const MOTOR_RPM_IN_SKIP_BAND =
+    "ERR132:main motor:speed is inside a skip band\n";
+const char* const MOTOR_ILLEGAL_SKIP_BAND =
+    "ERR133:main motor:illegal skip band\n";
+const char* const MOTOR_SKIP_BANDS_FULL =
+    "ERR134:main motor:skip band table full\n";
+const char* const MOTOR_SKIP_BANDS_NOT_SAVED =
+    "ERR135:main motor:could not save skip bands\n";
+const char* const PLATE_LOCK_MOVE_SUPERSEDED =
+    "ERR136:plate lock:move superseded by another\n";
 const char* const HEATER_THERMISTOR_A_DISCONNECTED =
     "ERR201:heater:thermistor a disconnected\n";
 const char* const HEATER_THERMISTOR_A_SHORT =
@@ -53,6 +71,14 @@ const char* const HEATER_HARDWARE_ERROR_LATCH =
     "ERR211:heater:hardware error latch set\n";
 const char* const HEATER_CONSTANT_OUT_OF_RANGE =
     "ERR212:heater:control constant out of range\n";
+const char* const HEATER_AUTOTUNE_FAILED =
+    "ERR213:heater:PID autotune did not converge\n";
+const char* const HEATER_THERMISTOR_MISMATCH =
+    "ERR214:heater:pad thermistors a and b disagree\n";
+const char* const HEATER_THERMAL_RUNAWAY =
+    "ERR215:heater:temperature rising without heater power\n";
+const char* const HEATER_NO_RESPONSE =
+    "ERR216:heater:temperature not following heater power\n";
 const char* const SYSTEM_SERIAL_NUMBER_INVALID =
     "ERR301:system:serial number invalid format\n";
 const char* const SYSTEM_SERIAL_NUMBER_HAL_ERROR =
@@ -95,6 +121,16 @@ auto errors::errorstring(ErrorCode code) -> const char* {
         HANDLE_CASE(MOTOR_NOT_STOPPED);
         HANDLE_CASE(PLATE_LOCK_TIMEOUT);
         HANDLE_CASE(PLATE_LOCK_NOT_CLOSED);
+        HANDLE_CASE(MOTOR_ILLEGAL_JERK);
+        HANDLE_CASE(MOTOR_PROGRAM_FULL);
+        HANDLE_CASE(MOTOR_PROGRAM_EMPTY);
+        HANDLE_CASE(MOTOR_BAD_CAPTURE_SETTINGS);
+        HANDLE_CASE(MOTOR_CAPTURE_NOT_ARMED);
+        HANDLE_CASE(MOTOR_RPM_IN_SKIP_BAND);
+        HANDLE_CASE(MOTOR_ILLEGAL_SKIP_BAND);
+        HANDLE_CASE(MOTOR_SKIP_BANDS_FULL);
+        HANDLE_CASE(MOTOR_SKIP_BANDS_NOT_SAVED);
+        HANDLE_CASE(PLATE_LOCK_MOVE_SUPERSEDED);
         HANDLE_CASE(HEATER_THERMISTOR_A_DISCONNECTED);
         HANDLE_CASE(HEATER_THERMISTOR_A_SHORT);
         HANDLE_CASE(HEATER_THERMISTOR_A_OVERTEMP);
@@ -106,6 +142,10 @@ auto errors::errorstring(ErrorCode code) -> const char* {
         HANDLE_CASE(HEATER_THERMISTOR_BOARD_DISCONNECTED);
         HANDLE_CASE(HEATER_HARDWARE_ERROR_LATCH);
         HANDLE_CASE(HEATER_CONSTANT_OUT_OF_RANGE);
+        HANDLE_CASE(HEATER_AUTOTUNE_FAILED);
+        HANDLE_CASE(HEATER_THERMISTOR_MISMATCH);
+        HANDLE_CASE(HEATER_THERMAL_RUNAWAY);
+        HANDLE_CASE(HEATER_NO_RESPONSE);
         HANDLE_CASE(SYSTEM_SERIAL_NUMBER_INVALID);
         HANDLE_CASE(SYSTEM_SERIAL_NUMBER_HAL_ERROR);
         HANDLE_CASE(SYSTEM_LED_I2C_NOT_READY);
@@ -18,3 +18,40 @@ TaskBuilder::TaskBuilder()
 auto TaskBuilder::build() -> std::shared_ptr<TaskBuilder> {
     return std::shared_ptr<TaskBuilder>(new TaskBuilder());
 }
+
+auto TaskBuilder::fire_homing_wakeup() -> bool {
+    if (!motor_policy.test_homing_wakeup_armed()) {
+        return false;
+    }
+    motor_policy.homing_wakeup_disarm();
+    motor_queue.backing_deque.push_back(messages::CheckHomingStatusMessage{});
+    return true;
+}
+
+auto TaskBuilder::fire_plate_lock_timeout() -> bool {
+    if (!motor_policy.test_plate_lock_timeout_armed()) {
+        return false;
+    }
+    motor_policy.plate_lock_timeout_disarm();
+    motor_queue.backing_deque.push_back(messages::PlateLockTimeoutMessage{});
+    return true;
+}
+
+auto TaskBuilder::fire_shake_program_wakeup() -> bool {
+    if (!motor_policy.test_shake_program_wakeup_armed()) {
+        return false;
+    }
+    motor_policy.shake_program_wakeup_disarm();
+    motor_queue.backing_deque.push_back(messages::ShakeProgramStepMessage{
+        .generation = motor_policy.test_shake_program_wakeup_generation()});
+    return true;
+}
+
+auto TaskBuilder::fire_speed_profile_wakeup() -> bool {
+    if (!motor_policy.test_speed_profile_wakeup_armed()) {
+        return false;
+    }
+    motor_policy.speed_profile_wakeup_disarm();
+    motor_queue.backing_deque.push_back(messages::SpeedProfileStepMessage{});
+    return true;
+}
@@ -0,0 +1,81 @@
+#include "catch2/catch.hpp"
+#include "simulator/heater_model.hpp"
+
+using namespace heater_model;
+
+namespace {
+constexpr double step_s = 0.1;
+
+auto run_for(PlateModel& model, double seconds) -> void {
+    const auto steps = static_cast<int>(seconds / step_s + 0.5);
+    for (int i = 0; i < steps; ++i) {
+        model.step();
+    }
+}
+}  // namespace
+
+SCENARIO("heater plate model") {
+    auto model = PlateModel(step_s);
+    GIVEN("a model with the heater off") {
+        run_for(model, 60);
+        THEN("the plate and board stay at ambient") {
+            REQUIRE(model.plate_c() == Approx(PlateModel::AMBIENT_C));
+            REQUIRE(model.board_c() == Approx(PlateModel::AMBIENT_C));
+            REQUIRE(model.elapsed_s() == Approx(60));
+        }
+    }
+
+    GIVEN("the heater at full power") {
+        model.set_power(1.0);
+        WHEN("less than the dead time has passed") {
+            run_for(model, PlateModel::PLATE_DEAD_TIME_S - 1);
+            THEN("the plate hasn't moved but the board has") {
+                REQUIRE(model.plate_c() == Approx(PlateModel::AMBIENT_C));
+                REQUIRE(model.board_c() > PlateModel::AMBIENT_C);
+            }
+        }
+        WHEN("some time after the dead time") {
+            run_for(model, PlateModel::PLATE_DEAD_TIME_S + 10);
+            THEN("the plate is warming") {
+                REQUIRE(model.plate_c() > PlateModel::AMBIENT_C + 2);
+            }
+        }
+        WHEN("heating to 95C") {
+            double seconds = 0;
+            while (model.plate_c() < 95.0 && seconds < 3600) {
+                model.step();
+                seconds += step_s;
+            }
+            THEN("it takes minutes, like the real plate") {
+                REQUIRE(seconds > 300);
+                REQUIRE(seconds < 600);
+            }
+        }
+        WHEN("holding it for a long time") {
+            run_for(model, 10 * PlateModel::PLATE_TIME_CONSTANT_S);
+            THEN("the plate and board settle at their gains") {
+                REQUIRE(model.plate_c() ==
+                        Approx(PlateModel::AMBIENT_C +
+                               PlateModel::PLATE_GAIN_C)
+                            .margin(0.1));
+                REQUIRE(model.board_c() ==
+                        Approx(PlateModel::AMBIENT_C +
+                               PlateModel::BOARD_GAIN_C)
+                            .margin(0.1));
+            }
+            AND_WHEN("turning it off for less than the dead time") {
+                auto hot_c = model.plate_c();
+                model.set_power(0);
+                run_for(model, PlateModel::PLATE_DEAD_TIME_S - 1);
+                THEN("the plate is still held up") {
+                    REQUIRE(model.plate_c() == Approx(hot_c));
+                }
+            }
+        }
+    }
+
+    GIVEN("out of range power") {
+        model.set_power(2.0);
+        THEN("it is clamped") { REQUIRE(model.power() == 1.0); }
+    }
+}
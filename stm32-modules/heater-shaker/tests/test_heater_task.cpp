@@ -1,8 +1,13 @@
+#include <algorithm>
+
 #include "catch2/catch.hpp"
 #include "core/pid.hpp"
+#include "core/thermistor_conversion.hpp"
 #include "heater-shaker/heater_task.hpp"
 #include "heater-shaker/messages.hpp"
+#include "heater-shaker/power_budget.hpp"
 #include "test/task_builder.hpp"
+#include "thermistor_lookups.hpp"
 
 SCENARIO("heater task message passing") {
     GIVEN("a heater task with valid temps") {
@@ -162,6 +167,97 @@ SCENARIO("heater task message passing") {
                 }
             }
         }
+        WHEN("sending a set-temperature message as if from a shake program") {
+            auto message = messages::SetTemperatureMessage{
+                .id = 0, .target_temperature = 45, .from_motor = true};
+            tasks->get_heater_queue().backing_deque.push_back(
+                messages::HeaterMessage(message));
+            tasks->run_heater_task();
+            THEN("the task should respond to the motor task") {
+                REQUIRE(!tasks->get_motor_queue().backing_deque.empty());
+                auto ack = std::get<messages::AcknowledgePrevious>(
+                    tasks->get_motor_queue().backing_deque.front());
+                REQUIRE(ack.with_error == errors::ErrorCode::NO_ERROR);
+            }
+        }
+        WHEN("sending an autotune message") {
+            auto message =
+                messages::StartAutotuneMessage{.id = 303, .setpoint = 95};
+            tasks->get_heater_queue().backing_deque.push_back(message);
+            tasks->run_heater_task();
+            tasks->get_heater_queue().backing_deque.push_back(read_message);
+            tasks->run_heater_task();
+            THEN("the task drives the relay high and holds the response") {
+                REQUIRE(tasks->get_heater_queue().backing_deque.empty());
+                REQUIRE(tasks->get_heater_policy().last_enable_setting());
+                REQUIRE(tasks->get_heater_policy().last_power_setting() == 1.0);
+                REQUIRE(tasks->get_host_comms_queue().backing_deque.empty());
+            }
+            AND_WHEN("sending a set-temperature message during the tune") {
+                auto settemp = messages::SetTemperatureMessage{
+                    .id = 1, .target_temperature = 40};
+                tasks->get_heater_queue().backing_deque.push_back(settemp);
+                tasks->run_heater_task();
+                THEN("the tune fails and then the set-temp is acknowledged") {
+                    auto& comms = tasks->get_host_comms_queue().backing_deque;
+                    REQUIRE(comms.size() == 2);
+                    auto tune_response =
+                        std::get<messages::AutotuneResultResponse>(
+                            comms.front());
+                    REQUIRE(tune_response.responding_to_id == 303);
+                    REQUIRE(tune_response.with_error ==
+                            errors::ErrorCode::HEATER_AUTOTUNE_FAILED);
+                    auto ack =
+                        std::get<messages::AcknowledgePrevious>(comms.back());
+                    REQUIRE(ack.responding_to_id == 1);
+                    REQUIRE(ack.with_error == errors::ErrorCode::NO_ERROR);
+                }
+            }
+            AND_WHEN("sending new PID constants during the tune") {
+                tasks->get_heater_queue().backing_deque.push_back(
+                    messages::SetPIDConstantsMessage{
+                        .id = 2, .kp = 1, .ki = 0.1, .kd = 0.01});
+                tasks->run_heater_task();
+                THEN("the tune fails and then the constants are acknowledged") {
+                    auto& comms = tasks->get_host_comms_queue().backing_deque;
+                    REQUIRE(comms.size() == 2);
+                    auto tune_response =
+                        std::get<messages::AutotuneResultResponse>(
+                            comms.front());
+                    REQUIRE(tune_response.responding_to_id == 303);
+                    REQUIRE(tune_response.with_error ==
+                            errors::ErrorCode::HEATER_AUTOTUNE_FAILED);
+                    auto ack =
+                        std::get<messages::AcknowledgePrevious>(comms.back());
+                    REQUIRE(ack.responding_to_id == 2);
+                    REQUIRE(ack.with_error == errors::ErrorCode::NO_ERROR);
+                    REQUIRE(!tasks->get_heater_policy().last_enable_setting());
+                }
+            }
+            AND_WHEN("a thermistor error occurs during the tune") {
+                tasks->get_heater_queue().backing_deque.push_back(
+                    messages::TemperatureConversionComplete{
+                        .pad_a = 0,
+                        .pad_b = (1U << 9),
+                        .board = (1U << 11)});
+                tasks->run_heater_task();
+                THEN("the tune fails with that error and power is disabled") {
+                    REQUIRE(!tasks->get_heater_policy().last_enable_setting());
+                    auto& comms = tasks->get_host_comms_queue().backing_deque;
+                    auto tune_response = std::find_if(
+                        comms.begin(), comms.end(), [](auto& msg) {
+                            return std::holds_alternative<
+                                messages::AutotuneResultResponse>(msg);
+                        });
+                    REQUIRE(tune_response != comms.end());
+                    auto error = std::get<messages::AutotuneResultResponse>(
+                                     *tune_response)
+                                     .with_error;
+                    REQUIRE(error ==
+                            errors::ErrorCode::HEATER_THERMISTOR_A_DISCONNECTED);
+                }
+            }
+        }
         WHEN("sending a get-temperature message") {
             auto message = messages::GetTemperatureMessage{.id = 999};
             tasks->get_heater_queue().backing_deque.push_back(
@@ -217,6 +313,53 @@ SCENARIO("heater task message passing") {
                 }
             }
         }
+        WHEN("pad b disconnects and its stats are requested") {
+            auto bad_read = read_message;
+            bad_read.pad_b = 0;
+            tasks->get_heater_queue().backing_deque.push_back(
+                messages::HeaterMessage(bad_read));
+            tasks->run_heater_task();
+            tasks->get_host_comms_queue().backing_deque.clear();
+            auto message =
+                messages::GetThermistorStatsMessage{.id = 123, .thermistor = 1};
+            tasks->get_heater_queue().backing_deque.push_back(
+                messages::HeaterMessage(message));
+            tasks->run_heater_task();
+            THEN("the task responds with pad b's statistics") {
+                auto& comms = tasks->get_host_comms_queue().backing_deque;
+                REQUIRE(!comms.empty());
+                REQUIRE(std::holds_alternative<
+                        messages::GetThermistorStatsResponse>(comms.front()));
+                auto stats = std::get<messages::GetThermistorStatsResponse>(
+                    comms.front());
+                REQUIRE(stats.responding_to_id == message.id);
+                REQUIRE(stats.thermistor == 1);
+                REQUIRE(stats.count == 1);
+                REQUIRE_THAT(stats.mean,
+                             Catch::Matchers::WithinAbs(95.20, 0.1));
+                REQUIRE(stats.invalid == 1);
+                REQUIRE(stats.total == 2);
+                REQUIRE(stats.total_invalid == 1);
+            }
+            AND_WHEN("the board's stats are requested") {
+                tasks->get_host_comms_queue().backing_deque.clear();
+                tasks->get_heater_queue().backing_deque.push_back(
+                    messages::HeaterMessage(messages::GetThermistorStatsMessage{
+                        .id = 124, .thermistor = 2}));
+                tasks->run_heater_task();
+                THEN("they are the board's own") {
+                    auto& comms = tasks->get_host_comms_queue().backing_deque;
+                    REQUIRE(!comms.empty());
+                    auto stats =
+                        std::get<messages::GetThermistorStatsResponse>(
+                            comms.front());
+                    REQUIRE(stats.count == 2);
+                    REQUIRE(stats.invalid == 0);
+                    REQUIRE_THAT(stats.mean,
+                                 Catch::Matchers::WithinAbs(43.16, 0.2));
+                }
+            }
+        }
     }
 
     GIVEN("a heater task with an invalid out-of-range temp") {
@@ -505,3 +648,153 @@ SCENARIO("heater task error handling") {
         }
     }
 }
+
+SCENARIO("heater task power budget") {
+    GIVEN("a heater task controlling well below its setpoint") {
+        auto tasks = TaskBuilder::build();
+        auto& budget = tasks->get_tasks_aggregator().power_budget;
+        auto read_message = messages::TemperatureConversionComplete{
+            .pad_a = (1U << 11), .pad_b = (1U << 11), .board = (1U << 11)};
+        tasks->get_heater_queue().backing_deque.push_back(read_message);
+        tasks->run_heater_task();
+        tasks->get_heater_queue().backing_deque.push_back(
+            messages::SetTemperatureMessage{.id = 1, .target_temperature = 95});
+        tasks->run_heater_task();
+        WHEN("the motor is not running") {
+            tasks->get_heater_queue().backing_deque.push_back(read_message);
+            tasks->run_heater_task();
+            THEN("the heater runs at full power and publishes its demand") {
+                REQUIRE(tasks->get_heater_policy().last_power_setting() == 1.0);
+                REQUIRE(budget.demand(power::HEATER) ==
+                        Approx(1.0).epsilon(0.001));
+            }
+        }
+        WHEN("the motor is drawing full power") {
+            budget.set_demand(power::MOTOR, 1.0);
+            tasks->get_heater_queue().backing_deque.push_back(read_message);
+            tasks->run_heater_task();
+            THEN("the default budget does not hold the heater back") {
+                REQUIRE(tasks->get_heater_policy().last_power_setting() == 1.0);
+                auto& pid = tasks->get_heater_task().get_pid();
+                REQUIRE(pid.windup_limit_high() == 1.0);
+            }
+        }
+        WHEN("the supply is limited and the motor is drawing full power") {
+            const double supply_watts = 100.0;
+            tasks->get_host_comms_queue().backing_deque.clear();
+            tasks->get_heater_queue().backing_deque.push_back(
+                messages::SetPowerSupplyMessage{.id = 2,
+                                                .watts = supply_watts});
+            tasks->run_heater_task();
+            auto ack = std::get<messages::AcknowledgePrevious>(
+                tasks->get_host_comms_queue().backing_deque.front());
+            tasks->get_host_comms_queue().backing_deque.pop_front();
+            budget.set_demand(power::MOTOR, 1.0);
+            tasks->get_heater_queue().backing_deque.push_back(read_message);
+            tasks->run_heater_task();
+            THEN("the supply figure is acknowledged") {
+                REQUIRE(ack.responding_to_id == 2);
+                REQUIRE(ack.with_error == errors::ErrorCode::NO_ERROR);
+            }
+            THEN("the heater is held to what is left of the supply") {
+                const double ceiling =
+                    (supply_watts - power::MOTOR_MAX_WATTS) /
+                    power::HEATER_MAX_WATTS;
+                REQUIRE(tasks->get_heater_policy().last_power_setting() ==
+                        Approx(ceiling).epsilon(0.001));
+                auto& pid = tasks->get_heater_task().get_pid();
+                REQUIRE(pid.windup_limit_high() ==
+                        Approx(ceiling).epsilon(0.001));
+            }
+        }
+    }
+}
+
+SCENARIO("heater task thermal fault detection") {
+    using HeaterTask = heater_task::HeaterTask<TestMessageQueue>;
+    auto converter =
+        thermistor_conversion::Conversion<lookups::NTCG104ED104DTDSX>(
+            HeaterTask::THERMISTOR_CIRCUIT_BIAS_RESISTANCE_KOHM,
+            HeaterTask::ADC_BIT_DEPTH);
+    auto reading = [&converter](double pad_a, double pad_b) {
+        return messages::TemperatureConversionComplete{
+            .pad_a = converter.backconvert(pad_a),
+            .pad_b = converter.backconvert(pad_b),
+            .board = converter.backconvert(30.0)};
+    };
+    const int window_periods = static_cast<int>(
+        HeaterTask::FAULT_LIMITS.window_s / HeaterTask::CONTROL_PERIOD_S);
+    GIVEN("a heater task controlling towards a setpoint") {
+        auto tasks = TaskBuilder::build();
+        auto& queue = tasks->get_heater_queue().backing_deque;
+        auto& comms = tasks->get_host_comms_queue().backing_deque;
+        queue.push_back(reading(30.0, 30.0));
+        tasks->run_heater_task();
+        queue.push_back(
+            messages::SetTemperatureMessage{.id = 1, .target_temperature = 80});
+        tasks->run_heater_task();
+        comms.clear();
+        WHEN("the pads warm up while it heats") {
+            double temp = 30.0;
+            for (int i = 0; i < 2 * window_periods; ++i) {
+                temp += 0.2 * HeaterTask::CONTROL_PERIOD_S;
+                queue.push_back(reading(temp, temp));
+                tasks->run_heater_task();
+            }
+            THEN("no fault is raised") {
+                REQUIRE(comms.empty());
+                REQUIRE(tasks->get_heater_policy().last_enable_setting());
+            }
+        }
+        WHEN("the pads don't warm up at full power") {
+            // One period to start driving, then a full window without change
+            for (int i = 0; i < window_periods + 2; ++i) {
+                queue.push_back(reading(30.0, 30.0));
+                tasks->run_heater_task();
+            }
+            THEN("the heater is shut off and an error is sent") {
+                REQUIRE(!tasks->get_heater_policy().last_enable_setting());
+                REQUIRE(!comms.empty());
+                REQUIRE(std::get<messages::ErrorMessage>(comms.front()).code ==
+                        errors::ErrorCode::HEATER_NO_RESPONSE);
+                AND_WHEN("setting a new temperature") {
+                    comms.clear();
+                    queue.push_back(messages::SetTemperatureMessage{
+                        .id = 2, .target_temperature = 60});
+                    tasks->run_heater_task();
+                    THEN("the fault stays latched") {
+                        REQUIRE(std::get<messages::AcknowledgePrevious>(
+                                    comms.front())
+                                    .with_error ==
+                                errors::ErrorCode::HEATER_NO_RESPONSE);
+                    }
+                }
+            }
+        }
+        WHEN("the pads keep heating once the heater is off") {
+            // Above the setpoint the loop turns the heater off
+            double temp = 82.0;
+            for (int i = 0; i < 2 * window_periods && comms.empty(); ++i) {
+                temp += 0.3 * HeaterTask::CONTROL_PERIOD_S;
+                queue.push_back(reading(temp, temp));
+                tasks->run_heater_task();
+            }
+            THEN("a runaway is flagged") {
+                REQUIRE(!comms.empty());
+                REQUIRE(std::get<messages::ErrorMessage>(comms.front()).code ==
+                        errors::ErrorCode::HEATER_THERMAL_RUNAWAY);
+                REQUIRE(!tasks->get_heater_policy().last_enable_setting());
+            }
+        }
+        WHEN("the pad thermistors disagree") {
+            queue.push_back(reading(30.0, 50.0));
+            tasks->run_heater_task();
+            THEN("a mismatch is flagged") {
+                REQUIRE(!comms.empty());
+                REQUIRE(std::get<messages::ErrorMessage>(comms.front()).code ==
+                        errors::ErrorCode::HEATER_THERMISTOR_MISMATCH);
+                REQUIRE(!tasks->get_heater_policy().last_enable_setting());
+            }
+        }
+    }
+}
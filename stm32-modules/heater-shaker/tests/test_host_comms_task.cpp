@@ -236,6 +236,138 @@ SCENARIO("message passing for ack-only gcodes from usb input") {
             }
         }
 
+        WHEN("sending a set-jerk") {
+            auto message_text = std::string("M205 J5000\n");
+            auto message_obj =
+                messages::HostCommsMessage(messages::IncomingMessageFromHost(
+                    &*message_text.begin(), &*message_text.end()));
+            tasks->get_host_comms_queue().backing_deque.push_back(message_obj);
+            auto written_firstpass = tasks->get_host_comms_task().run_once(
+                tx_buf.begin(), tx_buf.end());
+            THEN(
+                "the task should pass the message on to the motor and not "
+                "immediately ack") {
+                REQUIRE(written_firstpass == tx_buf.begin());
+                auto set_jerk_message = std::get<messages::SetJerkMessage>(
+                    tasks->get_motor_queue().backing_deque.front());
+                tasks->get_motor_queue().backing_deque.pop_front();
+                REQUIRE(set_jerk_message.rpm_per_s2 == 5000);
+                AND_WHEN("sending a good response back to the comms task") {
+                    tasks->get_host_comms_queue().backing_deque.push_back(
+                        messages::AcknowledgePrevious{
+                            .responding_to_id = set_jerk_message.id});
+                    auto written_secondpass =
+                        tasks->get_host_comms_task().run_once(tx_buf.begin(),
+                                                              tx_buf.end());
+                    THEN("the task should ack the previous message") {
+                        REQUIRE_THAT(tx_buf,
+                                     Catch::Matchers::StartsWith("M205 OK\n"));
+                        REQUIRE(written_secondpass != tx_buf.begin());
+                    }
+                }
+            }
+        }
+
+        WHEN("sending a set-power-supply") {
+            auto message_text = std::string("M998 S100\n");
+            auto message_obj =
+                messages::HostCommsMessage(messages::IncomingMessageFromHost(
+                    &*message_text.begin(), &*message_text.end()));
+            tasks->get_host_comms_queue().backing_deque.push_back(message_obj);
+            auto written_firstpass = tasks->get_host_comms_task().run_once(
+                tx_buf.begin(), tx_buf.end());
+            THEN(
+                "the task should pass the message on to the heater and not "
+                "immediately ack") {
+                REQUIRE(written_firstpass == tx_buf.begin());
+                auto supply_message =
+                    std::get<messages::SetPowerSupplyMessage>(
+                        tasks->get_heater_queue().backing_deque.front());
+                tasks->get_heater_queue().backing_deque.pop_front();
+                REQUIRE(supply_message.watts == 100.0);
+                AND_WHEN("sending a good response back to the comms task") {
+                    tasks->get_host_comms_queue().backing_deque.push_back(
+                        messages::AcknowledgePrevious{
+                            .responding_to_id = supply_message.id});
+                    auto written_secondpass =
+                        tasks->get_host_comms_task().run_once(tx_buf.begin(),
+                                                              tx_buf.end());
+                    THEN("the task should ack the previous message") {
+                        REQUIRE_THAT(tx_buf,
+                                     Catch::Matchers::StartsWith("M998 OK\n"));
+                        REQUIRE(written_secondpass != tx_buf.begin());
+                    }
+                }
+            }
+        }
+
+        WHEN("sending a shake program segment") {
+            auto message_text = std::string("M3.P S1500 A2000 D10000 R2 H40\n");
+            auto message_obj =
+                messages::HostCommsMessage(messages::IncomingMessageFromHost(
+                    &*message_text.begin(), &*message_text.end()));
+            tasks->get_host_comms_queue().backing_deque.push_back(message_obj);
+            auto written_firstpass = tasks->get_host_comms_task().run_once(
+                tx_buf.begin(), tx_buf.end());
+            THEN(
+                "the task should pass the segment on to the motor and not "
+                "immediately ack") {
+                REQUIRE(written_firstpass == tx_buf.begin());
+                auto segment_message =
+                    std::get<messages::AddShakeSegmentMessage>(
+                        tasks->get_motor_queue().backing_deque.front());
+                tasks->get_motor_queue().backing_deque.pop_front();
+                REQUIRE(segment_message.segment.rpm == 1500);
+                REQUIRE(segment_message.segment.ramp_rpm_per_s == 2000);
+                REQUIRE(segment_message.segment.dwell_ms == 10000);
+                REQUIRE(segment_message.segment.repeats == 2);
+                REQUIRE(segment_message.segment.temperature.value() ==
+                        Approx(40));
+                AND_WHEN("sending a good response back to the comms task") {
+                    tasks->get_host_comms_queue().backing_deque.push_back(
+                        messages::AcknowledgePrevious{
+                            .responding_to_id = segment_message.id});
+                    auto written_secondpass =
+                        tasks->get_host_comms_task().run_once(tx_buf.begin(),
+                                                              tx_buf.end());
+                    THEN("the task should ack the previous message") {
+                        REQUIRE_THAT(tx_buf,
+                                     Catch::Matchers::StartsWith("M3.P OK\n"));
+                        REQUIRE(written_secondpass != tx_buf.begin());
+                    }
+                }
+            }
+        }
+
+        WHEN("running the shake program") {
+            auto message_text = std::string("M3.S\n");
+            auto message_obj =
+                messages::HostCommsMessage(messages::IncomingMessageFromHost(
+                    &*message_text.begin(), &*message_text.end()));
+            tasks->get_host_comms_queue().backing_deque.push_back(message_obj);
+            auto written_firstpass = tasks->get_host_comms_task().run_once(
+                tx_buf.begin(), tx_buf.end());
+            THEN("the task should pass the message on to the motor") {
+                REQUIRE(written_firstpass == tx_buf.begin());
+                auto run_message = std::get<messages::RunShakeProgramMessage>(
+                    tasks->get_motor_queue().backing_deque.front());
+                AND_WHEN("sending an error back to the comms task") {
+                    tasks->get_host_comms_queue().backing_deque.push_back(
+                        messages::AcknowledgePrevious{
+                            .responding_to_id = run_message.id,
+                            .with_error =
+                                errors::ErrorCode::MOTOR_PROGRAM_EMPTY});
+                    static_cast<void>(tasks->get_host_comms_task().run_once(
+                        tx_buf.begin(), tx_buf.end()));
+                    THEN("the task should write out the error") {
+                        REQUIRE_THAT(tx_buf, Catch::Matchers::StartsWith(
+                                                 "ERR129:main motor:shake "
+                                                 "program empty\n"));
+                    }
+                }
+            }
+        }
+
         WHEN("sending a set-acceleration") {
             auto message_text = std::string("M204 S3000\n");
             auto message_obj =
@@ -825,6 +957,60 @@ SCENARIO("message passing for response-carrying gcodes from usb input") {
             }
         }
 
+        WHEN("sending a get-thermistor-stats") {
+            auto message_text = std::string("M105.S 2\n");
+            auto message_obj =
+                messages::HostCommsMessage(messages::IncomingMessageFromHost(
+                    &*message_text.begin(), &*message_text.end()));
+            tasks->get_host_comms_queue().backing_deque.push_back(message_obj);
+            auto written_firstpass = tasks->get_host_comms_task().run_once(
+                tx_buf.begin(), tx_buf.end());
+            THEN("the task should pass the message on to the heater") {
+                REQUIRE(written_firstpass == tx_buf.begin());
+                REQUIRE(tasks->get_heater_queue().backing_deque.size() != 0);
+                auto heater_message =
+                    tasks->get_heater_queue().backing_deque.front();
+                REQUIRE(std::holds_alternative<
+                        messages::GetThermistorStatsMessage>(heater_message));
+                auto stats_message =
+                    std::get<messages::GetThermistorStatsMessage>(
+                        heater_message);
+                tasks->get_heater_queue().backing_deque.pop_front();
+                REQUIRE(stats_message.thermistor == 2);
+                REQUIRE(stats_message.window ==
+                        gcode::GetThermistorStats::max_window);
+                AND_WHEN("sending a good response back to the comms task") {
+                    auto response = messages::HostCommsMessage(
+                        messages::GetThermistorStatsResponse{
+                            .responding_to_id = stats_message.id,
+                            .thermistor = 2,
+                            .count = 64,
+                            .min = 24.5,
+                            .max = 25.25,
+                            .mean = 25.0,
+                            .variance = 0.0125,
+                            .invalid = 0,
+                            .total = 500,
+                            .total_invalid = 1,
+                            .drift = 0.5});
+                    tasks->get_host_comms_queue().backing_deque.push_back(
+                        response);
+                    auto written_secondpass =
+                        tasks->get_host_comms_task().run_once(tx_buf.begin(),
+                                                              tx_buf.end());
+                    THEN("the task should write the statistics") {
+                        REQUIRE_THAT(tx_buf,
+                                     Catch::Matchers::StartsWith(
+                                         "M105.S T:2 N:64 MIN:24.50 "
+                                         "MAX:25.25 AVG:25.000 VAR:0.01250 "
+                                         "INV:0 TOT:500 TINV:1 DR:0.500 "
+                                         "OK\n"));
+                        REQUIRE(written_secondpass != tx_buf.begin());
+                    }
+                }
+            }
+        }
+
         WHEN("sending a get-temp-debug") {
             auto message_text = std::string("M105.D\n");
             auto message_obj =
@@ -1192,6 +1378,166 @@ SCENARIO("message passing for response-carrying gcodes from usb input") {
                 }
             }
         }
+        WHEN("sending a get-loop-timing with a reset") {
+            auto message_text = std::string("M123.D R\n");
+            auto message_obj =
+                messages::HostCommsMessage(messages::IncomingMessageFromHost(
+                    &*message_text.begin(), &*message_text.end()));
+            tasks->get_host_comms_queue().backing_deque.push_back(message_obj);
+            auto written_firstpass = tasks->get_host_comms_task().run_once(
+                tx_buf.begin(), tx_buf.end());
+            THEN("the task should pass the message on to the motor") {
+                auto motor_message =
+                    tasks->get_motor_queue().backing_deque.front();
+                auto get_message =
+                    std::get<messages::GetLoopTimingMessage>(motor_message);
+                tasks->get_motor_queue().backing_deque.pop_front();
+                REQUIRE(get_message.reset);
+                REQUIRE(written_firstpass == tx_buf.begin());
+                AND_WHEN("sending the timing back to the comms task") {
+                    std::string response_buf(256, 'c');
+                    auto response = messages::GetLoopTimingResponse{
+                        .responding_to_id = get_message.id,
+                        .timing = {.high_frequency = {.period_cycles = 100,
+                                                      .samples = 4,
+                                                      .min_cycles = 10,
+                                                      .max_cycles = 30,
+                                                      .mean_cycles = 25,
+                                                      .overruns = 0},
+                                   .medium_frequency = {}}};
+                    tasks->get_host_comms_queue().backing_deque.push_back(
+                        messages::HostCommsMessage(response));
+                    auto written_secondpass =
+                        tasks->get_host_comms_task().run_once(
+                            response_buf.begin(), response_buf.end());
+                    THEN("the task should write the timing") {
+                        std::string expected =
+                            "M123.D HN:4 HMIN:10 HMAX:30 HAVG:25 HP:100 HOV:0 "
+                            "HLD:25.00 MN:0 MMIN:0 MMAX:0 MAVG:0 MP:0 MOV:0 "
+                            "MLD:0.00 OK\n";
+                        REQUIRE_THAT(response_buf,
+                                     Catch::Matchers::StartsWith(expected));
+                        REQUIRE(written_secondpass ==
+                                response_buf.begin() + expected.size());
+                    }
+                }
+            }
+        }
+        WHEN("sending an add-skip-band") {
+            auto message_text = std::string("M3.B L500 H650\n");
+            auto message_obj =
+                messages::HostCommsMessage(messages::IncomingMessageFromHost(
+                    &*message_text.begin(), &*message_text.end()));
+            tasks->get_host_comms_queue().backing_deque.push_back(message_obj);
+            auto written_firstpass = tasks->get_host_comms_task().run_once(
+                tx_buf.begin(), tx_buf.end());
+            THEN("the task should pass the band on to the motor") {
+                auto motor_message =
+                    tasks->get_motor_queue().backing_deque.front();
+                auto add_message =
+                    std::get<messages::AddSkipBandMessage>(motor_message);
+                tasks->get_motor_queue().backing_deque.pop_front();
+                REQUIRE(add_message.band.low_rpm == 500);
+                REQUIRE(add_message.band.high_rpm == 650);
+                REQUIRE(written_firstpass == tx_buf.begin());
+                AND_WHEN("the motor acknowledges it") {
+                    tasks->get_host_comms_queue().backing_deque.push_back(
+                        messages::AcknowledgePrevious{
+                            .responding_to_id = add_message.id});
+                    auto written_secondpass =
+                        tasks->get_host_comms_task().run_once(tx_buf.begin(),
+                                                              tx_buf.end());
+                    THEN("the task should write the ack") {
+                        REQUIRE_THAT(tx_buf,
+                                     Catch::Matchers::StartsWith("M3.B OK\n"));
+                        REQUIRE(written_secondpass == tx_buf.begin() + 8);
+                    }
+                }
+            }
+        }
+        WHEN("sending a get-skip-bands") {
+            auto message_text = std::string("M3.B\n");
+            auto message_obj =
+                messages::HostCommsMessage(messages::IncomingMessageFromHost(
+                    &*message_text.begin(), &*message_text.end()));
+            tasks->get_host_comms_queue().backing_deque.push_back(message_obj);
+            static_cast<void>(tasks->get_host_comms_task().run_once(
+                tx_buf.begin(), tx_buf.end()));
+            THEN("the task should ask the motor for the bands") {
+                auto motor_message =
+                    tasks->get_motor_queue().backing_deque.front();
+                auto get_message =
+                    std::get<messages::GetSkipBandsMessage>(motor_message);
+                tasks->get_motor_queue().backing_deque.pop_front();
+                AND_WHEN("sending the bands back to the comms task") {
+                    auto response = messages::GetSkipBandsResponse{
+                        .responding_to_id = get_message.id,
+                        .bands = {skip_bands::Band{.low_rpm = 500,
+                                                   .high_rpm = 650}},
+                        .count = 1};
+                    tasks->get_host_comms_queue().backing_deque.push_back(
+                        messages::HostCommsMessage(response));
+                    auto written_secondpass =
+                        tasks->get_host_comms_task().run_once(tx_buf.begin(),
+                                                              tx_buf.end());
+                    THEN("the task should list them") {
+                        REQUIRE_THAT(tx_buf, Catch::Matchers::StartsWith(
+                                                 "M3.B 500-650 OK\n"));
+                        REQUIRE(written_secondpass == tx_buf.begin() + 16);
+                    }
+                }
+            }
+        }
+        WHEN("sending a get-motor-capture") {
+            auto message_text = std::string("M125 I8\n");
+            auto message_obj =
+                messages::HostCommsMessage(messages::IncomingMessageFromHost(
+                    &*message_text.begin(), &*message_text.end()));
+            tasks->get_host_comms_queue().backing_deque.push_back(message_obj);
+            auto written_firstpass = tasks->get_host_comms_task().run_once(
+                tx_buf.begin(), tx_buf.end());
+            THEN("the task should pass the message on to the motor") {
+                auto motor_message =
+                    tasks->get_motor_queue().backing_deque.front();
+                REQUIRE(
+                    std::holds_alternative<messages::GetMotorCaptureMessage>(
+                        motor_message));
+                auto get_message =
+                    std::get<messages::GetMotorCaptureMessage>(motor_message);
+                tasks->get_motor_queue().backing_deque.pop_front();
+                REQUIRE(get_message.start == 8);
+                REQUIRE(written_firstpass == tx_buf.begin());
+                AND_WHEN("sending a page back to the comms task") {
+                    auto response = messages::GetMotorCaptureResponse{
+                        .responding_to_id = get_message.id,
+                        .status = motor_telemetry::Status::DONE,
+                        .period_ticks = 2,
+                        .count = 10,
+                        .trigger_index = 4,
+                        .start = 8,
+                        .page_count = 2,
+                        .page = {}};
+                    response.page.at(0) = motor_telemetry::Sample{
+                        .rpm = 1, .setpoint_rpm = 2, .iq = 3, .bus_mv = 4};
+                    response.page.at(1) = motor_telemetry::Sample{
+                        .rpm = 5, .setpoint_rpm = 6, .iq = 7, .bus_mv = 8};
+                    tasks->get_host_comms_queue().backing_deque.push_back(
+                        messages::HostCommsMessage(response));
+                    auto written_secondpass =
+                        tasks->get_host_comms_task().run_once(tx_buf.begin(),
+                                                              tx_buf.end());
+                    THEN("the task should write the page") {
+                        std::string expected =
+                            "M125 S:DONE P:2 N:10 T:4 I:8 D:1,2,3,4 5,6,7,8 "
+                            "OK\n";
+                        REQUIRE_THAT(tx_buf,
+                                     Catch::Matchers::StartsWith(expected));
+                        REQUIRE(written_secondpass ==
+                                tx_buf.begin() + expected.size());
+                    }
+                }
+            }
+        }
     }
 }
 
@@ -1251,6 +1597,61 @@ SCENARIO("message handling for m301") {
     }
 }
 
+SCENARIO("message handling for m303") {
+    GIVEN("a host_comms task") {
+        auto tasks = TaskBuilder::build();
+        std::string tx_buf(128, 'c');
+        WHEN("sending an autotune message") {
+            std::string message_text = "M303 S70\n";
+            auto message_obj = messages::IncomingMessageFromHost(
+                &*message_text.begin(), &*message_text.end());
+            tasks->get_host_comms_queue().backing_deque.push_back(message_obj);
+            auto written_firstpass = tasks->get_host_comms_task().run_once(
+                tx_buf.begin(), tx_buf.end());
+            THEN("the gcode is sent to the heater without an immediate ack") {
+                REQUIRE(written_firstpass == tx_buf.begin());
+                REQUIRE(!tasks->get_heater_queue().backing_deque.empty());
+                auto heater_message = std::get<messages::StartAutotuneMessage>(
+                    tasks->get_heater_queue().backing_deque.front());
+                REQUIRE_THAT(heater_message.setpoint,
+                             Catch::Matchers::WithinAbs(70, 0.01));
+                AND_WHEN("the heater reports the tune result") {
+                    tasks->get_host_comms_queue().backing_deque.push_back(
+                        messages::AutotuneResultResponse{
+                            .responding_to_id = heater_message.id,
+                            .kp = 0.25,
+                            .ki = 0.0015,
+                            .kd = 4.5});
+                    tasks->get_host_comms_task().run_once(tx_buf.begin(),
+                                                          tx_buf.end());
+                    THEN("the task prints the new constants") {
+                        REQUIRE_THAT(tx_buf,
+                                     Catch::Matchers::StartsWith(
+                                         "M303 P:0.2500 I:0.0015 D:4.5000 "
+                                         "OK\n"));
+                    }
+                }
+                AND_WHEN("the heater reports a failed tune") {
+                    tasks->get_host_comms_queue().backing_deque.push_back(
+                        messages::AutotuneResultResponse{
+                            .responding_to_id = heater_message.id,
+                            .kp = 0,
+                            .ki = 0,
+                            .kd = 0,
+                            .with_error =
+                                errors::ErrorCode::HEATER_AUTOTUNE_FAILED});
+                    tasks->get_host_comms_task().run_once(tx_buf.begin(),
+                                                          tx_buf.end());
+                    THEN("the task prints the error") {
+                        REQUIRE_THAT(tx_buf,
+                                     Catch::Matchers::StartsWith("ERR213"));
+                    }
+                }
+            }
+        }
+    }
+}
+
 SCENARIO("message handling for other-task-initiated communication") {
     GIVEN("a host_comms task") {
         auto tasks = TaskBuilder::build();
@@ -1267,6 +1668,28 @@ SCENARIO("message handling for other-task-initiated communication") {
                 REQUIRE(*written == 'c');
             }
         }
+        WHEN("sending shake program events as from the motor task") {
+            tasks->get_host_comms_queue().backing_deque.push_back(
+                messages::ShakeProgramEventMessage{.segment = 3});
+            auto written = tasks->get_host_comms_task().run_once(tx_buf.begin(),
+                                                                 tx_buf.end());
+            THEN("the task should write out the segment") {
+                REQUIRE_THAT(tx_buf,
+                             Catch::Matchers::StartsWith("M3.S SEG:3\n"));
+                REQUIRE(written == tx_buf.begin() + 11);
+            }
+            AND_WHEN("the program finishes") {
+                tasks->get_host_comms_queue().backing_deque.push_back(
+                    messages::ShakeProgramEventMessage{.segment = 3,
+                                                       .done = true});
+                static_cast<void>(tasks->get_host_comms_task().run_once(
+                    tx_buf.begin(), tx_buf.end()));
+                THEN("the task should write out the end") {
+                    REQUIRE_THAT(tx_buf,
+                                 Catch::Matchers::StartsWith("M3.S DONE\n"));
+                }
+            }
+        }
         WHEN("sending a force-disconnect") {
             auto message_obj = messages::ForceUSBDisconnectMessage{.id = 222};
             tasks->get_host_comms_queue().backing_deque.push_back(message_obj);
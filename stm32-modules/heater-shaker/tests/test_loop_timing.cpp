@@ -0,0 +1,59 @@
+#include "catch2/catch.hpp"
+#include "heater-shaker/loop_timing.hpp"
+
+using namespace loop_timing;
+
+SCENARIO("loop timing statistics") {
+    auto stats = LoopStats(100);
+    GIVEN("no passes recorded") {
+        THEN("the summary is empty but keeps the period") {
+            auto summary = stats.summary();
+            REQUIRE(summary.period_cycles == 100);
+            REQUIRE(summary.samples == 0);
+            REQUIRE(summary.min_cycles == 0);
+            REQUIRE(summary.max_cycles == 0);
+            REQUIRE(summary.mean_cycles == 0);
+            REQUIRE(summary.overruns == 0);
+            REQUIRE(load_percent(summary) == 0);
+        }
+    }
+    GIVEN("some passes, one past the period") {
+        stats.record(20);
+        stats.record(40);
+        stats.record(150);
+        stats.record(30);
+        THEN("the summary covers them") {
+            auto summary = stats.summary();
+            REQUIRE(summary.samples == 4);
+            REQUIRE(summary.min_cycles == 20);
+            REQUIRE(summary.max_cycles == 150);
+            REQUIRE(summary.mean_cycles == 60);
+            REQUIRE(summary.overruns == 1);
+            REQUIRE(load_percent(summary) == Approx(60));
+        }
+        THEN("a pass of exactly the period is not an overrun") {
+            stats.record(100);
+            REQUIRE(stats.summary().overruns == 1);
+        }
+        WHEN("the statistics are reset") {
+            stats.reset();
+            stats.record(50);
+            THEN("only later passes count") {
+                auto summary = stats.summary();
+                REQUIRE(summary.samples == 1);
+                REQUIRE(summary.min_cycles == 50);
+                REQUIRE(summary.max_cycles == 50);
+                REQUIRE(summary.mean_cycles == 50);
+                REQUIRE(summary.overruns == 0);
+                REQUIRE(summary.period_cycles == 100);
+            }
+        }
+    }
+    GIVEN("a loop with no period") {
+        auto unbounded = LoopStats(0);
+        unbounded.record(10);
+        THEN("its load reads as zero") {
+            REQUIRE(load_percent(unbounded.summary()) == 0);
+        }
+    }
+}
@@ -0,0 +1,85 @@
+#include <string>
+
+#include "catch2/catch.hpp"
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-truncation"
+#include "heater-shaker/gcodes.hpp"
+#pragma GCC diagnostic pop
+
+SCENARIO("GetLoopTimingDebug (M123.D) parser works",
+         "[gcode][parse][m123.d]") {
+    GIVEN("a string with the prefix only") {
+        std::string to_parse = "M123.D\r\n";
+        WHEN("calling parse") {
+            auto result = gcode::GetLoopTimingDebug::parse(to_parse.cbegin(),
+                                                           to_parse.cend());
+            THEN("it is parsed without a reset") {
+                REQUIRE(result.first.has_value());
+                REQUIRE(!result.first.value().reset);
+                REQUIRE(result.second == to_parse.cbegin() + 6);
+            }
+            THEN("it isn't mistaken for a speed request") {
+                auto rpm =
+                    gcode::GetRPM::parse(to_parse.cbegin(), to_parse.cend());
+                REQUIRE(!rpm.first.has_value());
+                REQUIRE(rpm.second == to_parse.cbegin());
+            }
+        }
+    }
+    GIVEN("a string asking for a reset") {
+        std::string to_parse = "M123.D R\r\n";
+        WHEN("calling parse") {
+            auto result = gcode::GetLoopTimingDebug::parse(to_parse.cbegin(),
+                                                           to_parse.cend());
+            THEN("it is parsed with a reset") {
+                REQUIRE(result.first.has_value());
+                REQUIRE(result.first.value().reset);
+                REQUIRE(result.second == to_parse.cbegin() + 8);
+            }
+        }
+    }
+}
+
+SCENARIO("GetLoopTimingDebug (M123.D) response generation works",
+         "[gcode][response][m123.d]") {
+    auto timing = loop_timing::MotorLoopTiming{
+        .high_frequency = {.period_cycles = 2400,
+                           .samples = 30000,
+                           .min_cycles = 800,
+                           .max_cycles = 2500,
+                           .mean_cycles = 1200,
+                           .overruns = 2},
+        .medium_frequency = {.period_cycles = 72000,
+                             .samples = 1000,
+                             .min_cycles = 3000,
+                             .max_cycles = 9000,
+                             .mean_cycles = 3600,
+                             .overruns = 0}};
+    GIVEN("a response buffer large enough for the formatted response") {
+        std::string buffer(256, 'c');
+        WHEN("filling response") {
+            auto written = gcode::GetLoopTimingDebug::write_response_into(
+                buffer.begin(), buffer.end(), timing);
+            THEN("the response should be written in full") {
+                std::string expected =
+                    "M123.D HN:30000 HMIN:800 HMAX:2500 HAVG:1200 HP:2400 "
+                    "HOV:2 HLD:50.00 MN:1000 MMIN:3000 MMAX:9000 MAVG:3600 "
+                    "MP:72000 MOV:0 MLD:5.00 OK\n";
+                REQUIRE_THAT(buffer, Catch::Matchers::StartsWith(expected));
+                REQUIRE(written == buffer.begin() + expected.size());
+            }
+        }
+    }
+    GIVEN("a response buffer not large enough for the formatted response") {
+        std::string buffer(32, 'c');
+        WHEN("filling response") {
+            auto written = gcode::GetLoopTimingDebug::write_response_into(
+                buffer.begin(), buffer.begin() + 16, timing);
+            THEN("the response should write only up to the available space") {
+                REQUIRE(written == buffer.begin() + 16);
+                REQUIRE_THAT(buffer,
+                             Catch::Matchers::StartsWith("M123.D HN:30000"));
+            }
+        }
+    }
+}
@@ -0,0 +1,154 @@
+#include <array>
+#include <string>
+
+#include "catch2/catch.hpp"
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-truncation"
+#include "heater-shaker/gcodes.hpp"
+#pragma GCC diagnostic pop
+
+SCENARIO("ArmMotorCapture (M125.A) parser works", "[gcode][parse][m125.a]") {
+    GIVEN("a string missing the sample count") {
+        std::string to_parse = "M125.A P2\r\n";
+        WHEN("calling parse") {
+            auto result = gcode::ArmMotorCapture::parse(to_parse.cbegin(),
+                                                        to_parse.cend());
+            THEN("nothing should be parsed") {
+                REQUIRE(!result.first.has_value());
+                REQUIRE(result.second == to_parse.cbegin());
+            }
+        }
+    }
+    GIVEN("a valid string") {
+        std::string to_parse = "M125.A P2 N400\r\n";
+        WHEN("calling parse") {
+            auto result = gcode::ArmMotorCapture::parse(to_parse.cbegin(),
+                                                        to_parse.cend());
+            THEN("the settings are parsed") {
+                REQUIRE(result.first.has_value());
+                REQUIRE(result.first.value().period_ms == 2);
+                REQUIRE(result.first.value().post_trigger == 400);
+                REQUIRE(result.second == to_parse.cbegin() + 14);
+            }
+        }
+    }
+    GIVEN("a response buffer") {
+        std::string buffer(64, 'c');
+        WHEN("filling the response") {
+            auto written = gcode::ArmMotorCapture::write_response_into(
+                buffer.begin(), buffer.end());
+            THEN("the response is written") {
+                REQUIRE_THAT(buffer,
+                             Catch::Matchers::StartsWith("M125.A OK\n"));
+                REQUIRE(written == buffer.begin() + 10);
+            }
+        }
+    }
+}
+
+SCENARIO("TriggerMotorCapture (M125.T) parser works",
+         "[gcode][parse][m125.t]") {
+    GIVEN("a valid string") {
+        std::string to_parse = "M125.T\r\n";
+        WHEN("calling parse") {
+            auto result = gcode::TriggerMotorCapture::parse(to_parse.cbegin(),
+                                                            to_parse.cend());
+            THEN("it is parsed") {
+                REQUIRE(result.first.has_value());
+                REQUIRE(result.second == to_parse.cbegin() + 6);
+            }
+        }
+    }
+    GIVEN("a string for a different gcode") {
+        std::string to_parse = "M125.TX\r\n";
+        WHEN("calling parse") {
+            auto result = gcode::TriggerMotorCapture::parse(to_parse.cbegin(),
+                                                            to_parse.cend());
+            THEN("nothing should be parsed") {
+                REQUIRE(!result.first.has_value());
+                REQUIRE(result.second == to_parse.cbegin());
+            }
+        }
+    }
+}
+
+SCENARIO("GetMotorCapture (M125) parser works", "[gcode][parse][m125]") {
+    GIVEN("a string with no start") {
+        std::string to_parse = "M125\r\n";
+        WHEN("calling parse") {
+            auto result = gcode::GetMotorCapture::parse(to_parse.cbegin(),
+                                                        to_parse.cend());
+            THEN("it starts from the first sample") {
+                REQUIRE(result.first.has_value());
+                REQUIRE(result.first.value().start == 0);
+                REQUIRE(result.second == to_parse.cbegin() + 4);
+            }
+        }
+    }
+    GIVEN("a string with a start") {
+        std::string to_parse = "M125 I16\r\n";
+        WHEN("calling parse") {
+            auto result = gcode::GetMotorCapture::parse(to_parse.cbegin(),
+                                                        to_parse.cend());
+            THEN("the start is parsed") {
+                REQUIRE(result.first.has_value());
+                REQUIRE(result.first.value().start == 16);
+                REQUIRE(result.second == to_parse.cbegin() + 8);
+            }
+        }
+    }
+    GIVEN("a string for the arm gcode") {
+        std::string to_parse = "M125.A P2 N400\r\n";
+        WHEN("calling parse") {
+            auto result = gcode::GetMotorCapture::parse(to_parse.cbegin(),
+                                                        to_parse.cend());
+            THEN("nothing should be parsed") {
+                REQUIRE(!result.first.has_value());
+                REQUIRE(result.second == to_parse.cbegin());
+            }
+        }
+    }
+    GIVEN("a response buffer large enough for the response") {
+        std::string buffer(256, 'c');
+        auto samples = std::array{
+            motor_telemetry::Sample{
+                .rpm = 998, .setpoint_rpm = 1000, .iq = 1204, .bus_mv = 23950},
+            motor_telemetry::Sample{
+                .rpm = -5, .setpoint_rpm = 0, .iq = -30, .bus_mv = 24010}};
+        WHEN("filling a page") {
+            auto written = gcode::GetMotorCapture::write_response_into(
+                buffer.begin(), buffer.end(), motor_telemetry::Status::DONE, 2,
+                512, 112, 8, samples, samples.size());
+            THEN("the header and samples are written") {
+                std::string expected =
+                    "M125 S:DONE P:2 N:512 T:112 I:8 "
+                    "D:998,1000,1204,23950 -5,0,-30,24010 OK\n";
+                REQUIRE_THAT(buffer, Catch::Matchers::StartsWith(expected));
+                REQUIRE(written == buffer.begin() + expected.size());
+            }
+        }
+        WHEN("filling a response with no samples") {
+            auto written = gcode::GetMotorCapture::write_response_into(
+                buffer.begin(), buffer.end(), motor_telemetry::Status::ARMED,
+                1, 0, 0, 0, samples, 0);
+            THEN("only the header is written") {
+                std::string expected = "M125 S:ARMED P:1 N:0 T:0 I:0 D:OK\n";
+                REQUIRE_THAT(buffer, Catch::Matchers::StartsWith(expected));
+                REQUIRE(written == buffer.begin() + expected.size());
+            }
+        }
+    }
+    GIVEN("a response buffer too small for the samples") {
+        std::string buffer(40, 'c');
+        auto samples = std::array{motor_telemetry::Sample{
+            .rpm = 998, .setpoint_rpm = 1000, .iq = 1204, .bus_mv = 23950}};
+        WHEN("filling the response") {
+            auto written = gcode::GetMotorCapture::write_response_into(
+                buffer.begin(), buffer.end(), motor_telemetry::Status::DONE, 2,
+                512, 112, 8, samples, samples.size());
+            THEN("it stays inside the buffer") {
+                REQUIRE(written <= buffer.end());
+            }
+        }
+    }
+}
@@ -0,0 +1,75 @@
+#include <array>
+
+#include "catch2/catch.hpp"
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-truncation"
+#include "heater-shaker/gcodes.hpp"
+#pragma GCC diagnostic pop
+
+SCENARIO("SetJerk (M205) parser works", "[gcode][parse][m205]") {
+    GIVEN("a string with prefix only") {
+        auto to_parse = std::array{'M', '2', '0', '5', ' ', 'J'};
+
+        WHEN("calling parse") {
+            auto result =
+                gcode::SetJerk::parse(to_parse.cbegin(), to_parse.cend());
+            THEN("nothing should be parsed") {
+                REQUIRE(!result.first.has_value());
+                REQUIRE(result.second == to_parse.cbegin());
+            }
+        }
+    }
+
+    GIVEN("a string with a prefix matching but bad data") {
+        std::string to_parse = "M205 Jalsjdhas\r\n";
+        WHEN("calling parse") {
+            auto result =
+                gcode::SetJerk::parse(to_parse.cbegin(), to_parse.cend());
+
+            THEN("nothing should be parsed") {
+                REQUIRE(!result.first.has_value());
+                REQUIRE(result.second == to_parse.cbegin());
+            }
+        }
+    }
+
+    GIVEN("a string with a matching prefix and positive integral data") {
+        std::string to_parse = "M205 J5000\r\n";
+        WHEN("calling parse") {
+            auto result =
+                gcode::SetJerk::parse(to_parse.cbegin(), to_parse.cend());
+
+            THEN("a gcode should be parsed") {
+                REQUIRE(result.first.has_value());
+                REQUIRE(result.first.value().rpm_per_s2 == 5000);
+                REQUIRE(result.second == to_parse.cbegin() + 10);
+            }
+        }
+    }
+
+    GIVEN("a string turning the jerk limit off") {
+        std::string to_parse = "M205 J0\r\n";
+        WHEN("calling parse") {
+            auto result =
+                gcode::SetJerk::parse(to_parse.cbegin(), to_parse.cend());
+
+            THEN("a gcode should be parsed") {
+                REQUIRE(result.first.has_value());
+                REQUIRE(result.first.value().rpm_per_s2 == 0);
+                REQUIRE(result.second == to_parse.cbegin() + 7);
+            }
+        }
+    }
+
+    GIVEN("a response buffer") {
+        std::string buffer(16, 'c');
+        WHEN("filling the response") {
+            auto written = gcode::SetJerk::write_response_into(buffer.begin(),
+                                                               buffer.end());
+            THEN("the response should be written") {
+                REQUIRE_THAT(buffer, Catch::Matchers::StartsWith("M205 OK\n"));
+                REQUIRE(written == buffer.begin() + 8);
+            }
+        }
+    }
+}
@@ -0,0 +1,74 @@
+#include <array>
+
+#include "catch2/catch.hpp"
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-truncation"
+#include "heater-shaker/gcodes.hpp"
+#pragma GCC diagnostic pop
+
+SCENARIO("StartAutotune (M303) parser works", "[gcode][parse][m303]") {
+    GIVEN("a response buffer large enough for the formatted response") {
+        std::string buffer(64, 'c');
+        WHEN("filling response") {
+            auto written = gcode::StartAutotune::write_response_into(
+                buffer.begin(), buffer.end(), 0.25, 0.0015, 4.5);
+            THEN("the response should be written in full") {
+                REQUIRE_THAT(buffer,
+                             Catch::Matchers::StartsWith(
+                                 "M303 P:0.2500 I:0.0015 D:4.5000 OK\n"));
+                REQUIRE(written == buffer.begin() + 35);
+            }
+        }
+    }
+
+    GIVEN("a response buffer not large enough for the formatted response") {
+        std::string buffer(16, 'c');
+        WHEN("filling response") {
+            auto written = gcode::StartAutotune::write_response_into(
+                buffer.begin(), buffer.begin() + 7, 0.25, 0.0015, 4.5);
+            THEN("the response should write only up to the available space") {
+                std::string response = "M303 Pcccccccccc";
+                response.at(6) = '\0';
+                REQUIRE_THAT(buffer, Catch::Matchers::Equals(response));
+                REQUIRE(written != buffer.begin());
+            }
+        }
+    }
+
+    GIVEN("a valid autotune command") {
+        std::string buffer = "M303 S70.5\n";
+        WHEN("parsing the command") {
+            auto parsed =
+                gcode::StartAutotune::parse(buffer.begin(), buffer.end());
+            THEN("the setpoint is parsed") {
+                REQUIRE(parsed.first.has_value());
+                REQUIRE(parsed.first.value().temperature == 70.5);
+                REQUIRE(parsed.second != buffer.begin());
+            }
+        }
+    }
+
+    GIVEN("an autotune command with a non-positive setpoint") {
+        std::string buffer = "M303 S0\n";
+        WHEN("parsing the command") {
+            auto parsed =
+                gcode::StartAutotune::parse(buffer.begin(), buffer.end());
+            THEN("an error is produced") {
+                REQUIRE(!parsed.first.has_value());
+                REQUIRE(parsed.second == buffer.begin());
+            }
+        }
+    }
+
+    GIVEN("an autotune command without a setpoint") {
+        std::string buffer = "M303\n";
+        WHEN("parsing the command") {
+            auto parsed =
+                gcode::StartAutotune::parse(buffer.begin(), buffer.end());
+            THEN("an error is produced") {
+                REQUIRE(!parsed.first.has_value());
+                REQUIRE(parsed.second == buffer.begin());
+            }
+        }
+    }
+}
@@ -0,0 +1,149 @@
+#include <array>
+
+#include "catch2/catch.hpp"
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-truncation"
+#include "heater-shaker/gcodes.hpp"
+#pragma GCC diagnostic pop
+
+SCENARIO("AddSkipBand (M3.B) parser works", "[gcode][parse][m3.b]") {
+    GIVEN("a string with prefix only") {
+        auto to_parse = std::array{'M', '3', '.', 'B', ' ', 'L'};
+
+        WHEN("calling parse") {
+            auto result =
+                gcode::AddSkipBand::parse(to_parse.cbegin(), to_parse.cend());
+            THEN("nothing should be parsed") {
+                REQUIRE(!result.first.has_value());
+                REQUIRE(result.second == to_parse.cbegin());
+            }
+        }
+    }
+
+    GIVEN("a string missing the high edge") {
+        std::string to_parse = "M3.B L500\r\n";
+        WHEN("calling parse") {
+            auto result =
+                gcode::AddSkipBand::parse(to_parse.cbegin(), to_parse.cend());
+            THEN("nothing should be parsed") {
+                REQUIRE(!result.first.has_value());
+                REQUIRE(result.second == to_parse.cbegin());
+            }
+        }
+    }
+
+    GIVEN("a full string") {
+        std::string to_parse = "M3.B L500 H650\r\n";
+        WHEN("calling parse") {
+            auto result =
+                gcode::AddSkipBand::parse(to_parse.cbegin(), to_parse.cend());
+            THEN("the band is parsed") {
+                REQUIRE(result.first.has_value());
+                REQUIRE(result.first.value().low_rpm == 500);
+                REQUIRE(result.first.value().high_rpm == 650);
+                REQUIRE(result.second == to_parse.cbegin() + 14);
+            }
+        }
+    }
+
+    GIVEN("a response buffer") {
+        std::string buffer(16, 'c');
+        WHEN("filling the response") {
+            auto written = gcode::AddSkipBand::write_response_into(
+                buffer.begin(), buffer.end());
+            THEN("the response should be written") {
+                REQUIRE_THAT(buffer, Catch::Matchers::StartsWith("M3.B OK\n"));
+                REQUIRE(written == buffer.begin() + 8);
+            }
+        }
+    }
+}
+
+SCENARIO("ClearSkipBands (M3.B C) parser works", "[gcode][parse][m3.b]") {
+    GIVEN("a matching string") {
+        std::string to_parse = "M3.B C\r\n";
+        WHEN("calling parse") {
+            auto result = gcode::ClearSkipBands::parse(to_parse.cbegin(),
+                                                       to_parse.cend());
+            THEN("a gcode should be parsed") {
+                REQUIRE(result.first.has_value());
+                REQUIRE(result.second == to_parse.cbegin() + 6);
+            }
+        }
+    }
+
+    GIVEN("a string that only starts the same") {
+        std::string to_parse = "M3.B CX\r\n";
+        WHEN("calling parse") {
+            auto result = gcode::ClearSkipBands::parse(to_parse.cbegin(),
+                                                       to_parse.cend());
+            THEN("nothing should be parsed") {
+                REQUIRE(!result.first.has_value());
+                REQUIRE(result.second == to_parse.cbegin());
+            }
+        }
+    }
+
+    GIVEN("a response buffer") {
+        std::string buffer(16, 'c');
+        WHEN("filling the response") {
+            auto written = gcode::ClearSkipBands::write_response_into(
+                buffer.begin(), buffer.end());
+            THEN("the response should be written") {
+                REQUIRE_THAT(buffer,
+                             Catch::Matchers::StartsWith("M3.B C OK\n"));
+                REQUIRE(written == buffer.begin() + 10);
+            }
+        }
+    }
+}
+
+SCENARIO("GetSkipBands (M3.B) parser works", "[gcode][parse][m3.b]") {
+    GIVEN("a matching string") {
+        std::string to_parse = "M3.B\r\n";
+        WHEN("calling parse") {
+            auto result =
+                gcode::GetSkipBands::parse(to_parse.cbegin(), to_parse.cend());
+            THEN("a gcode should be parsed") {
+                REQUIRE(result.first.has_value());
+                REQUIRE(result.second == to_parse.cbegin() + 4);
+            }
+        }
+    }
+
+    GIVEN("a string that only starts the same") {
+        std::string to_parse = "M3.BX\r\n";
+        WHEN("calling parse") {
+            auto result =
+                gcode::GetSkipBands::parse(to_parse.cbegin(), to_parse.cend());
+            THEN("nothing should be parsed") {
+                REQUIRE(!result.first.has_value());
+                REQUIRE(result.second == to_parse.cbegin());
+            }
+        }
+    }
+
+    GIVEN("a response buffer and some bands") {
+        std::string buffer(64, 'c');
+        auto bands =
+            std::array{skip_bands::Band{.low_rpm = 500, .high_rpm = 650},
+                       skip_bands::Band{.low_rpm = 1200, .high_rpm = 1310}};
+        WHEN("filling the response") {
+            auto written = gcode::GetSkipBands::write_response_into(
+                buffer.begin(), buffer.end(), bands, bands.size());
+            THEN("the bands are listed") {
+                REQUIRE_THAT(buffer, Catch::Matchers::StartsWith(
+                                         "M3.B 500-650 1200-1310 OK\n"));
+                REQUIRE(written == buffer.begin() + 26);
+            }
+        }
+        WHEN("filling the response with no bands") {
+            auto written = gcode::GetSkipBands::write_response_into(
+                buffer.begin(), buffer.end(), bands, 0);
+            THEN("only the framing is written") {
+                REQUIRE_THAT(buffer, Catch::Matchers::StartsWith("M3.B OK\n"));
+                REQUIRE(written == buffer.begin() + 8);
+            }
+        }
+    }
+}
@@ -0,0 +1,164 @@
+#include <array>
+
+#include "catch2/catch.hpp"
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-truncation"
+#include "heater-shaker/gcodes.hpp"
+#pragma GCC diagnostic pop
+
+SCENARIO("AddShakeSegment (M3.P) parser works", "[gcode][parse][m3.p]") {
+    GIVEN("a string with prefix only") {
+        auto to_parse = std::array{'M', '3', '.', 'P', ' ', 'S'};
+
+        WHEN("calling parse") {
+            auto result = gcode::AddShakeSegment::parse(to_parse.cbegin(),
+                                                        to_parse.cend());
+            THEN("nothing should be parsed") {
+                REQUIRE(!result.first.has_value());
+                REQUIRE(result.second == to_parse.cbegin());
+            }
+        }
+    }
+
+    GIVEN("a string missing the dwell") {
+        std::string to_parse = "M3.P S1500 A2000\r\n";
+        WHEN("calling parse") {
+            auto result = gcode::AddShakeSegment::parse(to_parse.cbegin(),
+                                                        to_parse.cend());
+            THEN("nothing should be parsed") {
+                REQUIRE(!result.first.has_value());
+                REQUIRE(result.second == to_parse.cbegin());
+            }
+        }
+    }
+
+    GIVEN("a string with only the required fields") {
+        std::string to_parse = "M3.P S1500 A2000 D10000\r\n";
+        WHEN("calling parse") {
+            auto result = gcode::AddShakeSegment::parse(to_parse.cbegin(),
+                                                        to_parse.cend());
+            THEN("a segment without repeats or a setpoint is parsed") {
+                REQUIRE(result.first.has_value());
+                REQUIRE(result.first.value().rpm == 1500);
+                REQUIRE(result.first.value().ramp_rpm_per_s == 2000);
+                REQUIRE(result.first.value().dwell_ms == 10000);
+                REQUIRE(result.first.value().repeats == 0);
+                REQUIRE(!result.first.value().temperature.has_value());
+                REQUIRE(result.second == to_parse.cbegin() + 23);
+            }
+        }
+    }
+
+    GIVEN("a string with every field") {
+        std::string to_parse = "M3.P S1500 A2000 D10000 R3 H37.5\r\n";
+        WHEN("calling parse") {
+            auto result = gcode::AddShakeSegment::parse(to_parse.cbegin(),
+                                                        to_parse.cend());
+            THEN("the whole segment is parsed") {
+                REQUIRE(result.first.has_value());
+                REQUIRE(result.first.value().repeats == 3);
+                REQUIRE(result.first.value().temperature.value() ==
+                        Approx(37.5));
+                REQUIRE(result.second == to_parse.cbegin() + 32);
+            }
+        }
+    }
+
+    GIVEN("a string with a bad repeat count") {
+        std::string to_parse = "M3.P S1500 A2000 D10000 Rx\r\n";
+        WHEN("calling parse") {
+            auto result = gcode::AddShakeSegment::parse(to_parse.cbegin(),
+                                                        to_parse.cend());
+            THEN("nothing should be parsed") {
+                REQUIRE(!result.first.has_value());
+                REQUIRE(result.second == to_parse.cbegin());
+            }
+        }
+    }
+
+    GIVEN("a response buffer") {
+        std::string buffer(16, 'c');
+        WHEN("filling the response") {
+            auto written = gcode::AddShakeSegment::write_response_into(
+                buffer.begin(), buffer.end());
+            THEN("the response should be written") {
+                REQUIRE_THAT(buffer, Catch::Matchers::StartsWith("M3.P OK\n"));
+                REQUIRE(written == buffer.begin() + 8);
+            }
+        }
+    }
+}
+
+SCENARIO("RunShakeProgram (M3.S) parser works", "[gcode][parse][m3.s]") {
+    GIVEN("a matching string") {
+        std::string to_parse = "M3.S\r\n";
+        WHEN("calling parse") {
+            auto result = gcode::RunShakeProgram::parse(to_parse.cbegin(),
+                                                        to_parse.cend());
+            THEN("a gcode should be parsed") {
+                REQUIRE(result.first.has_value());
+                REQUIRE(result.second == to_parse.cbegin() + 4);
+            }
+        }
+    }
+
+    GIVEN("a string that only starts the same") {
+        std::string to_parse = "M3.SX\r\n";
+        WHEN("calling parse") {
+            auto result = gcode::RunShakeProgram::parse(to_parse.cbegin(),
+                                                        to_parse.cend());
+            THEN("nothing should be parsed") {
+                REQUIRE(!result.first.has_value());
+                REQUIRE(result.second == to_parse.cbegin());
+            }
+        }
+    }
+
+    GIVEN("a response buffer") {
+        std::string buffer(16, 'c');
+        WHEN("filling the segment event") {
+            auto written = gcode::RunShakeProgram::write_segment_into(
+                buffer.begin(), buffer.end(), 12);
+            THEN("the event should be written") {
+                REQUIRE_THAT(buffer,
+                             Catch::Matchers::StartsWith("M3.S SEG:12\n"));
+                REQUIRE(written == buffer.begin() + 12);
+            }
+        }
+        WHEN("filling the done event") {
+            auto written = gcode::RunShakeProgram::write_done_into(
+                buffer.begin(), buffer.end());
+            THEN("the event should be written") {
+                REQUIRE_THAT(buffer,
+                             Catch::Matchers::StartsWith("M3.S DONE\n"));
+                REQUIRE(written == buffer.begin() + 10);
+            }
+        }
+    }
+}
+
+SCENARIO("ClearShakeProgram (M3.C) parser works", "[gcode][parse][m3.c]") {
+    GIVEN("a matching string") {
+        std::string to_parse = "M3.C\r\n";
+        WHEN("calling parse") {
+            auto result = gcode::ClearShakeProgram::parse(to_parse.cbegin(),
+                                                          to_parse.cend());
+            THEN("a gcode should be parsed") {
+                REQUIRE(result.first.has_value());
+                REQUIRE(result.second == to_parse.cbegin() + 4);
+            }
+        }
+    }
+
+    GIVEN("a response buffer") {
+        std::string buffer(16, 'c');
+        WHEN("filling the response") {
+            auto written = gcode::ClearShakeProgram::write_response_into(
+                buffer.begin(), buffer.end());
+            THEN("the response should be written") {
+                REQUIRE_THAT(buffer, Catch::Matchers::StartsWith("M3.C OK\n"));
+                REQUIRE(written == buffer.begin() + 8);
+            }
+        }
+    }
+}
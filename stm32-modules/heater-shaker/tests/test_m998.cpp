@@ -0,0 +1,74 @@
+#include <array>
+
+#include "catch2/catch.hpp"
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-truncation"
+#include "heater-shaker/gcodes.hpp"
+#pragma GCC diagnostic pop
+
+SCENARIO("SetPowerSupply (M998) parser works", "[gcode][parse][m998]") {
+    GIVEN("a string with prefix only") {
+        auto to_parse = std::array{'M', '9', '9', '8', ' ', 'S'};
+
+        WHEN("calling parse") {
+            auto result = gcode::SetPowerSupply::parse(to_parse.cbegin(),
+                                                       to_parse.cend());
+            THEN("nothing should be parsed") {
+                REQUIRE(!result.first.has_value());
+                REQUIRE(result.second == to_parse.cbegin());
+            }
+        }
+    }
+
+    GIVEN("a string with a prefix matching but bad data") {
+        std::string to_parse = "M998 Salsjdhas\r\n";
+        WHEN("calling parse") {
+            auto result = gcode::SetPowerSupply::parse(to_parse.cbegin(),
+                                                       to_parse.cend());
+
+            THEN("nothing should be parsed") {
+                REQUIRE(!result.first.has_value());
+                REQUIRE(result.second == to_parse.cbegin());
+            }
+        }
+    }
+
+    GIVEN("a string with a negative supply") {
+        std::string to_parse = "M998 S-10\r\n";
+        WHEN("calling parse") {
+            auto result = gcode::SetPowerSupply::parse(to_parse.cbegin(),
+                                                       to_parse.cend());
+
+            THEN("nothing should be parsed") {
+                REQUIRE(!result.first.has_value());
+                REQUIRE(result.second == to_parse.cbegin());
+            }
+        }
+    }
+
+    GIVEN("a string with a matching prefix and a supply") {
+        std::string to_parse = "M998 S92.5\r\n";
+        WHEN("calling parse") {
+            auto result = gcode::SetPowerSupply::parse(to_parse.cbegin(),
+                                                       to_parse.cend());
+
+            THEN("a gcode should be parsed") {
+                REQUIRE(result.first.has_value());
+                REQUIRE(result.first.value().watts == 92.5);
+                REQUIRE(result.second == to_parse.cbegin() + 10);
+            }
+        }
+    }
+
+    GIVEN("a response buffer") {
+        std::string buffer(16, 'c');
+        WHEN("filling the response") {
+            auto written = gcode::SetPowerSupply::write_response_into(
+                buffer.begin(), buffer.end());
+            THEN("the response should be written") {
+                REQUIRE_THAT(buffer, Catch::Matchers::StartsWith("M998 OK\n"));
+                REQUIRE(written == buffer.begin() + 8);
+            }
+        }
+    }
+}
@@ -9,13 +9,32 @@ TestMotorPolicy::TestMotorPolicy(int16_t initial_rpm,
                                  int32_t initial_ramp_rate)
     : target_rpm(initial_target_rpm),
       current_rpm(initial_rpm),
-      ramp_rate(initial_ramp_rate) {}
+      ramp_rate(initial_ramp_rate) {
+    stored_skip_bands.fill(UINT64_MAX);
+}
 
 auto TestMotorPolicy::set_rpm(int16_t rpm) -> errors::ErrorCode {
     target_rpm = rpm;
+    segment_ticks = 0;
+    return set_rpm_return;
+}
+
+auto TestMotorPolicy::validate_rpm(int16_t rpm) const -> errors::ErrorCode {
+    static_cast<void>(rpm);
+    return set_rpm_return;
+}
+
+auto TestMotorPolicy::set_rpm_segment(int16_t rpm, uint16_t ramp_ticks)
+    -> errors::ErrorCode {
+    target_rpm = rpm;
+    segment_ticks = ramp_ticks;
     return set_rpm_return;
 }
 
+auto TestMotorPolicy::test_get_segment_ticks() const -> uint16_t {
+    return segment_ticks;
+}
+
 auto TestMotorPolicy::get_current_rpm() const -> int16_t { return current_rpm; }
 
 auto TestMotorPolicy::get_target_rpm() const -> int16_t { return target_rpm; }
@@ -35,6 +54,12 @@ auto TestMotorPolicy::set_ramp_rate(int32_t new_ramp_rate)
     return set_ramp_rate_return;
 }
 
+auto TestMotorPolicy::validate_ramp_rate(int32_t new_ramp_rate) const
+    -> errors::ErrorCode {
+    static_cast<void>(new_ramp_rate);
+    return set_ramp_rate_return;
+}
+
 auto TestMotorPolicy::test_get_ramp_rate() -> int32_t { return ramp_rate; }
 
 auto TestMotorPolicy::test_set_ramp_rate_return_code(errors::ErrorCode error)
@@ -72,6 +97,121 @@ auto TestMotorPolicy::delay_ticks(uint16_t ticks) -> void {
     last_delay = ticks;
 }
 
+auto TestMotorPolicy::homing_wakeup_arm(uint16_t ticks, int16_t low_rpm,
+                                        int16_t high_rpm) -> void {
+    homing_wakeup_armed = true;
+    homing_wakeup_ticks = ticks;
+    homing_wakeup_low_rpm = low_rpm;
+    homing_wakeup_high_rpm = high_rpm;
+}
+
+auto TestMotorPolicy::homing_wakeup_disarm() -> void {
+    homing_wakeup_armed = false;
+}
+
+auto TestMotorPolicy::speed_profile_wakeup_arm(uint16_t ticks) -> void {
+    speed_profile_wakeup_armed = true;
+    speed_profile_wakeup_ticks = ticks;
+}
+
+auto TestMotorPolicy::speed_profile_wakeup_disarm() -> void {
+    speed_profile_wakeup_armed = false;
+}
+
+auto TestMotorPolicy::shake_program_wakeup_arm(uint16_t ticks,
+                                               uint32_t generation) -> void {
+    shake_program_wakeup_armed = true;
+    shake_program_wakeup_ticks = ticks;
+    shake_program_wakeup_generation = generation;
+}
+
+auto TestMotorPolicy::shake_program_wakeup_disarm() -> void {
+    shake_program_wakeup_armed = false;
+}
+
+auto TestMotorPolicy::motor_capture() -> motor_telemetry::MotorCapture& {
+    return capture;
+}
+
+auto TestMotorPolicy::get_loop_timing() const -> loop_timing::MotorLoopTiming {
+    return timing;
+}
+
+auto TestMotorPolicy::reset_loop_timing() -> void { ++loop_timing_resets; }
+
+auto TestMotorPolicy::test_set_loop_timing(
+    const loop_timing::MotorLoopTiming& new_timing) -> void {
+    timing = new_timing;
+}
+
+auto TestMotorPolicy::test_loop_timing_resets() const -> uint32_t {
+    return loop_timing_resets;
+}
+
+auto TestMotorPolicy::read_skip_bands() const
+    -> skip_bands::MotorSkipBands::Stored {
+    return stored_skip_bands;
+}
+
+auto TestMotorPolicy::write_skip_bands(
+    const skip_bands::MotorSkipBands::Stored& words) -> bool {
+    if (write_skip_bands_return) {
+        stored_skip_bands = words;
+    }
+    return write_skip_bands_return;
+}
+
+auto TestMotorPolicy::test_set_stored_skip_bands(
+    const skip_bands::MotorSkipBands::Stored& words) -> void {
+    stored_skip_bands = words;
+}
+
+auto TestMotorPolicy::test_stored_skip_bands() const
+    -> skip_bands::MotorSkipBands::Stored {
+    return stored_skip_bands;
+}
+
+auto TestMotorPolicy::test_set_write_skip_bands_return(bool ok) -> void {
+    write_skip_bands_return = ok;
+}
+
+auto TestMotorPolicy::test_shake_program_wakeup_armed() const -> bool {
+    return shake_program_wakeup_armed;
+}
+
+auto TestMotorPolicy::test_shake_program_wakeup_ticks() const -> uint16_t {
+    return shake_program_wakeup_ticks;
+}
+
+auto TestMotorPolicy::test_shake_program_wakeup_generation() const
+    -> uint32_t {
+    return shake_program_wakeup_generation;
+}
+
+auto TestMotorPolicy::test_speed_profile_wakeup_armed() const -> bool {
+    return speed_profile_wakeup_armed;
+}
+
+auto TestMotorPolicy::test_speed_profile_wakeup_ticks() const -> uint16_t {
+    return speed_profile_wakeup_ticks;
+}
+
+auto TestMotorPolicy::test_homing_wakeup_armed() const -> bool {
+    return homing_wakeup_armed;
+}
+
+auto TestMotorPolicy::test_homing_wakeup_ticks() const -> uint16_t {
+    return homing_wakeup_ticks;
+}
+
+auto TestMotorPolicy::test_homing_wakeup_low_rpm() const -> int16_t {
+    return homing_wakeup_low_rpm;
+}
+
+auto TestMotorPolicy::test_homing_wakeup_high_rpm() const -> int16_t {
+    return homing_wakeup_high_rpm;
+}
+
 auto TestMotorPolicy::plate_lock_set_power(float power) -> void {
     plate_lock_power = power;
     plate_lock_enabled = true;
@@ -101,6 +241,23 @@ auto TestMotorPolicy::test_plate_lock_braked() const -> bool {
     return plate_lock_braked;
 }
 
+auto TestMotorPolicy::plate_lock_timeout_arm(uint16_t ticks) -> void {
+    plate_lock_timeout_armed = true;
+    plate_lock_timeout_ticks = ticks;
+}
+
+auto TestMotorPolicy::plate_lock_timeout_disarm() -> void {
+    plate_lock_timeout_armed = false;
+}
+
+auto TestMotorPolicy::test_plate_lock_timeout_armed() const -> bool {
+    return plate_lock_timeout_armed;
+}
+
+auto TestMotorPolicy::test_plate_lock_timeout_ticks() const -> uint16_t {
+    return plate_lock_timeout_ticks;
+}
+
 auto TestMotorPolicy::plate_lock_open_sensor_read() const -> bool {
     if (!plate_lock_braked) {
         return false;
@@ -1,7 +1,10 @@
+#include <vector>
+
 #include "catch2/catch.hpp"
 #include "heater-shaker/errors.hpp"
 #include "heater-shaker/messages.hpp"
 #include "heater-shaker/motor_task.hpp"
+#include "heater-shaker/power_budget.hpp"
 #include "test/task_builder.hpp"
 
 SCENARIO("motor task core message handling", "[motor]") {
@@ -68,6 +71,12 @@ SCENARIO("motor task core message handling", "[motor]") {
                     REQUIRE(!tasks->get_motor_policy().test_solenoid_engaged());
                     REQUIRE(tasks->get_motor_policy().get_target_rpm() == 1254);
                 }
+                AND_THEN("the task should publish its power demand") {
+                    auto& budget = tasks->get_tasks_aggregator().power_budget;
+                    REQUIRE(budget.demand(power::MOTOR) ==
+                            Approx(1254 / power::MOTOR_FULL_POWER_RPM)
+                                .epsilon(0.001));
+                }
                 AND_THEN(
                     "the task should respond to the message to the host "
                     "comms") {
@@ -177,6 +186,369 @@ SCENARIO("motor task core message handling", "[motor]") {
     }
 }
 
+SCENARIO("motor task s-curve speed changes", "[motor]") {
+    GIVEN("a motor task with the plate lock closed") {
+        auto tasks = TaskBuilder::build();
+        using MotorTask = motor_task::MotorTask<TestMessageQueue>;
+        tasks->get_motor_queue().backing_deque.push_back(
+            messages::PlateLockComplete{.open = false, .closed = true});
+        tasks->get_motor_task().run_once(tasks->get_motor_policy());
+        auto run_motor = [&tasks](const messages::MotorMessage& message) {
+            tasks->get_motor_queue().backing_deque.push_back(message);
+            tasks->get_motor_task().run_once(tasks->get_motor_policy());
+            auto response = tasks->get_host_comms_queue().backing_deque.front();
+            tasks->get_host_comms_queue().backing_deque.pop_front();
+            return response;
+        };
+        WHEN("setting a jerk limit out of range") {
+            auto response = run_motor(messages::SetJerkMessage{
+                .id = 12, .rpm_per_s2 = MotorTask::MIN_JERK_RPM_PER_S2 - 1});
+            THEN("it is refused") {
+                auto ack = std::get<messages::AcknowledgePrevious>(response);
+                REQUIRE(ack.responding_to_id == 12);
+                REQUIRE(ack.with_error ==
+                        errors::ErrorCode::MOTOR_ILLEGAL_JERK);
+            }
+        }
+        WHEN("changing speed without a jerk limit") {
+            static_cast<void>(run_motor(
+                messages::SetRPMMessage{.id = 1, .target_rpm = 1000}));
+            THEN("the motor driver ramps straight to the target") {
+                REQUIRE(tasks->get_motor_policy().get_target_rpm() == 1000);
+                REQUIRE(tasks->get_motor_policy().test_get_segment_ticks() ==
+                        0);
+                REQUIRE(!tasks->get_motor_policy()
+                             .test_speed_profile_wakeup_armed());
+            }
+        }
+        WHEN("changing speed with a jerk limit") {
+            auto jerk_ack = std::get<messages::AcknowledgePrevious>(run_motor(
+                messages::SetJerkMessage{.id = 12, .rpm_per_s2 = 4000}));
+            REQUIRE(jerk_ack.with_error == errors::ErrorCode::NO_ERROR);
+            auto ack = std::get<messages::AcknowledgePrevious>(run_motor(
+                messages::SetRPMMessage{.id = 1, .target_rpm = 1000}));
+            THEN("the change is acknowledged straight away") {
+                REQUIRE(ack.responding_to_id == 1);
+                REQUIRE(ack.with_error == errors::ErrorCode::NO_ERROR);
+                REQUIRE(tasks->get_motor_task().get_state() ==
+                        motor_task::State::RUNNING);
+            }
+            THEN("the first segment barely moves") {
+                REQUIRE(tasks->get_motor_policy().test_get_segment_ticks() ==
+                        MotorTask::SPEED_PROFILE_SEGMENT_TICKS);
+                REQUIRE(tasks->get_motor_policy().get_target_rpm() < 5);
+                REQUIRE(tasks->get_motor_policy()
+                            .test_speed_profile_wakeup_armed());
+                REQUIRE(tasks->get_motor_policy()
+                            .test_speed_profile_wakeup_ticks() ==
+                        MotorTask::SPEED_PROFILE_SEGMENT_TICKS);
+            }
+            THEN("the setpoint reported is the target of the whole change") {
+                auto rpm = std::get<messages::GetRPMResponse>(
+                    run_motor(messages::GetRPMMessage{.id = 3}));
+                REQUIRE(rpm.setpoint_rpm == 1000);
+            }
+            AND_WHEN("the profile runs to the end") {
+                size_t segments = 1;
+                int16_t last_rpm = tasks->get_motor_policy().get_target_rpm();
+                bool rising = true;
+                while (tasks->fire_speed_profile_wakeup()) {
+                    tasks->get_motor_task().run_once(
+                        tasks->get_motor_policy());
+                    if (tasks->get_motor_policy()
+                            .test_speed_profile_wakeup_armed()) {
+                        ++segments;
+                        rising = rising &&
+                                 (tasks->get_motor_policy().get_target_rpm() >=
+                                  last_rpm);
+                        last_rpm = tasks->get_motor_policy().get_target_rpm();
+                    }
+                }
+                THEN("it takes the ramp time plus one jerk period") {
+                    // 1000 rpm at 1000 rpm/s, plus 1000 / 4000 s, in 20 ms
+                    // segments
+                    REQUIRE(segments == 63);
+                    REQUIRE(rising);
+                    REQUIRE(tasks->get_motor_policy().get_target_rpm() == 1000);
+                    REQUIRE(
+                        tasks->get_host_comms_queue().backing_deque.empty());
+                }
+            }
+            AND_WHEN("stopping partway") {
+                static_cast<void>(tasks->fire_speed_profile_wakeup());
+                tasks->get_motor_task().run_once(tasks->get_motor_policy());
+                static_cast<void>(run_motor(
+                    messages::SetRPMMessage{.id = 2, .target_rpm = 0}));
+                THEN("the profile is abandoned") {
+                    REQUIRE(tasks->get_motor_policy().get_target_rpm() == 0);
+                    REQUIRE(!tasks->get_motor_policy()
+                                 .test_speed_profile_wakeup_armed());
+                }
+                AND_THEN("a wakeup already on its way is ignored") {
+                    tasks->get_motor_queue().backing_deque.push_back(
+                        messages::SpeedProfileStepMessage{});
+                    tasks->get_motor_task().run_once(tasks->get_motor_policy());
+                    REQUIRE(tasks->get_motor_policy().get_target_rpm() == 0);
+                }
+            }
+        }
+        WHEN("raising the acceleration limit first") {
+            static_cast<void>(run_motor(
+                messages::SetAccelerationMessage{.id = 11, .rpm_per_s = 4000}));
+            static_cast<void>(run_motor(
+                messages::SetJerkMessage{.id = 12, .rpm_per_s2 = 4000}));
+            static_cast<void>(run_motor(
+                messages::SetRPMMessage{.id = 1, .target_rpm = 1000}));
+            size_t segments = 1;
+            while (tasks->fire_speed_profile_wakeup()) {
+                tasks->get_motor_task().run_once(tasks->get_motor_policy());
+                if (tasks->get_motor_policy()
+                        .test_speed_profile_wakeup_armed()) {
+                    ++segments;
+                }
+            }
+            THEN("the change never reaches it and is shorter") {
+                // 2 * sqrt(1000 / 4000) s in 20 ms segments
+                REQUIRE(segments == 50);
+                REQUIRE(tasks->get_motor_policy().get_target_rpm() == 1000);
+            }
+        }
+    }
+}
+
+SCENARIO("motor task shake programs", "[motor]") {
+    GIVEN("a motor task with the plate lock closed") {
+        auto tasks = TaskBuilder::build();
+        using MotorTask = motor_task::MotorTask<TestMessageQueue>;
+        tasks->get_motor_queue().backing_deque.push_back(
+            messages::PlateLockComplete{.open = false, .closed = true});
+        tasks->get_motor_task().run_once(tasks->get_motor_policy());
+        auto& comms = tasks->get_host_comms_queue().backing_deque;
+        auto run_motor = [&tasks](const messages::MotorMessage& message) {
+            tasks->get_motor_queue().backing_deque.push_back(message);
+            tasks->get_motor_task().run_once(tasks->get_motor_policy());
+        };
+        auto next_response = [&comms]() {
+            auto response = comms.front();
+            comms.pop_front();
+            return response;
+        };
+        auto fire_wakeup = [&tasks]() {
+            REQUIRE(tasks->fire_shake_program_wakeup());
+            tasks->get_motor_task().run_once(tasks->get_motor_policy());
+        };
+        WHEN("running an empty program") {
+            run_motor(messages::RunShakeProgramMessage{.id = 3});
+            THEN("it is refused") {
+                auto ack =
+                    std::get<messages::AcknowledgePrevious>(next_response());
+                REQUIRE(ack.responding_to_id == 3);
+                REQUIRE(ack.with_error ==
+                        errors::ErrorCode::MOTOR_PROGRAM_EMPTY);
+                REQUIRE(comms.empty());
+                REQUIRE(tasks->get_motor_policy().get_target_rpm() == 0);
+            }
+        }
+        WHEN("adding a segment with no ramp rate") {
+            run_motor(messages::AddShakeSegmentMessage{
+                .id = 2,
+                .segment = {.rpm = 1000, .ramp_rpm_per_s = 0, .dwell_ms = 10}});
+            THEN("it is refused") {
+                auto ack =
+                    std::get<messages::AcknowledgePrevious>(next_response());
+                REQUIRE(ack.with_error ==
+                        errors::ErrorCode::MOTOR_ILLEGAL_RAMP_RATE);
+            }
+        }
+        WHEN("adding a segment faster than the motor can ramp") {
+            tasks->get_motor_policy().test_set_ramp_rate_return_code(
+                errors::ErrorCode::MOTOR_ILLEGAL_RAMP_RATE);
+            run_motor(messages::AddShakeSegmentMessage{
+                .id = 2,
+                .segment = {
+                    .rpm = 1000, .ramp_rpm_per_s = 50000, .dwell_ms = 10}});
+            THEN("it is refused when added rather than when run") {
+                auto ack =
+                    std::get<messages::AcknowledgePrevious>(next_response());
+                REQUIRE(ack.with_error ==
+                        errors::ErrorCode::MOTOR_ILLEGAL_RAMP_RATE);
+                run_motor(messages::RunShakeProgramMessage{.id = 3});
+                ack = std::get<messages::AcknowledgePrevious>(next_response());
+                REQUIRE(ack.with_error ==
+                        errors::ErrorCode::MOTOR_PROGRAM_EMPTY);
+            }
+        }
+        WHEN("adding more segments than fit") {
+            for (size_t i = 0; i < MotorTask::SHAKE_PROGRAM_CAPACITY; ++i) {
+                run_motor(messages::AddShakeSegmentMessage{
+                    .id = 2,
+                    .segment = {.rpm = 1000,
+                                .ramp_rpm_per_s = 1000,
+                                .dwell_ms = 10}});
+                auto ack =
+                    std::get<messages::AcknowledgePrevious>(next_response());
+                REQUIRE(ack.with_error == errors::ErrorCode::NO_ERROR);
+            }
+            run_motor(messages::AddShakeSegmentMessage{
+                .id = 2,
+                .segment = {
+                    .rpm = 1000, .ramp_rpm_per_s = 1000, .dwell_ms = 10}});
+            THEN("the last one is refused") {
+                auto ack =
+                    std::get<messages::AcknowledgePrevious>(next_response());
+                REQUIRE(ack.with_error ==
+                        errors::ErrorCode::MOTOR_PROGRAM_FULL);
+            }
+        }
+        WHEN("running a program that repeats") {
+            run_motor(messages::AddShakeSegmentMessage{
+                .id = 1,
+                .segment = {.rpm = 1000,
+                            .ramp_rpm_per_s = 2000,
+                            .dwell_ms = 1500,
+                            .temperature = 37.0}});
+            run_motor(messages::AddShakeSegmentMessage{
+                .id = 2,
+                .segment = {.rpm = 2000,
+                            .ramp_rpm_per_s = 4000,
+                            .dwell_ms = 750,
+                            .repeats = 1}});
+            comms.clear();
+            run_motor(messages::RunShakeProgramMessage{.id = 3});
+            THEN("the run is acknowledged and the first segment starts") {
+                auto ack =
+                    std::get<messages::AcknowledgePrevious>(next_response());
+                REQUIRE(ack.responding_to_id == 3);
+                REQUIRE(ack.with_error == errors::ErrorCode::NO_ERROR);
+                auto event = std::get<messages::ShakeProgramEventMessage>(
+                    next_response());
+                REQUIRE(event.segment == 0);
+                REQUIRE(!event.done);
+                REQUIRE(tasks->get_motor_task().get_state() ==
+                        motor_task::State::RUNNING);
+                REQUIRE(tasks->get_motor_policy().get_target_rpm() == 1000);
+                REQUIRE(tasks->get_motor_policy().test_get_ramp_rate() ==
+                        2000);
+            }
+            THEN("the heater setpoint is changed") {
+                auto setpoint = std::get<messages::SetTemperatureMessage>(
+                    tasks->get_heater_queue().backing_deque.front());
+                REQUIRE(setpoint.target_temperature == 37.0);
+                REQUIRE(setpoint.from_motor);
+            }
+            THEN("the wakeup covers the ramp and the dwell") {
+                // 1000 rpm at 2000 rpm/s, then 1500 ms
+                REQUIRE(tasks->get_motor_policy()
+                            .test_shake_program_wakeup_ticks() == 2000);
+            }
+            AND_WHEN("the program runs to the end") {
+                comms.clear();
+                tasks->get_motor_policy().test_set_current_rpm(1000);
+                fire_wakeup();
+                REQUIRE(tasks->get_motor_policy().get_target_rpm() == 2000);
+                // 1000 rpm at 4000 rpm/s, then 750 ms
+                REQUIRE(tasks->get_motor_policy()
+                            .test_shake_program_wakeup_ticks() == 1000);
+                tasks->get_motor_policy().test_set_current_rpm(2000);
+                fire_wakeup();
+                REQUIRE(tasks->get_motor_policy().get_target_rpm() == 1000);
+                tasks->get_motor_policy().test_set_current_rpm(1000);
+                fire_wakeup();
+                REQUIRE(tasks->get_motor_policy().get_target_rpm() == 2000);
+                tasks->get_motor_policy().test_set_current_rpm(2000);
+                fire_wakeup();
+                THEN("each segment start is reported and then the end") {
+                    std::vector<uint16_t> segments;
+                    while (comms.size() > 1) {
+                        segments.push_back(
+                            std::get<messages::ShakeProgramEventMessage>(
+                                next_response())
+                                .segment);
+                    }
+                    REQUIRE(segments == std::vector<uint16_t>{1, 0, 1});
+                    auto done = std::get<messages::ShakeProgramEventMessage>(
+                        next_response());
+                    REQUIRE(done.done);
+                }
+                THEN("the motor keeps its speed and the M204 ramp rate") {
+                    REQUIRE(tasks->get_motor_policy().get_target_rpm() ==
+                            2000);
+                    REQUIRE(tasks->get_motor_policy().test_get_ramp_rate() ==
+                            MotorTask::DEFAULT_ACCELERATION_RPM_PER_S);
+                    REQUIRE(!tasks->get_motor_policy()
+                                 .test_shake_program_wakeup_armed());
+                }
+            }
+            AND_WHEN("a new speed is set partway") {
+                run_motor(messages::SetRPMMessage{.id = 4, .target_rpm = 500});
+                THEN("the program stops") {
+                    REQUIRE(!tasks->get_motor_policy()
+                                 .test_shake_program_wakeup_armed());
+                    REQUIRE(tasks->get_motor_policy().get_target_rpm() == 500);
+                }
+                AND_THEN("a wakeup already on its way is ignored") {
+                    const auto generation =
+                        tasks->get_motor_policy()
+                            .test_shake_program_wakeup_generation();
+                    run_motor(messages::ShakeProgramStepMessage{
+                        .generation = generation});
+                    REQUIRE(tasks->get_motor_policy().get_target_rpm() == 500);
+                }
+            }
+            AND_WHEN("the program is run again before a wakeup arrives") {
+                const auto stale = tasks->get_motor_policy()
+                                       .test_shake_program_wakeup_generation();
+                run_motor(messages::RunShakeProgramMessage{.id = 5});
+                comms.clear();
+                tasks->get_motor_policy().test_set_current_rpm(1000);
+                run_motor(
+                    messages::ShakeProgramStepMessage{.generation = stale});
+                THEN("the wakeup from the first run doesn't advance it") {
+                    REQUIRE(comms.empty());
+                    REQUIRE(tasks->get_motor_policy().get_target_rpm() == 1000);
+                    REQUIRE(tasks->get_motor_policy()
+                                .test_shake_program_wakeup_generation() !=
+                            stale);
+                }
+            }
+            AND_WHEN("the heater refuses the setpoint") {
+                comms.clear();
+                run_motor(messages::AcknowledgePrevious{
+                    .responding_to_id = 0,
+                    .with_error =
+                        errors::ErrorCode::HEATER_HARDWARE_ERROR_LATCH});
+                THEN("the error is passed on to the host") {
+                    auto error =
+                        std::get<messages::ErrorMessage>(next_response());
+                    REQUIRE(error.code ==
+                            errors::ErrorCode::HEATER_HARDWARE_ERROR_LATCH);
+                }
+            }
+        }
+        WHEN("running a segment with a long dwell") {
+            run_motor(messages::AddShakeSegmentMessage{
+                .id = 1,
+                .segment = {.rpm = 1000,
+                            .ramp_rpm_per_s = 1000,
+                            .dwell_ms = 99000}});
+            run_motor(messages::RunShakeProgramMessage{.id = 3});
+            comms.clear();
+            THEN("the dwell is waited out in pieces") {
+                REQUIRE(tasks->get_motor_policy()
+                            .test_shake_program_wakeup_ticks() == 65535);
+                fire_wakeup();
+                REQUIRE(tasks->get_motor_policy()
+                            .test_shake_program_wakeup_ticks() == 34465);
+                REQUIRE(comms.empty());
+                fire_wakeup();
+                REQUIRE(std::get<messages::ShakeProgramEventMessage>(
+                            comms.front())
+                            .done);
+            }
+        }
+    }
+}
+
 SCENARIO("motor task error handling", "[motor]") {
     GIVEN("a motor task") {
         auto tasks = TaskBuilder::build();
@@ -507,12 +879,19 @@ SCENARIO("motor task homing", "[motor][homing]") {
                 1.1);
             tasks->get_motor_task().run_once(tasks->get_motor_policy());
             THEN("the task remains in moving-to-speed and waits for the rpm") {
+                using MotorTask =
+                    std::remove_cvref_t<decltype(tasks->get_motor_task())>;
+                auto& policy = tasks->get_motor_policy();
                 REQUIRE(tasks->get_motor_task().get_state() ==
                         motor_task::State::HOMING_MOVING_TO_HOME_SPEED);
-                REQUIRE(!tasks->get_motor_policy().test_solenoid_engaged());
-                REQUIRE(
-                    std::holds_alternative<messages::CheckHomingStatusMessage>(
-                        tasks->get_motor_queue().backing_deque.front()));
+                REQUIRE(!policy.test_solenoid_engaged());
+                REQUIRE(tasks->get_motor_queue().backing_deque.empty());
+                REQUIRE(policy.test_homing_wakeup_armed());
+                REQUIRE(policy.test_homing_wakeup_low_rpm() ==
+                        MotorTask::HOMING_ROTATION_LIMIT_LOW_RPM);
+                REQUIRE(policy.test_homing_wakeup_high_rpm() ==
+                        MotorTask::HOMING_ROTATION_LIMIT_HIGH_RPM);
+                REQUIRE(policy.test_get_last_delay() == 0);
             }
         }
     }
@@ -542,14 +921,13 @@ SCENARIO("motor task homing", "[motor][homing]") {
         tasks->get_motor_task().run_once(tasks->get_motor_policy());
         CHECK(tasks->get_motor_task().get_state() ==
               motor_task::State::HOMING_COASTING_TO_STOP);
+        CHECK(tasks->get_motor_policy().test_homing_wakeup_armed());
         WHEN("receiving an error") {
             tasks->get_motor_queue().backing_deque.push_back(
                 messages::MotorSystemErrorMessage{.errors = 0x2});
-            // This must run twice to handle the check-status message from the
-            // timeout mechanism before the error message
-            tasks->get_motor_task().run_once(tasks->get_motor_policy());
             tasks->get_motor_task().run_once(tasks->get_motor_policy());
             THEN("the task goes to homed state and lowers solenoid current") {
+                REQUIRE(!tasks->get_motor_policy().test_homing_wakeup_armed());
                 REQUIRE(tasks->get_motor_task().get_state() ==
                         motor_task::State::STOPPED_HOMED);
                 REQUIRE(tasks->get_motor_policy().test_solenoid_engaged());
@@ -570,12 +948,14 @@ SCENARIO("motor task homing", "[motor][homing]") {
                  i++) {
                 CHECK(tasks->get_motor_task().get_state() ==
                       motor_task::State::HOMING_COASTING_TO_STOP);
+                CHECK(tasks->fire_homing_wakeup());
                 tasks->get_motor_task().run_once(tasks->get_motor_policy());
                 CHECK(tasks->get_motor_policy().test_solenoid_current() ==
                       std::remove_cvref_t<decltype(tasks->get_motor_task())>::
                           HOMING_SOLENOID_CURRENT_INITIAL);
                 CHECK(tasks->get_host_comms_queue().backing_deque.empty());
             }
+            CHECK(tasks->fire_homing_wakeup());
             tasks->get_motor_task().run_once(tasks->get_motor_policy());
             THEN("the home timeout should fire") {
                 auto ack_message = std::get<messages::AcknowledgePrevious>(
@@ -587,6 +967,95 @@ SCENARIO("motor task homing", "[motor][homing]") {
             }
         }
     }
+
+    GIVEN("a motor task waiting for the homing speed") {
+        using MotorTask = motor_task::MotorTask<TestMessageQueue>;
+        auto tasks = TaskBuilder::build();
+        auto& policy = tasks->get_motor_policy();
+        tasks->get_motor_queue().backing_deque.push_back(
+            messages::PlateLockComplete{.open = false, .closed = true});
+        tasks->get_motor_task().run_once(policy);
+        tasks->get_motor_queue().backing_deque.push_back(
+            messages::BeginHomingMessage{.id = 2213});
+        tasks->get_motor_task().run_once(policy);
+        tasks->get_motor_task().run_once(policy);
+        CHECK(tasks->get_motor_task().get_state() ==
+              motor_task::State::HOMING_MOVING_TO_HOME_SPEED);
+        CHECK(policy.test_homing_wakeup_armed());
+        tasks->get_host_comms_queue().backing_deque.clear();
+        WHEN("asking for the rpm") {
+            tasks->get_motor_queue().backing_deque.push_back(
+                messages::GetRPMMessage{.id = 55});
+            tasks->get_motor_task().run_once(policy);
+            THEN("the task answers straight away without delaying") {
+                REQUIRE(policy.test_get_last_delay() == 0);
+                REQUIRE(std::holds_alternative<messages::GetRPMResponse>(
+                    tasks->get_host_comms_queue().backing_deque.front()));
+                AND_THEN("homing carries on") {
+                    REQUIRE(tasks->get_motor_task().get_state() ==
+                            motor_task::State::HOMING_MOVING_TO_HOME_SPEED);
+                    REQUIRE(policy.test_homing_wakeup_armed());
+                }
+            }
+        }
+        WHEN("the motor reaches the homing speed and the wakeup fires") {
+            policy.test_set_current_rpm(
+                (MotorTask::HOMING_ROTATION_LIMIT_LOW_RPM +
+                 MotorTask::HOMING_ROTATION_LIMIT_HIGH_RPM) /
+                2);
+            REQUIRE(tasks->fire_homing_wakeup());
+            tasks->get_motor_task().run_once(policy);
+            THEN("the task coasts with a timer-only wakeup") {
+                REQUIRE(tasks->get_motor_task().get_state() ==
+                        motor_task::State::HOMING_COASTING_TO_STOP);
+                REQUIRE(policy.test_homing_wakeup_armed());
+                REQUIRE(policy.test_homing_wakeup_low_rpm() >=
+                        policy.test_homing_wakeup_high_rpm());
+            }
+            THEN("the solenoid gets a double wait before the first check") {
+                REQUIRE(policy.test_homing_wakeup_ticks() ==
+                        MotorTask::HOMING_ENGAGE_WAIT_TICKS);
+            }
+            AND_WHEN("the plate never settles") {
+                // A margin past the 1200-tick coast, in case it never ends
+                constexpr uint32_t coast_limit = 2000;
+                uint32_t coasted = 0;
+                while ((tasks->get_motor_task().get_state() ==
+                        motor_task::State::HOMING_COASTING_TO_STOP) &&
+                       (coasted < coast_limit)) {
+                    coasted += policy.test_homing_wakeup_ticks();
+                    REQUIRE(tasks->fire_homing_wakeup());
+                    tasks->get_motor_task().run_once(policy);
+                }
+                REQUIRE(coasted < coast_limit);
+                THEN("the home times out after as long a coast as ever") {
+                    REQUIRE(tasks->get_motor_task().get_state() ==
+                            motor_task::State::STOPPED_HOMED);
+                    REQUIRE(coasted == MotorTask::HOMING_COAST_TIMEOUT_TICKS);
+                    REQUIRE(coasted == 1200);
+                }
+            }
+        }
+        WHEN("homing again before the first one finishes") {
+            tasks->get_motor_queue().backing_deque.push_back(
+                messages::BeginHomingMessage{.id = 2214});
+            tasks->get_motor_task().run_once(policy);
+            THEN("the wakeup is rearmed rather than a second check queued") {
+                REQUIRE(tasks->get_motor_queue().backing_deque.empty());
+                REQUIRE(policy.test_homing_wakeup_armed());
+            }
+        }
+        WHEN("setting an rpm") {
+            tasks->get_motor_queue().backing_deque.push_back(
+                messages::SetRPMMessage{.id = 56, .target_rpm = 1000});
+            tasks->get_motor_task().run_once(policy);
+            THEN("homing is abandoned and its wakeup disarmed") {
+                REQUIRE(tasks->get_motor_task().get_state() ==
+                        motor_task::State::RUNNING);
+                REQUIRE(!policy.test_homing_wakeup_armed());
+            }
+        }
+    }
 }
 
 SCENARIO("motor task debug solenoid handling", "[motor][debug]") {
@@ -774,12 +1243,14 @@ SCENARIO("motor task debug plate lock handling", "[motor][debug]") {
                  i++) {
                 CHECK(tasks->get_motor_task().get_state() ==
                       motor_task::State::HOMING_COASTING_TO_STOP);
+                CHECK(tasks->fire_homing_wakeup());
                 tasks->get_motor_task().run_once(tasks->get_motor_policy());
                 CHECK(tasks->get_motor_policy().test_solenoid_current() ==
                       std::remove_cvref_t<decltype(tasks->get_motor_task())>::
                           HOMING_SOLENOID_CURRENT_INITIAL);
                 CHECK(tasks->get_host_comms_queue().backing_deque.empty());
             }
+            CHECK(tasks->fire_homing_wakeup());
             tasks->get_motor_task().run_once(tasks->get_motor_policy());
             THEN("the home timeout should fire") {
                 auto ack_message = std::get<messages::AcknowledgePrevious>(
@@ -804,25 +1275,18 @@ SCENARIO("motor task debug plate lock handling", "[motor][debug]") {
                         -1.0F);
                     REQUIRE(tasks->get_motor_task().get_plate_lock_state() ==
                             motor_task::PlateLockState::OPENING);
-                    REQUIRE(std::holds_alternative<
-                            messages::CheckPlateLockStatusMessage>(
-                        tasks->get_motor_queue().backing_deque.front()));
+                    REQUIRE(tasks->get_motor_queue().backing_deque.empty());
+                    REQUIRE(tasks->get_motor_policy()
+                                .test_plate_lock_timeout_armed());
+                    REQUIRE(tasks->get_motor_policy()
+                                .test_plate_lock_timeout_ticks() ==
+                            std::remove_cvref_t<
+                                decltype(tasks->get_motor_task())>::
+                                PLATE_LOCK_MOVE_TIME_THRESHOLD);
                     AND_WHEN(
                         "opening plate lock and not receiving a plate complete "
                         "event for too long") {
-                        for (size_t i = 0;
-                             i < std::remove_cvref_t<
-                                     decltype(tasks->get_motor_task())>::
-                                     PLATE_LOCK_MOVE_TIME_THRESHOLD;
-                             i = i + 100) {  // mimic polling_time incrementing
-                            CHECK(tasks->get_motor_task()
-                                      .get_plate_lock_state() ==
-                                  motor_task::PlateLockState::OPENING);
-                            tasks->get_motor_task().run_once(
-                                tasks->get_motor_policy());
-                            CHECK(tasks->get_host_comms_queue()
-                                      .backing_deque.empty());
-                        }
+                        CHECK(tasks->fire_plate_lock_timeout());
                         tasks->get_motor_task().run_once(
                             tasks->get_motor_policy());
                         THEN("the plate lock timeout should fire") {
@@ -843,9 +1307,6 @@ SCENARIO("motor task debug plate lock handling", "[motor][debug]") {
                                     errors::ErrorCode::PLATE_LOCK_TIMEOUT);
                         }
                     }
-                    tasks->get_motor_queue()
-                        .backing_deque
-                        .pop_front();  // pulling message out of queue
                     AND_WHEN("a stop condition is sent") {
                         auto stop_message = messages::PlateLockComplete{
                             .open = true, .closed = false};
@@ -853,14 +1314,36 @@ SCENARIO("motor task debug plate lock handling", "[motor][debug]") {
                             stop_message);
                         tasks->get_motor_task().run_once(
                             tasks->get_motor_policy());
-                        THEN("state should update") {
+                        THEN("state should update and the move is answered") {
                             REQUIRE(tasks->get_motor_policy()
                                         .test_plate_lock_braked());
                             REQUIRE(tasks->get_motor_task()
                                         .get_plate_lock_state() ==
                                     motor_task::PlateLockState::IDLE_OPEN);
-                            CHECK(tasks->get_host_comms_queue()
-                                      .backing_deque.empty());
+                            REQUIRE(!tasks->get_motor_policy()
+                                         .test_plate_lock_timeout_armed());
+                            auto ack_message =
+                                std::get<messages::AcknowledgePrevious>(
+                                    tasks->get_host_comms_queue()
+                                        .backing_deque.front());
+                            REQUIRE(ack_message.responding_to_id ==
+                                    open_message.id);
+                            REQUIRE(ack_message.with_error ==
+                                    errors::ErrorCode::NO_ERROR);
+                        }
+                        tasks->get_host_comms_queue().backing_deque.clear();
+                        AND_WHEN("a timeout from the finished move arrives") {
+                            tasks->get_motor_queue().backing_deque.push_back(
+                                messages::PlateLockTimeoutMessage{});
+                            tasks->get_motor_task().run_once(
+                                tasks->get_motor_policy());
+                            THEN("it is ignored") {
+                                REQUIRE(tasks->get_motor_task()
+                                            .get_plate_lock_state() ==
+                                        motor_task::PlateLockState::IDLE_OPEN);
+                                CHECK(tasks->get_host_comms_queue()
+                                          .backing_deque.empty());
+                            }
                         }
                         AND_WHEN(
                             "check plate lock status message is called") {  // pushing message back in from above
@@ -937,12 +1420,14 @@ SCENARIO("motor task debug plate lock handling", "[motor][debug]") {
                  i++) {
                 CHECK(tasks->get_motor_task().get_state() ==
                       motor_task::State::HOMING_COASTING_TO_STOP);
+                CHECK(tasks->fire_homing_wakeup());
                 tasks->get_motor_task().run_once(tasks->get_motor_policy());
                 CHECK(tasks->get_motor_policy().test_solenoid_current() ==
                       std::remove_cvref_t<decltype(tasks->get_motor_task())>::
                           HOMING_SOLENOID_CURRENT_INITIAL);
                 CHECK(tasks->get_host_comms_queue().backing_deque.empty());
             }
+            CHECK(tasks->fire_homing_wakeup());
             tasks->get_motor_task().run_once(tasks->get_motor_policy());
             THEN("the home timeout should fire") {
                 auto ack_message = std::get<messages::AcknowledgePrevious>(
@@ -955,17 +1440,53 @@ SCENARIO("motor task debug plate lock handling", "[motor][debug]") {
             tasks->get_host_comms_queue()
                 .backing_deque
                 .clear();  // clear homing messages in host_comms queue
+            AND_WHEN("sending an open and then a close straight after") {
+                tasks->get_motor_queue().backing_deque.push_back(
+                    messages::OpenPlateLockMessage{.id = 201});
+                tasks->get_motor_task().run_once(tasks->get_motor_policy());
+                tasks->get_motor_queue().backing_deque.push_back(
+                    messages::ClosePlateLockMessage{.id = 202});
+                tasks->get_motor_task().run_once(tasks->get_motor_policy());
+                THEN("the open fails since it never reached its switch") {
+                    auto& comms = tasks->get_host_comms_queue().backing_deque;
+                    REQUIRE(comms.size() == 1);
+                    auto ack = std::get<messages::AcknowledgePrevious>(
+                        comms.front());
+                    REQUIRE(ack.responding_to_id == 201);
+                    REQUIRE(ack.with_error ==
+                            errors::ErrorCode::PLATE_LOCK_MOVE_SUPERSEDED);
+                    AND_WHEN("the lock closes") {
+                        comms.clear();
+                        tasks->get_motor_queue().backing_deque.push_back(
+                            messages::PlateLockComplete{.open = false,
+                                                        .closed = true});
+                        tasks->get_motor_task().run_once(
+                            tasks->get_motor_policy());
+                        THEN("the close succeeds") {
+                            REQUIRE(!comms.empty());
+                            auto close_ack =
+                                std::get<messages::AcknowledgePrevious>(
+                                    comms.front());
+                            REQUIRE(close_ack.responding_to_id == 202);
+                            REQUIRE(close_ack.with_error ==
+                                    errors::ErrorCode::NO_ERROR);
+                        }
+                    }
+                }
+            }
             AND_WHEN("sending a regular close plate lock message") {
                 auto open_message = messages::OpenPlateLockMessage{
                     .id = 123};  // placing plate lock in not-closed state
                 tasks->get_motor_queue().backing_deque.push_back(open_message);
                 tasks->get_motor_task().run_once(tasks->get_motor_policy());
-                tasks->get_motor_queue()
-                    .backing_deque
-                    .pop_front();  // pulling out CheckPlateLockStatusMessage
                 auto close_message = messages::ClosePlateLockMessage{.id = 123};
                 tasks->get_motor_queue().backing_deque.push_back(close_message);
                 tasks->get_motor_task().run_once(tasks->get_motor_policy());
+                // The close replaces the open move, which fails at once
+                CHECK(std::get<messages::AcknowledgePrevious>(
+                          tasks->get_host_comms_queue().backing_deque.front())
+                          .responding_to_id == open_message.id);
+                tasks->get_host_comms_queue().backing_deque.clear();
                 THEN("motor should be enabled with correct power and state") {
                     REQUIRE(
                         tasks->get_motor_policy().test_plate_lock_enabled());
@@ -974,25 +1495,18 @@ SCENARIO("motor task debug plate lock handling", "[motor][debug]") {
                         1.0F);
                     REQUIRE(tasks->get_motor_task().get_plate_lock_state() ==
                             motor_task::PlateLockState::CLOSING);
-                    REQUIRE(std::holds_alternative<
-                            messages::CheckPlateLockStatusMessage>(
-                        tasks->get_motor_queue().backing_deque.front()));
+                    REQUIRE(tasks->get_motor_queue().backing_deque.empty());
+                    REQUIRE(tasks->get_motor_policy()
+                                .test_plate_lock_timeout_armed());
+                    REQUIRE(tasks->get_motor_policy()
+                                .test_plate_lock_timeout_ticks() ==
+                            std::remove_cvref_t<
+                                decltype(tasks->get_motor_task())>::
+                                PLATE_LOCK_MOVE_TIME_THRESHOLD);
                     AND_WHEN(
                         "closing plate lock and not receiving a plate complete "
                         "event for too long") {
-                        for (size_t i = 0;
-                             i < std::remove_cvref_t<
-                                     decltype(tasks->get_motor_task())>::
-                                     PLATE_LOCK_MOVE_TIME_THRESHOLD;
-                             i = i + 100) {  // mimic polling_time incrementing
-                            CHECK(tasks->get_motor_task()
-                                      .get_plate_lock_state() ==
-                                  motor_task::PlateLockState::CLOSING);
-                            tasks->get_motor_task().run_once(
-                                tasks->get_motor_policy());
-                            CHECK(tasks->get_host_comms_queue()
-                                      .backing_deque.empty());
-                        }
+                        CHECK(tasks->fire_plate_lock_timeout());
                         tasks->get_motor_task().run_once(
                             tasks->get_motor_policy());
                         THEN("the plate lock timeout should fire") {
@@ -1013,9 +1527,6 @@ SCENARIO("motor task debug plate lock handling", "[motor][debug]") {
                                     errors::ErrorCode::PLATE_LOCK_TIMEOUT);
                         }
                     }
-                    tasks->get_motor_queue()
-                        .backing_deque
-                        .pop_front();  // pulling message out of queue
                     AND_WHEN("a stop condition is sent") {
                         auto stop_message = messages::PlateLockComplete{
                             .open = false, .closed = true};
@@ -1023,15 +1534,24 @@ SCENARIO("motor task debug plate lock handling", "[motor][debug]") {
                             stop_message);
                         tasks->get_motor_task().run_once(
                             tasks->get_motor_policy());
-                        THEN("state should update and send acknowledgement") {
+                        THEN("state should update and the move is answered") {
                             REQUIRE(tasks->get_motor_policy()
                                         .test_plate_lock_braked());
                             REQUIRE(tasks->get_motor_task()
                                         .get_plate_lock_state() ==
                                     motor_task::PlateLockState::IDLE_CLOSED);
-                            CHECK(tasks->get_host_comms_queue()
-                                      .backing_deque.empty());
+                            REQUIRE(!tasks->get_motor_policy()
+                                         .test_plate_lock_timeout_armed());
+                            auto ack_message =
+                                std::get<messages::AcknowledgePrevious>(
+                                    tasks->get_host_comms_queue()
+                                        .backing_deque.front());
+                            REQUIRE(ack_message.responding_to_id ==
+                                    close_message.id);
+                            REQUIRE(ack_message.with_error ==
+                                    errors::ErrorCode::NO_ERROR);
                         }
+                        tasks->get_host_comms_queue().backing_deque.clear();
                         AND_WHEN(
                             "check plate lock status message is called") {  // pushing message back in from above
                             auto check_status_message =
@@ -1105,13 +1625,15 @@ SCENARIO("motor task debug plate lock handling", "[motor][debug]") {
                     .id = 123};  // placing plate lock in not-closed state
                 tasks->get_motor_queue().backing_deque.push_back(open_message);
                 tasks->get_motor_task().run_once(tasks->get_motor_policy());
-                tasks->get_motor_queue()
-                    .backing_deque
-                    .pop_front();  // pulling out CheckPlateLockStatusMessage
                 auto close_message = messages::ClosePlateLockMessage{
                     .id = 123, .from_startup = true};
                 tasks->get_motor_queue().backing_deque.push_back(close_message);
                 tasks->get_motor_task().run_once(tasks->get_motor_policy());
+                // The close replaces the open move, which fails at once
+                CHECK(std::get<messages::AcknowledgePrevious>(
+                          tasks->get_host_comms_queue().backing_deque.front())
+                          .responding_to_id == open_message.id);
+                tasks->get_host_comms_queue().backing_deque.clear();
                 THEN("motor should be enabled with correct power and state") {
                     REQUIRE(
                         tasks->get_motor_policy().test_plate_lock_enabled());
@@ -1120,25 +1642,18 @@ SCENARIO("motor task debug plate lock handling", "[motor][debug]") {
                         1.0F);
                     REQUIRE(tasks->get_motor_task().get_plate_lock_state() ==
                             motor_task::PlateLockState::CLOSING);
-                    REQUIRE(std::holds_alternative<
-                            messages::CheckPlateLockStatusMessage>(
-                        tasks->get_motor_queue().backing_deque.front()));
+                    REQUIRE(tasks->get_motor_queue().backing_deque.empty());
+                    REQUIRE(tasks->get_motor_policy()
+                                .test_plate_lock_timeout_armed());
+                    REQUIRE(tasks->get_motor_policy()
+                                .test_plate_lock_timeout_ticks() ==
+                            std::remove_cvref_t<
+                                decltype(tasks->get_motor_task())>::
+                                PLATE_LOCK_MOVE_TIME_THRESHOLD);
                     AND_WHEN(
                         "closing plate lock and not receiving a plate complete "
                         "event for too long") {
-                        for (size_t i = 0;
-                             i < std::remove_cvref_t<
-                                     decltype(tasks->get_motor_task())>::
-                                     PLATE_LOCK_MOVE_TIME_THRESHOLD;
-                             i = i + 100) {  // mimic polling_time incrementing
-                            CHECK(tasks->get_motor_task()
-                                      .get_plate_lock_state() ==
-                                  motor_task::PlateLockState::CLOSING);
-                            tasks->get_motor_task().run_once(
-                                tasks->get_motor_policy());
-                            CHECK(tasks->get_host_comms_queue()
-                                      .backing_deque.empty());
-                        }
+                        CHECK(tasks->fire_plate_lock_timeout());
                         tasks->get_motor_task().run_once(
                             tasks->get_motor_policy());
                         auto response =
@@ -1157,11 +1672,6 @@ SCENARIO("motor task debug plate lock handling", "[motor][debug]") {
                                       .backing_deque.empty());
                         }
                     }
-                    auto front_message =
-                        tasks->get_motor_queue().backing_deque.front();
-                    tasks->get_motor_queue()
-                        .backing_deque
-                        .pop_front();  // pulling message out of queue
                     AND_WHEN("a stop condition is sent") {
                         auto stop_message = messages::PlateLockComplete{
                             .open = false, .closed = true};
@@ -1169,10 +1679,6 @@ SCENARIO("motor task debug plate lock handling", "[motor][debug]") {
                             stop_message);
                         tasks->get_motor_task().run_once(
                             tasks->get_motor_policy());
-                        tasks->get_motor_queue().backing_deque.push_back(
-                            front_message);
-                        tasks->get_motor_task().run_once(
-                            tasks->get_motor_policy());
                         auto response =
                             tasks->get_motor_queue().backing_deque.front();
                         tasks->get_motor_queue().backing_deque.pop_front();
@@ -1184,6 +1690,8 @@ SCENARIO("motor task debug plate lock handling", "[motor][debug]") {
                                     motor_task::PlateLockState::IDLE_CLOSED);
                             CHECK(tasks->get_host_comms_queue()
                                       .backing_deque.empty());
+                            REQUIRE(!tasks->get_motor_policy()
+                                         .test_plate_lock_timeout_armed());
                             REQUIRE(std::holds_alternative<
                                     messages::BeginHomingMessage>(response));
                         }
@@ -1258,3 +1766,360 @@ SCENARIO("motor task debug plate lock handling", "[motor][debug]") {
         }
     }
 }
+
+SCENARIO("motor task speed captures", "[motor]") {
+    GIVEN("a motor task with the plate lock closed") {
+        auto tasks = TaskBuilder::build();
+        tasks->get_motor_queue().backing_deque.push_back(
+            messages::PlateLockComplete{.open = false, .closed = true});
+        tasks->get_motor_task().run_once(tasks->get_motor_policy());
+        auto& comms = tasks->get_host_comms_queue().backing_deque;
+        auto& capture = tasks->get_motor_policy().motor_capture();
+        auto run_motor = [&tasks](const messages::MotorMessage& message) {
+            tasks->get_motor_queue().backing_deque.push_back(message);
+            tasks->get_motor_task().run_once(tasks->get_motor_policy());
+        };
+        auto next_response = [&comms]() {
+            auto response = comms.front();
+            comms.pop_front();
+            return response;
+        };
+        WHEN("arming with bad settings") {
+            run_motor(messages::ArmMotorCaptureMessage{
+                .id = 1, .period_ticks = 0, .post_trigger = 10});
+            THEN("it is refused") {
+                auto ack =
+                    std::get<messages::AcknowledgePrevious>(next_response());
+                REQUIRE(ack.with_error ==
+                        errors::ErrorCode::MOTOR_BAD_CAPTURE_SETTINGS);
+                REQUIRE(capture.status() == motor_telemetry::Status::IDLE);
+            }
+        }
+        WHEN("triggering a capture that isn't armed") {
+            run_motor(messages::TriggerMotorCaptureMessage{.id = 2});
+            THEN("it is refused") {
+                auto ack =
+                    std::get<messages::AcknowledgePrevious>(next_response());
+                REQUIRE(ack.with_error ==
+                        errors::ErrorCode::MOTOR_CAPTURE_NOT_ARMED);
+            }
+        }
+        WHEN("reading a capture that isn't done") {
+            run_motor(messages::GetMotorCaptureMessage{.id = 3, .start = 0});
+            THEN("only its state is sent") {
+                auto response = std::get<messages::GetMotorCaptureResponse>(
+                    next_response());
+                REQUIRE(response.responding_to_id == 3);
+                REQUIRE(response.status == motor_telemetry::Status::IDLE);
+                REQUIRE(response.count == 0);
+                REQUIRE(response.page_count == 0);
+            }
+        }
+        WHEN("arming a capture and changing speed") {
+            run_motor(messages::ArmMotorCaptureMessage{
+                .id = 4, .period_ticks = 1, .post_trigger = 10});
+            auto ack = std::get<messages::AcknowledgePrevious>(next_response());
+            REQUIRE(ack.with_error == errors::ErrorCode::NO_ERROR);
+            for (int16_t i = 0; i < 5; ++i) {
+                if (capture.sample_due()) {
+                    capture.record(motor_telemetry::Sample{
+                        .rpm = i, .setpoint_rpm = 0, .iq = 0, .bus_mv = 0});
+                }
+            }
+            run_motor(messages::SetRPMMessage{.id = 5, .target_rpm = 1000});
+            comms.clear();
+            THEN("the speed change triggers the capture") {
+                REQUIRE(capture.status() ==
+                        motor_telemetry::Status::TRIGGERED);
+            }
+            AND_WHEN("the capture fills and is read back") {
+                for (int16_t i = 5; i < 15; ++i) {
+                    if (capture.sample_due()) {
+                        capture.record(motor_telemetry::Sample{
+                            .rpm = i, .setpoint_rpm = 1000, .iq = 0,
+                            .bus_mv = 0});
+                    }
+                }
+                run_motor(
+                    messages::GetMotorCaptureMessage{.id = 6, .start = 0});
+                run_motor(
+                    messages::GetMotorCaptureMessage{.id = 7, .start = 8});
+                THEN("it is sent a page at a time") {
+                    auto first = std::get<messages::GetMotorCaptureResponse>(
+                        next_response());
+                    REQUIRE(first.status == motor_telemetry::Status::DONE);
+                    REQUIRE(first.period_ticks == 1);
+                    REQUIRE(first.count == 15);
+                    REQUIRE(first.trigger_index == 5);
+                    REQUIRE(first.page_count == first.page.size());
+                    REQUIRE(first.page.at(0).rpm == 0);
+                    REQUIRE(first.page.at(7).rpm == 7);
+                    auto second = std::get<messages::GetMotorCaptureResponse>(
+                        next_response());
+                    REQUIRE(second.start == 8);
+                    REQUIRE(second.page_count == 7);
+                    REQUIRE(second.page.at(0).rpm == 8);
+                    REQUIRE(second.page.at(6).rpm == 14);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("motor task loop timing", "[motor]") {
+    GIVEN("a motor task whose loops have been timed") {
+        auto tasks = TaskBuilder::build();
+        auto timing = loop_timing::MotorLoopTiming{
+            .high_frequency = {.period_cycles = 2400,
+                               .samples = 10,
+                               .min_cycles = 900,
+                               .max_cycles = 1500,
+                               .mean_cycles = 1000,
+                               .overruns = 0},
+            .medium_frequency = {.period_cycles = 72000,
+                                 .samples = 3,
+                                 .min_cycles = 4000,
+                                 .max_cycles = 5000,
+                                 .mean_cycles = 4500,
+                                 .overruns = 0}};
+        tasks->get_motor_policy().test_set_loop_timing(timing);
+        auto& comms = tasks->get_host_comms_queue().backing_deque;
+        WHEN("the timing is requested") {
+            tasks->get_motor_queue().backing_deque.push_back(
+                messages::GetLoopTimingMessage{.id = 12, .reset = false});
+            tasks->get_motor_task().run_once(tasks->get_motor_policy());
+            THEN("it is sent to the host comms task") {
+                auto response =
+                    std::get<messages::GetLoopTimingResponse>(comms.front());
+                REQUIRE(response.responding_to_id == 12);
+                REQUIRE(response.timing.high_frequency.mean_cycles == 1000);
+                REQUIRE(response.timing.medium_frequency.samples == 3);
+                REQUIRE(tasks->get_motor_policy().test_loop_timing_resets() ==
+                        0);
+            }
+        }
+        WHEN("the timing is requested with a reset") {
+            tasks->get_motor_queue().backing_deque.push_back(
+                messages::GetLoopTimingMessage{.id = 13, .reset = true});
+            tasks->get_motor_task().run_once(tasks->get_motor_policy());
+            THEN("it is sent before the statistics are reset") {
+                auto response =
+                    std::get<messages::GetLoopTimingResponse>(comms.front());
+                REQUIRE(response.timing.high_frequency.samples == 10);
+                REQUIRE(tasks->get_motor_policy().test_loop_timing_resets() ==
+                        1);
+            }
+        }
+    }
+}
+
+SCENARIO("motor task skip bands", "[motor]") {
+    GIVEN("a motor task with a skip band saved and the plate lock closed") {
+        auto tasks = TaskBuilder::build();
+        auto saved = skip_bands::MotorSkipBands();
+        REQUIRE(saved.add(skip_bands::Band{.low_rpm = 500, .high_rpm = 650}));
+        tasks->get_motor_policy().test_set_stored_skip_bands(saved.store());
+        tasks->get_motor_queue().backing_deque.push_back(
+            messages::PlateLockComplete{.open = false, .closed = true});
+        tasks->get_motor_task().run_once(tasks->get_motor_policy());
+        auto run_motor = [&tasks](const messages::MotorMessage& message) {
+            tasks->get_motor_queue().backing_deque.push_back(message);
+            tasks->get_motor_task().run_once(tasks->get_motor_policy());
+            auto response = tasks->get_host_comms_queue().backing_deque.front();
+            tasks->get_host_comms_queue().backing_deque.pop_front();
+            return response;
+        };
+        auto stored = [&tasks]() {
+            auto bands = skip_bands::MotorSkipBands();
+            REQUIRE(bands.restore(
+                tasks->get_motor_policy().test_stored_skip_bands()));
+            return bands;
+        };
+        WHEN("listing the bands") {
+            auto response = std::get<messages::GetSkipBandsResponse>(
+                run_motor(messages::GetSkipBandsMessage{.id = 4}));
+            THEN("the saved band was loaded") {
+                REQUIRE(response.responding_to_id == 4);
+                REQUIRE(response.count == 1);
+                REQUIRE(response.bands.at(0).low_rpm == 500);
+                REQUIRE(response.bands.at(0).high_rpm == 650);
+            }
+        }
+        WHEN("setting a speed inside the band") {
+            auto ack = std::get<messages::AcknowledgePrevious>(run_motor(
+                messages::SetRPMMessage{.id = 1, .target_rpm = 600}));
+            THEN("it is refused") {
+                REQUIRE(ack.with_error ==
+                        errors::ErrorCode::MOTOR_RPM_IN_SKIP_BAND);
+                REQUIRE(tasks->get_motor_policy().get_target_rpm() == 0);
+            }
+        }
+        WHEN("adding a shake segment inside the band") {
+            auto ack = std::get<messages::AcknowledgePrevious>(
+                run_motor(messages::AddShakeSegmentMessage{
+                    .id = 2,
+                    .segment = {.rpm = 600,
+                                .ramp_rpm_per_s = 1000,
+                                .dwell_ms = 10}}));
+            THEN("it is refused") {
+                REQUIRE(ack.with_error ==
+                        errors::ErrorCode::MOTOR_RPM_IN_SKIP_BAND);
+            }
+        }
+        WHEN("setting a speed past the band") {
+            auto ack = std::get<messages::AcknowledgePrevious>(run_motor(
+                messages::SetRPMMessage{.id = 1, .target_rpm = 1000}));
+            THEN("the motor ramps to the edge of the band first") {
+                REQUIRE(ack.with_error == errors::ErrorCode::NO_ERROR);
+                REQUIRE(tasks->get_motor_policy().get_target_rpm() == 500);
+                REQUIRE(tasks->get_motor_policy().test_get_segment_ticks() ==
+                        500);
+                REQUIRE(tasks->get_motor_policy()
+                            .test_speed_profile_wakeup_ticks() == 500);
+            }
+            THEN("the setpoint reported is the target of the whole change") {
+                auto rpm = std::get<messages::GetRPMResponse>(
+                    run_motor(messages::GetRPMMessage{.id = 3}));
+                REQUIRE(rpm.setpoint_rpm == 1000);
+            }
+            THEN("the bands can't be changed while it runs") {
+                auto band_ack = std::get<messages::AcknowledgePrevious>(
+                    run_motor(messages::ClearSkipBandsMessage{.id = 5}));
+                REQUIRE(band_ack.with_error ==
+                        errors::ErrorCode::MOTOR_NOT_STOPPED);
+            }
+            AND_WHEN("the ramp to the edge finishes") {
+                REQUIRE(tasks->fire_speed_profile_wakeup());
+                tasks->get_motor_task().run_once(tasks->get_motor_policy());
+                THEN("the band is crossed at the fastest rate") {
+                    // 150 rpm at 20000 rpm/s
+                    REQUIRE(tasks->get_motor_policy().get_target_rpm() == 650);
+                    REQUIRE(
+                        tasks->get_motor_policy().test_get_segment_ticks() ==
+                        8);
+                }
+                AND_WHEN("the rest of the change runs") {
+                    REQUIRE(tasks->fire_speed_profile_wakeup());
+                    tasks->get_motor_task().run_once(
+                        tasks->get_motor_policy());
+                    REQUIRE(tasks->get_motor_policy().get_target_rpm() ==
+                            1000);
+                    REQUIRE(
+                        tasks->get_motor_policy().test_get_segment_ticks() ==
+                        350);
+                    REQUIRE(tasks->fire_speed_profile_wakeup());
+                    tasks->get_motor_task().run_once(
+                        tasks->get_motor_policy());
+                    THEN("the crossing is over") {
+                        REQUIRE(!tasks->get_motor_policy()
+                                     .test_speed_profile_wakeup_armed());
+                        REQUIRE(tasks->get_host_comms_queue()
+                                    .backing_deque.empty());
+                    }
+                }
+            }
+        }
+        WHEN("stopping from above the band") {
+            tasks->get_motor_policy().test_set_current_rpm(1000);
+            auto ack = std::get<messages::AcknowledgePrevious>(
+                run_motor(messages::SetRPMMessage{.id = 1, .target_rpm = 0}));
+            THEN("the motor ramps down to the edge of the band first") {
+                REQUIRE(ack.with_error == errors::ErrorCode::NO_ERROR);
+                REQUIRE(tasks->get_motor_policy().get_target_rpm() == 650);
+                REQUIRE(tasks->get_motor_policy().test_get_segment_ticks() ==
+                        350);
+            }
+            THEN("the setpoint reported is the stop") {
+                auto rpm = std::get<messages::GetRPMResponse>(
+                    run_motor(messages::GetRPMMessage{.id = 3}));
+                REQUIRE(rpm.setpoint_rpm == 0);
+            }
+            AND_WHEN("the ramp to the edge finishes") {
+                REQUIRE(tasks->fire_speed_profile_wakeup());
+                tasks->get_motor_task().run_once(tasks->get_motor_policy());
+                THEN("the band is crossed at the fastest rate") {
+                    REQUIRE(tasks->get_motor_policy().get_target_rpm() == 500);
+                    REQUIRE(
+                        tasks->get_motor_policy().test_get_segment_ticks() ==
+                        8);
+                }
+                AND_WHEN("the band is crossed") {
+                    REQUIRE(tasks->fire_speed_profile_wakeup());
+                    tasks->get_motor_task().run_once(
+                        tasks->get_motor_policy());
+                    THEN("the motor driver takes the rest of the stop") {
+                        REQUIRE(tasks->get_motor_policy().get_target_rpm() ==
+                                0);
+                        REQUIRE(tasks->get_motor_policy()
+                                    .test_get_segment_ticks() == 0);
+                        REQUIRE(!tasks->get_motor_policy()
+                                     .test_speed_profile_wakeup_armed());
+                    }
+                }
+            }
+        }
+        WHEN("running a shake program past the band") {
+            static_cast<void>(
+                run_motor(messages::AddShakeSegmentMessage{
+                    .id = 2,
+                    .segment = {.rpm = 1000,
+                                .ramp_rpm_per_s = 1000,
+                                .dwell_ms = 10}}));
+            static_cast<void>(
+                run_motor(messages::RunShakeProgramMessage{.id = 3}));
+            THEN("the segment waits out every leg of the crossing") {
+                REQUIRE(tasks->get_motor_policy()
+                            .test_shake_program_wakeup_ticks() ==
+                        500 + 8 + 350 + 10);
+            }
+        }
+        WHEN("adding a band that overlaps the saved one") {
+            auto ack = std::get<messages::AcknowledgePrevious>(
+                run_motor(messages::AddSkipBandMessage{
+                    .id = 6, .band = {.low_rpm = 600, .high_rpm = 700}}));
+            THEN("they are merged and saved") {
+                REQUIRE(ack.responding_to_id == 6);
+                REQUIRE(ack.with_error == errors::ErrorCode::NO_ERROR);
+                auto bands = stored();
+                REQUIRE(bands.size() == 1);
+                REQUIRE(bands.at(0).low_rpm == 500);
+                REQUIRE(bands.at(0).high_rpm == 700);
+            }
+        }
+        WHEN("adding a band with its edges the wrong way round") {
+            auto ack = std::get<messages::AcknowledgePrevious>(
+                run_motor(messages::AddSkipBandMessage{
+                    .id = 6, .band = {.low_rpm = 900, .high_rpm = 800}}));
+            THEN("it is refused") {
+                REQUIRE(ack.with_error ==
+                        errors::ErrorCode::MOTOR_ILLEGAL_SKIP_BAND);
+                REQUIRE(stored().size() == 1);
+            }
+        }
+        WHEN("adding a band and the flash write fails") {
+            tasks->get_motor_policy().test_set_write_skip_bands_return(false);
+            auto ack = std::get<messages::AcknowledgePrevious>(
+                run_motor(messages::AddSkipBandMessage{
+                    .id = 6, .band = {.low_rpm = 800, .high_rpm = 900}}));
+            THEN("the error is reported") {
+                REQUIRE(ack.with_error ==
+                        errors::ErrorCode::MOTOR_SKIP_BANDS_NOT_SAVED);
+            }
+        }
+        WHEN("clearing the bands") {
+            auto ack = std::get<messages::AcknowledgePrevious>(
+                run_motor(messages::ClearSkipBandsMessage{.id = 7}));
+            THEN("the empty table is saved") {
+                REQUIRE(ack.with_error == errors::ErrorCode::NO_ERROR);
+                REQUIRE(stored().empty());
+            }
+            AND_THEN("speeds inside the old band are allowed") {
+                auto rpm_ack = std::get<messages::AcknowledgePrevious>(
+                    run_motor(
+                        messages::SetRPMMessage{.id = 1, .target_rpm = 600}));
+                REQUIRE(rpm_ack.with_error == errors::ErrorCode::NO_ERROR);
+                REQUIRE(tasks->get_motor_policy().get_target_rpm() == 600);
+            }
+        }
+    }
+}
@@ -0,0 +1,110 @@
+#include "catch2/catch.hpp"
+#include "heater-shaker/motor_telemetry.hpp"
+
+using namespace motor_telemetry;
+
+namespace {
+auto sample(int16_t rpm) -> Sample {
+    return Sample{.rpm = rpm, .setpoint_rpm = 0, .iq = 0, .bus_mv = 0};
+}
+
+// Offer a sample every tick the way the control loop does
+template <size_t Capacity>
+auto tick(Capture<Capacity>& capture, int16_t rpm) -> void {
+    if (capture.sample_due()) {
+        capture.record(sample(rpm));
+    }
+}
+}  // namespace
+
+SCENARIO("motor captures") {
+    auto capture = Capture<4>();
+    GIVEN("a capture that was never armed") {
+        THEN("it records nothing") {
+            REQUIRE(capture.status() == Status::IDLE);
+            REQUIRE(!capture.sample_due());
+            capture.record(sample(1));
+            REQUIRE(capture.size() == 0);
+        }
+        THEN("it can't be triggered") { REQUIRE(!capture.trigger()); }
+    }
+    GIVEN("bad settings") {
+        THEN("a zero period is refused") { REQUIRE(!capture.arm(0, 1)); }
+        THEN("more samples after the trigger than fit are refused") {
+            REQUIRE(!capture.arm(1, 5));
+        }
+        THEN("the capture stays idle") {
+            static_cast<void>(capture.arm(0, 1));
+            REQUIRE(capture.status() == Status::IDLE);
+        }
+    }
+    GIVEN("a capture armed to sample every other tick") {
+        REQUIRE(capture.arm(2, 2));
+        THEN("it samples on every other tick") {
+            REQUIRE(capture.sample_due());
+            REQUIRE(!capture.sample_due());
+            REQUIRE(capture.sample_due());
+        }
+        WHEN("more samples arrive than fit before a trigger") {
+            for (int16_t i = 1; i <= 12; ++i) {
+                tick(capture, i);
+            }
+            THEN("it keeps the most recent ones") {
+                REQUIRE(capture.status() == Status::ARMED);
+                REQUIRE(capture.size() == 4);
+                REQUIRE(capture.at(0).rpm == 5);
+                REQUIRE(capture.at(3).rpm == 11);
+            }
+            AND_WHEN("it is triggered") {
+                REQUIRE(capture.trigger());
+                THEN("it can't be triggered again") {
+                    REQUIRE(!capture.trigger());
+                }
+                THEN("it freezes after the set number of samples") {
+                    for (int16_t i = 13; i <= 20; ++i) {
+                        tick(capture, i);
+                    }
+                    REQUIRE(capture.status() == Status::DONE);
+                    REQUIRE(!capture.sample_due());
+                    REQUIRE(capture.size() == 4);
+                    REQUIRE(capture.trigger_index() == 2);
+                    REQUIRE(capture.at(0).rpm == 9);
+                    REQUIRE(capture.at(1).rpm == 11);
+                    REQUIRE(capture.at(2).rpm == 13);
+                    REQUIRE(capture.at(3).rpm == 15);
+                }
+            }
+        }
+        WHEN("it is triggered before filling up") {
+            tick(capture, 1);
+            REQUIRE(capture.trigger());
+            for (int16_t i = 2; i <= 8; ++i) {
+                tick(capture, i);
+            }
+            THEN("it holds only what it recorded") {
+                REQUIRE(capture.status() == Status::DONE);
+                REQUIRE(capture.size() == 3);
+                REQUIRE(capture.trigger_index() == 1);
+                REQUIRE(capture.at(0).rpm == 1);
+                REQUIRE(capture.at(2).rpm == 5);
+            }
+        }
+        WHEN("it is disarmed") {
+            capture.disarm();
+            THEN("it stops recording") {
+                REQUIRE(capture.status() == Status::IDLE);
+                REQUIRE(!capture.sample_due());
+            }
+        }
+    }
+    GIVEN("a capture with no samples after the trigger") {
+        REQUIRE(capture.arm(1, 0));
+        tick(capture, 1);
+        THEN("a trigger freezes it at once") {
+            REQUIRE(capture.trigger());
+            REQUIRE(capture.status() == Status::DONE);
+            REQUIRE(capture.size() == 1);
+            REQUIRE(capture.trigger_index() == 1);
+        }
+    }
+}
@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <chrono>
+#include <stop_token>
+#include <vector>
+
+#include "catch2/catch.hpp"
+#include "simulator/scheduler.hpp"
+#include "simulator/sim_clock.hpp"
+
+using namespace scheduler;
+
+namespace {
+// Run two tasks with a few things each to do, and record which ran when
+auto interleaving(uint32_t seed) -> std::vector<int> {
+    auto sched = Scheduler(seed);
+    auto source = std::stop_source();
+    auto order = std::vector<int>();
+    int pending[] = {5, 5};
+    for (int task = 0; task < 2; ++task) {
+        sched.add_task([&pending, task]() { return pending[task] > 0; },
+                       [&, task]() {
+                           --pending[task];
+                           order.push_back(task);
+                           if (pending[0] + pending[1] == 0) {
+                               source.request_stop();
+                           }
+                       });
+    }
+    sched.run(source.get_token());
+    return order;
+}
+}  // namespace
+
+SCENARIO("cooperative scheduler") {
+    sim_clock::clock().set_speed(sim_clock::SimClock::AS_FAST_AS_POSSIBLE);
+    GIVEN("two tasks that are ready") {
+        WHEN("running them with a seed") {
+            auto order = interleaving(1);
+            THEN("every step of each runs") {
+                REQUIRE(order.size() == 10);
+                REQUIRE(std::count(order.begin(), order.end(), 0) == 5);
+            }
+            THEN("the same seed runs them in the same order") {
+                REQUIRE(interleaving(1) == order);
+            }
+            THEN("other seeds run them in other orders") {
+                bool any_different = false;
+                for (uint32_t seed = 2; seed < 10; ++seed) {
+                    any_different |= (interleaving(seed) != order);
+                }
+                REQUIRE(any_different);
+            }
+        }
+    }
+    GIVEN("a periodic action and no tasks") {
+        using namespace std::chrono_literals;
+        auto sched = Scheduler(0);
+        auto source = std::stop_source();
+        auto times = std::vector<Scheduler::duration>();
+        sched.add_periodic(10ms, [&]() {
+            times.push_back(sim_clock::clock().now());
+            if (times.size() == 3) {
+                source.request_stop();
+            }
+        });
+        WHEN("running it") {
+            const auto start = sim_clock::clock().now();
+            sched.run(source.get_token());
+            THEN("the clock jumps straight to each time it's due") {
+                REQUIRE(times ==
+                        std::vector<Scheduler::duration>{
+                            start + 10ms, start + 20ms, start + 30ms});
+            }
+        }
+    }
+    GIVEN("a timer armed for a one-off time") {
+        using namespace std::chrono_literals;
+        auto sched = Scheduler(0);
+        auto source = std::stop_source();
+        auto due = sim_clock::SimClock::FOREVER;
+        auto fired_at = std::vector<Scheduler::duration>();
+        sched.add_timer([&due]() { return due; },
+                        [&]() {
+                            fired_at.push_back(sim_clock::clock().now());
+                            due = sim_clock::SimClock::FOREVER;
+                            source.request_stop();
+                        });
+        WHEN("running it") {
+            const auto start = sim_clock::clock().now();
+            due = start + 25ms;
+            sched.run(source.get_token());
+            THEN("the clock jumps straight to the time and fires it once") {
+                REQUIRE(fired_at ==
+                        std::vector<Scheduler::duration>{start + 25ms});
+            }
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#include <vector>
+
+#include "catch2/catch.hpp"
+#include "heater-shaker/shake_program.hpp"
+
+using namespace shake_program;
+
+namespace {
+auto segment(int16_t rpm, uint16_t repeats = 0) -> Segment {
+    return Segment{.rpm = rpm,
+                   .ramp_rpm_per_s = 1000,
+                   .dwell_ms = 100,
+                   .repeats = repeats};
+}
+
+template <size_t Capacity>
+auto run(Program<Capacity>& program) -> std::vector<int16_t> {
+    std::vector<int16_t> speeds;
+    program.restart();
+    do {
+        speeds.push_back(program.current().rpm);
+    } while (program.advance());
+    return speeds;
+}
+}  // namespace
+
+SCENARIO("shake programs") {
+    auto program = Program<4>();
+    GIVEN("an empty program") {
+        THEN("it has no segments") {
+            REQUIRE(program.empty());
+            REQUIRE(program.size() == 0);
+        }
+        THEN("it takes segments until it is full") {
+            for (size_t i = 0; i < program.capacity; ++i) {
+                REQUIRE(program.add(segment(100)));
+            }
+            REQUIRE(!program.add(segment(100)));
+            REQUIRE(program.size() == program.capacity);
+        }
+    }
+    GIVEN("a program without repeats") {
+        program.add(segment(100));
+        program.add(segment(200));
+        program.add(segment(300));
+        THEN("it runs each segment once in order") {
+            REQUIRE(run(program) == std::vector<int16_t>{100, 200, 300});
+        }
+        THEN("it runs the same way when restarted") {
+            static_cast<void>(run(program));
+            REQUIRE(run(program) == std::vector<int16_t>{100, 200, 300});
+        }
+        WHEN("it is cleared") {
+            program.clear();
+            THEN("it is empty") { REQUIRE(program.empty()); }
+        }
+    }
+    GIVEN("a program that repeats from the start") {
+        program.add(segment(100));
+        program.add(segment(200, 2));
+        program.add(segment(300));
+        THEN("the block before the repeat runs three times") {
+            REQUIRE(run(program) ==
+                    std::vector<int16_t>{100, 200, 100, 200, 100, 200, 300});
+        }
+        THEN("every repeat runs again when restarted") {
+            static_cast<void>(run(program));
+            REQUIRE(run(program).size() == 7);
+        }
+    }
+    GIVEN("a program with two blocks") {
+        program.add(segment(100, 1));
+        program.add(segment(200));
+        program.add(segment(300, 1));
+        program.add(segment(400));
+        THEN("the second block starts after the first") {
+            REQUIRE(run(program) == std::vector<int16_t>{100, 100, 200, 300,
+                                                         200, 300, 400});
+        }
+    }
+}
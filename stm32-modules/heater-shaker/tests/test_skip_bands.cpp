@@ -0,0 +1,132 @@
+#include <vector>
+
+#include "catch2/catch.hpp"
+#include "heater-shaker/skip_bands.hpp"
+
+using namespace skip_bands;
+
+namespace {
+auto band(int16_t low, int16_t high) -> Band {
+    return Band{.low_rpm = low, .high_rpm = high};
+}
+
+template <size_t Capacity>
+auto legs(const SkipBands<Capacity>& bands, int16_t from, int16_t to)
+    -> std::vector<std::pair<int16_t, bool>> {
+    typename SkipBands<Capacity>::Legs out{};
+    auto count = bands.legs(from, to, out);
+    std::vector<std::pair<int16_t, bool>> ret;
+    for (size_t i = 0; i < count; ++i) {
+        ret.emplace_back(out.at(i).rpm, out.at(i).crossing);
+    }
+    return ret;
+}
+}  // namespace
+
+SCENARIO("skip band tables") {
+    auto bands = SkipBands<4>();
+    GIVEN("an empty table") {
+        THEN("no speed is inside a band") {
+            REQUIRE(bands.empty());
+            REQUIRE(!bands.contains(500));
+            REQUIRE(!bands.crosses(0, 3000));
+        }
+        THEN("a change of speed is a single ordinary leg") {
+            REQUIRE(legs(bands, 0, 3000) ==
+                    std::vector<std::pair<int16_t, bool>>{{3000, false}});
+        }
+        THEN("invalid bands are refused") {
+            REQUIRE(!bands.add(band(650, 500)));
+            REQUIRE(!bands.add(band(500, 500)));
+            REQUIRE(!bands.add(band(-100, 500)));
+            REQUIRE(bands.empty());
+        }
+        THEN("it takes bands until it is full") {
+            for (int16_t i = 0; i < 4; ++i) {
+                REQUIRE(bands.add(band(i * 1000, i * 1000 + 100)));
+            }
+            REQUIRE(!bands.add(band(3500, 3600)));
+            REQUIRE(bands.size() == 4);
+        }
+    }
+
+    GIVEN("a table with bands added out of order") {
+        REQUIRE(bands.add(band(1200, 1300)));
+        REQUIRE(bands.add(band(500, 650)));
+        THEN("they are kept in order of speed") {
+            REQUIRE(bands.size() == 2);
+            REQUIRE(bands.at(0).low_rpm == 500);
+            REQUIRE(bands.at(1).low_rpm == 1200);
+        }
+        THEN("only speeds strictly inside a band are in it") {
+            REQUIRE(!bands.contains(500));
+            REQUIRE(bands.contains(501));
+            REQUIRE(bands.contains(649));
+            REQUIRE(!bands.contains(650));
+            REQUIRE(!bands.contains(1000));
+        }
+        WHEN("adding a band that overlaps both") {
+            REQUIRE(bands.add(band(600, 1250)));
+            THEN("they merge into one") {
+                REQUIRE(bands.size() == 1);
+                REQUIRE(bands.at(0).low_rpm == 500);
+                REQUIRE(bands.at(0).high_rpm == 1300);
+            }
+        }
+        WHEN("adding a band that only touches one") {
+            REQUIRE(bands.add(band(650, 700)));
+            THEN("they stay apart, leaving the shared edge allowed") {
+                REQUIRE(bands.size() == 3);
+                REQUIRE(!bands.contains(650));
+            }
+        }
+        THEN("a speed up through both crosses each at its edges") {
+            REQUIRE(legs(bands, 0, 3000) ==
+                    std::vector<std::pair<int16_t, bool>>{{500, false},
+                                                          {650, true},
+                                                          {1200, false},
+                                                          {1300, true},
+                                                          {3000, false}});
+        }
+        THEN("a speed down through both crosses them highest first") {
+            REQUIRE(legs(bands, 3000, 100) ==
+                    std::vector<std::pair<int16_t, bool>>{{1300, false},
+                                                          {1200, true},
+                                                          {650, false},
+                                                          {500, true},
+                                                          {100, false}});
+        }
+        THEN("a change that starts inside a band crosses the rest first") {
+            REQUIRE(legs(bands, 600, 1000) ==
+                    std::vector<std::pair<int16_t, bool>>{{650, true},
+                                                          {1000, false}});
+            REQUIRE(bands.crosses(600, 1000));
+        }
+        THEN("a change that ends on an edge doesn't cross") {
+            REQUIRE(!bands.crosses(0, 500));
+            REQUIRE(!bands.crosses(650, 1200));
+            REQUIRE(legs(bands, 0, 1200) ==
+                    std::vector<std::pair<int16_t, bool>>{
+                        {500, false}, {650, true}, {1200, false}});
+        }
+        THEN("it survives being stored and restored") {
+            auto restored = SkipBands<4>();
+            REQUIRE(restored.restore(bands.store()));
+            REQUIRE(restored.size() == 2);
+            REQUIRE(restored.at(0).low_rpm == 500);
+            REQUIRE(restored.at(0).high_rpm == 650);
+            REQUIRE(restored.at(1).low_rpm == 1200);
+            REQUIRE(restored.at(1).high_rpm == 1300);
+        }
+    }
+
+    GIVEN("stored words that don't hold a table") {
+        REQUIRE(bands.add(band(500, 650)));
+        auto erased = SkipBands<4>::Stored{};
+        erased.fill(UINT64_MAX);
+        THEN("restoring fails and leaves the table empty") {
+            REQUIRE(!bands.restore(erased));
+            REQUIRE(bands.empty());
+        }
+    }
+}
@@ -0,0 +1,305 @@
+#include <array>
+#include <boost/asio.hpp>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <variant>
+#include <vector>
+
+#include "catch2/catch.hpp"
+#include "heater-shaker/heater_task.hpp"
+#include "heater-shaker/host_comms_task.hpp"
+#include "heater-shaker/messages.hpp"
+#include "heater-shaker/motor_task.hpp"
+#include "heater-shaker/system_task.hpp"
+#include "heater-shaker/tasks.hpp"
+#include "simulator/simulator_queue.hpp"
+#include "simulator/socket_sim_driver.hpp"
+
+using namespace socket_sim_driver;
+using boost::asio::ip::tcp;
+
+namespace {
+// The tasks the driver needs, none of them running
+struct IdleTasks {
+    IdleTasks() {
+        heater_queue.set_cooperative();
+        comms_queue.set_cooperative();
+        motor_queue.set_cooperative();
+        system_queue.set_cooperative();
+    }
+    heater_task::HeaterTask<SimulatorMessageQueue>::Queue heater_queue{};
+    host_comms_task::HostCommsTask<SimulatorMessageQueue>::Queue comms_queue{};
+    motor_task::MotorTask<SimulatorMessageQueue>::Queue motor_queue{};
+    system_task::SystemTask<SimulatorMessageQueue>::Queue system_queue{};
+    heater_task::HeaterTask<SimulatorMessageQueue> heater{heater_queue};
+    host_comms_task::HostCommsTask<SimulatorMessageQueue> comms{comms_queue};
+    motor_task::MotorTask<SimulatorMessageQueue> motor{motor_queue};
+    system_task::SystemTask<SimulatorMessageQueue> system{system_queue};
+    tasks::Tasks<SimulatorMessageQueue> aggregator{&heater, &comms, &motor,
+                                                   &system};
+};
+
+// The driver keeps a line, and whatever follows it, in a buffer this big
+constexpr size_t driver_buffer_size = 2048;
+// How long the client waits for anything from the driver
+constexpr auto client_timeout = std::chrono::seconds(5);
+
+auto line_of(const messages::HostCommsMessage& message) -> std::string {
+    auto line = std::get<messages::IncomingMessageFromHost>(message);
+    return std::string(line.buffer, line.limit);
+}
+
+// Wait for the comms task to be handed a line, and take it. Gives up if
+// the client is turned away.
+auto next_line(IdleTasks& tasks, tcp::socket* client = nullptr)
+    -> std::string {
+    using namespace std::chrono_literals;
+    messages::HostCommsMessage message;
+    for (int tries = 0; tries < 500; ++tries) {
+        if (tasks.comms_queue.try_recv(&message)) {
+            return line_of(message);
+        }
+        if (client && client->available() == 0) {
+            client->non_blocking(true);
+            std::array<char, 1> data{};
+            boost::system::error_code ec;
+            static_cast<void>(client->read_some(boost::asio::buffer(data), ec));
+            client->non_blocking(false);
+            if (ec && (ec != boost::asio::error::would_block)) {
+                return "";
+            }
+        }
+        std::this_thread::sleep_for(10ms);
+    }
+    return "";
+}
+
+// Take every line the comms task has been handed so far
+auto waiting_lines(IdleTasks& tasks) -> std::vector<std::string> {
+    auto lines = std::vector<std::string>();
+    messages::HostCommsMessage message;
+    while (tasks.comms_queue.try_recv(&message)) {
+        lines.push_back(line_of(message));
+    }
+    return lines;
+}
+
+// Run the driver until the scenario is done with it
+class Serving {
+  public:
+    Serving(SocketSimDriver& driver, IdleTasks& tasks)
+        : driver(driver),
+          thread([&driver, &tasks]() { driver.read(tasks.aggregator); }) {}
+    Serving(const Serving&) = delete;
+    auto operator=(const Serving&) -> Serving& = delete;
+    Serving(Serving&&) = delete;
+    auto operator=(Serving&&) -> Serving& = delete;
+    ~Serving() { driver.stop(); }
+
+  private:
+    SocketSimDriver& driver;
+    std::jthread thread;
+};
+
+auto connect(boost::asio::io_context& io_context, SocketSimDriver& driver)
+    -> tcp::socket {
+    auto socket = tcp::socket(io_context);
+    socket.connect(tcp::endpoint(boost::asio::ip::address_v4::loopback(),
+                                 driver.get_port()));
+    // Send each write as it's made, so pieces of a line arrive apart
+    socket.set_option(tcp::no_delay(true));
+    return socket;
+}
+
+auto send(tcp::socket& socket, const std::string& data) -> void {
+    boost::system::error_code ignored;
+    boost::asio::write(socket, boost::asio::buffer(data), ignored);
+}
+
+// Run the client's read, cancelling it if the driver takes too long
+auto run_read(boost::asio::io_context& io_context, tcp::socket& socket)
+    -> void {
+    io_context.restart();
+    io_context.run_for(client_timeout);
+    if (!io_context.stopped()) {
+        socket.cancel();
+        io_context.run();
+    }
+}
+
+auto read_line(boost::asio::io_context& io_context, tcp::socket& socket)
+    -> std::string {
+    boost::asio::streambuf buffer;
+    boost::asio::async_read_until(
+        socket, buffer, '\n', [](const boost::system::error_code&, size_t) {});
+    run_read(io_context, socket);
+    return std::string(boost::asio::buffers_begin(buffer.data()),
+                       boost::asio::buffers_end(buffer.data()));
+}
+
+// Wait for the driver to end the connection, and say how it did
+auto read_end(boost::asio::io_context& io_context, tcp::socket& socket)
+    -> boost::system::error_code {
+    std::array<char, 16> data{};
+    auto result = boost::system::error_code();
+    socket.async_read_some(
+        boost::asio::buffer(data),
+        [&result](const boost::system::error_code& ec, size_t) {
+            result = ec;
+        });
+    run_read(io_context, socket);
+    return result;
+}
+}  // namespace
+
+SCENARIO("socket driver serves one client at a time") {
+    GIVEN("a driver listening on a free port") {
+        auto tasks = IdleTasks();
+        auto driver = SocketSimDriver(Listen{0});
+        auto serving = Serving(driver, tasks);
+        boost::asio::io_context io_context;
+        auto first = connect(io_context, driver);
+        send(first, "M115\n");
+        REQUIRE(next_line(tasks) == "M115\n");
+        WHEN("a second client connects") {
+            auto second = connect(io_context, driver);
+            send(second, "M3 S200\n");
+            THEN("it is turned away without a response") {
+                driver.write("ok\n");
+                auto ec = read_end(io_context, second);
+                // Reset rather than closed if the line was still unread
+                REQUIRE(((ec == boost::asio::error::eof) ||
+                         (ec == boost::asio::error::connection_reset)));
+                AND_THEN("the response goes to the first client") {
+                    REQUIRE(read_line(io_context, first) == "ok\n");
+                }
+            }
+            THEN("its line never reaches the comms task") {
+                driver.comms_finished();
+                send(first, "M105\n");
+                REQUIRE(next_line(tasks) == "M105\n");
+            }
+        }
+        WHEN("the first client disconnects") {
+            driver.comms_finished();
+            first.close();
+            THEN("the next client is served") {
+                // The driver may see the next client before it sees the
+                // first one go, and turn it away, so try until it's taken
+                auto second = tcp::socket(io_context);
+                auto line = std::string();
+                for (int tries = 0; (tries < 50) && line.empty(); ++tries) {
+                    second = connect(io_context, driver);
+                    send(second, "M105\n");
+                    line = next_line(tasks, &second);
+                }
+                REQUIRE(line == "M105\n");
+                driver.write("ok\n");
+                REQUIRE(read_line(io_context, second) == "ok\n");
+            }
+        }
+    }
+}
+
+SCENARIO("socket driver splits what it reads into lines") {
+    GIVEN("a driver with a client") {
+        using namespace std::chrono_literals;
+        auto tasks = IdleTasks();
+        auto driver = SocketSimDriver(Listen{0});
+        auto serving = Serving(driver, tasks);
+        boost::asio::io_context io_context;
+        auto client = connect(io_context, driver);
+        WHEN("a line arrives in pieces") {
+            send(client, "M3");
+            std::this_thread::sleep_for(20ms);
+            send(client, " S20");
+            std::this_thread::sleep_for(20ms);
+            send(client, "0\n");
+            THEN("the comms task gets it whole") {
+                REQUIRE(next_line(tasks) == "M3 S200\n");
+            }
+        }
+        WHEN("several lines arrive together") {
+            send(client, "M105\nM115\nM3 S200\n");
+            THEN("the comms task gets each of them in order") {
+                REQUIRE(next_line(tasks) == "M105\n");
+                REQUIRE(next_line(tasks) == "M115\n");
+                REQUIRE(next_line(tasks) == "M3 S200\n");
+            }
+        }
+        WHEN("a line runs past the end of the buffer") {
+            // The first line and the start of the second fill the buffer
+            // exactly, so the second has to be moved back to the start
+            const auto first = std::string(1500, 'a') + "\n";
+            const auto second = std::string(1000, 'b') + "\n";
+            send(client, first + second);
+            REQUIRE(next_line(tasks) == first);
+            std::this_thread::sleep_for(20ms);
+            driver.comms_finished();
+            THEN("the comms task gets it whole") {
+                REQUIRE(next_line(tasks) == second);
+            }
+        }
+        WHEN("a line is longer than the buffer") {
+            send(client, std::string(driver_buffer_size + 1000, 'x') +
+                             "\nM105\n");
+            THEN("it is dropped, and the next line gets through") {
+                REQUIRE(next_line(tasks) == "M105\n");
+                std::this_thread::sleep_for(20ms);
+                REQUIRE(!tasks.comms_queue.has_message());
+            }
+        }
+    }
+}
+
+SCENARIO("socket driver waits for room in the comms queue") {
+    GIVEN("a driver with a client") {
+        using namespace std::chrono_literals;
+        auto tasks = IdleTasks();
+        auto driver = SocketSimDriver(Listen{0});
+        auto serving = Serving(driver, tasks);
+        boost::asio::io_context io_context;
+        auto client = connect(io_context, driver);
+        WHEN("the client sends more lines than the queue holds") {
+            constexpr size_t line_count = 20;
+            auto sent = std::vector<std::string>();
+            auto data = std::string();
+            for (size_t line = 0; line < line_count; ++line) {
+                sent.push_back("M105 " + std::to_string(line) + "\n");
+                data += sent.back();
+            }
+            send(client, data);
+            // Let the driver fill the queue before anything comes off it
+            for (int tries = 0;
+                 (tries < 500) && !tasks.comms_queue.has_message(); ++tries) {
+                std::this_thread::sleep_for(10ms);
+            }
+            std::this_thread::sleep_for(50ms);
+            auto received = waiting_lines(tasks);
+            THEN("the rest are held back") {
+                REQUIRE(!received.empty());
+                REQUIRE(received.size() < line_count);
+                std::this_thread::sleep_for(50ms);
+                REQUIRE(!tasks.comms_queue.has_message());
+            }
+            THEN("they all arrive, in order, as the comms task catches up") {
+                for (size_t round = 0;
+                     (round < line_count) && (received.size() < line_count);
+                     ++round) {
+                    driver.comms_finished();
+                    auto line = next_line(tasks);
+                    if (line.empty()) {
+                        break;
+                    }
+                    received.push_back(line);
+                    for (auto& more : waiting_lines(tasks)) {
+                        received.push_back(more);
+                    }
+                }
+                REQUIRE(received == sent);
+            }
+        }
+    }
+}
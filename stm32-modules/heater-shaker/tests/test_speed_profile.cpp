@@ -0,0 +1,76 @@
+#include <cmath>
+
+#include "catch2/catch.hpp"
+#include "heater-shaker/speed_profile.hpp"
+
+using namespace speed_profile;
+
+SCENARIO("s-curve speed profiles") {
+    GIVEN("a change long enough to reach the acceleration limit") {
+        auto profile = SCurve(0, 3000, 1000, 4000);
+        THEN("the change takes the ramp time plus one jerk period") {
+            // 3000 / 1000 + 1000 / 4000
+            REQUIRE(profile.duration_s() == Approx(3.25));
+            REQUIRE(profile.peak_accel_rpm_per_s() == Approx(1000));
+        }
+        THEN("it starts and ends at the right speeds") {
+            REQUIRE(profile.rpm_at(0) == 0);
+            REQUIRE(profile.rpm_at(-1) == 0);
+            REQUIRE(profile.rpm_at(profile.duration_s()) == 3000);
+            REQUIRE(profile.rpm_at(10) == 3000);
+        }
+        THEN("it is symmetric about its midpoint") {
+            REQUIRE(profile.rpm_at(profile.duration_s() / 2) ==
+                    Approx(1500));
+            REQUIRE(profile.rpm_at(0.1) ==
+                    Approx(3000 - profile.rpm_at(profile.duration_s() - 0.1)));
+        }
+        THEN("acceleration and jerk stay inside their limits") {
+            constexpr double step = 0.001;
+            double last_accel = 0;
+            for (double t = 0; t < profile.duration_s(); t += step) {
+                const double accel =
+                    (profile.rpm_at(t + step) - profile.rpm_at(t)) / step;
+                REQUIRE(accel >= 0);
+                REQUIRE(accel <= 1000 + 1e-6);
+                // Allow for the finite difference straddling a corner
+                REQUIRE(std::abs(accel - last_accel) <= 4000 * step + 1e-6);
+                last_accel = accel;
+            }
+        }
+        THEN("the acceleration ramps in rather than stepping") {
+            REQUIRE(profile.rpm_at(0.01) == Approx(0.2));
+        }
+    }
+
+    GIVEN("a change too short to reach the acceleration limit") {
+        auto profile = SCurve(1000, 1100, 1000, 4000);
+        THEN("the acceleration peaks partway and ramps straight back down") {
+            // sqrt(100 / 4000) either side of the peak
+            REQUIRE(profile.duration_s() == Approx(2 * std::sqrt(0.025)));
+            REQUIRE(profile.peak_accel_rpm_per_s() ==
+                    Approx(std::sqrt(100.0 * 4000)));
+            REQUIRE(profile.peak_accel_rpm_per_s() < 1000);
+            REQUIRE(profile.rpm_at(profile.duration_s() / 2) == Approx(1050));
+        }
+    }
+
+    GIVEN("a decrease in speed") {
+        auto profile = SCurve(3000, 500, 1000, 4000);
+        THEN("the speed falls from the start to the target") {
+            REQUIRE(profile.duration_s() == Approx(2.75));
+            REQUIRE(profile.rpm_at(0) == 3000);
+            REQUIRE(profile.rpm_at(1) < 3000);
+            REQUIRE(profile.rpm_at(1) > profile.rpm_at(2));
+            REQUIRE(profile.rpm_at(profile.duration_s()) == 500);
+        }
+    }
+
+    GIVEN("limits that aren't positive") {
+        auto profile = SCurve(0, 3000, 1000, 0);
+        THEN("the change is instant") {
+            REQUIRE(profile.duration_s() == 0);
+            REQUIRE(profile.rpm_at(0.001) == 3000);
+        }
+    }
+}
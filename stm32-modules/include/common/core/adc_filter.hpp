@@ -0,0 +1,50 @@
+/*
+ * Filtering for a stream of ADC readings from one channel, applied once per
+ * control period before the readings are converted to temperatures.
+ *
+ * - NONE passes readings through untouched.
+ * - MEDIAN outputs the median of the last MEDIAN_WINDOW readings, which
+ *   removes single-reading spikes at the cost of one reading of delay.
+ * - IIR is a first order low pass, y += alpha * (x - y). Smaller alphas
+ *   filter harder and lag more.
+ *
+ * A failed read should not be filtered at all; call reset() so that stale
+ * history doesn't leak into the readings after it.
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+class AdcFilter {
+  public:
+    enum class Mode { NONE, MEDIAN, IIR };
+
+    static constexpr size_t MEDIAN_WINDOW = 3;
+
+    AdcFilter() = delete;
+    /**
+     * @param mode The filter to apply
+     * @param iir_alpha The IIR smoothing factor in (0, 1]; ignored by the
+     * other modes
+     */
+    AdcFilter(Mode mode, double iir_alpha);
+
+    /** Add a reading and get the filtered value.*/
+    auto update(uint16_t reading) -> uint16_t;
+
+    /** Forget every previous reading.*/
+    auto reset() -> void;
+
+  private:
+    auto median() const -> uint16_t;
+
+    Mode _mode;
+    double _alpha;
+    std::array<uint16_t, MEDIAN_WINDOW> _window = {};
+    size_t _window_count = 0;
+    size_t _window_next = 0;
+    double _iir_value = 0;
+    bool _iir_started = false;
+};
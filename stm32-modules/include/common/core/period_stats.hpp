@@ -0,0 +1,47 @@
+/*
+ * Running statistics on the interval between events that are meant to be
+ * periodic, such as the thermistor scans that drive a control loop. The
+ * events are timestamped with a free running microsecond counter that may
+ * wrap; intervals are taken modulo 2^32, so a wrap between two events is
+ * harmless as long as they are less than ~71 minutes apart.
+ */
+#pragma once
+
+#include <cstdint>
+
+class PeriodStats {
+  public:
+    PeriodStats() = delete;
+    /**
+     * @param nominal_us The period the events are scheduled at, which
+     * jitter is measured against
+     */
+    explicit PeriodStats(uint32_t nominal_us);
+
+    /** Record an event. The first event after a reset only sets the start.*/
+    auto add(uint32_t timestamp_us) -> void;
+
+    /** Forget every interval, but keep the last timestamp so that the next
+     * event still produces an interval.*/
+    auto reset() -> void;
+
+    /** Number of intervals recorded.*/
+    [[nodiscard]] auto count() const -> uint32_t;
+    [[nodiscard]] auto mean_us() const -> double;
+    [[nodiscard]] auto stddev_us() const -> double;
+    [[nodiscard]] auto min_us() const -> uint32_t;
+    [[nodiscard]] auto max_us() const -> uint32_t;
+    /** Largest distance of any interval from the nominal period.*/
+    [[nodiscard]] auto peak_jitter_us() const -> uint32_t;
+
+  private:
+    uint32_t _nominal_us;
+    bool _started = false;
+    uint32_t _last_us = 0;
+    uint32_t _count = 0;
+    // Welford's running mean and sum of squared differences
+    double _mean_us = 0;
+    double _m2 = 0;
+    uint32_t _min_us = 0;
+    uint32_t _max_us = 0;
+};
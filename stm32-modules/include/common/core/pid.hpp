@@ -17,6 +17,10 @@ class PID {
     [[nodiscard]] auto last_error() const -> double;
     [[nodiscard]] auto last_iterm() const -> double;
     auto arm_integrator_reset(double error) -> void;
+    // Narrow or widen the integrator limits without resetting the loop, e.g.
+    // when the output the loop may actually use changes
+    auto set_windup_limits(double windup_limit_high, double windup_limit_low)
+        -> void;
 
   private:
     enum IntegratorResetTrigger { RISING, FALLING, NONE };
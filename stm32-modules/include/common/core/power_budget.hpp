@@ -0,0 +1,137 @@
+/*
+** The power budget shares a limited supply between tasks that each drive a
+** high power load. Every consumer publishes how much of its own maximum it
+** is currently using, and can ask for its ceiling: the fraction of its
+** maximum that is left after every consumer ahead of it in priority order
+** has taken what it asked for.
+**
+** Consumers are identified by their index, and the index is also the
+** priority: consumer 0 is served first. Demands are kept in atomics so that
+** tasks running in different threads can share one budget without locking;
+** a consumer's ceiling may be one control period stale, which is fine for
+** the thermal loops this is meant for.
+**
+** A budget built without a supply figure never limits anyone: until the
+** supply has been measured, that is what the modules ship with, and the
+** figure can be applied later with set_supply().
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+template <size_t consumer_count>
+class PowerBudget {
+  public:
+    static constexpr size_t size = consumer_count;
+
+    /**
+     * @param budget_watts The total power the supply can deliver to the
+     * consumers
+     * @param max_watts The power each consumer draws at full output, in
+     * priority order
+     */
+    PowerBudget(double budget_watts,
+                const std::array<double, consumer_count>& max_watts)
+        : _budget_mw(to_milliwatts(budget_watts)),
+          _max_mw(),
+          _demand_mw() {
+        for (size_t i = 0; i < consumer_count; ++i) {
+            _max_mw.at(i) = to_milliwatts(max_watts.at(i));
+        }
+    }
+
+    /**
+     * A budget with enough supply for every consumer at full output, so
+     * every ceiling is always 1. Demands are still tracked.
+     * @param max_watts The power each consumer draws at full output, in
+     * priority order
+     */
+    explicit PowerBudget(const std::array<double, consumer_count>& max_watts)
+        : PowerBudget(0, max_watts) {
+        set_supply(std::numeric_limits<double>::infinity());
+    }
+
+    /**
+     * Change the total power the supply can deliver. Anything at or above
+     * the sum of the consumers' maximums removes the limit.
+     */
+    auto set_supply(double budget_watts) -> void {
+        uint64_t total_mw = 0;
+        for (auto max_mw : _max_mw) {
+            total_mw += max_mw;
+        }
+        const double budget_mw = std::max(budget_watts, 0.0) *
+                                 MILLIWATTS_PER_WATT;
+        _budget_mw.store(
+            budget_mw >= static_cast<double>(total_mw)
+                ? static_cast<uint32_t>(total_mw)
+                : static_cast<uint32_t>(budget_mw),
+            std::memory_order_relaxed);
+    }
+
+    /**
+     * Publish the output a consumer is currently using.
+     * @param consumer The consumer index
+     * @param fraction The output as a fraction of the consumer's maximum.
+     * Negative values (e.g. a peltier cooling) draw power too.
+     */
+    auto set_demand(size_t consumer, double fraction) -> void {
+        const double clamped = std::min(std::abs(fraction), 1.0);
+        _demand_mw.at(consumer).store(
+            static_cast<uint32_t>(clamped * _max_mw.at(consumer)),
+            std::memory_order_relaxed);
+    }
+
+    /**
+     * The output a consumer may use without pushing the total past the
+     * budget, given what the consumers ahead of it are using.
+     * @param consumer The consumer index
+     * @return The ceiling as a fraction of the consumer's maximum, in [0, 1]
+     */
+    [[nodiscard]] auto ceiling(size_t consumer) const -> double {
+        if (_max_mw.at(consumer) == 0) {
+            return 0.0;
+        }
+        const uint32_t budget_mw = _budget_mw.load(std::memory_order_relaxed);
+        uint32_t used = 0;
+        for (size_t i = 0; i < consumer; ++i) {
+            used += _demand_mw.at(i).load(std::memory_order_relaxed);
+        }
+        if (used >= budget_mw) {
+            return 0.0;
+        }
+        return std::min(static_cast<double>(budget_mw - used) /
+                            static_cast<double>(_max_mw.at(consumer)),
+                        1.0);
+    }
+
+    /** The last published demand of a consumer, as a fraction of its max.*/
+    [[nodiscard]] auto demand(size_t consumer) const -> double {
+        if (_max_mw.at(consumer) == 0) {
+            return 0.0;
+        }
+        return static_cast<double>(
+                   _demand_mw.at(consumer).load(std::memory_order_relaxed)) /
+               static_cast<double>(_max_mw.at(consumer));
+    }
+
+  private:
+    static constexpr double MILLIWATTS_PER_WATT = 1000.0;
+
+    static constexpr auto to_milliwatts(double watts) -> uint32_t {
+        return static_cast<uint32_t>(std::max(watts, 0.0) *
+                                     MILLIWATTS_PER_WATT);
+    }
+
+    std::atomic<uint32_t> _budget_mw;
+    std::array<uint32_t, consumer_count> _max_mw;
+    // Stored as integers so the atomics are lock-free on 32 bit targets
+    std::array<std::atomic<uint32_t>, consumer_count> _demand_mw;
+};
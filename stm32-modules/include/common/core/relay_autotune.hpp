@@ -0,0 +1,83 @@
+/*
+ * Relay-feedback PID autotuning (Astrom-Hagglund). While running, the tuner
+ * replaces the PID and drives its output with a bang-bang relay around the
+ * setpoint. This forces the loop into a limit cycle; the amplitude and period
+ * of that cycle give the ultimate gain and period of the plant, from which
+ * PID constants are derived.
+ */
+#pragma once
+
+#include <cstdint>
+
+class RelayAutotune {
+  public:
+    enum class Status {
+        RUNNING, /**< Still collecting oscillation cycles.*/
+        DONE,    /**< Enough cycles were measured; gains are valid.*/
+        FAILED   /**< The loop never settled into a limit cycle in time.*/
+    };
+
+    // Cycles run from one overshoot of the setpoint to the next. The
+    // approach to the first overshoot isn't a cycle at all, and the first
+    // full cycle is still settling from it, so both are skipped; this many
+    // cycles after them are averaged
+    static constexpr uint8_t DEFAULT_CYCLES = 4;
+    static constexpr double DEFAULT_TIMEOUT_S = 60.0 * 30.0;
+
+    RelayAutotune() = delete;
+    /**
+     * @param setpoint The temperature to oscillate around
+     * @param output_high The relay output while below the setpoint
+     * @param output_low The relay output while above the setpoint
+     * @param hysteresis Deadband around the setpoint, which keeps sensor
+     * noise from chattering the relay
+     * @param sampletime Time between calls to update(), in seconds
+     * @param cycles The number of cycles to average the result across
+     * @param timeout_s How long to try before failing, in seconds
+     */
+    RelayAutotune(double setpoint, double output_high, double output_low,
+                  double hysteresis, double sampletime,
+                  uint8_t cycles = DEFAULT_CYCLES,
+                  double timeout_s = DEFAULT_TIMEOUT_S);
+
+    /**
+     * Feed a new measurement into the tuner.
+     * @return the output to apply until the next update
+     */
+    auto update(double input) -> double;
+
+    [[nodiscard]] auto status() const -> Status;
+    [[nodiscard]] auto setpoint() const -> double;
+    [[nodiscard]] auto output() const -> double;
+    [[nodiscard]] auto cycles_completed() const -> uint8_t;
+    // These are only meaningful once status() is DONE
+    [[nodiscard]] auto ultimate_gain() const -> double;
+    [[nodiscard]] auto ultimate_period() const -> double;
+    // Suggested constants in the form used by PID, using the Tyreus-Luyben
+    // rule, which trades some rise time for much less overshoot than
+    // Ziegler-Nichols
+    [[nodiscard]] auto kp() const -> double;
+    [[nodiscard]] auto ki() const -> double;
+    [[nodiscard]] auto kd() const -> double;
+
+  private:
+    auto finish_cycle() -> void;
+
+    double _setpoint;
+    double _output_high;
+    double _output_low;
+    double _hysteresis;
+    double _sampletime;
+    uint8_t _cycles;
+    double _timeout_s;
+    Status _status = Status::RUNNING;
+    bool _relay_high = true;
+    double _elapsed_s = 0;
+    // Time of the most recent high->low relay switch, or < 0 if none yet
+    double _last_switch_s = -1;
+    double _cycle_max = 0;
+    double _cycle_min = 0;
+    uint8_t _cycles_completed = 0;
+    double _period_sum = 0;
+    double _amplitude_sum = 0;
+};
@@ -0,0 +1,108 @@
+/*
+ * Mean, spread and range of the most recent readings of a signal, e.g. to
+ * measure how noisy a thermistor is while its temperature is steady. The
+ * window is kept as a ring buffer and the statistics are computed over it
+ * on request, so adding a reading is cheap and the result doesn't drift
+ * from accumulated rounding. Each statistic can also cover just the last
+ * few readings in the window, so a caller can pick a shorter window at
+ * runtime without keeping a buffer for each.
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+template <size_t Window>
+class RollingStats {
+  public:
+    static constexpr size_t window = Window;
+
+    auto add(double value) -> void {
+        _values.at(_next) = value;
+        _next = (_next + 1) % Window;
+        if (_count < Window) {
+            ++_count;
+        }
+    }
+
+    auto reset() -> void {
+        _count = 0;
+        _next = 0;
+    }
+
+    /** Number of readings in the window, up to the window size.*/
+    [[nodiscard]] auto count() const -> size_t { return _count; }
+    /** Number of readings the last `last` of them cover.*/
+    [[nodiscard]] auto count(size_t last) const -> size_t {
+        return std::min(last, _count);
+    }
+
+    [[nodiscard]] auto mean(size_t last = Window) const -> double {
+        const auto covered = count(last);
+        if (covered == 0) {
+            return 0;
+        }
+        double sum = 0;
+        for (size_t i = 0; i < covered; ++i) {
+            sum += recent(i);
+        }
+        return sum / static_cast<double>(covered);
+    }
+
+    /** Sample variance of the last readings in the window.*/
+    [[nodiscard]] auto variance(size_t last = Window) const -> double {
+        const auto covered = count(last);
+        if (covered < 2) {
+            return 0;
+        }
+        const double average = mean(last);
+        double squares = 0;
+        for (size_t i = 0; i < covered; ++i) {
+            const double diff = recent(i) - average;
+            squares += diff * diff;
+        }
+        return squares / static_cast<double>(covered - 1);
+    }
+
+    /** Sample standard deviation of the last readings in the window.*/
+    [[nodiscard]] auto stddev(size_t last = Window) const -> double {
+        return std::sqrt(variance(last));
+    }
+
+    [[nodiscard]] auto min(size_t last = Window) const -> double {
+        const auto covered = count(last);
+        if (covered == 0) {
+            return 0;
+        }
+        double lowest = recent(0);
+        for (size_t i = 1; i < covered; ++i) {
+            lowest = std::min(lowest, recent(i));
+        }
+        return lowest;
+    }
+
+    [[nodiscard]] auto max(size_t last = Window) const -> double {
+        const auto covered = count(last);
+        if (covered == 0) {
+            return 0;
+        }
+        double highest = recent(0);
+        for (size_t i = 1; i < covered; ++i) {
+            highest = std::max(highest, recent(i));
+        }
+        return highest;
+    }
+
+  private:
+    // The reading that many readings older than the latest one
+    [[nodiscard]] auto recent(size_t age) const -> double {
+        return _values.at((_next + Window - 1 - age) % Window);
+    }
+
+    // Until the window fills, the readings are at the start of the buffer
+    std::array<double, Window> _values = {};
+    size_t _count = 0;
+    size_t _next = 0;
+};
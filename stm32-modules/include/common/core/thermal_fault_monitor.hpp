@@ -0,0 +1,102 @@
+/*
+ * Rate-of-rise fault detection for a closed loop thermal element. The static
+ * thermistor checks only catch a fault once the reading itself is out of
+ * range; this instead compares what the loop is commanding against how the
+ * temperature actually moves, so that a detached thermistor, a dead driver or
+ * a load that is stuck on can be caught while the temperature is still sane.
+ *
+ * Two things are checked:
+ * - Response: while the output is driven hard towards a target that is
+ *   still some way off, the temperature must move at least a minimum amount
+ *   that way within one window. A heater whose thermistor fell off the block
+ *   will sit at full power without the reading changing. Near the target a
+ *   loop may legitimately sit at a high output, so this isn't checked there.
+ * - Runaway: while the output is not heating, the temperature must not rise
+ *   by more than a limit within any one window. The first window after the
+ *   output drops is a grace period for the element's own thermal lag. An
+ *   element that shares a block with others (like the zones of a peltier
+ *   plate) can be heated by its neighbours while its own output is backed
+ *   off, so for those "not heating" means nothing in the block is heating.
+ */
+#pragma once
+
+#include <cstdint>
+
+class ThermalFaultMonitor {
+  public:
+    enum class Fault {
+        NONE,        /**< Temperature is following the output.*/
+        NO_RESPONSE, /**< Temperature didn't follow a driven output.*/
+        RUNAWAY      /**< Temperature rose while the output was not heating.*/
+    };
+
+    struct Limits {
+        // Length of each check window, in seconds
+        double window_s;
+        // Outputs at or beyond this magnitude count as driving the element
+        double drive_threshold;
+        // The response is only checked while further than this from target
+        double target_band_c;
+        // Minimum change, in the driven direction, expected within a window
+        double min_response_c;
+        // Largest rise allowed within a window while not heating
+        double max_undriven_rise_c;
+    };
+
+    ThermalFaultMonitor() = delete;
+    /**
+     * @param limits The thresholds for this thermal element
+     * @param sampletime Time between calls to update(), in seconds
+     */
+    ThermalFaultMonitor(const Limits& limits, double sampletime);
+
+    /**
+     * Feed a new measurement and the output that was applied since the last
+     * one. Once a fault is found it is latched until reset().
+     * @param temp_c The measured temperature
+     * @param target_c The temperature the loop is driving towards
+     * @param output The commanded output, from -1 (full cooling) to 1 (full
+     * heating)
+     * @return the current fault, if any
+     */
+    auto update(double temp_c, double target_c, double output) -> Fault;
+
+    /**
+     * As above, for an element thermally coupled to others.
+     * @param coupled_output The most heating output applied to anything in
+     * the block the element shares, including itself. The runaway check
+     * only runs while this isn't heating.
+     */
+    auto update(double temp_c, double target_c, double output,
+                double coupled_output) -> Fault;
+
+    /** Forget all history, e.g. when the loop stops controlling.*/
+    auto reset() -> void;
+
+    [[nodiscard]] auto fault() const -> Fault;
+
+    /**
+     * Two thermistors reading the same thermal mass should agree closely;
+     * one that has come loose reads far from its partner.
+     */
+    [[nodiscard]] static auto pair_plausible(double a_c, double b_c,
+                                             double max_delta_c) -> bool;
+
+  private:
+    auto check_response(double temp_c, int8_t drive) -> void;
+    auto check_runaway(double temp_c, double output) -> void;
+
+    Limits _limits;
+    double _sampletime;
+    Fault _fault = Fault::NONE;
+    // -1 driven cooling, 0 not driven, 1 driven heating; only nonzero while
+    // the target is outside the band
+    int8_t _drive = 0;
+    bool _responded = true;
+    double _response_start_c = 0;
+    double _response_elapsed_s = 0;
+    // Time spent not heating, or < 0 while heating
+    double _undriven_elapsed_s = -1;
+    double _runaway_start_c = 0;
+    double _runaway_window_s = 0;
+};
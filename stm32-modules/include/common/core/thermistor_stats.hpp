@@ -0,0 +1,115 @@
+/*
+ * Health statistics for one thermistor, updated with every conversion so
+ * that a failing sensor shows up without streaming raw samples:
+ *
+ * - min, max, mean and variance of the last Window valid temperatures
+ * - how many of the last Window conversions were invalid (out of range of
+ *   the thermistor table), and how many have been since boot
+ * - drift: how far the mean of the window has moved from the mean of the
+ *   first full window after boot. This is only a fair comparison when the
+ *   sensor is at a similar temperature to the one it started at, e.g. an
+ *   idle module in the same room.
+ *
+ * Window is how much is kept; the window statistics can be asked for over
+ * any shorter run of the most recent conversions, e.g. to see a transient
+ * that a full window would average away.
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "core/rolling_stats.hpp"
+
+template <size_t Window>
+class ThermistorStats {
+  public:
+    static constexpr size_t window = Window;
+
+    /** Add a valid temperature reading.*/
+    auto add(double temp_c) -> void {
+        record(false);
+        _readings.add(temp_c);
+        if (!_baseline_set && (_readings.count() == Window)) {
+            _baseline_c = _readings.mean();
+            _baseline_set = true;
+        }
+    }
+
+    /** Count a conversion that didn't give a temperature.*/
+    auto add_invalid() -> void {
+        record(true);
+        ++_total_invalid;
+    }
+
+    /** Number of valid readings among the last `last` of them.*/
+    [[nodiscard]] auto count(size_t last = Window) const -> size_t {
+        return _readings.count(last);
+    }
+    [[nodiscard]] auto min(size_t last = Window) const -> double {
+        return _readings.min(last);
+    }
+    [[nodiscard]] auto max(size_t last = Window) const -> double {
+        return _readings.max(last);
+    }
+    [[nodiscard]] auto mean(size_t last = Window) const -> double {
+        return _readings.mean(last);
+    }
+    [[nodiscard]] auto variance(size_t last = Window) const -> double {
+        return _readings.variance(last);
+    }
+    [[nodiscard]] auto stddev(size_t last = Window) const -> double {
+        return _readings.stddev(last);
+    }
+    /** Invalid conversions among the last `last` conversions.*/
+    [[nodiscard]] auto invalid(size_t last = Window) const -> size_t {
+        if (last >= _recent_count) {
+            return _recent_invalid;
+        }
+        size_t invalid = 0;
+        for (size_t age = 0; age < last; ++age) {
+            if (_recent.at((_recent_next + Window - 1 - age) % Window)) {
+                ++invalid;
+            }
+        }
+        return invalid;
+    }
+    /** Conversions since boot, valid or not.*/
+    [[nodiscard]] auto total() const -> uint32_t { return _total; }
+    [[nodiscard]] auto total_invalid() const -> uint32_t {
+        return _total_invalid;
+    }
+    /** Mean of the window less that of the first full one; 0 until then.*/
+    [[nodiscard]] auto drift() const -> double {
+        return _baseline_set ? _readings.mean() - _baseline_c : 0;
+    }
+
+  private:
+    auto record(bool invalid) -> void {
+        ++_total;
+        if (_recent_count == Window) {
+            if (_recent.at(_recent_next)) {
+                --_recent_invalid;
+            }
+        } else {
+            ++_recent_count;
+        }
+        _recent.at(_recent_next) = invalid;
+        if (invalid) {
+            ++_recent_invalid;
+        }
+        _recent_next = (_recent_next + 1) % Window;
+    }
+
+    RollingStats<Window> _readings = RollingStats<Window>();
+    // Ring buffer of whether each of the last Window conversions was invalid
+    std::array<bool, Window> _recent = {};
+    size_t _recent_count = 0;
+    size_t _recent_next = 0;
+    size_t _recent_invalid = 0;
+    uint32_t _total = 0;
+    uint32_t _total_invalid = 0;
+    double _baseline_c = 0;
+    bool _baseline_set = false;
+};
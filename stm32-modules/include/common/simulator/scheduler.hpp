@@ -0,0 +1,147 @@
+/*
+ * Runs the simulator's tasks cooperatively on one thread, instead of each
+ * on a thread of its own.
+ *
+ * A task is only stepped when it has a message waiting, so stepping it
+ * never blocks, and its queues are set up never to wait (see
+ * SimulatorMessageQueue::set_cooperative). When more than one task is
+ * ready, which one goes next is picked at random from a fixed seed, so
+ * the interleaving of tasks is repeatable for a given seed and input, and
+ * different seeds shake out different interleavings. Anything that would
+ * otherwise run on a timer of its own, like reading the simulated
+ * thermistors, runs as a periodic action on the simulator clock, and
+ * anything armed for a one-off time, like a task's wakeups, as a timer.
+ *
+ * The scheduler is the only participant in the simulator clock, and waits
+ * on it when nothing is ready and nothing is due.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <stop_token>
+#include <vector>
+
+#include "simulator/sim_clock.hpp"
+
+namespace scheduler {
+
+class Scheduler {
+  public:
+    using duration = sim_clock::SimClock::duration;
+
+    explicit Scheduler(uint32_t seed) : _random(seed) {}
+    Scheduler(const Scheduler&) = delete;
+    auto operator=(const Scheduler&) -> Scheduler& = delete;
+    Scheduler(Scheduler&&) = delete;
+    auto operator=(Scheduler&&) -> Scheduler& = delete;
+    ~Scheduler() = default;
+
+    /**
+     * Add a task. Only call this before run().
+     * @param ready Whether the task has something to do
+     * @param step Do one thing, without waiting. Only called once ready()
+     * is true.
+     */
+    auto add_task(std::function<bool()> ready, std::function<void()> step)
+        -> void {
+        _tasks.push_back(Task{std::move(ready), std::move(step)});
+    }
+
+    /**
+     * Call an action once every period of simulator time, the first time
+     * one period after run() starts. Only call this before run().
+     */
+    auto add_periodic(duration period, std::function<void()> action)
+        -> void {
+        _periodics.push_back(Periodic{period, period, std::move(action)});
+    }
+
+    /**
+     * Call an action whenever the simulator clock reaches the time due()
+     * gives, which is FOREVER while there's nothing to wait for. The action
+     * has to move due() on. Only call this before run().
+     */
+    auto add_timer(std::function<duration()> due,
+                   std::function<void()> action) -> void {
+        _timers.push_back(Timer{std::move(due), std::move(action)});
+    }
+
+    /** Run everything until a stop is requested.*/
+    auto run(const std::stop_token& st) -> void {
+        auto& clock = sim_clock::clock();
+        clock.add_participant();
+        const auto start = clock.now();
+        for (auto& periodic : _periodics) {
+            periodic.next = start + periodic.period;
+        }
+        const std::function<bool()> any_ready = [this]() {
+            return std::any_of(_tasks.begin(), _tasks.end(),
+                               [](const Task& task) { return task.ready(); });
+        };
+        while (!st.stop_requested()) {
+            const auto now = clock.now();
+            auto next = sim_clock::SimClock::FOREVER;
+            for (auto& periodic : _periodics) {
+                if (periodic.next <= now) {
+                    periodic.action();
+                    periodic.next += periodic.period;
+                }
+                next = std::min(next, periodic.next);
+            }
+            for (auto& timer : _timers) {
+                if (timer.due() <= now) {
+                    timer.action();
+                }
+                next = std::min(next, timer.due());
+            }
+            if (!step_one()) {
+                static_cast<void>(clock.wait_until(next, any_ready, st));
+            }
+        }
+        clock.remove_participant();
+    }
+
+  private:
+    struct Task {
+        std::function<bool()> ready;
+        std::function<void()> step;
+    };
+    struct Periodic {
+        duration period;
+        duration next;
+        std::function<void()> action;
+    };
+    struct Timer {
+        std::function<duration()> due;
+        std::function<void()> action;
+    };
+
+    // Step one of the ready tasks, picked at random
+    auto step_one() -> bool {
+        _ready.clear();
+        for (size_t i = 0; i < _tasks.size(); ++i) {
+            if (_tasks[i].ready()) {
+                _ready.push_back(i);
+            }
+        }
+        if (_ready.empty()) {
+            return false;
+        }
+        auto pick =
+            std::uniform_int_distribution<size_t>(0, _ready.size() - 1);
+        _tasks[_ready[pick(_random)]].step();
+        return true;
+    }
+
+    std::vector<Task> _tasks{};
+    std::vector<Periodic> _periodics{};
+    std::vector<Timer> _timers{};
+    std::vector<size_t> _ready{};
+    std::mt19937 _random;
+};
+
+}  // namespace scheduler
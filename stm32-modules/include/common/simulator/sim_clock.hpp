@@ -0,0 +1,185 @@
+/*
+ * The time the simulator runs on. Every simulator thread that waits, for a
+ * message or for time to pass, waits on this clock.
+ *
+ * At a speed of 1 it follows the steady clock, and at other speeds it runs
+ * that many times faster. Run as fast as possible, it doesn't follow the
+ * wall clock at all: it stands still while any thread taking part in it is
+ * busy, and once they are all waiting it jumps straight to the earliest
+ * time any of them is waiting for. Each task queue takes part for its
+ * task's thread; threads that only wait for time to pass, like the plant
+ * models, take part explicitly.
+ *
+ * Anything that changes what a waiting thread is waiting for (like sending
+ * it a message) has to call notify() afterwards.
+ */
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <stop_token>
+
+namespace sim_clock {
+
+class SimClock {
+  public:
+    using duration = std::chrono::microseconds;
+    using real_clock = std::chrono::steady_clock;
+    // A wait until this never times out
+    static constexpr duration FOREVER = duration::max();
+    static constexpr double AS_FAST_AS_POSSIBLE = 0;
+
+    SimClock() = default;
+    SimClock(const SimClock&) = delete;
+    auto operator=(const SimClock&) -> SimClock& = delete;
+    SimClock(SimClock&&) = delete;
+    auto operator=(SimClock&&) -> SimClock& = delete;
+    ~SimClock() = default;
+
+    /**
+     * Set how fast the clock runs, restarting it from 0. Only call this
+     * before any thread uses the clock.
+     * @param speed A multiple of real time, or AS_FAST_AS_POSSIBLE
+     */
+    auto set_speed(double speed) -> void {
+        auto lock = std::lock_guard(_mutex);
+        _speed = std::max(speed, AS_FAST_AS_POSSIBLE);
+        _start = real_clock::now();
+        _now = duration(0);
+    }
+
+    [[nodiscard]] auto speed() const -> double { return _speed; }
+
+    [[nodiscard]] auto now() -> duration {
+        auto lock = std::lock_guard(_mutex);
+        return now_locked();
+    }
+
+    auto add_participant() -> void {
+        auto lock = std::lock_guard(_mutex);
+        ++_participants;
+    }
+
+    auto remove_participant() -> void {
+        {
+            auto lock = std::lock_guard(_mutex);
+            --_participants;
+        }
+        _changed.notify_all();
+    }
+
+    /**
+     * Wait until ready() is true, the clock reaches the deadline, or a stop
+     * is requested.
+     * @return ready() when the wait finished
+     */
+    auto wait_until(duration deadline, const std::function<bool()>& ready,
+                    const std::stop_token& st) -> bool {
+        auto on_stop = std::stop_callback(st, [this]() { notify(); });
+        auto lock = std::unique_lock(_mutex);
+        if (_speed == AS_FAST_AS_POSSIBLE) {
+            return wait_virtual(lock, deadline, ready, st);
+        }
+        auto done = [&]() { return ready() || st.stop_requested(); };
+        if (deadline == FOREVER) {
+            _changed.wait(lock, done);
+        } else {
+            _changed.wait_until(lock, to_real(deadline), done);
+        }
+        return ready();
+    }
+
+    /** Wait until the clock reaches the deadline or a stop is requested.*/
+    auto sleep_until(duration deadline, const std::stop_token& st) -> void {
+        static const std::function<bool()> never = []() { return false; };
+        static_cast<void>(wait_until(deadline, never, st));
+    }
+
+    /** Wake waiting threads to check whether they are ready.*/
+    auto notify() -> void {
+        // Taking the lock orders this after any waiter's last check
+        { auto lock = std::lock_guard(_mutex); }
+        _changed.notify_all();
+    }
+
+  private:
+    struct Waiter {
+        duration deadline;
+        const std::function<bool()>* ready;
+    };
+
+    [[nodiscard]] auto now_locked() const -> duration {
+        if (_speed == AS_FAST_AS_POSSIBLE) {
+            return _now;
+        }
+        return std::chrono::duration_cast<duration>(
+            std::chrono::duration<double, std::micro>(real_clock::now() -
+                                                      _start) *
+            _speed);
+    }
+
+    [[nodiscard]] auto to_real(duration deadline) const
+        -> real_clock::time_point {
+        return _start + std::chrono::duration_cast<real_clock::duration>(
+                            std::chrono::duration<double, std::micro>(
+                                deadline) /
+                            _speed);
+    }
+
+    auto wait_virtual(std::unique_lock<std::mutex>& lock, duration deadline,
+                      const std::function<bool()>& ready,
+                      const std::stop_token& st) -> bool {
+        auto self =
+            _waiters.insert(_waiters.end(), Waiter{deadline, &ready});
+        while (!ready() && !st.stop_requested() && (_now < deadline)) {
+            if (!advance()) {
+                _changed.wait(lock);
+            }
+        }
+        _waiters.erase(self);
+        return ready();
+    }
+
+    // Jump to the earliest deadline, if every participant is waiting and
+    // none of them has anything to do yet
+    auto advance() -> bool {
+        if (_waiters.size() < _participants) {
+            return false;
+        }
+        auto next = FOREVER;
+        for (const auto& waiter : _waiters) {
+            if ((*waiter.ready)()) {
+                return false;
+            }
+            next = std::min(next, waiter.deadline);
+        }
+        // Waiters that are already due just haven't woken up yet
+        if ((next == FOREVER) || (next <= _now)) {
+            return false;
+        }
+        _now = next;
+        _changed.notify_all();
+        return true;
+    }
+
+    std::mutex _mutex{};
+    std::condition_variable _changed{};
+    double _speed = 1;
+    real_clock::time_point _start = real_clock::now();
+    duration _now = duration(0);
+    size_t _participants = 0;
+    std::list<Waiter> _waiters{};
+};
+
+/** The clock the whole simulator shares.*/
+inline auto clock() -> SimClock& {
+    static SimClock instance;
+    return instance;
+}
+
+}  // namespace sim_clock
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <algorithm>
+#include <boost/lockfree/queue.hpp>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <thread>
+
+#include "simulator/sim_clock.hpp"
+
+/*
+ * Waits, and timeouts in ticks (milliseconds), are on the simulator clock.
+ * Each queue takes part in the clock for the thread that receives from it,
+ * unless it's set up for the cooperative scheduler (see scheduler.hpp).
+ */
+template <typename Message, size_t queue_size = 8>
+class SimulatorMessageQueue {
+  public:
+    using clock = sim_clock::SimClock;
+    using QueueType =
+        boost::lockfree::queue<Message, boost::lockfree::capacity<queue_size>>;
+    class StopDuringMsgWait : public std::exception {};
+    SimulatorMessageQueue()
+        : queue(),
+          mythread_stop_token(),
+          has_message_fn([this]() { return has_message(); }) {
+        sim_clock::clock().add_participant();
+    }
+    SimulatorMessageQueue(const SimulatorMessageQueue&) = delete;
+    auto operator=(const SimulatorMessageQueue&)
+        -> SimulatorMessageQueue& = delete;
+    SimulatorMessageQueue(SimulatorMessageQueue&&) = delete;
+    auto operator=(SimulatorMessageQueue&&) -> SimulatorMessageQueue& = delete;
+    ~SimulatorMessageQueue() {
+        if (!cooperative) {
+            sim_clock::clock().remove_participant();
+        }
+    }
+
+    auto get_backing_queue() -> QueueType& { return queue; }
+    auto set_stop_token(std::stop_token st) { mythread_stop_token = st; }
+
+    /**
+     * Never wait to send or receive: a full queue fails a send and an empty
+     * one fails a receive straight away, whatever the timeout. For a queue
+     * whose task is only run once it has a message; since it never waits
+     * on the clock, it stops taking part in it.
+     */
+    auto set_cooperative() -> void {
+        if (!cooperative) {
+            cooperative = true;
+            sim_clock::clock().remove_participant();
+        }
+    }
+
+    [[nodiscard]] auto try_send(const Message& message,
+                                const uint32_t timeout_ticks = 0) -> bool {
+        using namespace std::literals::chrono_literals;
+        static const std::function<bool()> never = []() { return false; };
+        auto& sim_time = sim_clock::clock();
+        const auto deadline =
+            sim_time.now() + std::chrono::milliseconds(timeout_ticks);
+        while (!queue.push(message)) {
+            const auto now = sim_time.now();
+            if (cooperative || (now >= deadline)) {
+                return false;
+            }
+            // Check for room again every tick
+            static_cast<void>(sim_time.wait_until(
+                std::min(deadline, now + clock::duration(1ms)), never,
+                std::stop_token()));
+        }
+        sim_time.notify();
+        return true;
+    }
+
+    [[nodiscard]] auto try_recv(Message* message, uint32_t timeout_ticks = 0)
+        -> bool {
+        if (!message) {
+            throw std::invalid_argument("null message pointer");
+        }
+        auto& sim_time = sim_clock::clock();
+        const auto deadline =
+            (timeout_ticks == std::numeric_limits<uint32_t>::max())
+                ? clock::FOREVER
+                : sim_time.now() + std::chrono::milliseconds(timeout_ticks);
+        while (!queue.pop(*message)) {
+            if (cooperative || (sim_time.now() >= deadline)) {
+                return false;
+            }
+            if (mythread_stop_token.stop_requested()) {
+                throw StopDuringMsgWait();
+            }
+            static_cast<void>(sim_time.wait_until(deadline, has_message_fn,
+                                                   mythread_stop_token));
+        }
+        // There's room for a sender that might be waiting
+        sim_time.notify();
+        return true;
+    }
+
+    auto recv(Message* message) -> void {
+        static_cast<void>(
+            try_recv(message, std::numeric_limits<uint32_t>::max()));
+    }
+
+    [[nodiscard]] auto has_message() const -> bool { return !queue.empty(); }
+
+  private:
+    QueueType queue;
+    std::stop_token mythread_stop_token;
+    std::function<bool()> has_message_fn;
+    bool cooperative = false;
+};
@@ -46,6 +46,16 @@ enum class ErrorCode {
     MOTOR_NOT_STOPPED = 124,
     PLATE_LOCK_TIMEOUT = 125,
     PLATE_LOCK_NOT_CLOSED = 126,
+    MOTOR_ILLEGAL_JERK = 127,
+    MOTOR_PROGRAM_FULL = 128,
+    MOTOR_PROGRAM_EMPTY = 129,
+    MOTOR_BAD_CAPTURE_SETTINGS = 130,
+    MOTOR_CAPTURE_NOT_ARMED = 131,
+    MOTOR_RPM_IN_SKIP_BAND = 132,
+    MOTOR_ILLEGAL_SKIP_BAND = 133,
+    MOTOR_SKIP_BANDS_FULL = 134,
+    MOTOR_SKIP_BANDS_NOT_SAVED = 135,
+    PLATE_LOCK_MOVE_SUPERSEDED = 136,
     HEATER_THERMISTOR_A_DISCONNECTED = 201,
     HEATER_THERMISTOR_A_SHORT = 202,
     HEATER_THERMISTOR_A_OVERTEMP = 203,
@@ -57,6 +67,10 @@ enum class ErrorCode {
     HEATER_THERMISTOR_BOARD_DISCONNECTED = 210,
     HEATER_HARDWARE_ERROR_LATCH = 211,
     HEATER_CONSTANT_OUT_OF_RANGE = 212,
+    HEATER_AUTOTUNE_FAILED = 213,
+    HEATER_THERMISTOR_MISMATCH = 214,
+    HEATER_THERMAL_RUNAWAY = 215,
+    HEATER_NO_RESPONSE = 216,
     SYSTEM_SERIAL_NUMBER_INVALID = 301,
     SYSTEM_SERIAL_NUMBER_HAL_ERROR = 302,
     SYSTEM_LED_I2C_NOT_READY = 303,
@@ -21,6 +21,9 @@
 #include "core/gcode_parser.hpp"
 #include "core/utility.hpp"
 #include "heater-shaker/errors.hpp"
+#include "heater-shaker/loop_timing.hpp"
+#include "heater-shaker/motor_telemetry.hpp"
+#include "heater-shaker/skip_bands.hpp"
 #include "systemwide.h"
 
 namespace gcode {
@@ -201,6 +204,9 @@ struct GetRPM {
         if (working == input) {
             return std::make_pair(ParseResult(), input);
         }
+        if (working != limit && !std::isspace(*working)) {
+            return std::make_pair(ParseResult(), input);
+        }
         return std::make_pair(ParseResult(GetRPM()), working);
     }
 };
@@ -256,6 +262,531 @@ struct SetAcceleration {
     }
 };
 
+struct SetJerk {
+    /*
+    ** SetJerk uses M205, which sets the jerk limit in RPM/s^2 for changes of
+    ** speed. With a jerk limit, speed changes follow an S-curve: the
+    ** acceleration ramps up at this rate to the limit set by M204 and back
+    ** down again, rather than stepping straight to it. 0 turns the limit off,
+    ** so speed changes follow a plain M204 ramp.
+    ** Format: M205 Jxxxx
+    ** Example: M205 J5000
+    */
+
+    using ParseResult = std::optional<SetJerk>;
+    int32_t rpm_per_s2;
+    static constexpr auto prefix = std::array{'M', '2', '0', '5', ' ', 'J'};
+    static constexpr const char* response = "M205 OK\n";
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    static auto write_response_into(InputIt buf, InputLimit limit) -> InputIt {
+        return write_string_to_iterpair(buf, limit, response);
+    }
+
+    template <typename InputIt, typename Limit>
+    requires std::contiguous_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto working = prefix_matches(input, limit, prefix);
+        if (working == input) {
+            return std::make_pair(ParseResult(), input);
+        }
+
+        auto value_res = parse_value<int32_t>(working, limit);
+
+        if (!value_res.first.has_value()) {
+            return std::make_pair(ParseResult(), input);
+        }
+        return std::make_pair(
+            ParseResult(SetJerk{
+                .rpm_per_s2 = static_cast<int32_t>(value_res.first.value())}),
+            value_res.second);
+    }
+};
+
+struct AddShakeSegment {
+    /*
+    ** AddShakeSegment uses M3.P to add a segment to the end of the shake
+    ** program that M3.S runs. The segment ramps to S rpm at A rpm/s, then
+    ** holds that speed for D ms. R repeats the segments since the previous
+    ** segment with an R (or since the start) that many more times, and H
+    ** sets the heater to that temperature as the segment starts.
+    ** Format: M3.P S<rpm> A<rpm/s> D<ms> [R<repeats>] [H<temp>]
+    ** Example: M3.P S1500 A2000 D10000 R3 H37
+    */
+    using ParseResult = std::optional<AddShakeSegment>;
+    static constexpr auto prefix = std::array{'M', '3', '.', 'P', ' ', 'S'};
+    static constexpr const char* response = "M3.P OK\n";
+    int16_t rpm;
+    int32_t ramp_rpm_per_s;
+    uint32_t dwell_ms;
+    uint16_t repeats;
+    std::optional<double> temperature;
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    static auto write_response_into(InputIt buf, InputLimit limit) -> InputIt {
+        return write_string_to_iterpair(buf, limit, response);
+    }
+
+    template <typename InputIt, typename Limit>
+    requires std::contiguous_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto working = prefix_matches(input, limit, prefix);
+        if (working == input) {
+            return std::make_pair(ParseResult(), input);
+        }
+        auto rpm_res = parse_value<int16_t>(working, limit);
+        if (!rpm_res.first.has_value()) {
+            return std::make_pair(ParseResult(), input);
+        }
+
+        constexpr auto a_pref = std::array{' ', 'A'};
+        working = prefix_matches(rpm_res.second, limit, a_pref);
+        if (working == rpm_res.second) {
+            return std::make_pair(ParseResult(), input);
+        }
+        auto ramp_res = parse_value<int32_t>(working, limit);
+        if (!ramp_res.first.has_value()) {
+            return std::make_pair(ParseResult(), input);
+        }
+
+        constexpr auto d_pref = std::array{' ', 'D'};
+        working = prefix_matches(ramp_res.second, limit, d_pref);
+        if (working == ramp_res.second) {
+            return std::make_pair(ParseResult(), input);
+        }
+        auto dwell_res = parse_value<uint32_t>(working, limit);
+        if (!dwell_res.first.has_value()) {
+            return std::make_pair(ParseResult(), input);
+        }
+        auto segment = AddShakeSegment{.rpm = rpm_res.first.value(),
+                                       .ramp_rpm_per_s = ramp_res.first.value(),
+                                       .dwell_ms = dwell_res.first.value(),
+                                       .repeats = 0,
+                                       .temperature = std::nullopt};
+        working = dwell_res.second;
+
+        constexpr auto r_pref = std::array{' ', 'R'};
+        auto after_pref = prefix_matches(working, limit, r_pref);
+        if (after_pref != working) {
+            auto repeats_res = parse_value<uint16_t>(after_pref, limit);
+            if (!repeats_res.first.has_value()) {
+                return std::make_pair(ParseResult(), input);
+            }
+            segment.repeats = repeats_res.first.value();
+            working = repeats_res.second;
+        }
+
+        constexpr auto h_pref = std::array{' ', 'H'};
+        after_pref = prefix_matches(working, limit, h_pref);
+        if (after_pref != working) {
+            auto temp_res = parse_value<float>(after_pref, limit);
+            if (!temp_res.first.has_value()) {
+                return std::make_pair(ParseResult(), input);
+            }
+            segment.temperature = temp_res.first.value();
+            working = temp_res.second;
+        }
+        return std::make_pair(ParseResult(segment), working);
+    }
+};
+
+struct RunShakeProgram {
+    /*
+    ** RunShakeProgram uses M3.S to run the segments added with M3.P, from
+    ** the first. The response is sent as the program starts. As each segment
+    ** starts, an unsolicited M3.S SEG:<index> line is sent, and once the last
+    ** segment's dwell is over the motor keeps its speed and M3.S DONE is
+    ** sent. M3, G28 or M3.C stop the program early.
+    ** Format: M3.S
+    */
+    using ParseResult = std::optional<RunShakeProgram>;
+    static constexpr auto prefix = std::array{'M', '3', '.', 'S'};
+    static constexpr const char* response = "M3.S OK\n";
+    static constexpr const char* done = "M3.S DONE\n";
+
+    template <typename InputIt, typename Limit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto working = prefix_matches(input, limit, prefix);
+        if (working == input) {
+            return std::make_pair(ParseResult(), input);
+        }
+        if (working != limit && !std::isspace(*working)) {
+            return std::make_pair(ParseResult(), input);
+        }
+        return std::make_pair(ParseResult(RunShakeProgram()), working);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    static auto write_response_into(InputIt buf, InputLimit limit) -> InputIt {
+        return write_string_to_iterpair(buf, limit, response);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    static auto write_segment_into(InputIt buf, InputLimit limit,
+                                   uint16_t index) -> InputIt {
+        auto res = snprintf(&*buf, (limit - buf), "M3.S SEG:%u\n",
+                            static_cast<unsigned int>(index));
+        if (res <= 0) {
+            return buf;
+        }
+        return buf + res;
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    static auto write_done_into(InputIt buf, InputLimit limit) -> InputIt {
+        return write_string_to_iterpair(buf, limit, done);
+    }
+};
+
+struct ClearShakeProgram {
+    /*
+    ** ClearShakeProgram uses M3.C to stop any running shake program and
+    ** remove its segments. The motor keeps whatever speed it had reached.
+    ** Format: M3.C
+    */
+    using ParseResult = std::optional<ClearShakeProgram>;
+    static constexpr auto prefix = std::array{'M', '3', '.', 'C'};
+    static constexpr const char* response = "M3.C OK\n";
+
+    template <typename InputIt, typename Limit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto working = prefix_matches(input, limit, prefix);
+        if (working == input) {
+            return std::make_pair(ParseResult(), input);
+        }
+        if (working != limit && !std::isspace(*working)) {
+            return std::make_pair(ParseResult(), input);
+        }
+        return std::make_pair(ParseResult(ClearShakeProgram()), working);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    static auto write_response_into(InputIt buf, InputLimit limit) -> InputIt {
+        return write_string_to_iterpair(buf, limit, response);
+    }
+};
+
+struct AddSkipBand {
+    /*
+    ** AddSkipBand uses M3.B to forbid the speeds strictly between L and H
+    ** rpm, merging the band with any it overlaps. Speeds inside a band are
+    ** refused, and changes of speed cross bands as fast as the motor can.
+    ** The table is kept in flash, so it only changes with the motor stopped.
+    ** Format: M3.B L<low rpm> H<high rpm>
+    ** Example: M3.B L500 H650
+    */
+    using ParseResult = std::optional<AddSkipBand>;
+    static constexpr auto prefix = std::array{'M', '3', '.', 'B', ' ', 'L'};
+    static constexpr const char* response = "M3.B OK\n";
+    int16_t low_rpm;
+    int16_t high_rpm;
+
+    template <typename InputIt, typename Limit>
+    requires std::contiguous_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto working = prefix_matches(input, limit, prefix);
+        if (working == input) {
+            return std::make_pair(ParseResult(), input);
+        }
+        auto low_res = parse_value<int16_t>(working, limit);
+        if (!low_res.first.has_value()) {
+            return std::make_pair(ParseResult(), input);
+        }
+        constexpr auto h_pref = std::array{' ', 'H'};
+        working = prefix_matches(low_res.second, limit, h_pref);
+        if (working == low_res.second) {
+            return std::make_pair(ParseResult(), input);
+        }
+        auto high_res = parse_value<int16_t>(working, limit);
+        if (!high_res.first.has_value()) {
+            return std::make_pair(ParseResult(), input);
+        }
+        return std::make_pair(
+            ParseResult(AddSkipBand{.low_rpm = low_res.first.value(),
+                                    .high_rpm = high_res.first.value()}),
+            high_res.second);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    static auto write_response_into(InputIt buf, InputLimit limit) -> InputIt {
+        return write_string_to_iterpair(buf, limit, response);
+    }
+};
+
+struct ClearSkipBands {
+    /*
+    ** ClearSkipBands uses M3.B C to remove every skip band, in flash too,
+    ** so the motor must be stopped.
+    ** Format: M3.B C
+    */
+    using ParseResult = std::optional<ClearSkipBands>;
+    static constexpr auto prefix = std::array{'M', '3', '.', 'B', ' ', 'C'};
+    static constexpr const char* response = "M3.B C OK\n";
+
+    template <typename InputIt, typename Limit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto working = prefix_matches(input, limit, prefix);
+        if (working == input) {
+            return std::make_pair(ParseResult(), input);
+        }
+        if (working != limit && !std::isspace(*working)) {
+            return std::make_pair(ParseResult(), input);
+        }
+        return std::make_pair(ParseResult(ClearSkipBands()), working);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    static auto write_response_into(InputIt buf, InputLimit limit) -> InputIt {
+        return write_string_to_iterpair(buf, limit, response);
+    }
+};
+
+struct GetSkipBands {
+    /*
+    ** GetSkipBands uses M3.B to list the skip bands in order of speed, as
+    ** low-high rpm. It must come after AddSkipBand and ClearSkipBands in
+    ** the parser since it shares their prefix.
+    ** Format: M3.B
+    ** Example: M3.B -> M3.B 500-650 1200-1310 OK\n
+    */
+    using ParseResult = std::optional<GetSkipBands>;
+    static constexpr auto prefix = std::array{'M', '3', '.', 'B'};
+
+    template <typename InputIt, typename Limit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto working = prefix_matches(input, limit, prefix);
+        if (working == input) {
+            return std::make_pair(ParseResult(), input);
+        }
+        if (working != limit && !std::isspace(*working)) {
+            return std::make_pair(ParseResult(), input);
+        }
+        return std::make_pair(ParseResult(GetSkipBands()), working);
+    }
+
+    template <typename InputIt, typename InputLimit, typename Bands>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    static auto write_response_into(InputIt buf, InputLimit limit,
+                                    const Bands& bands, size_t count)
+        -> InputIt {
+        auto written = write_string_to_iterpair(buf, limit, "M3.B ");
+        for (size_t i = 0; i < count; ++i) {
+            const auto& band = bands.at(i);
+            auto res = snprintf(&*written, (limit - written), "%d-%d ",
+                                static_cast<int>(band.low_rpm),
+                                static_cast<int>(band.high_rpm));
+            if (res <= 0) {
+                return written;
+            }
+            written += std::min(res, static_cast<int>(limit - written));
+        }
+        return write_string_to_iterpair(written, limit, "OK\n");
+    }
+};
+
+struct ArmMotorCapture {
+    /*
+    ** ArmMotorCapture uses M125.A to start recording the motor's speed,
+    ** speed setpoint, Iq current and bus voltage into a ring of samples, one
+    ** every P ms. The next speed change, shake program or homing, or an
+    ** M125.T, triggers the capture, which then stops once it has recorded N
+    ** more samples. M125 reads it back.
+    ** Format: M125.A P<period ms> N<samples after trigger>
+    ** Example: M125.A P2 N400
+    */
+    using ParseResult = std::optional<ArmMotorCapture>;
+    static constexpr auto prefix = std::array{'M', '1', '2', '5', '.',
+                                              'A', ' ', 'P'};
+    static constexpr const char* response = "M125.A OK\n";
+    uint16_t period_ms;
+    uint16_t post_trigger;
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    static auto write_response_into(InputIt buf, InputLimit limit) -> InputIt {
+        return write_string_to_iterpair(buf, limit, response);
+    }
+
+    template <typename InputIt, typename Limit>
+    requires std::contiguous_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto working = prefix_matches(input, limit, prefix);
+        if (working == input) {
+            return std::make_pair(ParseResult(), input);
+        }
+        auto period_res = parse_value<uint16_t>(working, limit);
+        if (!period_res.first.has_value()) {
+            return std::make_pair(ParseResult(), input);
+        }
+        constexpr auto n_pref = std::array{' ', 'N'};
+        working = prefix_matches(period_res.second, limit, n_pref);
+        if (working == period_res.second) {
+            return std::make_pair(ParseResult(), input);
+        }
+        auto post_res = parse_value<uint16_t>(working, limit);
+        if (!post_res.first.has_value()) {
+            return std::make_pair(ParseResult(), input);
+        }
+        return std::make_pair(
+            ParseResult(
+                ArmMotorCapture{.period_ms = period_res.first.value(),
+                                .post_trigger = post_res.first.value()}),
+            post_res.second);
+    }
+};
+
+struct TriggerMotorCapture {
+    /*
+    ** TriggerMotorCapture uses M125.T to trigger an armed motor capture
+    ** straight away.
+    ** Format: M125.T
+    */
+    using ParseResult = std::optional<TriggerMotorCapture>;
+    static constexpr auto prefix = std::array{'M', '1', '2', '5', '.', 'T'};
+    static constexpr const char* response = "M125.T OK\n";
+
+    template <typename InputIt, typename Limit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto working = prefix_matches(input, limit, prefix);
+        if (working == input) {
+            return std::make_pair(ParseResult(), input);
+        }
+        if (working != limit && !std::isspace(*working)) {
+            return std::make_pair(ParseResult(), input);
+        }
+        return std::make_pair(ParseResult(TriggerMotorCapture()), working);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    static auto write_response_into(InputIt buf, InputLimit limit) -> InputIt {
+        return write_string_to_iterpair(buf, limit, response);
+    }
+};
+
+struct GetMotorCapture {
+    /*
+    ** GetMotorCapture uses M125 to read back a motor capture a page at a
+    ** time, starting from sample I (0 if left out). The response has the
+    ** capture's state (IDLE, ARMED, TRIGGERED or DONE), its sample period,
+    ** how many samples it holds and how many of them came before the
+    ** trigger, then the page of samples as
+    ** rpm,setpoint rpm,Iq,bus mV. Samples are only sent once it is DONE.
+    ** Format: M125 [I<first sample>]
+    ** Example: M125 I8 ->
+    ** M125 S:DONE P:2 N:512 T:112 I:8 D:998,1000,1204,23950 ... OK\n
+    */
+    using ParseResult = std::optional<GetMotorCapture>;
+    static constexpr auto prefix = std::array{'M', '1', '2', '5'};
+    uint16_t start;
+
+    template <typename InputIt, typename Limit>
+    requires std::contiguous_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto working = prefix_matches(input, limit, prefix);
+        if (working == input) {
+            return std::make_pair(ParseResult(), input);
+        }
+        if (working != limit && !std::isspace(*working)) {
+            return std::make_pair(ParseResult(), input);
+        }
+        constexpr auto i_pref = std::array{' ', 'I'};
+        auto after_pref = prefix_matches(working, limit, i_pref);
+        if (after_pref == working) {
+            return std::make_pair(ParseResult(GetMotorCapture{.start = 0}),
+                                  working);
+        }
+        auto start_res = parse_value<uint16_t>(after_pref, limit);
+        if (!start_res.first.has_value()) {
+            return std::make_pair(ParseResult(), input);
+        }
+        return std::make_pair(
+            ParseResult(GetMotorCapture{.start = start_res.first.value()}),
+            start_res.second);
+    }
+
+    template <typename InputIt, typename InputLimit, typename Samples>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    static auto write_response_into(InputIt buf, InputLimit limit,
+                                    motor_telemetry::Status status,
+                                    uint16_t period_ticks, uint16_t count,
+                                    uint16_t trigger_index, uint16_t start,
+                                    const Samples& samples, size_t sample_count)
+        -> InputIt {
+        static constexpr std::array<const char*, 4> status_names = {
+            "IDLE", "ARMED", "TRIGGERED", "DONE"};
+        auto res = snprintf(&*buf, (limit - buf),
+                            "M125 S:%s P:%u N:%u T:%u I:%u D:",
+                            status_names.at(static_cast<size_t>(status)),
+                            static_cast<unsigned int>(period_ticks),
+                            static_cast<unsigned int>(count),
+                            static_cast<unsigned int>(trigger_index),
+                            static_cast<unsigned int>(start));
+        if (res <= 0) {
+            return buf;
+        }
+        auto written = buf + std::min(res, static_cast<int>(limit - buf));
+        for (size_t i = 0; i < sample_count; ++i) {
+            const auto& sample = samples.at(i);
+            res = snprintf(&*written, (limit - written), "%d,%d,%d,%u ",
+                           static_cast<int>(sample.rpm),
+                           static_cast<int>(sample.setpoint_rpm),
+                           static_cast<int>(sample.iq),
+                           static_cast<unsigned int>(sample.bus_mv));
+            if (res <= 0) {
+                return written;
+            }
+            written += std::min(res, static_cast<int>(limit - written));
+        }
+        return write_string_to_iterpair(written, limit, "OK\n");
+    }
+};
+
 struct GetTemperatureDebug {
     /**
      * GetTemperatureDebug uses M105.D arbitrarily. It responds with
@@ -303,6 +834,173 @@ struct GetTemperatureDebug {
     }
 };
 
+struct GetLoopTimingDebug {
+    /**
+     * GetLoopTimingDebug uses M123.D. It reports how long the motor
+     * controller's loops take, in CPU cycles, since boot or the last reset:
+     * the FOC current loop in the ADC interrupt (H) and the control task's
+     * pass through the speed loop and safety checks (M). The control task
+     * pass includes any FOC interrupts that land during it. R resets the
+     * statistics once they have been read.
+     *
+     * Format: M123.D [R]
+     *
+     * For each loop, prefixed with H or M:
+     * - Passes timed (N)
+     * - Minimum, maximum and mean pass (MIN, MAX, AVG)
+     * - The loop's period, and passes that ran past it (P, OV)
+     * - The mean pass as a percentage of the period (LD)
+     * */
+    using ParseResult = std::optional<GetLoopTimingDebug>;
+    static constexpr auto prefix = std::array{'M', '1', '2', '3', '.', 'D'};
+
+    bool reset;
+
+    template <typename InputIt, typename InLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputIt, InLimit>
+    static auto write_response_into(InputIt buf, InLimit limit,
+                                    const loop_timing::MotorLoopTiming& timing)
+        -> InputIt {
+        const auto& hf = timing.high_frequency;
+        const auto& mf = timing.medium_frequency;
+        auto res = snprintf(
+            &*buf, (limit - buf),
+            "M123.D HN:%lu HMIN:%lu HMAX:%lu HAVG:%lu HP:%lu HOV:%lu "
+            "HLD:%0.2f MN:%lu MMIN:%lu MMAX:%lu MAVG:%lu MP:%lu MOV:%lu "
+            "MLD:%0.2f OK\n",
+            static_cast<unsigned long>(hf.samples),
+            static_cast<unsigned long>(hf.min_cycles),
+            static_cast<unsigned long>(hf.max_cycles),
+            static_cast<unsigned long>(hf.mean_cycles),
+            static_cast<unsigned long>(hf.period_cycles),
+            static_cast<unsigned long>(hf.overruns),
+            static_cast<float>(loop_timing::load_percent(hf)),
+            static_cast<unsigned long>(mf.samples),
+            static_cast<unsigned long>(mf.min_cycles),
+            static_cast<unsigned long>(mf.max_cycles),
+            static_cast<unsigned long>(mf.mean_cycles),
+            static_cast<unsigned long>(mf.period_cycles),
+            static_cast<unsigned long>(mf.overruns),
+            static_cast<float>(loop_timing::load_percent(mf)));
+        if (res <= 0) {
+            return buf;
+        }
+        return buf + std::min(res, static_cast<int>(limit - buf));
+    }
+
+    template <typename InputIt, typename Limit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto working = prefix_matches(input, limit, prefix);
+        if (working == input) {
+            return std::make_pair(ParseResult(), input);
+        }
+        constexpr auto reset_pref = std::array{' ', 'R'};
+        auto after_reset = prefix_matches(working, limit, reset_pref);
+        if (after_reset != working) {
+            return std::make_pair(
+                ParseResult(GetLoopTimingDebug{.reset = true}), after_reset);
+        }
+        return std::make_pair(ParseResult(GetLoopTimingDebug{.reset = false}),
+                              working);
+    }
+};
+
+struct GetThermistorStats {
+    /**
+     * GetThermistorStats uses M105.S. It reports the health statistics kept
+     * for one thermistor: 0 is pad A, 1 is pad B and 2 is the board.
+     *
+     * Format: M105.S <thermistor> [W<readings>]
+     *
+     * W covers just that many of the most recent readings, from 1 up to
+     * the max_window that are kept (the default), e.g. to catch a brief
+     * glitch that the full window would average away. The drift is always
+     * of the full window.
+     *
+     * - The thermistor (T)
+     * - Valid readings in the statistics window (N)
+     * - Minimum, maximum and mean temperature in the window (MIN, MAX, AVG)
+     * - Variance of the temperature in the window, in C^2 (VAR)
+     * - Invalid conversions among the last window's worth (INV)
+     * - Conversions since boot, and how many of them were invalid (TOT, TINV)
+     * - Drift of the window mean since the first full window after boot (DR)
+     * */
+    using ParseResult = std::optional<GetThermistorStats>;
+    static constexpr auto prefix =
+        std::array{'M', '1', '0', '5', '.', 'S', ' '};
+    static constexpr auto prefix_window = std::array{' ', 'W'};
+    static constexpr uint8_t thermistor_count = 3;
+    // Readings kept for each thermistor
+    static constexpr uint32_t max_window = 64;
+
+    uint8_t thermistor;
+    uint32_t window = max_window;
+
+    template <typename InputIt, typename InLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputIt, InLimit>
+    static auto write_response_into(InputIt buf, InLimit limit,
+                                    uint8_t thermistor, uint32_t count,
+                                    double min, double max, double mean,
+                                    double variance, uint32_t invalid,
+                                    uint32_t total, uint32_t total_invalid,
+                                    double drift) -> InputIt {
+        auto res = snprintf(
+            &*buf, (limit - buf),
+            "M105.S T:%u N:%lu MIN:%0.2f MAX:%0.2f AVG:%0.3f VAR:%0.5f "
+            "INV:%lu TOT:%lu TINV:%lu DR:%0.3f OK\n",
+            static_cast<unsigned int>(thermistor),
+            static_cast<unsigned long>(count), static_cast<float>(min),
+            static_cast<float>(max), static_cast<float>(mean),
+            static_cast<float>(variance), static_cast<unsigned long>(invalid),
+            static_cast<unsigned long>(total),
+            static_cast<unsigned long>(total_invalid),
+            static_cast<float>(drift));
+        if (res <= 0) {
+            return buf;
+        }
+        return buf + res;
+    }
+    template <typename InputIt, typename Limit>
+    requires std::contiguous_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto working = prefix_matches(input, limit, prefix);
+        if (working == input) {
+            return std::make_pair(ParseResult(), input);
+        }
+        auto value_res = parse_value<uint8_t>(working, limit);
+        if (!value_res.first.has_value() ||
+            (value_res.first.value() >= thermistor_count)) {
+            return std::make_pair(ParseResult(), input);
+        }
+        auto working_window = prefix_matches(value_res.second, limit,
+                                             prefix_window);
+        if (working_window == value_res.second) {
+            return std::make_pair(
+                ParseResult(GetThermistorStats{
+                    .thermistor = value_res.first.value()}),
+                value_res.second);
+        }
+        auto window_res = parse_value<uint32_t>(working_window, limit);
+        if (!window_res.first.has_value() ||
+            (window_res.first.value() == 0) ||
+            (window_res.first.value() > max_window)) {
+            return std::make_pair(ParseResult(), input);
+        }
+        return std::make_pair(
+            ParseResult(
+                GetThermistorStats{.thermistor = value_res.first.value(),
+                                   .window = window_res.first.value()}),
+            window_res.second);
+    }
+};
+
 struct Home {
     /**
      * Home uses G28
@@ -519,6 +1217,48 @@ struct SetHeaterPowerTest {
     }
 };
 
+struct SetPowerSupply {
+    /*
+    ** Set Power Supply uses a random gcode, M998, next to the other setup
+    ** gcodes. It sets the power in watts the supply can share between the
+    ** motor and the heater; the motor is served first and the heater is held
+    ** to what is left. A figure at or above what both draw at full power
+    ** removes the limit, which is also what the module starts up with. The
+    ** figure is not saved.
+    ** Format: M998 S<watts>
+    ** Example: M998 S100 limits the motor and heater to 100W between them
+    */
+    double watts;
+    using ParseResult = std::optional<SetPowerSupply>;
+    static constexpr auto prefix = std::array{'M', '9', '9', '8', ' ', 'S'};
+    static constexpr const char* response = "M998 OK\n";
+
+    template <typename InputIt, typename InLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputIt, InLimit>
+    static auto write_response_into(InputIt buf, InLimit limit) -> InputIt {
+        return write_string_to_iterpair(buf, limit, response);
+    }
+    template <typename InputIt, typename Limit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto working = prefix_matches(input, limit, prefix);
+        if (working == input) {
+            return std::make_pair(ParseResult(), input);
+        }
+
+        auto watts = parse_value<float>(working, limit);
+        if (!watts.first.has_value() || (watts.first.value() < 0)) {
+            return std::make_pair(ParseResult(), input);
+        }
+        return std::make_pair(
+            ParseResult(SetPowerSupply{.watts = watts.first.value()}),
+            watts.second);
+    }
+};
+
 struct EnterBootloader {
     /**
      * EnterBootloader uses the command string "dfu" instead of a gcode to be
@@ -1011,4 +1751,59 @@ struct GetPlateLockStateDebug {
     }
 };
 
+struct StartAutotune {
+    /*
+    ** StartAutotune uses M303, like Marlin's PID autotune. It runs a
+    ** relay-feedback autotune of the heater around the given temperature and
+    ** applies the resulting constants. The response is only sent once tuning
+    ** is finished, which may take several minutes.
+    ** Format: M303 S<temp>
+    ** Example: M303 S70 tunes the heater around 70C
+    ** Returns the new constants: M303 P:<kp> I:<ki> D:<kd> OK
+    */
+    using ParseResult = std::optional<StartAutotune>;
+    static constexpr auto prefix = std::array{'M', '3', '0', '3', ' ', 'S'};
+    double temperature;
+
+    template <typename InputIt, typename InLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputIt, InLimit>
+    static auto write_response_into(InputIt buf, InLimit limit, double kp,
+                                    double ki, double kd) -> InputIt {
+        auto res = snprintf(&*buf, (limit - buf),
+                            "M303 P:%0.4f I:%0.4f D:%0.4f OK\n",
+                            static_cast<float>(kp), static_cast<float>(ki),
+                            static_cast<float>(kd));
+        if (res <= 0) {
+            return buf;
+        }
+        return buf + res;
+    }
+
+    template <typename InputIt, typename Limit>
+    requires std::contiguous_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto working = prefix_matches(input, limit, prefix);
+        if (working == input) {
+            return std::make_pair(ParseResult(), input);
+        }
+
+        auto value_res = parse_value<float>(working, limit);
+
+        if (!value_res.first.has_value()) {
+            return std::make_pair(ParseResult(), input);
+        }
+
+        if (value_res.first.value() <= 0) {
+            return std::make_pair(ParseResult(), input);
+        }
+
+        return std::make_pair(
+            ParseResult(StartAutotune{.temperature = value_res.first.value()}),
+            value_res.second);
+    }
+};
+
 }  // namespace gcode
@@ -4,15 +4,22 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
 #include <concepts>
 #include <cstddef>
+#include <optional>
 #include <variant>
 
 #include "core/pid.hpp"
+#include "core/relay_autotune.hpp"
+#include "core/thermal_fault_monitor.hpp"
 #include "core/thermistor_conversion.hpp"
+#include "core/thermistor_stats.hpp"
 #include "hal/message_queue.hpp"
 #include "heater-shaker/errors.hpp"
+#include "heater-shaker/gcodes.hpp"
 #include "heater-shaker/messages.hpp"
+#include "heater-shaker/power_budget.hpp"
 #include "heater-shaker/tasks.hpp"
 #include "thermistor_lookups.hpp"
 
@@ -48,6 +55,7 @@ struct State {
         ERROR,
         CONTROLLING,
         POWER_TEST,
+        AUTOTUNING,
     };
     Status system_status;
     uint8_t error_bitmap;
@@ -58,8 +66,15 @@ struct State {
     static constexpr uint8_t BOARD_SENSE_ERROR = (1 << 2);
     static constexpr uint8_t SENSE_ERROR = PAD_SENSE_ERROR | BOARD_SENSE_ERROR;
     static constexpr uint8_t POWER_GOOD_ERROR = (1 << 3);
+    static constexpr uint8_t THERMAL_FAULT_ERROR = (1 << 4);
 };
 
+// Thermistor health statistics are kept over this many conversions (6.4s)
+static constexpr size_t THERMISTOR_STATS_WINDOW = 64;
+static_assert(gcode::GetThermistorStats::max_window ==
+                  THERMISTOR_STATS_WINDOW,
+              "M105.S should be able to ask for every reading kept");
+
 struct TemperatureSensor {
     // The last converted temperature (0 if it was not valid)
     double temp_c = 0;
@@ -67,6 +82,9 @@ struct TemperatureSensor {
     uint16_t last_adc = 0;
     // The current error
     errors::ErrorCode error = errors::ErrorCode::NO_ERROR;
+    // Health statistics over recent conversions
+    ThermistorStats<THERMISTOR_STATS_WINDOW> stats =
+        ThermistorStats<THERMISTOR_STATS_WINDOW>();
     // These static values should be set when this struct is constructed to
     // provide errors specific to a sensor
     const errors::ErrorCode disconnected_error;
@@ -103,9 +121,22 @@ class HeaterTask {
     static constexpr double KI_MAX = 200;
     static constexpr double KD_MIN = -200;
     static constexpr double KD_MAX = 200;
+    static constexpr double AUTOTUNE_HYSTERESIS_C = 0.5;
     // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
     static constexpr double CONTROL_PERIOD_S =
         static_cast<uint32_t>(CONTROL_PERIOD_TICKS) * 0.001;
+    // While heating at half power or more from further than the band below
+    // the setpoint, the pad must warm up by the minimum response within a
+    // window; with the heater off, it may not climb more than the max rise
+    static constexpr ThermalFaultMonitor::Limits FAULT_LIMITS{
+        .window_s = 30.0,
+        .drive_threshold = 0.5,
+        .target_band_c = 5.0,
+        .min_response_c = 2.0,
+        .max_undriven_rise_c = 3.0};
+    // Both pad thermistors sit on the same plate and shouldn't read further
+    // apart than this while controlling
+    static constexpr double PAD_MISMATCH_LIMIT_C = 10.0;
     explicit HeaterTask(Queue& q)
         : message_queue(q),
           task_registry(nullptr),
@@ -143,7 +174,11 @@ class HeaterTask {
               .error_bit = State::BOARD_SENSE_ERROR},
           state{.system_status = State::IDLE, .error_bitmap = 0},
           pid(DEFAULT_KP, DEFAULT_KI, DEFAULT_KD, CONTROL_PERIOD_S, 1.0, -1.0),
-          setpoint(0) {}
+          setpoint(0),
+          autotune(std::nullopt),
+          autotune_id(0),
+          fault_monitor(FAULT_LIMITS, CONTROL_PERIOD_S),
+          fault_error(errors::ErrorCode::NO_ERROR) {}
     HeaterTask(const HeaterTask& other) = delete;
     auto operator=(const HeaterTask& other) -> HeaterTask& = delete;
     HeaterTask(HeaterTask&& other) noexcept = delete;
@@ -218,6 +253,7 @@ class HeaterTask {
         // While in error state, we will refuse to set temperatures
         // But we can try and disarm the latch if that's the only problem
         try_latch_disarm(policy);
+        cancel_autotune();
         auto response =
             messages::AcknowledgePrevious{.responding_to_id = msg.id};
         if (state.system_status == State::ERROR) {
@@ -226,12 +262,20 @@ class HeaterTask {
         } else {
             setpoint = msg.target_temperature;
             pid.arm_integrator_reset(setpoint - pad_temperature());
+            if (state.system_status != State::CONTROLLING) {
+                fault_monitor.reset();
+                controlled_power = 0;
+            }
             state.system_status = State::CONTROLLING;
         }
         if (msg.from_system) {
             static_cast<void>(
                 task_registry->system->get_message_queue().try_send(
                     messages::SystemMessage(response)));
+        } else if (msg.from_motor) {
+            static_cast<void>(
+                task_registry->motor->get_message_queue().try_send(
+                    messages::MotorMessage(response)));
         } else {
             static_cast<void>(
                 task_registry->comms->get_message_queue().try_send(
@@ -274,6 +318,30 @@ class HeaterTask {
             messages::HostCommsMessage(response)));
     }
 
+    template <typename Policy>
+    requires HeaterExecutionPolicy<Policy>
+    auto visit_message(const messages::GetThermistorStatsMessage& msg,
+                       Policy& policy) -> void {
+        static_cast<void>(policy);
+        // Numbered as M105.S does: pad A, pad B, board
+        const auto sensors = std::array{&pad_a, &pad_b, &board};
+        const auto& stats = sensors.at(msg.thermistor)->stats;
+        auto response = messages::GetThermistorStatsResponse{
+            .responding_to_id = msg.id,
+            .thermistor = msg.thermistor,
+            .count = static_cast<uint32_t>(stats.count(msg.window)),
+            .min = stats.min(msg.window),
+            .max = stats.max(msg.window),
+            .mean = stats.mean(msg.window),
+            .variance = stats.variance(msg.window),
+            .invalid = static_cast<uint32_t>(stats.invalid(msg.window)),
+            .total = stats.total(),
+            .total_invalid = stats.total_invalid(),
+            .drift = stats.drift()};
+        static_cast<void>(task_registry->comms->get_message_queue().try_send(
+            messages::HostCommsMessage(response)));
+    }
+
     template <typename Policy>
     requires HeaterExecutionPolicy<Policy>
     auto visit_message(const messages::SetPIDConstantsMessage& msg,
@@ -285,6 +353,8 @@ class HeaterTask {
             response.with_error =
                 errors::ErrorCode::HEATER_CONSTANT_OUT_OF_RANGE;
         } else {
+            // A tune would replace these constants once it finished
+            cancel_autotune();
             policy.disable_power_output();
             pid = PID(msg.kp, msg.ki, msg.kd, CONTROL_PERIOD_S, 1.0, -1.0);
         }
@@ -346,19 +416,51 @@ class HeaterTask {
             state.system_status = State::ERROR;
             setpoint = 0;
         }
+        if ((state.system_status == State::ERROR) && autotune.has_value()) {
+            finish_autotune(most_relevant_error());
+        }
+        if (state.system_status == State::CONTROLLING) {
+            check_thermal_fault();
+        }
         // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
         if (state.system_status == State::CONTROLLING) {
-            policy.set_power_output(pid.compute(setpoint - pad_temperature()));
+            // The integrator is held to what the supply can actually deliver
+            // so it doesn't wind up while the motor is using the rest
+            auto ceiling = task_registry->power_budget.ceiling(power::HEATER);
+            pid.set_windup_limits(ceiling, pid.windup_limit_low());
+            auto power = std::clamp(pid.compute(setpoint - pad_temperature()),
+                                    0.0, ceiling);
+            policy.set_power_output(power);
+            task_registry->power_budget.set_demand(power::HEATER, power);
+            controlled_power = power;
+        } else if (state.system_status == State::AUTOTUNING) {
+            update_autotune(policy);
         } else if (state.system_status != State::POWER_TEST) {
             policy.disable_power_output();
+            task_registry->power_budget.set_demand(power::HEATER, 0.0);
         }
     }
 
+    /**
+     * The heater is the budget's last consumer, so it owns the supply figure;
+     * the new ceiling takes effect from the next control period.
+     */
+    template <typename Policy>
+    requires HeaterExecutionPolicy<Policy>
+    auto visit_message(const messages::SetPowerSupplyMessage& msg,
+                       Policy& policy) -> void {
+        static_cast<void>(policy);
+        task_registry->power_budget.set_supply(msg.watts);
+        static_cast<void>(task_registry->comms->get_message_queue().try_send(
+            messages::AcknowledgePrevious{.responding_to_id = msg.id}));
+    }
+
     template <typename Policy>
     requires HeaterExecutionPolicy<Policy>
     auto visit_message(const messages::SetPowerTestMessage& msg, Policy& policy)
         -> void {
         try_latch_disarm(policy);
+        cancel_autotune();
         auto response =
             messages::AcknowledgePrevious{.responding_to_id = msg.id};
         if (state.system_status == State::ERROR) {
@@ -370,6 +472,7 @@ class HeaterTask {
             } else {
                 policy.set_power_output(power);
             }
+            task_registry->power_budget.set_demand(power::HEATER, power);
             setpoint = power;
             state.system_status = State::POWER_TEST;
         }
@@ -377,6 +480,79 @@ class HeaterTask {
             task_registry->comms->get_message_queue().try_send(response));
     }
 
+    template <typename Policy>
+    requires HeaterExecutionPolicy<Policy>
+    auto visit_message(const messages::StartAutotuneMessage& msg,
+                       Policy& policy) -> void {
+        try_latch_disarm(policy);
+        cancel_autotune();
+        if (state.system_status == State::ERROR) {
+            auto response = messages::AutotuneResultResponse{
+                .responding_to_id = msg.id,
+                .with_error = most_relevant_error()};
+            static_cast<void>(
+                task_registry->comms->get_message_queue().try_send(response));
+            return;
+        }
+        // The response is held until the tune finishes
+        policy.disable_power_output();
+        autotune.emplace(msg.setpoint, 1.0, 0.0, AUTOTUNE_HYSTERESIS_C,
+                         CONTROL_PERIOD_S);
+        autotune_id = msg.id;
+        setpoint = msg.setpoint;
+        state.system_status = State::AUTOTUNING;
+    }
+
+    template <typename Policy>
+    requires HeaterExecutionPolicy<Policy>
+    auto update_autotune(Policy& policy) -> void {
+        auto power = autotune->update(pad_temperature());
+        task_registry->power_budget.set_demand(power::HEATER, power);
+        if (autotune->status() == RelayAutotune::Status::RUNNING) {
+            if (power == 0.0) {
+                policy.disable_power_output();
+            } else {
+                policy.set_power_output(power);
+            }
+            return;
+        }
+        policy.disable_power_output();
+        setpoint = 0;
+        state.system_status = State::IDLE;
+        auto error = errors::ErrorCode::HEATER_AUTOTUNE_FAILED;
+        if (autotune->status() == RelayAutotune::Status::DONE &&
+            (autotune->kp() <= KP_MAX) && (autotune->ki() <= KI_MAX) &&
+            (autotune->kd() <= KD_MAX)) {
+            pid = PID(autotune->kp(), autotune->ki(), autotune->kd(),
+                      CONTROL_PERIOD_S, 1.0, -1.0);
+            error = errors::ErrorCode::NO_ERROR;
+        }
+        finish_autotune(error);
+    }
+
+    // Any other command that sets the heater output ends a tune in progress
+    auto cancel_autotune() -> void {
+        if (autotune.has_value()) {
+            finish_autotune(errors::ErrorCode::HEATER_AUTOTUNE_FAILED);
+            if (state.system_status == State::AUTOTUNING) {
+                setpoint = 0;
+                state.system_status = State::IDLE;
+            }
+        }
+    }
+
+    auto finish_autotune(errors::ErrorCode error) -> void {
+        auto response =
+            messages::AutotuneResultResponse{.responding_to_id = autotune_id,
+                                             .kp = autotune->kp(),
+                                             .ki = autotune->ki(),
+                                             .kd = autotune->kd(),
+                                             .with_error = error};
+        autotune.reset();
+        static_cast<void>(task_registry->comms->get_message_queue().try_send(
+            messages::HostCommsMessage(response)));
+    }
+
     template <typename Policy>
     requires HeaterExecutionPolicy<Policy>
     auto try_latch_disarm(Policy& policy) -> void {
@@ -384,7 +560,11 @@ class HeaterTask {
             ((state.error_bitmap & State::PAD_SENSE_ERROR) == 0)) {
             if (policy.try_reset_power_good()) {
                 state.error_bitmap &= ~State::POWER_GOOD_ERROR;
-                state.system_status = State::IDLE;
+                // A thermal fault stays latched even if the hardware
+                // latch clears
+                if ((state.error_bitmap & State::THERMAL_FAULT_ERROR) == 0) {
+                    state.system_status = State::IDLE;
+                }
             } else {
                 state.error_bitmap |= State::POWER_GOOD_ERROR;
                 state.system_status = State::ERROR;
@@ -392,6 +572,34 @@ class HeaterTask {
         }
     }
 
+    /**
+     * Compares the power applied over the last control period against how
+     * the pad temperature moved, and checks that both pad thermistors still
+     * agree. A fault turns the heater off and latches until restart; unlike
+     * the hardware latch it can't be disarmed by a new setpoint.
+     */
+    auto check_thermal_fault() -> void {
+        auto fault =
+            fault_monitor.update(pad_temperature(), setpoint, controlled_power);
+        if (fault == ThermalFaultMonitor::Fault::RUNAWAY) {
+            fault_error = errors::ErrorCode::HEATER_THERMAL_RUNAWAY;
+        } else if (fault == ThermalFaultMonitor::Fault::NO_RESPONSE) {
+            fault_error = errors::ErrorCode::HEATER_NO_RESPONSE;
+        } else if (!ThermalFaultMonitor::pair_plausible(
+                       pad_a.temp_c, pad_b.temp_c, PAD_MISMATCH_LIMIT_C)) {
+            fault_error = errors::ErrorCode::HEATER_THERMISTOR_MISMATCH;
+        } else {
+            return;
+        }
+        state.error_bitmap |= State::THERMAL_FAULT_ERROR;
+        state.system_status = State::ERROR;
+        setpoint = 0;
+        auto error_message = messages::HostCommsMessage(
+            messages::ErrorMessage{.code = fault_error});
+        static_cast<void>(
+            task_registry->comms->get_message_queue().try_send(error_message));
+    }
+
     auto handle_temperature_conversion(uint16_t conversion_result,
                                        TemperatureSensor& sensor) {
         auto visitor = [this, &sensor](auto val) {
@@ -426,6 +634,7 @@ class HeaterTask {
                 sensor.error = sensor.disconnected_error;
             }
         }
+        sensor.stats.add_invalid();
     }
 
     auto visit_conversion(double value, TemperatureSensor& sensor) -> void {
@@ -435,6 +644,7 @@ class HeaterTask {
             sensor.error = errors::ErrorCode::NO_ERROR;
         }
         sensor.temp_c = value;
+        sensor.stats.add(value);
     }
 
     [[nodiscard]] auto most_relevant_error() const -> errors::ErrorCode {
@@ -455,6 +665,10 @@ class HeaterTask {
             }
         }
 
+        if ((state.error_bitmap & State::THERMAL_FAULT_ERROR) != 0) {
+            return fault_error;
+        }
+
         // Return the heater pad error if everything is ok but the error latch
         // is set, which signifies that the latch circuit is broken
         if ((state.error_bitmap & State::POWER_GOOD_ERROR) != 0) {
@@ -476,6 +690,12 @@ class HeaterTask {
     State state;
     PID pid;
     double setpoint;
+    std::optional<RelayAutotune> autotune;
+    uint32_t autotune_id;
+    ThermalFaultMonitor fault_monitor;
+    errors::ErrorCode fault_error;
+    // The output the control loop applied last period
+    double controlled_power = 0;
     bool hot_LED_set = false;
 };
 
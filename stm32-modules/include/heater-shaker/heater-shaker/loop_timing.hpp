@@ -0,0 +1,99 @@
+/*
+ * Execution time statistics for the motor controller's periodic loops, in
+ * CPU cycles. Whatever runs a loop times each pass and records it here. A
+ * pass that runs past the loop's period is an overrun, and the mean pass
+ * as a share of the period is how much of the CPU the loop takes, which is
+ * what's left over for everything else.
+ */
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+namespace loop_timing {
+
+struct Summary {
+    uint32_t period_cycles;
+    uint32_t samples;
+    uint32_t min_cycles;
+    uint32_t max_cycles;
+    uint32_t mean_cycles;
+    uint32_t overruns;
+};
+
+class LoopStats {
+  public:
+    explicit LoopStats(uint32_t period_cycles)
+        : _period_cycles(period_cycles) {}
+
+    auto record(uint32_t cycles) -> void {
+        // Stop counting rather than wrap so the mean stays right
+        if (_samples == std::numeric_limits<uint32_t>::max()) {
+            return;
+        }
+        ++_samples;
+        _total_cycles += cycles;
+        if (cycles < _min_cycles) {
+            _min_cycles = cycles;
+        }
+        if (cycles > _max_cycles) {
+            _max_cycles = cycles;
+        }
+        if (cycles > _period_cycles) {
+            ++_overruns;
+        }
+    }
+
+    [[nodiscard]] auto summary() const -> Summary {
+        if (_samples == 0) {
+            return Summary{.period_cycles = _period_cycles,
+                           .samples = 0,
+                           .min_cycles = 0,
+                           .max_cycles = 0,
+                           .mean_cycles = 0,
+                           .overruns = 0};
+        }
+        return Summary{
+            .period_cycles = _period_cycles,
+            .samples = _samples,
+            .min_cycles = _min_cycles,
+            .max_cycles = _max_cycles,
+            .mean_cycles = static_cast<uint32_t>(_total_cycles / _samples),
+            .overruns = _overruns};
+    }
+
+    auto reset() -> void {
+        _samples = 0;
+        _total_cycles = 0;
+        _min_cycles = std::numeric_limits<uint32_t>::max();
+        _max_cycles = 0;
+        _overruns = 0;
+    }
+
+  private:
+    uint32_t _period_cycles;
+    uint32_t _samples = 0;
+    uint64_t _total_cycles = 0;
+    uint32_t _min_cycles = std::numeric_limits<uint32_t>::max();
+    uint32_t _max_cycles = 0;
+    uint32_t _overruns = 0;
+};
+
+/** The mean pass as a percentage of the loop's period.*/
+inline auto load_percent(const Summary& summary) -> double {
+    if (summary.period_cycles == 0) {
+        return 0;
+    }
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
+    return static_cast<double>(summary.mean_cycles) * 100.0 /
+           static_cast<double>(summary.period_cycles);
+}
+
+// The FOC current loop, run from the ADC interrupt every PWM period, and
+// the control task's pass through the speed loop and safety checks
+struct MotorLoopTiming {
+    Summary high_frequency;
+    Summary medium_frequency;
+};
+
+}  // namespace loop_timing
@@ -2,9 +2,14 @@
 #include <array>
 #include <concepts>
 #include <cstdint>
+#include <limits>
 #include <variant>
 
 #include "heater-shaker/errors.hpp"
+#include "heater-shaker/loop_timing.hpp"
+#include "heater-shaker/motor_telemetry.hpp"
+#include "heater-shaker/shake_program.hpp"
+#include "heater-shaker/skip_bands.hpp"
 #include "systemwide.h"
 
 namespace messages {
@@ -37,7 +42,7 @@ concept Response = requires(ResponseType rt) {
 */
 // The from_system elements are a bit of a hack because we don't have full
 // message source tracking and it seems weird to add it for literally two
-// messages.
+// messages. from_motor is the same for setpoints from a shake program.
 struct SetRPMMessage {
     uint32_t id;
     int16_t target_rpm;
@@ -48,6 +53,7 @@ struct SetTemperatureMessage {
     uint32_t id;
     double target_temperature;
     bool from_system = false;
+    bool from_motor = false;
 };
 
 struct GetTemperatureMessage {
@@ -58,6 +64,14 @@ struct GetTemperatureDebugMessage {
     uint32_t id;
 };
 
+struct GetThermistorStatsMessage {
+    uint32_t id;
+    uint8_t thermistor;
+    // How many of the most recent readings to cover; all that are kept if
+    // there are fewer
+    uint32_t window = std::numeric_limits<uint32_t>::max();
+};
+
 struct GetRPMMessage {
     uint32_t id;
 };
@@ -71,6 +85,69 @@ struct SetAccelerationMessage {
     int32_t rpm_per_s;
 };
 
+struct SetPowerSupplyMessage {
+    uint32_t id;
+    double watts;
+};
+
+struct SetJerkMessage {
+    uint32_t id;
+    int32_t rpm_per_s2;
+};
+
+struct SpeedProfileStepMessage {};
+
+struct AddShakeSegmentMessage {
+    uint32_t id;
+    shake_program::Segment segment;
+};
+
+struct RunShakeProgramMessage {
+    uint32_t id;
+};
+
+struct ClearShakeProgramMessage {
+    uint32_t id;
+};
+
+struct ShakeProgramStepMessage {
+    // The run of the program the wakeup was armed for
+    uint32_t generation = 0;
+};
+
+struct ArmMotorCaptureMessage {
+    uint32_t id;
+    uint16_t period_ticks;
+    uint16_t post_trigger;
+};
+
+struct TriggerMotorCaptureMessage {
+    uint32_t id;
+};
+
+struct GetMotorCaptureMessage {
+    uint32_t id;
+    uint16_t start;
+};
+
+struct GetLoopTimingMessage {
+    uint32_t id;
+    bool reset;
+};
+
+struct AddSkipBandMessage {
+    uint32_t id;
+    skip_bands::Band band;
+};
+
+struct ClearSkipBandsMessage {
+    uint32_t id;
+};
+
+struct GetSkipBandsMessage {
+    uint32_t id;
+};
+
 struct TemperatureConversionComplete {
     uint16_t pad_a;
     uint16_t pad_b;
@@ -89,6 +166,19 @@ struct SetPIDConstantsMessage {
     double kd;
 };
 
+struct StartAutotuneMessage {
+    uint32_t id;
+    double setpoint;
+};
+
+struct AutotuneResultResponse {
+    uint32_t responding_to_id;
+    double kp;
+    double ki;
+    double kd;
+    errors::ErrorCode with_error = errors::ErrorCode::NO_ERROR;
+};
+
 struct SetPowerTestMessage {
     uint32_t id;
     double power;
@@ -179,6 +269,8 @@ struct CheckPlateLockStatusMessage {
     errors::ErrorCode with_error = errors::ErrorCode::NO_ERROR;
 };
 
+struct PlateLockTimeoutMessage {};
+
 /*
 ** Response structs either confirm actions or fulfill actions. Because some
 *messages
@@ -207,6 +299,20 @@ struct GetTemperatureDebugResponse {
     bool power_good;
 };
 
+struct GetThermistorStatsResponse {
+    uint32_t responding_to_id;
+    uint8_t thermistor;
+    uint32_t count;
+    double min;
+    double max;
+    double mean;
+    double variance;
+    uint32_t invalid;
+    uint32_t total;
+    uint32_t total_invalid;
+    double drift;
+};
+
 struct GetRPMResponse {
     uint32_t responding_to_id;
     int16_t current_rpm;
@@ -241,6 +347,36 @@ struct AcknowledgePrevious {
     errors::ErrorCode with_error = errors::ErrorCode::NO_ERROR;
 };
 
+// One page of a motor capture; samples are only sent once it is done
+struct GetMotorCaptureResponse {
+    static constexpr size_t PAGE_SIZE = 8;
+    uint32_t responding_to_id;
+    motor_telemetry::Status status;
+    uint16_t period_ticks;
+    uint16_t count;
+    uint16_t trigger_index;
+    uint16_t start;
+    uint8_t page_count;
+    std::array<motor_telemetry::Sample, PAGE_SIZE> page;
+};
+
+struct GetLoopTimingResponse {
+    uint32_t responding_to_id;
+    loop_timing::MotorLoopTiming timing;
+};
+
+struct GetSkipBandsResponse {
+    uint32_t responding_to_id;
+    std::array<skip_bands::Band, skip_bands::MOTOR_SKIP_BANDS> bands;
+    size_t count;
+};
+
+// Sent as each segment of a shake program starts, and once it finishes
+struct ShakeProgramEventMessage {
+    uint16_t segment;
+    bool done = false;
+};
+
 struct IncomingMessageFromHost {
     const char* buffer;
     const char* limit;
@@ -249,14 +385,21 @@ struct IncomingMessageFromHost {
 using HeaterMessage =
     ::std::variant<std::monostate, SetTemperatureMessage, GetTemperatureMessage,
                    TemperatureConversionComplete, GetTemperatureDebugMessage,
-                   SetPIDConstantsMessage, SetPowerTestMessage>;
+                   SetPIDConstantsMessage, SetPowerTestMessage,
+                   StartAutotuneMessage, GetThermistorStatsMessage,
+                   SetPowerSupplyMessage>;
 using MotorMessage = ::std::variant<
     std::monostate, MotorSystemErrorMessage, SetRPMMessage, GetRPMMessage,
     SetAccelerationMessage, CheckHomingStatusMessage, BeginHomingMessage,
     ActuateSolenoidMessage, SetPlateLockPowerMessage, OpenPlateLockMessage,
     ClosePlateLockMessage, SetPIDConstantsMessage, PlateLockComplete,
     GetPlateLockStateMessage, GetPlateLockStateDebugMessage,
-    CheckPlateLockStatusMessage>;
+    CheckPlateLockStatusMessage, PlateLockTimeoutMessage, SetJerkMessage,
+    SpeedProfileStepMessage, AddShakeSegmentMessage, RunShakeProgramMessage,
+    ClearShakeProgramMessage, ShakeProgramStepMessage, AcknowledgePrevious,
+    ArmMotorCaptureMessage, TriggerMotorCaptureMessage,
+    GetMotorCaptureMessage, GetLoopTimingMessage, AddSkipBandMessage,
+    ClearSkipBandsMessage, GetSkipBandsMessage>;
 using SystemMessage =
     ::std::variant<std::monostate, EnterBootloaderMessage, AcknowledgePrevious,
                    SetSerialNumberMessage, GetSystemInfoMessage, SetLEDMessage,
@@ -267,5 +410,8 @@ using HostCommsMessage =
                    ErrorMessage, GetTemperatureResponse, GetRPMResponse,
                    GetTemperatureDebugResponse, ForceUSBDisconnectMessage,
                    GetPlateLockStateResponse, GetPlateLockStateDebugResponse,
-                   GetSystemInfoResponse>;
+                   GetSystemInfoResponse, AutotuneResultResponse,
+                   GetThermistorStatsResponse, ShakeProgramEventMessage,
+                   GetMotorCaptureResponse, GetLoopTimingResponse,
+                   GetSkipBandsResponse>;
 };  // namespace messages
@@ -4,11 +4,20 @@
 #pragma once
 
 #include <algorithm>
+#include <cmath>
 #include <concepts>
+#include <limits>
+#include <optional>
 #include <variant>
 
 #include "hal/message_queue.hpp"
+#include "heater-shaker/loop_timing.hpp"
 #include "heater-shaker/messages.hpp"
+#include "heater-shaker/motor_telemetry.hpp"
+#include "heater-shaker/power_budget.hpp"
+#include "heater-shaker/shake_program.hpp"
+#include "heater-shaker/skip_bands.hpp"
+#include "heater-shaker/speed_profile.hpp"
 #include "heater-shaker/tasks.hpp"
 namespace tasks {
 template <template <class> class QueueImpl>
@@ -37,14 +46,53 @@ namespace motor_task {
  * task of its event by sending a message.
  */
 template <typename Policy>
-concept MotorExecutionPolicy = requires(Policy& p, const Policy& cp) {
+concept MotorExecutionPolicy = requires(
+    Policy& p, const Policy& cp,
+    const skip_bands::MotorSkipBands::Stored& stored_bands) {
     { p.set_rpm(static_cast<int16_t>(16)) } -> std::same_as<errors::ErrorCode>;
+    // Whether set_rpm would accept a speed, without changing anything
+    {
+        cp.validate_rpm(static_cast<int16_t>(16))
+        } -> std::same_as<errors::ErrorCode>;
+    // Ramp linearly to a speed over some ticks rather than at the ramp rate,
+    // starting the motor if it's stopped. S-curve speed changes are sent to
+    // the motor driver as a series of these.
+    {
+        p.set_rpm_segment(static_cast<int16_t>(16), static_cast<uint16_t>(20))
+        } -> std::same_as<errors::ErrorCode>;
+    // A one-shot wakeup: the hardware sends a SpeedProfileStepMessage once
+    // the ticks have passed. Arming again replaces the previous wakeup.
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
+    {p.speed_profile_wakeup_arm(20)};
+    {p.speed_profile_wakeup_disarm()};
+    // A one-shot wakeup for shake programs: the hardware sends a
+    // ShakeProgramStepMessage carrying the given generation once the ticks
+    // have passed. Arming again replaces the previous wakeup.
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
+    {p.shake_program_wakeup_arm(20, static_cast<uint32_t>(1))};
+    {p.shake_program_wakeup_disarm()};
+    // The capture the motor control loop records into
+    { p.motor_capture() } -> std::same_as<motor_telemetry::MotorCapture&>;
+    // Execution time of the motor controller's loops since the last reset
+    { p.get_loop_timing() } -> std::same_as<loop_timing::MotorLoopTiming>;
+    {p.reset_loop_timing()};
+    // The skip band table as kept in non-volatile storage. Storage that was
+    // never written reads back as something that won't restore.
+    {
+        cp.read_skip_bands()
+        } -> std::same_as<skip_bands::MotorSkipBands::Stored>;
+    { p.write_skip_bands(stored_bands) } -> std::same_as<bool>;
     { cp.get_current_rpm() } -> std::same_as<int16_t>;
     { cp.get_target_rpm() } -> std::same_as<int16_t>;
     {p.stop()};
     {
         p.set_ramp_rate(static_cast<int32_t>(8))
         } -> std::same_as<errors::ErrorCode>;
+    // Check a ramp rate against the limits set_ramp_rate enforces, without
+    // changing anything
+    {
+        cp.validate_ramp_rate(static_cast<int32_t>(8))
+        } -> std::same_as<errors::ErrorCode>;
     // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
     {p.set_pid_constants(1.0, 2.0, 3.0)};
     {p.homing_solenoid_disengage()};
@@ -52,9 +100,24 @@ concept MotorExecutionPolicy = requires(Policy& p, const Policy& cp) {
     {p.homing_solenoid_engage(122)};
     // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
     {p.delay_ticks(10)};
+    // Homing waits without blocking the task: arm a one-shot wakeup and the
+    // hardware sends a CheckHomingStatusMessage once the ticks have passed,
+    // or as soon as the motor speed is inside the (low, high) rpm range if
+    // that comes first. An empty range waits for the ticks alone. Arming
+    // again replaces the previous wakeup.
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
+    {p.homing_wakeup_arm(100, 200, 250)};
+    {p.homing_wakeup_disarm()};
     // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
     {p.plate_lock_set_power(0.1)};
     {p.plate_lock_disable()};
+    // Plate lock moves end when a limit switch interrupt sends a
+    // PlateLockComplete; if the ticks pass first, the hardware sends a
+    // PlateLockTimeoutMessage instead. Arming again replaces the previous
+    // timeout.
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
+    {p.plate_lock_timeout_arm(100)};
+    {p.plate_lock_timeout_disarm()};
 };
 
 struct State {
@@ -90,8 +153,7 @@ using Message = ::messages::MotorMessage;
 template <template <class> class QueueImpl>
 requires MessageQueue<QueueImpl<Message>, Message>
 class MotorTask {
-    static constexpr const uint32_t HOMING_INTERSTATE_WAIT_TICKS = 100;
-    static constexpr const uint16_t PLATE_LOCK_WAIT_TICKS = 100;
+    static constexpr const uint16_t HOMING_INTERSTATE_WAIT_TICKS = 100;
     static constexpr const uint16_t STARTUP_HOMING_WAIT_TICKS =
         200;  // needed to ensure motor setup complete at startup before homing
 
@@ -102,6 +164,25 @@ class MotorTask {
     static constexpr uint16_t HOMING_SOLENOID_CURRENT_INITIAL = 200;
     static constexpr uint16_t HOMING_SOLENOID_CURRENT_HOLD = 75;
     static constexpr uint16_t HOMING_CYCLES_BEFORE_TIMEOUT = 10;
+    // The solenoid gets two waits to catch the plate before the first check
+    // that it's stopped, as when homing slept through both in turn
+    static constexpr uint16_t HOMING_ENGAGE_WAIT_TICKS =
+        2 * HOMING_INTERSTATE_WAIT_TICKS;
+    // The longest a home coasts with the solenoid engaged
+    static constexpr uint32_t HOMING_COAST_TIMEOUT_TICKS =
+        HOMING_ENGAGE_WAIT_TICKS +
+        HOMING_CYCLES_BEFORE_TIMEOUT * HOMING_INTERSTATE_WAIT_TICKS;
+    // S-curve speed changes are sent to the motor driver as linear ramps of
+    // this many ticks
+    static constexpr uint16_t SPEED_PROFILE_SEGMENT_TICKS = 20;
+    // The motor driver's ramp rate until M204 changes it
+    static constexpr int32_t DEFAULT_ACCELERATION_RPM_PER_S = 1000;
+    static constexpr int32_t MIN_JERK_RPM_PER_S2 = 100;
+    static constexpr int32_t MAX_JERK_RPM_PER_S2 = 1000000;
+    static constexpr size_t SHAKE_PROGRAM_CAPACITY = 32;
+    // Skip bands are crossed at the motor driver's fastest ramp
+    static constexpr int32_t SKIP_BAND_CROSSING_RPM_PER_S = 20000;
+    // Ticks a plate lock move may take before it times out
     static constexpr uint16_t PLATE_LOCK_MOVE_TIME_THRESHOLD =
         2350;  // 1250 for 380:1 motor, 2350 for 1000:1 motor
     using Queue = QueueImpl<Message>;
@@ -133,6 +214,12 @@ class MotorTask {
     auto run_once(Policy& policy) -> void {
         auto message = Message(std::monostate());
 
+        if (!skip_bands_loaded) {
+            static_cast<void>(
+                skip_band_table.restore(policy.read_skip_bands()));
+            skip_bands_loaded = true;
+        }
+
         // This is the call down to the provided queue. It will block for
         // anywhere up to the provided timeout, which drives the controller
         // frequency.
@@ -164,9 +251,14 @@ class MotorTask {
                         .with_error =
                             errors::ErrorCode::PLATE_LOCK_NOT_CLOSED}));
         } else {
+            policy.homing_wakeup_disarm();
             policy.homing_solenoid_disengage();
-            auto error = policy.set_rpm(msg.target_rpm);
+            cancel_shake_program(policy);
+            static_cast<void>(policy.motor_capture().trigger());
+            auto error = change_speed(msg.target_rpm, acceleration_rpm_per_s,
+                                      policy);
             state.status = State::RUNNING;
+            publish_power_demand(msg.target_rpm);
             auto response = messages::AcknowledgePrevious{
                 .responding_to_id = msg.id, .with_error = error};
             if (msg.from_system) {
@@ -194,19 +286,271 @@ class MotorTask {
     auto visit_message(const messages::SetAccelerationMessage& msg,
                        Policy& policy) -> void {
         auto error = policy.set_ramp_rate(msg.rpm_per_s);
+        if (error == errors::ErrorCode::NO_ERROR) {
+            acceleration_rpm_per_s = msg.rpm_per_s;
+        }
         auto response = messages::AcknowledgePrevious{
             .responding_to_id = msg.id, .with_error = error};
         static_cast<void>(task_registry->comms->get_message_queue().try_send(
             messages::HostCommsMessage(response)));
     }
 
+    template <typename Policy>
+    auto visit_message(const messages::SetJerkMessage& msg, Policy& policy)
+        -> void {
+        static_cast<void>(policy);
+        auto error = errors::ErrorCode::NO_ERROR;
+        if ((msg.rpm_per_s2 != 0) && ((msg.rpm_per_s2 < MIN_JERK_RPM_PER_S2) ||
+                                      (msg.rpm_per_s2 > MAX_JERK_RPM_PER_S2))) {
+            error = errors::ErrorCode::MOTOR_ILLEGAL_JERK;
+        } else {
+            jerk_rpm_per_s2 = msg.rpm_per_s2;
+        }
+        static_cast<void>(task_registry->comms->get_message_queue().try_send(
+            messages::AcknowledgePrevious{.responding_to_id = msg.id,
+                                          .with_error = error}));
+    }
+
+    template <typename Policy>
+    auto visit_message(const messages::SpeedProfileStepMessage& _ignore,
+                       Policy& policy) -> void {
+        static_cast<void>(_ignore);
+        // Stale once the change it was armed for is finished or cancelled
+        if (profile.has_value()) {
+            step_speed_profile(policy);
+        } else if (crossing_leg_count > 0) {
+            step_band_crossing(policy);
+        }
+    }
+
+    template <typename Policy>
+    auto visit_message(const messages::AddShakeSegmentMessage& msg,
+                       Policy& policy) -> void {
+        auto error = errors::ErrorCode::NO_ERROR;
+        if (msg.segment.ramp_rpm_per_s <= 0) {
+            error = errors::ErrorCode::MOTOR_ILLEGAL_RAMP_RATE;
+        } else if (auto ramp_error =
+                       policy.validate_ramp_rate(msg.segment.ramp_rpm_per_s);
+                   ramp_error != errors::ErrorCode::NO_ERROR) {
+            error = ramp_error;
+        } else if (skip_band_table.contains(msg.segment.rpm)) {
+            error = errors::ErrorCode::MOTOR_RPM_IN_SKIP_BAND;
+        } else if (msg.segment.rpm != 0) {
+            error = policy.validate_rpm(msg.segment.rpm);
+        }
+        if ((error == errors::ErrorCode::NO_ERROR) &&
+            !program.add(msg.segment)) {
+            error = errors::ErrorCode::MOTOR_PROGRAM_FULL;
+        }
+        static_cast<void>(task_registry->comms->get_message_queue().try_send(
+            messages::AcknowledgePrevious{.responding_to_id = msg.id,
+                                          .with_error = error}));
+    }
+
+    template <typename Policy>
+    auto visit_message(const messages::RunShakeProgramMessage& msg,
+                       Policy& policy) -> void {
+        auto error = errors::ErrorCode::NO_ERROR;
+        if ((!policy.plate_lock_closed_sensor_read()) &&
+            (plate_lock_state.status != PlateLockState::IDLE_CLOSED)) {
+            error = errors::ErrorCode::PLATE_LOCK_NOT_CLOSED;
+        } else if (program.empty()) {
+            error = errors::ErrorCode::MOTOR_PROGRAM_EMPTY;
+        }
+        static_cast<void>(task_registry->comms->get_message_queue().try_send(
+            messages::AcknowledgePrevious{.responding_to_id = msg.id,
+                                          .with_error = error}));
+        if (error != errors::ErrorCode::NO_ERROR) {
+            return;
+        }
+        policy.homing_wakeup_disarm();
+        policy.homing_solenoid_disengage();
+        state.status = State::RUNNING;
+        static_cast<void>(policy.motor_capture().trigger());
+        program.restart();
+        program_running = true;
+        ++program_generation;
+        start_program_segment(policy);
+    }
+
+    template <typename Policy>
+    auto visit_message(const messages::ClearShakeProgramMessage& msg,
+                       Policy& policy) -> void {
+        cancel_shake_program(policy);
+        program.clear();
+        static_cast<void>(task_registry->comms->get_message_queue().try_send(
+            messages::AcknowledgePrevious{.responding_to_id = msg.id}));
+    }
+
+    template <typename Policy>
+    auto visit_message(const messages::ShakeProgramStepMessage& msg,
+                       Policy& policy) -> void {
+        // Stale once the program it was armed for is finished or cancelled,
+        // even if another run has started since
+        if (!program_running || (msg.generation != program_generation)) {
+            return;
+        }
+        if (program_wait_ticks > 0) {
+            wait_program_ticks(policy);
+            return;
+        }
+        if (program.advance()) {
+            start_program_segment(policy);
+            return;
+        }
+        cancel_shake_program(policy);
+        static_cast<void>(task_registry->comms->get_message_queue().try_send(
+            messages::HostCommsMessage(messages::ShakeProgramEventMessage{
+                .segment = static_cast<uint16_t>(program.size() - 1),
+                .done = true})));
+    }
+
+    // Answers heater setpoints sent by a shake program
+    template <typename Policy>
+    auto visit_message(const messages::AcknowledgePrevious& msg,
+                       Policy& policy) -> void {
+        static_cast<void>(policy);
+        if (msg.with_error != errors::ErrorCode::NO_ERROR) {
+            static_cast<void>(
+                task_registry->comms->get_message_queue().try_send(
+                    messages::HostCommsMessage(
+                        messages::ErrorMessage{.code = msg.with_error})));
+        }
+    }
+
+    // An armed capture is triggered by hand, or by the next speed change,
+    // shake program or homing, whichever comes first
+    template <typename Policy>
+    auto visit_message(const messages::ArmMotorCaptureMessage& msg,
+                       Policy& policy) -> void {
+        auto error = errors::ErrorCode::NO_ERROR;
+        if (!policy.motor_capture().arm(msg.period_ticks, msg.post_trigger)) {
+            error = errors::ErrorCode::MOTOR_BAD_CAPTURE_SETTINGS;
+        }
+        static_cast<void>(task_registry->comms->get_message_queue().try_send(
+            messages::AcknowledgePrevious{.responding_to_id = msg.id,
+                                          .with_error = error}));
+    }
+
+    template <typename Policy>
+    auto visit_message(const messages::TriggerMotorCaptureMessage& msg,
+                       Policy& policy) -> void {
+        auto error = errors::ErrorCode::NO_ERROR;
+        if (!policy.motor_capture().trigger()) {
+            error = errors::ErrorCode::MOTOR_CAPTURE_NOT_ARMED;
+        }
+        static_cast<void>(task_registry->comms->get_message_queue().try_send(
+            messages::AcknowledgePrevious{.responding_to_id = msg.id,
+                                          .with_error = error}));
+    }
+
+    template <typename Policy>
+    auto visit_message(const messages::GetLoopTimingMessage& msg,
+                       Policy& policy) -> void {
+        auto response = messages::GetLoopTimingResponse{
+            .responding_to_id = msg.id, .timing = policy.get_loop_timing()};
+        if (msg.reset) {
+            policy.reset_loop_timing();
+        }
+        static_cast<void>(task_registry->comms->get_message_queue().try_send(
+            messages::HostCommsMessage(response)));
+    }
+
+    template <typename Policy>
+    auto visit_message(const messages::AddSkipBandMessage& msg,
+                       Policy& policy) -> void {
+        auto error = errors::ErrorCode::NO_ERROR;
+        if (!may_write_skip_bands(policy)) {
+            error = errors::ErrorCode::MOTOR_NOT_STOPPED;
+        } else if (!skip_bands::MotorSkipBands::valid(msg.band)) {
+            error = errors::ErrorCode::MOTOR_ILLEGAL_SKIP_BAND;
+        } else if (!skip_band_table.add(msg.band)) {
+            error = errors::ErrorCode::MOTOR_SKIP_BANDS_FULL;
+        } else if (!policy.write_skip_bands(skip_band_table.store())) {
+            error = errors::ErrorCode::MOTOR_SKIP_BANDS_NOT_SAVED;
+        }
+        static_cast<void>(task_registry->comms->get_message_queue().try_send(
+            messages::AcknowledgePrevious{.responding_to_id = msg.id,
+                                          .with_error = error}));
+    }
+
+    template <typename Policy>
+    auto visit_message(const messages::ClearSkipBandsMessage& msg,
+                       Policy& policy) -> void {
+        auto error = errors::ErrorCode::NO_ERROR;
+        if (!may_write_skip_bands(policy)) {
+            error = errors::ErrorCode::MOTOR_NOT_STOPPED;
+        } else {
+            skip_band_table.clear();
+            if (!policy.write_skip_bands(skip_band_table.store())) {
+                error = errors::ErrorCode::MOTOR_SKIP_BANDS_NOT_SAVED;
+            }
+        }
+        static_cast<void>(task_registry->comms->get_message_queue().try_send(
+            messages::AcknowledgePrevious{.responding_to_id = msg.id,
+                                          .with_error = error}));
+    }
+
+    template <typename Policy>
+    auto visit_message(const messages::GetSkipBandsMessage& msg,
+                       Policy& policy) -> void {
+        static_cast<void>(policy);
+        auto response = messages::GetSkipBandsResponse{
+            .responding_to_id = msg.id,
+            .bands = {},
+            .count = skip_band_table.size()};
+        for (size_t i = 0; i < response.count; ++i) {
+            response.bands.at(i) = skip_band_table.at(i);
+        }
+        static_cast<void>(task_registry->comms->get_message_queue().try_send(
+            messages::HostCommsMessage(response)));
+    }
+
+    template <typename Policy>
+    auto visit_message(const messages::GetMotorCaptureMessage& msg,
+                       Policy& policy) -> void {
+        const auto& capture = policy.motor_capture();
+        auto response = messages::GetMotorCaptureResponse{
+            .responding_to_id = msg.id,
+            .status = capture.status(),
+            .period_ticks = capture.period_ticks(),
+            .count = 0,
+            .trigger_index = 0,
+            .start = msg.start,
+            .page_count = 0,
+            .page = {}};
+        if (response.status == motor_telemetry::Status::DONE) {
+            response.count = static_cast<uint16_t>(capture.size());
+            response.trigger_index =
+                static_cast<uint16_t>(capture.trigger_index());
+            for (size_t i = msg.start;
+                 (i < capture.size()) &&
+                 (response.page_count < response.page.size());
+                 ++i, ++response.page_count) {
+                response.page.at(response.page_count) = capture.at(i);
+            }
+        }
+        static_cast<void>(task_registry->comms->get_message_queue().try_send(
+            messages::HostCommsMessage(response)));
+    }
+
     template <typename Policy>
     auto visit_message(const messages::GetRPMMessage& msg, Policy& policy)
         -> void {
+        // During an S-curve or a band crossing the driver's setpoint is only
+        // the end of the current segment
+        int16_t setpoint = policy.get_target_rpm();
+        if (profile.has_value()) {
+            setpoint = static_cast<int16_t>(std::lround(profile->target_rpm()));
+        } else if (crossing_stops) {
+            setpoint = 0;
+        } else if (crossing_leg_count > 0) {
+            setpoint = crossing_legs.at(crossing_leg_count - 1).rpm;
+        }
         auto response =
             messages::GetRPMResponse{.responding_to_id = msg.id,
                                      .current_rpm = policy.get_current_rpm(),
-                                     .setpoint_rpm = policy.get_target_rpm()};
+                                     .setpoint_rpm = setpoint};
         static_cast<void>(task_registry->comms->get_message_queue().try_send(
             messages::HostCommsMessage(response)));
     }
@@ -223,13 +567,7 @@ class MotorTask {
             return;
         }
         if (state.status == State::HOMING_COASTING_TO_STOP) {
-            policy.homing_solenoid_engage(HOMING_SOLENOID_CURRENT_HOLD);
-            policy.stop();
-            state.status = State::STOPPED_HOMED;
-            static_cast<void>(
-                task_registry->comms->get_message_queue().try_send(
-                    messages::AcknowledgePrevious{.responding_to_id =
-                                                      cached_home_id}));
+            finish_homing(policy);
         } else {
             for (auto offset = static_cast<uint8_t>(
                      errors::MotorErrorOffset::FOC_DURATION);
@@ -239,7 +577,11 @@ class MotorTask {
                 auto code = errors::from_motor_error(
                     msg.errors, static_cast<errors::MotorErrorOffset>(offset));
                 if (code != errors::ErrorCode::NO_ERROR) {
+                    policy.homing_wakeup_disarm();
+                    cancel_speed_profile(policy);
+                    cancel_shake_program(policy);
                     state.status = State::ERROR;
+                    publish_power_demand(0);
                     static_cast<void>(
                         task_registry->comms->get_message_queue().try_send(
                             messages::HostCommsMessage(
@@ -261,19 +603,19 @@ class MotorTask {
      * - set solenoid
      * - wait until the motor driver says we stalled or for a period of time
      *
-     * So we replace any wait states with repeatedly sending ourselves another
-     * CheckHomingStatusMessage. Because we talk with queues, we won't spinlock
-     * ourselves - any messages sent asynchronously will get enqueued and
-     * handled eventually, and we'll wait a bit always in between runs - but we
-     * still do a bit of a sleep because otherwise we'd run every tick.
+     * So we replace any wait states with a homing wakeup from the policy: the
+     * hardware sends us a CheckHomingStatusMessage when the motor reaches the
+     * homing speed or when a timer runs out, and until then the task is free
+     * to handle everything else that comes in.
      *
      * So, the sequence is
      * - Get a BeginHomingMessage and take the quick actions of setting an RPM
-     * target and doublechecking the solenoid is disengaged, then send ourselves
-     * a check-status
+     * target and doublechecking the solenoid is disengaged, then check the
+     * status straight away in case we're already at the homing speed
      * - When we get a check-status, go from moving-to-speed to coasting-to-stop
-     * if we can and otherwise send another check-status
-     * - When in coasting-to-stop, keep sending those check-statuses. If we keep
+     * if we can and otherwise wait for the motor to reach the homing speed
+     * (rechecking every so often regardless)
+     * - When in coasting-to-stop, keep waking up every so often. If we keep
      * the solenoid engaged forever, it will fry itself, so we need a timeout.
      * In either case, we've probably homed successfully; sadly, the motor
      * system isn't quite good enough to detect when it's homed on its own.
@@ -289,25 +631,18 @@ class MotorTask {
                 policy.homing_solenoid_engage(HOMING_SOLENOID_CURRENT_INITIAL);
                 state.status = State::HOMING_COASTING_TO_STOP;
                 homing_cycles_coasting = 0;
-                policy.delay_ticks(HOMING_INTERSTATE_WAIT_TICKS);
+                policy.homing_wakeup_arm(HOMING_ENGAGE_WAIT_TICKS, 0, 0);
+            } else {
+                policy.homing_wakeup_arm(HOMING_INTERSTATE_WAIT_TICKS,
+                                         HOMING_ROTATION_LIMIT_LOW_RPM,
+                                         HOMING_ROTATION_LIMIT_HIGH_RPM);
             }
-            policy.delay_ticks(HOMING_INTERSTATE_WAIT_TICKS);
-            static_cast<void>(get_message_queue().try_send(
-                messages::CheckHomingStatusMessage{}));
         } else if (state.status == State::HOMING_COASTING_TO_STOP) {
             homing_cycles_coasting++;
             if (homing_cycles_coasting > HOMING_CYCLES_BEFORE_TIMEOUT) {
-                policy.homing_solenoid_engage(HOMING_SOLENOID_CURRENT_HOLD);
-                policy.stop();
-                state.status = State::STOPPED_HOMED;
-                static_cast<void>(
-                    task_registry->comms->get_message_queue().try_send(
-                        messages::AcknowledgePrevious{.responding_to_id =
-                                                          cached_home_id}));
+                finish_homing(policy);
             } else {
-                policy.delay_ticks(HOMING_INTERSTATE_WAIT_TICKS);
-                static_cast<void>(get_message_queue().try_send(
-                    messages::CheckHomingStatusMessage{}));
+                policy.homing_wakeup_arm(HOMING_INTERSTATE_WAIT_TICKS, 0, 0);
             }
         }
     }
@@ -324,20 +659,47 @@ class MotorTask {
                         .with_error =
                             errors::ErrorCode::PLATE_LOCK_NOT_CLOSED}));
         } else {
+            const bool already_homing =
+                (state.status == State::HOMING_MOVING_TO_HOME_SPEED) ||
+                (state.status == State::HOMING_COASTING_TO_STOP);
             state.status = State::HOMING_MOVING_TO_HOME_SPEED;
             policy.homing_solenoid_disengage();
+            cancel_speed_profile(policy);
+            cancel_shake_program(policy);
+            static_cast<void>(policy.motor_capture().trigger());
             policy.set_rpm(HOMING_ROTATION_LIMIT_LOW_RPM +
                            HOMING_ROTATION_LOW_MARGIN);
-            policy.delay_ticks(HOMING_INTERSTATE_WAIT_TICKS);
+            publish_power_demand(HOMING_ROTATION_LIMIT_LOW_RPM +
+                                 HOMING_ROTATION_LOW_MARGIN);
             cached_home_id = msg.id;
-            static_cast<void>(get_message_queue().try_send(
-                messages::CheckHomingStatusMessage{}));
+            if (already_homing) {
+                // A check is already on its way; just make sure it's looking
+                // for the homing speed
+                policy.homing_wakeup_arm(HOMING_INTERSTATE_WAIT_TICKS,
+                                         HOMING_ROTATION_LIMIT_LOW_RPM,
+                                         HOMING_ROTATION_LIMIT_HIGH_RPM);
+            } else {
+                static_cast<void>(get_message_queue().try_send(
+                    messages::CheckHomingStatusMessage{}));
+            }
         }
     }
 
+    template <typename Policy>
+    auto finish_homing(Policy& policy) -> void {
+        policy.homing_wakeup_disarm();
+        policy.homing_solenoid_engage(HOMING_SOLENOID_CURRENT_HOLD);
+        policy.stop();
+        state.status = State::STOPPED_HOMED;
+        publish_power_demand(0);
+        static_cast<void>(task_registry->comms->get_message_queue().try_send(
+            messages::AcknowledgePrevious{.responding_to_id = cached_home_id}));
+    }
+
     template <typename Policy>
     auto visit_message(const messages::ActuateSolenoidMessage& msg,
                        Policy& policy) -> void {
+        policy.homing_wakeup_disarm();
         state.status = State::STOPPED_UNKNOWN;
         if (msg.current_ma == 0) {
             policy.homing_solenoid_disengage();
@@ -384,7 +746,8 @@ class MotorTask {
             } else {
                 policy.plate_lock_set_power(OpenPower);
                 plate_lock_state.status = PlateLockState::OPENING;
-                polling_time = 0;
+                begin_plate_lock_move(check_state_message, policy);
+                return;
             }
         }
         static_cast<void>(get_message_queue().try_send(check_state_message));
@@ -407,7 +770,8 @@ class MotorTask {
             } else {
                 policy.plate_lock_set_power(ClosePower);
                 plate_lock_state.status = PlateLockState::CLOSING;
-                polling_time = 0;
+                begin_plate_lock_move(check_state_message, policy);
+                return;
             }
         }
         static_cast<void>(get_message_queue().try_send(check_state_message));
@@ -434,21 +798,6 @@ class MotorTask {
                         messages::AcknowledgePrevious{
                             .responding_to_id = msg.responding_to_id}));
             }
-        } else if (polling_time > PLATE_LOCK_MOVE_TIME_THRESHOLD) {
-            policy.plate_lock_brake();
-            plate_lock_state.status = PlateLockState::IDLE_UNKNOWN;
-            static_cast<void>(
-                task_registry->comms->get_message_queue().try_send(
-                    messages::AcknowledgePrevious{
-                        .responding_to_id = msg.responding_to_id,
-                        .with_error = errors::ErrorCode::PLATE_LOCK_TIMEOUT}));
-        } else {
-            policy.delay_ticks(PLATE_LOCK_WAIT_TICKS);
-            polling_time += PLATE_LOCK_WAIT_TICKS;
-            static_cast<void>(get_message_queue().try_send(
-                messages::CheckPlateLockStatusMessage{
-                    .responding_to_id = msg.responding_to_id,
-                    .from_startup = msg.from_startup}));
         }
     }
 
@@ -461,6 +810,31 @@ class MotorTask {
         } else if ((msg.open == true) && (msg.closed == false)) {
             plate_lock_state.status = PlateLockState::IDLE_OPEN;
         }
+        if (plate_lock_move.has_value() &&
+            ((plate_lock_state.status == PlateLockState::IDLE_CLOSED) ||
+             (plate_lock_state.status == PlateLockState::IDLE_OPEN))) {
+            policy.plate_lock_timeout_disarm();
+            auto finished = plate_lock_move.value();
+            plate_lock_move.reset();
+            visit_message(finished, policy);
+        }
+    }
+
+    template <typename Policy>
+    auto visit_message(const messages::PlateLockTimeoutMessage& _ignore,
+                       Policy& policy) -> void {
+        static_cast<void>(_ignore);
+        // Stale once the move it was armed for has finished
+        if (!plate_lock_move.has_value()) {
+            return;
+        }
+        policy.plate_lock_brake();
+        plate_lock_state.status = PlateLockState::IDLE_UNKNOWN;
+        static_cast<void>(task_registry->comms->get_message_queue().try_send(
+            messages::AcknowledgePrevious{
+                .responding_to_id = plate_lock_move.value().responding_to_id,
+                .with_error = errors::ErrorCode::PLATE_LOCK_TIMEOUT}));
+        plate_lock_move.reset();
     }
 
     template <typename Policy>
@@ -535,13 +909,335 @@ class MotorTask {
             messages::HostCommsMessage(response)));
     }
 
+    /**
+     * Start a change of speed. Speeds inside a skip band are refused. A
+     * change through bands runs as linear legs, crossing each band at
+     * SKIP_BAND_CROSSING_RPM_PER_S with no jerk limit, a stop crossing down
+     * to the edge of the lowest band before the motor driver takes it the
+     * rest of the way; failing that, with a jerk limit set, anything but a
+     * stop follows an S-curve from the current speed. The task steps through
+     * either one segment at a time on speed profile wakeups. Anything else,
+     * stops included, goes straight to the motor driver, which ramps at
+     * whatever rate it was last given.
+     */
+    template <typename Policy>
+    auto change_speed(int16_t target_rpm, int32_t acceleration,
+                      Policy& policy) -> errors::ErrorCode {
+        cancel_speed_profile(policy);
+        if (skip_band_table.contains(target_rpm)) {
+            return errors::ErrorCode::MOTOR_RPM_IN_SKIP_BAND;
+        }
+        const auto current_rpm = policy.get_current_rpm();
+        if ((target_rpm == 0) && skip_band_table.crosses(current_rpm, 0)) {
+            start_band_crossing(current_rpm, 0, acceleration, policy);
+            return errors::ErrorCode::NO_ERROR;
+        }
+        if (skip_band_table.crosses(current_rpm, target_rpm)) {
+            auto error = policy.validate_rpm(target_rpm);
+            if (error != errors::ErrorCode::NO_ERROR) {
+                return error;
+            }
+            start_band_crossing(current_rpm, target_rpm, acceleration, policy);
+            return errors::ErrorCode::NO_ERROR;
+        }
+        if ((jerk_rpm_per_s2 == 0) || (target_rpm == 0)) {
+            return policy.set_rpm(target_rpm);
+        }
+        auto error = policy.validate_rpm(target_rpm);
+        if (error != errors::ErrorCode::NO_ERROR) {
+            return error;
+        }
+        profile = speed_profile::SCurve(current_rpm, target_rpm, acceleration,
+                                        jerk_rpm_per_s2);
+        if (profile->duration_s() <= 0) {
+            profile.reset();
+            return policy.set_rpm(target_rpm);
+        }
+        profile_elapsed_ticks = 0;
+        step_speed_profile(policy);
+        return errors::ErrorCode::NO_ERROR;
+    }
+
+    /**
+     * Send the next segment of the profile, a linear ramp to the profile's
+     * speed at the end of the segment, or end the profile if the last one is
+     * done.
+     */
+    template <typename Policy>
+    auto step_speed_profile(Policy& policy) -> void {
+        static constexpr double TICKS_PER_SECOND = 1000.0;
+        const auto duration_ticks = static_cast<uint32_t>(
+            std::ceil(profile->duration_s() * TICKS_PER_SECOND));
+        if (profile_elapsed_ticks >= duration_ticks) {
+            profile.reset();
+            return;
+        }
+        const auto segment_ticks = static_cast<uint16_t>(
+            std::min(static_cast<uint32_t>(SPEED_PROFILE_SEGMENT_TICKS),
+                     duration_ticks - profile_elapsed_ticks));
+        profile_elapsed_ticks += segment_ticks;
+        const auto rpm = static_cast<int16_t>(std::lround(profile->rpm_at(
+            static_cast<double>(profile_elapsed_ticks) / TICKS_PER_SECOND)));
+        static_cast<void>(policy.set_rpm_segment(rpm, segment_ticks));
+        policy.speed_profile_wakeup_arm(segment_ticks);
+    }
+
+    /**
+     * Saving the skip bands can stall the CPU for long enough to upset the
+     * motor control loop, so it waits until the motor isn't being driven.
+     */
+    template <typename Policy>
+    [[nodiscard]] auto may_write_skip_bands(const Policy& policy) const
+        -> bool {
+        return (state.status != State::HOMING_MOVING_TO_HOME_SPEED) &&
+               (state.status != State::HOMING_COASTING_TO_STOP) &&
+               (policy.get_target_rpm() == 0);
+    }
+
+    /**
+     * The driver can't be given a segment down to 0 rpm, so a stop drops its
+     * last leg and is finished with a plain stop once the rest is run; the
+     * dropped leg still counts towards the time the change takes.
+     */
+    template <typename Policy>
+    auto start_band_crossing(int16_t from_rpm, int16_t to_rpm,
+                             int32_t acceleration, Policy& policy) -> void {
+        crossing_leg_count =
+            skip_band_table.legs(from_rpm, to_rpm, crossing_legs);
+        crossing_next_leg = 0;
+        crossing_rpm = from_rpm;
+        crossing_acceleration_rpm_per_s = acceleration;
+        crossing_total_ticks = 0;
+        int16_t at_rpm = from_rpm;
+        for (size_t i = 0; i < crossing_leg_count; ++i) {
+            const auto& leg = crossing_legs.at(i);
+            crossing_total_ticks += leg_ticks(at_rpm, leg);
+            at_rpm = leg.rpm;
+        }
+        crossing_stops = (to_rpm == 0);
+        if (crossing_stops) {
+            --crossing_leg_count;
+        }
+        step_band_crossing(policy);
+    }
+
+    /**
+     * Send the next leg of a band crossing as a linear ramp, or end the
+     * crossing if the last one is done. Legs longer than a wakeup can wait
+     * are sent a piece at a time.
+     */
+    template <typename Policy>
+    auto step_band_crossing(Policy& policy) -> void {
+        static constexpr double TICKS_PER_SECOND = 1000.0;
+        static constexpr uint32_t MAX_TICKS =
+            std::numeric_limits<uint16_t>::max();
+        if (crossing_next_leg >= crossing_leg_count) {
+            crossing_leg_count = 0;
+            if (crossing_stops) {
+                crossing_stops = false;
+                static_cast<void>(policy.set_rpm(0));
+            }
+            return;
+        }
+        const auto& leg = crossing_legs.at(crossing_next_leg);
+        auto ticks = leg_ticks(crossing_rpm, leg);
+        auto rpm = leg.rpm;
+        if (ticks > MAX_TICKS) {
+            ticks = MAX_TICKS;
+            const auto change = std::lround(
+                static_cast<double>(leg_rate_rpm_per_s(leg)) *
+                static_cast<double>(MAX_TICKS) / TICKS_PER_SECOND);
+            rpm = static_cast<int16_t>(
+                (leg.rpm > crossing_rpm) ? crossing_rpm + change
+                                         : crossing_rpm - change);
+        } else {
+            ++crossing_next_leg;
+        }
+        crossing_rpm = rpm;
+        static_cast<void>(
+            policy.set_rpm_segment(rpm, static_cast<uint16_t>(ticks)));
+        policy.speed_profile_wakeup_arm(static_cast<uint16_t>(ticks));
+    }
+
+    [[nodiscard]] auto leg_rate_rpm_per_s(const skip_bands::Leg& leg) const
+        -> int32_t {
+        return leg.crossing ? SKIP_BAND_CROSSING_RPM_PER_S
+                            : crossing_acceleration_rpm_per_s;
+    }
+
+    // Always at least a tick, so every leg gets a wakeup
+    [[nodiscard]] auto leg_ticks(int16_t from_rpm,
+                                 const skip_bands::Leg& leg) const
+        -> uint32_t {
+        static constexpr double TICKS_PER_SECOND = 1000.0;
+        const auto change = std::abs(static_cast<double>(leg.rpm) -
+                                     static_cast<double>(from_rpm));
+        return std::max(
+            static_cast<uint32_t>(std::ceil(
+                change * TICKS_PER_SECOND /
+                static_cast<double>(leg_rate_rpm_per_s(leg)))),
+            static_cast<uint32_t>(1));
+    }
+
+    template <typename Policy>
+    auto cancel_speed_profile(Policy& policy) -> void {
+        profile.reset();
+        crossing_leg_count = 0;
+        crossing_stops = false;
+        policy.speed_profile_wakeup_disarm();
+    }
+
+    /**
+     * Start the program's current segment: apply its heater setpoint, ramp to
+     * its speed at its own rate and wait out the ramp and then the dwell on
+     * shake program wakeups. The ramp time is worked out up front so that
+     * the segment takes the same time however the motor driver reports its
+     * progress.
+     */
+    template <typename Policy>
+    auto start_program_segment(Policy& policy) -> void {
+        static constexpr double TICKS_PER_SECOND = 1000.0;
+        const auto& segment = program.current();
+        const auto index = static_cast<uint16_t>(program.index());
+        static_cast<void>(task_registry->comms->get_message_queue().try_send(
+            messages::HostCommsMessage(
+                messages::ShakeProgramEventMessage{.segment = index})));
+        if (segment.temperature.has_value()) {
+            static_cast<void>(
+                task_registry->heater->get_message_queue().try_send(
+                    messages::SetTemperatureMessage{
+                        .id = 0,
+                        .target_temperature = segment.temperature.value(),
+                        .from_motor = true}));
+        }
+        auto error = policy.set_ramp_rate(segment.ramp_rpm_per_s);
+        if (error == errors::ErrorCode::NO_ERROR) {
+            error = change_speed(segment.rpm, segment.ramp_rpm_per_s, policy);
+        }
+        if (error != errors::ErrorCode::NO_ERROR) {
+            cancel_shake_program(policy);
+            static_cast<void>(
+                task_registry->comms->get_message_queue().try_send(
+                    messages::HostCommsMessage(
+                        messages::ErrorMessage{.code = error})));
+            return;
+        }
+        publish_power_demand(segment.rpm);
+        uint32_t ramp_ticks = crossing_total_ticks;
+        if (crossing_leg_count == 0) {
+            const double ramp_s =
+                profile.has_value()
+                    ? profile->duration_s()
+                    : std::abs(static_cast<double>(segment.rpm) -
+                               static_cast<double>(policy.get_current_rpm())) /
+                          static_cast<double>(segment.ramp_rpm_per_s);
+            ramp_ticks =
+                static_cast<uint32_t>(std::ceil(ramp_s * TICKS_PER_SECOND));
+        }
+        program_wait_ticks = ramp_ticks + segment.dwell_ms;
+        wait_program_ticks(policy);
+    }
+
+    /**
+     * Wakeups only reach so far, so long segments are waited out a piece at a
+     * time.
+     */
+    template <typename Policy>
+    auto wait_program_ticks(Policy& policy) -> void {
+        const auto ticks = static_cast<uint16_t>(std::min(
+            program_wait_ticks,
+            static_cast<uint32_t>(std::numeric_limits<uint16_t>::max())));
+        program_wait_ticks -= ticks;
+        if (ticks == 0) {
+            static_cast<void>(get_message_queue().try_send(
+                messages::ShakeProgramStepMessage{
+                    .generation = program_generation}));
+        } else {
+            policy.shake_program_wakeup_arm(ticks, program_generation);
+        }
+    }
+
+    /**
+     * Stop running the shake program, leaving its segments and the motor's
+     * speed alone, and give the motor driver back the M204 ramp rate.
+     */
+    template <typename Policy>
+    auto cancel_shake_program(Policy& policy) -> void {
+        policy.shake_program_wakeup_disarm();
+        if (program_running) {
+            program_running = false;
+            program_wait_ticks = 0;
+            static_cast<void>(policy.set_ramp_rate(acceleration_rpm_per_s));
+        }
+    }
+
+    /**
+     * Nothing polls a plate lock move: the limit switch interrupt or the
+     * timeout answers the command that started it. A move that replaces one
+     * still in progress fails the earlier command straight away, since only
+     * one move can be tracked and the earlier one never reached its switch.
+     */
+    template <typename Policy>
+    auto begin_plate_lock_move(const messages::CheckPlateLockStatusMessage& msg,
+                               Policy& policy) -> void {
+        if (plate_lock_move.has_value()) {
+            static_cast<void>(
+                task_registry->comms->get_message_queue().try_send(
+                    messages::AcknowledgePrevious{
+                        .responding_to_id =
+                            plate_lock_move.value().responding_to_id,
+                        .with_error =
+                            errors::ErrorCode::PLATE_LOCK_MOVE_SUPERSEDED}));
+        }
+        plate_lock_move = msg;
+        policy.plate_lock_timeout_arm(PLATE_LOCK_MOVE_TIME_THRESHOLD);
+    }
+
+    /**
+     * The motor driver doesn't report its power draw, so the motor's share
+     * of the power budget is estimated from its target speed.
+     */
+    auto publish_power_demand(int32_t rpm) -> void {
+        task_registry->power_budget.set_demand(
+            power::MOTOR,
+            static_cast<double>(rpm) / power::MOTOR_FULL_POWER_RPM);
+    }
+
     State state;
     PlateLockState plate_lock_state;
     Queue& message_queue;
     tasks::Tasks<QueueImpl>* task_registry;
     uint32_t cached_home_id = 0;
     uint32_t homing_cycles_coasting = 0;
-    uint32_t polling_time = 0;
+    // The open or close command waiting for the plate lock to finish moving
+    std::optional<messages::CheckPlateLockStatusMessage> plate_lock_move =
+        std::nullopt;
+    int32_t acceleration_rpm_per_s = DEFAULT_ACCELERATION_RPM_PER_S;
+    // 0 for plain ramps
+    int32_t jerk_rpm_per_s2 = 0;
+    // The S-curve speed change in progress, and how far into it the segment
+    // sent to the motor driver ends
+    std::optional<speed_profile::SCurve> profile = std::nullopt;
+    uint32_t profile_elapsed_ticks = 0;
+    skip_bands::MotorSkipBands skip_band_table{};
+    // Read from the policy on the first pass, since that's where it lives
+    bool skip_bands_loaded = false;
+    // The band crossing in progress, if there are legs: the next leg to
+    // send, where the last one sent ends, and how long it takes in all
+    skip_bands::MotorSkipBands::Legs crossing_legs{};
+    size_t crossing_leg_count = 0;
+    size_t crossing_next_leg = 0;
+    int16_t crossing_rpm = 0;
+    int32_t crossing_acceleration_rpm_per_s = 0;
+    uint32_t crossing_total_ticks = 0;
+    bool crossing_stops = false;
+    shake_program::Program<SHAKE_PROGRAM_CAPACITY> program{};
+    bool program_running = false;
+    // Counts runs of the shake program, so that wakeups from an earlier run
+    // can be told apart
+    uint32_t program_generation = 0;
+    // Ticks of the current segment still to wait beyond the armed wakeup
+    uint32_t program_wait_ticks = 0;
 };
 
 };  // namespace motor_task
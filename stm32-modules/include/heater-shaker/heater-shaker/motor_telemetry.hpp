@@ -0,0 +1,137 @@
+/*
+ * A capture of the motor's behaviour over time, for tuning ramps and the
+ * speed loop without a scope on the board. Whatever runs the motor
+ * controller offers it a sample every tick; the capture keeps one every
+ * period ticks in a ring, so once armed it always holds the most recent
+ * history. A trigger freezes the ring once a set number of samples after
+ * the trigger have been recorded, which keeps some history from before the
+ * trigger as well as what followed it.
+ *
+ * Arming and triggering come from the motor task and recording comes from
+ * the motor control loop, so the status is atomic. Samples are only read
+ * back once the capture is done and nothing writes them any more.
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace motor_telemetry {
+
+struct Sample {
+    int16_t rpm;
+    int16_t setpoint_rpm;
+    // Torque-producing current, in the motor driver's internal units
+    int16_t iq;
+    uint16_t bus_mv;
+};
+
+enum class Status : uint8_t { IDLE, ARMED, TRIGGERED, DONE };
+
+template <size_t Capacity>
+class Capture {
+  public:
+    static constexpr size_t capacity = Capacity;
+
+    /**
+     * Start recording from scratch.
+     * @param period_ticks Ticks between samples
+     * @param post_trigger Samples to record after a trigger before freezing
+     * @return false, changing nothing, if the settings don't fit
+     */
+    auto arm(uint16_t period_ticks, size_t post_trigger) -> bool {
+        if ((period_ticks == 0) || (post_trigger > Capacity)) {
+            return false;
+        }
+        // Stop the control loop recording while the settings change
+        _status.store(Status::IDLE, std::memory_order_release);
+        _period_ticks = period_ticks;
+        _post_trigger = post_trigger;
+        _ticks_to_sample = 0;
+        _next = 0;
+        _count = 0;
+        _recorded_after_trigger = 0;
+        _status.store(Status::ARMED, std::memory_order_release);
+        return true;
+    }
+
+    /** Start counting down to the freeze; false if the capture wasn't armed.*/
+    auto trigger() -> bool {
+        auto expected = Status::ARMED;
+        return _status.compare_exchange_strong(
+            expected, (_post_trigger == 0) ? Status::DONE : Status::TRIGGERED,
+            std::memory_order_acq_rel);
+    }
+
+    auto disarm() -> void {
+        _status.store(Status::IDLE, std::memory_order_release);
+    }
+
+    /** Called every tick; true if a sample should be recorded this tick.*/
+    auto sample_due() -> bool {
+        const auto status = _status.load(std::memory_order_acquire);
+        if ((status != Status::ARMED) && (status != Status::TRIGGERED)) {
+            return false;
+        }
+        if (_ticks_to_sample > 0) {
+            --_ticks_to_sample;
+            return false;
+        }
+        _ticks_to_sample = _period_ticks - 1;
+        return true;
+    }
+
+    auto record(const Sample& sample) -> void {
+        const auto status = _status.load(std::memory_order_acquire);
+        if ((status != Status::ARMED) && (status != Status::TRIGGERED)) {
+            return;
+        }
+        _samples.at(_next) = sample;
+        _next = (_next + 1) % Capacity;
+        if (_count < Capacity) {
+            ++_count;
+        }
+        if (status == Status::TRIGGERED) {
+            ++_recorded_after_trigger;
+            if (_recorded_after_trigger >= _post_trigger) {
+                _status.store(Status::DONE, std::memory_order_release);
+            }
+        }
+    }
+
+    [[nodiscard]] auto status() const -> Status {
+        return _status.load(std::memory_order_acquire);
+    }
+    [[nodiscard]] auto period_ticks() const -> uint16_t {
+        return _period_ticks;
+    }
+    /** Samples held; only meaningful once the capture is done.*/
+    [[nodiscard]] auto size() const -> size_t { return _count; }
+    /** How many of the samples, oldest first, came before the trigger.*/
+    [[nodiscard]] auto trigger_index() const -> size_t {
+        return _count - _recorded_after_trigger;
+    }
+    /** A sample by age, oldest first.*/
+    [[nodiscard]] auto at(size_t index) const -> const Sample& {
+        return _samples.at((_next + Capacity - _count + index) % Capacity);
+    }
+
+  private:
+    std::array<Sample, Capacity> _samples = {};
+    std::atomic<Status> _status = Status::IDLE;
+    uint16_t _period_ticks = 1;
+    uint16_t _ticks_to_sample = 0;
+    size_t _post_trigger = 0;
+    size_t _next = 0;
+    size_t _count = 0;
+    size_t _recorded_after_trigger = 0;
+};
+
+// Enough for half a second at the full 1 kHz rate, or a whole ramp or
+// spin-down at a lower one
+static constexpr size_t MOTOR_CAPTURE_SAMPLES = 512;
+using MotorCapture = Capture<MOTOR_CAPTURE_SAMPLES>;
+
+}  // namespace motor_telemetry
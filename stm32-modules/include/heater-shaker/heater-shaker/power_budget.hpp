@@ -0,0 +1,33 @@
+/**
+ * The heater-shaker pad heater and shaker motor share one supply. This file
+ * names them as consumers of the shared power budget and holds their
+ * nominal power figures.
+ */
+#pragma once
+
+#include <cstddef>
+
+#include "core/power_budget.hpp"
+
+namespace power {
+
+/** Consumers of the supply, in priority order. The motor is served first
+ * since starving it would stall the shake; the heater gets what is left.*/
+enum Consumer : size_t {
+    MOTOR = 0,
+    HEATER = 1,
+    CONSUMER_COUNT = 2,
+};
+
+// The supply has not been measured under a combined heat and shake load, so
+// the budget starts without a supply limit (see tasks::Tasks) until one is
+// set with M998; until then the figures below only scale the demands
+static constexpr double MOTOR_MAX_WATTS = 40.0;
+static constexpr double HEATER_MAX_WATTS = 80.0;
+// Motor demand is estimated from its target speed, reaching the full
+// figure at this speed
+static constexpr double MOTOR_FULL_POWER_RPM = 3000.0;
+
+using Budget = PowerBudget<CONSUMER_COUNT>;
+
+}  // namespace power
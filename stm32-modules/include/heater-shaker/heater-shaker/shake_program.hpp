@@ -0,0 +1,93 @@
+/*
+ * A shake program is a list of segments that the motor task runs back to
+ * back, so that a mix doesn't depend on the host's timing. Each segment
+ * ramps to a speed at its own rate and then holds it for a dwell time, and
+ * may change the heater setpoint as it starts.
+ *
+ * A segment with a repeat count closes a block: once it finishes, the
+ * program goes back to the segment just after the previous segment with a
+ * repeat count (or to the start), until the block has run repeats more
+ * times. Blocks follow one another; they don't nest.
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace shake_program {
+
+struct Segment {
+    int16_t rpm;
+    int32_t ramp_rpm_per_s;
+    uint32_t dwell_ms;
+    uint16_t repeats = 0;
+    // Heater setpoint to apply as the segment starts
+    std::optional<double> temperature = std::nullopt;
+};
+
+template <size_t Capacity>
+class Program {
+  public:
+    static constexpr size_t capacity = Capacity;
+
+    /** Add a segment to the end; false if the program is full.*/
+    auto add(const Segment& segment) -> bool {
+        if (_count == Capacity) {
+            return false;
+        }
+        _segments.at(_count) = segment;
+        ++_count;
+        return true;
+    }
+
+    auto clear() -> void {
+        _count = 0;
+        _index = 0;
+    }
+
+    [[nodiscard]] auto size() const -> size_t { return _count; }
+    [[nodiscard]] auto empty() const -> bool { return _count == 0; }
+
+    /** Go back to the first segment with every repeat count reset.*/
+    auto restart() -> void {
+        _index = 0;
+        for (size_t i = 0; i < _count; ++i) {
+            _repeats_left.at(i) = _segments.at(i).repeats;
+        }
+    }
+
+    [[nodiscard]] auto index() const -> size_t { return _index; }
+    [[nodiscard]] auto current() const -> const Segment& {
+        return _segments.at(_index);
+    }
+
+    /** Move on from the current segment; false once the program is done.*/
+    auto advance() -> bool {
+        if (_repeats_left.at(_index) > 0) {
+            --_repeats_left.at(_index);
+            _index = block_start(_index);
+            return true;
+        }
+        ++_index;
+        return _index < _count;
+    }
+
+  private:
+    [[nodiscard]] auto block_start(size_t block_end) const -> size_t {
+        for (size_t i = block_end; i > 0; --i) {
+            if (_segments.at(i - 1).repeats > 0) {
+                return i;
+            }
+        }
+        return 0;
+    }
+
+    std::array<Segment, Capacity> _segments = {};
+    std::array<uint16_t, Capacity> _repeats_left = {};
+    size_t _count = 0;
+    size_t _index = 0;
+};
+
+}  // namespace shake_program
@@ -0,0 +1,208 @@
+/*
+ * Speeds the shaker must not hold. Some labware and plate adapters resonate
+ * at particular speeds, and dwelling there makes noise, walks the plate and
+ * strains the plate lock. A band forbids the speeds strictly between its
+ * edges; the edges themselves are fine. Overlapping bands are merged as they
+ * are added, so the table stays sorted and disjoint.
+ *
+ * A change of speed that has to pass through bands is split into legs:
+ * ordinary ramps up to and away from each band, and a crossing leg from one
+ * edge of each band to the other, to be run as fast as the motor allows.
+ *
+ * The table packs into a few 64-bit words so it can be kept in flash.
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace skip_bands {
+
+struct Band {
+    int16_t low_rpm;
+    int16_t high_rpm;
+};
+
+struct Leg {
+    // Speed at the end of the leg
+    int16_t rpm;
+    // Whether the leg crosses a band
+    bool crossing;
+};
+
+template <size_t Capacity>
+class SkipBands {
+  public:
+    static constexpr size_t capacity = Capacity;
+    // An ordinary leg before each band, the crossing, and one after the last
+    static constexpr size_t MAX_LEGS = 2 * Capacity + 1;
+    // A header word, then two bands to a word
+    static constexpr size_t STORED_WORDS = 1 + (Capacity + 1) / 2;
+    using Legs = std::array<Leg, MAX_LEGS>;
+    using Stored = std::array<uint64_t, STORED_WORDS>;
+
+    [[nodiscard]] static auto valid(const Band& band) -> bool {
+        return (band.low_rpm >= 0) && (band.low_rpm < band.high_rpm);
+    }
+
+    /**
+     * Add a band, merging it with any it overlaps.
+     * @return false, changing nothing, if the band is invalid or there's no
+     * room for it
+     */
+    auto add(Band band) -> bool {
+        if (!valid(band)) {
+            return false;
+        }
+        std::array<Band, Capacity> merged{};
+        size_t count = 0;
+        bool placed = false;
+        for (size_t i = 0; i < _count; ++i) {
+            const auto& existing = _bands.at(i);
+            if ((existing.low_rpm < band.high_rpm) &&
+                (band.low_rpm < existing.high_rpm)) {
+                band.low_rpm = std::min(band.low_rpm, existing.low_rpm);
+                band.high_rpm = std::max(band.high_rpm, existing.high_rpm);
+                continue;
+            }
+            if (!placed && (band.high_rpm <= existing.low_rpm)) {
+                if (count == Capacity) {
+                    return false;
+                }
+                merged.at(count++) = band;
+                placed = true;
+            }
+            if (count == Capacity) {
+                return false;
+            }
+            merged.at(count++) = existing;
+        }
+        if (!placed) {
+            if (count == Capacity) {
+                return false;
+            }
+            merged.at(count++) = band;
+        }
+        _bands = merged;
+        _count = count;
+        return true;
+    }
+
+    auto clear() -> void { _count = 0; }
+
+    [[nodiscard]] auto size() const -> size_t { return _count; }
+    [[nodiscard]] auto empty() const -> bool { return _count == 0; }
+    /** Bands in order of speed.*/
+    [[nodiscard]] auto at(size_t index) const -> const Band& {
+        return _bands.at(index);
+    }
+
+    /** Whether a speed is inside a band.*/
+    [[nodiscard]] auto contains(int16_t rpm) const -> bool {
+        return std::any_of(_bands.cbegin(), _bands.cbegin() + _count,
+                           [rpm](const Band& band) {
+                               return (band.low_rpm < rpm) &&
+                                      (rpm < band.high_rpm);
+                           });
+    }
+
+    /** Whether changing between two speeds passes through any band.*/
+    [[nodiscard]] auto crosses(int16_t from_rpm, int16_t to_rpm) const
+        -> bool {
+        const auto low = std::min(from_rpm, to_rpm);
+        const auto high = std::max(from_rpm, to_rpm);
+        return std::any_of(_bands.cbegin(), _bands.cbegin() + _count,
+                           [low, high](const Band& band) {
+                               return (band.low_rpm < high) &&
+                                      (low < band.high_rpm);
+                           });
+    }
+
+    /**
+     * Split a change of speed into legs, in the order to run them. A change
+     * that starts inside a band crosses the rest of it first.
+     * @return the number of legs written, at least one
+     */
+    auto legs(int16_t from_rpm, int16_t to_rpm, Legs& out) const -> size_t {
+        size_t count = 0;
+        int16_t at_rpm = from_rpm;
+        auto cross = [&](int16_t entry_rpm, int16_t exit_rpm) {
+            if (entry_rpm != at_rpm) {
+                out.at(count++) = Leg{.rpm = entry_rpm, .crossing = false};
+            }
+            out.at(count++) = Leg{.rpm = exit_rpm, .crossing = true};
+            at_rpm = exit_rpm;
+        };
+        if (from_rpm <= to_rpm) {
+            for (size_t i = 0; i < _count; ++i) {
+                const auto& band = _bands.at(i);
+                if ((band.low_rpm < to_rpm) && (from_rpm < band.high_rpm)) {
+                    cross(std::max(from_rpm, band.low_rpm),
+                          std::min(to_rpm, band.high_rpm));
+                }
+            }
+        } else {
+            for (size_t i = _count; i > 0; --i) {
+                const auto& band = _bands.at(i - 1);
+                if ((band.low_rpm < from_rpm) && (to_rpm < band.high_rpm)) {
+                    cross(std::min(from_rpm, band.high_rpm),
+                          std::max(to_rpm, band.low_rpm));
+                }
+            }
+        }
+        if ((count == 0) || (at_rpm != to_rpm)) {
+            out.at(count++) = Leg{.rpm = to_rpm, .crossing = false};
+        }
+        return count;
+    }
+
+    [[nodiscard]] auto store() const -> Stored {
+        Stored words{};
+        words.at(0) = (static_cast<uint64_t>(STORED_MAGIC) << 32) | _count;
+        for (size_t i = 0; i < _count; ++i) {
+            const auto& band = _bands.at(i);
+            const uint64_t packed =
+                static_cast<uint16_t>(band.low_rpm) |
+                (static_cast<uint32_t>(static_cast<uint16_t>(band.high_rpm))
+                 << 16);
+            words.at(1 + i / 2) |= packed << (32 * (i % 2));
+        }
+        return words;
+    }
+
+    /**
+     * Load a table written by store().
+     * @return false, leaving the table empty, if the words don't hold one
+     * (such as erased flash)
+     */
+    auto restore(const Stored& words) -> bool {
+        clear();
+        const auto header = words.at(0);
+        const auto count = static_cast<size_t>(header & UINT32_MAX);
+        if (((header >> 32) != STORED_MAGIC) || (count > Capacity)) {
+            return false;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            const auto packed =
+                static_cast<uint32_t>(words.at(1 + i / 2) >> (32 * (i % 2)));
+            if (!add(Band{.low_rpm = static_cast<int16_t>(packed & UINT16_MAX),
+                          .high_rpm = static_cast<int16_t>(packed >> 16)})) {
+                clear();
+                return false;
+            }
+        }
+        return true;
+    }
+
+  private:
+    static constexpr uint32_t STORED_MAGIC = 0x534b4244;
+    std::array<Band, Capacity> _bands = {};
+    size_t _count = 0;
+};
+
+static constexpr size_t MOTOR_SKIP_BANDS = 8;
+using MotorSkipBands = SkipBands<MOTOR_SKIP_BANDS>;
+
+}  // namespace skip_bands
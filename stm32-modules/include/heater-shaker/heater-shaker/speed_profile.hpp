@@ -0,0 +1,97 @@
+/*
+ * A jerk-limited ("S-curve") change of speed. A linear ramp steps straight
+ * to its full acceleration and back off again, which kicks the plate and
+ * can slosh liquid out of the wells. An S-curve instead ramps the
+ * acceleration up at the jerk limit, holds it at the acceleration limit if
+ * there is time to, and ramps it back down so that it reaches zero just as
+ * the speed reaches the target. Changes too small to reach the
+ * acceleration limit peak partway and ramp straight back down.
+ *
+ * The profile is a function of the time since the change started. The motor
+ * task samples it to give the motor driver a series of short linear ramps.
+ */
+#pragma once
+
+#include <cmath>
+
+namespace speed_profile {
+
+class SCurve {
+  public:
+    /**
+     * @param start_rpm Speed at the start of the change
+     * @param target_rpm Speed at the end of the change
+     * @param accel_rpm_per_s Acceleration limit
+     * @param jerk_rpm_per_s2 Jerk limit
+     *
+     * A limit that isn't positive makes the change instant.
+     */
+    SCurve(double start_rpm, double target_rpm, double accel_rpm_per_s,
+           double jerk_rpm_per_s2)
+        : _start_rpm(start_rpm),
+          _target_rpm(target_rpm),
+          _change_rpm(std::abs(target_rpm - start_rpm)),
+          _jerk(jerk_rpm_per_s2) {
+        if ((accel_rpm_per_s <= 0) || (jerk_rpm_per_s2 <= 0)) {
+            return;
+        }
+        if (_change_rpm * jerk_rpm_per_s2 <
+            accel_rpm_per_s * accel_rpm_per_s) {
+            // Never reaches the acceleration limit
+            _jerk_time_s = std::sqrt(_change_rpm / jerk_rpm_per_s2);
+            _hold_time_s = 0;
+        } else {
+            _jerk_time_s = accel_rpm_per_s / jerk_rpm_per_s2;
+            _hold_time_s = _change_rpm / accel_rpm_per_s - _jerk_time_s;
+        }
+    }
+
+    [[nodiscard]] auto start_rpm() const -> double { return _start_rpm; }
+    [[nodiscard]] auto target_rpm() const -> double { return _target_rpm; }
+
+    /** Time the whole change takes.*/
+    [[nodiscard]] auto duration_s() const -> double {
+        return 2 * _jerk_time_s + _hold_time_s;
+    }
+
+    /** Highest acceleration reached on the way.*/
+    [[nodiscard]] auto peak_accel_rpm_per_s() const -> double {
+        return _jerk * _jerk_time_s;
+    }
+
+    /** The speed the given time after the change started.*/
+    [[nodiscard]] auto rpm_at(double time_s) const -> double {
+        if (time_s <= 0) {
+            return _start_rpm;
+        }
+        const double duration = duration_s();
+        if (time_s >= duration) {
+            return _target_rpm;
+        }
+        const double peak_accel = peak_accel_rpm_per_s();
+        double changed = 0;
+        if (time_s < _jerk_time_s) {
+            changed = _jerk * time_s * time_s / 2;
+        } else if (time_s < _jerk_time_s + _hold_time_s) {
+            changed = peak_accel * _jerk_time_s / 2 +
+                      peak_accel * (time_s - _jerk_time_s);
+        } else {
+            const double remaining = duration - time_s;
+            changed = _change_rpm - _jerk * remaining * remaining / 2;
+        }
+        return (_target_rpm < _start_rpm) ? _start_rpm - changed
+                                          : _start_rpm + changed;
+    }
+
+  private:
+    double _start_rpm;
+    double _target_rpm;
+    double _change_rpm;
+    double _jerk;
+    // Time spent ramping the acceleration up, and again ramping it down
+    double _jerk_time_s = 0;
+    // Time spent at the acceleration limit
+    double _hold_time_s = 0;
+};
+
+}  // namespace speed_profile
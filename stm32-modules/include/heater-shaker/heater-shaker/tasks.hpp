@@ -10,6 +10,7 @@
 #include "host_comms_task.hpp"
 #include "messages.hpp"
 #include "motor_task.hpp"
+#include "power_budget.hpp"
 #include "system_task.hpp"
 
 namespace motor_task {
@@ -83,5 +84,10 @@ struct Tasks {
     motor_task::MotorTask<QueueImpl>* motor;
     // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
     system_task::SystemTask<QueueImpl>* system;
+    // Shared between the motor and heater tasks, with no supply limit until
+    // M998 sets one
+    // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+    power::Budget power_budget{
+        {power::MOTOR_MAX_WATTS, power::HEATER_MAX_WATTS}};
 };
 }  // namespace tasks
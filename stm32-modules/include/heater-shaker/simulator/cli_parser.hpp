@@ -1,8 +1,24 @@
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "simulator/sim_driver.hpp"
 
 namespace cli_parser {
-std::shared_ptr<sim_driver::SimDriver> get_sim_driver(int, char**);
+struct SimOptions {
+    // One for each module to simulate
+    std::vector<std::shared_ptr<sim_driver::SimDriver>> drivers;
+    // Standard deviation of simulated heater thermistor noise, in degrees C
+    double heater_noise_c;
+    // How many times faster than real time the simulator clock runs, or
+    // sim_clock::SimClock::AS_FAST_AS_POSSIBLE
+    double speed;
+    // Run the tasks on the cooperative scheduler, with this seed
+    bool cooperative;
+    uint32_t seed;
+    // How many cooperative scheduler threads the modules share
+    uint32_t workers;
+};
+SimOptions get_sim_options(int, char**);
 }
\ No newline at end of file
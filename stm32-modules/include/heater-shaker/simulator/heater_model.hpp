@@ -0,0 +1,92 @@
+/*
+ * A first-order-plus-dead-time model of the heater plate, for the simulator
+ * to close the heater control loop around.
+ *
+ * Heater power shows up at the plate after a dead time, and the plate then
+ * settles exponentially towards ambient plus a fixed rise per unit of
+ * power. The board warms the same way, less and more quickly, from the
+ * power being switched through it. The constants give heat-up times close
+ * to the real module's.
+ *
+ * The model steps by a fixed period, so the dead time is a whole number of
+ * steps. Steps use the exact solution of the first order response, so any
+ * period is stable.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace heater_model {
+
+class PlateModel {
+  public:
+    static constexpr double AMBIENT_C = 23.0;
+    // Plate rise above ambient with the heater held at full power
+    static constexpr double PLATE_GAIN_C = 110.0;
+    static constexpr double PLATE_TIME_CONSTANT_S = 400.0;
+    static constexpr double PLATE_DEAD_TIME_S = 8.0;
+    // Board rise above ambient with the heater held at full power
+    static constexpr double BOARD_GAIN_C = 15.0;
+    static constexpr double BOARD_TIME_CONSTANT_S = 120.0;
+
+    PlateModel() = delete;
+    /**
+     * @param step_s The time each step() covers, in seconds
+     * @param ambient_c Where the plate and board start, and settle with
+     * the heater off
+     */
+    explicit PlateModel(double step_s, double ambient_c = AMBIENT_C)
+        : _step_s(step_s),
+          _ambient_c(ambient_c),
+          _plate_c(ambient_c),
+          _board_c(ambient_c),
+          _delayed(std::max(static_cast<size_t>(
+                                std::lround(PLATE_DEAD_TIME_S / step_s)),
+                            static_cast<size_t>(1)),
+                   0.0) {}
+
+    /** @param power From 0 to 1*/
+    auto set_power(double power) -> void {
+        _power = std::clamp(power, 0.0, 1.0);
+    }
+
+    /** Advance the model by one step.*/
+    auto step() -> void {
+        // The power reaching the plate now is what was set a dead time ago
+        const auto plate_power = _delayed.at(_next);
+        _delayed.at(_next) = _power;
+        _next = (_next + 1) % _delayed.size();
+        _plate_c = settle(_plate_c, _ambient_c + PLATE_GAIN_C * plate_power,
+                          PLATE_TIME_CONSTANT_S);
+        _board_c = settle(_board_c, _ambient_c + BOARD_GAIN_C * _power,
+                          BOARD_TIME_CONSTANT_S);
+        _elapsed_s += _step_s;
+    }
+
+    [[nodiscard]] auto power() const -> double { return _power; }
+    [[nodiscard]] auto plate_c() const -> double { return _plate_c; }
+    [[nodiscard]] auto board_c() const -> double { return _board_c; }
+    [[nodiscard]] auto step_s() const -> double { return _step_s; }
+    /** Total time stepped, in seconds.*/
+    [[nodiscard]] auto elapsed_s() const -> double { return _elapsed_s; }
+
+  private:
+    [[nodiscard]] auto settle(double from_c, double to_c,
+                              double time_constant_s) const -> double {
+        return to_c + (from_c - to_c) * std::exp(-_step_s / time_constant_s);
+    }
+
+    double _step_s;
+    double _ambient_c;
+    double _power = 0;
+    double _plate_c;
+    double _board_c;
+    std::vector<double> _delayed;
+    size_t _next = 0;
+    double _elapsed_s = 0;
+};
+
+}  // namespace heater_model
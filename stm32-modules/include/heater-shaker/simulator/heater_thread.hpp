@@ -4,10 +4,23 @@
 
 #include "heater-shaker/heater_task.hpp"
 #include "heater-shaker/tasks.hpp"
+#include "simulator/scheduler.hpp"
 #include "simulator/simulator_queue.hpp"
 
 namespace heater_thread {
 using SimHeaterTask = heater_task::HeaterTask<SimulatorMessageQueue>;
 struct TaskControlBlock;
-auto build() -> tasks::Task<std::unique_ptr<std::jthread>, SimHeaterTask>;
+/**
+ * @param noise_c Standard deviation of the noise added to each simulated
+ * thermistor reading, in degrees C
+ */
+auto build(double noise_c = 0)
+    -> tasks::Task<std::unique_ptr<std::jthread>, SimHeaterTask>;
+/**
+ * Build the task to run on the cooperative scheduler instead of a thread of
+ * its own, in which case the handle is empty. The thermistors are read by a
+ * periodic action on the scheduler.
+ */
+auto build(scheduler::Scheduler& scheduler, double noise_c = 0)
+    -> tasks::Task<std::unique_ptr<std::jthread>, SimHeaterTask>;
 };  // namespace heater_thread
@@ -4,10 +4,17 @@
 
 #include "heater-shaker/motor_task.hpp"
 #include "heater-shaker/tasks.hpp"
+#include "simulator/scheduler.hpp"
 #include "simulator/simulator_queue.hpp"
 
 namespace motor_thread {
 using SimMotorTask = motor_task::MotorTask<SimulatorMessageQueue>;
 struct TaskControlBlock;
 auto build() -> tasks::Task<std::unique_ptr<std::jthread>, SimMotorTask>;
+/**
+ * Build the task to run on the cooperative scheduler instead of a thread of
+ * its own, in which case the handle is empty.
+ */
+auto build(scheduler::Scheduler& scheduler)
+    -> tasks::Task<std::unique_ptr<std::jthread>, SimMotorTask>;
 };  // namespace motor_thread
@@ -1,5 +1,12 @@
 #pragma once
+#include <atomic>
 #include <boost/asio.hpp>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
 
 #include "heater-shaker/host_comms_task.hpp"
 #include "heater-shaker/messages.hpp"
@@ -10,22 +17,91 @@
 namespace socket_sim_driver {
 
 struct AddressInfo {
-    std::string host;
+    std::string host{};
+    int port = 0;
+};
+
+/** Listen for clients on a port, instead of connecting out to a server.*/
+struct Listen {
     int port;
 };
 
+class Connection;
+
+/*
+ * Drives the simulator over TCP, either connecting out to a server or
+ * listening for clients, all on an asio io_context that read() runs.
+ *
+ * Each connection reads into a buffer of its own, and complete lines are
+ * handed to the comms task in place. A line stays in use until the comms
+ * task has finished with it; a connection whose buffer is full of lines in
+ * use stops reading, and the backpressure reaches the client through TCP.
+ *
+ * A listening driver serves one client at a time, and closes any other
+ * client that connects meanwhile: a response can be written long after
+ * the line that asked for it, and nothing ties it back to that line. To
+ * drive several modules in parallel, give each its own port (see
+ * --modules).
+ */
 class SocketSimDriver : public sim_driver::SimDriver {
     static const std::string name;
-    AddressInfo address_info;
-    std::unique_ptr<boost::asio::ip::tcp::socket> s;
 
   public:
-    SocketSimDriver(std::string);
+    /**
+     * Connect to the server at a url like socket://host:port
+     * @param port_offset Added to the port in the url, so that several
+     * modules can each connect on a port of their own
+     */
+    SocketSimDriver(std::string, int port_offset = 0);
+    /**
+     * Listen for a client. Port 0 listens on any free port, which
+     * get_port() gives once constructed.
+     * @param port_offset Added to the port to listen on, as above
+     */
+    SocketSimDriver(Listen listen, int port_offset = 0);
     const std::string& get_host() const;
     int get_port() const;
     const std::string& get_name() const;
 
     void write(const std::string& message);
+    /** Run until the server closes the connection, or forever listening.*/
     void read(tasks::Tasks<SimulatorMessageQueue>& tasks);
+    void comms_finished();
+    /** Stop serving, so that read() returns.*/
+    void stop();
+
+  private:
+    friend class Connection;
+    using Queue =
+        host_comms_task::HostCommsTask<SimulatorMessageQueue>::Queue;
+
+    auto accept() -> void;
+    /**
+     * Hand the comms task a line, if its queue has room.
+     * @return The line's count, to release it by once the task is done
+     */
+    auto send_line(const messages::IncomingMessageFromHost& line)
+        -> std::optional<uint64_t>;
+    auto release(uint64_t up_to) -> void;
+    auto remove(const std::shared_ptr<Connection>& connection) -> void;
+    auto comms_queue() -> Queue&;
+
+    AddressInfo address_info;
+    boost::asio::io_context io_context{};
+    std::unique_ptr<boost::asio::ip::tcp::acceptor> acceptor{};
+    std::list<std::shared_ptr<Connection>> connections{};
+    std::optional<boost::asio::executor_work_guard<
+        boost::asio::io_context::executor_type>>
+        work{};
+    std::atomic<tasks::Tasks<SimulatorMessageQueue>*> tasks{nullptr};
+    // Orders handing lines to the comms task against checking whether it's
+    // finished with them
+    std::mutex mutex{};
+    // How many lines have been handed to the comms task
+    uint64_t sent = 0;
+    // and how many it's known to have finished with
+    uint64_t finished = 0;
+    // Whether a connection has a line the comms queue had no room for
+    bool blocked = false;
 };
-}  // namespace socket_sim_driver
\ No newline at end of file
+}  // namespace socket_sim_driver
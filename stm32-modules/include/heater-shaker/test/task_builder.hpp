@@ -62,6 +62,22 @@ struct TaskBuilder {
 
     auto run_system_task() -> void { system_task.run_once(system_policy); }
 
+    // Stands in for the hardware firing the motor task's homing wakeup, if
+    // it is armed; returns whether it was
+    auto fire_homing_wakeup() -> bool;
+
+    // Stands in for the hardware firing the plate lock timeout, if it is
+    // armed; returns whether it was
+    auto fire_plate_lock_timeout() -> bool;
+
+    // Stands in for the hardware firing the speed profile wakeup, if it is
+    // armed; returns whether it was
+    auto fire_speed_profile_wakeup() -> bool;
+
+    // Stands in for the hardware firing the shake program wakeup, if it is
+    // armed; returns whether it was
+    auto fire_shake_program_wakeup() -> bool;
+
   private:
     TaskBuilder();
     TestMessageQueue<host_comms_task::Message> host_comms_queue;
@@ -2,6 +2,9 @@
 #include <cstdint>
 
 #include "heater-shaker/errors.hpp"
+#include "heater-shaker/loop_timing.hpp"
+#include "heater-shaker/motor_telemetry.hpp"
+#include "heater-shaker/skip_bands.hpp"
 
 class TestMotorPolicy {
   public:
@@ -10,9 +13,13 @@ class TestMotorPolicy {
                     int32_t initial_ramp_rate);
     ~TestMotorPolicy() = default;
     auto set_rpm(int16_t rpm) -> errors::ErrorCode;
+    [[nodiscard]] auto validate_rpm(int16_t rpm) const -> errors::ErrorCode;
+    auto set_rpm_segment(int16_t rpm, uint16_t ramp_ticks) -> errors::ErrorCode;
     [[nodiscard]] auto get_current_rpm() const -> int16_t;
     [[nodiscard]] auto get_target_rpm() const -> int16_t;
     auto set_ramp_rate(int32_t new_ramp_rate) -> errors::ErrorCode;
+    [[nodiscard]] auto validate_ramp_rate(int32_t new_ramp_rate) const
+        -> errors::ErrorCode;
     auto stop() -> void;
 
     auto homing_solenoid_disengage() -> void;
@@ -20,28 +27,71 @@ class TestMotorPolicy {
 
     auto delay_ticks(uint16_t ticks) -> void;
 
+    auto homing_wakeup_arm(uint16_t ticks, int16_t low_rpm, int16_t high_rpm)
+        -> void;
+    auto homing_wakeup_disarm() -> void;
+    auto speed_profile_wakeup_arm(uint16_t ticks) -> void;
+    auto speed_profile_wakeup_disarm() -> void;
+    auto shake_program_wakeup_arm(uint16_t ticks, uint32_t generation)
+        -> void;
+    auto shake_program_wakeup_disarm() -> void;
+
     auto plate_lock_set_power(float power) -> void;
     auto plate_lock_disable() -> void;
     auto plate_lock_brake() -> void;
+    auto plate_lock_timeout_arm(uint16_t ticks) -> void;
+    auto plate_lock_timeout_disarm() -> void;
 
     [[nodiscard]] auto test_solenoid_engaged() const -> bool;
     [[nodiscard]] auto test_solenoid_current() const -> uint16_t;
 
     auto set_pid_constants(double kp, double ki, double kd) -> void;
 
+    auto motor_capture() -> motor_telemetry::MotorCapture&;
+    [[nodiscard]] auto get_loop_timing() const -> loop_timing::MotorLoopTiming;
+    auto reset_loop_timing() -> void;
+    [[nodiscard]] auto read_skip_bands() const
+        -> skip_bands::MotorSkipBands::Stored;
+    auto write_skip_bands(const skip_bands::MotorSkipBands::Stored& words)
+        -> bool;
+
     auto test_set_current_rpm(int16_t current_rpm) -> void;
     [[nodiscard]] auto test_get_ramp_rate() -> int32_t;
 
     auto test_set_rpm_return_code(errors::ErrorCode code) -> void;
     auto test_set_ramp_rate_return_code(errors::ErrorCode code) -> void;
     [[nodiscard]] auto test_get_last_delay() const -> uint16_t;
+    [[nodiscard]] auto test_homing_wakeup_armed() const -> bool;
+    [[nodiscard]] auto test_homing_wakeup_ticks() const -> uint16_t;
+    [[nodiscard]] auto test_homing_wakeup_low_rpm() const -> int16_t;
+    [[nodiscard]] auto test_homing_wakeup_high_rpm() const -> int16_t;
+    [[nodiscard]] auto test_speed_profile_wakeup_armed() const -> bool;
+    [[nodiscard]] auto test_speed_profile_wakeup_ticks() const -> uint16_t;
+    [[nodiscard]] auto test_shake_program_wakeup_armed() const -> bool;
+    [[nodiscard]] auto test_shake_program_wakeup_ticks() const -> uint16_t;
+    [[nodiscard]] auto test_shake_program_wakeup_generation() const
+        -> uint32_t;
+    // Ramp time of the last set_rpm_segment; 0 if set_rpm was called since
+    [[nodiscard]] auto test_get_segment_ticks() const -> uint16_t;
 
     [[nodiscard]] auto test_plate_lock_get_power() const -> float;
     [[nodiscard]] auto test_plate_lock_enabled() const -> bool;
     [[nodiscard]] auto test_plate_lock_braked() const -> bool;
+    [[nodiscard]] auto test_plate_lock_timeout_armed() const -> bool;
+    [[nodiscard]] auto test_plate_lock_timeout_ticks() const -> uint16_t;
     [[nodiscard]] auto plate_lock_open_sensor_read() const -> bool;
     [[nodiscard]] auto plate_lock_closed_sensor_read() const -> bool;
 
+    auto test_set_loop_timing(const loop_timing::MotorLoopTiming& timing)
+        -> void;
+    [[nodiscard]] auto test_loop_timing_resets() const -> uint32_t;
+    // Starts out like erased flash
+    auto test_set_stored_skip_bands(
+        const skip_bands::MotorSkipBands::Stored& words) -> void;
+    [[nodiscard]] auto test_stored_skip_bands() const
+        -> skip_bands::MotorSkipBands::Stored;
+    auto test_set_write_skip_bands_return(bool ok) -> void;
+
     [[nodiscard]] auto test_get_overridden_ki() const -> double;
     [[nodiscard]] auto test_get_overridden_kp() const -> double;
     [[nodiscard]] auto test_get_overridden_kd() const -> double;
@@ -55,10 +105,27 @@ class TestMotorPolicy {
     bool solenoid_engaged = false;
     uint16_t solenoid_current = 0;
     uint16_t last_delay = 0;
+    bool homing_wakeup_armed = false;
+    uint16_t homing_wakeup_ticks = 0;
+    int16_t homing_wakeup_low_rpm = 0;
+    int16_t homing_wakeup_high_rpm = 0;
+    bool speed_profile_wakeup_armed = false;
+    uint16_t speed_profile_wakeup_ticks = 0;
+    bool shake_program_wakeup_armed = false;
+    uint16_t shake_program_wakeup_ticks = 0;
+    uint32_t shake_program_wakeup_generation = 0;
+    uint16_t segment_ticks = 0;
     float plate_lock_power = 0;
     bool plate_lock_enabled = false;
     double overridden_ki = 0.0;
     double overridden_kp = 0.0;
     double overridden_kd = 0.0;
     bool plate_lock_braked = false;
+    bool plate_lock_timeout_armed = false;
+    uint16_t plate_lock_timeout_ticks = 0;
+    motor_telemetry::MotorCapture capture{};
+    loop_timing::MotorLoopTiming timing{};
+    uint32_t loop_timing_resets = 0;
+    skip_bands::MotorSkipBands::Stored stored_skip_bands{};
+    bool write_skip_bands_return = true;
 };
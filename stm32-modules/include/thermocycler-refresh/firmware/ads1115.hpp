@@ -6,7 +6,9 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <span>
 #include <variant>
 
 #include "firmware/thermal_hardware.h"
@@ -19,9 +21,66 @@ enum class Error {
     ADCInit     /**< ADC is not initialized.*/
 };
 
+/**
+ * Conversion rates the ADC supports, in samples per second. Slower rates
+ * average over a longer window inside the ADC and so are less noisy.
+ */
+enum class DataRate : uint16_t {
+    SPS_8 = 0,
+    SPS_16 = 1,
+    SPS_32 = 2,
+    SPS_64 = 3,
+    SPS_128 = 4,
+    SPS_250 = 5,
+    SPS_475 = 6,
+    SPS_860 = 7
+};
+
+/**
+ * @brief Get how long a single conversion takes at a data rate.
+ * @param[in] rate The data rate
+ * @return The conversion time in microseconds, rounded up
+ */
+constexpr auto conversion_time_us(DataRate rate) -> uint32_t {
+    switch (rate) {
+        case DataRate::SPS_8:
+            return 125000;
+        case DataRate::SPS_16:
+            return 62500;
+        case DataRate::SPS_32:
+            return 31250;
+        case DataRate::SPS_64:
+            return 15625;
+        case DataRate::SPS_128:
+            return 7813;
+        case DataRate::SPS_250:
+            return 4000;
+        case DataRate::SPS_475:
+            return 2106;
+        case DataRate::SPS_860:
+        default:
+            return 1163;
+    }
+}
+
+/** A conversion result from a scan, along with when it was taken.*/
+struct Sample {
+    uint16_t value;        /**< ADC counts*/
+    uint32_t timestamp_us; /**< From thermal_hardware_timestamp_us*/
+};
+
+class ADC;
+
+/** One conversion in a scan: which ADC, and which of its pins.*/
+struct ScanEntry {
+    ADC *adc;
+    uint16_t pin;
+};
+
 class ADC {
   public:
     using ReadVal = std::variant<uint16_t, Error>;
+    using SampleVal = std::variant<Sample, Error>;
 
     ADC() = delete;
     /**
@@ -50,12 +109,61 @@ class ADC {
      */
     auto read(uint16_t pin) -> ReadVal;
 
+    /**
+     * @brief Set the data rate used by every following conversion on this
+     * ADC, through any ADC object with the same ID. Defaults to 250 SPS.
+     * @note Thread safe
+     * @warning Only call this from a FreeRTOS thread context.
+     * @param[in] rate The new data rate
+     */
+    void set_data_rate(DataRate rate);
+
+    /**
+     * @brief Run a set of conversions, possibly across several ADCs, as
+     * one scan. Each ADC converts its own pins in order, at the same time as
+     * the other ADCs, and the calling thread only wakes up once the whole
+     * scan is done. Results land in each ADC's sample buffer and can be
+     * fetched with \ref last_sample.
+     * @note Thread safe
+     * @warning Only call this from a FreeRTOS thread context.
+     * @param[in] entries The conversions to run, in order. At most
+     * \ref max_scan_length.
+     * @param[in] oversample How many conversions to average for each entry,
+     * in the range [1, \ref max_oversample]. The timestamp of each result is
+     * that of its last conversion.
+     * @return True if every conversion succeeded. Conversions that failed
+     * are reported as errors by \ref last_sample.
+     */
+    static auto scan(std::span<const ScanEntry> entries, uint8_t oversample = 1)
+        -> bool;
+
+    /** The most conversions that a scan can average for one entry.*/
+    static constexpr uint8_t max_oversample = 16;
+
+    /**
+     * @brief Get the result of the last scan that included a pin.
+     * @note Thread safe
+     * @warning Only call this from a FreeRTOS thread context.
+     * @param[in] pin The pin to get. Must be a value in the range
+     * [0, \ref pin_count)
+     * @return The sample, or an error if the last conversion of this pin
+     * failed or the pin has never been scanned.
+     */
+    auto last_sample(uint16_t pin) -> SampleVal;
+
     /**
      * @brief Check if this ADC is initialized
      * @return True if initialized, false if not.
      */
     auto initialized() -> bool;
 
+    /**
+     * @brief Forget the setup of every ADC, as if the board had just been
+     * reset, so that each one has to be initialized again.
+     * @warning Only for host tests. Call it while no thread uses an ADC.
+     */
+    static void reset_all();
+
   private:
     uint8_t _addr;
     ADC_ITR_T _id;
@@ -63,6 +171,8 @@ class ADC {
 
     auto get_lock() -> bool;
     auto release_lock() -> bool;
+    /** The config register value that starts a conversion of a pin.*/
+    auto start_config(uint16_t pin) -> uint16_t;
 
     static constexpr uint8_t conversion_addr = 0x00;
     static constexpr uint8_t config_addr = 0x01;
@@ -72,22 +182,32 @@ class ADC {
     static constexpr uint16_t lo_thresh_default = 0x0000;
     /** Need to write this to enable RDY pin.*/
     static constexpr uint16_t hi_thresh_default = 0x8000;
-    /** Not the startup default, but the value to write on startup.
+    /** Not the startup default, but the value to write on startup, before
+     * the data rate is added in.
      * - Input will be from AINx to GND instead of differential
      * - Gain amplifier is set to +/- 2.048 V
      * - Single shot mode
-     * - Data rate is 250 SPS
      * - Default comparator values, except for enabling the ALERT/RDY pin
      */
-    static constexpr uint16_t config_default = 0x45A0;
+    static constexpr uint16_t config_default = 0x4500;
+    /** Shift the data rate setting by this many bits to set the rate.*/
+    static constexpr uint16_t config_data_rate_shift = 5;
+    static constexpr DataRate default_data_rate = DataRate::SPS_250;
     /** Set this bit to start a read.*/
     static constexpr uint16_t config_start_read = 0x8000;
     /** Shift the pin setting by this many bits to set the input pin.*/
     static constexpr uint16_t config_mux_shift = 12;
     /** Number of pins on the ADC.*/
     static constexpr uint16_t pin_count = 4;
+    /** The longest scan that can be run at once: every pin of every ADC.*/
+    static constexpr size_t max_scan_length = ADC_ITR_NUM * pin_count;
+
+    friend struct adc_hardware;
     /** Maximum time to wait for the semaphor, in milliseconds.*/
     static constexpr int max_semaphor_wait = 400;
+    /** Time allowed for each conversion of a scan on top of the
+     * conversion time itself, in milliseconds.*/
+    static constexpr uint32_t max_scan_step_wait = 10;
 };
 
 }  // namespace ADS1115
@@ -3,7 +3,10 @@
  */
 #pragma once
 
+#include <cstdint>
+
 #include "FreeRTOS.h"
+#include "core/adc_filter.hpp"
 #include "firmware/freertos_message_queue.hpp"
 #include "task.h"
 #include "thermocycler-refresh/tasks.hpp"
@@ -13,4 +16,11 @@ namespace thermal_plate_control_task {
 auto start()
     -> tasks::Task<TaskHandle_t,
                    thermal_plate_task::ThermalPlateTask<FreeRTOSMessageQueue>>;
+/**
+ * Change how the plate thermistors are sampled, from the next scan on.
+ * @return False, changing nothing, if the data rate isn't one the ADCs
+ * have or the scan wouldn't fit in a control period
+ */
+auto set_acquisition(uint16_t data_rate_sps, uint8_t oversample,
+                     AdcFilter::Mode filter, double filter_alpha) -> bool;
 }  // namespace thermal_plate_control_task
@@ -17,6 +17,47 @@ typedef enum { ADC_FRONT = ADC1_ITR, ADC_REAR = ADC2_ITR } ADC_ID_t;
 
 #define ADC_ITR_NUM (2)
 
+/** Result of one step in an ADC scan.*/
+typedef struct {
+    /** The conversion result read back from the ADC, averaged over every
+     * conversion of the step.*/
+    uint16_t value;
+    /** When the ADC signalled the last conversion of the step was ready,
+     * from \ref thermal_hardware_timestamp_us.*/
+    uint32_t timestamp_us;
+    /** Only true if the conversion was read back successfully.*/
+    bool valid;
+} thermal_adc_sample_t;
+
+/**
+ * One step in an ADC scan: write \c start_val to \c start_reg,
+ * wait for the ADC's READY pin, then read back \c result_reg. This is
+ * repeated \c samples times and the results are averaged.
+ */
+typedef struct {
+    uint16_t addr;
+    ADC_ITR_T id;
+    uint8_t start_reg;
+    uint16_t start_val;
+    uint8_t result_reg;
+    /** Conversions to average; 0 is treated as 1*/
+    uint8_t samples;
+    thermal_adc_sample_t *result;
+} thermal_adc_scan_step_t;
+
+/** Direction of one transfer in an I2C batch.*/
+typedef enum { THERMAL_I2C_WRITE, THERMAL_I2C_READ } thermal_i2c_op_t;
+
+/** One 16-bit register access in an I2C batch.*/
+typedef struct {
+    thermal_i2c_op_t op;
+    uint16_t addr;
+    uint8_t reg;
+    /** The value to write, or where a read's value is stored. The MSB is
+     * the first byte on the bus.*/
+    uint16_t value;
+} thermal_i2c_transfer_t;
+
 /**
  * Initializes all thermal hardware. Sets a static, thread-safe
  * variable to indicate completion to thermal_hardware_wait_for_init
@@ -53,13 +94,45 @@ bool thermal_i2c_write_16(uint16_t addr, uint8_t reg, uint16_t val);
  * @return true on success, false  on error
  */
 bool thermal_i2c_read_16(uint16_t addr, uint8_t reg, uint16_t *val);
+/**
+ * @brief Runs a list of 16-bit register reads and writes back to back. Each
+ * transfer is started from the interrupt that finished the one before it,
+ * so the calling task is only woken once, when the whole batch is done.
+ * @note Thread safe
+ * @warning This function should \e only be called from a FreeRTOS
+ * task context! It relies on a mutex to lock the commmunication!
+ * @param[in,out] transfers The transfers to run, in order. Reads store
+ * their result in the transfer's \c value.
+ * @param[in] count The number of transfers
+ * @return true if every transfer succeeded, false if any failed. The
+ * batch stops at the first failure.
+ */
+bool thermal_i2c_batch(thermal_i2c_transfer_t *transfers, uint8_t count);
+
+/**
+ * @brief Runs a list of ADC conversions from interrupt context, so the
+ * calling task is only woken once, when the whole scan is done. Each ADC
+ * works through its own steps in order, starting each conversion from the
+ * interrupt that finished its previous one. Different ADCs convert at the
+ * same time and only take turns for the I2C transfers.
+ * @note Thread safe. The I2C bus is held for the whole scan, so no other
+ * thread may use it until the scan finishes.
+ * @warning Only call this from a FreeRTOS thread context. The caller must
+ * hold the locks of every ADC in the scan.
+ * @param[in] steps The conversions to run, in order. Every step's result
+ * is marked invalid before the scan starts.
+ * @param[in] count The number of steps
+ * @param[in] timeout_ms How long to wait for the whole scan
+ * @return true if every conversion was read back, false otherwise
+ */
+bool thermal_adc_scan(const thermal_adc_scan_step_t *steps, uint8_t count,
+                      uint32_t timeout_ms);
 
 /**
- * @brief Configures one of the ADC Alert monitoring pins to be ready
- * to signal the correct task after a conversion-complete signals is raised.
- * @param[in] id The ADC to arm the callback for.
+ * @brief Returns a free running microsecond count. It wraps around
+ * every ~71 minutes, so only differences between timestamps are meaningful.
  */
-bool thermal_arm_adc_for_read(ADC_ITR_T id);
+uint32_t thermal_hardware_timestamp_us(void);
 
 /**
  * @brief Callback when an ADC READY pin interrupt is triggered (falling edge)
@@ -5,6 +5,9 @@
  */
 #pragma once
 
+#include <cstdint>
+
+#include "core/adc_filter.hpp"
 #include "thermocycler-refresh/thermal_general.hpp"
 
 class ThermalPlatePolicy {
@@ -19,4 +22,7 @@ class ThermalPlatePolicy {
     auto get_peltier(PeltierID peltier) -> std::pair<PeltierDirection, double>;
 
     auto set_fan(double power) -> bool;
+
+    auto set_acquisition(uint16_t data_rate_sps, uint8_t oversample,
+                         AdcFilter::Mode filter, double filter_alpha) -> bool;
 };
@@ -3,6 +3,7 @@
 #include <thread>
 
 #include "simulator/sim_driver.hpp"
+#include "simulator/scheduler.hpp"
 #include "simulator/simulator_queue.hpp"
 #include "thermocycler-refresh/host_comms_task.hpp"
 #include "thermocycler-refresh/tasks.hpp"
@@ -12,6 +13,13 @@ using SimCommTask = host_comms_task::HostCommsTask<SimulatorMessageQueue>;
 struct TaskControlBlock;
 auto build(std::shared_ptr<sim_driver::SimDriver>&&)
     -> tasks::Task<std::unique_ptr<std::jthread>, SimCommTask>;
+/**
+ * Build the task to run on the cooperative scheduler instead of a thread of
+ * its own, in which case the handle is empty.
+ */
+auto build(std::shared_ptr<sim_driver::SimDriver>&&,
+           scheduler::Scheduler& scheduler)
+    -> tasks::Task<std::unique_ptr<std::jthread>, SimCommTask>;
 void handle_input(std::shared_ptr<sim_driver::SimDriver>&& driver,
                   tasks::Tasks<SimulatorMessageQueue>& tasks);
 };  // namespace comm_thread
@@ -0,0 +1,46 @@
+/*
+ * Host stand-in for FreeRTOS.h. Together with task.h and semphr.h in this
+ * directory, it lets firmware code that only needs task notifications,
+ * mutexes and critical sections run on host threads. See freertos_shim.cpp
+ * for the implementation.
+ */
+#ifndef SIM_FREERTOS_H__
+#define SIM_FREERTOS_H__
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint32_t StackType_t;
+
+#define pdTRUE ((BaseType_t)1)
+#define pdFALSE ((BaseType_t)0)
+#define pdPASS (pdTRUE)
+#define pdFAIL (pdFALSE)
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+/** Ticks are milliseconds of wall clock time, as on the board.*/
+#define configTICK_RATE_HZ ((TickType_t)1000)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+/** There's no scheduler to hand over to at the end of an interrupt.*/
+#define portYIELD_FROM_ISR(woken) ((void)(woken))
+
+#define configASSERT(x)                                      \
+    do {                                                     \
+        if (!(x)) {                                          \
+            sim_freertos_assert_failed(__FILE__, __LINE__);  \
+        }                                                    \
+    } while (0)
+
+/** Reports the failed assertion and aborts.*/
+void sim_freertos_assert_failed(const char *file, int line);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+#endif  // SIM_FREERTOS_H__
@@ -0,0 +1,36 @@
+/*
+ * Host stand-in for the FreeRTOS semaphore API. Only mutexes are
+ * supported. A StaticSemaphore_t owns a host semaphore, which is created
+ * by xSemaphoreCreateMutexStatic and freed by vSemaphoreDelete.
+ */
+#ifndef SIM_SEMPHR_H__
+#define SIM_SEMPHR_H__
+
+#include "FreeRTOS.h"
+// Like the real one, which gets the task API through queue.h
+#include "task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+typedef struct {
+    void *impl;
+} StaticSemaphore_t;
+typedef StaticSemaphore_t *SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t *buffer);
+void vSemaphoreDelete(SemaphoreHandle_t semaphore);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore,
+                          TickType_t ticks_to_wait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+BaseType_t xSemaphoreTakeFromISR(SemaphoreHandle_t semaphore,
+                                 BaseType_t *higher_priority_task_woken);
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore,
+                                 BaseType_t *higher_priority_task_woken);
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t semaphore);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+#endif  // SIM_SEMPHR_H__
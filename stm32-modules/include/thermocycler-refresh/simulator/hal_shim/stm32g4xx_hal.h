@@ -0,0 +1,182 @@
+/*
+ * Host stand-in for the parts of the STM32G4 HAL used by the thermal
+ * subsystem's I2C and ADC code. Peripheral setup calls succeed and do
+ * nothing. I2C transfers, the READY pin EXTI lines and the microsecond
+ * timestamp timer are backed by the emulated bus in
+ * simulator/thermal_bus_emulator.hpp, which calls the HAL completion
+ * callbacks the way the real interrupts would.
+ */
+#ifndef SIM_STM32G4XX_HAL_H__
+#define SIM_STM32G4XX_HAL_H__
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+#include <stdint.h>
+
+typedef enum {
+    HAL_OK = 0x00U,
+    HAL_ERROR = 0x01U,
+    HAL_BUSY = 0x02U,
+    HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+/** Peripherals are only told apart by these addresses.*/
+#define I2C2 ((void *)0x40005800UL)
+#define TIM2 ((void *)0x40000000UL)
+#define GPIOA ((void *)0x48000000UL)
+#define DMA1_Channel1 ((void *)0x40020008UL)
+#define DMA1_Channel2 ((void *)0x4002001CUL)
+
+typedef enum {
+    DMA1_Channel1_IRQn = 11,
+    DMA1_Channel2_IRQn = 12,
+    EXTI9_5_IRQn = 23,
+    I2C2_EV_IRQn = 33,
+    I2C2_ER_IRQn = 34,
+    EXTI15_10_IRQn = 40
+} IRQn_Type;
+
+typedef struct {
+    uint32_t Pin;
+    uint32_t Mode;
+    uint32_t Pull;
+    uint32_t Speed;
+    uint32_t Alternate;
+} GPIO_InitTypeDef;
+
+#define GPIO_PIN_9 ((uint16_t)0x0200)
+#define GPIO_PIN_10 ((uint16_t)0x0400)
+#define GPIO_MODE_IT_FALLING (0x10210000U)
+#define GPIO_PULLUP (0x00000001U)
+
+typedef struct {
+    uint32_t Request;
+    uint32_t Direction;
+    uint32_t PeriphInc;
+    uint32_t MemInc;
+    uint32_t PeriphDataAlignment;
+    uint32_t MemDataAlignment;
+    uint32_t Mode;
+    uint32_t Priority;
+} DMA_InitTypeDef;
+
+typedef struct __DMA_HandleTypeDef {
+    void *Instance;
+    DMA_InitTypeDef Init;
+    void *Parent;
+} DMA_HandleTypeDef;
+
+#define DMA_REQUEST_I2C2_RX (18U)
+#define DMA_REQUEST_I2C2_TX (19U)
+#define DMA_PERIPH_TO_MEMORY (0x00000000U)
+#define DMA_MEMORY_TO_PERIPH (0x00000010U)
+#define DMA_PINC_DISABLE (0x00000000U)
+#define DMA_MINC_ENABLE (0x00000080U)
+#define DMA_PDATAALIGN_BYTE (0x00000000U)
+#define DMA_MDATAALIGN_BYTE (0x00000000U)
+#define DMA_NORMAL (0x00000000U)
+#define DMA_PRIORITY_LOW (0x00000000U)
+
+typedef struct {
+    uint32_t Timing;
+    uint32_t OwnAddress1;
+    uint32_t AddressingMode;
+    uint32_t DualAddressMode;
+    uint32_t OwnAddress2;
+    uint32_t OwnAddress2Masks;
+    uint32_t GeneralCallMode;
+    uint32_t NoStretchMode;
+} I2C_InitTypeDef;
+
+typedef struct __I2C_HandleTypeDef {
+    void *Instance;
+    I2C_InitTypeDef Init;
+    DMA_HandleTypeDef *hdmatx;
+    DMA_HandleTypeDef *hdmarx;
+} I2C_HandleTypeDef;
+
+#define I2C_ADDRESSINGMODE_7BIT (0x00000001U)
+#define I2C_DUALADDRESS_DISABLE (0x00000000U)
+#define I2C_OA2_NOMASK (0x00U)
+#define I2C_GENERALCALL_DISABLE (0x00000000U)
+#define I2C_NOSTRETCH_DISABLE (0x00000000U)
+#define I2C_ANALOGFILTER_ENABLE (0x00000000U)
+#define I2C_FASTMODEPLUS_I2C2 (0x00200000U)
+
+typedef struct {
+    uint32_t Prescaler;
+    uint32_t CounterMode;
+    uint32_t Period;
+    uint32_t ClockDivision;
+    uint32_t RepetitionCounter;
+    uint32_t AutoReloadPreload;
+} TIM_Base_InitTypeDef;
+
+typedef struct {
+    void *Instance;
+    TIM_Base_InitTypeDef Init;
+} TIM_HandleTypeDef;
+
+#define TIM_COUNTERMODE_UP (0x00000000U)
+#define TIM_CLOCKDIVISION_DIV1 (0x00000000U)
+#define TIM_AUTORELOAD_PRELOAD_DISABLE (0x00000000U)
+
+#define __HAL_RCC_GPIOA_CLK_ENABLE() ((void)0)
+#define __HAL_RCC_TIM2_CLK_ENABLE() ((void)0)
+#define __HAL_RCC_DMA1_CLK_ENABLE() ((void)0)
+#define __HAL_RCC_DMAMUX1_CLK_ENABLE() ((void)0)
+#define __HAL_SYSCFG_FASTMODEPLUS_ENABLE(fastmode) ((void)(fastmode))
+#define __HAL_LINKDMA(handle, field, dma)   \
+    do {                                    \
+        (handle)->field = &(dma);           \
+        (dma).Parent = (handle);            \
+    } while (0)
+/** Every timer reads the emulated bus's microsecond clock.*/
+#define __HAL_TIM_GET_COUNTER(handle) sim_hal_timer_counter(handle)
+#define __HAL_GPIO_EXTI_GET_IT(pin) sim_hal_exti_get_it(pin)
+#define __HAL_GPIO_EXTI_CLEAR_IT(pin) sim_hal_exti_clear_it(pin)
+
+uint32_t sim_hal_timer_counter(TIM_HandleTypeDef *handle);
+uint32_t sim_hal_exti_get_it(uint16_t pin);
+void sim_hal_exti_clear_it(uint16_t pin);
+
+void HAL_GPIO_Init(void *port, GPIO_InitTypeDef *init);
+void HAL_NVIC_SetPriority(IRQn_Type irq, uint32_t preempt, uint32_t sub);
+void HAL_NVIC_EnableIRQ(IRQn_Type irq);
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *handle);
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef *handle);
+void HAL_DMA_IRQHandler(DMA_HandleTypeDef *handle);
+
+HAL_StatusTypeDef HAL_TIM_Base_Init(TIM_HandleTypeDef *handle);
+HAL_StatusTypeDef HAL_TIM_Base_Start(TIM_HandleTypeDef *handle);
+
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef *handle);
+HAL_StatusTypeDef HAL_I2C_DeInit(I2C_HandleTypeDef *handle);
+HAL_StatusTypeDef HAL_I2CEx_ConfigAnalogFilter(I2C_HandleTypeDef *handle,
+                                               uint32_t filter);
+HAL_StatusTypeDef HAL_I2CEx_ConfigDigitalFilter(I2C_HandleTypeDef *handle,
+                                                uint32_t filter);
+HAL_StatusTypeDef HAL_I2C_Mem_Write_DMA(I2C_HandleTypeDef *handle,
+                                        uint16_t dev_address,
+                                        uint16_t mem_address,
+                                        uint16_t mem_add_size, uint8_t *data,
+                                        uint16_t size);
+HAL_StatusTypeDef HAL_I2C_Mem_Read_DMA(I2C_HandleTypeDef *handle,
+                                       uint16_t dev_address,
+                                       uint16_t mem_address,
+                                       uint16_t mem_add_size, uint8_t *data,
+                                       uint16_t size);
+void HAL_I2C_EV_IRQHandler(I2C_HandleTypeDef *handle);
+void HAL_I2C_ER_IRQHandler(I2C_HandleTypeDef *handle);
+
+/** Provided by the code under test, called by the emulated bus.*/
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *handle);
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *handle);
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *handle);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+#endif  // SIM_STM32G4XX_HAL_H__
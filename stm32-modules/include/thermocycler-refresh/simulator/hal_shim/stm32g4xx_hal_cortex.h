@@ -0,0 +1,3 @@
+/* Host stand-in; everything used from this header is in stm32g4xx_hal.h */
+#pragma once
+#include "stm32g4xx_hal.h"
@@ -0,0 +1,47 @@
+/*
+ * Host stand-in for the FreeRTOS task API. Every host thread is its own
+ * task, with its own notification count.
+ *
+ * Critical sections lock one process-wide recursive mutex. Emulated
+ * interrupts run holding the same mutex, so masking interrupts behaves
+ * the way it does on the board.
+ */
+#ifndef SIM_TASK_H__
+#define SIM_TASK_H__
+
+#include "FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+typedef struct sim_task *TaskHandle_t;
+
+#define taskYIELD() sim_task_yield()
+#define taskENTER_CRITICAL() sim_task_enter_critical()
+#define taskEXIT_CRITICAL() sim_task_exit_critical()
+#define taskENTER_CRITICAL_FROM_ISR() sim_task_enter_critical_from_isr()
+#define taskEXIT_CRITICAL_FROM_ISR(saved) \
+    sim_task_exit_critical_from_isr(saved)
+
+void sim_task_yield(void);
+void sim_task_enter_critical(void);
+void sim_task_exit_critical(void);
+UBaseType_t sim_task_enter_critical_from_isr(void);
+void sim_task_exit_critical_from_isr(UBaseType_t saved);
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+TickType_t xTaskGetTickCount(void);
+void vTaskDelay(TickType_t ticks);
+void vTaskDelayUntil(TickType_t *previous_wake_time, TickType_t increment);
+uint32_t ulTaskNotifyTake(BaseType_t clear_count_on_exit,
+                          TickType_t ticks_to_wait);
+void vTaskNotifyGiveFromISR(TaskHandle_t task,
+                            BaseType_t *higher_priority_task_woken);
+BaseType_t xTaskNotifyStateClear(TaskHandle_t task);
+uint32_t ulTaskNotifyValueClear(TaskHandle_t task, uint32_t bits_to_clear);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+#endif  // SIM_TASK_H__
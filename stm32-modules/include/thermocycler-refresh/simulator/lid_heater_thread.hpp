@@ -2,12 +2,22 @@
 #include <memory>
 #include <thread>
 
+#include "simulator/scheduler.hpp"
 #include "simulator/simulator_queue.hpp"
+#include "simulator/thermal_model.hpp"
 #include "thermocycler-refresh/lid_heater_task.hpp"
 #include "thermocycler-refresh/tasks.hpp"
 
 namespace lid_heater_thread {
 using SimLidHeaterTask = lid_heater_task::LidHeaterTask<SimulatorMessageQueue>;
 struct TaskControlBlock;
-auto build() -> tasks::Task<std::unique_ptr<std::jthread>, SimLidHeaterTask>;
+auto build(std::shared_ptr<thermal_model::Plant> plant)
+    -> tasks::Task<std::unique_ptr<std::jthread>, SimLidHeaterTask>;
+/**
+ * Build the task to run on the cooperative scheduler instead of a thread of
+ * its own, in which case the handle is empty.
+ */
+auto build(std::shared_ptr<thermal_model::Plant> plant,
+           scheduler::Scheduler& scheduler)
+    -> tasks::Task<std::unique_ptr<std::jthread>, SimLidHeaterTask>;
 };  // namespace lid_heater_thread
@@ -0,0 +1,25 @@
+#pragma once
+#include <memory>
+#include <thread>
+
+#include "simulator/lid_heater_thread.hpp"
+#include "simulator/scheduler.hpp"
+#include "simulator/thermal_model.hpp"
+#include "simulator/thermal_plate_thread.hpp"
+
+namespace plant_thread {
+/**
+ * Step the plant on the simulator clock, once every plate control period,
+ * sending the thermal plate task its readings every step and the lid
+ * heater task its readings every lid control period.
+ */
+auto build(std::shared_ptr<thermal_model::Plant> plant,
+           thermal_plate_thread::SimThermalPlateTask* thermal_plate,
+           lid_heater_thread::SimLidHeaterTask* lid_heater)
+    -> std::unique_ptr<std::jthread>;
+/** Step the plant the same way, as a periodic action on the scheduler.*/
+auto build(std::shared_ptr<thermal_model::Plant> plant,
+           thermal_plate_thread::SimThermalPlateTask* thermal_plate,
+           lid_heater_thread::SimLidHeaterTask* lid_heater,
+           scheduler::Scheduler& scheduler) -> void;
+};  // namespace plant_thread
@@ -8,8 +8,15 @@ namespace sim_driver {
 
 class SimDriver {
   public:
+    virtual ~SimDriver() = default;
     virtual const std::string& get_name() const = 0;
     virtual void write(const std::string& message) = 0;
     virtual void read(tasks::Tasks<SimulatorMessageQueue>& tasks) = 0;
+    /**
+     * Called from the comms task's thread each time the task has finished
+     * with a message, for drivers that hand the task their input in place
+     * and need to know when they can reuse it.
+     */
+    virtual void comms_finished() {}
 };
 }  // namespace sim_driver
@@ -2,6 +2,7 @@
 #include <memory>
 #include <thread>
 
+#include "simulator/scheduler.hpp"
 #include "simulator/simulator_queue.hpp"
 #include "thermocycler-refresh/system_task.hpp"
 #include "thermocycler-refresh/tasks.hpp"
@@ -10,4 +11,10 @@ namespace system_thread {
 using SimSystemTask = system_task::SystemTask<SimulatorMessageQueue>;
 struct TaskControlBlock;
 auto build() -> tasks::Task<std::unique_ptr<std::jthread>, SimSystemTask>;
+/**
+ * Build the task to run on the cooperative scheduler instead of a thread of
+ * its own, in which case the handle is empty.
+ */
+auto build(scheduler::Scheduler& scheduler)
+    -> tasks::Task<std::unique_ptr<std::jthread>, SimSystemTask>;
 };  // namespace system_thread
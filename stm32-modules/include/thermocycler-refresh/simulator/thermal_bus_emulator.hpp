@@ -0,0 +1,204 @@
+/*
+ * Register-level emulation of the thermal I2C bus and the ADS1115 ADCs on
+ * it. With the HAL and FreeRTOS stand-ins in simulator/hal_shim, this lets
+ * the real ADS1115 driver and thermal_hardware.c run on host, in tests.
+ *
+ * Time on the bus is virtual. Transfers and conversions take as long as
+ * they would on the board (1MHz I2C, conversion time set by the data
+ * rate), but each completion runs as soon as everything before it has run
+ * instead of after that much real time. The timestamp timer reads this
+ * virtual clock, so acquisition timing can be measured exactly.
+ *
+ * Completions run on the bus's own thread, standing in for interrupts:
+ * they hold the critical section lock while they run, so masking
+ * interrupts with taskENTER_CRITICAL keeps them out.
+ */
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "firmware/thermal_hardware.h"
+#include "stm32g4xx_hal.h"
+
+namespace thermal_bus_emulator {
+
+/**
+ * One ADS1115. Only single-ended, single shot conversions are modelled;
+ * the comparator only as far as using ALERT/RDY as a conversion ready pin.
+ */
+class ADS1115 {
+  public:
+    static constexpr uint8_t conversion_reg = 0x00;
+    static constexpr uint8_t config_reg = 0x01;
+    static constexpr uint8_t lo_thresh_reg = 0x02;
+    static constexpr uint8_t hi_thresh_reg = 0x03;
+    static constexpr size_t pin_count = 4;
+
+    ADS1115() = delete;
+    /**
+     * @param address The I2C address, as passed to the HAL (shifted left)
+     * @param ready_line The interrupt line its ALERT/RDY pin is wired to
+     */
+    ADS1115(uint16_t address, ADC_ITR_T ready_line);
+
+    [[nodiscard]] auto address() const -> uint16_t { return _address; }
+    [[nodiscard]] auto ready_line() const -> ADC_ITR_T { return _ready_line; }
+
+    /** Set what conversions of a single-ended input read, in counts.*/
+    auto set_input(uint16_t pin, uint16_t counts) -> void;
+    /**
+     * Make an input noisy: conversions alternate between adding and
+     * subtracting \c amplitude counts, so any even number of them
+     * averages out to the input.
+     */
+    auto set_input_noise(uint16_t pin, uint16_t amplitude) -> void;
+    /** A disconnected ADC doesn't acknowledge its address.*/
+    auto set_connected(bool connected) -> void { _connected = connected; }
+    /** With ALERT/RDY cut, conversions finish but are never signalled.*/
+    auto set_ready_connected(bool connected) -> void {
+        _ready_connected = connected;
+    }
+    /** Number of conversions run since the ADC was created or reset.*/
+    [[nodiscard]] auto conversions() const -> uint32_t {
+        return _conversions;
+    }
+
+    // These are for the bus
+    [[nodiscard]] auto acknowledges() const -> bool { return _connected; }
+    /**
+     * @return How long a conversion started by this write takes, in
+     * microseconds, or 0 if it didn't start one
+     */
+    auto write_register(uint8_t reg, uint16_t value) -> uint32_t;
+    [[nodiscard]] auto read_register(uint8_t reg) const -> uint16_t;
+    /** @return true if ALERT/RDY pulses for the finished conversion*/
+    auto finish_conversion() -> bool;
+
+    /** Time one conversion takes with a config register value.*/
+    static auto conversion_time_us(uint16_t config) -> uint32_t;
+
+  private:
+    static constexpr uint16_t config_os = 0x8000;
+    static constexpr uint16_t config_mux_shift = 12;
+    static constexpr uint16_t config_mux_mask = 0x7;
+    /** Mux settings from here up are AINx against GND.*/
+    static constexpr uint16_t config_mux_single_ended = 0x4;
+    static constexpr uint16_t config_mode_single_shot = 0x0100;
+    static constexpr uint16_t config_dr_shift = 5;
+    static constexpr uint16_t config_dr_mask = 0x7;
+    static constexpr uint16_t config_comp_que_mask = 0x3;
+    static constexpr uint16_t thresh_msb = 0x8000;
+    // Power-on register values
+    static constexpr uint16_t config_reset = 0x8583;
+    static constexpr uint16_t lo_thresh_reset = 0x8000;
+    static constexpr uint16_t hi_thresh_reset = 0x7FFF;
+
+    uint16_t _address;
+    ADC_ITR_T _ready_line;
+    uint16_t _config = config_reset;
+    uint16_t _lo_thresh = lo_thresh_reset;
+    uint16_t _hi_thresh = hi_thresh_reset;
+    uint16_t _conversion = 0;
+    bool _converting = false;
+    bool _connected = true;
+    bool _ready_connected = true;
+    uint32_t _conversions = 0;
+    std::array<uint16_t, pin_count> _inputs = {};
+    std::array<uint16_t, pin_count> _noise = {};
+    std::array<bool, pin_count> _noise_high = {};
+};
+
+/** The thermal I2C bus, the ADCs on it and the interrupts they raise.*/
+class Bus {
+  public:
+    /** The bus runs at 1MHz, so a bit takes a microsecond.*/
+    static constexpr uint32_t bit_time_us = 1;
+    /** Start, address, register, two data bytes, stop.*/
+    static constexpr uint32_t write_bits = 38;
+    /** Start, address, register, restart, address, two data bytes, stop.*/
+    static constexpr uint32_t read_bits = 48;
+    /** Start, then an address nobody acknowledges.*/
+    static constexpr uint32_t nack_bits = 10;
+
+    Bus();
+    Bus(const Bus &) = delete;
+    Bus(Bus &&) = delete;
+    auto operator=(const Bus &) -> Bus & = delete;
+    auto operator=(Bus &&) -> Bus & = delete;
+    ~Bus();
+
+    /**
+     * Get the ADC at an address, adding it to the bus if there isn't one.
+     * ADCs stay on the bus for the life of the process, since the driver
+     * only configures them once.
+     */
+    auto ads1115(uint16_t address, ADC_ITR_T ready_line) -> ADS1115 &;
+    /** The virtual time, in microseconds. Wraps like the hardware timer.*/
+    [[nodiscard]] auto now_us() -> uint32_t;
+    /** Number of I2C transfers started, acknowledged or not.*/
+    [[nodiscard]] auto transfers() -> uint32_t;
+    /** Block until every scheduled completion has run.*/
+    auto wait_idle() -> void;
+    /**
+     * Wait until idle, then put every ADC back to its power-on registers
+     * with quiet, connected inputs at 0.
+     */
+    auto reset() -> void;
+
+    // These are for the HAL stand-in
+    /** @return false if the bus is busy*/
+    auto start_write(I2C_HandleTypeDef *handle, uint16_t address, uint8_t reg,
+                     const uint8_t *data) -> bool;
+    /** @return false if the bus is busy*/
+    auto start_read(I2C_HandleTypeDef *handle, uint16_t address, uint8_t reg,
+                    uint8_t *data) -> bool;
+    auto exti_pending(uint16_t pin) -> bool;
+    auto exti_clear(uint16_t pin) -> void;
+
+  private:
+    struct Event {
+        uint64_t at_us;
+        /** Keeps events scheduled for the same time in order.*/
+        uint64_t sequence;
+        std::function<void()> action;
+    };
+    struct Later {
+        auto operator()(const Event &lhs, const Event &rhs) const -> bool {
+            return (lhs.at_us != rhs.at_us) ? (lhs.at_us > rhs.at_us)
+                                            : (lhs.sequence > rhs.sequence);
+        }
+    };
+
+    /** Call with _mutex held.*/
+    auto schedule(uint64_t delay_us, std::function<void()> action) -> void;
+    /** Call with _mutex held.*/
+    auto find(uint16_t address) -> ADS1115 *;
+    auto run(std::stop_token stop) -> void;
+
+    std::mutex _mutex{};
+    std::condition_variable_any _changed{};
+    std::priority_queue<Event, std::vector<Event>, Later> _events{};
+    uint64_t _now_us = 0;
+    uint64_t _sequence = 0;
+    bool _running_event = false;
+    bool _busy = false;
+    uint32_t _transfers = 0;
+    uint16_t _exti_pending = 0;
+    // A deque so that references to ADCs stay valid as more are added
+    std::deque<ADS1115> _devices{};
+    std::jthread _thread;
+};
+
+/** The one bus that the HAL stand-in drives.*/
+auto bus() -> Bus &;
+
+}  // namespace thermal_bus_emulator
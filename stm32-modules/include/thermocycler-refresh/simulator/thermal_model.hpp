@@ -0,0 +1,144 @@
+/*
+ * A lumped thermal model of the plate, heatsink, lid and samples, so the
+ * simulator can close the loop around the real thermal tasks.
+ *
+ * The block is three zones, one over each peltier, each coupled to its
+ * neighbours and losing a little heat to the air. Each peltier pumps heat
+ * between its zone and the shared heatsink, dissipates its I²R loss half
+ * into each side, and leaks heat back by conduction, so cooling gets
+ * weaker as the heatsink warms up. The fans set how well the heatsink
+ * rejects heat to the air. The lid is one mass with a resistive heater.
+ * Each zone carries a mass of sample wells that lags behind it and that
+ * the lid warms a little.
+ *
+ * PlantModel is plain state stepped by an explicit time. Plant wraps it
+ * with a lock so the task threads can set its inputs while the plant
+ * thread steps it, and turns its temperatures into the readings the tasks
+ * expect from the ADCs.
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include "core/thermistor_conversion.hpp"
+#include "systemwide.h"
+#include "thermistor_lookups.hpp"
+#include "thermocycler-refresh/messages.hpp"
+
+namespace thermal_model {
+
+class PlantModel {
+  public:
+    // Zones are indexed by the PeltierID of the peltier under them
+    static constexpr size_t ZONES = PELTIER_NUMBER;
+    static constexpr double AMBIENT_C = 23.0;
+    // Longer steps are split into Euler steps no longer than this
+    static constexpr double MAX_STEP_S = 0.01;
+
+    // Per peltier: Seebeck coefficient, resistance, thermal conductance
+    // and the current at full power
+    static constexpr double PELTIER_SEEBECK_V_PER_K = 0.05;
+    static constexpr double PELTIER_RESISTANCE_OHM = 1.5;
+    static constexpr double PELTIER_CONDUCTANCE_W_PER_K = 0.5;
+    static constexpr double PELTIER_MAX_CURRENT_A = 6.0;
+
+    static constexpr double ZONE_CAPACITY_J_PER_K = 36.0;
+    static constexpr double ZONE_COUPLING_W_PER_K = 2.0;
+    static constexpr double ZONE_LOSS_W_PER_K = 0.05;
+
+    static constexpr double WELL_CAPACITY_J_PER_K = 3.4;
+    static constexpr double WELL_COUPLING_W_PER_K = 0.7;
+    static constexpr double LID_TO_WELL_W_PER_K = 0.02;
+
+    static constexpr double HEATSINK_CAPACITY_J_PER_K = 400.0;
+    static constexpr double HEATSINK_LOSS_W_PER_K = 1.0;
+    // Extra rejection with the fans at full power
+    static constexpr double HEATSINK_FAN_LOSS_W_PER_K = 7.0;
+
+    static constexpr double LID_CAPACITY_J_PER_K = 150.0;
+    static constexpr double LID_HEATER_MAX_W = 60.0;
+    static constexpr double LID_LOSS_W_PER_K = 0.3;
+
+    explicit PlantModel(double ambient_c = AMBIENT_C);
+
+    /**
+     * @param zone The PeltierID of the peltier
+     * @param power From -1 (full cooling) to 1 (full heating)
+     */
+    auto set_peltier(size_t zone, double power) -> void;
+    /** @param power From 0 to 1*/
+    auto set_fan(double power) -> void;
+    /** @param power From 0 to 1*/
+    auto set_lid_heater(double power) -> void;
+
+    /** Advance the model by some time, in seconds.*/
+    auto step(double seconds) -> void;
+
+    [[nodiscard]] auto peltier(size_t zone) const -> double {
+        return _peltier_power.at(zone);
+    }
+    [[nodiscard]] auto fan() const -> double { return _fan_power; }
+    [[nodiscard]] auto lid_heater() const -> double { return _lid_power; }
+    [[nodiscard]] auto ambient_c() const -> double { return _ambient_c; }
+    [[nodiscard]] auto zone_c(size_t zone) const -> double {
+        return _zone_c.at(zone);
+    }
+    [[nodiscard]] auto well_c(size_t zone) const -> double {
+        return _well_c.at(zone);
+    }
+    [[nodiscard]] auto heatsink_c() const -> double { return _heatsink_c; }
+    [[nodiscard]] auto lid_c() const -> double { return _lid_c; }
+    /** Total time stepped, in seconds.*/
+    [[nodiscard]] auto elapsed_s() const -> double { return _elapsed_s; }
+
+  private:
+    auto euler(double seconds) -> void;
+
+    double _ambient_c;
+    std::array<double, ZONES> _peltier_power = {};
+    double _fan_power = 0;
+    double _lid_power = 0;
+    std::array<double, ZONES> _zone_c;
+    std::array<double, ZONES> _well_c;
+    double _heatsink_c;
+    double _lid_c;
+    double _elapsed_s = 0;
+};
+
+class Plant {
+  public:
+    // The thermistor circuits the thermal tasks are built for
+    static constexpr double THERMISTOR_CIRCUIT_BIAS_RESISTANCE_KOHM = 10.0;
+    static constexpr uint16_t ADC_BIT_MAX = 0x5DC0;
+
+    explicit Plant(double ambient_c = PlantModel::AMBIENT_C);
+
+    // These take the same inputs as the thermal task policies
+    auto set_peltier(PeltierID peltier, double power,
+                     PeltierDirection direction) -> void;
+    auto set_fan(double power) -> void;
+    auto set_lid_heater(double power) -> void;
+
+    auto step(double seconds) -> void;
+
+    /**
+     * What a scan of the plate thermistors would read now. The front and
+     * back thermistors of a zone both read the zone temperature, and the
+     * timestamp is the time the plant has been stepped.
+     */
+    [[nodiscard]] auto plate_reading() const
+        -> messages::ThermalPlateTempReadComplete;
+    [[nodiscard]] auto lid_reading() const -> messages::LidTempReadComplete;
+    /** A copy of the model as it is now.*/
+    [[nodiscard]] auto snapshot() const -> PlantModel;
+
+  private:
+    mutable std::mutex _mutex;
+    PlantModel _model;
+    thermistor_conversion::Conversion<lookups::KS103J2G> _converter;
+};
+
+}  // namespace thermal_model
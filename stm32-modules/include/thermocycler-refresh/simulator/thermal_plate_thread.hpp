@@ -2,7 +2,9 @@
 #include <memory>
 #include <thread>
 
+#include "simulator/scheduler.hpp"
 #include "simulator/simulator_queue.hpp"
+#include "simulator/thermal_model.hpp"
 #include "thermocycler-refresh/tasks.hpp"
 #include "thermocycler-refresh/thermal_plate_task.hpp"
 
@@ -10,5 +12,13 @@ namespace thermal_plate_thread {
 using SimThermalPlateTask =
     thermal_plate_task::ThermalPlateTask<SimulatorMessageQueue>;
 struct TaskControlBlock;
-auto build() -> tasks::Task<std::unique_ptr<std::jthread>, SimThermalPlateTask>;
+auto build(std::shared_ptr<thermal_model::Plant> plant)
+    -> tasks::Task<std::unique_ptr<std::jthread>, SimThermalPlateTask>;
+/**
+ * Build the task to run on the cooperative scheduler instead of a thread of
+ * its own, in which case the handle is empty.
+ */
+auto build(std::shared_ptr<thermal_model::Plant> plant,
+           scheduler::Scheduler& scheduler)
+    -> tasks::Task<std::unique_ptr<std::jthread>, SimThermalPlateTask>;
 };  // namespace thermal_plate_thread
@@ -22,3 +22,7 @@ typedef enum PeltierDirection {
 enum PeltierSelection { LEFT, CENTER, RIGHT, ALL };
 
 enum PidSelection { HEATER, PELTIERS, FANS };
+
+/* Independent zones run one PID per peltier; uniformity mode computes all
+ * three peltier outputs jointly to minimize zone-to-zone spread */
+enum PlateControlMode { PLATE_CONTROL_INDEPENDENT, PLATE_CONTROL_UNIFORMITY };
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "core/adc_filter.hpp"
 #include "thermocycler-refresh/thermal_general.hpp"
 
 struct TestPeltier {
@@ -54,11 +55,29 @@ class TestThermalPlatePolicy {
         return true;
     }
 
+    auto set_acquisition(uint16_t data_rate_sps, uint8_t oversample,
+                         AdcFilter::Mode filter, double filter_alpha) -> bool {
+        if (!_acquisition_ok) {
+            return false;
+        }
+        _data_rate_sps = data_rate_sps;
+        _oversample = oversample;
+        _filter = filter;
+        _filter_alpha = filter_alpha;
+        return true;
+    }
+
     bool _enabled = false;
     TestPeltier _left = TestPeltier();
     TestPeltier _center = TestPeltier();
     TestPeltier _right = TestPeltier();
     double _fan_power = 0.0F;
+    // Whether set_acquisition takes the settings it's given
+    bool _acquisition_ok = true;
+    uint16_t _data_rate_sps = 0;
+    uint8_t _oversample = 0;
+    AdcFilter::Mode _filter = AdcFilter::Mode::NONE;
+    double _filter_alpha = 0;
 
   private:
     using GetPeltierT = std::optional<std::reference_wrapper<TestPeltier>>;
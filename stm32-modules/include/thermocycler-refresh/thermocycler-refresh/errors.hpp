@@ -39,6 +39,7 @@ enum class ErrorCode {
     THERMISTOR_LID_DISCONNECTED = 222,
     THERMISTOR_LID_SHORT = 223,
     THERMISTOR_LID_OVERTEMP = 224,
+    THERMISTOR_PLATE_PAIR_MISMATCH = 225,
     // 3xx - System General
     SYSTEM_SERIAL_NUMBER_INVALID = 301,
     SYSTEM_SERIAL_NUMBER_HAL_ERROR = 302,
@@ -49,6 +50,12 @@ enum class ErrorCode {
     THERMAL_LID_BUSY = 404,
     THERMAL_HEATER_ERROR = 405,
     THERMAL_CONSTANT_OUT_OF_RANGE = 406,
+    THERMAL_AUTOTUNE_FAILED = 407,
+    THERMAL_PLATE_RUNAWAY = 408,
+    THERMAL_PLATE_NO_RESPONSE = 409,
+    THERMAL_LID_RUNAWAY = 410,
+    THERMAL_LID_NO_RESPONSE = 411,
+    THERMAL_PLATE_ACQUISITION_INVALID = 412,
 };
 
 auto errorstring(ErrorCode code) -> const char*;
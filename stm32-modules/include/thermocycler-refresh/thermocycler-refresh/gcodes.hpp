@@ -18,6 +18,7 @@
 #include <optional>
 #include <utility>
 
+#include "core/adc_filter.hpp"
 #include "core/gcode_parser.hpp"
 #include "core/utility.hpp"
 #include "systemwide.h"
@@ -596,6 +597,320 @@ struct GetPlateTemperatureDebug {
     }
 };
 
+struct GetPlateSampleTiming {
+    /**
+     * GetPlateSampleTiming uses M105.T, a debug gcode that reports how
+     * regularly the plate thermistors have been sampled since the last
+     * M105.T (or since startup).
+     *
+     * - Number of scan intervals measured (N)
+     * - Mean interval between scans, in ms (P)
+     * - Standard deviation of the interval, in ms (S)
+     * - Largest distance of any interval from the control period, in ms (J)
+     * - Longest time any one scan took to acquire, in ms (A)
+     */
+    using ParseResult = std::optional<GetPlateSampleTiming>;
+    static constexpr auto prefix = std::array{'M', '1', '0', '5', '.', 'T'};
+
+    template <typename InputIt, typename InLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputIt, InLimit>
+    static auto write_response_into(InputIt buf, InLimit limit, uint32_t count,
+                                    double period_ms, double stddev_ms,
+                                    double jitter_ms, double acquisition_ms)
+        -> InputIt {
+        auto res = snprintf(
+            &*buf, (limit - buf),
+            "M105.T N:%lu P:%0.3f S:%0.3f J:%0.3f A:%0.3f OK\n",
+            static_cast<unsigned long>(count), static_cast<float>(period_ms),
+            static_cast<float>(stddev_ms), static_cast<float>(jitter_ms),
+            static_cast<float>(acquisition_ms));
+        if (res <= 0) {
+            return buf;
+        }
+        return buf + res;
+    }
+    template <typename InputIt, typename Limit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto working = prefix_matches(input, limit, prefix);
+        if (working == input) {
+            return std::make_pair(ParseResult(), input);
+        }
+        return std::make_pair(ParseResult(GetPlateSampleTiming()), working);
+    }
+};
+
+struct GetPlateThermistorNoise {
+    /**
+     * GetPlateThermistorNoise uses M105.N, a debug gcode that reports how
+     * noisy each plate thermistor reading is: the standard deviation, in C,
+     * of its most recent readings. Only meaningful while the plate is
+     * holding a steady temperature.
+     *
+     * - Number of readings in the window (N)
+     * - Heat sink (HST)
+     * - Front right (FRT)
+     * - Front left (FLT)
+     * - Front center (FCT)
+     * - Back right (BRT)
+     * - Back left (BLT)
+     * - Back center (BCT)
+     */
+    using ParseResult = std::optional<GetPlateThermistorNoise>;
+    static constexpr auto prefix = std::array{'M', '1', '0', '5', '.', 'N'};
+
+    template <typename InputIt, typename InLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputIt, InLimit>
+    static auto write_response_into(
+        InputIt buf, InLimit limit, uint32_t count, double heat_sink,
+        double front_right, double front_left, double front_center,
+        double back_right, double back_left, double back_center) -> InputIt {
+        auto res = snprintf(&*buf, (limit - buf),
+                            "M105.N N:%lu HST:%0.4f FRT:%0.4f FLT:%0.4f "
+                            "FCT:%0.4f BRT:%0.4f BLT:%0.4f BCT:%0.4f OK\n",
+                            static_cast<unsigned long>(count),
+                            static_cast<float>(heat_sink),
+                            static_cast<float>(front_right),
+                            static_cast<float>(front_left),
+                            static_cast<float>(front_center),
+                            static_cast<float>(back_right),
+                            static_cast<float>(back_left),
+                            static_cast<float>(back_center));
+        if (res <= 0) {
+            return buf;
+        }
+        return buf + res;
+    }
+    template <typename InputIt, typename Limit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto working = prefix_matches(input, limit, prefix);
+        if (working == input) {
+            return std::make_pair(ParseResult(), input);
+        }
+        return std::make_pair(ParseResult(GetPlateThermistorNoise()), working);
+    }
+};
+
+struct SetPlateAcquisition {
+    /**
+     * SetPlateAcquisition uses M105.A, a debug gcode that sets how the plate
+     * thermistors are sampled, so that the noise reported by M105.N can be
+     * traded against latency on a running unit. Every thermistor is
+     * converted O times per control period at R samples per second, and the
+     * average of the conversions is passed through the filter.
+     *
+     * M105.A R<sps> O<oversample> [F<filter>] [A<alpha>]
+     *
+     * - R may be 250, 475 or 860. The ADCs' slower rates can't convert
+     *   every thermistor even once in the half of a control period a scan
+     *   gets, so they aren't offered.
+     * - F may be 0 (none, the default), 1 (median) or 2 (IIR)
+     * - A is the IIR smoothing factor in (0, 1], 0.5 if not given
+     *
+     * Settings whose conversions don't fit in a control period are refused
+     * with ERR412: on the current boards that's O above 1 at R250, above 2
+     * at R475 and above 5 at R860.
+     */
+    using ParseResult = std::optional<SetPlateAcquisition>;
+    static constexpr auto prefix =
+        std::array{'M', '1', '0', '5', '.', 'A', ' ', 'R'};
+    static constexpr auto prefix_oversample = std::array{' ', 'O'};
+    static constexpr auto prefix_filter = std::array{' ', 'F'};
+    static constexpr auto prefix_alpha = std::array{' ', 'A'};
+    static constexpr auto data_rates = std::array<uint16_t, 3>{250, 475, 860};
+    static constexpr double default_alpha = 0.5;
+    static constexpr const char* response = "M105.A OK\n";
+
+    uint16_t data_rate_sps;
+    uint8_t oversample;
+    AdcFilter::Mode filter;
+    double filter_alpha;
+
+    template <typename InputIt, typename InLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputIt, InLimit>
+    static auto write_response_into(InputIt buf, InLimit limit) -> InputIt {
+        return write_string_to_iterpair(buf, limit, response);
+    }
+
+    template <typename InputIt, typename Limit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto working = prefix_matches(input, limit, prefix);
+        if (working == input) {
+            return std::make_pair(ParseResult(), input);
+        }
+        auto rate = parse_value<uint16_t>(working, limit);
+        if (!rate.first.has_value() ||
+            std::find(data_rates.begin(), data_rates.end(),
+                      rate.first.value()) == data_rates.end()) {
+            return std::make_pair(ParseResult(), input);
+        }
+
+        working = prefix_matches(rate.second, limit, prefix_oversample);
+        if (working == rate.second) {
+            return std::make_pair(ParseResult(), input);
+        }
+        auto oversample = parse_value<uint8_t>(working, limit);
+        if (!oversample.first.has_value() || oversample.first.value() == 0) {
+            return std::make_pair(ParseResult(), input);
+        }
+
+        auto filter = AdcFilter::Mode::NONE;
+        working = prefix_matches(oversample.second, limit, prefix_filter);
+        if (working == oversample.second) {
+            // No filter given
+        } else if (working == limit) {
+            return std::make_pair(ParseResult(), input);
+        } else {
+            switch (*working) {
+                case '0':
+                    filter = AdcFilter::Mode::NONE;
+                    break;
+                case '1':
+                    filter = AdcFilter::Mode::MEDIAN;
+                    break;
+                case '2':
+                    filter = AdcFilter::Mode::IIR;
+                    break;
+                default:
+                    return std::make_pair(ParseResult(), input);
+            }
+            std::advance(working, 1);
+        }
+
+        double alpha = default_alpha;
+        auto old_working = working;
+        working = prefix_matches(old_working, limit, prefix_alpha);
+        if (working != old_working) {
+            auto alpha_res = parse_value<float>(working, limit);
+            if (!alpha_res.first.has_value() ||
+                !(alpha_res.first.value() > 0.0F) ||
+                alpha_res.first.value() > 1.0F) {
+                return std::make_pair(ParseResult(), input);
+            }
+            alpha = alpha_res.first.value();
+            working = alpha_res.second;
+        }
+
+        return std::make_pair(
+            ParseResult(SetPlateAcquisition{
+                .data_rate_sps = rate.first.value(),
+                .oversample = oversample.first.value(),
+                .filter = filter,
+                .filter_alpha = alpha}),
+            working);
+    }
+};
+
+struct GetThermistorStats {
+    /**
+     * GetThermistorStats uses M105.S, a debug gcode that reports the health
+     * statistics kept for one thermistor, so that a failing sensor can be
+     * spotted without streaming its readings.
+     *
+     * M105.S <thermistor> [W<readings>]
+     *
+     * W covers just that many of the most recent readings, from 1 up to
+     * the max_window that are kept (the default), e.g. to catch a brief
+     * glitch that the full window would average away. The drift is always
+     * of the full window.
+     *
+     * The thermistor is numbered as:
+     * 0 front right, 1 front left, 2 front center, 3 back right,
+     * 4 back left, 5 back center, 6 heat sink, 7 lid
+     *
+     * The response has:
+     * - The thermistor (T)
+     * - Valid readings in the statistics window (N)
+     * - Minimum, maximum and mean temperature in the window (MIN, MAX, AVG)
+     * - Variance of the temperature in the window, in C^2 (VAR)
+     * - Invalid conversions among the last window's worth (INV)
+     * - Conversions since boot, and how many of them were invalid (TOT, TINV)
+     * - Drift of the window mean since the first full window after boot (DR)
+     */
+    using ParseResult = std::optional<GetThermistorStats>;
+    static constexpr auto prefix =
+        std::array{'M', '1', '0', '5', '.', 'S', ' '};
+    static constexpr auto prefix_window = std::array{' ', 'W'};
+    static constexpr uint8_t thermistor_count = 8;
+    // Readings kept for each thermistor
+    static constexpr uint32_t max_window = 64;
+
+    uint8_t thermistor;
+    uint32_t window = max_window;
+
+    template <typename InputIt, typename InLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputIt, InLimit>
+    static auto write_response_into(InputIt buf, InLimit limit,
+                                    uint8_t thermistor, uint32_t count,
+                                    double min, double max, double mean,
+                                    double variance, uint32_t invalid,
+                                    uint32_t total, uint32_t total_invalid,
+                                    double drift) -> InputIt {
+        auto res = snprintf(
+            &*buf, (limit - buf),
+            "M105.S T:%u N:%lu MIN:%0.2f MAX:%0.2f AVG:%0.3f VAR:%0.5f "
+            "INV:%lu TOT:%lu TINV:%lu DR:%0.3f OK\n",
+            static_cast<unsigned int>(thermistor),
+            static_cast<unsigned long>(count), static_cast<float>(min),
+            static_cast<float>(max), static_cast<float>(mean),
+            static_cast<float>(variance), static_cast<unsigned long>(invalid),
+            static_cast<unsigned long>(total),
+            static_cast<unsigned long>(total_invalid),
+            static_cast<float>(drift));
+        if (res <= 0) {
+            return buf;
+        }
+        return buf + res;
+    }
+
+    template <typename InputIt, typename Limit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto working = prefix_matches(input, limit, prefix);
+        if (working == input) {
+            return std::make_pair(ParseResult(), input);
+        }
+        auto value_res = parse_value<uint8_t>(working, limit);
+        if (!value_res.first.has_value() ||
+            (value_res.first.value() >= thermistor_count)) {
+            return std::make_pair(ParseResult(), input);
+        }
+        auto working_window = prefix_matches(value_res.second, limit,
+                                             prefix_window);
+        if (working_window == value_res.second) {
+            return std::make_pair(
+                ParseResult(GetThermistorStats{
+                    .thermistor = value_res.first.value()}),
+                value_res.second);
+        }
+        auto window_res = parse_value<uint32_t>(working_window, limit);
+        if (!window_res.first.has_value() ||
+            (window_res.first.value() == 0) ||
+            (window_res.first.value() > max_window)) {
+            return std::make_pair(ParseResult(), input);
+        }
+        return std::make_pair(
+            ParseResult(
+                GetThermistorStats{.thermistor = value_res.first.value(),
+                                   .window = window_res.first.value()}),
+            window_res.second);
+    }
+};
+
 struct SetLidTemperature {
     /**
      * SetLidTemperature uses M140. Only parameter is optional and it is
@@ -684,19 +999,26 @@ struct SetPlateTemperature {
      * SetPlateTemperature uses M104. Parameters:
      * - S - setpoint temperature
      * - H - hold time (optional)
+     * - V - sample volume in microliters (optional). When provided, the
+     *   plate overshoots the setpoint while the sample catches up.
      *
      * M104 S44\n
+     * M104 S95 H30 V25\n
      */
     using ParseResult = std::optional<SetPlateTemperature>;
     static constexpr auto prefix = std::array{'M', '1', '0', '4', ' ', 'S'};
     static constexpr auto hold_prefix = std::array{' ', 'H'};
+    static constexpr auto volume_prefix = std::array{' ', 'V'};
     static constexpr const char* response = "M104 OK\n";
 
     // 0 seconds means infinite hold time
     constexpr static double infinite_hold = 0.0F;
+    // 0 microliters means no volume compensation
+    constexpr static double no_volume = 0.0F;
 
     double setpoint;
     double hold_time;
+    double volume;
 
     template <typename InputIt, typename InLimit>
     requires std::forward_iterator<InputIt> &&
@@ -731,11 +1053,25 @@ struct SetPlateTemperature {
             }
             hold_val = hold.first.value();
             working = hold.second;
+        } else {
+            working = temperature.second;
+        }
+
+        auto volume_val = no_volume;
+        auto after_volume = prefix_matches(working, limit, volume_prefix);
+        if (after_volume != working) {
+            auto volume = parse_value<float>(after_volume, limit);
+            if (!volume.first.has_value() || volume.first.value() < 0.0F) {
+                return std::make_pair(ParseResult(), input);
+            }
+            volume_val = volume.first.value();
+            working = volume.second;
         }
 
         return std::make_pair(
             ParseResult(SetPlateTemperature{.setpoint = temperature_val,
-                                            .hold_time = hold_val}),
+                                            .hold_time = hold_val,
+                                            .volume = volume_val}),
             working);
     }
 };
@@ -882,4 +1218,190 @@ struct SetPIDConstants {
     }
 };
 
+struct SetPlateControlMode {
+    /**
+     * SetPlateControlMode uses M104.U. It selects how the three peltier
+     * outputs are computed while the plate is controlling temperature.
+     *
+     * M104.U S<mode>
+     *
+     * Mode may be:
+     * - 0 = independent zones, one PID per peltier (default)
+     * - 1 = uniformity mode, all peltier outputs computed jointly from
+     *       every plate thermistor and the heatsink
+     */
+    using ParseResult = std::optional<SetPlateControlMode>;
+    static constexpr auto prefix =
+        std::array{'M', '1', '0', '4', '.', 'U', ' ', 'S'};
+    static constexpr const char* response = "M104.U OK\n";
+
+    PlateControlMode mode;
+
+    template <typename InputIt, typename InLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputIt, InLimit>
+    static auto write_response_into(InputIt buf, InLimit limit) -> InputIt {
+        return write_string_to_iterpair(buf, limit, response);
+    }
+
+    template <typename InputIt, typename Limit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto working = prefix_matches(input, limit, prefix);
+        if (working == input || working == limit) {
+            return std::make_pair(ParseResult(), input);
+        }
+        PlateControlMode mode = PLATE_CONTROL_INDEPENDENT;
+        switch (*working) {
+            case '0':
+                mode = PLATE_CONTROL_INDEPENDENT;
+                break;
+            case '1':
+                mode = PLATE_CONTROL_UNIFORMITY;
+                break;
+            default:
+                return std::make_pair(ParseResult(), input);
+        }
+        std::advance(working, 1);
+        return std::make_pair(ParseResult(SetPlateControlMode{.mode = mode}),
+                              working);
+    }
+};
+
+struct SetPowerSupply {
+    /**
+     * SetPowerSupply uses a random gcode, M998, next to the other setup
+     * gcodes. It sets the power in watts the supply can share between the
+     * lid heater and the plate peltiers; the lid is served first and the
+     * plate is held to what is left. A figure at or above what both draw at
+     * full power removes the limit, which is also what the module starts up
+     * with. The figure is not saved.
+     *
+     * M998 S<watts>
+     */
+    using ParseResult = std::optional<SetPowerSupply>;
+    static constexpr auto prefix = std::array{'M', '9', '9', '8', ' ', 'S'};
+    static constexpr const char* response = "M998 OK\n";
+
+    double watts;
+
+    template <typename InputIt, typename InLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputIt, InLimit>
+    static auto write_response_into(InputIt buf, InLimit limit) -> InputIt {
+        return write_string_to_iterpair(buf, limit, response);
+    }
+
+    template <typename InputIt, typename Limit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto working = prefix_matches(input, limit, prefix);
+        if (working == input) {
+            return std::make_pair(ParseResult(), input);
+        }
+        auto watts = parse_value<float>(working, limit);
+        if (!watts.first.has_value() || (watts.first.value() < 0)) {
+            return std::make_pair(ParseResult(), input);
+        }
+        return std::make_pair(
+            ParseResult(SetPowerSupply{.watts = watts.first.value()}),
+            watts.second);
+    }
+};
+
+struct StartAutotune {
+    /**
+     * StartAutotune uses M303. It runs a relay-feedback autotune of one of
+     * the temperature control loops around the given setpoint, then applies
+     * the resulting PID constants to that loop. The response is only sent
+     * once tuning is finished, which may take several minutes.
+     *
+     * M303 S<selection> T<setpoint>
+     *
+     * Selection may be:
+     * - H = heater, with a setpoint from 37 to 110C
+     * - P = peltiers, with a setpoint from 4 to 99C
+     *
+     * The tune drives its loop at full power on either side of the
+     * setpoint, so setpoints outside the loop's operating range are refused.
+     *
+     * Returns the new constants as M303 P:<kp> I:<ki> D:<kd> OK
+     */
+    using ParseResult = std::optional<StartAutotune>;
+    static constexpr auto prefix = std::array{'M', '3', '0', '3', ' ', 'S'};
+    static constexpr auto prefix_setpoint = std::array{' ', 'T'};
+    static constexpr double heater_min_setpoint = 37.0;
+    static constexpr double heater_max_setpoint = 110.0;
+    static constexpr double peltier_min_setpoint = 4.0;
+    static constexpr double peltier_max_setpoint = 99.0;
+
+    PidSelection selection;
+    double setpoint;
+
+    template <typename InputIt, typename InLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputIt, InLimit>
+    static auto write_response_into(InputIt buf, InLimit limit, double kp,
+                                    double ki, double kd) -> InputIt {
+        auto res = snprintf(&*buf, (limit - buf),
+                            "M303 P:%0.4f I:%0.4f D:%0.4f OK\n",
+                            static_cast<float>(kp), static_cast<float>(ki),
+                            static_cast<float>(kd));
+        if (res <= 0) {
+            return buf;
+        }
+        return buf + res;
+    }
+
+    template <typename InputIt, typename Limit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<Limit, InputIt>
+    static auto parse(const InputIt& input, Limit limit)
+        -> std::pair<ParseResult, InputIt> {
+        auto working = prefix_matches(input, limit, prefix);
+        if (working == input || working == limit) {
+            return std::make_pair(ParseResult(), input);
+        }
+        PidSelection selection_val = PidSelection::PELTIERS;
+        switch (*working) {
+            case 'H':
+                selection_val = PidSelection::HEATER;
+                break;
+            case 'P':
+                selection_val = PidSelection::PELTIERS;
+                break;
+            default:
+                return std::make_pair(ParseResult(), input);
+        }
+        std::advance(working, 1);
+
+        auto old_working = working;
+        working = prefix_matches(old_working, limit, prefix_setpoint);
+        if (working == old_working) {
+            return std::make_pair(ParseResult(), input);
+        }
+        auto setpoint = parse_value<float>(working, limit);
+        if (!setpoint.first.has_value()) {
+            return std::make_pair(ParseResult(), input);
+        }
+        const bool heater = (selection_val == PidSelection::HEATER);
+        const double min_setpoint =
+            heater ? heater_min_setpoint : peltier_min_setpoint;
+        const double max_setpoint =
+            heater ? heater_max_setpoint : peltier_max_setpoint;
+        if ((setpoint.first.value() < min_setpoint) ||
+            (setpoint.first.value() > max_setpoint)) {
+            return std::make_pair(ParseResult(), input);
+        }
+        return std::make_pair(
+            ParseResult(StartAutotune{.selection = selection_val,
+                                      .setpoint = setpoint.first.value()}),
+            setpoint.second);
+    }
+};
+
 }  // namespace gcode
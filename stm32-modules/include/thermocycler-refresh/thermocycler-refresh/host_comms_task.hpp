@@ -17,6 +17,7 @@
 #include "thermocycler-refresh/gcodes.hpp"
 #include "thermocycler-refresh/messages.hpp"
 #include "thermocycler-refresh/tasks.hpp"
+#include "thermocycler-refresh/thermal_general.hpp"
 
 namespace tasks {
 template <template <class> class QueueImpl>
@@ -40,21 +41,37 @@ class HostCommsTask {
     using GCodeParser = gcode::GroupParser<
         gcode::EnterBootloader, gcode::GetSystemInfo, gcode::SetSerialNumber,
         gcode::GetLidTemperatureDebug, gcode::GetPlateTemperatureDebug,
+        gcode::GetPlateSampleTiming, gcode::GetPlateThermistorNoise,
+        gcode::SetPlateAcquisition, gcode::GetThermistorStats,
         gcode::SetPeltierDebug, gcode::SetFanManual, gcode::SetHeaterDebug,
         gcode::GetPlateTemp, gcode::GetLidTemp, gcode::SetLidTemperature,
         gcode::DeactivateLidHeating, gcode::SetPIDConstants,
-        gcode::SetPlateTemperature, gcode::DeactivatePlate>;
+        gcode::SetPlateTemperature, gcode::DeactivatePlate,
+        gcode::SetPlateControlMode, gcode::SetPowerSupply,
+        gcode::StartAutotune>;
     using AckOnlyCache =
         AckCache<8, gcode::EnterBootloader, gcode::SetSerialNumber,
                  gcode::SetPeltierDebug, gcode::SetFanManual,
                  gcode::SetHeaterDebug, gcode::SetLidTemperature,
                  gcode::DeactivateLidHeating, gcode::SetPIDConstants,
-                 gcode::SetPlateTemperature, gcode::DeactivatePlate>;
+                 gcode::SetPlateTemperature, gcode::DeactivatePlate,
+                 gcode::SetPlateControlMode, gcode::SetPlateAcquisition,
+                 gcode::SetPowerSupply>;
     using GetSystemInfoCache = AckCache<8, gcode::GetSystemInfo>;
     using GetLidTempDebugCache = AckCache<8, gcode::GetLidTemperatureDebug>;
     using GetPlateTempDebugCache = AckCache<8, gcode::GetPlateTemperatureDebug>;
     using GetPlateTempCache = AckCache<8, gcode::GetPlateTemp>;
     using GetLidTempCache = AckCache<8, gcode::GetLidTemp>;
+    using AutotuneCache = AckCache<8, gcode::StartAutotune>;
+    using GetPlateSampleTimingCache = AckCache<8, gcode::GetPlateSampleTiming>;
+    using GetPlateThermistorNoiseCache =
+        AckCache<8, gcode::GetPlateThermistorNoise>;
+    using GetThermistorStatsCache = AckCache<8, gcode::GetThermistorStats>;
+    static_assert(gcode::GetThermistorStats::thermistor_count == THERM_COUNT,
+                  "M105.S should number every thermistor");
+    static_assert(gcode::GetThermistorStats::max_window ==
+                      THERMISTOR_STATS_WINDOW,
+                  "M105.S should be able to ask for every reading kept");
 
   public:
     static constexpr size_t TICKS_TO_WAIT_ON_SEND = 10;
@@ -73,7 +90,15 @@ class HostCommsTask {
           // NOLINTNEXTLINE(readability-redundant-member-init)
           get_plate_temp_cache(),
           // NOLINTNEXTLINE(readability-redundant-member-init)
-          get_lid_temp_cache() {}
+          get_lid_temp_cache(),
+          // NOLINTNEXTLINE(readability-redundant-member-init)
+          autotune_cache(),
+          // NOLINTNEXTLINE(readability-redundant-member-init)
+          get_plate_sample_timing_cache(),
+          // NOLINTNEXTLINE(readability-redundant-member-init)
+          get_plate_thermistor_noise_cache(),
+          // NOLINTNEXTLINE(readability-redundant-member-init)
+          get_thermistor_stats_cache() {}
     HostCommsTask(const HostCommsTask& other) = delete;
     auto operator=(const HostCommsTask& other) -> HostCommsTask& = delete;
     HostCommsTask(HostCommsTask&& other) noexcept = delete;
@@ -373,6 +398,108 @@ class HostCommsTask {
             cache_entry);
     }
 
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_message(const messages::AutotuneResultResponse& response,
+                       InputIt tx_into, InputLimit tx_limit) -> InputIt {
+        auto cache_entry =
+            autotune_cache.remove_if_present(response.responding_to_id);
+        return std::visit(
+            [tx_into, tx_limit, response](auto cache_element) {
+                using T = std::decay_t<decltype(cache_element)>;
+                if constexpr (std::is_same_v<std::monostate, T>) {
+                    return errors::write_into(
+                        tx_into, tx_limit,
+                        errors::ErrorCode::BAD_MESSAGE_ACKNOWLEDGEMENT);
+                } else if (response.with_error !=
+                           errors::ErrorCode::NO_ERROR) {
+                    return errors::write_into(tx_into, tx_limit,
+                                              response.with_error);
+                } else {
+                    return cache_element.write_response_into(
+                        tx_into, tx_limit, response.kp, response.ki,
+                        response.kd);
+                }
+            },
+            cache_entry);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_message(const messages::GetPlateSampleTimingResponse& response,
+                       InputIt tx_into, InputLimit tx_limit) -> InputIt {
+        auto cache_entry = get_plate_sample_timing_cache.remove_if_present(
+            response.responding_to_id);
+        return std::visit(
+            [tx_into, tx_limit, response](auto cache_element) {
+                using T = std::decay_t<decltype(cache_element)>;
+                if constexpr (std::is_same_v<std::monostate, T>) {
+                    return errors::write_into(
+                        tx_into, tx_limit,
+                        errors::ErrorCode::BAD_MESSAGE_ACKNOWLEDGEMENT);
+                } else {
+                    return cache_element.write_response_into(
+                        tx_into, tx_limit, response.count, response.period_ms,
+                        response.stddev_ms, response.jitter_ms,
+                        response.acquisition_ms);
+                }
+            },
+            cache_entry);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_message(
+        const messages::GetPlateThermistorNoiseResponse& response,
+        InputIt tx_into, InputLimit tx_limit) -> InputIt {
+        auto cache_entry = get_plate_thermistor_noise_cache.remove_if_present(
+            response.responding_to_id);
+        return std::visit(
+            [tx_into, tx_limit, response](auto cache_element) {
+                using T = std::decay_t<decltype(cache_element)>;
+                if constexpr (std::is_same_v<std::monostate, T>) {
+                    return errors::write_into(
+                        tx_into, tx_limit,
+                        errors::ErrorCode::BAD_MESSAGE_ACKNOWLEDGEMENT);
+                } else {
+                    return cache_element.write_response_into(
+                        tx_into, tx_limit, response.count, response.heat_sink,
+                        response.front_right, response.front_left,
+                        response.front_center, response.back_right,
+                        response.back_left, response.back_center);
+                }
+            },
+            cache_entry);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_message(const messages::GetThermistorStatsResponse& response,
+                       InputIt tx_into, InputLimit tx_limit) -> InputIt {
+        auto cache_entry = get_thermistor_stats_cache.remove_if_present(
+            response.responding_to_id);
+        return std::visit(
+            [tx_into, tx_limit, response](auto cache_element) {
+                using T = std::decay_t<decltype(cache_element)>;
+                if constexpr (std::is_same_v<std::monostate, T>) {
+                    return errors::write_into(
+                        tx_into, tx_limit,
+                        errors::ErrorCode::BAD_MESSAGE_ACKNOWLEDGEMENT);
+                } else {
+                    return cache_element.write_response_into(
+                        tx_into, tx_limit, response.thermistor, response.count,
+                        response.min, response.max, response.mean,
+                        response.variance, response.invalid, response.total,
+                        response.total_invalid, response.drift);
+                }
+            },
+            cache_entry);
+    }
+
     /**
      * visit_gcode() is a set of member function overloads, each of which is
      * called when we parse the appropriate gcode out of the receive buffer.
@@ -541,6 +668,90 @@ class HostCommsTask {
         return std::make_pair(true, tx_into);
     }
 
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_gcode(const gcode::GetPlateSampleTiming& gcode,
+                     InputIt tx_into, InputLimit tx_limit)
+        -> std::pair<bool, InputIt> {
+        auto id = get_plate_sample_timing_cache.add(gcode);
+        if (id == 0) {
+            return std::make_pair(
+                false, errors::write_into(tx_into, tx_limit,
+                                          errors::ErrorCode::GCODE_CACHE_FULL));
+        }
+
+        auto message = messages::GetPlateSampleTimingMessage{.id = id};
+        if (!task_registry->thermal_plate->get_message_queue().try_send(
+                message, TICKS_TO_WAIT_ON_SEND)) {
+            auto wrote_to = errors::write_into(
+                tx_into, tx_limit, errors::ErrorCode::INTERNAL_QUEUE_FULL);
+            get_plate_sample_timing_cache.remove_if_present(id);
+            return std::make_pair(false, wrote_to);
+        }
+
+        return std::make_pair(true, tx_into);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_gcode(const gcode::GetPlateThermistorNoise& gcode,
+                     InputIt tx_into, InputLimit tx_limit)
+        -> std::pair<bool, InputIt> {
+        auto id = get_plate_thermistor_noise_cache.add(gcode);
+        if (id == 0) {
+            return std::make_pair(
+                false, errors::write_into(tx_into, tx_limit,
+                                          errors::ErrorCode::GCODE_CACHE_FULL));
+        }
+
+        auto message = messages::GetPlateThermistorNoiseMessage{.id = id};
+        if (!task_registry->thermal_plate->get_message_queue().try_send(
+                message, TICKS_TO_WAIT_ON_SEND)) {
+            auto wrote_to = errors::write_into(
+                tx_into, tx_limit, errors::ErrorCode::INTERNAL_QUEUE_FULL);
+            get_plate_thermistor_noise_cache.remove_if_present(id);
+            return std::make_pair(false, wrote_to);
+        }
+
+        return std::make_pair(true, tx_into);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_gcode(const gcode::GetThermistorStats& gcode, InputIt tx_into,
+                     InputLimit tx_limit) -> std::pair<bool, InputIt> {
+        auto id = get_thermistor_stats_cache.add(gcode);
+        if (id == 0) {
+            return std::make_pair(
+                false, errors::write_into(tx_into, tx_limit,
+                                          errors::ErrorCode::GCODE_CACHE_FULL));
+        }
+
+        auto message = messages::GetThermistorStatsMessage{
+            .id = id, .thermistor = gcode.thermistor, .window = gcode.window};
+        // The lid thermistor belongs to the lid heater; the rest are the
+        // plate's
+        bool sent = false;
+        if (gcode.thermistor == THERM_LID) {
+            sent = task_registry->lid_heater->get_message_queue().try_send(
+                message, TICKS_TO_WAIT_ON_SEND);
+        } else {
+            sent = task_registry->thermal_plate->get_message_queue().try_send(
+                message, TICKS_TO_WAIT_ON_SEND);
+        }
+        if (!sent) {
+            auto wrote_to = errors::write_into(
+                tx_into, tx_limit, errors::ErrorCode::INTERNAL_QUEUE_FULL);
+            get_thermistor_stats_cache.remove_if_present(id);
+            return std::make_pair(false, wrote_to);
+        }
+
+        return std::make_pair(true, tx_into);
+    }
+
     template <typename InputIt, typename InputLimit>
     requires std::forward_iterator<InputIt> &&
         std::sized_sentinel_for<InputLimit, InputIt>
@@ -740,8 +951,11 @@ class HostCommsTask {
                                           errors::ErrorCode::GCODE_CACHE_FULL));
         }
 
-        auto message = messages::SetPlateTemperatureMessage{
-            .id = id, .setpoint = gcode.setpoint, .hold_time = gcode.hold_time};
+        auto message =
+            messages::SetPlateTemperatureMessage{.id = id,
+                                                 .setpoint = gcode.setpoint,
+                                                 .hold_time = gcode.hold_time,
+                                                 .volume = gcode.volume};
         if (!task_registry->thermal_plate->get_message_queue().try_send(
                 message, TICKS_TO_WAIT_ON_SEND)) {
             auto wrote_to = errors::write_into(
@@ -777,6 +991,117 @@ class HostCommsTask {
         return std::make_pair(true, tx_into);
     }
 
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_gcode(const gcode::SetPlateControlMode& gcode, InputIt tx_into,
+                     InputLimit tx_limit) -> std::pair<bool, InputIt> {
+        auto id = ack_only_cache.add(gcode);
+        if (id == 0) {
+            return std::make_pair(
+                false, errors::write_into(tx_into, tx_limit,
+                                          errors::ErrorCode::GCODE_CACHE_FULL));
+        }
+
+        auto message =
+            messages::SetPlateControlModeMessage{.id = id, .mode = gcode.mode};
+        if (!task_registry->thermal_plate->get_message_queue().try_send(
+                message, TICKS_TO_WAIT_ON_SEND)) {
+            auto wrote_to = errors::write_into(
+                tx_into, tx_limit, errors::ErrorCode::INTERNAL_QUEUE_FULL);
+            ack_only_cache.remove_if_present(id);
+            return std::make_pair(false, wrote_to);
+        }
+
+        return std::make_pair(true, tx_into);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_gcode(const gcode::SetPowerSupply& gcode, InputIt tx_into,
+                     InputLimit tx_limit) -> std::pair<bool, InputIt> {
+        auto id = ack_only_cache.add(gcode);
+        if (id == 0) {
+            return std::make_pair(
+                false, errors::write_into(tx_into, tx_limit,
+                                          errors::ErrorCode::GCODE_CACHE_FULL));
+        }
+
+        auto message =
+            messages::SetPowerSupplyMessage{.id = id, .watts = gcode.watts};
+        if (!task_registry->thermal_plate->get_message_queue().try_send(
+                message, TICKS_TO_WAIT_ON_SEND)) {
+            auto wrote_to = errors::write_into(
+                tx_into, tx_limit, errors::ErrorCode::INTERNAL_QUEUE_FULL);
+            ack_only_cache.remove_if_present(id);
+            return std::make_pair(false, wrote_to);
+        }
+
+        return std::make_pair(true, tx_into);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_gcode(const gcode::SetPlateAcquisition& gcode, InputIt tx_into,
+                     InputLimit tx_limit) -> std::pair<bool, InputIt> {
+        auto id = ack_only_cache.add(gcode);
+        if (id == 0) {
+            return std::make_pair(
+                false, errors::write_into(tx_into, tx_limit,
+                                          errors::ErrorCode::GCODE_CACHE_FULL));
+        }
+
+        auto message = messages::SetPlateAcquisitionMessage{
+            .id = id,
+            .data_rate_sps = gcode.data_rate_sps,
+            .oversample = gcode.oversample,
+            .filter = gcode.filter,
+            .filter_alpha = gcode.filter_alpha};
+        if (!task_registry->thermal_plate->get_message_queue().try_send(
+                message, TICKS_TO_WAIT_ON_SEND)) {
+            auto wrote_to = errors::write_into(
+                tx_into, tx_limit, errors::ErrorCode::INTERNAL_QUEUE_FULL);
+            ack_only_cache.remove_if_present(id);
+            return std::make_pair(false, wrote_to);
+        }
+
+        return std::make_pair(true, tx_into);
+    }
+
+    template <typename InputIt, typename InputLimit>
+    requires std::forward_iterator<InputIt> &&
+        std::sized_sentinel_for<InputLimit, InputIt>
+    auto visit_gcode(const gcode::StartAutotune& gcode, InputIt tx_into,
+                     InputLimit tx_limit) -> std::pair<bool, InputIt> {
+        auto id = autotune_cache.add(gcode);
+        if (id == 0) {
+            return std::make_pair(
+                false, errors::write_into(tx_into, tx_limit,
+                                          errors::ErrorCode::GCODE_CACHE_FULL));
+        }
+
+        auto message = messages::StartAutotuneMessage{
+            .id = id, .selection = gcode.selection, .setpoint = gcode.setpoint};
+        bool ret = false;
+        if (message.selection == PidSelection::HEATER) {
+            ret = task_registry->lid_heater->get_message_queue().try_send(
+                message, TICKS_TO_WAIT_ON_SEND);
+        } else {
+            ret = task_registry->thermal_plate->get_message_queue().try_send(
+                message, TICKS_TO_WAIT_ON_SEND);
+        }
+        if (!ret) {
+            auto wrote_to = errors::write_into(
+                tx_into, tx_limit, errors::ErrorCode::INTERNAL_QUEUE_FULL);
+            autotune_cache.remove_if_present(id);
+            return std::make_pair(false, wrote_to);
+        }
+
+        return std::make_pair(true, tx_into);
+    }
+
     // Our error handler just writes an error and bails
     template <typename InputIt, typename InputLimit>
     requires std::forward_iterator<InputIt> &&
@@ -797,6 +1122,10 @@ class HostCommsTask {
     GetPlateTempDebugCache get_plate_temp_debug_cache;
     GetPlateTempCache get_plate_temp_cache;
     GetLidTempCache get_lid_temp_cache;
+    AutotuneCache autotune_cache;
+    GetPlateSampleTimingCache get_plate_sample_timing_cache;
+    GetPlateThermistorNoiseCache get_plate_thermistor_noise_cache;
+    GetThermistorStatsCache get_thermistor_stats_cache;
     bool may_connect_latch = true;
 };
 
@@ -6,14 +6,18 @@
 #include <algorithm>
 #include <concepts>
 #include <cstddef>
+#include <optional>
 #include <variant>
 
 #include "core/pid.hpp"
+#include "core/relay_autotune.hpp"
+#include "core/thermal_fault_monitor.hpp"
 #include "core/thermistor_conversion.hpp"
 #include "hal/message_queue.hpp"
 #include "thermistor_lookups.hpp"
 #include "thermocycler-refresh/errors.hpp"
 #include "thermocycler-refresh/messages.hpp"
+#include "thermocycler-refresh/power_budget.hpp"
 #include "thermocycler-refresh/tasks.hpp"
 #include "thermocycler-refresh/thermal_general.hpp"
 
@@ -42,12 +46,14 @@ struct State {
         IDLE,        /**< Not doing anything.*/
         ERROR,       /**< Experiencing an error.*/
         CONTROLLING, /**< Controlling temperature (PID).*/
-        HEATER_TEST  /**< Testing PWM output (debug command).*/
+        HEATER_TEST, /**< Testing PWM output (debug command).*/
+        AUTOTUNING   /**< Relay autotuning the heater PID.*/
     };
     Status system_status;
     uint16_t error_bitmap;
     static constexpr uint16_t LID_THERMISTOR_ERROR = (1 << 0);
     static constexpr uint16_t HEATER_POWER_ERROR = (1 << 1);
+    static constexpr uint16_t HEATER_FAULT_ERROR = (1 << 2);
 };
 
 // By using a template template parameter here, we allow the code instantiating
@@ -73,9 +79,19 @@ class LidHeaterTask {
     static constexpr double KD_MIN = -200;
     static constexpr double KD_MAX = 200;
     static constexpr double OVERTEMP_LIMIT_C = 115;
+    static constexpr double AUTOTUNE_HYSTERESIS_C = 0.5;
     // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
     static constexpr const double CONTROL_PERIOD_SECONDS =
         CONTROL_PERIOD_TICKS * 0.001;
+    // While heating at half power or more from further than the band below
+    // the setpoint, the lid must warm up by the minimum response within a
+    // window; with the heater off, it may not climb more than the max rise
+    static constexpr ThermalFaultMonitor::Limits FAULT_LIMITS{
+        .window_s = 30.0,
+        .drive_threshold = 0.5,
+        .target_band_c = 5.0,
+        .min_response_c = 2.0,
+        .max_undriven_rise_c = 3.0};
 
     explicit LidHeaterTask(Queue& q)
         : _message_queue(q),
@@ -92,7 +108,11 @@ class LidHeaterTask {
           _state{.system_status = State::IDLE, .error_bitmap = 0},
           _pid(DEFAULT_KP, DEFAULT_KI, DEFAULT_KD, CONTROL_PERIOD_SECONDS, 1.0,
                -1.0),
-          _setpoint_c(0.0F) {}
+          _setpoint_c(0.0F),
+          _autotune(std::nullopt),
+          _autotune_id(0),
+          _fault_monitor(FAULT_LIMITS, CONTROL_PERIOD_SECONDS),
+          _fault_error(errors::ErrorCode::NO_ERROR) {}
     LidHeaterTask(const LidHeaterTask& other) = delete;
     auto operator=(const LidHeaterTask& other) -> LidHeaterTask& = delete;
     LidHeaterTask(LidHeaterTask&& other) noexcept = delete;
@@ -151,7 +171,10 @@ class LidHeaterTask {
             if (_state.error_bitmap != 0) {
                 // We entered an error state. Disable power output.
                 _state.system_status = State::ERROR;
-                policy.set_heater_power(0.0F);
+                set_heater_power(0.0F, policy);
+                if (_autotune.has_value()) {
+                    finish_autotune(most_relevant_error());
+                }
             } else {
                 // We went from an error state to no error state... so go idle
                 _state.system_status = State::IDLE;
@@ -160,15 +183,27 @@ class LidHeaterTask {
 
         // If we're in a controlling state, we now update the heater output
         if (_state.system_status == State::CONTROLLING) {
-            auto ret = policy.set_heater_power(
-                _pid.compute(_setpoint_c - _thermistor.temp_c));
+            check_thermal_fault(policy);
+        }
+        if (_state.system_status == State::CONTROLLING) {
+            // The integrator is held to what the supply can actually deliver
+            // so it doesn't wind up while the budget is saturated
+            auto ceiling =
+                _task_registry->power_budget.ceiling(power::LID_HEATER);
+            _pid.set_windup_limits(ceiling, _pid.windup_limit_low());
+            auto ret = set_heater_power(
+                std::clamp(_pid.compute(_setpoint_c - _thermistor.temp_c), 0.0,
+                           ceiling),
+                policy);
             if (!ret) {
-                policy.set_heater_power(0.0F);
+                set_heater_power(0.0F, policy);
                 _state.system_status = State::ERROR;
                 _state.error_bitmap |= State::HEATER_POWER_ERROR;
             }
+        } else if (_state.system_status == State::AUTOTUNING) {
+            update_autotune(policy);
         } else if (_state.system_status != State::HEATER_TEST) {
-            policy.set_heater_power(0.0F);
+            set_heater_power(0.0F, policy);
         }
     }
 
@@ -186,6 +221,27 @@ class LidHeaterTask {
             messages::HostCommsMessage(response)));
     }
 
+    template <LidHeaterExecutionPolicy Policy>
+    auto visit_message(const messages::GetThermistorStatsMessage& msg,
+                       Policy& policy) -> void {
+        static_cast<void>(policy);
+        const auto& stats = _thermistor.stats;
+        auto response = messages::GetThermistorStatsResponse{
+            .responding_to_id = msg.id,
+            .thermistor = msg.thermistor,
+            .count = static_cast<uint32_t>(stats.count(msg.window)),
+            .min = stats.min(msg.window),
+            .max = stats.max(msg.window),
+            .mean = stats.mean(msg.window),
+            .variance = stats.variance(msg.window),
+            .invalid = static_cast<uint32_t>(stats.invalid(msg.window)),
+            .total = stats.total(),
+            .total_invalid = stats.total_invalid(),
+            .drift = stats.drift()};
+        static_cast<void>(_task_registry->comms->get_message_queue().try_send(
+            messages::HostCommsMessage(response)));
+    }
+
     template <typename Policy>
     requires LidHeaterExecutionPolicy<Policy>
     auto visit_message(const messages::GetLidTempMessage& msg, Policy& policy)
@@ -213,7 +269,8 @@ class LidHeaterTask {
                 _task_registry->comms->get_message_queue().try_send(response));
             return;
         }
-        if (_state.system_status == State::CONTROLLING) {
+        if ((_state.system_status == State::CONTROLLING) ||
+            (_state.system_status == State::AUTOTUNING)) {
             // Send busy error
             response.with_error = errors::ErrorCode::THERMAL_LID_BUSY;
             static_cast<void>(
@@ -221,7 +278,7 @@ class LidHeaterTask {
             return;
         }
 
-        if (policy.set_heater_power(msg.power)) {
+        if (set_heater_power(msg.power, policy)) {
             _state.system_status =
                 (msg.power > 0.0) ? State::HEATER_TEST : State::IDLE;
         } else {
@@ -245,8 +302,14 @@ class LidHeaterTask {
                 _task_registry->comms->get_message_queue().try_send(response));
             return;
         }
+        if (_state.system_status == State::AUTOTUNING) {
+            response.with_error = errors::ErrorCode::THERMAL_LID_BUSY;
+            static_cast<void>(
+                _task_registry->comms->get_message_queue().try_send(response));
+            return;
+        }
         if (_state.system_status == State::HEATER_TEST) {
-            auto ret = policy.set_heater_power(0.0F);
+            auto ret = set_heater_power(0.0F, policy);
             if (!ret) {
                 response.with_error = errors::ErrorCode::THERMAL_HEATER_ERROR;
                 _state.system_status = State::ERROR;
@@ -263,6 +326,9 @@ class LidHeaterTask {
             _state.system_status = State::IDLE;
         } else {
             _setpoint_c = msg.setpoint;
+            if (_state.system_status != State::CONTROLLING) {
+                _fault_monitor.reset();
+            }
             _state.system_status = State::CONTROLLING;
             _pid.arm_integrator_reset(_setpoint_c - _thermistor.temp_c);
         }
@@ -284,8 +350,12 @@ class LidHeaterTask {
             return;
         }
 
-        auto ret = policy.set_heater_power(0.0F);
+        auto ret = set_heater_power(0.0F, policy);
         _state.system_status = State::IDLE;
+        if (_autotune.has_value()) {
+            // Deactivating cancels a tune in progress
+            finish_autotune(errors::ErrorCode::THERMAL_AUTOTUNE_FAILED);
+        }
 
         if (!ret) {
             response.with_error = errors::ErrorCode::THERMAL_HEATER_ERROR;
@@ -304,7 +374,8 @@ class LidHeaterTask {
         auto response =
             messages::AcknowledgePrevious{.responding_to_id = msg.id};
 
-        if (_state.system_status == State::CONTROLLING) {
+        if ((_state.system_status == State::CONTROLLING) ||
+            (_state.system_status == State::AUTOTUNING)) {
             response.with_error = errors::ErrorCode::THERMAL_LID_BUSY;
             static_cast<void>(
                 _task_registry->comms->get_message_queue().try_send(response));
@@ -324,6 +395,110 @@ class LidHeaterTask {
             _task_registry->comms->get_message_queue().try_send(response));
     }
 
+    template <LidHeaterExecutionPolicy Policy>
+    auto visit_message(const messages::StartAutotuneMessage& msg,
+                       Policy& policy) -> void {
+        auto response =
+            messages::AutotuneResultResponse{.responding_to_id = msg.id};
+        if (_state.system_status == State::ERROR) {
+            response.with_error = most_relevant_error();
+        } else if ((_state.system_status == State::CONTROLLING) ||
+                   (_state.system_status == State::AUTOTUNING)) {
+            response.with_error = errors::ErrorCode::THERMAL_LID_BUSY;
+        } else if (!set_heater_power(0.0F, policy)) {
+            response.with_error = errors::ErrorCode::THERMAL_HEATER_ERROR;
+            _state.system_status = State::ERROR;
+            _state.error_bitmap |= State::HEATER_POWER_ERROR;
+        }
+        if (response.with_error != errors::ErrorCode::NO_ERROR) {
+            static_cast<void>(
+                _task_registry->comms->get_message_queue().try_send(response));
+            return;
+        }
+        // The response is held until the tune finishes
+        _autotune.emplace(msg.setpoint, 1.0, 0.0, AUTOTUNE_HYSTERESIS_C,
+                          CONTROL_PERIOD_SECONDS);
+        _autotune_id = msg.id;
+        _state.system_status = State::AUTOTUNING;
+    }
+
+    /**
+     * Runs one step of an in-progress autotune, and once it's over applies
+     * the new gains and answers the message that started it.
+     */
+    template <LidHeaterExecutionPolicy Policy>
+    auto update_autotune(Policy& policy) -> void {
+        if (!set_heater_power(_autotune->update(_thermistor.temp_c), policy)) {
+            set_heater_power(0.0F, policy);
+            _state.system_status = State::ERROR;
+            _state.error_bitmap |= State::HEATER_POWER_ERROR;
+            finish_autotune(errors::ErrorCode::THERMAL_HEATER_ERROR);
+            return;
+        }
+        if (_autotune->status() == RelayAutotune::Status::RUNNING) {
+            return;
+        }
+        set_heater_power(0.0F, policy);
+        _state.system_status = State::IDLE;
+        auto error = errors::ErrorCode::THERMAL_AUTOTUNE_FAILED;
+        if (_autotune->status() == RelayAutotune::Status::DONE &&
+            (_autotune->kp() <= KP_MAX) && (_autotune->ki() <= KI_MAX) &&
+            (_autotune->kd() <= KD_MAX)) {
+            _pid = PID(_autotune->kp(), _autotune->ki(), _autotune->kd(),
+                       CONTROL_PERIOD_SECONDS, 1.0, -1.0);
+            error = errors::ErrorCode::NO_ERROR;
+        }
+        finish_autotune(error);
+    }
+
+    auto finish_autotune(errors::ErrorCode error) -> void {
+        auto response =
+            messages::AutotuneResultResponse{.responding_to_id = _autotune_id,
+                                             .kp = _autotune->kp(),
+                                             .ki = _autotune->ki(),
+                                             .kd = _autotune->kd(),
+                                             .with_error = error};
+        _autotune.reset();
+        static_cast<void>(
+            _task_registry->comms->get_message_queue().try_send(response));
+    }
+
+    /**
+     * Sets the heater output and publishes it to the power budget, so the
+     * plate knows how much of the supply is left.
+     */
+    template <LidHeaterExecutionPolicy Policy>
+    auto set_heater_power(double power, Policy& policy) -> bool {
+        auto ret = policy.set_heater_power(power);
+        _task_registry->power_budget.set_demand(power::LID_HEATER,
+                                                ret ? power : 0.0);
+        return ret;
+    }
+
+    /**
+     * Compares the heater output applied over the last period against how
+     * the lid temperature moved. A fault turns the heater off and, like a
+     * heater power error, latches until the system restarts.
+     */
+    template <LidHeaterExecutionPolicy Policy>
+    auto check_thermal_fault(Policy& policy) -> void {
+        auto fault = _fault_monitor.update(_thermistor.temp_c, _setpoint_c,
+                                           policy.get_heater_power());
+        if (fault == ThermalFaultMonitor::Fault::NONE) {
+            return;
+        }
+        _fault_error = (fault == ThermalFaultMonitor::Fault::RUNAWAY)
+                           ? errors::ErrorCode::THERMAL_LID_RUNAWAY
+                           : errors::ErrorCode::THERMAL_LID_NO_RESPONSE;
+        set_heater_power(0.0F, policy);
+        _state.system_status = State::ERROR;
+        _state.error_bitmap |= State::HEATER_FAULT_ERROR;
+        auto error_message = messages::HostCommsMessage(
+            messages::ErrorMessage{.code = _fault_error});
+        static_cast<void>(
+            _task_registry->comms->get_message_queue().try_send(error_message));
+    }
+
     auto handle_temperature_conversion(uint16_t conversion_result,
                                        Thermistor& thermistor) -> void {
         auto visitor = [this, &thermistor](const auto value) -> void {
@@ -360,6 +535,7 @@ class LidHeaterTask {
                 break;
             }
         }
+        therm.stats.add_invalid();
     }
 
     auto visit_conversion(Thermistor& therm, const double temp) -> void {
@@ -369,6 +545,7 @@ class LidHeaterTask {
             therm.error = errors::ErrorCode::NO_ERROR;
         }
         therm.temp_c = temp;
+        therm.stats.add(temp);
     }
 
     [[nodiscard]] auto most_relevant_error() const -> errors::ErrorCode {
@@ -381,6 +558,10 @@ class LidHeaterTask {
             _thermistor.error_bit) {
             return _thermistor.error;
         }
+        if ((_state.error_bitmap & State::HEATER_FAULT_ERROR) ==
+            State::HEATER_FAULT_ERROR) {
+            return _fault_error;
+        }
         if ((_state.error_bitmap & State::HEATER_POWER_ERROR) ==
             State::HEATER_POWER_ERROR) {
             return errors::ErrorCode::THERMAL_HEATER_ERROR;
@@ -396,6 +577,10 @@ class LidHeaterTask {
     State _state;
     PID _pid;
     double _setpoint_c;
+    std::optional<RelayAutotune> _autotune;
+    uint32_t _autotune_id;
+    ThermalFaultMonitor _fault_monitor;
+    errors::ErrorCode _fault_error;
 };
 
 }  // namespace lid_heater_task
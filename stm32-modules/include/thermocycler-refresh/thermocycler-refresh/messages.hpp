@@ -2,8 +2,10 @@
 #include <array>
 #include <concepts>
 #include <cstdint>
+#include <limits>
 #include <variant>
 
+#include "core/adc_filter.hpp"
 #include "systemwide.h"
 #include "thermocycler-refresh/errors.hpp"
 
@@ -88,6 +90,11 @@ struct ThermalPlateTempReadComplete {
     uint16_t back_right;
     uint16_t back_center;
     uint16_t back_left;
+    // When the first conversion of the scan finished, from a free running
+    // microsecond counter
+    uint32_t timestamp_us = 0;
+    // Time from starting the scan to the last conversion finishing
+    uint32_t acquisition_us = 0;
 };
 
 struct LidTempReadComplete {
@@ -178,6 +185,7 @@ struct SetPlateTemperatureMessage {
     uint32_t id;
     double setpoint;
     double hold_time;
+    double volume = 0.0F;
 };
 
 struct DeactivatePlateMessage {
@@ -192,6 +200,89 @@ struct SetPIDConstantsMessage {
     double d;
 };
 
+struct SetPlateControlModeMessage {
+    uint32_t id;
+    PlateControlMode mode;
+};
+
+struct SetPowerSupplyMessage {
+    uint32_t id;
+    double watts;
+};
+
+struct SetPlateAcquisitionMessage {
+    uint32_t id;
+    uint16_t data_rate_sps;
+    uint8_t oversample;
+    AdcFilter::Mode filter;
+    double filter_alpha;
+};
+
+struct GetPlateSampleTimingMessage {
+    uint32_t id;
+};
+
+struct GetPlateSampleTimingResponse {
+    uint32_t responding_to_id;
+    uint32_t count;
+    double period_ms;
+    double stddev_ms;
+    double jitter_ms;
+    double acquisition_ms;
+};
+
+struct GetPlateThermistorNoiseMessage {
+    uint32_t id;
+};
+
+struct GetPlateThermistorNoiseResponse {
+    uint32_t responding_to_id;
+    uint32_t count;
+    double heat_sink;
+    double front_right;
+    double front_left;
+    double front_center;
+    double back_right;
+    double back_left;
+    double back_center;
+};
+
+struct GetThermistorStatsMessage {
+    uint32_t id;
+    uint8_t thermistor;
+    // How many of the most recent readings to cover; all that are kept if
+    // there are fewer
+    uint32_t window = std::numeric_limits<uint32_t>::max();
+};
+
+struct GetThermistorStatsResponse {
+    uint32_t responding_to_id;
+    uint8_t thermistor;
+    uint32_t count;
+    double min;
+    double max;
+    double mean;
+    double variance;
+    uint32_t invalid;
+    uint32_t total;
+    uint32_t total_invalid;
+    double drift;
+};
+
+struct StartAutotuneMessage {
+    uint32_t id;
+    PidSelection selection;
+    double setpoint;
+};
+
+struct AutotuneResultResponse {
+    uint32_t responding_to_id;
+    double kp;
+    double ki;
+    double kd;
+    errors::ErrorCode with_error = errors::ErrorCode::NO_ERROR;
+};
+
 using SystemMessage =
     ::std::variant<std::monostate, EnterBootloaderMessage, AcknowledgePrevious,
                    SetSerialNumberMessage, GetSystemInfoMessage>;
@@ -200,16 +291,22 @@ using HostCommsMessage =
                    ErrorMessage, ForceUSBDisconnectMessage,
                    GetSystemInfoResponse, GetLidTemperatureDebugResponse,
                    GetPlateTemperatureDebugResponse, GetPlateTempResponse,
-                   GetLidTempResponse>;
+                   GetLidTempResponse, AutotuneResultResponse,
+                   GetPlateSampleTimingResponse,
+                   GetPlateThermistorNoiseResponse, GetThermistorStatsResponse>;
 using ThermalPlateMessage =
     ::std::variant<std::monostate, ThermalPlateTempReadComplete,
                    GetPlateTemperatureDebugMessage, SetPeltierDebugMessage,
                    SetFanManualMessage, GetPlateTempMessage,
                    SetPlateTemperatureMessage, DeactivatePlateMessage,
-                   SetPIDConstantsMessage>;
+                   SetPIDConstantsMessage, SetPlateControlModeMessage,
+                   StartAutotuneMessage, GetPlateSampleTimingMessage,
+                   GetPlateThermistorNoiseMessage, SetPlateAcquisitionMessage,
+                   GetThermistorStatsMessage, SetPowerSupplyMessage>;
 using LidHeaterMessage =
     ::std::variant<std::monostate, LidTempReadComplete,
                    GetLidTemperatureDebugMessage, SetHeaterDebugMessage,
                    GetLidTempMessage, SetLidTemperatureMessage,
-                   DeactivateLidHeatingMessage, SetPIDConstantsMessage>;
+                   DeactivateLidHeatingMessage, SetPIDConstantsMessage,
+                   StartAutotuneMessage, GetThermistorStatsMessage>;
 };  // namespace messages
@@ -0,0 +1,32 @@
+/**
+ * The thermocycler-refresh lid heater and plate peltiers share one supply.
+ * This file names them as consumers of the shared power budget and holds
+ * their nominal power figures.
+ */
+#pragma once
+
+#include <cstddef>
+
+#include "core/power_budget.hpp"
+
+namespace power {
+
+/** Consumers of the supply, in priority order. The lid is served first so
+ * that it pre-heats ahead of the plate ramp when both start together.*/
+enum Consumer : size_t {
+    LID_HEATER = 0,
+    THERMAL_PLATE = 1,
+    CONSUMER_COUNT = 2,
+};
+
+// The supply has not been measured with the lid and plate both at full
+// power, so the budget starts without a supply limit (see tasks::Tasks)
+// until one is set with M998; until then the figures below only scale the
+// published demands
+static constexpr double LID_HEATER_MAX_WATTS = 60.0;
+// All three peltiers at full power
+static constexpr double THERMAL_PLATE_MAX_WATTS = 165.0;
+
+using Budget = PowerBudget<CONSUMER_COUNT>;
+
+}  // namespace power
@@ -9,6 +9,7 @@
 #include "host_comms_task.hpp"
 #include "lid_heater_task.hpp"
 #include "messages.hpp"
+#include "power_budget.hpp"
 #include "system_task.hpp"
 #include "thermal_plate_task.hpp"
 
@@ -88,5 +89,10 @@ struct Tasks {
     thermal_plate_task::ThermalPlateTask<QueueImpl>* thermal_plate;
     // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
     lid_heater_task::LidHeaterTask<QueueImpl>* lid_heater;
+    // Shared between the lid heater and thermal plate tasks, with no supply
+    // limit until M998 sets one
+    // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+    power::Budget power_budget{
+        {power::LID_HEATER_MAX_WATTS, power::THERMAL_PLATE_MAX_WATTS}};
 };
 }  // namespace tasks
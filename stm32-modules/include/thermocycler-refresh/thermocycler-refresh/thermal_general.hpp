@@ -5,7 +5,9 @@
 #pragma once
 
 #include "core/pid.hpp"
+#include "core/thermal_fault_monitor.hpp"
 #include "core/thermistor_conversion.hpp"
+#include "core/thermistor_stats.hpp"
 #include "systemwide.h"
 #include "thermocycler-refresh/errors.hpp"
 
@@ -26,6 +28,9 @@ enum ThermistorID {
     THERM_COUNT
 };
 
+/** Readings covered by each thermistor's rolling statistics.*/
+static constexpr size_t THERMISTOR_STATS_WINDOW = 64;
+
 // Disabled lint warning because we specifically want the rest
 // of the parameters to be initialized by the task constructor
 // NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init)
@@ -36,6 +41,9 @@ struct Thermistor {
     uint16_t last_adc = 0;
     // Current error
     errors::ErrorCode error = errors::ErrorCode::NO_ERROR;
+    // Health statistics, updated with every conversion
+    ThermistorStats<THERMISTOR_STATS_WINDOW> stats =
+        ThermistorStats<THERMISTOR_STATS_WINDOW>();
     // These constant values should be set when the struct is initialized
     // in order to capture errors specific to a sensor that require
     // a system restart to rectify
@@ -55,4 +63,6 @@ struct Peltier {
     double temp_target = 0.0F;
     // Current PID loop
     PID pid;
+    // Checks that the zone temperature follows this peltier's output
+    ThermalFaultMonitor fault_monitor;
 };
@@ -4,15 +4,24 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
 #include <concepts>
 #include <cstddef>
+#include <functional>
+#include <optional>
+#include <utility>
 #include <variant>
 
+#include "core/adc_filter.hpp"
+#include "core/period_stats.hpp"
 #include "core/pid.hpp"
+#include "core/relay_autotune.hpp"
+#include "core/thermal_fault_monitor.hpp"
 #include "core/thermistor_conversion.hpp"
 #include "hal/message_queue.hpp"
 #include "thermocycler-refresh/errors.hpp"
 #include "thermocycler-refresh/messages.hpp"
+#include "thermocycler-refresh/power_budget.hpp"
 #include "thermocycler-refresh/tasks.hpp"
 #include "thermocycler-refresh/thermal_general.hpp"
 
@@ -43,6 +52,13 @@ concept ThermalPlateExecutionPolicy = requires(Policy& p, PeltierID id,
     // a percentage from 0 to 1.0
     // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
     { p.set_fan(1.0F) } -> std::same_as<bool>;
+    // A set_acquisition function to change how the plate thermistors are
+    // sampled, from the next scan on. Returns false, changing nothing, if
+    // the hardware can't take the settings.
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
+    {
+        p.set_acquisition(860, 4, AdcFilter::Mode::NONE, 0.5)
+        } -> std::same_as<bool>;
 };
 
 /** Just used for initialization assignment of error bits.*/
@@ -58,7 +74,8 @@ struct State {
         IDLE,        /**< Not doing anything.*/
         ERROR,       /**< Experiencing an error*/
         CONTROLLING, /**< Controlling temperature (PID)*/
-        PWM_TEST     /**< Testing PWM output (debug command)*/
+        PWM_TEST,    /**< Testing PWM output (debug command)*/
+        AUTOTUNING   /**< Relay autotuning the peltier PID*/
     };
     Status system_status;
     uint16_t error_bitmap;
@@ -66,6 +83,8 @@ struct State {
     // initializor. Additional errors are defined assuming the max thermistor
     // error is (1 << 6), for the heat sink
     static constexpr uint16_t PELTIER_ERROR = (1 << 7);
+    static constexpr uint16_t THERMISTOR_MISMATCH_ERROR = (1 << 8);
+    static constexpr uint16_t PELTIER_FAULT_ERROR = (1 << 9);
 };
 
 // By using a template template parameter here, we allow the code instantiating
@@ -95,6 +114,51 @@ class ThermalPlateTask {
     // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
     static constexpr const double CONTROL_PERIOD_SECONDS =
         CONTROL_PERIOD_TICKS * 0.001;
+    static constexpr uint32_t CONTROL_PERIOD_US = CONTROL_PERIOD_TICKS * 1000;
+    // Thermistor noise is measured over this many readings (3.2s)
+    static constexpr size_t NOISE_WINDOW = THERMISTOR_STATS_WINDOW;
+    // Uniformity mode: power added to each zone per degree it sits below
+    // the mean of all six plate thermistors
+    static constexpr double UNIFORMITY_GAIN = 0.5;
+    // Uniformity mode: power added to every zone per degree between the
+    // zone target and the heatsink, to pre-compensate heatsink leakage
+    static constexpr double HEATSINK_FEEDFORWARD_GAIN = 0.002;
+    // Autotune drives all three peltiers together, heating and cooling at
+    // this power around the setpoint
+    static constexpr double AUTOTUNE_RELAY_POWER = 1.0;
+    static constexpr double AUTOTUNE_HYSTERESIS_C = 0.5;
+    // When a sample volume is given, the plate target is pushed past the
+    // setpoint by (C + PER_UL * volume) in the direction of the step, as in
+    // the legacy firmware, until the modelled sample temperature catches up
+    static constexpr double HEATING_OVERSHOOT_C = 1.0869;
+    static constexpr double HEATING_OVERSHOOT_PER_UL = 0.0105;
+    static constexpr double COOLING_OVERSHOOT_C = 0.4302;
+    static constexpr double COOLING_OVERSHOOT_PER_UL = 0.0133;
+    // Steps smaller than this do not overshoot
+    static constexpr double OVERSHOOT_MIN_STEP_C = 0.5;
+    // The overshoot target never leaves this range
+    static constexpr double OVERSHOOT_TARGET_MIN_C = 0.0;
+    static constexpr double OVERSHOOT_TARGET_MAX_C = 105.0;
+    // The sample is modelled as a first order lag behind the average plate
+    // temperature, with a time constant that grows with volume
+    static constexpr double SAMPLE_TAU_BASE_S = 2.0;
+    static constexpr double SAMPLE_TAU_PER_UL_S = 0.15;
+    // The overshoot ends once the modelled sample is this close to the
+    // setpoint
+    static constexpr double SAMPLE_SETTLE_BAND_C = 0.5;
+    // While a peltier is driven at half power or more from further than the
+    // band away from its target, its zone must move by the minimum response
+    // within a window; while it isn't heating, the zone may not climb more
+    // than the max rise
+    static constexpr ThermalFaultMonitor::Limits FAULT_LIMITS{
+        .window_s = 10.0,
+        .drive_threshold = 0.5,
+        .target_band_c = 3.0,
+        .min_response_c = 1.0,
+        .max_undriven_rise_c = 2.0};
+    // The front and back thermistors of a zone sit on the same peltier and
+    // shouldn't read further apart than this
+    static constexpr double THERMISTOR_PAIR_MISMATCH_C = 10.0;
 
     explicit ThermalPlateTask(Queue& q)
         : _message_queue(q),
@@ -103,17 +167,23 @@ class ThermalPlateTask {
                         .temp_current = 0.0,
                         .temp_target = 0.0,
                         .pid = PID(DEFAULT_KP, DEFAULT_KI, DEFAULT_KD,
-                                   CONTROL_PERIOD_SECONDS, 1.0, -1.0)},
+                                   CONTROL_PERIOD_SECONDS, 1.0, -1.0),
+                        .fault_monitor = ThermalFaultMonitor(
+                            FAULT_LIMITS, CONTROL_PERIOD_SECONDS)},
           _peltier_right{.id = PELTIER_RIGHT,
                          .temp_current = 0.0,
                          .temp_target = 0.0,
                          .pid = PID(DEFAULT_KP, DEFAULT_KI, DEFAULT_KD,
-                                    CONTROL_PERIOD_SECONDS, 1.0, -1.0)},
+                                    CONTROL_PERIOD_SECONDS, 1.0, -1.0),
+                         .fault_monitor = ThermalFaultMonitor(
+                             FAULT_LIMITS, CONTROL_PERIOD_SECONDS)},
           _peltier_center{.id = PELTIER_CENTER,
                           .temp_current = 0.0,
                           .temp_target = 0.0,
                           .pid = PID(DEFAULT_KP, DEFAULT_KI, DEFAULT_KD,
-                                     CONTROL_PERIOD_SECONDS, 1.0, -1.0)},
+                                     CONTROL_PERIOD_SECONDS, 1.0, -1.0),
+                          .fault_monitor = ThermalFaultMonitor(
+                              FAULT_LIMITS, CONTROL_PERIOD_SECONDS)},
           _thermistors{
               {{.overtemp_limit_c = OVERTEMP_LIMIT_C,
                 .disconnected_error =
@@ -170,7 +240,17 @@ class ThermalPlateTask {
           _setpoint_c(0),
           _fans_pid(DEFAULT_KP, DEFAULT_KI, DEFAULT_KD, CONTROL_PERIOD_SECONDS,
                     1.0, -1.0),
-          _hold_time(0) {}
+          _hold_time(0),
+          _control_mode(PLATE_CONTROL_INDEPENDENT),
+          _autotune(std::nullopt),
+          _autotune_id(0),
+          _volume_ul(0),
+          _sample_temp_c(std::nullopt),
+          _overshoot_active(false),
+          _power_ceiling(1.0),
+          _fault_error(errors::ErrorCode::NO_ERROR),
+          _sample_timing(CONTROL_PERIOD_US),
+          _max_acquisition_us(0) {}
     ThermalPlateTask(const ThermalPlateTask& other) = delete;
     auto operator=(const ThermalPlateTask& other) -> ThermalPlateTask& = delete;
     ThermalPlateTask(ThermalPlateTask&& other) noexcept = delete;
@@ -226,6 +306,8 @@ class ThermalPlateTask {
                        Policy& policy) -> void {
         constexpr double thermistors_per_peltier = 2;
         auto old_error_bitmap = _state.error_bitmap;
+        _sample_timing.add(msg.timestamp_us);
+        _max_acquisition_us = std::max(_max_acquisition_us, msg.acquisition_us);
         handle_temperature_conversion(msg.front_right,
                                       _thermistors[THERM_FRONT_RIGHT]);
         handle_temperature_conversion(msg.front_left,
@@ -240,12 +322,16 @@ class ThermalPlateTask {
                                       _thermistors[THERM_BACK_CENTER]);
         handle_temperature_conversion(msg.heat_sink,
                                       _thermistors[THERM_HEATSINK]);
+        check_thermistor_pairs();
 
         if (old_error_bitmap != _state.error_bitmap) {
             if (_state.error_bitmap != 0) {
                 // We entered an error state. Disable power output.
                 _state.system_status = State::ERROR;
                 policy.set_enabled(false);
+                if (_autotune.has_value()) {
+                    finish_autotune(most_relevant_error());
+                }
             } else {
                 // We went from an error state to no error state... so go idle
                 _state.system_status = State::IDLE;
@@ -262,25 +348,44 @@ class ThermalPlateTask {
             (_thermistors[THERM_FRONT_CENTER].temp_c +
              _thermistors[THERM_BACK_CENTER].temp_c) /
             thermistors_per_peltier;
+        update_sample_estimate();
+        if (_state.system_status == State::CONTROLLING) {
+            check_thermal_faults(policy);
+        }
         if (_state.system_status == State::CONTROLLING) {
             policy.set_enabled(true);
-            // Each of the peltiers has its own PID loop, as does the fan
-            auto ret = update_peltier_pid(_peltier_left, policy);
-            if (ret) {
-                ret = update_peltier_pid(_peltier_right, policy);
-            }
-            if (ret) {
-                ret = update_peltier_pid(_peltier_center, policy);
+            update_overshoot();
+            update_power_ceiling();
+            bool ret = true;
+            if (_control_mode == PLATE_CONTROL_UNIFORMITY) {
+                ret = update_peltiers_uniform(policy);
+            } else {
+                // Each of the peltiers has its own PID loop, as does the fan
+                ret = update_peltier_pid(_peltier_left, policy);
+                if (ret) {
+                    ret = update_peltier_pid(_peltier_right, policy);
+                }
+                if (ret) {
+                    ret = update_peltier_pid(_peltier_center, policy);
+                }
             }
             if (!ret) {
                 _state.system_status = State::ERROR;
                 _state.error_bitmap |= State::PELTIER_ERROR;
             }
+        } else if (_state.system_status == State::AUTOTUNING) {
+            policy.set_enabled(true);
+            if (!update_autotune(policy)) {
+                _state.system_status = State::ERROR;
+                _state.error_bitmap |= State::PELTIER_ERROR;
+                finish_autotune(errors::ErrorCode::THERMAL_PELTIER_ERROR);
+            }
         }
         // Not an `else` so we can immediately resolve any issue setting outputs
         if (_state.system_status == State::ERROR) {
             policy.set_enabled(false);
         }
+        publish_power_demand(policy);
     }
 
     template <typename Policy>
@@ -308,6 +413,65 @@ class ThermalPlateTask {
             messages::HostCommsMessage(response)));
     }
 
+    template <ThermalPlateExecutionPolicy Policy>
+    auto visit_message(const messages::GetPlateSampleTimingMessage& msg,
+                       Policy& policy) -> void {
+        static_cast<void>(policy);
+        constexpr double us_per_ms = 1000.0;
+        auto response = messages::GetPlateSampleTimingResponse{
+            .responding_to_id = msg.id,
+            .count = _sample_timing.count(),
+            .period_ms = _sample_timing.mean_us() / us_per_ms,
+            .stddev_ms = _sample_timing.stddev_us() / us_per_ms,
+            .jitter_ms = _sample_timing.peak_jitter_us() / us_per_ms,
+            .acquisition_ms = _max_acquisition_us / us_per_ms};
+        // Each query reports on the scans since the last one
+        _sample_timing.reset();
+        _max_acquisition_us = 0;
+        static_cast<void>(_task_registry->comms->get_message_queue().try_send(
+            messages::HostCommsMessage(response)));
+    }
+
+    template <ThermalPlateExecutionPolicy Policy>
+    auto visit_message(const messages::GetThermistorStatsMessage& msg,
+                       Policy& policy) -> void {
+        static_cast<void>(policy);
+        const auto& stats = _thermistors.at(msg.thermistor).stats;
+        auto response = messages::GetThermistorStatsResponse{
+            .responding_to_id = msg.id,
+            .thermistor = msg.thermistor,
+            .count = static_cast<uint32_t>(stats.count(msg.window)),
+            .min = stats.min(msg.window),
+            .max = stats.max(msg.window),
+            .mean = stats.mean(msg.window),
+            .variance = stats.variance(msg.window),
+            .invalid = static_cast<uint32_t>(stats.invalid(msg.window)),
+            .total = stats.total(),
+            .total_invalid = stats.total_invalid(),
+            .drift = stats.drift()};
+        static_cast<void>(_task_registry->comms->get_message_queue().try_send(
+            messages::HostCommsMessage(response)));
+    }
+
+    template <ThermalPlateExecutionPolicy Policy>
+    auto visit_message(const messages::GetPlateThermistorNoiseMessage& msg,
+                       Policy& policy) -> void {
+        static_cast<void>(policy);
+        auto response = messages::GetPlateThermistorNoiseResponse{
+            .responding_to_id = msg.id,
+            .count = static_cast<uint32_t>(
+                _thermistors[THERM_HEATSINK].stats.count()),
+            .heat_sink = _thermistors[THERM_HEATSINK].stats.stddev(),
+            .front_right = _thermistors[THERM_FRONT_RIGHT].stats.stddev(),
+            .front_left = _thermistors[THERM_FRONT_LEFT].stats.stddev(),
+            .front_center = _thermistors[THERM_FRONT_CENTER].stats.stddev(),
+            .back_right = _thermistors[THERM_BACK_RIGHT].stats.stddev(),
+            .back_left = _thermistors[THERM_BACK_LEFT].stats.stddev(),
+            .back_center = _thermistors[THERM_BACK_CENTER].stats.stddev()};
+        static_cast<void>(_task_registry->comms->get_message_queue().try_send(
+            messages::HostCommsMessage(response)));
+    }
+
     template <ThermalPlateExecutionPolicy Policy>
     auto visit_message(const messages::GetPlateTempMessage& msg, Policy& policy)
         -> void {
@@ -334,7 +498,8 @@ class ThermalPlateTask {
                 _task_registry->comms->get_message_queue().try_send(response));
             return;
         }
-        if (_state.system_status == State::CONTROLLING) {
+        if ((_state.system_status == State::CONTROLLING) ||
+            (_state.system_status == State::AUTOTUNING)) {
             // Send busy error
             response.with_error = errors::ErrorCode::THERMAL_PLATE_BUSY;
             static_cast<void>(
@@ -375,6 +540,7 @@ class ThermalPlateTask {
         }
         policy.set_enabled(enabled);
         _state.system_status = (enabled) ? State::PWM_TEST : State::IDLE;
+        publish_power_demand(policy);
 
         if (!ok) {
             response.with_error = errors::ErrorCode::THERMAL_PELTIER_ERROR;
@@ -416,6 +582,12 @@ class ThermalPlateTask {
                 _task_registry->comms->get_message_queue().try_send(response));
             return;
         }
+        if (_state.system_status == State::AUTOTUNING) {
+            response.with_error = errors::ErrorCode::THERMAL_PLATE_BUSY;
+            static_cast<void>(
+                _task_registry->comms->get_message_queue().try_send(response));
+            return;
+        }
         if (_state.system_status == State::PWM_TEST) {
             // Reset all peltiers
             auto ret = policy.set_peltier(_peltier_left.id, 0.0F,
@@ -446,16 +618,22 @@ class ThermalPlateTask {
             policy.set_enabled(false);
         } else {
             _setpoint_c = msg.setpoint;
+            _volume_ul = std::max(msg.volume, 0.0);
+            if (_state.system_status != State::CONTROLLING) {
+                _peltier_left.fault_monitor.reset();
+                _peltier_right.fault_monitor.reset();
+                _peltier_center.fault_monitor.reset();
+            }
             _state.system_status = State::CONTROLLING;
-            _peltier_left.pid.arm_integrator_reset(_setpoint_c -
+            auto target = overshoot_target();
+            _overshoot_active = (target != _setpoint_c);
+            _peltier_left.pid.arm_integrator_reset(target -
                                                    _peltier_left.temp_current);
             _peltier_right.pid.arm_integrator_reset(
-                _setpoint_c - _peltier_right.temp_current);
+                target - _peltier_right.temp_current);
             _peltier_center.pid.arm_integrator_reset(
-                _setpoint_c - _peltier_center.temp_current);
-            _peltier_left.temp_target = _setpoint_c;
-            _peltier_right.temp_target = _setpoint_c;
-            _peltier_center.temp_target = _setpoint_c;
+                target - _peltier_center.temp_current);
+            set_plate_target(target);
             _hold_time = msg.hold_time;
         }
 
@@ -478,6 +656,10 @@ class ThermalPlateTask {
 
         policy.set_enabled(false);
         _state.system_status = State::IDLE;
+        if (_autotune.has_value()) {
+            // Deactivating cancels a tune in progress
+            finish_autotune(errors::ErrorCode::THERMAL_AUTOTUNE_FAILED);
+        }
 
         static_cast<void>(
             _task_registry->comms->get_message_queue().try_send(response));
@@ -490,7 +672,8 @@ class ThermalPlateTask {
         auto response =
             messages::AcknowledgePrevious{.responding_to_id = msg.id};
 
-        if (_state.system_status == State::CONTROLLING) {
+        if ((_state.system_status == State::CONTROLLING) ||
+            (_state.system_status == State::AUTOTUNING)) {
             response.with_error = errors::ErrorCode::THERMAL_PLATE_BUSY;
             static_cast<void>(
                 _task_registry->comms->get_message_queue().try_send(response));
@@ -522,6 +705,73 @@ class ThermalPlateTask {
             _task_registry->comms->get_message_queue().try_send(response));
     }
 
+    template <ThermalPlateExecutionPolicy Policy>
+    auto visit_message(const messages::SetPlateControlModeMessage& msg,
+                       Policy& policy) -> void {
+        static_cast<void>(policy);
+        auto response =
+            messages::AcknowledgePrevious{.responding_to_id = msg.id};
+        if (msg.mode != _control_mode) {
+            // The two modes scale their integrators differently, so start
+            // the new mode from a clean slate
+            _peltier_left.pid.reset();
+            _peltier_right.pid.reset();
+            _peltier_center.pid.reset();
+            _control_mode = msg.mode;
+        }
+        static_cast<void>(
+            _task_registry->comms->get_message_queue().try_send(response));
+    }
+
+    // The plate is the budget's last consumer, so it owns the supply figure
+    template <ThermalPlateExecutionPolicy Policy>
+    auto visit_message(const messages::SetPowerSupplyMessage& msg,
+                       Policy& policy) -> void {
+        static_cast<void>(policy);
+        _task_registry->power_budget.set_supply(msg.watts);
+        static_cast<void>(_task_registry->comms->get_message_queue().try_send(
+            messages::AcknowledgePrevious{.responding_to_id = msg.id}));
+    }
+
+    template <ThermalPlateExecutionPolicy Policy>
+    auto visit_message(const messages::SetPlateAcquisitionMessage& msg,
+                       Policy& policy) -> void {
+        auto response =
+            messages::AcknowledgePrevious{.responding_to_id = msg.id};
+        if (!policy.set_acquisition(msg.data_rate_sps, msg.oversample,
+                                    msg.filter, msg.filter_alpha)) {
+            response.with_error =
+                errors::ErrorCode::THERMAL_PLATE_ACQUISITION_INVALID;
+        }
+        static_cast<void>(
+            _task_registry->comms->get_message_queue().try_send(response));
+    }
+
+    template <ThermalPlateExecutionPolicy Policy>
+    auto visit_message(const messages::StartAutotuneMessage& msg,
+                       Policy& policy) -> void {
+        static_cast<void>(policy);
+        auto response =
+            messages::AutotuneResultResponse{.responding_to_id = msg.id};
+        if (_state.system_status == State::ERROR) {
+            response.with_error = most_relevant_error();
+        } else if (_state.system_status != State::IDLE) {
+            response.with_error = errors::ErrorCode::THERMAL_PLATE_BUSY;
+        }
+        if (response.with_error != errors::ErrorCode::NO_ERROR) {
+            static_cast<void>(
+                _task_registry->comms->get_message_queue().try_send(response));
+            return;
+        }
+        // The response is held until the tune finishes
+        _autotune.emplace(msg.setpoint, AUTOTUNE_RELAY_POWER,
+                          -AUTOTUNE_RELAY_POWER, AUTOTUNE_HYSTERESIS_C,
+                          CONTROL_PERIOD_SECONDS);
+        _autotune_id = msg.id;
+        _setpoint_c = msg.setpoint;
+        _state.system_status = State::AUTOTUNING;
+    }
+
     auto handle_temperature_conversion(uint16_t conversion_result,
                                        Thermistor& thermistor) -> void {
         auto visitor = [this, &thermistor](const auto value) -> void {
@@ -559,6 +809,7 @@ class ThermalPlateTask {
                 break;
             }
         }
+        therm.stats.add_invalid();
     }
 
     auto visit_conversion(Thermistor& therm, const double temp) -> void {
@@ -568,6 +819,7 @@ class ThermalPlateTask {
             therm.error = errors::ErrorCode::NO_ERROR;
         }
         therm.temp_c = temp;
+        therm.stats.add(temp);
     }
 
     [[nodiscard]] auto most_relevant_error() const -> errors::ErrorCode {
@@ -580,14 +832,109 @@ class ThermalPlateTask {
             State::PELTIER_ERROR) {
             return errors::ErrorCode::THERMAL_PELTIER_ERROR;
         }
-        for (auto therm : _thermistors) {
+        if ((_state.error_bitmap & State::PELTIER_FAULT_ERROR) ==
+            State::PELTIER_FAULT_ERROR) {
+            return _fault_error;
+        }
+        for (const auto& therm : _thermistors) {
             if ((_state.error_bitmap & therm.error_bit) == therm.error_bit) {
                 return therm.error;
             }
         }
+        if ((_state.error_bitmap & State::THERMISTOR_MISMATCH_ERROR) ==
+            State::THERMISTOR_MISMATCH_ERROR) {
+            return errors::ErrorCode::THERMISTOR_PLATE_PAIR_MISMATCH;
+        }
         return errors::ErrorCode::NO_ERROR;
     }
 
+    /**
+     * @brief Cross-checks the front and back thermistor of each zone. A
+     * thermistor that reads far from its partner has most likely come loose
+     * from the plate. Like the other thermistor errors, this clears once the
+     * readings agree again.
+     */
+    auto check_thermistor_pairs() -> void {
+        constexpr std::array<std::pair<ThermistorID, ThermistorID>,
+                             PELTIER_NUMBER>
+            pairs{{{THERM_FRONT_LEFT, THERM_BACK_LEFT},
+                   {THERM_FRONT_CENTER, THERM_BACK_CENTER},
+                   {THERM_FRONT_RIGHT, THERM_BACK_RIGHT}}};
+        bool plausible = true;
+        for (const auto& [front_id, back_id] : pairs) {
+            const auto& front = _thermistors.at(front_id);
+            const auto& back = _thermistors.at(back_id);
+            // A thermistor that is already in error reports that instead
+            if ((front.error != errors::ErrorCode::NO_ERROR) ||
+                (back.error != errors::ErrorCode::NO_ERROR)) {
+                continue;
+            }
+            if (!ThermalFaultMonitor::pair_plausible(
+                    front.temp_c, back.temp_c, THERMISTOR_PAIR_MISMATCH_C)) {
+                plausible = false;
+            }
+        }
+        const bool flagged =
+            (_state.error_bitmap & State::THERMISTOR_MISMATCH_ERROR) != 0;
+        if (!plausible && !flagged) {
+            _state.error_bitmap |= State::THERMISTOR_MISMATCH_ERROR;
+            auto error_message =
+                messages::HostCommsMessage(messages::ErrorMessage{
+                    .code = errors::ErrorCode::THERMISTOR_PLATE_PAIR_MISMATCH});
+            static_cast<void>(
+                _task_registry->comms->get_message_queue().try_send(
+                    error_message));
+        } else if (plausible && flagged) {
+            _state.error_bitmap &= ~State::THERMISTOR_MISMATCH_ERROR;
+        }
+    }
+
+    /**
+     * @brief Compares the output each peltier ran at over the last period
+     * against how its zone temperature moved. A fault shuts the peltiers
+     * down and, like a peltier error, latches until the system restarts.
+     * The zones share one block, so a zone backed off below zero (as
+     * uniformity control and the overshoot back-off both do) while its
+     * neighbours heat it isn't a runaway.
+     *
+     * @tparam Policy Provides platform-specific control mechanisms
+     * @param[in] policy Instance of the platform policy
+     */
+    template <ThermalPlateExecutionPolicy Policy>
+    auto check_thermal_faults(Policy& policy) -> void {
+        auto zones = std::array<std::reference_wrapper<Peltier>,
+                                PELTIER_NUMBER>{_peltier_left, _peltier_center,
+                                                _peltier_right};
+        std::array<double, PELTIER_NUMBER> powers{};
+        for (size_t i = 0; i < zones.size(); ++i) {
+            auto output = policy.get_peltier(zones.at(i).get().id);
+            powers.at(i) = (output.first == PeltierDirection::PELTIER_COOLING)
+                               ? -output.second
+                               : output.second;
+        }
+        const double block_power =
+            *std::max_element(powers.cbegin(), powers.cend());
+        for (size_t i = 0; i < zones.size(); ++i) {
+            Peltier& zone = zones.at(i);
+            auto fault = zone.fault_monitor.update(
+                zone.temp_current, zone.temp_target, powers.at(i), block_power);
+            if (fault == ThermalFaultMonitor::Fault::NONE) {
+                continue;
+            }
+            _fault_error = (fault == ThermalFaultMonitor::Fault::RUNAWAY)
+                               ? errors::ErrorCode::THERMAL_PLATE_RUNAWAY
+                               : errors::ErrorCode::THERMAL_PLATE_NO_RESPONSE;
+            _state.system_status = State::ERROR;
+            _state.error_bitmap |= State::PELTIER_FAULT_ERROR;
+            auto error_message = messages::HostCommsMessage(
+                messages::ErrorMessage{.code = _fault_error});
+            static_cast<void>(
+                _task_registry->comms->get_message_queue().try_send(
+                    error_message));
+            return;
+        }
+    }
+
     [[nodiscard]] auto average_plate_temp() const -> double {
         return (_thermistors[THERM_FRONT_RIGHT].temp_c +
                 _thermistors[THERM_BACK_RIGHT].temp_c +
@@ -598,6 +945,72 @@ class ThermalPlateTask {
                ((double)(PLATE_THERM_COUNT - 1));
     }
 
+    /**
+     * @brief Advances the modelled sample temperature by one control period.
+     * The estimate starts from the plate temperature and is dropped while
+     * any thermistor is in error, since the plate reading is meaningless.
+     */
+    auto update_sample_estimate() -> void {
+        if (_state.error_bitmap != 0) {
+            _sample_temp_c = std::nullopt;
+            return;
+        }
+        const double plate = average_plate_temp();
+        if (!_sample_temp_c.has_value()) {
+            _sample_temp_c = plate;
+            return;
+        }
+        const double tau = SAMPLE_TAU_BASE_S + SAMPLE_TAU_PER_UL_S * _volume_ul;
+        _sample_temp_c = _sample_temp_c.value() +
+                         (plate - _sample_temp_c.value()) *
+                             std::min(CONTROL_PERIOD_SECONDS / tau, 1.0);
+    }
+
+    /**
+     * @brief The plate target for a new setpoint. This is the setpoint
+     * itself unless a sample volume was given and the sample is far enough
+     * from the setpoint to need an overshoot.
+     */
+    [[nodiscard]] auto overshoot_target() const -> double {
+        if (_volume_ul <= 0.0F) {
+            return _setpoint_c;
+        }
+        const double sample = _sample_temp_c.value_or(average_plate_temp());
+        double overshoot = 0.0F;
+        if (_setpoint_c - sample >= OVERSHOOT_MIN_STEP_C) {
+            overshoot =
+                HEATING_OVERSHOOT_C + HEATING_OVERSHOOT_PER_UL * _volume_ul;
+        } else if (sample - _setpoint_c >= OVERSHOOT_MIN_STEP_C) {
+            overshoot =
+                -(COOLING_OVERSHOOT_C + COOLING_OVERSHOOT_PER_UL * _volume_ul);
+        }
+        return std::clamp(_setpoint_c + overshoot, OVERSHOOT_TARGET_MIN_C,
+                          std::max(OVERSHOOT_TARGET_MAX_C, _setpoint_c));
+    }
+
+    /**
+     * @brief Ends an active overshoot once the modelled sample temperature
+     * has caught up with the setpoint, returning the plate target to the
+     * setpoint itself.
+     */
+    auto update_overshoot() -> void {
+        if (!_overshoot_active) {
+            return;
+        }
+        if (!_sample_temp_c.has_value() ||
+            (std::abs(_setpoint_c - _sample_temp_c.value()) <
+             SAMPLE_SETTLE_BAND_C)) {
+            _overshoot_active = false;
+            set_plate_target(_setpoint_c);
+        }
+    }
+
+    auto set_plate_target(double target) -> void {
+        _peltier_left.temp_target = target;
+        _peltier_right.temp_target = target;
+        _peltier_center.temp_target = target;
+    }
+
     /**
      * @brief Updates the power of a peltier. Calculates a new PID value and
      * updates the power output. The \c temp_current field in the peltier
@@ -612,6 +1025,166 @@ class ThermalPlateTask {
     auto update_peltier_pid(Peltier& peltier, Policy& policy) -> bool {
         auto power =
             peltier.pid.compute(peltier.temp_target - peltier.temp_current);
+        return set_peltier_power(
+            peltier, std::clamp(power, -_power_ceiling, _power_ceiling),
+            policy);
+    }
+
+    /**
+     * @brief Updates the power of all three peltiers jointly. Each zone
+     * still runs its own PID for setpoint tracking, but the outputs are
+     * then corrected as a vector:
+     * - Every zone is pulled towards the mean of all six plate thermistors
+     *   with a zero-sum uniformity term, so corrections move heat between
+     *   zones rather than adding or removing it from the block
+     * - A common feedforward term compensates leakage to the heatsink
+     * - If the result saturates, the whole vector is shifted back into
+     *   range rather than clamped per zone, so the zone that is furthest
+     *   behind keeps full power and the others back off. This is what keeps
+     *   the zones together during a ramp.
+     *
+     * @tparam Policy Provides platform-specific control mechanisms
+     * @param[in] policy Instance of the platform policy
+     * @return True on success, false if an error occurs
+     */
+    template <ThermalPlateExecutionPolicy Policy>
+    auto update_peltiers_uniform(Policy& policy) -> bool {
+        auto zones = std::array<std::reference_wrapper<Peltier>,
+                                PELTIER_NUMBER>{_peltier_left, _peltier_center,
+                                                _peltier_right};
+        const double mean = average_plate_temp();
+        const double heatsink = _thermistors[THERM_HEATSINK].temp_c;
+        std::array<double, PELTIER_NUMBER> powers{};
+        for (size_t i = 0; i < zones.size(); ++i) {
+            Peltier& zone = zones.at(i);
+            powers.at(i) =
+                zone.pid.compute(zone.temp_target - zone.temp_current) +
+                UNIFORMITY_GAIN * (mean - zone.temp_current) +
+                HEATSINK_FEEDFORWARD_GAIN * (zone.temp_target - heatsink);
+        }
+        const auto [low, high] =
+            std::minmax_element(powers.cbegin(), powers.cend());
+        const double limit = _power_ceiling;
+        double shift = 0.0F;
+        if (*high > limit && *low >= -limit) {
+            shift = std::max(limit - *high, -limit - *low);
+        } else if (*low < -limit && *high <= limit) {
+            shift = std::min(-limit - *low, limit - *high);
+        }
+        bool ret = true;
+        for (size_t i = 0; i < zones.size() && ret; ++i) {
+            ret = set_peltier_power(
+                zones.at(i), std::clamp(powers.at(i) + shift, -limit, limit),
+                policy);
+        }
+        return ret;
+    }
+
+    /**
+     * @brief Fetches the share of the supply the plate may use this period,
+     * given what the lid heater is drawing, and holds the peltier
+     * integrators to it so they don't wind up against a limit the PID
+     * can't see.
+     */
+    auto update_power_ceiling() -> void {
+        _power_ceiling =
+            _task_registry->power_budget.ceiling(power::THERMAL_PLATE);
+        _peltier_left.pid.set_windup_limits(_power_ceiling, -_power_ceiling);
+        _peltier_right.pid.set_windup_limits(_power_ceiling, -_power_ceiling);
+        _peltier_center.pid.set_windup_limits(_power_ceiling, -_power_ceiling);
+    }
+
+    /**
+     * @brief Publishes the power the peltiers are drawing to the power
+     * budget. Heating and cooling both draw from the supply.
+     */
+    template <ThermalPlateExecutionPolicy Policy>
+    auto publish_power_demand(Policy& policy) -> void {
+        double demand = 0.0F;
+        if ((_state.system_status == State::CONTROLLING) ||
+            (_state.system_status == State::AUTOTUNING) ||
+            (_state.system_status == State::PWM_TEST)) {
+            demand = (policy.get_peltier(_peltier_left.id).second +
+                      policy.get_peltier(_peltier_right.id).second +
+                      policy.get_peltier(_peltier_center.id).second) /
+                     static_cast<double>(PELTIER_NUMBER);
+        }
+        _task_registry->power_budget.set_demand(power::THERMAL_PLATE, demand);
+    }
+
+    /**
+     * @brief Runs one step of an in-progress autotune. All three peltiers
+     * get the same relay output, driven by the average plate temperature.
+     * Once the tune is over, the response to the start message is sent.
+     *
+     * @tparam Policy Provides platform-specific control mechanisms
+     * @param[in] policy Instance of the platform policy
+     * @return True on success, false if an error occurs
+     */
+    template <ThermalPlateExecutionPolicy Policy>
+    auto update_autotune(Policy& policy) -> bool {
+        auto power = _autotune->update(average_plate_temp());
+        bool ret = set_peltier_power(_peltier_left, power, policy);
+        if (ret) {
+            ret = set_peltier_power(_peltier_right, power, policy);
+        }
+        if (ret) {
+            ret = set_peltier_power(_peltier_center, power, policy);
+        }
+        if (!ret) {
+            return false;
+        }
+        if (_autotune->status() == RelayAutotune::Status::RUNNING) {
+            return true;
+        }
+        policy.set_enabled(false);
+        _state.system_status = State::IDLE;
+        auto error = errors::ErrorCode::THERMAL_AUTOTUNE_FAILED;
+        if (_autotune->status() == RelayAutotune::Status::DONE &&
+            (_autotune->kp() <= KP_MAX) && (_autotune->ki() <= KI_MAX) &&
+            (_autotune->kd() <= KD_MAX)) {
+            auto pid = PID(_autotune->kp(), _autotune->ki(), _autotune->kd(),
+                           CONTROL_PERIOD_SECONDS, 1.0, -1.0);
+            _peltier_left.pid = pid;
+            _peltier_right.pid = pid;
+            _peltier_center.pid = pid;
+            error = errors::ErrorCode::NO_ERROR;
+        }
+        finish_autotune(error);
+        return true;
+    }
+
+    /**
+     * @brief Responds to the message that started the current autotune and
+     * forgets about it, along with the setpoint it was tuning around. On
+     * success, the response carries the new gains.
+     */
+    auto finish_autotune(errors::ErrorCode error) -> void {
+        auto response =
+            messages::AutotuneResultResponse{.responding_to_id = _autotune_id,
+                                             .kp = _autotune->kp(),
+                                             .ki = _autotune->ki(),
+                                             .kd = _autotune->kd(),
+                                             .with_error = error};
+        _autotune.reset();
+        _setpoint_c = 0.0F;
+        static_cast<void>(
+            _task_registry->comms->get_message_queue().try_send(response));
+    }
+
+    /**
+     * @brief Sets a peltier output from a signed power value, where
+     * positive values heat and negative values cool.
+     *
+     * @tparam Policy Provides platform-specific control mechanisms
+     * @param[in] peltier The peltier to update
+     * @param[in] power The signed power, clamped to [-1, 1]
+     * @param[in] policy Instance of the platform policy
+     * @return True on success, false if an error occurs
+     */
+    template <ThermalPlateExecutionPolicy Policy>
+    auto set_peltier_power(const Peltier& peltier, double power,
+                           Policy& policy) -> bool {
         auto direction = PeltierDirection::PELTIER_HEATING;
         if (power < 0.0F) {
             // The set_peltier function takes a *positive* percentage and a
@@ -635,6 +1208,17 @@ class ThermalPlateTask {
     double _setpoint_c;
     PID _fans_pid;
     double _hold_time;
+    PlateControlMode _control_mode;
+    std::optional<RelayAutotune> _autotune;
+    uint32_t _autotune_id;
+    double _volume_ul;
+    std::optional<double> _sample_temp_c;
+    bool _overshoot_active;
+    double _power_ceiling;
+    errors::ErrorCode _fault_error;
+    // How regularly thermistor scans arrive, and the longest any one took
+    PeriodStats _sample_timing;
+    uint32_t _max_acquisition_us;
 };
 
 }  // namespace thermal_plate_task
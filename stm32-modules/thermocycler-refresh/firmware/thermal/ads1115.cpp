@@ -6,6 +6,14 @@
  * This file provides functionality to control ADS1115 Analog to Digital
  * Converter IC's. Each of these chips provides four channels of 16-bit
  * analog conversion.
+ *
+ * Pins can either be read one at a time with ADC::read, or as part of a
+ * scan with ADC::scan. A scan chains its conversions from interrupt context
+ * (see thermal_hardware.c) and leaves the results, with timestamps, in a
+ * sample buffer per ADC. A single read is just a scan of one pin.
+ *
+ * The data rate is kept per physical ADC and written along with every
+ * conversion start, since the ADCs run in single shot mode.
  */
 
 #include "firmware/ads1115.hpp"
@@ -33,6 +41,10 @@ struct adc_hardware {
     // Semaphore information for the ADC
     freertos_synchronization::FreeRTOSMutex _mutex =
         freertos_synchronization::FreeRTOSMutex();
+    // Result of the last scan of each pin
+    std::array<thermal_adc_sample_t, ADC::pin_count> _samples = {};
+    // Data rate for every conversion
+    std::atomic<DataRate> _data_rate = ADC::default_data_rate;
 };
 
 // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
@@ -40,6 +52,15 @@ static std::array<adc_hardware, ADC_ITR_NUM> _adc_hardware;
 
 ADC::ADC(uint8_t addr, ADC_ITR_T id) : _addr(addr), _id(id), _last_result(0) {}
 
+void ADC::reset_all() {
+    for (auto &hardware : _adc_hardware) {
+        hardware._initialization_done = false;
+        hardware._initialization_started = false;
+        hardware._samples = {};
+        hardware._data_rate = default_data_rate;
+    }
+}
+
 void ADC::initialize() {
     bool initialization_started =
         _adc_hardware.at(_id)._initialization_started.exchange(true);
@@ -54,58 +75,134 @@ void ADC::initialize() {
         configASSERT(_adc_hardware.at(_id)._mutex.get_count() == 1);
 
         // Write to the Lo and Hi threshold registers first to enable the ALERT
-        // pin
-        thermal_i2c_write_16(_addr, lo_thresh_addr, lo_thresh_default);
-        thermal_i2c_write_16(_addr, hi_thresh_addr, hi_thresh_default);
-
-        thermal_i2c_write_16(_addr, config_addr, config_default);
+        // pin, then the config, all as one batch
+        std::array<thermal_i2c_transfer_t, 3> setup{{
+            {.op = THERMAL_I2C_WRITE,
+             .addr = _addr,
+             .reg = lo_thresh_addr,
+             .value = lo_thresh_default},
+            {.op = THERMAL_I2C_WRITE,
+             .addr = _addr,
+             .reg = hi_thresh_addr,
+             .value = hi_thresh_default},
+            {.op = THERMAL_I2C_WRITE,
+             .addr = _addr,
+             .reg = config_addr,
+             .value = static_cast<uint16_t>(
+                 config_default |
+                 (static_cast<uint16_t>(
+                      _adc_hardware.at(_id)._data_rate.load())
+                  << config_data_rate_shift))}}};
+        static_cast<void>(thermal_i2c_batch(
+            setup.data(), static_cast<uint8_t>(setup.size())));
 
         _adc_hardware.at(_id)._initialization_done = true;
     }
 }
 
 auto ADC::read(uint16_t pin) -> ADC::ReadVal {
-    uint32_t notification_val = 0;
-    bool i2c_ret = false;
-    const TickType_t max_block_time = pdMS_TO_TICKS(500);
     if (!initialized()) {
         return ReadVal(Error::ADCInit);
     }
     if (!(pin < pin_count)) {
         return ReadVal(Error::ADCPin);
     }
-
-    if (!get_lock()) {
+    // A scan of one pin wakes this thread once, rather than after the
+    // conversion start, the READY pin and the result read separately
+    const auto entry = ScanEntry{.adc = this, .pin = pin};
+    if (!scan(std::span(&entry, 1))) {
         return ReadVal(Error::ADCTimeout);
     }
-
-    i2c_ret = thermal_arm_adc_for_read(_id);
-    if (!i2c_ret) {
-        static_cast<void>(release_lock());
-        return ReadVal(Error::ADCTimeout);
+    auto sample = last_sample(pin);
+    if (std::holds_alternative<Error>(sample)) {
+        return ReadVal(std::get<Error>(sample));
     }
-    // This kicks off the conversion on the selected pin
-    i2c_ret = thermal_i2c_write_16(
-        _addr, config_addr,
-        config_default | (pin << config_mux_shift) | config_start_read);
+    _last_result = std::get<Sample>(sample).value;
+    return ReadVal(_last_result);
+}
 
-    if (i2c_ret) {
-        // thermal_hardware.c will notify this task once the correct GPIO sends
-        // a pulse indicating ADC READY.
-        notification_val = ulTaskNotifyTake(pdTRUE, max_block_time);
+void ADC::set_data_rate(DataRate rate) {
+    _adc_hardware.at(_id)._data_rate.store(rate);
+}
 
-        if (notification_val == 1) {
-            i2c_ret =
-                thermal_i2c_read_16(_addr, conversion_addr, &_last_result);
+auto ADC::scan(std::span<const ScanEntry> entries, uint8_t oversample)
+    -> bool {
+    std::array<thermal_adc_scan_step_t, max_scan_length> steps{};
+    std::array<bool, ADC_ITR_NUM> in_scan{};
+    uint32_t timeout_ms = 0;
+    if (entries.empty() || entries.size() > max_scan_length) {
+        return false;
+    }
+    if (oversample == 0 || oversample > max_oversample) {
+        return false;
+    }
+    for (const auto &entry : entries) {
+        if (!entry.adc->initialized() || !(entry.pin < pin_count)) {
+            return false;
         }
+        in_scan.at(entry.adc->_id) = true;
     }
+    // Lock in ID order so that two overlapping scans can't deadlock
+    for (size_t id = 0; id < ADC_ITR_NUM; ++id) {
+        if (in_scan.at(id)) {
+            _adc_hardware.at(id)._mutex.acquire();
+        }
+    }
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const auto &entry = entries[i];
+        steps.at(i) = thermal_adc_scan_step_t{
+            .addr = entry.adc->_addr,
+            .id = entry.adc->_id,
+            .start_reg = config_addr,
+            .start_val = entry.adc->start_config(entry.pin),
+            .result_reg = conversion_addr,
+            .samples = oversample,
+            .result = &_adc_hardware.at(entry.adc->_id)._samples.at(entry.pin)};
+        // Allow for every conversion running back to back, rounded up
+        timeout_ms +=
+            oversample *
+            (((conversion_time_us(
+                   _adc_hardware.at(entry.adc->_id)._data_rate.load()) +
+               999) /
+              1000) +
+             max_scan_step_wait);
+    }
+    auto ret = thermal_adc_scan(steps.data(),
+                                static_cast<uint8_t>(entries.size()),
+                                timeout_ms);
+    for (size_t id = ADC_ITR_NUM; id > 0; --id) {
+        if (in_scan.at(id - 1)) {
+            _adc_hardware.at(id - 1)._mutex.release();
+        }
+    }
+    return ret;
+}
 
+auto ADC::last_sample(uint16_t pin) -> ADC::SampleVal {
+    if (!initialized()) {
+        return SampleVal(Error::ADCInit);
+    }
+    if (!(pin < pin_count)) {
+        return SampleVal(Error::ADCPin);
+    }
+    if (!get_lock()) {
+        return SampleVal(Error::ADCTimeout);
+    }
+    auto sample = _adc_hardware.at(_id)._samples.at(pin);
     static_cast<void>(release_lock());
-    if ((!i2c_ret) || (notification_val == 0)) {
-        return ReadVal(Error::ADCTimeout);
+    if (!sample.valid) {
+        return SampleVal(Error::ADCTimeout);
     }
+    return SampleVal(
+        Sample{.value = sample.value, .timestamp_us = sample.timestamp_us});
+}
 
-    return ReadVal(_last_result);
+auto ADC::start_config(uint16_t pin) -> uint16_t {
+    return static_cast<uint16_t>(
+        config_default |
+        (static_cast<uint16_t>(_adc_hardware.at(_id)._data_rate.load())
+         << config_data_rate_shift) |
+        (pin << config_mux_shift) | config_start_read);
 }
 
 auto ADC::initialized() -> bool {
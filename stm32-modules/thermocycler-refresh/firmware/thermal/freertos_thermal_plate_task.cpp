@@ -4,9 +4,13 @@
 
 #include "firmware/freertos_thermal_plate_task.hpp"
 
+#include <algorithm>
+#include <array>
+#include <optional>
 #include <variant>
 
 #include "FreeRTOS.h"
+#include "core/adc_filter.hpp"
 #include "firmware/ads1115.hpp"
 #include "firmware/thermal_hardware.h"
 #include "firmware/thermal_plate_policy.hpp"
@@ -67,23 +71,117 @@ static constexpr std::array<ADCPinMap, ThermistorID::THERM_LID> _adc_map = {{
     {ADC_FRONT, 0}   // Heat sink
 }};
 
+// Acquisition settings for the plate thermistors. Each thermistor is
+// converted oversample times per control period at data_rate and the
+// conversions are averaged; the averages are then passed through a filter
+// of the given mode. M105.A changes them at runtime.
+struct Acquisition {
+    ADS1115::DataRate data_rate;
+    uint8_t oversample;
+    AdcFilter::Mode filter;
+    double filter_alpha;
+};
+
+// Each ADC converts up to four pins, so this is 16 conversions of ~1.2ms
+// per ADC. No filter by default: the averaging already takes the edge off
+// the noise, and M105.N shows whether a unit needs more.
+static constexpr Acquisition _default_acquisition = {
+    .data_rate = ADS1115::DataRate::SPS_860,
+    .oversample = 4,
+    .filter = AdcFilter::Mode::NONE,
+    .filter_alpha = 0.5};
+
+// The settings in use, only touched by the thermistor task
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+static Acquisition _acquisition = _default_acquisition;
+// New settings for the thermistor task to pick up before its next scan.
+// Only accessed in a critical section.
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+static std::optional<Acquisition> _pending_acquisition = std::nullopt;
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+static std::array<AdcFilter, ThermistorID::THERM_LID> _filters = {
+    AdcFilter(_default_acquisition.filter, _default_acquisition.filter_alpha),
+    AdcFilter(_default_acquisition.filter, _default_acquisition.filter_alpha),
+    AdcFilter(_default_acquisition.filter, _default_acquisition.filter_alpha),
+    AdcFilter(_default_acquisition.filter, _default_acquisition.filter_alpha),
+    AdcFilter(_default_acquisition.filter, _default_acquisition.filter_alpha),
+    AdcFilter(_default_acquisition.filter, _default_acquisition.filter_alpha),
+    AdcFilter(_default_acquisition.filter, _default_acquisition.filter_alpha)};
+
+/** The most pins any one ADC converts in a scan.*/
+static constexpr auto max_pins_per_adc() -> uint32_t {
+    uint32_t most = 0;
+    for (uint8_t adc = 0; adc < ADC_ITR_NUM; ++adc) {
+        uint32_t pins = 0;
+        for (const auto &pin : _adc_map) {
+            if (static_cast<uint8_t>(pin.adc_index) == adc) {
+                ++pins;
+            }
+        }
+        most = std::max(most, pins);
+    }
+    return most;
+}
+
+/**
+ * Whether a scan with these settings fits well inside a control period,
+ * leaving half of it for the I2C traffic and the control loop.
+ */
+static constexpr auto scan_fits(ADS1115::DataRate rate, uint8_t oversample)
+    -> bool {
+    return (max_pins_per_adc() * oversample *
+            ADS1115::conversion_time_us(rate)) <=
+           (decltype(_main_task)::CONTROL_PERIOD_US / 2);
+}
+static_assert(scan_fits(_default_acquisition.data_rate,
+                        _default_acquisition.oversample),
+              "The default scan doesn't fit in a control period");
+static_assert(_default_acquisition.oversample <= ADS1115::ADC::max_oversample,
+              "Too much oversampling for one scan");
+
+/** Pick up any new acquisition settings before a scan.*/
+static auto apply_pending_acquisition() -> void {
+    taskENTER_CRITICAL();
+    auto pending = _pending_acquisition;
+    _pending_acquisition.reset();
+    taskEXIT_CRITICAL();
+    if (!pending.has_value()) {
+        return;
+    }
+    _acquisition = pending.value();
+    for (auto &adc : _adc) {
+        adc.set_data_rate(_acquisition.data_rate);
+    }
+    // Readings taken with the old settings don't belong in the new filters
+    _filters.fill(AdcFilter(_acquisition.filter, _acquisition.filter_alpha));
+}
+
 // Internal FreeRTOS data structure for the task
 static StaticTask_t
     data;  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
 
 /**
- * Performs a conversion from an ADC pin and returns the value read.
- * @param[in] pin The pin to read
+ * Gets the filtered result of the last scan of a thermistor.
+ * @param[in] id The thermistor to get
+ * @param[out] timestamp_us Set to when the conversion finished, if it
+ * succeeded
  * @return The value read by the ADC in counts. Will return 0 if the
- * ADC cannot be read.
+ * ADC could not be read.
  */
-static auto read_thermistor(const ADCPinMap &pin) -> uint16_t {
+static auto scanned_thermistor(ThermistorID id, uint32_t &timestamp_us)
+    -> uint16_t {
+    const auto &pin = _adc_map.at(id);
     auto result =
-        _adc.at(static_cast<uint8_t>(pin.adc_index)).read(pin.adc_pin);
+        _adc.at(static_cast<uint8_t>(pin.adc_index)).last_sample(pin.adc_pin);
     if (std::holds_alternative<ADS1115::Error>(result)) {
+        // Don't let readings from before the failure into the filter
+        _filters.at(id).reset();
         return 0;
     }
-    return std::get<uint16_t>(result);
+    auto sample = std::get<ADS1115::Sample>(result);
+    timestamp_us = sample.timestamp_us;
+    return _filters.at(id).update(sample.value);
 }
 
 static void run(void *param) {
@@ -104,8 +202,19 @@ static void run(void *param) {
 static void run_thermistor_task(void *param) {
     static_cast<void>(param);
     thermal_hardware_setup();
+    _adc[ADC_FRONT].set_data_rate(_acquisition.data_rate);
+    _adc[ADC_REAR].set_data_rate(_acquisition.data_rate);
     _adc[ADC_FRONT].initialize();
     _adc[ADC_REAR].initialize();
+    // Every plate thermistor is converted in one scan. The front and rear
+    // ADCs each work through their own pins, converting at the same time.
+    std::array<ADS1115::ScanEntry, _adc_map.size()> scan{};
+    for (size_t i = 0; i < _adc_map.size(); ++i) {
+        scan.at(i) = ADS1115::ScanEntry{
+            .adc = &_adc.at(static_cast<uint8_t>(_adc_map.at(i).adc_index)),
+            .pin = _adc_map.at(i).adc_pin};
+    }
+    std::array<uint32_t, _adc_map.size()> timestamps{};
     auto last_wake_time = xTaskGetTickCount();
     messages::ThermalPlateTempReadComplete readings{};
     while (true) {
@@ -114,13 +223,36 @@ static void run_thermistor_task(void *param) {
             // NOLINTNEXTLINE(readability-static-accessed-through-instance)
             _main_task.CONTROL_PERIOD_TICKS);
 
-        readings.front_right = read_thermistor(_adc_map[THERM_FRONT_RIGHT]);
-        readings.front_left = read_thermistor(_adc_map[THERM_FRONT_LEFT]);
-        readings.front_center = read_thermistor(_adc_map[THERM_FRONT_CENTER]);
-        readings.back_left = read_thermistor(_adc_map[THERM_BACK_LEFT]);
-        readings.back_right = read_thermistor(_adc_map[THERM_BACK_RIGHT]);
-        readings.back_center = read_thermistor(_adc_map[THERM_BACK_CENTER]);
-        readings.heat_sink = read_thermistor(_adc_map[THERM_HEATSINK]);
+        apply_pending_acquisition();
+        auto scan_start = thermal_hardware_timestamp_us();
+        timestamps.fill(scan_start);
+        // Failed conversions show up as errors from last_sample below
+        static_cast<void>(ADS1115::ADC::scan(scan, _acquisition.oversample));
+
+        readings.front_right = scanned_thermistor(
+            THERM_FRONT_RIGHT, timestamps[THERM_FRONT_RIGHT]);
+        readings.front_left =
+            scanned_thermistor(THERM_FRONT_LEFT, timestamps[THERM_FRONT_LEFT]);
+        readings.front_center = scanned_thermistor(
+            THERM_FRONT_CENTER, timestamps[THERM_FRONT_CENTER]);
+        readings.back_left =
+            scanned_thermistor(THERM_BACK_LEFT, timestamps[THERM_BACK_LEFT]);
+        readings.back_right =
+            scanned_thermistor(THERM_BACK_RIGHT, timestamps[THERM_BACK_RIGHT]);
+        readings.back_center = scanned_thermistor(
+            THERM_BACK_CENTER, timestamps[THERM_BACK_CENTER]);
+        readings.heat_sink =
+            scanned_thermistor(THERM_HEATSINK, timestamps[THERM_HEATSINK]);
+        // Both ADCs convert at once, so any entry may be first or last.
+        // Offsets from the start are taken first in case the counter wraps.
+        uint32_t first = UINT32_MAX;
+        uint32_t last = 0;
+        for (auto timestamp : timestamps) {
+            first = std::min(first, timestamp - scan_start);
+            last = std::max(last, timestamp - scan_start);
+        }
+        readings.timestamp_us = scan_start + first;
+        readings.acquisition_us = last;
 
         auto send_ret = _main_task.get_message_queue().try_send(readings);
         static_cast<void>(
@@ -128,6 +260,37 @@ static void run_thermistor_task(void *param) {
     }
 }
 
+auto set_acquisition(uint16_t data_rate_sps, uint8_t oversample,
+                     AdcFilter::Mode filter, double filter_alpha) -> bool {
+    using ADS1115::DataRate;
+    auto data_rate = DataRate::SPS_860;
+    // Slower rates never fit a scan in a control period (see M105.A)
+    switch (data_rate_sps) {
+        case 250:
+            data_rate = DataRate::SPS_250;
+            break;
+        case 475:
+            data_rate = DataRate::SPS_475;
+            break;
+        case 860:
+            data_rate = DataRate::SPS_860;
+            break;
+        default:
+            return false;
+    }
+    if ((oversample == 0) || (oversample > ADS1115::ADC::max_oversample) ||
+        !scan_fits(data_rate, oversample)) {
+        return false;
+    }
+    taskENTER_CRITICAL();
+    _pending_acquisition = Acquisition{.data_rate = data_rate,
+                                       .oversample = oversample,
+                                       .filter = filter,
+                                       .filter_alpha = filter_alpha};
+    taskEXIT_CRITICAL();
+    return true;
+}
+
 // Function that spins up the task
 auto start()
     -> tasks::Task<TaskHandle_t,
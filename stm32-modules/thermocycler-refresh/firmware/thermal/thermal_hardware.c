@@ -19,6 +19,26 @@
  * Note that the thread safety only applies to individual reads to the I2C bus.
  * Transactions which constitute multiple reads in a row (e.g. reading from an
  * ADC) may require further semaphore use on a higher level.
+ *
+ * ADC scans are the exception: thermal_adc_scan takes the I2C semaphore once
+ * and then chains every conversion from interrupt context. The READY pin
+ * interrupt starts the read of the result, and the end of that read starts
+ * the next conversion, so the scanning thread sleeps until the last result
+ * is in instead of waking up two or three times per conversion.
+ *
+ * Each ADC in a scan runs its own chain, so conversions on different chips
+ * overlap and only the short I2C transfers take turns on the bus. A transfer
+ * that finds the bus busy is left pending and started from the interrupt
+ * that frees the bus, with result reads going ahead of conversion starts.
+ *
+ * A step can ask for several conversions of the same pin. They run back to
+ * back in the step's chain and the step's result is their rounded average.
+ *
+ * Every I2C transfer moves its data by DMA. Register accesses that don't
+ * depend on an ADC READY pin can be grouped into a batch with
+ * thermal_i2c_batch, which runs them back to back from the transfer complete
+ * interrupts and only wakes the calling thread once at the end. The single
+ * register functions are batches of one.
  */
 
 #include "firmware/thermal_hardware.h"
@@ -52,20 +72,44 @@
 #define I2C_BUF_MAX (2)
 /** Size of register address: 1 byte.*/
 #define REGISTER_ADDR_LEN (1)
+/** DMA channels for the I2C transfers, routed to I2C2 through DMAMUX.*/
+#define I2C_DMA_TX_CHANNEL (DMA1_Channel1)
+#define I2C_DMA_RX_CHANNEL (DMA1_Channel2)
+/** NVIC priority of the I2C DMA interrupts. Same as the I2C interrupts,
+ * since both can move a scan or batch along.*/
+#define I2C_DMA_ITR_PRIO (5)
+/** Time allowed for each transfer in a batch.*/
+#define I2C_TRANSFER_TIMEOUT_MS (100)
 /** NVIC priority of ADC interrupts.
  * On the higher end (low-priority) because timing
  * is not critical compared to other interrupts.
  */
 #define ADC_READY_ITR_PRIO (10)
+/** 32 bit timer used for microsecond timestamps.*/
+#define TIMESTAMP_TIMER (TIM2)
+#define TIMESTAMP_TIMER_CLOCK_FREQ (170000000)
+#define TIMESTAMP_TIMER_PRESCALER ((TIMESTAMP_TIMER_CLOCK_FREQ / 1000000) - 1)
+
+/** Local types */
+
+/** Where one ADC is in its part of a scan.*/
+typedef enum {
+    CHAIN_DONE,          /**< No conversions left for this ADC*/
+    CHAIN_START_PENDING, /**< Waiting for the bus to start a conversion*/
+    CHAIN_STARTING,      /**< Writing the register that starts a conversion*/
+    CHAIN_CONVERTING,    /**< Waiting for the ADC READY pin*/
+    CHAIN_READ_PENDING,  /**< Waiting for the bus to read the result*/
+    CHAIN_READING        /**< Reading back the result*/
+} chain_state_t;
+
+/** Marks the I2C bus as free in \ref _scan.*/
+#define SCAN_BUS_FREE (-1)
 
 /** Local variables */
 
-static TaskHandle_t _i2c_task_to_notify = NULL;
 static atomic_flag _initialization_started = ATOMIC_FLAG_INIT;
 static bool _initialization_done = false;
 
-/** When an ADC READY pin is triggered, which task to notify.*/
-static TaskHandle_t _gpio_task_to_notify[ADC_ITR_NUM] = {NULL};
 /** Mapping from ITR enum to actual pin numbers.*/
 static const uint16_t _adc_itr_gpio[ADC_ITR_NUM] = {
     GPIO_PIN_9,
@@ -79,9 +123,63 @@ StaticSemaphore_t _i2c_semaphore_buffer;
 
 /** There's only one I2C handle for the device*/
 I2C_HandleTypeDef _i2c_handle;
+/** DMA handles for I2C transmit and receive*/
+DMA_HandleTypeDef _i2c_dma_tx;
+DMA_HandleTypeDef _i2c_dma_rx;
 /** Buffers are shared for writing/reading.*/
 uint8_t _i2c_buffer[I2C_BUF_MAX];
 
+/** Free running microsecond counter*/
+static TIM_HandleTypeDef _timestamp_timer;
+
+/** State of the ADC scan. Only modified by the interrupts below while
+ * a scan is active.*/
+static struct {
+    volatile bool active;
+    const thermal_adc_scan_step_t *steps;
+    uint8_t count;
+    bool ok;
+    /** Which chain owns the I2C bus, or SCAN_BUS_FREE*/
+    int8_t bus_owner;
+    struct {
+        volatile chain_state_t state;
+        /** The step this chain is working on*/
+        uint8_t index;
+        /** Conversions read back so far for this step*/
+        uint8_t taken;
+        /** Sum of the conversions read back so far for this step*/
+        uint32_t sum;
+    } chains[ADC_ITR_NUM];
+    TaskHandle_t task_to_notify;
+} _scan = {
+    .active = false,
+    .steps = NULL,
+    .count = 0,
+    .ok = false,
+    .bus_owner = SCAN_BUS_FREE,
+    .chains = {{CHAIN_DONE, 0, 0, 0}},
+    .task_to_notify = NULL,
+};
+
+/** State of the I2C batch. Only modified by the interrupts below while
+ * a batch is active.*/
+static struct {
+    volatile bool active;
+    thermal_i2c_transfer_t *transfers;
+    uint8_t count;
+    /** The transfer on the bus*/
+    uint8_t index;
+    bool ok;
+    TaskHandle_t task_to_notify;
+} _batch = {
+    .active = false,
+    .transfers = NULL,
+    .count = 0,
+    .index = 0,
+    .ok = false,
+    .task_to_notify = NULL,
+};
+
 /** Local functions */
 
 static void thermal_gpio_init(void) {
@@ -129,6 +227,245 @@ static void thermal_i2c_init(void) {
     __HAL_SYSCFG_FASTMODEPLUS_ENABLE(I2C_FASTMODEPLUS_I2C2);
 }
 
+static void thermal_i2c_dma_init(void) {
+    HAL_StatusTypeDef hal_ret;
+    __HAL_RCC_DMAMUX1_CLK_ENABLE();
+    __HAL_RCC_DMA1_CLK_ENABLE();
+
+    _i2c_dma_tx.Instance = I2C_DMA_TX_CHANNEL;
+    _i2c_dma_tx.Init.Request = DMA_REQUEST_I2C2_TX;
+    _i2c_dma_tx.Init.Direction = DMA_MEMORY_TO_PERIPH;
+    _i2c_dma_tx.Init.PeriphInc = DMA_PINC_DISABLE;
+    _i2c_dma_tx.Init.MemInc = DMA_MINC_ENABLE;
+    _i2c_dma_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    _i2c_dma_tx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    _i2c_dma_tx.Init.Mode = DMA_NORMAL;
+    _i2c_dma_tx.Init.Priority = DMA_PRIORITY_LOW;
+    hal_ret = HAL_DMA_Init(&_i2c_dma_tx);
+    configASSERT(hal_ret == HAL_OK);
+    __HAL_LINKDMA(&_i2c_handle, hdmatx, _i2c_dma_tx);
+
+    _i2c_dma_rx.Instance = I2C_DMA_RX_CHANNEL;
+    _i2c_dma_rx.Init.Request = DMA_REQUEST_I2C2_RX;
+    _i2c_dma_rx.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    _i2c_dma_rx.Init.PeriphInc = DMA_PINC_DISABLE;
+    _i2c_dma_rx.Init.MemInc = DMA_MINC_ENABLE;
+    _i2c_dma_rx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    _i2c_dma_rx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    _i2c_dma_rx.Init.Mode = DMA_NORMAL;
+    _i2c_dma_rx.Init.Priority = DMA_PRIORITY_LOW;
+    hal_ret = HAL_DMA_Init(&_i2c_dma_rx);
+    configASSERT(hal_ret == HAL_OK);
+    __HAL_LINKDMA(&_i2c_handle, hdmarx, _i2c_dma_rx);
+
+    HAL_NVIC_SetPriority(DMA1_Channel1_IRQn, I2C_DMA_ITR_PRIO, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Channel1_IRQn);
+    HAL_NVIC_SetPriority(DMA1_Channel2_IRQn, I2C_DMA_ITR_PRIO, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Channel2_IRQn);
+}
+
+static void thermal_timestamp_init(void) {
+    HAL_StatusTypeDef hal_ret;
+    __HAL_RCC_TIM2_CLK_ENABLE();
+    _timestamp_timer.Instance = TIMESTAMP_TIMER;
+    _timestamp_timer.Init.Prescaler = TIMESTAMP_TIMER_PRESCALER;
+    _timestamp_timer.Init.CounterMode = TIM_COUNTERMODE_UP;
+    _timestamp_timer.Init.Period = 0xFFFFFFFF;
+    _timestamp_timer.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+    _timestamp_timer.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+    hal_ret = HAL_TIM_Base_Init(&_timestamp_timer);
+    configASSERT(hal_ret == HAL_OK);
+    hal_ret = HAL_TIM_Base_Start(&_timestamp_timer);
+    configASSERT(hal_ret == HAL_OK);
+}
+
+/**
+ * Stops a transfer that stalled, so that it can't finish into the shared
+ * buffer, or set off a callback, once the bus has moved on. The HAL's
+ * abort only handles plain master transfers, not the memory transfers used
+ * here, so this stops both DMA channels and resets the peripheral, which
+ * also lets go of the bus lines.
+ * Only call from task context with the bus semaphore held, after ending
+ * the scan or batch the transfer belonged to.
+ */
+static void thermal_i2c_abort(void) {
+    HAL_StatusTypeDef hal_ret;
+    // Either may be idle, which the HAL reports as an error
+    (void)HAL_DMA_Abort(&_i2c_dma_tx);
+    (void)HAL_DMA_Abort(&_i2c_dma_rx);
+    hal_ret = HAL_I2C_DeInit(&_i2c_handle);
+    configASSERT(hal_ret == HAL_OK);
+    thermal_i2c_init();
+}
+
+/**
+ * Forgets any notification that arrived after a wait for one timed out,
+ * so that it can't end the next wait early.
+ */
+static void thermal_i2c_clear_notification(void) {
+    (void)xTaskNotifyStateClear(NULL);
+    (void)ulTaskNotifyValueClear(NULL, UINT32_MAX);
+}
+
+/**
+ * Ends the running scan, without waking up the thread that started it.
+ * Only call from interrupt context or with interrupts masked.
+ */
+static void thermal_adc_scan_end(bool ok) {
+    _scan.ok = ok;
+    _scan.active = false;
+}
+
+/**
+ * Wakes up the thread that started the scan, once the scan has ended.
+ * Only call from interrupt context.
+ */
+static void thermal_adc_scan_notify_from_isr(void) {
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    if(_scan.task_to_notify != NULL) {
+        vTaskNotifyGiveFromISR(_scan.task_to_notify, &xHigherPriorityTaskWoken);
+        _scan.task_to_notify = NULL;
+    }
+    portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+}
+
+/**
+ * Ends the running scan and wakes up the thread that started it.
+ * Only call from interrupt context.
+ */
+static void thermal_adc_scan_finish(bool ok) {
+    thermal_adc_scan_end(ok);
+    thermal_adc_scan_notify_from_isr();
+}
+
+/**
+ * Finds the first step at or after \c from that belongs to an ADC.
+ * @return The step index, or the step count if there are none left.
+ */
+static uint8_t thermal_adc_scan_next_step(ADC_ITR_T id, uint8_t from) {
+    while((from < _scan.count) && (_scan.steps[from].id != id)) {
+        ++from;
+    }
+    return from;
+}
+
+/**
+ * Starts the I2C transfer a chain is waiting on.
+ * @return true if the transfer was started
+ */
+static bool thermal_adc_scan_transfer(ADC_ITR_T id) {
+    const thermal_adc_scan_step_t *step =
+        &_scan.steps[_scan.chains[id].index];
+    _scan.bus_owner = (int8_t)id;
+    if(_scan.chains[id].state == CHAIN_READ_PENDING) {
+        _scan.chains[id].state = CHAIN_READING;
+        return HAL_I2C_Mem_Read_DMA(&_i2c_handle, step->addr,
+                                    (uint16_t)step->result_reg,
+                                    REGISTER_ADDR_LEN, _i2c_buffer,
+                                    I2C_BUF_MAX) == HAL_OK;
+    }
+    _scan.chains[id].state = CHAIN_STARTING;
+    _i2c_buffer[0] = (step->start_val >> 8) & 0xFF;
+    _i2c_buffer[1] = (step->start_val & 0xFF);
+    return HAL_I2C_Mem_Write_DMA(&_i2c_handle, step->addr,
+                                 (uint16_t)step->start_reg, REGISTER_ADDR_LEN,
+                                 _i2c_buffer, I2C_BUF_MAX) == HAL_OK;
+}
+
+/**
+ * Gives the I2C bus to the next chain that is waiting for it, or ends the
+ * scan once every chain is done. Reads go first, since until its result is
+ * read back an ADC can't start its next conversion anyway.
+ * Only call from interrupt context or with interrupts masked.
+ * @return true if this ended the scan. The thread that started it is not
+ * woken up here, since this also runs in that thread as the scan starts.
+ */
+static bool thermal_adc_scan_dispatch(void) {
+    int id;
+    int next = SCAN_BUS_FREE;
+    bool done = true;
+    if(!_scan.active || (_scan.bus_owner != SCAN_BUS_FREE)) {
+        return false;
+    }
+    for(id = 0; id < ADC_ITR_NUM; ++id) {
+        if(_scan.chains[id].state != CHAIN_DONE) {
+            done = false;
+        }
+        if(_scan.chains[id].state == CHAIN_READ_PENDING) {
+            next = id;
+            break;
+        }
+        if((_scan.chains[id].state == CHAIN_START_PENDING) &&
+           (next == SCAN_BUS_FREE)) {
+            next = id;
+        }
+    }
+    if(done) {
+        thermal_adc_scan_end(true);
+        return true;
+    }
+    if((next != SCAN_BUS_FREE) &&
+       !thermal_adc_scan_transfer((ADC_ITR_T)next)) {
+        _scan.bus_owner = SCAN_BUS_FREE;
+        thermal_adc_scan_end(false);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Starts the current transfer of the batch.
+ * @return true if the transfer was started
+ */
+static bool thermal_i2c_batch_transfer(void) {
+    const thermal_i2c_transfer_t *transfer = &_batch.transfers[_batch.index];
+    if(transfer->op == THERMAL_I2C_READ) {
+        return HAL_I2C_Mem_Read_DMA(&_i2c_handle, transfer->addr,
+                                    (uint16_t)transfer->reg,
+                                    REGISTER_ADDR_LEN, _i2c_buffer,
+                                    I2C_BUF_MAX) == HAL_OK;
+    }
+    _i2c_buffer[0] = (transfer->value >> 8) & 0xFF;
+    _i2c_buffer[1] = (transfer->value & 0xFF);
+    return HAL_I2C_Mem_Write_DMA(&_i2c_handle, transfer->addr,
+                                 (uint16_t)transfer->reg, REGISTER_ADDR_LEN,
+                                 _i2c_buffer, I2C_BUF_MAX) == HAL_OK;
+}
+
+/**
+ * Ends the running batch and wakes up the thread that started it.
+ * Only call from interrupt context.
+ */
+static void thermal_i2c_batch_finish(bool ok) {
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    _batch.ok = ok;
+    _batch.active = false;
+    if(_batch.task_to_notify != NULL) {
+        vTaskNotifyGiveFromISR(_batch.task_to_notify, &xHigherPriorityTaskWoken);
+        _batch.task_to_notify = NULL;
+    }
+    portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+}
+
+/**
+ * Stores the result of the transfer that just finished and starts the
+ * next one, or ends the batch after the last one.
+ * Only call from interrupt context.
+ */
+static void thermal_i2c_batch_next(void) {
+    thermal_i2c_transfer_t *transfer = &_batch.transfers[_batch.index];
+    if(transfer->op == THERMAL_I2C_READ) {
+        transfer->value = (((uint16_t)_i2c_buffer[0]) << 8) |
+                          ((uint16_t)_i2c_buffer[1]);
+    }
+    _batch.index++;
+    if(_batch.index >= _batch.count) {
+        thermal_i2c_batch_finish(true);
+    } else if(!thermal_i2c_batch_transfer()) {
+        thermal_i2c_batch_finish(false);
+    }
+}
+
 /** Public functions */
 
 void thermal_hardware_setup(void) {
@@ -144,6 +481,8 @@ void thermal_hardware_setup(void) {
         configASSERT(_i2c_semaphore != NULL);
         thermal_gpio_init();
         thermal_i2c_init();
+        thermal_i2c_dma_init();
+        thermal_timestamp_init();
         thermal_peltier_initialize();
         thermal_fan_initialize();
         thermal_heater_initialize();
@@ -160,100 +499,187 @@ void thermal_hardware_wait_for_init(void)
     }
 }
 
-bool thermal_i2c_write_16(uint16_t addr, uint8_t reg, uint16_t val) {
-    const uint16_t bytes_to_send = 2;
-    const TickType_t max_block_time = pdMS_TO_TICKS(100);
+bool thermal_i2c_batch(thermal_i2c_transfer_t *transfers, uint8_t count) {
     BaseType_t sem_ret;
     uint32_t notification_val = 0;
-    HAL_StatusTypeDef hal_ret;
+    bool started = false;
+    bool ret = false;
+
+    if((transfers == NULL) || (count == 0)) {
+        return false;
+    }
 
     sem_ret = xSemaphoreTake(_i2c_semaphore, portMAX_DELAY);
     if(sem_ret != pdTRUE) {
         return false;
     }
-
-    // Set up notification info
-    if(_i2c_task_to_notify != NULL) {
+    if(_batch.active || _scan.active) {
         xSemaphoreGive(_i2c_semaphore);
         return false;
     }
-    _i2c_task_to_notify = xTaskGetCurrentTaskHandle();
 
-    // Prepare buffer & send it
-    _i2c_buffer[0] = (val >> 8) & 0xFF;
-    _i2c_buffer[1] = (val & 0xFF);
-    hal_ret = HAL_I2C_Mem_Write_IT(&_i2c_handle, addr, (uint16_t)reg,
-                                   REGISTER_ADDR_LEN, _i2c_buffer, 
-                                   bytes_to_send);
-    if(hal_ret == HAL_OK) {
-        // Block on the interrupt for transmit_complete
-        notification_val = ulTaskNotifyTake(pdTRUE, max_block_time);
+    _batch.transfers = transfers;
+    _batch.count = count;
+    _batch.index = 0;
+    _batch.ok = false;
+    _batch.task_to_notify = xTaskGetCurrentTaskHandle();
+    // A short transfer may finish and start the next one before this
+    // returns, so keep the interrupts out until the batch is kicked off
+    taskENTER_CRITICAL();
+    _batch.active = true;
+    started = thermal_i2c_batch_transfer();
+    if(!started) {
+        _batch.active = false;
+        _batch.task_to_notify = NULL;
+    }
+    taskEXIT_CRITICAL();
+
+    if(started) {
+        notification_val = ulTaskNotifyTake(
+            pdTRUE, pdMS_TO_TICKS(I2C_TRANSFER_TIMEOUT_MS * count));
+        if(notification_val == 0) {
+            // The batch stalled. Stop it so it can't write into the
+            // caller's transfers after we return.
+            taskENTER_CRITICAL();
+            _batch.active = false;
+            _batch.task_to_notify = NULL;
+            taskEXIT_CRITICAL();
+            thermal_i2c_abort();
+            thermal_i2c_clear_notification();
+        } else {
+            ret = _batch.ok;
+        }
     }
 
     // Ignore return, we would not return an error here even if it fails
     (void)xSemaphoreGive(_i2c_semaphore);
+    return ret;
+}
 
-    return (notification_val == 1) && (hal_ret == HAL_OK);
+bool thermal_i2c_write_16(uint16_t addr, uint8_t reg, uint16_t val) {
+    thermal_i2c_transfer_t transfer = {
+        .op = THERMAL_I2C_WRITE,
+        .addr = addr,
+        .reg = reg,
+        .value = val,
+    };
+    return thermal_i2c_batch(&transfer, 1);
 }
 
 bool thermal_i2c_read_16(uint16_t addr, uint8_t reg, uint16_t *val) {
-    const uint16_t bytes_to_read = 2;
-    const TickType_t max_block_time = pdMS_TO_TICKS(100);
+    thermal_i2c_transfer_t transfer = {
+        .op = THERMAL_I2C_READ,
+        .addr = addr,
+        .reg = reg,
+        .value = 0,
+    };
+    if(!thermal_i2c_batch(&transfer, 1)) {
+        return false;
+    }
+    // Only write an output value if we succesfully read from the device
+    *val = transfer.value;
+    return true;
+}
+
+bool thermal_adc_scan(const thermal_adc_scan_step_t *steps, uint8_t count,
+                      uint32_t timeout_ms) {
     BaseType_t sem_ret;
-    uint32_t notification_val;
-    HAL_StatusTypeDef hal_ret;
+    uint32_t notification_val = 0;
+    bool ended = false;
+    bool ret = false;
+    uint8_t i;
+
+    if((steps == NULL) || (count == 0)) {
+        return false;
+    }
+    for(i = 0; i < count; ++i) {
+        steps[i].result->valid = false;
+    }
 
     sem_ret = xSemaphoreTake(_i2c_semaphore, portMAX_DELAY);
     if(sem_ret != pdTRUE) {
         return false;
     }
-    
-    // Set up notification info
-    if(_i2c_task_to_notify != NULL) {
+    if(_batch.active || _scan.active) {
         xSemaphoreGive(_i2c_semaphore);
         return false;
     }
-    _i2c_task_to_notify = xTaskGetCurrentTaskHandle();
-    
-    hal_ret = HAL_I2C_Mem_Read_IT(&_i2c_handle, addr, (uint16_t)reg,
-                                  REGISTER_ADDR_LEN, _i2c_buffer,
-                                  bytes_to_read);
-    if(hal_ret == HAL_OK) {
-        // Block on the interrupt for transmit_complete
-        notification_val = ulTaskNotifyTake(pdTRUE, max_block_time);
-        if(notification_val == 1) {
-            // Only write an output value if we succesfully read from the device
-            *val = (((uint16_t)_i2c_buffer[0]) << 8) | ((uint16_t)_i2c_buffer[1]);
+
+    _scan.steps = steps;
+    _scan.count = count;
+    _scan.ok = false;
+    _scan.bus_owner = SCAN_BUS_FREE;
+    _scan.task_to_notify = xTaskGetCurrentTaskHandle();
+    for(i = 0; i < ADC_ITR_NUM; ++i) {
+        _scan.chains[i].index = thermal_adc_scan_next_step((ADC_ITR_T)i, 0);
+        _scan.chains[i].taken = 0;
+        _scan.chains[i].sum = 0;
+        _scan.chains[i].state = (_scan.chains[i].index < count)
+            ? CHAIN_START_PENDING : CHAIN_DONE;
+    }
+    // The first transfer's interrupts may dispatch the next one before
+    // this returns, so keep them out until the scan is fully kicked off
+    taskENTER_CRITICAL();
+    _scan.active = true;
+    ended = thermal_adc_scan_dispatch();
+    if(ended) {
+        // The scan ended before any interrupt could, e.g. the first
+        // transfer failed to start, so there's nothing to wait for
+        _scan.task_to_notify = NULL;
+    }
+    taskEXIT_CRITICAL();
+
+    if(ended) {
+        ret = _scan.ok;
+    } else {
+        notification_val = ulTaskNotifyTake(pdTRUE,
+                                            pdMS_TO_TICKS(timeout_ms));
+        if(notification_val == 0) {
+            // The chain stalled. Stop it so it can't write into the
+            // caller's buffers after we return.
+            taskENTER_CRITICAL();
+            _scan.active = false;
+            _scan.bus_owner = SCAN_BUS_FREE;
+            _scan.task_to_notify = NULL;
+            taskEXIT_CRITICAL();
+            thermal_i2c_abort();
+            thermal_i2c_clear_notification();
+        } else {
+            ret = _scan.ok;
         }
     }
 
     // Ignore return, we would not return an error here even if it fails
     (void)xSemaphoreGive(_i2c_semaphore);
-
-    return (notification_val == 1) && (hal_ret == HAL_OK);
+    return ret;
 }
 
-bool thermal_arm_adc_for_read(ADC_ITR_T id) {
-    if(_gpio_task_to_notify[id] != NULL) {
-        return false;
-    }
-    _gpio_task_to_notify[id] = xTaskGetCurrentTaskHandle();
-    return true;
+uint32_t thermal_hardware_timestamp_us(void) {
+    return __HAL_TIM_GET_COUNTER(&_timestamp_timer);
 }
 
 void thermal_adc_ready_callback(ADC_ITR_T id) {
+    UBaseType_t saved_interrupts;
+    bool ended = false;
     // Check that the pin is actually set - the interrupt doesn't do this for us,
     // and other pins trigger the same interrupt vector.
     if(__HAL_GPIO_EXTI_GET_IT(_adc_itr_gpio[id]) != 0x00u) {
         __HAL_GPIO_EXTI_CLEAR_IT(_adc_itr_gpio[id]);
-        // There's a possibility of getting an interrupt when we don't expect
-        // one, so just ignore if there's no armed task.
-        if(_gpio_task_to_notify[id] != NULL) {
-            BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-            vTaskNotifyGiveFromISR( _gpio_task_to_notify[id], &xHigherPriorityTaskWoken );
-            _gpio_task_to_notify[id] = NULL;
-            portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+        if(_scan.active && (_scan.chains[id].state == CHAIN_CONVERTING)) {
+            // The I2C interrupts run at a higher priority and also
+            // dispatch, so keep them out while this one does
+            saved_interrupts = taskENTER_CRITICAL_FROM_ISR();
+            _scan.steps[_scan.chains[id].index].result->timestamp_us =
+                thermal_hardware_timestamp_us();
+            _scan.chains[id].state = CHAIN_READ_PENDING;
+            ended = thermal_adc_scan_dispatch();
+            taskEXIT_CRITICAL_FROM_ISR(saved_interrupts);
+            if(ended) {
+                thermal_adc_scan_notify_from_isr();
+            }
         }
+        // There's a possibility of getting an interrupt when we don't expect
+        // one, e.g. after a scan timed out, so just ignore anything else.
     }
 }
 
@@ -261,36 +687,68 @@ void thermal_adc_ready_callback(ADC_ITR_T id) {
 
 void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *i2c_handle)
 {
-    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-    if( _i2c_task_to_notify == NULL ) {
+    int8_t id = _scan.bus_owner;
+    if( _scan.active && (id != SCAN_BUS_FREE) ) {
+        // The conversion is running; the READY pin picks up from here
+        _scan.chains[id].state = CHAIN_CONVERTING;
+        _scan.bus_owner = SCAN_BUS_FREE;
+        if(thermal_adc_scan_dispatch()) {
+            thermal_adc_scan_notify_from_isr();
+        }
         return;
     }
-    vTaskNotifyGiveFromISR( _i2c_task_to_notify, &xHigherPriorityTaskWoken );
-    _i2c_task_to_notify = NULL;
-    portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+    if( _batch.active ) {
+        thermal_i2c_batch_next();
+    }
 }
 
 void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *i2c_handle)
 {
-    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-    if( _i2c_task_to_notify == NULL ) {
+    const thermal_adc_scan_step_t *step = NULL;
+    uint8_t samples;
+    int8_t id = _scan.bus_owner;
+    if( _scan.active && (id != SCAN_BUS_FREE) ) {
+        step = &_scan.steps[_scan.chains[id].index];
+        samples = (step->samples == 0) ? 1 : step->samples;
+        _scan.chains[id].sum += (((uint16_t)_i2c_buffer[0]) << 8) |
+                                ((uint16_t)_i2c_buffer[1]);
+        _scan.chains[id].taken++;
+        if(_scan.chains[id].taken < samples) {
+            // Same step again for the next conversion to average
+            _scan.chains[id].state = CHAIN_START_PENDING;
+        } else {
+            step->result->value = (uint16_t)(
+                (_scan.chains[id].sum + (samples / 2)) / samples);
+            step->result->valid = true;
+            _scan.chains[id].taken = 0;
+            _scan.chains[id].sum = 0;
+            _scan.chains[id].index = thermal_adc_scan_next_step(
+                (ADC_ITR_T)id, _scan.chains[id].index + 1);
+            _scan.chains[id].state = (_scan.chains[id].index < _scan.count)
+                ? CHAIN_START_PENDING : CHAIN_DONE;
+        }
+        _scan.bus_owner = SCAN_BUS_FREE;
+        if(thermal_adc_scan_dispatch()) {
+            thermal_adc_scan_notify_from_isr();
+        }
         return;
     }
-    vTaskNotifyGiveFromISR( _i2c_task_to_notify, &xHigherPriorityTaskWoken );
-    _i2c_task_to_notify = NULL;
-    portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+    if( _batch.active ) {
+        thermal_i2c_batch_next();
+    }
 }
 
 
 void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *i2c_handle)
 {
-    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-    if( _i2c_task_to_notify == NULL ) {
+    if( _scan.active ) {
+        _scan.bus_owner = SCAN_BUS_FREE;
+        thermal_adc_scan_finish(false);
         return;
     }
-    vTaskNotifyGiveFromISR( _i2c_task_to_notify, &xHigherPriorityTaskWoken );
-    _i2c_task_to_notify = NULL;
-    portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+    if( _batch.active ) {
+        thermal_i2c_batch_finish(false);
+    }
 }
 
 /** Interrupt handlers */
@@ -316,3 +774,13 @@ void I2C2_ER_IRQHandler(void)
 
   /* USER CODE END I2C2_ER_IRQn 1 */
 }
+
+void DMA1_Channel1_IRQHandler(void)
+{
+    HAL_DMA_IRQHandler(&_i2c_dma_tx);
+}
+
+void DMA1_Channel2_IRQHandler(void)
+{
+    HAL_DMA_IRQHandler(&_i2c_dma_rx);
+}
@@ -1,5 +1,6 @@
 #include "firmware/thermal_plate_policy.hpp"
 
+#include "firmware/freertos_thermal_plate_task.hpp"
 #include "firmware/thermal_fan_hardware.h"
 #include "firmware/thermal_peltier_hardware.h"
 #include "systemwide.h"
@@ -41,3 +42,12 @@ auto ThermalPlatePolicy::set_fan(double power) -> bool {
     power = std::clamp(power, (double)0.0F, (double)1.0F);
     return thermal_fan_set_power(power);
 }
+
+// NOLINTNEXTLINE(readability-convert-member-functions-to-static)
+auto ThermalPlatePolicy::set_acquisition(uint16_t data_rate_sps,
+                                         uint8_t oversample,
+                                         AdcFilter::Mode filter,
+                                         double filter_alpha) -> bool {
+    return thermal_plate_control_task::set_acquisition(
+        data_rate_sps, oversample, filter, filter_alpha);
+}
@@ -135,10 +135,12 @@ def set_heater_pid(p: float, i: float, d: float, ser: serial.Serial):
     guard_error(res, b'M301 OK')
     print(res)
 
-# Sets the plate target as a temperature in celsius
-def set_plate_temperature(temperature: float, ser: serial.Serial):
+# Sets the plate target as a temperature in celsius. If a sample volume
+# in microliters is given, the plate overshoots to bring the sample in faster.
+def set_plate_temperature(temperature: float, ser: serial.Serial, volume: float = None):
     print(f'Setting plate temperature target to {temperature}C')
-    ser.write(f'M104 S{temperature}\n'.encode())
+    volume_arg = f' V{volume}' if volume else ''
+    ser.write(f'M104 S{temperature}{volume_arg}\n'.encode())
     res = ser.readline()
     guard_error(res, b'M104 OK')
     print(res)
@@ -158,3 +160,66 @@ def set_peltier_pid(p: float, i: float, d: float, ser: serial.Serial):
     res = ser.readline()
     guard_error(res, b'M301 OK')
     print(res)
+
+_AUTOTUNE_RE = re.compile('^M303 P:(?P<p>.+) I:(?P<i>.+) D:(?P<d>.+) OK\n')
+# Autotune the heater ('H') or peltier ('P') PID around a temperature. The
+# firmware applies the new constants and only responds once the tune is over,
+# which can take several minutes.
+def autotune_pid(selection: str, temperature: float, ser: serial.Serial) -> Tuple[float, float, float]:
+    print(f'Autotuning {selection} PID around {temperature}C')
+    ser.write(f'M303 S{selection} T{temperature}\n'.encode())
+    res = ser.readline()
+    guard_error(res, b'M303')
+    print(res)
+    match = re.match(_AUTOTUNE_RE, res.decode())
+    return float(match.group('p')), float(match.group('i')), float(match.group('d'))
+
+_SAMPLE_TIMING_RE = re.compile('^M105.T N:(?P<n>.+) P:(?P<p>.+) S:(?P<s>.+) J:(?P<j>.+) A:(?P<a>.+) OK\n')
+# Get the plate thermistor sampling statistics since the last call: number of
+# intervals, mean period, period stddev, peak jitter and longest acquisition,
+# all in ms.
+def get_plate_sample_timing(ser: serial.Serial) -> Tuple[int, float, float, float, float]:
+    ser.write(b'M105.T\n')
+    res = ser.readline()
+    guard_error(res, b'M105.T')
+    match = re.match(_SAMPLE_TIMING_RE, res.decode())
+    return int(match.group('n')), float(match.group('p')), float(match.group('s')), float(match.group('j')), float(match.group('a'))
+
+_THERMISTOR_NOISE_RE = re.compile('^M105.N N:(?P<n>.+) HST:(?P<hs>.+) FRT:(?P<fr>.+) FLT:(?P<fl>.+) FCT:(?P<fc>.+) BRT:(?P<br>.+) BLT:(?P<bl>.+) BCT:(?P<bc>.+) OK\n')
+# Get the noise of each plate thermistor over its recent readings: the number
+# of readings, then the standard deviation in C of the heat sink, front right,
+# front left, front center, back right, back left and back center.
+def get_plate_thermistor_noise(ser: serial.Serial) -> Tuple[int, float, float, float, float, float, float, float]:
+    ser.write(b'M105.N\n')
+    res = ser.readline()
+    guard_error(res, b'M105.N')
+    match = re.match(_THERMISTOR_NOISE_RE, res.decode())
+    return (int(match.group('n')), float(match.group('hs')),
+            float(match.group('fr')), float(match.group('fl')),
+            float(match.group('fc')), float(match.group('br')),
+            float(match.group('bl')), float(match.group('bc')))
+
+# Set how the plate thermistors are sampled: the ADC data rate in samples per
+# second (8, 16, 32, 64, 128, 250, 475 or 860), the conversions averaged per
+# reading, and the filter (0 none, 1 median, 2 IIR with factor alpha).
+def set_plate_acquisition(ser: serial.Serial, sps: int, oversample: int, filter: int = 0, alpha: float = 0.5):
+    ser.write(f'M105.A R{sps} O{oversample} F{filter} A{alpha}\n'.encode())
+    res = ser.readline()
+    guard_error(res, b'M105.A')
+
+_THERMISTOR_STATS_RE = re.compile('^M105.S T:(?P<t>.+) N:(?P<n>.+) MIN:(?P<min>.+) MAX:(?P<max>.+) AVG:(?P<mean>.+) VAR:(?P<variance>.+) INV:(?P<invalid>.+) TOT:(?P<total>.+) TINV:(?P<total_invalid>.+) DR:(?P<drift>.+) OK\n')
+# Get the health statistics of one thermistor (0 front right, 1 front left,
+# 2 front center, 3 back right, 4 back left, 5 back center, 6 heat sink, 7 lid):
+# the readings in the window and their min, max, mean and variance, the invalid
+# conversions in the window and since boot, and the drift since boot. A window
+# covers only that many of the most recent readings, up to the 64 kept.
+def get_thermistor_stats(ser: serial.Serial, thermistor: int,
+                         window: Optional[int] = None) -> Dict[str, float]:
+    window_arg = f' W{window}' if window else ''
+    ser.write(f'M105.S {thermistor}{window_arg}\n'.encode())
+    res = ser.readline()
+    guard_error(res, b'M105.S')
+    match = re.match(_THERMISTOR_STATS_RE, res.decode())
+    counts = ('n', 'invalid', 'total', 'total_invalid')
+    return {key: (int(value) if key in counts else float(value))
+            for key, value in match.groupdict().items() if key != 't'}
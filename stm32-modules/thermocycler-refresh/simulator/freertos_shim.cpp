@@ -0,0 +1,204 @@
+/*
+ * Host implementation of the FreeRTOS stand-in in simulator/hal_shim.
+ */
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "task.h"
+
+struct sim_task {
+    std::mutex mutex{};
+    std::condition_variable notified{};
+    uint32_t notifications = 0;
+};
+
+namespace {
+
+struct Semaphore {
+    std::mutex mutex{};
+    std::condition_variable given{};
+    UBaseType_t count = 1;
+};
+
+using Clock = std::chrono::steady_clock;
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+thread_local sim_task this_task;
+
+auto critical_section() -> std::recursive_mutex & {
+    static std::recursive_mutex mutex;
+    return mutex;
+}
+
+auto start_time() -> Clock::time_point {
+    static const auto start = Clock::now();
+    return start;
+}
+
+auto semaphore(SemaphoreHandle_t handle) -> Semaphore * {
+    return static_cast<Semaphore *>(handle->impl);
+}
+
+/** Wait on a condition for a number of ticks, or forever.*/
+template <typename Predicate>
+auto wait_ticks(std::condition_variable &condition,
+                std::unique_lock<std::mutex> &lock, TickType_t ticks,
+                Predicate predicate) -> bool {
+    if (ticks == portMAX_DELAY) {
+        condition.wait(lock, predicate);
+        return true;
+    }
+    return condition.wait_for(lock, std::chrono::milliseconds(ticks),
+                              predicate);
+}
+
+}  // namespace
+
+void sim_freertos_assert_failed(const char *file, int line) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+    static_cast<void>(std::fprintf(stderr, "configASSERT failed at %s:%d\n",
+                                   file, line));
+    std::abort();
+}
+
+void sim_task_yield(void) { std::this_thread::yield(); }
+
+void sim_task_enter_critical(void) { critical_section().lock(); }
+
+void sim_task_exit_critical(void) { critical_section().unlock(); }
+
+UBaseType_t sim_task_enter_critical_from_isr(void) {
+    critical_section().lock();
+    return 0;
+}
+
+void sim_task_exit_critical_from_isr(UBaseType_t saved) {
+    static_cast<void>(saved);
+    critical_section().unlock();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) { return &this_task; }
+
+TickType_t xTaskGetTickCount(void) {
+    return static_cast<TickType_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() -
+                                                              start_time())
+            .count());
+}
+
+void vTaskDelay(TickType_t ticks) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+void vTaskDelayUntil(TickType_t *previous_wake_time, TickType_t increment) {
+    *previous_wake_time += increment;
+    std::this_thread::sleep_until(
+        start_time() + std::chrono::milliseconds(*previous_wake_time));
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_count_on_exit,
+                          TickType_t ticks_to_wait) {
+    uint32_t count = 0;
+    {
+        std::unique_lock lock(this_task.mutex);
+        static_cast<void>(
+            wait_ticks(this_task.notified, lock, ticks_to_wait,
+                       [] { return this_task.notifications > 0; }));
+        count = this_task.notifications;
+        if (count > 0) {
+            this_task.notifications =
+                (clear_count_on_exit == pdFALSE) ? count - 1 : 0;
+        }
+    }
+    // On the board, a task woken from an interrupt only runs once the
+    // interrupt returns. Interrupts here run holding the critical section,
+    // so wait for it.
+    critical_section().lock();
+    critical_section().unlock();
+    return count;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task,
+                            BaseType_t *higher_priority_task_woken) {
+    {
+        std::lock_guard lock(task->mutex);
+        ++task->notifications;
+    }
+    task->notified.notify_all();
+    if (higher_priority_task_woken != nullptr) {
+        *higher_priority_task_woken = pdTRUE;
+    }
+}
+
+// There's no pending state apart from the count, which only the value clear
+// changes
+BaseType_t xTaskNotifyStateClear(TaskHandle_t task) {
+    static_cast<void>(task);
+    return pdFALSE;
+}
+
+uint32_t ulTaskNotifyValueClear(TaskHandle_t task, uint32_t bits_to_clear) {
+    auto *handle = (task == nullptr) ? &this_task : task;
+    std::lock_guard lock(handle->mutex);
+    const auto previous = handle->notifications;
+    handle->notifications &= ~bits_to_clear;
+    return previous;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t *buffer) {
+    buffer->impl = new Semaphore();
+    return buffer;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+    delete ::semaphore(semaphore);
+    semaphore->impl = nullptr;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t handle, TickType_t ticks_to_wait) {
+    auto *sem = semaphore(handle);
+    std::unique_lock lock(sem->mutex);
+    if (!wait_ticks(sem->given, lock, ticks_to_wait,
+                    [sem] { return sem->count > 0; })) {
+        return pdFALSE;
+    }
+    --sem->count;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t handle) {
+    auto *sem = semaphore(handle);
+    {
+        std::lock_guard lock(sem->mutex);
+        if (sem->count > 0) {
+            return pdFALSE;
+        }
+        ++sem->count;
+    }
+    sem->given.notify_one();
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreTakeFromISR(SemaphoreHandle_t handle,
+                                 BaseType_t *higher_priority_task_woken) {
+    static_cast<void>(higher_priority_task_woken);
+    return xSemaphoreTake(handle, 0);
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t handle,
+                                 BaseType_t *higher_priority_task_woken) {
+    static_cast<void>(higher_priority_task_woken);
+    return xSemaphoreGive(handle);
+}
+
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t handle) {
+    auto *sem = semaphore(handle);
+    std::lock_guard lock(sem->mutex);
+    return sem->count;
+}
@@ -0,0 +1,137 @@
+/*
+ * Host implementation of the HAL stand-in in simulator/hal_shim. Setup
+ * calls succeed without doing anything; I2C transfers, EXTI flags and the
+ * timestamp timer go to the emulated thermal bus.
+ */
+#include "firmware/thermal_fan_hardware.h"
+#include "firmware/thermal_heater_hardware.h"
+#include "firmware/thermal_peltier_hardware.h"
+#include "simulator/thermal_bus_emulator.hpp"
+#include "stm32g4xx_hal.h"
+
+using thermal_bus_emulator::bus;
+
+namespace {
+// Only whole 16-bit registers behind 8-bit register addresses are modelled
+constexpr uint16_t register_address_size = 1;
+constexpr uint16_t register_size = 2;
+}  // namespace
+
+uint32_t sim_hal_timer_counter(TIM_HandleTypeDef *handle) {
+    static_cast<void>(handle);
+    return bus().now_us();
+}
+
+uint32_t sim_hal_exti_get_it(uint16_t pin) {
+    return bus().exti_pending(pin) ? pin : 0;
+}
+
+void sim_hal_exti_clear_it(uint16_t pin) { bus().exti_clear(pin); }
+
+void HAL_GPIO_Init(void *port, GPIO_InitTypeDef *init) {
+    static_cast<void>(port);
+    static_cast<void>(init);
+}
+
+void HAL_NVIC_SetPriority(IRQn_Type irq, uint32_t preempt, uint32_t sub) {
+    static_cast<void>(irq);
+    static_cast<void>(preempt);
+    static_cast<void>(sub);
+}
+
+void HAL_NVIC_EnableIRQ(IRQn_Type irq) { static_cast<void>(irq); }
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *handle) {
+    static_cast<void>(handle);
+    return HAL_OK;
+}
+
+// Emulated transfers always finish, so there's never one to abort
+
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef *handle) {
+    static_cast<void>(handle);
+    return HAL_OK;
+}
+
+void HAL_DMA_IRQHandler(DMA_HandleTypeDef *handle) {
+    static_cast<void>(handle);
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Init(TIM_HandleTypeDef *handle) {
+    static_cast<void>(handle);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Start(TIM_HandleTypeDef *handle) {
+    static_cast<void>(handle);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef *handle) {
+    static_cast<void>(handle);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_DeInit(I2C_HandleTypeDef *handle) {
+    static_cast<void>(handle);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2CEx_ConfigAnalogFilter(I2C_HandleTypeDef *handle,
+                                               uint32_t filter) {
+    static_cast<void>(handle);
+    static_cast<void>(filter);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2CEx_ConfigDigitalFilter(I2C_HandleTypeDef *handle,
+                                                uint32_t filter) {
+    static_cast<void>(handle);
+    static_cast<void>(filter);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write_DMA(I2C_HandleTypeDef *handle,
+                                        uint16_t dev_address,
+                                        uint16_t mem_address,
+                                        uint16_t mem_add_size, uint8_t *data,
+                                        uint16_t size) {
+    if ((mem_add_size != register_address_size) || (size != register_size)) {
+        return HAL_ERROR;
+    }
+    return bus().start_write(handle, dev_address,
+                             static_cast<uint8_t>(mem_address), data)
+               ? HAL_OK
+               : HAL_BUSY;
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read_DMA(I2C_HandleTypeDef *handle,
+                                       uint16_t dev_address,
+                                       uint16_t mem_address,
+                                       uint16_t mem_add_size, uint8_t *data,
+                                       uint16_t size) {
+    if ((mem_add_size != register_address_size) || (size != register_size)) {
+        return HAL_ERROR;
+    }
+    return bus().start_read(handle, dev_address,
+                            static_cast<uint8_t>(mem_address), data)
+               ? HAL_OK
+               : HAL_BUSY;
+}
+
+void HAL_I2C_EV_IRQHandler(I2C_HandleTypeDef *handle) {
+    static_cast<void>(handle);
+}
+
+void HAL_I2C_ER_IRQHandler(I2C_HandleTypeDef *handle) {
+    static_cast<void>(handle);
+}
+
+// thermal_hardware_setup() brings these up along with the I2C bus. They
+// aren't emulated, so there's nothing to do.
+
+void thermal_peltier_initialize(void) {}
+
+void thermal_fan_initialize(void) {}
+
+void thermal_heater_initialize(void) {}
@@ -2,6 +2,7 @@
 
 #include <chrono>
 #include <stop_token>
+#include <utility>
 
 #include "systemwide.h"
 #include "thermocycler-refresh/errors.hpp"
@@ -11,11 +12,16 @@ using namespace lid_heater_thread;
 
 class SimLidHeaterPolicy {
   private:
+    std::shared_ptr<thermal_model::Plant> _plant;
     double _power = 0.0F;
 
   public:
+    explicit SimLidHeaterPolicy(std::shared_ptr<thermal_model::Plant> plant)
+        : _plant(std::move(plant)) {}
+
     auto set_heater_power(double power) -> bool {
         _power = std::clamp(power, (double)0.0F, (double)1.0F);
+        _plant->set_lid_heater(_power);
         return true;
     }
 
@@ -29,9 +35,10 @@ struct lid_heater_thread::TaskControlBlock {
     SimLidHeaterTask task;
 };
 
-auto run(std::stop_token st, std::shared_ptr<TaskControlBlock> tcb) -> void {
+auto run(std::stop_token st, std::shared_ptr<TaskControlBlock> tcb,
+         std::shared_ptr<thermal_model::Plant> plant) -> void {
     using namespace std::literals::chrono_literals;
-    auto policy = SimLidHeaterPolicy();
+    auto policy = SimLidHeaterPolicy(std::move(plant));
     tcb->queue.set_stop_token(st);
     while (!st.stop_requested()) {
         try {
@@ -42,8 +49,20 @@ auto run(std::stop_token st, std::shared_ptr<TaskControlBlock> tcb) -> void {
     }
 }
 
-auto lid_heater_thread::build()
+auto lid_heater_thread::build(std::shared_ptr<thermal_model::Plant> plant)
+    -> tasks::Task<std::unique_ptr<std::jthread>, SimLidHeaterTask> {
+    auto tcb = std::make_shared<TaskControlBlock>();
+    return tasks::Task(std::make_unique<std::jthread>(run, tcb, plant),
+                       &tcb->task);
+}
+
+auto lid_heater_thread::build(std::shared_ptr<thermal_model::Plant> plant,
+                              scheduler::Scheduler& scheduler)
     -> tasks::Task<std::unique_ptr<std::jthread>, SimLidHeaterTask> {
     auto tcb = std::make_shared<TaskControlBlock>();
-    return tasks::Task(std::make_unique<std::jthread>(run, tcb), &tcb->task);
+    auto policy = std::make_shared<SimLidHeaterPolicy>(std::move(plant));
+    tcb->queue.set_cooperative();
+    scheduler.add_task([tcb]() { return tcb->queue.has_message(); },
+                       [tcb, policy]() { tcb->task.run_once(*policy); });
+    return tasks::Task(std::unique_ptr<std::jthread>(), &tcb->task);
 }
@@ -1,25 +1,36 @@
 #include <iostream>
 #include <memory>
+#include <stop_token>
+#include <thread>
+#include <vector>
 
 #include "simulator/cli_parser.hpp"
 #include "simulator/comm_thread.hpp"
 #include "simulator/lid_heater_thread.hpp"
+#include "simulator/plant_thread.hpp"
+#include "simulator/scheduler.hpp"
+#include "simulator/sim_clock.hpp"
 #include "simulator/sim_driver.hpp"
 #include "simulator/simulator_queue.hpp"
 #include "simulator/system_thread.hpp"
+#include "simulator/thermal_model.hpp"
 #include "simulator/thermal_plate_thread.hpp"
 #include "thermocycler-refresh/tasks.hpp"
 
 using namespace std;
 
-int main(int argc, char *argv[]) {
-    auto sim_driver = cli_parser::get_sim_driver(argc, argv);
+// Each task on a thread of its own
+auto run_threaded(cli_parser::SimOptions& options) -> void {
+    auto sim_driver = options.drivers.front();
+    auto plant = std::make_shared<thermal_model::Plant>();
     auto system = system_thread::build();
-    auto thermal_plate = thermal_plate_thread::build();
-    auto lid_heater = lid_heater_thread::build();
+    auto thermal_plate = thermal_plate_thread::build(plant);
+    auto lid_heater = lid_heater_thread::build(plant);
     auto comms = comm_thread::build(std::move(sim_driver));
     auto tasks = tasks::Tasks<SimulatorMessageQueue>(
         comms.task, system.task, thermal_plate.task, lid_heater.task);
+    auto plant_handle =
+        plant_thread::build(plant, thermal_plate.task, lid_heater.task);
 
     comm_thread::handle_input(std::move(sim_driver), tasks);
 
@@ -27,11 +38,67 @@ int main(int argc, char *argv[]) {
     comms.handle->request_stop();
     thermal_plate.handle->request_stop();
     lid_heater.handle->request_stop();
+    plant_handle->request_stop();
 
     system.handle->join();
     comms.handle->join();
     thermal_plate.handle->join();
     lid_heater.handle->join();
+    plant_handle->join();
+}
+
+// Every module's tasks on a pool of scheduler threads, each module's all on
+// the same one
+auto run_cooperative(cli_parser::SimOptions& options) -> void {
+    const auto modules = options.drivers.size();
+    auto schedulers = std::vector<std::unique_ptr<scheduler::Scheduler>>();
+    for (uint32_t worker = 0; worker < options.workers; ++worker) {
+        schedulers.push_back(
+            std::make_unique<scheduler::Scheduler>(options.seed + worker));
+    }
+    // The tasks keep pointers to these, so they mustn't move
+    auto module_tasks =
+        std::vector<tasks::Tasks<SimulatorMessageQueue>>(modules);
+    for (size_t module = 0; module < modules; ++module) {
+        auto& scheduler = *schedulers.at(module % schedulers.size());
+        auto plant = std::make_shared<thermal_model::Plant>();
+        auto system = system_thread::build(scheduler);
+        auto thermal_plate = thermal_plate_thread::build(plant, scheduler);
+        auto lid_heater = lid_heater_thread::build(plant, scheduler);
+        auto sim_driver = options.drivers.at(module);
+        auto comms = comm_thread::build(std::move(sim_driver), scheduler);
+        module_tasks.at(module).initialize(comms.task, system.task,
+                                           thermal_plate.task, lid_heater.task);
+        plant_thread::build(plant, thermal_plate.task, lid_heater.task,
+                            scheduler);
+    }
+    auto workers = std::vector<std::jthread>();
+    for (auto& scheduler : schedulers) {
+        workers.emplace_back([&scheduler = *scheduler](std::stop_token st) {
+            scheduler.run(st);
+        });
+    }
 
+    // Run until every module's input is finished
+    auto inputs = std::vector<std::jthread>();
+    for (size_t module = 0; module < modules; ++module) {
+        inputs.emplace_back([driver = options.drivers.at(module),
+                             &tasks = module_tasks.at(module)]() mutable {
+            comm_thread::handle_input(std::move(driver), tasks);
+        });
+    }
+    inputs.clear();
+    // Stops and joins them
+    workers.clear();
+}
+
+int main(int argc, char *argv[]) {
+    auto options = cli_parser::get_sim_options(argc, argv);
+    sim_clock::clock().set_speed(options.speed);
+    if (options.cooperative) {
+        run_cooperative(options);
+    } else {
+        run_threaded(options);
+    }
     return 0;
 }
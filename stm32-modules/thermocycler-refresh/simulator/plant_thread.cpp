@@ -0,0 +1,80 @@
+#include "simulator/plant_thread.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <stop_token>
+
+#include "simulator/sim_clock.hpp"
+
+using namespace plant_thread;
+using namespace thermal_plate_thread;
+using namespace lid_heater_thread;
+
+static constexpr auto STEP_TICKS = SimThermalPlateTask::CONTROL_PERIOD_TICKS;
+static constexpr auto LID_STEPS =
+    SimLidHeaterTask::CONTROL_PERIOD_TICKS / STEP_TICKS;
+
+// One plant step and the readings it makes
+class Stepper {
+  public:
+    Stepper(std::shared_ptr<thermal_model::Plant> plant,
+            SimThermalPlateTask* thermal_plate, SimLidHeaterTask* lid_heater)
+        : plant(std::move(plant)),
+          thermal_plate(thermal_plate),
+          lid_heater(lid_heater) {}
+
+    auto operator()() -> void {
+        plant->step(PERIOD_S);
+        static_cast<void>(thermal_plate->get_message_queue().try_send(
+            messages::ThermalPlateMessage(plant->plate_reading())));
+        if (++steps % LID_STEPS == 0) {
+            static_cast<void>(lid_heater->get_message_queue().try_send(
+                messages::LidHeaterMessage(plant->lid_reading())));
+        }
+    }
+
+  private:
+    static constexpr double PERIOD_S =
+        static_cast<double>(STEP_TICKS) / 1000.0;
+    std::shared_ptr<thermal_model::Plant> plant;
+    SimThermalPlateTask* thermal_plate;
+    SimLidHeaterTask* lid_heater;
+    uint32_t steps = 0;
+};
+
+auto run(std::stop_token st, std::shared_ptr<thermal_model::Plant> plant,
+         SimThermalPlateTask* thermal_plate, SimLidHeaterTask* lid_heater)
+    -> void {
+    auto& clock = sim_clock::clock();
+    const auto period = std::chrono::milliseconds(STEP_TICKS);
+    auto step = Stepper(std::move(plant), thermal_plate, lid_heater);
+    auto next = clock.now();
+    while (true) {
+        next += period;
+        clock.sleep_until(next, st);
+        if (st.stop_requested()) {
+            break;
+        }
+        step();
+    }
+    clock.remove_participant();
+}
+
+auto plant_thread::build(std::shared_ptr<thermal_model::Plant> plant,
+                         SimThermalPlateTask* thermal_plate,
+                         SimLidHeaterTask* lid_heater)
+    -> std::unique_ptr<std::jthread> {
+    sim_clock::clock().add_participant();
+    return std::make_unique<std::jthread>(run, plant, thermal_plate,
+                                          lid_heater);
+}
+
+auto plant_thread::build(std::shared_ptr<thermal_model::Plant> plant,
+                         SimThermalPlateTask* thermal_plate,
+                         SimLidHeaterTask* lid_heater,
+                         scheduler::Scheduler& scheduler) -> void {
+    scheduler.add_periodic(
+        std::chrono::milliseconds(STEP_TICKS),
+        Stepper(std::move(plant), thermal_plate, lid_heater));
+}
@@ -1,21 +1,26 @@
 #include "simulator/socket_sim_driver.hpp"
 
 #include <algorithm>
+#include <array>
 #include <boost/asio.hpp>
+#include <cstring>
+#include <deque>
+#include <iostream>
 #include <iterator>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <regex>
+#include <utility>
 
-#include "hal/double_buffer.hpp"
 #include "simulator/simulator_queue.hpp"
 
 using namespace socket_sim_driver;
 
 const std::string SOCKET_DRIVER_NAME = "Socket";
 
-std::unique_ptr<boost::asio::ip::tcp::socket> connect_to_socket(
-    std::string host, int port) {
-    boost::asio::io_service io_context;
+boost::asio::ip::tcp::socket connect_to_socket(
+    boost::asio::io_context& io_context, std::string host, int port) {
     boost::asio::ip::tcp::resolver resolver(io_context);
     std::string parsed_host;
     try {
@@ -27,11 +32,11 @@ std::unique_ptr<boost::asio::ip::tcp::socket> connect_to_socket(
         exit(1);
     }
 
-    auto socket = std::make_unique<boost::asio::ip::tcp::socket>(io_context);
+    auto socket = boost::asio::ip::tcp::socket(io_context);
     boost::asio::ip::tcp::endpoint endpoint(
         boost::asio::ip::address::from_string(parsed_host), port);
     boost::system::error_code ec;
-    socket->connect(endpoint, ec);
+    socket.connect(endpoint, ec);
     if (ec) {
         std::cerr << "Failed to create socket: " << ec.category().name() << ": "
                   << ec.value() << std::endl;
@@ -40,14 +45,185 @@ std::unique_ptr<boost::asio::ip::tcp::socket> connect_to_socket(
     return socket;
 }
 
-socket_sim_driver::SocketSimDriver::SocketSimDriver(std::string url) {
+/*
+ * One client's end of the driver. Everything here runs on the driver's
+ * io_context.
+ *
+ * The buffer holds, in order, lines handed to the comms task that it
+ * hasn't finished with yet, then lines waiting for room in its queue,
+ * then whatever part of a line has been read so far. Lines are only ever
+ * appended, and the buffer starts again from the beginning whenever none
+ * of it is in use; the only copy made is moving a part line back to the
+ * beginning when it reaches the end of the buffer.
+ */
+class socket_sim_driver::Connection
+    : public std::enable_shared_from_this<Connection> {
+  public:
+    // The comms task's own limit on a line from the host is about this
+    static constexpr size_t BUFFER_SIZE = 2048;
+
+    Connection(boost::asio::ip::tcp::socket socket, SocketSimDriver& driver)
+        : socket(std::move(socket)), driver(driver) {}
+
+    auto start() -> void { read(); }
+
+    /** The comms task has finished with the first lines it was handed.*/
+    auto release(uint64_t finished) -> void {
+        while (!in_use.empty() && in_use.front().first <= finished) {
+            in_use.pop_front();
+        }
+        dispatch();
+        read();
+        remove_if_done();
+    }
+
+    [[nodiscard]] auto is_open() const -> bool { return open; }
+
+    auto send(const std::shared_ptr<const std::string>& message) -> void {
+        if (!open) {
+            return;
+        }
+        writes.push_back(message);
+        if (writes.size() == 1) {
+            write_next();
+        }
+    }
+
+  private:
+    // Hand over as many complete lines as the comms queue has room for
+    auto dispatch() -> void {
+        auto* begin = buffer.data();
+        while (true) {
+            auto* end = begin + filled;
+            auto* newline = std::find(begin + scanned, end, '\n');
+            if (newline == end) {
+                scanned = filled;
+                return;
+            }
+            const auto line_end = static_cast<size_t>(newline + 1 - begin);
+            if (discarding) {
+                discarding = false;
+            } else {
+                auto sent = driver.send_line(messages::IncomingMessageFromHost(
+                    begin + unsent, newline + 1));
+                if (!sent) {
+                    // Try again once the comms task has caught up
+                    scanned = static_cast<size_t>(newline - begin);
+                    return;
+                }
+                in_use.emplace_back(*sent, line_end);
+            }
+            unsent = scanned = line_end;
+        }
+    }
+
+    auto read() -> void {
+        if (reading || !open) {
+            return;
+        }
+        // Where the next read goes is only decided here
+        if (in_use.empty() && (unsent == filled)) {
+            unsent = scanned = filled = 0;
+        }
+        if (filled == buffer.size()) {
+            if (!in_use.empty() || (scanned < filled)) {
+                // Wait for the comms task, and let the client wait for us
+                return;
+            }
+            if (unsent > 0) {
+                std::memmove(buffer.data(), buffer.data() + unsent,
+                             filled - unsent);
+                filled -= unsent;
+                scanned -= unsent;
+                unsent = 0;
+            } else {
+                std::cerr << "Discarding a line longer than " << BUFFER_SIZE
+                          << " bytes" << std::endl;
+                unsent = scanned = filled = 0;
+                discarding = true;
+            }
+        }
+        reading = true;
+        socket.async_read_some(
+            boost::asio::buffer(buffer.data() + filled,
+                                buffer.size() - filled),
+            [self = shared_from_this()](const boost::system::error_code& ec,
+                                        size_t length) {
+                self->reading = false;
+                if (ec) {
+                    self->close();
+                    return;
+                }
+                self->filled += length;
+                self->dispatch();
+                self->read();
+            });
+    }
+
+    auto write_next() -> void {
+        boost::asio::async_write(
+            socket, boost::asio::buffer(*writes.front()),
+            [self = shared_from_this()](const boost::system::error_code& ec,
+                                        size_t) {
+                self->writes.pop_front();
+                if (ec) {
+                    self->close();
+                } else if (!self->writes.empty()) {
+                    self->write_next();
+                }
+            });
+    }
+
+    auto close() -> void {
+        if (open) {
+            open = false;
+            boost::system::error_code ignored;
+            socket.close(ignored);
+            remove_if_done();
+        }
+    }
+
+    // Once closed, the buffer has to last until the comms task has been
+    // through every complete line in it
+    auto remove_if_done() -> void {
+        if (!open && in_use.empty() && (scanned == filled)) {
+            driver.remove(shared_from_this());
+        }
+    }
+
+    boost::asio::ip::tcp::socket socket;
+    SocketSimDriver& driver;
+    std::array<char, BUFFER_SIZE> buffer{};
+    // Where the lines not handed over yet start
+    size_t unsent = 0;
+    // How far has been searched for the end of a line
+    size_t scanned = 0;
+    size_t filled = 0;
+    // The lines still in use, by the count the driver gave them when they
+    // were sent and where they end
+    std::deque<std::pair<uint64_t, size_t>> in_use{};
+    std::deque<std::shared_ptr<const std::string>> writes{};
+    bool discarding = false;
+    bool reading = false;
+    bool open = true;
+};
+
+socket_sim_driver::SocketSimDriver::SocketSimDriver(std::string url,
+                                                    int port_offset)
+    : address_info() {
     std::regex url_regex(":\\/\\/([a-zA-Z0-9.]*):(\\d*)$");
     std::smatch url_match_result;
 
     if (std::regex_search(url, url_match_result, url_regex)) {
         address_info = socket_sim_driver::AddressInfo{
-            url_match_result[1], std::stoi(url_match_result[2])};
-        s = connect_to_socket(address_info.host, address_info.port);
+            url_match_result[1],
+            std::stoi(url_match_result[2]) + port_offset};
+        connections.push_back(std::make_shared<Connection>(
+            connect_to_socket(io_context, address_info.host,
+                              address_info.port),
+            *this));
+        // Keep going until the connection is closed and done with
+        work.emplace(io_context.get_executor());
 
     } else {
         std::cerr << "Malformed url." << std::endl;
@@ -55,6 +231,34 @@ socket_sim_driver::SocketSimDriver::SocketSimDriver(std::string url) {
     }
 }
 
+socket_sim_driver::SocketSimDriver::SocketSimDriver(Listen listen,
+                                                    int port_offset)
+    : address_info{"0.0.0.0", listen.port + port_offset} {
+    boost::system::error_code ec;
+    auto endpoint = boost::asio::ip::tcp::endpoint(
+        boost::asio::ip::tcp::v4(), address_info.port);
+    acceptor = std::make_unique<boost::asio::ip::tcp::acceptor>(io_context);
+    static_cast<void>(acceptor->open(endpoint.protocol(), ec));
+    if (!ec) {
+        static_cast<void>(acceptor->set_option(
+            boost::asio::ip::tcp::acceptor::reuse_address(true), ec));
+    }
+    if (!ec) {
+        static_cast<void>(acceptor->bind(endpoint, ec));
+    }
+    if (!ec) {
+        static_cast<void>(acceptor->listen(
+            boost::asio::socket_base::max_listen_connections, ec));
+    }
+    if (ec) {
+        std::cerr << "Failed to listen on port " << address_info.port << ": "
+                  << ec.message() << std::endl;
+        exit(1);
+    }
+    // Port 0 listens on any free port
+    address_info.port = acceptor->local_endpoint().port();
+}
+
 const std::string socket_sim_driver::SocketSimDriver::name = SOCKET_DRIVER_NAME;
 
 const std::string& socket_sim_driver::SocketSimDriver::get_host() const {
@@ -70,40 +274,97 @@ const std::string& socket_sim_driver::SocketSimDriver::get_name() const {
 }
 
 void socket_sim_driver::SocketSimDriver::write(const std::string& message) {
-    this->s->write_some(boost::asio::buffer(message));
-}
-
-int has_char(char* char_array, char value_to_find) {
-    char* position =
-        std::find(char_array, char_array + strlen(char_array), value_to_find);
-    return char_array + strlen(char_array) != position;
+    if (message.empty()) {
+        return;
+    }
+    boost::asio::post(io_context, [this, message = std::make_shared<
+                                              const std::string>(message)]() {
+        for (auto& connection : connections) {
+            connection->send(message);
+        }
+    });
 }
 
 void socket_sim_driver::SocketSimDriver::read(
     tasks::Tasks<SimulatorMessageQueue>& tasks) {
-    char pBuff[30];
-    boost::asio::mutable_buffer buff(pBuff, sizeof(pBuff));
-    auto write_buffer =
-        std::make_shared<double_buffer::DoubleBuffer<char, 2048>>();
-    size_t l = this->s->read_some(buff);
-    char* end_of_input = std::begin(*write_buffer->accessible());
-    char* end_of_buffer = std::end(*write_buffer->accessible());
-    for (; l > 0; l = this->s->read_some(buff)) {
-        if (end_of_input + l > end_of_buffer) {
-            end_of_input = std::begin(*write_buffer->accessible());
-        }
-        char* data = write_buffer->accessible()->data();
-        end_of_input =
-            std::copy(reinterpret_cast<char*>(buff.data()),
-                      reinterpret_cast<char*>(buff.data()) + l, end_of_input);
-        if (has_char(data, '\n')) {
-            auto message = messages::IncomingMessageFromHost(
-                std::begin(*write_buffer->accessible()), end_of_input);
-            static_cast<void>(
-                tasks.comms->get_message_queue().try_send(message));
-            write_buffer->swap();
-            end_of_input = std::begin(*write_buffer->accessible());
-            end_of_buffer = std::end(*write_buffer->accessible());
+    this->tasks = &tasks;
+    if (acceptor) {
+        accept();
+    }
+    for (auto& connection : connections) {
+        connection->start();
+    }
+    io_context.run();
+}
+
+void socket_sim_driver::SocketSimDriver::stop() { io_context.stop(); }
+
+void socket_sim_driver::SocketSimDriver::comms_finished() {
+    if (!tasks.load()) {
+        return;
+    }
+    // With the queue empty, every line sent so far has been through the
+    // comms task, which is done with them since this is its thread
+    auto lock = std::lock_guard(mutex);
+    if (comms_queue().has_message() || ((sent == finished) && !blocked)) {
+        return;
+    }
+    finished = sent;
+    blocked = false;
+    boost::asio::post(io_context, [this, up_to = finished]() {
+        release(up_to);
+    });
+}
+
+auto socket_sim_driver::SocketSimDriver::send_line(
+    const messages::IncomingMessageFromHost& line) -> std::optional<uint64_t> {
+    auto lock = std::lock_guard(mutex);
+    if (!comms_queue().try_send(line)) {
+        blocked = true;
+        return std::nullopt;
+    }
+    return ++sent;
+}
+
+auto socket_sim_driver::SocketSimDriver::accept() -> void {
+    acceptor->async_accept([this](const boost::system::error_code& ec,
+                                  boost::asio::ip::tcp::socket socket) {
+        if (ec) {
+            // Fall through to accept the next client
+        } else if (std::any_of(connections.begin(), connections.end(),
+                               [](const auto& connection) {
+                                   return connection->is_open();
+                               })) {
+            std::cerr << "Refusing a second client on port "
+                      << address_info.port << std::endl;
+            boost::system::error_code ignored;
+            socket.close(ignored);
+        } else {
+            auto connection =
+                std::make_shared<Connection>(std::move(socket), *this);
+            connections.push_back(connection);
+            connection->start();
         }
+        accept();
+    });
+}
+
+auto socket_sim_driver::SocketSimDriver::release(uint64_t up_to) -> void {
+    // Releasing can take a connection off the list
+    auto current = connections;
+    for (auto& connection : current) {
+        connection->release(up_to);
     }
 }
+
+auto socket_sim_driver::SocketSimDriver::remove(
+    const std::shared_ptr<Connection>& connection) -> void {
+    connections.remove(connection);
+    if (connections.empty()) {
+        work.reset();
+    }
+}
+
+auto socket_sim_driver::SocketSimDriver::comms_queue() -> Queue& {
+    return tasks.load()->comms->get_message_queue();
+}
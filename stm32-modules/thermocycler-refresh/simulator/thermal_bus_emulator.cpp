@@ -0,0 +1,284 @@
+#include "simulator/thermal_bus_emulator.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include "task.h"
+
+using namespace thermal_bus_emulator;
+
+namespace {
+/** The EXTI lines each ADC's ALERT/RDY is wired to on the board.*/
+constexpr std::array<uint16_t, ADC_ITR_NUM> ready_pins = {GPIO_PIN_9,
+                                                          GPIO_PIN_10};
+constexpr std::array<uint32_t, 8> data_rates_sps = {8,   16,  32,  64,
+                                                    128, 250, 475, 860};
+constexpr uint32_t us_per_s = 1000000;
+constexpr uint16_t byte_shift = 8;
+constexpr uint16_t byte_mask = 0xFF;
+}  // namespace
+
+ADS1115::ADS1115(uint16_t address, ADC_ITR_T ready_line)
+    : _address(address), _ready_line(ready_line) {}
+
+auto ADS1115::set_input(uint16_t pin, uint16_t counts) -> void {
+    _inputs.at(pin) = counts;
+}
+
+auto ADS1115::set_input_noise(uint16_t pin, uint16_t amplitude) -> void {
+    _noise.at(pin) = amplitude;
+    _noise_high.at(pin) = false;
+}
+
+auto ADS1115::write_register(uint8_t reg, uint16_t value) -> uint32_t {
+    switch (reg) {
+        case config_reg:
+            _config = static_cast<uint16_t>(value & ~config_os);
+            // A start while a conversion is running is ignored
+            if (((value & config_os) != 0) &&
+                ((value & config_mode_single_shot) != 0) && !_converting) {
+                _converting = true;
+                return conversion_time_us(_config);
+            }
+            return 0;
+        case lo_thresh_reg:
+            _lo_thresh = value;
+            return 0;
+        case hi_thresh_reg:
+            _hi_thresh = value;
+            return 0;
+        default:
+            // The conversion register is read only
+            return 0;
+    }
+}
+
+auto ADS1115::read_register(uint8_t reg) const -> uint16_t {
+    switch (reg) {
+        case conversion_reg:
+            return _conversion;
+        case config_reg:
+            // OS reads back as 1 while the ADC is idle
+            return _converting ? _config
+                               : static_cast<uint16_t>(_config | config_os);
+        case lo_thresh_reg:
+            return _lo_thresh;
+        case hi_thresh_reg:
+            return _hi_thresh;
+        default:
+            return 0;
+    }
+}
+
+auto ADS1115::finish_conversion() -> bool {
+    _converting = false;
+    ++_conversions;
+    const uint16_t mux = (_config >> config_mux_shift) & config_mux_mask;
+    if (mux >= config_mux_single_ended) {
+        const size_t pin = mux - config_mux_single_ended;
+        int32_t value = _inputs.at(pin);
+        if (_noise.at(pin) != 0) {
+            value += _noise_high.at(pin) ? _noise.at(pin) : -_noise.at(pin);
+            _noise_high.at(pin) = !_noise_high.at(pin);
+        }
+        _conversion = static_cast<uint16_t>(
+            std::clamp(value, 0, static_cast<int32_t>(UINT16_MAX)));
+    } else {
+        _conversion = 0;
+    }
+    // ALERT/RDY only works as a ready pin with the threshold MSBs set
+    // this way and the comparator enabled
+    return _ready_connected && ((_hi_thresh & thresh_msb) != 0) &&
+           ((_lo_thresh & thresh_msb) == 0) &&
+           ((_config & config_comp_que_mask) != config_comp_que_mask);
+}
+
+auto ADS1115::conversion_time_us(uint16_t config) -> uint32_t {
+    const auto rate =
+        data_rates_sps.at((config >> config_dr_shift) & config_dr_mask);
+    return (us_per_s + rate - 1) / rate;
+}
+
+Bus::Bus() : _thread([this](std::stop_token stop) { run(stop); }) {}
+
+// Joining the thread has to happen before anything else goes away, which
+// it does as the last member
+Bus::~Bus() = default;
+
+auto Bus::ads1115(uint16_t address, ADC_ITR_T ready_line) -> ADS1115 & {
+    std::lock_guard lock(_mutex);
+    auto *device = find(address);
+    if (device != nullptr) {
+        return *device;
+    }
+    return _devices.emplace_back(address, ready_line);
+}
+
+auto Bus::now_us() -> uint32_t {
+    std::lock_guard lock(_mutex);
+    return static_cast<uint32_t>(_now_us);
+}
+
+auto Bus::transfers() -> uint32_t {
+    std::lock_guard lock(_mutex);
+    return _transfers;
+}
+
+auto Bus::wait_idle() -> void {
+    std::unique_lock lock(_mutex);
+    _changed.wait(lock, [this] { return _events.empty() && !_running_event; });
+}
+
+auto Bus::reset() -> void {
+    std::unique_lock lock(_mutex);
+    _changed.wait(lock, [this] { return _events.empty() && !_running_event; });
+    for (auto &device : _devices) {
+        device = ADS1115(device.address(), device.ready_line());
+    }
+    _exti_pending = 0;
+}
+
+auto Bus::start_write(I2C_HandleTypeDef *handle, uint16_t address,
+                      uint8_t reg, const uint8_t *data) -> bool {
+    std::lock_guard lock(_mutex);
+    if (_busy) {
+        return false;
+    }
+    _busy = true;
+    ++_transfers;
+    auto *device = find(address);
+    if ((device == nullptr) || !device->acknowledges()) {
+        schedule(nack_bits * bit_time_us, [this, handle] {
+            {
+                std::lock_guard lock(_mutex);
+                _busy = false;
+            }
+            HAL_I2C_ErrorCallback(handle);
+        });
+        return true;
+    }
+    // Registers go over the wire MSB first
+    const auto value = static_cast<uint16_t>((data[0] << byte_shift) | data[1]);
+    schedule(write_bits * bit_time_us, [this, handle, device, reg, value] {
+        {
+            std::lock_guard lock(_mutex);
+            _busy = false;
+            const auto conversion_us = device->write_register(reg, value);
+            if (conversion_us != 0) {
+                schedule(conversion_us, [this, device] {
+                    bool ready = false;
+                    {
+                        std::lock_guard lock(_mutex);
+                        ready = device->finish_conversion();
+                        if (ready) {
+                            _exti_pending |=
+                                ready_pins.at(device->ready_line());
+                        }
+                    }
+                    if (ready) {
+                        thermal_adc_ready_callback(device->ready_line());
+                    }
+                });
+            }
+        }
+        HAL_I2C_MemTxCpltCallback(handle);
+    });
+    return true;
+}
+
+auto Bus::start_read(I2C_HandleTypeDef *handle, uint16_t address, uint8_t reg,
+                     uint8_t *data) -> bool {
+    std::lock_guard lock(_mutex);
+    if (_busy) {
+        return false;
+    }
+    _busy = true;
+    ++_transfers;
+    auto *device = find(address);
+    if ((device == nullptr) || !device->acknowledges()) {
+        schedule(nack_bits * bit_time_us, [this, handle] {
+            {
+                std::lock_guard lock(_mutex);
+                _busy = false;
+            }
+            HAL_I2C_ErrorCallback(handle);
+        });
+        return true;
+    }
+    schedule(read_bits * bit_time_us, [this, handle, device, reg, data] {
+        {
+            std::lock_guard lock(_mutex);
+            _busy = false;
+            const auto value = device->read_register(reg);
+            data[0] = static_cast<uint8_t>(value >> byte_shift);
+            data[1] = static_cast<uint8_t>(value & byte_mask);
+        }
+        HAL_I2C_MemRxCpltCallback(handle);
+    });
+    return true;
+}
+
+auto Bus::exti_pending(uint16_t pin) -> bool {
+    std::lock_guard lock(_mutex);
+    return (_exti_pending & pin) != 0;
+}
+
+auto Bus::exti_clear(uint16_t pin) -> void {
+    std::lock_guard lock(_mutex);
+    _exti_pending = static_cast<uint16_t>(_exti_pending & ~pin);
+}
+
+auto Bus::schedule(uint64_t delay_us, std::function<void()> action) -> void {
+    _events.push(Event{.at_us = _now_us + delay_us,
+                       .sequence = _sequence++,
+                       .action = std::move(action)});
+    _changed.notify_all();
+}
+
+auto Bus::find(uint16_t address) -> ADS1115 * {
+    auto found = std::find_if(
+        _devices.begin(), _devices.end(),
+        [address](const auto &device) { return device.address() == address; });
+    return (found == _devices.end()) ? nullptr : &*found;
+}
+
+auto Bus::run(std::stop_token stop) -> void {
+    while (!stop.stop_requested()) {
+        {
+            std::unique_lock lock(_mutex);
+            if (!_changed.wait(lock, stop,
+                               [this] { return !_events.empty(); })) {
+                return;
+            }
+        }
+        // Like an interrupt, an event can't run while a task has interrupts
+        // masked. Take the critical section before the bus lock, the same
+        // order a task holding the critical section takes them in.
+        auto saved = sim_task_enter_critical_from_isr();
+        std::function<void()> action;
+        {
+            std::lock_guard lock(_mutex);
+            if (!_events.empty()) {
+                const auto &event = _events.top();
+                _now_us = std::max(_now_us, event.at_us);
+                action = event.action;
+                _events.pop();
+                _running_event = true;
+            }
+        }
+        if (action) {
+            action();
+        }
+        sim_task_exit_critical_from_isr(saved);
+        {
+            std::lock_guard lock(_mutex);
+            _running_event = false;
+        }
+        _changed.notify_all();
+    }
+}
+
+auto thermal_bus_emulator::bus() -> Bus & {
+    static Bus instance;
+    return instance;
+}
@@ -0,0 +1,150 @@
+#include "simulator/thermal_model.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace thermal_model;
+
+namespace {
+constexpr double KELVIN_OFFSET = 273.15;
+constexpr double US_PER_S = 1000000.0;
+}  // namespace
+
+PlantModel::PlantModel(double ambient_c)
+    : _ambient_c(ambient_c),
+      _zone_c{ambient_c, ambient_c, ambient_c},
+      _well_c{ambient_c, ambient_c, ambient_c},
+      _heatsink_c(ambient_c),
+      _lid_c(ambient_c) {}
+
+auto PlantModel::set_peltier(size_t zone, double power) -> void {
+    _peltier_power.at(zone) = std::clamp(power, -1.0, 1.0);
+}
+
+auto PlantModel::set_fan(double power) -> void {
+    _fan_power = std::clamp(power, 0.0, 1.0);
+}
+
+auto PlantModel::set_lid_heater(double power) -> void {
+    _lid_power = std::clamp(power, 0.0, 1.0);
+}
+
+auto PlantModel::step(double seconds) -> void {
+    while (seconds > 0) {
+        auto dt = std::min(seconds, MAX_STEP_S);
+        euler(dt);
+        seconds -= dt;
+    }
+}
+
+auto PlantModel::euler(double seconds) -> void {
+    std::array<double, ZONES> zone_w = {};
+    std::array<double, ZONES> well_w = {};
+    double heatsink_w =
+        -(HEATSINK_LOSS_W_PER_K + HEATSINK_FAN_LOSS_W_PER_K * _fan_power) *
+        (_heatsink_c - _ambient_c);
+    const double lid_w = LID_HEATER_MAX_W * _lid_power -
+                         LID_LOSS_W_PER_K * (_lid_c - _ambient_c);
+    double lid_out_w = 0;
+
+    for (size_t zone = 0; zone < ZONES; ++zone) {
+        const auto power = _peltier_power.at(zone);
+        const auto current = std::abs(power) * PELTIER_MAX_CURRENT_A;
+        // Heating pumps heat from the heatsink into the block
+        const double sign = (power < 0) ? -1.0 : 1.0;
+        const auto block_k = _zone_c.at(zone) + KELVIN_OFFSET;
+        const auto heatsink_k = _heatsink_c + KELVIN_OFFSET;
+        const auto joule = 0.5 * current * current * PELTIER_RESISTANCE_OHM;
+        const auto conduction =
+            PELTIER_CONDUCTANCE_W_PER_K * (_zone_c.at(zone) - _heatsink_c);
+        zone_w.at(zone) +=
+            sign * PELTIER_SEEBECK_V_PER_K * current * block_k + joule -
+            conduction;
+        heatsink_w += -sign * PELTIER_SEEBECK_V_PER_K * current * heatsink_k +
+                      joule + conduction;
+
+        zone_w.at(zone) -=
+            ZONE_LOSS_W_PER_K * (_zone_c.at(zone) - _ambient_c);
+        if (zone + 1 < ZONES) {
+            const auto coupling = ZONE_COUPLING_W_PER_K *
+                                  (_zone_c.at(zone) - _zone_c.at(zone + 1));
+            zone_w.at(zone) -= coupling;
+            zone_w.at(zone + 1) += coupling;
+        }
+
+        const auto to_well =
+            WELL_COUPLING_W_PER_K * (_zone_c.at(zone) - _well_c.at(zone));
+        const auto from_lid =
+            LID_TO_WELL_W_PER_K * (_lid_c - _well_c.at(zone));
+        zone_w.at(zone) -= to_well;
+        well_w.at(zone) += to_well + from_lid;
+        lid_out_w += from_lid;
+    }
+
+    for (size_t zone = 0; zone < ZONES; ++zone) {
+        _zone_c.at(zone) += zone_w.at(zone) * seconds / ZONE_CAPACITY_J_PER_K;
+        _well_c.at(zone) += well_w.at(zone) * seconds / WELL_CAPACITY_J_PER_K;
+    }
+    _heatsink_c += heatsink_w * seconds / HEATSINK_CAPACITY_J_PER_K;
+    _lid_c += (lid_w - lid_out_w) * seconds / LID_CAPACITY_J_PER_K;
+    _elapsed_s += seconds;
+}
+
+Plant::Plant(double ambient_c)
+    : _mutex(),
+      _model(ambient_c),
+      _converter(THERMISTOR_CIRCUIT_BIAS_RESISTANCE_KOHM, ADC_BIT_MAX, false) {}
+
+auto Plant::set_peltier(PeltierID peltier, double power,
+                        PeltierDirection direction) -> void {
+    if (peltier >= PELTIER_NUMBER) {
+        return;
+    }
+    auto lock = std::lock_guard(_mutex);
+    _model.set_peltier(peltier,
+                       (direction == PELTIER_COOLING) ? -power : power);
+}
+
+auto Plant::set_fan(double power) -> void {
+    auto lock = std::lock_guard(_mutex);
+    _model.set_fan(power);
+}
+
+auto Plant::set_lid_heater(double power) -> void {
+    auto lock = std::lock_guard(_mutex);
+    _model.set_lid_heater(power);
+}
+
+auto Plant::step(double seconds) -> void {
+    auto lock = std::lock_guard(_mutex);
+    _model.step(seconds);
+}
+
+auto Plant::plate_reading() const -> messages::ThermalPlateTempReadComplete {
+    auto lock = std::lock_guard(_mutex);
+    auto zone = [this](PeltierID peltier) {
+        return _converter.backconvert(_model.zone_c(peltier));
+    };
+    return messages::ThermalPlateTempReadComplete{
+        .heat_sink = _converter.backconvert(_model.heatsink_c()),
+        .front_right = zone(PELTIER_RIGHT),
+        .front_center = zone(PELTIER_CENTER),
+        .front_left = zone(PELTIER_LEFT),
+        .back_right = zone(PELTIER_RIGHT),
+        .back_center = zone(PELTIER_CENTER),
+        .back_left = zone(PELTIER_LEFT),
+        .timestamp_us =
+            static_cast<uint32_t>(std::llround(_model.elapsed_s() * US_PER_S)),
+        .acquisition_us = 0};
+}
+
+auto Plant::lid_reading() const -> messages::LidTempReadComplete {
+    auto lock = std::lock_guard(_mutex);
+    return messages::LidTempReadComplete{
+        .lid_temp = _converter.backconvert(_model.lid_c())};
+}
+
+auto Plant::snapshot() const -> PlantModel {
+    auto lock = std::lock_guard(_mutex);
+    return _model;
+}
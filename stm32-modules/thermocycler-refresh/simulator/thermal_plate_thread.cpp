@@ -2,6 +2,7 @@
 
 #include <chrono>
 #include <stop_token>
+#include <utility>
 
 #include "systemwide.h"
 #include "thermocycler-refresh/errors.hpp"
@@ -23,6 +24,7 @@ struct SimPeltier {
 
 struct SimThermalPlatePolicy {
   private:
+    std::shared_ptr<thermal_model::Plant> _plant;
     bool _enabled = false;
     SimPeltier _left = SimPeltier();
     SimPeltier _center = SimPeltier();
@@ -44,12 +46,18 @@ struct SimThermalPlatePolicy {
     }
 
   public:
+    explicit SimThermalPlatePolicy(std::shared_ptr<thermal_model::Plant> plant)
+        : _plant(std::move(plant)) {}
+
     auto set_enabled(bool enabled) -> void {
         _enabled = enabled;
         if (!enabled) {
             _left.reset();
             _center.reset();
             _right.reset();
+            for (auto peltier : {PELTIER_RIGHT, PELTIER_CENTER, PELTIER_LEFT}) {
+                _plant->set_peltier(peltier, 0.0F, PELTIER_HEATING);
+            }
         }
     }
 
@@ -64,6 +72,7 @@ struct SimThermalPlatePolicy {
         }
         handle.value().get().direction = direction;
         handle.value().get().power = power;
+        _plant->set_peltier(peltier, power, direction);
 
         return true;
     }
@@ -79,6 +88,17 @@ struct SimThermalPlatePolicy {
     auto set_fan(double power) -> bool {
         power = std::clamp(power, (double)0.0F, (double)1.0F);
         _fan_power = power;
+        _plant->set_fan(power);
+        return true;
+    }
+
+    // The simulated thermistors are read without any noise to filter
+    auto set_acquisition(uint16_t data_rate_sps, uint8_t oversample,
+                         AdcFilter::Mode filter, double filter_alpha) -> bool {
+        static_cast<void>(data_rate_sps);
+        static_cast<void>(oversample);
+        static_cast<void>(filter);
+        static_cast<void>(filter_alpha);
         return true;
     }
 };
@@ -91,9 +111,10 @@ struct thermal_plate_thread::TaskControlBlock {
     SimThermalPlateTask task;
 };
 
-auto run(std::stop_token st, std::shared_ptr<TaskControlBlock> tcb) -> void {
+auto run(std::stop_token st, std::shared_ptr<TaskControlBlock> tcb,
+         std::shared_ptr<thermal_model::Plant> plant) -> void {
     using namespace std::literals::chrono_literals;
-    auto policy = SimThermalPlatePolicy();
+    auto policy = SimThermalPlatePolicy(std::move(plant));
     tcb->queue.set_stop_token(st);
     while (!st.stop_requested()) {
         try {
@@ -104,8 +125,20 @@ auto run(std::stop_token st, std::shared_ptr<TaskControlBlock> tcb) -> void {
     }
 }
 
-auto thermal_plate_thread::build()
+auto thermal_plate_thread::build(std::shared_ptr<thermal_model::Plant> plant)
+    -> tasks::Task<std::unique_ptr<std::jthread>, SimThermalPlateTask> {
+    auto tcb = std::make_shared<TaskControlBlock>();
+    return tasks::Task(std::make_unique<std::jthread>(run, tcb, plant),
+                       &tcb->task);
+}
+
+auto thermal_plate_thread::build(std::shared_ptr<thermal_model::Plant> plant,
+                                 scheduler::Scheduler& scheduler)
     -> tasks::Task<std::unique_ptr<std::jthread>, SimThermalPlateTask> {
     auto tcb = std::make_shared<TaskControlBlock>();
-    return tasks::Task(std::make_unique<std::jthread>(run, tcb), &tcb->task);
+    auto policy = std::make_shared<SimThermalPlatePolicy>(std::move(plant));
+    tcb->queue.set_cooperative();
+    scheduler.add_task([tcb]() { return tcb->queue.has_message(); },
+                       [tcb, policy]() { tcb->task.run_once(*policy); });
+    return tasks::Task(std::unique_ptr<std::jthread>(), &tcb->task);
 }
@@ -55,6 +55,8 @@ const char* const THERMISTOR_LID_DISCONNECTED =
     "ERR222:Lid thermistor disconnected\n";
 const char* const THERMISTOR_LID_SHORT = "ERR223:Lid thermistor shorted\n";
 const char* const THERMISTOR_LID_OVERTEMP = "ERR224:Lid thermistor overtemp\n";
+const char* const THERMISTOR_PLATE_PAIR_MISMATCH =
+    "ERR225:Front and back plate thermistors disagree\n";
 const char* const SYSTEM_SERIAL_NUMBER_INVALID =
     "ERR301:system:serial number invalid format\n";
 const char* const SYSTEM_SERIAL_NUMBER_HAL_ERROR =
@@ -69,6 +71,18 @@ const char* const THERMAL_HEATER_ERROR =
     "ERR405:thermal:Error controlling lid heater";
 const char* const THERMAL_CONSTANT_OUT_OF_RANGE =
     "ERR406:thermal:PID constant(s) out of range";
+const char* const THERMAL_AUTOTUNE_FAILED =
+    "ERR407:thermal:PID autotune did not converge\n";
+const char* const THERMAL_PLATE_RUNAWAY =
+    "ERR408:thermal:Plate temperature rising without peltier power\n";
+const char* const THERMAL_PLATE_NO_RESPONSE =
+    "ERR409:thermal:Plate temperature not following peltiers\n";
+const char* const THERMAL_LID_RUNAWAY =
+    "ERR410:thermal:Lid temperature rising without heater power\n";
+const char* const THERMAL_LID_NO_RESPONSE =
+    "ERR411:thermal:Lid temperature not following heater\n";
+const char* const THERMAL_PLATE_ACQUISITION_INVALID =
+    "ERR412:thermal:Plate acquisition does not fit a control period\n";
 
 const char* const UNKNOWN_ERROR = "ERR-1:unknown error code\n";
 
@@ -109,6 +123,7 @@ auto errors::errorstring(ErrorCode code) -> const char* {
         HANDLE_CASE(THERMISTOR_LID_DISCONNECTED);
         HANDLE_CASE(THERMISTOR_LID_SHORT);
         HANDLE_CASE(THERMISTOR_LID_OVERTEMP);
+        HANDLE_CASE(THERMISTOR_PLATE_PAIR_MISMATCH);
         HANDLE_CASE(SYSTEM_SERIAL_NUMBER_INVALID);
         HANDLE_CASE(SYSTEM_SERIAL_NUMBER_HAL_ERROR);
         HANDLE_CASE(THERMAL_PLATE_BUSY);
@@ -117,6 +132,12 @@ auto errors::errorstring(ErrorCode code) -> const char* {
         HANDLE_CASE(THERMAL_LID_BUSY);
         HANDLE_CASE(THERMAL_HEATER_ERROR);
         HANDLE_CASE(THERMAL_CONSTANT_OUT_OF_RANGE);
+        HANDLE_CASE(THERMAL_AUTOTUNE_FAILED);
+        HANDLE_CASE(THERMAL_PLATE_RUNAWAY);
+        HANDLE_CASE(THERMAL_PLATE_NO_RESPONSE);
+        HANDLE_CASE(THERMAL_LID_RUNAWAY);
+        HANDLE_CASE(THERMAL_LID_NO_RESPONSE);
+        HANDLE_CASE(THERMAL_PLATE_ACQUISITION_INVALID);
     }
     return UNKNOWN_ERROR;
 }
@@ -0,0 +1,202 @@
+/*
+ * Runs the real ADS1115 driver and thermal_hardware.c against the emulated
+ * thermal I2C bus.
+ *
+ * Driver and emulator state lives for the whole process, just like on the
+ * board, so every test case starts with reset_adcs() to get powered-on,
+ * uninitialized ADCs no matter what ran before it.
+ */
+#include <array>
+#include <cstdint>
+#include <variant>
+
+#include "catch2/catch.hpp"
+#include "firmware/ads1115.hpp"
+#include "firmware/thermal_hardware.h"
+#include "simulator/thermal_bus_emulator.hpp"
+
+namespace {
+constexpr uint8_t front_address = (0x48 << 1);
+constexpr uint8_t rear_address = (0x49 << 1);
+
+auto front_emulator() -> thermal_bus_emulator::ADS1115 & {
+    return thermal_bus_emulator::bus().ads1115(front_address, ADC1_ITR);
+}
+
+auto rear_emulator() -> thermal_bus_emulator::ADS1115 & {
+    return thermal_bus_emulator::bus().ads1115(rear_address, ADC2_ITR);
+}
+
+auto reset_adcs() -> void {
+    thermal_bus_emulator::bus().reset();
+    ADS1115::ADC::reset_all();
+}
+
+auto setup_adc(ADS1115::ADC &adc) -> void {
+    thermal_hardware_setup();
+    adc.initialize();
+    REQUIRE(adc.initialized());
+}
+}  // namespace
+
+SCENARIO("ads1115 driver before initialization") {
+    reset_adcs();
+    static_cast<void>(rear_emulator());
+    thermal_hardware_setup();
+    GIVEN("an adc that has not been initialized") {
+        auto adc = ADS1115::ADC(rear_address, ADC2_ITR);
+        THEN("reads are refused") {
+            auto result = adc.read(0);
+            REQUIRE(std::holds_alternative<ADS1115::Error>(result));
+            REQUIRE(std::get<ADS1115::Error>(result) ==
+                    ADS1115::Error::ADCInit);
+        }
+    }
+}
+
+SCENARIO("ads1115 driver single reads") {
+    reset_adcs();
+    auto &emulator = rear_emulator();
+    auto adc = ADS1115::ADC(rear_address, ADC2_ITR);
+    setup_adc(adc);
+    GIVEN("an input voltage on each pin") {
+        constexpr std::array<uint16_t, 4> inputs{1000, 8000, 16000, 24000};
+        for (uint16_t pin = 0; pin < inputs.size(); ++pin) {
+            emulator.set_input(pin, inputs.at(pin));
+        }
+        THEN("each pin reads its own input") {
+            for (uint16_t pin = 0; pin < inputs.size(); ++pin) {
+                auto result = adc.read(pin);
+                REQUIRE(std::holds_alternative<uint16_t>(result));
+                REQUIRE(std::get<uint16_t>(result) == inputs.at(pin));
+            }
+        }
+        THEN("a pin the adc doesn't have is refused") {
+            auto result = adc.read(4);
+            REQUIRE(std::holds_alternative<ADS1115::Error>(result));
+            REQUIRE(std::get<ADS1115::Error>(result) ==
+                    ADS1115::Error::ADCPin);
+        }
+    }
+    GIVEN("an adc that stops answering") {
+        emulator.set_connected(false);
+        THEN("reads time out") {
+            auto result = adc.read(0);
+            emulator.set_connected(true);
+            REQUIRE(std::holds_alternative<ADS1115::Error>(result));
+            REQUIRE(std::get<ADS1115::Error>(result) ==
+                    ADS1115::Error::ADCTimeout);
+        }
+    }
+    GIVEN("an adc whose ready line is cut") {
+        emulator.set_ready_connected(false);
+        THEN("reads time out") {
+            auto result = adc.read(0);
+            thermal_bus_emulator::bus().wait_idle();
+            emulator.set_ready_connected(true);
+            REQUIRE(std::holds_alternative<ADS1115::Error>(result));
+            REQUIRE(std::get<ADS1115::Error>(result) ==
+                    ADS1115::Error::ADCTimeout);
+            AND_THEN("the adc works again once it is reconnected") {
+                emulator.set_input(1, 4321);
+                auto retry = adc.read(1);
+                REQUIRE(std::holds_alternative<uint16_t>(retry));
+                REQUIRE(std::get<uint16_t>(retry) == 4321);
+            }
+        }
+    }
+}
+
+SCENARIO("ads1115 driver scans") {
+    reset_adcs();
+    auto &front = front_emulator();
+    auto &rear = rear_emulator();
+    std::array<ADS1115::ADC, 2> adcs{ADS1115::ADC(front_address, ADC1_ITR),
+                                     ADS1115::ADC(rear_address, ADC2_ITR)};
+    for (auto &adc : adcs) {
+        setup_adc(adc);
+        adc.set_data_rate(ADS1115::DataRate::SPS_860);
+    }
+    for (uint16_t pin = 0; pin < 4; ++pin) {
+        front.set_input(pin, 1000 + pin);
+        rear.set_input(pin, 2000 + pin);
+    }
+    const std::array<ADS1115::ScanEntry, 4> entries{
+        {{.adc = &adcs[0], .pin = 0},
+         {.adc = &adcs[1], .pin = 0},
+         {.adc = &adcs[0], .pin = 2},
+         {.adc = &adcs[1], .pin = 3}}};
+    GIVEN("a scan across both adcs") {
+        const auto start_us = thermal_hardware_timestamp_us();
+        REQUIRE(ADS1115::ADC::scan(entries));
+        const auto elapsed_us = thermal_hardware_timestamp_us() - start_us;
+        THEN("every entry has its result") {
+            for (const auto &entry : entries) {
+                auto sample = entry.adc->last_sample(entry.pin);
+                REQUIRE(std::holds_alternative<ADS1115::Sample>(sample));
+                const auto expected = (entry.adc == &adcs[0])
+                                          ? 1000 + entry.pin
+                                          : 2000 + entry.pin;
+                REQUIRE(std::get<ADS1115::Sample>(sample).value == expected);
+            }
+        }
+        THEN("the two adcs convert at the same time") {
+            // Back to back, every entry would take its conversion plus the
+            // write that starts it and the read that fetches it
+            constexpr uint32_t serial_us =
+                entries.size() *
+                (ADS1115::conversion_time_us(ADS1115::DataRate::SPS_860) +
+                 thermal_bus_emulator::Bus::write_bits +
+                 thermal_bus_emulator::Bus::read_bits);
+            REQUIRE(elapsed_us < serial_us * 3 / 4);
+            const auto first =
+                std::get<ADS1115::Sample>(adcs[0].last_sample(0));
+            const auto second =
+                std::get<ADS1115::Sample>(adcs[1].last_sample(0));
+            REQUIRE(second.timestamp_us - first.timestamp_us <
+                    ADS1115::conversion_time_us(ADS1115::DataRate::SPS_860));
+        }
+    }
+    GIVEN("noisy inputs") {
+        front.set_input_noise(0, 50);
+        rear.set_input_noise(0, 50);
+        const auto conversions_before = front.conversions();
+        WHEN("scanning with oversampling") {
+            REQUIRE(ADS1115::ADC::scan(entries, 4));
+            THEN("the noise averages out") {
+                REQUIRE(std::get<ADS1115::Sample>(adcs[0].last_sample(0))
+                            .value == 1000);
+                REQUIRE(std::get<ADS1115::Sample>(adcs[1].last_sample(0))
+                            .value == 2000);
+            }
+            THEN("each entry took four conversions") {
+                REQUIRE(front.conversions() - conversions_before == 8);
+            }
+        }
+        WHEN("scanning without oversampling") {
+            REQUIRE(ADS1115::ADC::scan(entries));
+            THEN("the noise comes through") {
+                REQUIRE(std::get<ADS1115::Sample>(adcs[0].last_sample(0))
+                            .value == 950);
+            }
+        }
+        front.set_input_noise(0, 0);
+        rear.set_input_noise(0, 0);
+    }
+    GIVEN("a slow data rate") {
+        adcs[0].set_data_rate(ADS1115::DataRate::SPS_8);
+        const auto start_us = thermal_hardware_timestamp_us();
+        auto result = adcs[0].read(1);
+        const auto elapsed_us = thermal_hardware_timestamp_us() - start_us;
+        adcs[0].set_data_rate(ADS1115::DataRate::SPS_860);
+        THEN("the conversion takes as long as it would on the board") {
+            REQUIRE(std::get<uint16_t>(result) == 1001);
+            REQUIRE(elapsed_us >=
+                    ADS1115::conversion_time_us(ADS1115::DataRate::SPS_8));
+            REQUIRE(elapsed_us <=
+                    ADS1115::conversion_time_us(ADS1115::DataRate::SPS_8) +
+                        thermal_bus_emulator::Bus::write_bits +
+                        thermal_bus_emulator::Bus::read_bits);
+        }
+    }
+}
@@ -417,6 +417,7 @@ SCENARIO("message passing for ack-only gcodes from usb input") {
                 constexpr double test_hold = 40.0F;
                 REQUIRE(set_plate_temp_message.setpoint == test_temp);
                 REQUIRE(set_plate_temp_message.hold_time == test_hold);
+                REQUIRE(set_plate_temp_message.volume == 0.0F);
                 REQUIRE(written_firstpass == tx_buf.begin());
                 REQUIRE(tasks->get_host_comms_queue().backing_deque.empty());
                 AND_WHEN("sending a good response back to the comms task") {
@@ -475,6 +476,23 @@ SCENARIO("message passing for ack-only gcodes from usb input") {
                 }
             }
         }
+        WHEN("sending a SetPlateTemperature message with a sample volume") {
+            std::string message_text = std::string("M104 S95.0 V25\n");
+            auto message_obj =
+                messages::HostCommsMessage(messages::IncomingMessageFromHost(
+                    &*message_text.begin(), &*message_text.end()));
+            tasks->get_host_comms_queue().backing_deque.push_back(message_obj);
+            tasks->get_host_comms_task().run_once(tx_buf.begin(), tx_buf.end());
+            THEN("the volume should be passed on to the thermal plate task") {
+                REQUIRE(
+                    !tasks->get_thermal_plate_queue().backing_deque.empty());
+                auto set_plate_temp_message =
+                    std::get<messages::SetPlateTemperatureMessage>(
+                        tasks->get_thermal_plate_queue().backing_deque.front());
+                REQUIRE(set_plate_temp_message.setpoint == 95.0F);
+                REQUIRE(set_plate_temp_message.volume == 25.0F);
+            }
+        }
         WHEN("sending a DeactivatePlate message") {
             std::string message_text = std::string("M14\n");
             auto message_obj =
@@ -552,6 +570,198 @@ SCENARIO("message passing for ack-only gcodes from usb input") {
                 }
             }
         }
+        WHEN("sending a StartAutotune message for the heater") {
+            std::string message_text = std::string("M303 SH T90\n");
+            auto message_obj =
+                messages::HostCommsMessage(messages::IncomingMessageFromHost(
+                    &*message_text.begin(), &*message_text.end()));
+            tasks->get_host_comms_queue().backing_deque.push_back(message_obj);
+            auto written_firstpass = tasks->get_host_comms_task().run_once(
+                tx_buf.begin(), tx_buf.end());
+            THEN(
+                "the task should pass the message on to the lid heater task "
+                "and not immediately ack") {
+                REQUIRE(tasks->get_lid_heater_queue().backing_deque.size() !=
+                        0);
+                auto tune_message = std::get<messages::StartAutotuneMessage>(
+                    tasks->get_lid_heater_queue().backing_deque.front());
+                tasks->get_lid_heater_queue().backing_deque.pop_front();
+                REQUIRE(tune_message.selection == PidSelection::HEATER);
+                REQUIRE(tune_message.setpoint == 90.0);
+                REQUIRE(written_firstpass == tx_buf.begin());
+                REQUIRE(tasks->get_host_comms_queue().backing_deque.empty());
+                AND_WHEN("sending the tune result back to the comms task") {
+                    auto response = messages::HostCommsMessage(
+                        messages::AutotuneResultResponse{
+                            .responding_to_id = tune_message.id,
+                            .kp = 1.0,
+                            .ki = 0.5,
+                            .kd = 0.25});
+                    tasks->get_host_comms_queue().backing_deque.push_back(
+                        response);
+                    auto written_secondpass =
+                        tasks->get_host_comms_task().run_once(tx_buf.begin(),
+                                                              tx_buf.end());
+                    THEN("the task should print the new gains") {
+                        REQUIRE_THAT(tx_buf,
+                                     Catch::Matchers::StartsWith(
+                                         "M303 P:1.0000 I:0.5000 D:0.2500 "
+                                         "OK\n"));
+                        REQUIRE(written_secondpass != tx_buf.begin());
+                    }
+                }
+                AND_WHEN("sending a failed tune result to the comms task") {
+                    auto response = messages::HostCommsMessage(
+                        messages::AutotuneResultResponse{
+                            .responding_to_id = tune_message.id,
+                            .kp = 0,
+                            .ki = 0,
+                            .kd = 0,
+                            .with_error =
+                                errors::ErrorCode::THERMAL_AUTOTUNE_FAILED});
+                    tasks->get_host_comms_queue().backing_deque.push_back(
+                        response);
+                    auto written_secondpass =
+                        tasks->get_host_comms_task().run_once(tx_buf.begin(),
+                                                              tx_buf.end());
+                    THEN("the task should print the error") {
+                        REQUIRE_THAT(tx_buf,
+                                     Catch::Matchers::StartsWith("ERR407"));
+                        REQUIRE(written_secondpass != tx_buf.begin());
+                    }
+                }
+            }
+        }
+        WHEN("sending a StartAutotune message for the peltiers") {
+            std::string message_text = std::string("M303 SP T60\n");
+            auto message_obj =
+                messages::HostCommsMessage(messages::IncomingMessageFromHost(
+                    &*message_text.begin(), &*message_text.end()));
+            tasks->get_host_comms_queue().backing_deque.push_back(message_obj);
+            auto written_firstpass = tasks->get_host_comms_task().run_once(
+                tx_buf.begin(), tx_buf.end());
+            THEN("the task should pass the message on to the plate task") {
+                REQUIRE(written_firstpass == tx_buf.begin());
+                REQUIRE(tasks->get_thermal_plate_queue().backing_deque.size() !=
+                        0);
+                auto tune_message = std::get<messages::StartAutotuneMessage>(
+                    tasks->get_thermal_plate_queue().backing_deque.front());
+                REQUIRE(tune_message.selection == PidSelection::PELTIERS);
+                REQUIRE(tune_message.setpoint == 60.0);
+            }
+        }
+        WHEN("sending a SetPlateControlMode message") {
+            std::string message_text = std::string("M104.U S1\n");
+            auto message_obj =
+                messages::HostCommsMessage(messages::IncomingMessageFromHost(
+                    &*message_text.begin(), &*message_text.end()));
+            tasks->get_host_comms_queue().backing_deque.push_back(message_obj);
+            auto written_firstpass = tasks->get_host_comms_task().run_once(
+                tx_buf.begin(), tx_buf.end());
+            THEN(
+                "the task should pass the message on to the thermal plate task "
+                "and not immediately ack") {
+                REQUIRE(tasks->get_thermal_plate_queue().backing_deque.size() !=
+                        0);
+                auto plate_message =
+                    tasks->get_thermal_plate_queue().backing_deque.front();
+                auto mode_message =
+                    std::get<messages::SetPlateControlModeMessage>(
+                        plate_message);
+                tasks->get_thermal_plate_queue().backing_deque.pop_front();
+                REQUIRE(mode_message.mode == PLATE_CONTROL_UNIFORMITY);
+                REQUIRE(written_firstpass == tx_buf.begin());
+                REQUIRE(tasks->get_host_comms_queue().backing_deque.empty());
+                AND_WHEN("sending a good response back to the comms task") {
+                    auto response = messages::HostCommsMessage(
+                        messages::AcknowledgePrevious{
+                            .responding_to_id = mode_message.id});
+                    tasks->get_host_comms_queue().backing_deque.push_back(
+                        response);
+                    auto written_secondpass =
+                        tasks->get_host_comms_task().run_once(tx_buf.begin(),
+                                                              tx_buf.end());
+                    THEN("the task should ack the previous message") {
+                        REQUIRE_THAT(
+                            tx_buf, Catch::Matchers::StartsWith("M104.U OK\n"));
+                        REQUIRE(written_secondpass != tx_buf.begin());
+                        REQUIRE(tasks->get_host_comms_queue()
+                                    .backing_deque.empty());
+                    }
+                }
+            }
+        }
+        WHEN("sending a SetPlateAcquisition message") {
+            std::string message_text = std::string("M105.A R475 O2 F2 A0.25\n");
+            auto message_obj =
+                messages::HostCommsMessage(messages::IncomingMessageFromHost(
+                    &*message_text.begin(), &*message_text.end()));
+            tasks->get_host_comms_queue().backing_deque.push_back(message_obj);
+            auto written_firstpass = tasks->get_host_comms_task().run_once(
+                tx_buf.begin(), tx_buf.end());
+            THEN(
+                "the task should pass the message on to the thermal plate task "
+                "and not immediately ack") {
+                REQUIRE(tasks->get_thermal_plate_queue().backing_deque.size() !=
+                        0);
+                auto acquisition_message =
+                    std::get<messages::SetPlateAcquisitionMessage>(
+                        tasks->get_thermal_plate_queue().backing_deque.front());
+                tasks->get_thermal_plate_queue().backing_deque.pop_front();
+                REQUIRE(acquisition_message.data_rate_sps == 475);
+                REQUIRE(acquisition_message.oversample == 2);
+                REQUIRE(acquisition_message.filter == AdcFilter::Mode::IIR);
+                REQUIRE(acquisition_message.filter_alpha == 0.25);
+                REQUIRE(written_firstpass == tx_buf.begin());
+                AND_WHEN("sending an error response back to the comms task") {
+                    auto response = messages::HostCommsMessage(
+                        messages::AcknowledgePrevious{
+                            .responding_to_id = acquisition_message.id,
+                            .with_error = errors::ErrorCode::
+                                THERMAL_PLATE_ACQUISITION_INVALID});
+                    tasks->get_host_comms_queue().backing_deque.push_back(
+                        response);
+                    tasks->get_host_comms_task().run_once(tx_buf.begin(),
+                                                          tx_buf.end());
+                    THEN("the task should pass on the error") {
+                        REQUIRE_THAT(tx_buf,
+                                     Catch::Matchers::StartsWith("ERR412"));
+                    }
+                }
+            }
+        }
+        WHEN("sending a SetPowerSupply message") {
+            std::string message_text = std::string("M998 S200\n");
+            auto message_obj =
+                messages::HostCommsMessage(messages::IncomingMessageFromHost(
+                    &*message_text.begin(), &*message_text.end()));
+            tasks->get_host_comms_queue().backing_deque.push_back(message_obj);
+            auto written_firstpass = tasks->get_host_comms_task().run_once(
+                tx_buf.begin(), tx_buf.end());
+            THEN(
+                "the task should pass the message on to the thermal plate task "
+                "and not immediately ack") {
+                REQUIRE(tasks->get_thermal_plate_queue().backing_deque.size() !=
+                        0);
+                auto supply_message = std::get<messages::SetPowerSupplyMessage>(
+                    tasks->get_thermal_plate_queue().backing_deque.front());
+                tasks->get_thermal_plate_queue().backing_deque.pop_front();
+                REQUIRE(supply_message.watts == 200.0);
+                REQUIRE(written_firstpass == tx_buf.begin());
+                AND_WHEN("sending a good response back to the comms task") {
+                    tasks->get_host_comms_queue().backing_deque.push_back(
+                        messages::HostCommsMessage(
+                            messages::AcknowledgePrevious{
+                                .responding_to_id = supply_message.id}));
+                    tasks->get_host_comms_task().run_once(tx_buf.begin(),
+                                                          tx_buf.end());
+                    THEN("the task should ack the previous message") {
+                        REQUIRE_THAT(tx_buf,
+                                     Catch::Matchers::StartsWith("M998 OK\n"));
+                    }
+                }
+            }
+        }
         WHEN("sending a SetPIDConstants message for the heaters") {
             std::string message_text = std::string("M301 SH P1 I1 D1\n");
             auto message_obj =
@@ -1145,6 +1355,198 @@ SCENARIO("message passing for response-carrying gcodes from usb input") {
                 }
             }
         }
+        WHEN("sending a get-plate-sample-timing message") {
+            auto message_text = std::string("M105.T\n");
+            auto message_obj =
+                messages::HostCommsMessage(messages::IncomingMessageFromHost(
+                    &*message_text.begin(), &*message_text.end()));
+            tasks->get_host_comms_queue().backing_deque.push_back(message_obj);
+            auto written_firstpass = tasks->get_host_comms_task().run_once(
+                tx_buf.begin(), tx_buf.end());
+            THEN("the task should pass the message on to the plate task") {
+                REQUIRE(written_firstpass == tx_buf.begin());
+                auto& plate_queue =
+                    tasks->get_thermal_plate_queue().backing_deque;
+                REQUIRE(!plate_queue.empty());
+                REQUIRE(
+                    std::holds_alternative<
+                        messages::GetPlateSampleTimingMessage>(
+                        plate_queue.front()));
+                auto timing_message =
+                    std::get<messages::GetPlateSampleTimingMessage>(
+                        plate_queue.front());
+                plate_queue.pop_front();
+                AND_WHEN("sending a good response back to the comms task") {
+                    auto response = messages::HostCommsMessage(
+                        messages::GetPlateSampleTimingResponse{
+                            .responding_to_id = timing_message.id,
+                            .count = 20,
+                            .period_ms = 50.0,
+                            .stddev_ms = 0.1,
+                            .jitter_ms = 0.5,
+                            .acquisition_ms = 12.0});
+                    tasks->get_host_comms_queue().backing_deque.push_back(
+                        response);
+                    auto written_secondpass =
+                        tasks->get_host_comms_task().run_once(tx_buf.begin(),
+                                                              tx_buf.end());
+                    THEN("the task should write the timing") {
+                        REQUIRE_THAT(tx_buf,
+                                     Catch::Matchers::StartsWith(
+                                         "M105.T N:20 P:50.000 S:0.100 "
+                                         "J:0.500 A:12.000 OK\n"));
+                        REQUIRE(written_secondpass > tx_buf.begin());
+                    }
+                }
+                AND_WHEN(
+                    "sending a response with wrong id back to the comms task") {
+                    auto response = messages::HostCommsMessage(
+                        messages::GetPlateSampleTimingResponse{
+                            .responding_to_id = timing_message.id + 1,
+                            .count = 20,
+                            .period_ms = 50.0,
+                            .stddev_ms = 0.1,
+                            .jitter_ms = 0.5,
+                            .acquisition_ms = 12.0});
+                    tasks->get_host_comms_queue().backing_deque.push_back(
+                        response);
+                    tasks->get_host_comms_task().run_once(tx_buf.begin(),
+                                                          tx_buf.end());
+                    THEN("the task should print an error") {
+                        REQUIRE_THAT(tx_buf,
+                                     Catch::Matchers::StartsWith("ERR005"));
+                    }
+                }
+            }
+        }
+        WHEN("sending a get-plate-thermistor-noise message") {
+            auto message_text = std::string("M105.N\n");
+            auto message_obj =
+                messages::HostCommsMessage(messages::IncomingMessageFromHost(
+                    &*message_text.begin(), &*message_text.end()));
+            tasks->get_host_comms_queue().backing_deque.push_back(message_obj);
+            auto written_firstpass = tasks->get_host_comms_task().run_once(
+                tx_buf.begin(), tx_buf.end());
+            THEN("the task should pass the message on to the plate task") {
+                REQUIRE(written_firstpass == tx_buf.begin());
+                auto& plate_queue =
+                    tasks->get_thermal_plate_queue().backing_deque;
+                REQUIRE(!plate_queue.empty());
+                REQUIRE(
+                    std::holds_alternative<
+                        messages::GetPlateThermistorNoiseMessage>(
+                        plate_queue.front()));
+                auto noise_message =
+                    std::get<messages::GetPlateThermistorNoiseMessage>(
+                        plate_queue.front());
+                plate_queue.pop_front();
+                AND_WHEN("sending a good response back to the comms task") {
+                    auto response = messages::HostCommsMessage(
+                        messages::GetPlateThermistorNoiseResponse{
+                            .responding_to_id = noise_message.id,
+                            .count = 64,
+                            .heat_sink = 0.01,
+                            .front_right = 0.02,
+                            .front_left = 0.03,
+                            .front_center = 0.04,
+                            .back_right = 0.05,
+                            .back_left = 0.06,
+                            .back_center = 0.07});
+                    tasks->get_host_comms_queue().backing_deque.push_back(
+                        response);
+                    auto written_secondpass =
+                        tasks->get_host_comms_task().run_once(tx_buf.begin(),
+                                                              tx_buf.end());
+                    THEN("the task should write the noise") {
+                        REQUIRE_THAT(tx_buf,
+                                     Catch::Matchers::StartsWith(
+                                         "M105.N N:64 HST:0.0100 FRT:0.0200 "
+                                         "FLT:0.0300 FCT:0.0400 BRT:0.0500 "
+                                         "BLT:0.0600 BCT:0.0700 OK\n"));
+                        REQUIRE(written_secondpass > tx_buf.begin());
+                    }
+                }
+            }
+        }
+        WHEN("sending a get-thermistor-stats message for a plate thermistor") {
+            auto message_text = std::string("M105.S 3\n");
+            auto message_obj =
+                messages::HostCommsMessage(messages::IncomingMessageFromHost(
+                    &*message_text.begin(), &*message_text.end()));
+            tasks->get_host_comms_queue().backing_deque.push_back(message_obj);
+            auto written_firstpass = tasks->get_host_comms_task().run_once(
+                tx_buf.begin(), tx_buf.end());
+            THEN("the task should pass the message on to the plate task") {
+                REQUIRE(written_firstpass == tx_buf.begin());
+                REQUIRE(tasks->get_lid_heater_queue().backing_deque.empty());
+                auto& plate_queue =
+                    tasks->get_thermal_plate_queue().backing_deque;
+                REQUIRE(!plate_queue.empty());
+                REQUIRE(std::holds_alternative<
+                        messages::GetThermistorStatsMessage>(
+                    plate_queue.front()));
+                auto stats_message =
+                    std::get<messages::GetThermistorStatsMessage>(
+                        plate_queue.front());
+                plate_queue.pop_front();
+                REQUIRE(stats_message.thermistor == 3);
+                REQUIRE(stats_message.window ==
+                        gcode::GetThermistorStats::max_window);
+                AND_WHEN("sending a good response back to the comms task") {
+                    auto response = messages::HostCommsMessage(
+                        messages::GetThermistorStatsResponse{
+                            .responding_to_id = stats_message.id,
+                            .thermistor = 3,
+                            .count = 64,
+                            .min = 24.5,
+                            .max = 25.25,
+                            .mean = 25.0,
+                            .variance = 0.0125,
+                            .invalid = 2,
+                            .total = 1000,
+                            .total_invalid = 7,
+                            .drift = -0.25});
+                    tasks->get_host_comms_queue().backing_deque.push_back(
+                        response);
+                    auto written_secondpass =
+                        tasks->get_host_comms_task().run_once(tx_buf.begin(),
+                                                              tx_buf.end());
+                    THEN("the task should write the statistics") {
+                        REQUIRE_THAT(tx_buf,
+                                     Catch::Matchers::StartsWith(
+                                         "M105.S T:3 N:64 MIN:24.50 "
+                                         "MAX:25.25 AVG:25.000 VAR:0.01250 "
+                                         "INV:2 TOT:1000 TINV:7 DR:-0.250 "
+                                         "OK\n"));
+                        REQUIRE(written_secondpass > tx_buf.begin());
+                    }
+                }
+            }
+        }
+        WHEN("sending a get-thermistor-stats message for the lid thermistor") {
+            auto message_text = std::string("M105.S 7 W8\n");
+            auto message_obj =
+                messages::HostCommsMessage(messages::IncomingMessageFromHost(
+                    &*message_text.begin(), &*message_text.end()));
+            tasks->get_host_comms_queue().backing_deque.push_back(message_obj);
+            auto written_firstpass = tasks->get_host_comms_task().run_once(
+                tx_buf.begin(), tx_buf.end());
+            THEN("the task should pass the message on to the lid task") {
+                REQUIRE(written_firstpass == tx_buf.begin());
+                REQUIRE(
+                    tasks->get_thermal_plate_queue().backing_deque.empty());
+                auto& lid_queue = tasks->get_lid_heater_queue().backing_deque;
+                REQUIRE(!lid_queue.empty());
+                REQUIRE(std::holds_alternative<
+                        messages::GetThermistorStatsMessage>(
+                    lid_queue.front()));
+                auto stats_message =
+                    std::get<messages::GetThermistorStatsMessage>(
+                        lid_queue.front());
+                REQUIRE(stats_message.thermistor == 7);
+                REQUIRE(stats_message.window == 8);
+            }
+        }
         WHEN("sending a get-plate-temp-debug message") {
             auto message_text = std::string("M105.D\n");
             auto message_obj =
@@ -1,6 +1,11 @@
+#include <cmath>
+#include <numbers>
+
 #include "catch2/catch.hpp"
+#include "core/thermistor_conversion.hpp"
 #include "systemwide.h"
 #include "test/task_builder.hpp"
+#include "thermistor_lookups.hpp"
 #include "thermocycler-refresh/errors.hpp"
 #include "thermocycler-refresh/lid_heater_task.hpp"
 #include "thermocycler-refresh/messages.hpp"
@@ -71,6 +76,34 @@ SCENARIO("lid heater task message passing") {
                 }
             }
         }
+        WHEN("a disconnected reading follows and the stats are requested") {
+            tasks->get_lid_heater_queue().backing_deque.push_back(
+                messages::LidHeaterMessage(messages::LidTempReadComplete{
+                    .lid_temp = _disconnected_adc}));
+            tasks->run_lid_heater_task();
+            tasks->get_host_comms_queue().backing_deque.clear();
+            auto message =
+                messages::GetThermistorStatsMessage{.id = 123, .thermistor = 7};
+            tasks->get_lid_heater_queue().backing_deque.push_back(
+                messages::LidHeaterMessage(message));
+            tasks->run_lid_heater_task();
+            THEN("the task responds with the lid thermistor statistics") {
+                auto& comms = tasks->get_host_comms_queue().backing_deque;
+                REQUIRE(!comms.empty());
+                REQUIRE(std::holds_alternative<
+                        messages::GetThermistorStatsResponse>(comms.front()));
+                auto stats = std::get<messages::GetThermistorStatsResponse>(
+                    comms.front());
+                REQUIRE(stats.responding_to_id == message.id);
+                REQUIRE(stats.thermistor == 7);
+                REQUIRE(stats.count == 1);
+                REQUIRE_THAT(stats.mean,
+                             Catch::Matchers::WithinAbs(_valid_temp, 0.1));
+                REQUIRE(stats.invalid == 1);
+                REQUIRE(stats.total == 2);
+                REQUIRE(stats.total_invalid == 1);
+            }
+        }
         WHEN("Sending a SetHeaterDebug message to enable the heater") {
             auto message =
                 messages::SetHeaterDebugMessage{.id = 123, .power = 0.65};
@@ -282,6 +315,89 @@ SCENARIO("lid heater task message passing") {
             }
         }
     }
+    GIVEN("a lid heater task starting an autotune") {
+        auto tasks = TaskBuilder::build();
+        auto converter = thermistor_conversion::Conversion<lookups::KS103J2G>(
+            10.0, 0x5DC0, false);
+        auto& lid_queue = tasks->get_lid_heater_queue().backing_deque;
+        auto& comms_queue = tasks->get_host_comms_queue().backing_deque;
+        lid_queue.push_back(
+            messages::LidTempReadComplete{.lid_temp = _valid_adc});
+        tasks->run_lid_heater_task();
+        lid_queue.push_back(messages::StartAutotuneMessage{
+            .id = 125, .selection = PidSelection::HEATER, .setpoint = 60.0});
+        tasks->run_lid_heater_task();
+        THEN("the task holds its response until the tune is over") {
+            REQUIRE(lid_queue.empty());
+            REQUIRE(comms_queue.empty());
+        }
+        WHEN("sending a temperature below the tune setpoint") {
+            lid_queue.push_back(
+                messages::LidTempReadComplete{.lid_temp = _valid_adc});
+            tasks->run_lid_heater_task();
+            THEN("the heater is driven at full power") {
+                REQUIRE(tasks->get_lid_heater_policy().get_heater_power() ==
+                        1.0);
+            }
+        }
+        WHEN("sending a SetLidTemperature message") {
+            lid_queue.push_back(
+                messages::SetLidTemperatureMessage{.id = 126, .setpoint = 70});
+            tasks->run_lid_heater_task();
+            THEN("the task responds with a busy error") {
+                REQUIRE(!comms_queue.empty());
+                auto response = std::get<messages::AcknowledgePrevious>(
+                    comms_queue.front());
+                REQUIRE(response.responding_to_id == 126);
+                REQUIRE(response.with_error ==
+                        errors::ErrorCode::THERMAL_LID_BUSY);
+            }
+        }
+        WHEN("sending a DeactivateLidHeating message") {
+            lid_queue.push_back(
+                messages::DeactivateLidHeatingMessage{.id = 127});
+            tasks->run_lid_heater_task();
+            THEN("the tune is cancelled and both messages get responses") {
+                REQUIRE(comms_queue.size() == 2);
+                auto tune_response = std::get<messages::AutotuneResultResponse>(
+                    comms_queue.front());
+                REQUIRE(tune_response.responding_to_id == 125);
+                REQUIRE(tune_response.with_error ==
+                        errors::ErrorCode::THERMAL_AUTOTUNE_FAILED);
+                auto ack =
+                    std::get<messages::AcknowledgePrevious>(comms_queue.back());
+                REQUIRE(ack.responding_to_id == 127);
+                REQUIRE(ack.with_error == errors::ErrorCode::NO_ERROR);
+                REQUIRE(tasks->get_lid_heater_policy().get_heater_power() ==
+                        0.0F);
+            }
+        }
+        WHEN("the lid temperature oscillates around the tune setpoint") {
+            // A 20 second, 2C limit cycle sampled at the control period
+            constexpr double period_s = 20.0;
+            double time_s = 0;
+            while (comms_queue.empty() && time_s < 600) {
+                auto temp = 60.0 + 2.0 * std::sin(2.0 * std::numbers::pi *
+                                                   time_s / period_s);
+                lid_queue.push_back(messages::LidTempReadComplete{
+                    .lid_temp = converter.backconvert(temp)});
+                tasks->run_lid_heater_task();
+                time_s += 0.1;
+            }
+            THEN("the task applies and reports the new gains") {
+                REQUIRE(!comms_queue.empty());
+                auto response = std::get<messages::AutotuneResultResponse>(
+                    comms_queue.front());
+                REQUIRE(response.responding_to_id == 125);
+                REQUIRE(response.with_error == errors::ErrorCode::NO_ERROR);
+                REQUIRE(response.kp > 0);
+                REQUIRE(response.ki > 0);
+                REQUIRE(response.kd > 0);
+                REQUIRE(tasks->get_lid_heater_policy().get_heater_power() ==
+                        0.0F);
+            }
+        }
+    }
     GIVEN("a heater task with a shorted temp") {
         auto tasks = TaskBuilder::build();
         auto read_message =
@@ -441,3 +557,82 @@ SCENARIO("lid heater task message passing") {
         }
     }
 }
+
+SCENARIO("lid heater thermal fault detection") {
+    using LidTask = lid_heater_task::LidHeaterTask<TestMessageQueue>;
+    auto converter = thermistor_conversion::Conversion<lookups::KS103J2G>(
+        LidTask::THERMISTOR_CIRCUIT_BIAS_RESISTANCE_KOHM, LidTask::ADC_BIT_MAX,
+        false);
+    const int window_periods = static_cast<int>(
+        LidTask::FAULT_LIMITS.window_s / LidTask::CONTROL_PERIOD_SECONDS);
+    GIVEN("a lid heater controlling towards a setpoint") {
+        auto tasks = TaskBuilder::build();
+        auto& lid_queue = tasks->get_lid_heater_queue().backing_deque;
+        auto& comms_queue = tasks->get_host_comms_queue().backing_deque;
+        auto send_temp = [&](double temp) {
+            lid_queue.push_back(messages::LidTempReadComplete{
+                .lid_temp = converter.backconvert(temp)});
+            tasks->run_lid_heater_task();
+        };
+        send_temp(30.0);
+        lid_queue.push_back(
+            messages::SetLidTemperatureMessage{.id = 1, .setpoint = 90});
+        tasks->run_lid_heater_task();
+        comms_queue.clear();
+        WHEN("the lid warms up while it heats") {
+            double temp = 30.0;
+            for (int i = 0; i < 2 * window_periods; ++i) {
+                temp += 0.2 * LidTask::CONTROL_PERIOD_SECONDS;
+                send_temp(temp);
+            }
+            THEN("no fault is raised") {
+                REQUIRE(comms_queue.empty());
+                REQUIRE(tasks->get_lid_heater_policy().get_heater_power() > 0);
+            }
+        }
+        WHEN("the lid doesn't warm up at full power") {
+            // One period to start driving, then a full window without change
+            for (int i = 0; i < window_periods + 2; ++i) {
+                send_temp(30.0);
+            }
+            THEN("the heater is shut off and an error is sent") {
+                REQUIRE(tasks->get_lid_heater_policy().get_heater_power() ==
+                        0.0F);
+                REQUIRE(!comms_queue.empty());
+                auto error =
+                    std::get<messages::ErrorMessage>(comms_queue.front());
+                REQUIRE(error.code ==
+                        errors::ErrorCode::THERMAL_LID_NO_RESPONSE);
+                AND_WHEN("setting a new temperature") {
+                    comms_queue.clear();
+                    lid_queue.push_back(messages::SetLidTemperatureMessage{
+                        .id = 2, .setpoint = 60});
+                    tasks->run_lid_heater_task();
+                    THEN("the fault stays latched") {
+                        auto ack = std::get<messages::AcknowledgePrevious>(
+                            comms_queue.front());
+                        REQUIRE(ack.with_error ==
+                                errors::ErrorCode::THERMAL_LID_NO_RESPONSE);
+                    }
+                }
+            }
+        }
+        WHEN("the lid keeps heating once the heater is off") {
+            // Above the setpoint the loop turns the heater off
+            double temp = 92.0;
+            for (int i = 0; i < 2 * window_periods && comms_queue.empty();
+                 ++i) {
+                temp += 0.3 * LidTask::CONTROL_PERIOD_SECONDS;
+                send_temp(temp);
+            }
+            THEN("a runaway is flagged") {
+                REQUIRE(!comms_queue.empty());
+                auto error =
+                    std::get<messages::ErrorMessage>(comms_queue.front());
+                REQUIRE(error.code == errors::ErrorCode::THERMAL_LID_RUNAWAY);
+                REQUIRE(tasks->get_lid_heater_policy().get_heater_power() ==
+                        0.0F);
+            }
+        }
+    }
+}
@@ -63,6 +63,35 @@ SCENARIO("SetPlateTemperature (M104) parser works", "[gcode][parse][m104]") {
                 REQUIRE(val.has_value());
                 REQUIRE(val.value().setpoint == 50.0F);
                 REQUIRE(val.value().hold_time == 40.0F);
+                REQUIRE(val.value().volume ==
+                        gcode::SetPlateTemperature::no_volume);
+            }
+        }
+        WHEN("Setting target to 95C with a hold time and a sample volume") {
+            std::string buffer = "M104 S95 H30 V25\n";
+            auto parsed =
+                gcode::SetPlateTemperature::parse(buffer.begin(), buffer.end());
+            THEN("all three values should be parsed") {
+                auto &val = parsed.first;
+                REQUIRE(parsed.second != buffer.begin());
+                REQUIRE(val.has_value());
+                REQUIRE(val.value().setpoint == 95.0F);
+                REQUIRE(val.value().hold_time == 30.0F);
+                REQUIRE(val.value().volume == 25.0F);
+            }
+        }
+        WHEN("Setting target to 4C with only a sample volume") {
+            std::string buffer = "M104 S4 V50\n";
+            auto parsed =
+                gcode::SetPlateTemperature::parse(buffer.begin(), buffer.end());
+            THEN("the hold time should be infinite") {
+                auto &val = parsed.first;
+                REQUIRE(parsed.second != buffer.begin());
+                REQUIRE(val.has_value());
+                REQUIRE(val.value().setpoint == 4.0F);
+                REQUIRE(val.value().hold_time ==
+                        gcode::SetPlateTemperature::infinite_hold);
+                REQUIRE(val.value().volume == 50.0F);
             }
         }
     }
@@ -77,6 +106,17 @@ SCENARIO("SetPlateTemperature (M104) parser works", "[gcode][parse][m104]") {
             }
         }
     }
+    GIVEN("a negative sample volume") {
+        std::string buffer = "M104 S95 V-10\n";
+        WHEN("parsing") {
+            auto parsed =
+                gcode::SetPlateTemperature::parse(buffer.begin(), buffer.end());
+            THEN("parsing fails") {
+                REQUIRE(parsed.second == buffer.begin());
+                REQUIRE(!parsed.first.has_value());
+            }
+        }
+    }
     GIVEN("wrong gcode") {
         std::string buffer = "M1044 S\n";
         WHEN("parsing") {
@@ -0,0 +1,75 @@
+#include "catch2/catch.hpp"
+#include "thermocycler-refresh/gcodes.hpp"
+
+SCENARIO("SetPlateControlMode (M104.U) parser works",
+         "[gcode][parse][m104.u]") {
+    GIVEN("a response buffer large enough for the formatted response") {
+        std::string buffer(64, 'c');
+        WHEN("filling response") {
+            auto written = gcode::SetPlateControlMode::write_response_into(
+                buffer.begin(), buffer.end());
+            THEN("the response should be written in full") {
+                REQUIRE_THAT(buffer,
+                             Catch::Matchers::StartsWith("M104.U OK\n"));
+                REQUIRE(written != buffer.begin());
+            }
+        }
+    }
+
+    GIVEN("a response buffer not large enough for the formatted response") {
+        std::string buffer(16, 'c');
+        WHEN("filling response") {
+            auto written = gcode::SetPlateControlMode::write_response_into(
+                buffer.begin(), buffer.begin() + 6);
+            THEN("the response should write only up to the available space") {
+                std::string response = "M104.Ucccccccccc";
+                REQUIRE_THAT(buffer, Catch::Matchers::Equals(response));
+                REQUIRE(written != buffer.begin());
+            }
+        }
+    }
+    GIVEN("valid parameters") {
+        WHEN("selecting independent zones") {
+            std::string buffer = "M104.U S0\n";
+            auto parsed =
+                gcode::SetPlateControlMode::parse(buffer.begin(), buffer.end());
+            THEN("the mode should be independent") {
+                auto &val = parsed.first;
+                REQUIRE(parsed.second != buffer.begin());
+                REQUIRE(val.has_value());
+                REQUIRE(val.value().mode == PLATE_CONTROL_INDEPENDENT);
+            }
+        }
+        WHEN("selecting uniformity mode") {
+            std::string buffer = "M104.U S1\n";
+            auto parsed =
+                gcode::SetPlateControlMode::parse(buffer.begin(), buffer.end());
+            THEN("the mode should be uniformity") {
+                auto &val = parsed.first;
+                REQUIRE(parsed.second != buffer.begin());
+                REQUIRE(val.has_value());
+                REQUIRE(val.value().mode == PLATE_CONTROL_UNIFORMITY);
+            }
+        }
+    }
+    GIVEN("invalid input") {
+        WHEN("the mode is missing") {
+            std::string buffer = "M104.U S\n";
+            auto parsed =
+                gcode::SetPlateControlMode::parse(buffer.begin(), buffer.end());
+            THEN("parsing fails") {
+                REQUIRE(parsed.second == buffer.begin());
+                REQUIRE(!parsed.first.has_value());
+            }
+        }
+        WHEN("the mode is unknown") {
+            std::string buffer = "M104.U S2\n";
+            auto parsed =
+                gcode::SetPlateControlMode::parse(buffer.begin(), buffer.end());
+            THEN("parsing fails") {
+                REQUIRE(parsed.second == buffer.begin());
+                REQUIRE(!parsed.first.has_value());
+            }
+        }
+    }
+}
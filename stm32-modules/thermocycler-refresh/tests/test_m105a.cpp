@@ -0,0 +1,132 @@
+#include "catch2/catch.hpp"
+#include "thermocycler-refresh/gcodes.hpp"
+
+SCENARIO("SetPlateAcquisition (M105.A) parser works",
+         "[gcode][parse][m105.a]") {
+    GIVEN("a response buffer large enough for the formatted response") {
+        std::string buffer(64, 'c');
+        WHEN("filling response") {
+            auto written = gcode::SetPlateAcquisition::write_response_into(
+                buffer.begin(), buffer.end());
+            THEN("the response should be written in full") {
+                REQUIRE_THAT(buffer,
+                             Catch::Matchers::StartsWith("M105.A OK\n"));
+                REQUIRE(written != buffer.begin());
+            }
+        }
+    }
+
+    GIVEN("a response buffer not large enough for the formatted response") {
+        std::string buffer(16, 'c');
+        WHEN("filling response") {
+            auto written = gcode::SetPlateAcquisition::write_response_into(
+                buffer.begin(), buffer.begin() + 6);
+            THEN("the response should write only up to the available space") {
+                std::string response = "M105.Acccccccccc";
+                REQUIRE_THAT(buffer, Catch::Matchers::Equals(response));
+                REQUIRE(written != buffer.begin());
+            }
+        }
+    }
+    GIVEN("valid parameters") {
+        WHEN("leaving out the IIR factor") {
+            std::string buffer = "M105.A R860 O4 F1\n";
+            auto parsed =
+                gcode::SetPlateAcquisition::parse(buffer.begin(), buffer.end());
+            THEN("the settings are parsed with the default factor") {
+                auto &val = parsed.first;
+                REQUIRE(parsed.second != buffer.begin());
+                REQUIRE(val.has_value());
+                REQUIRE(val.value().data_rate_sps == 860);
+                REQUIRE(val.value().oversample == 4);
+                REQUIRE(val.value().filter == AdcFilter::Mode::MEDIAN);
+                REQUIRE(val.value().filter_alpha ==
+                        gcode::SetPlateAcquisition::default_alpha);
+            }
+        }
+        WHEN("leaving out the filter") {
+            std::string buffer = "M105.A R475 O2\n";
+            auto parsed =
+                gcode::SetPlateAcquisition::parse(buffer.begin(), buffer.end());
+            THEN("no filter is used") {
+                auto &val = parsed.first;
+                REQUIRE(parsed.second == buffer.begin() + 14);
+                REQUIRE(val.has_value());
+                REQUIRE(val.value().data_rate_sps == 475);
+                REQUIRE(val.value().oversample == 2);
+                REQUIRE(val.value().filter == AdcFilter::Mode::NONE);
+            }
+        }
+        WHEN("giving the IIR factor") {
+            std::string buffer = "M105.A R250 O2 F2 A0.25\n";
+            auto parsed =
+                gcode::SetPlateAcquisition::parse(buffer.begin(), buffer.end());
+            THEN("the settings are parsed") {
+                auto &val = parsed.first;
+                REQUIRE(parsed.second != buffer.begin());
+                REQUIRE(val.has_value());
+                REQUIRE(val.value().data_rate_sps == 250);
+                REQUIRE(val.value().oversample == 2);
+                REQUIRE(val.value().filter == AdcFilter::Mode::IIR);
+                REQUIRE_THAT(val.value().filter_alpha,
+                             Catch::Matchers::WithinAbs(0.25, 0.0001));
+            }
+        }
+    }
+    GIVEN("invalid input") {
+        WHEN("the data rate isn't one the ADCs have") {
+            std::string buffer = "M105.A R500 O4 F0\n";
+            auto parsed =
+                gcode::SetPlateAcquisition::parse(buffer.begin(), buffer.end());
+            THEN("parsing fails") {
+                REQUIRE(parsed.second == buffer.begin());
+                REQUIRE(!parsed.first.has_value());
+            }
+        }
+        WHEN("there is no oversampling") {
+            std::string buffer = "M105.A R860 O0 F0\n";
+            auto parsed =
+                gcode::SetPlateAcquisition::parse(buffer.begin(), buffer.end());
+            THEN("parsing fails") {
+                REQUIRE(parsed.second == buffer.begin());
+                REQUIRE(!parsed.first.has_value());
+            }
+        }
+        WHEN("the filter is unknown") {
+            std::string buffer = "M105.A R860 O4 F3\n";
+            auto parsed =
+                gcode::SetPlateAcquisition::parse(buffer.begin(), buffer.end());
+            THEN("parsing fails") {
+                REQUIRE(parsed.second == buffer.begin());
+                REQUIRE(!parsed.first.has_value());
+            }
+        }
+        WHEN("the IIR factor is out of range") {
+            std::string buffer = "M105.A R860 O4 F2 A1.5\n";
+            auto parsed =
+                gcode::SetPlateAcquisition::parse(buffer.begin(), buffer.end());
+            THEN("parsing fails") {
+                REQUIRE(parsed.second == buffer.begin());
+                REQUIRE(!parsed.first.has_value());
+            }
+        }
+        WHEN("the data rate is too slow to ever fit a scan") {
+            std::string buffer = "M105.A R128 O1 F0\n";
+            auto parsed =
+                gcode::SetPlateAcquisition::parse(buffer.begin(), buffer.end());
+            THEN("parsing fails") {
+                REQUIRE(parsed.second == buffer.begin());
+                REQUIRE(!parsed.first.has_value());
+            }
+        }
+        WHEN("the filter is empty") {
+            std::string buffer = "M105.A R860 O4 F";
+            auto parsed =
+                gcode::SetPlateAcquisition::parse(buffer.begin(), buffer.end());
+            THEN("parsing fails") {
+                REQUIRE(parsed.second == buffer.begin());
+                REQUIRE(!parsed.first.has_value());
+            }
+        }
+    }
+}
@@ -0,0 +1,66 @@
+#include <array>
+
+#include "catch2/catch.hpp"
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-truncation"
+#include "thermocycler-refresh/gcodes.hpp"
+#pragma GCC diagnostic pop
+
+SCENARIO("GetPlateThermistorNoise (M105.N) parser works",
+         "[gcode][parse][m105.n]") {
+    GIVEN("a response buffer large enough for the formatted response") {
+        std::string buffer(256, 'c');
+        WHEN("filling response") {
+            auto written = gcode::GetPlateThermistorNoise::write_response_into(
+                buffer.begin(), buffer.end(), 64, 0.01, 0.02, 0.03, 0.04, 0.05,
+                0.06, 0.07);
+            THEN("the response should be written in full") {
+                REQUIRE_THAT(buffer,
+                             Catch::Matchers::StartsWith(
+                                 "M105.N N:64 HST:0.0100 FRT:0.0200 "
+                                 "FLT:0.0300 FCT:0.0400 BRT:0.0500 "
+                                 "BLT:0.0600 BCT:0.0700 OK\n"));
+                REQUIRE(written != buffer.begin());
+            }
+        }
+    }
+
+    GIVEN("a response buffer not large enough for the formatted response") {
+        std::string buffer(16, 'c');
+        WHEN("filling response") {
+            auto written = gcode::GetPlateThermistorNoise::write_response_into(
+                buffer.begin(), buffer.begin() + 7, 64, 0.01, 0.02, 0.03, 0.04,
+                0.05, 0.06, 0.07);
+            THEN("the response should write only up to the available space") {
+                std::string response = "M105.Ncccccccccc";
+                response.at(6) = '\0';
+                REQUIRE_THAT(buffer, Catch::Matchers::Equals(response));
+                REQUIRE(written != buffer.begin());
+            }
+        }
+    }
+
+    GIVEN("a valid input") {
+        std::string buffer = "M105.N\n";
+        WHEN("parsing") {
+            auto parsed = gcode::GetPlateThermistorNoise::parse(buffer.begin(),
+                                                                buffer.end());
+            THEN("the gcode is recognized") {
+                REQUIRE(parsed.first.has_value());
+                REQUIRE(parsed.second == buffer.begin() + 6);
+            }
+        }
+    }
+
+    GIVEN("a different gcode") {
+        std::string buffer = "M105.T\n";
+        WHEN("parsing") {
+            auto parsed = gcode::GetPlateThermistorNoise::parse(buffer.begin(),
+                                                                buffer.end());
+            THEN("nothing is parsed") {
+                REQUIRE(!parsed.first.has_value());
+                REQUIRE(parsed.second == buffer.begin());
+            }
+        }
+    }
+}
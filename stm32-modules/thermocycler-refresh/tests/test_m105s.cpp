@@ -0,0 +1,129 @@
+#include <array>
+
+#include "catch2/catch.hpp"
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-truncation"
+#include "thermocycler-refresh/gcodes.hpp"
+#pragma GCC diagnostic pop
+
+SCENARIO("GetThermistorStats (M105.S) parser works",
+         "[gcode][parse][m105.s]") {
+    GIVEN("a response buffer large enough for the formatted response") {
+        std::string buffer(256, 'c');
+        WHEN("filling response") {
+            auto written = gcode::GetThermistorStats::write_response_into(
+                buffer.begin(), buffer.end(), 3, 64, 24.5, 25.25, 25.0, 0.0125,
+                2, 1000, 7, -0.25);
+            THEN("the response should be written in full") {
+                REQUIRE_THAT(buffer,
+                             Catch::Matchers::StartsWith(
+                                 "M105.S T:3 N:64 MIN:24.50 MAX:25.25 "
+                                 "AVG:25.000 VAR:0.01250 INV:2 TOT:1000 "
+                                 "TINV:7 DR:-0.250 OK\n"));
+                REQUIRE(written != buffer.begin());
+            }
+        }
+    }
+
+    GIVEN("a response buffer not large enough for the formatted response") {
+        std::string buffer(16, 'c');
+        WHEN("filling response") {
+            auto written = gcode::GetThermistorStats::write_response_into(
+                buffer.begin(), buffer.begin() + 7, 3, 64, 24.5, 25.25, 25.0,
+                0.0125, 2, 1000, 7, -0.25);
+            THEN("the response should write only up to the available space") {
+                std::string response = "M105.Scccccccccc";
+                response.at(6) = '\0';
+                REQUIRE_THAT(buffer, Catch::Matchers::Equals(response));
+                REQUIRE(written != buffer.begin());
+            }
+        }
+    }
+
+    GIVEN("a valid input") {
+        std::string buffer = "M105.S 7\n";
+        WHEN("parsing") {
+            auto parsed =
+                gcode::GetThermistorStats::parse(buffer.begin(), buffer.end());
+            THEN("the thermistor is parsed") {
+                REQUIRE(parsed.first.has_value());
+                REQUIRE(parsed.first.value().thermistor == 7);
+                REQUIRE(parsed.second == buffer.begin() + 8);
+            }
+        }
+    }
+
+    GIVEN("an input with a window") {
+        std::string buffer = "M105.S 7 W8\n";
+        WHEN("parsing") {
+            auto parsed =
+                gcode::GetThermistorStats::parse(buffer.begin(), buffer.end());
+            THEN("the window is parsed") {
+                REQUIRE(parsed.first.has_value());
+                REQUIRE(parsed.first.value().thermistor == 7);
+                REQUIRE(parsed.first.value().window == 8);
+                REQUIRE(parsed.second == buffer.begin() + 11);
+            }
+        }
+    }
+
+    GIVEN("an input without a window") {
+        std::string buffer = "M105.S 7\n";
+        WHEN("parsing") {
+            auto parsed =
+                gcode::GetThermistorStats::parse(buffer.begin(), buffer.end());
+            THEN("the window is all the readings kept") {
+                REQUIRE(parsed.first.value().window ==
+                        gcode::GetThermistorStats::max_window);
+            }
+        }
+    }
+
+    GIVEN("a window longer than is kept") {
+        std::string buffer = "M105.S 7 W65\n";
+        WHEN("parsing") {
+            auto parsed =
+                gcode::GetThermistorStats::parse(buffer.begin(), buffer.end());
+            THEN("nothing is parsed") {
+                REQUIRE(!parsed.first.has_value());
+                REQUIRE(parsed.second == buffer.begin());
+            }
+        }
+    }
+
+    GIVEN("an empty window") {
+        std::string buffer = "M105.S 7 W0\n";
+        WHEN("parsing") {
+            auto parsed =
+                gcode::GetThermistorStats::parse(buffer.begin(), buffer.end());
+            THEN("nothing is parsed") {
+                REQUIRE(!parsed.first.has_value());
+                REQUIRE(parsed.second == buffer.begin());
+            }
+        }
+    }
+
+    GIVEN("a thermistor that doesn't exist") {
+        std::string buffer = "M105.S 8\n";
+        WHEN("parsing") {
+            auto parsed =
+                gcode::GetThermistorStats::parse(buffer.begin(), buffer.end());
+            THEN("nothing is parsed") {
+                REQUIRE(!parsed.first.has_value());
+                REQUIRE(parsed.second == buffer.begin());
+            }
+        }
+    }
+
+    GIVEN("no thermistor") {
+        std::string buffer = "M105.S\n";
+        WHEN("parsing") {
+            auto parsed =
+                gcode::GetThermistorStats::parse(buffer.begin(), buffer.end());
+            THEN("nothing is parsed") {
+                REQUIRE(!parsed.first.has_value());
+                REQUIRE(parsed.second == buffer.begin());
+            }
+        }
+    }
+}
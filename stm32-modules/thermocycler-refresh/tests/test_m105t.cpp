@@ -0,0 +1,64 @@
+#include <array>
+
+#include "catch2/catch.hpp"
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-truncation"
+#include "thermocycler-refresh/gcodes.hpp"
+#pragma GCC diagnostic pop
+
+SCENARIO("GetPlateSampleTiming (M105.T) parser works",
+         "[gcode][parse][m105.t]") {
+    GIVEN("a response buffer large enough for the formatted response") {
+        std::string buffer(128, 'c');
+        WHEN("filling response") {
+            auto written = gcode::GetPlateSampleTiming::write_response_into(
+                buffer.begin(), buffer.end(), 120, 50.012, 0.25, 1.5, 12.75);
+            THEN("the response should be written in full") {
+                REQUIRE_THAT(buffer,
+                             Catch::Matchers::StartsWith(
+                                 "M105.T N:120 P:50.012 S:0.250 J:1.500 "
+                                 "A:12.750 OK\n"));
+                REQUIRE(written != buffer.begin());
+            }
+        }
+    }
+
+    GIVEN("a response buffer not large enough for the formatted response") {
+        std::string buffer(16, 'c');
+        WHEN("filling response") {
+            auto written = gcode::GetPlateSampleTiming::write_response_into(
+                buffer.begin(), buffer.begin() + 7, 120, 50.012, 0.25, 1.5,
+                12.75);
+            THEN("the response should write only up to the available space") {
+                std::string response = "M105.Tcccccccccc";
+                response.at(6) = '\0';
+                REQUIRE_THAT(buffer, Catch::Matchers::Equals(response));
+                REQUIRE(written != buffer.begin());
+            }
+        }
+    }
+
+    GIVEN("a valid input") {
+        std::string buffer = "M105.T\n";
+        WHEN("parsing") {
+            auto parsed = gcode::GetPlateSampleTiming::parse(buffer.begin(),
+                                                             buffer.end());
+            THEN("the gcode is recognized") {
+                REQUIRE(parsed.first.has_value());
+                REQUIRE(parsed.second == buffer.begin() + 6);
+            }
+        }
+    }
+
+    GIVEN("a different gcode") {
+        std::string buffer = "M105.D\n";
+        WHEN("parsing") {
+            auto parsed = gcode::GetPlateSampleTiming::parse(buffer.begin(),
+                                                             buffer.end());
+            THEN("nothing is parsed") {
+                REQUIRE(!parsed.first.has_value());
+                REQUIRE(parsed.second == buffer.begin());
+            }
+        }
+    }
+}
@@ -0,0 +1,146 @@
+#include "catch2/catch.hpp"
+#include "systemwide.h"
+// Push this diagnostic to avoid a compiler error about printing to too
+// small of a buffer... which we're doing on purpose!
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-truncation"
+#include "thermocycler-refresh/gcodes.hpp"
+#pragma GCC diagnostic pop
+
+SCENARIO("StartAutotune (M303) parser works", "[gcode][parse][m303]") {
+    GIVEN("a response buffer large enough for the formatted response") {
+        std::string buffer(256, 'c');
+        WHEN("filling response") {
+            auto written = gcode::StartAutotune::write_response_into(
+                buffer.begin(), buffer.end(), 1.5, 0.02, 12.25);
+            THEN("the response should be written in full") {
+                REQUIRE_THAT(buffer,
+                             Catch::Matchers::StartsWith(
+                                 "M303 P:1.5000 I:0.0200 D:12.2500 OK\n"));
+                REQUIRE(written != buffer.begin());
+            }
+        }
+    }
+    GIVEN("a response buffer not large enough for the formatted response") {
+        std::string buffer(16, 'c');
+        WHEN("filling response") {
+            auto written = gcode::StartAutotune::write_response_into(
+                buffer.begin(), buffer.begin() + 7, 1.5, 0.02, 12.25);
+            THEN("the response should write only up to the available space") {
+                std::string response = "M303 Pcccccccccc";
+                response[6] = '\0';
+                REQUIRE_THAT(buffer, Catch::Matchers::Equals(response));
+                REQUIRE(written != buffer.begin());
+            }
+        }
+    }
+    GIVEN("valid input for the heater") {
+        std::string buffer = "M303 SH T95.5\n";
+        WHEN("parsing the command") {
+            auto parsed =
+                gcode::StartAutotune::parse(buffer.begin(), buffer.end());
+            THEN("a valid command is produced") {
+                REQUIRE(parsed.first.has_value());
+                REQUIRE(parsed.second != buffer.begin());
+                auto val = parsed.first.value();
+                REQUIRE(val.selection == PidSelection::HEATER);
+                REQUIRE(val.setpoint == 95.5F);
+            }
+        }
+    }
+    GIVEN("valid input for the peltiers") {
+        std::string buffer = "M303 SP T60\n";
+        WHEN("parsing the command") {
+            auto parsed =
+                gcode::StartAutotune::parse(buffer.begin(), buffer.end());
+            THEN("a valid command is produced") {
+                REQUIRE(parsed.first.has_value());
+                auto val = parsed.first.value();
+                REQUIRE(val.selection == PidSelection::PELTIERS);
+                REQUIRE(val.setpoint == 60.0F);
+            }
+        }
+    }
+    GIVEN("input selecting the fans") {
+        std::string buffer = "M303 SF T60\n";
+        WHEN("parsing the command") {
+            auto parsed =
+                gcode::StartAutotune::parse(buffer.begin(), buffer.end());
+            THEN("an error is produced, since the fans cannot be tuned") {
+                REQUIRE(!parsed.first.has_value());
+                REQUIRE(parsed.second == buffer.begin());
+            }
+        }
+    }
+    GIVEN("input without a setpoint") {
+        std::string buffer = "M303 SH\n";
+        WHEN("parsing the command") {
+            auto parsed =
+                gcode::StartAutotune::parse(buffer.begin(), buffer.end());
+            THEN("an error is produced") {
+                REQUIRE(!parsed.first.has_value());
+                REQUIRE(parsed.second == buffer.begin());
+            }
+        }
+    }
+    GIVEN("a peltier setpoint above the plate's range") {
+        std::string buffer = "M303 SP T500\n";
+        WHEN("parsing the command") {
+            auto parsed =
+                gcode::StartAutotune::parse(buffer.begin(), buffer.end());
+            THEN("an error is produced") {
+                REQUIRE(!parsed.first.has_value());
+                REQUIRE(parsed.second == buffer.begin());
+            }
+        }
+    }
+    GIVEN("a peltier setpoint below the plate's range") {
+        std::string buffer = "M303 SP T2\n";
+        WHEN("parsing the command") {
+            auto parsed =
+                gcode::StartAutotune::parse(buffer.begin(), buffer.end());
+            THEN("an error is produced") {
+                REQUIRE(!parsed.first.has_value());
+                REQUIRE(parsed.second == buffer.begin());
+            }
+        }
+    }
+    GIVEN("a heater setpoint above the lid's range") {
+        std::string buffer = "M303 SH T115\n";
+        WHEN("parsing the command") {
+            auto parsed =
+                gcode::StartAutotune::parse(buffer.begin(), buffer.end());
+            THEN("an error is produced") {
+                REQUIRE(!parsed.first.has_value());
+                REQUIRE(parsed.second == buffer.begin());
+            }
+        }
+    }
+    GIVEN("a heater setpoint below the lid's range") {
+        std::string buffer = "M303 SH T25\n";
+        WHEN("parsing the command") {
+            auto parsed =
+                gcode::StartAutotune::parse(buffer.begin(), buffer.end());
+            THEN("an error is produced") {
+                REQUIRE(!parsed.first.has_value());
+                REQUIRE(parsed.second == buffer.begin());
+            }
+        }
+    }
+    GIVEN("setpoints at the edges of the ranges") {
+        WHEN("parsing them") {
+            std::string plate_low = "M303 SP T4\n";
+            std::string plate_high = "M303 SP T99\n";
+            std::string lid_low = "M303 SH T37\n";
+            std::string lid_high = "M303 SH T110\n";
+            THEN("they are accepted") {
+                for (auto *buffer :
+                     {&plate_low, &plate_high, &lid_low, &lid_high}) {
+                    REQUIRE(gcode::StartAutotune::parse(buffer->begin(),
+                                                        buffer->end())
+                                .first.has_value());
+                }
+            }
+        }
+    }
+}
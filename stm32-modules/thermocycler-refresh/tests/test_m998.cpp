@@ -0,0 +1,49 @@
+#include "catch2/catch.hpp"
+#include "thermocycler-refresh/gcodes.hpp"
+
+SCENARIO("SetPowerSupply (M998) parser works", "[gcode][parse][m998]") {
+    GIVEN("a response buffer large enough for the formatted response") {
+        std::string buffer(64, 'c');
+        WHEN("filling response") {
+            auto written = gcode::SetPowerSupply::write_response_into(
+                buffer.begin(), buffer.end());
+            THEN("the response should be written in full") {
+                REQUIRE_THAT(buffer, Catch::Matchers::StartsWith("M998 OK\n"));
+                REQUIRE(written != buffer.begin());
+            }
+        }
+    }
+    GIVEN("valid parameters") {
+        WHEN("setting a supply") {
+            std::string buffer = "M998 S212.5\n";
+            auto parsed =
+                gcode::SetPowerSupply::parse(buffer.begin(), buffer.end());
+            THEN("the supply should be parsed") {
+                auto &val = parsed.first;
+                REQUIRE(parsed.second != buffer.begin());
+                REQUIRE(val.has_value());
+                REQUIRE(val.value().watts == 212.5);
+            }
+        }
+    }
+    GIVEN("invalid input") {
+        WHEN("the supply is missing") {
+            std::string buffer = "M998 S\n";
+            auto parsed =
+                gcode::SetPowerSupply::parse(buffer.begin(), buffer.end());
+            THEN("parsing fails") {
+                REQUIRE(parsed.second == buffer.begin());
+                REQUIRE(!parsed.first.has_value());
+            }
+        }
+        WHEN("the supply is negative") {
+            std::string buffer = "M998 S-5\n";
+            auto parsed =
+                gcode::SetPowerSupply::parse(buffer.begin(), buffer.end());
+            THEN("parsing fails") {
+                REQUIRE(parsed.second == buffer.begin());
+                REQUIRE(!parsed.first.has_value());
+            }
+        }
+    }
+}
@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "catch2/catch.hpp"
+#include "core/thermistor_conversion.hpp"
+#include "systemwide.h"
+#include "test/task_builder.hpp"
+#include "thermistor_lookups.hpp"
+#include "thermocycler-refresh/messages.hpp"
+#include "thermocycler-refresh/thermal_plate_task.hpp"
+
+using PlateTask = thermal_plate_task::ThermalPlateTask<TestMessageQueue>;
+
+/**
+ * Lumped model of the plate block with a sample sitting in it. The block is
+ * driven by the peltiers; the sample only exchanges heat with the block, so
+ * it lags behind it with a time constant that grows with volume.
+ */
+struct PlateWithSample {
+    static constexpr double PELTIER_MAX_WATTS = 120.0;
+    static constexpr double BLOCK_CAPACITY_J_PER_K = 70.0;
+    static constexpr double HEATSINK_LEAK_W_PER_K = 0.6;
+    static constexpr double HEATSINK_TEMP = 25.0;
+
+    double sample_tau_s;
+    double block = HEATSINK_TEMP;
+    double sample = HEATSINK_TEMP;
+
+    auto step(double power, double seconds) -> void {
+        const double watts = PELTIER_MAX_WATTS * power -
+                             HEATSINK_LEAK_W_PER_K * (block - HEATSINK_TEMP);
+        block += watts * seconds / BLOCK_CAPACITY_J_PER_K;
+        sample += (block - sample) * seconds / sample_tau_s;
+    }
+};
+
+struct StepResult {
+    // Time from the setpoint command until the sample enters the hold band
+    // around the target for good
+    double hold_start_s;
+    // Furthest the sample went past the target
+    double sample_overshoot_c;
+    double final_block;
+    double final_sample;
+};
+
+/**
+ * Runs a heating step followed by a cooling step on a plate holding a
+ * sample of sample_volume_ul, telling the task the sample volume is
+ * commanded_volume_ul.
+ */
+static auto run_steps(double sample_volume_ul, double commanded_volume_ul,
+                      const std::array<double, 2>& targets)
+    -> std::array<StepResult, 2> {
+    constexpr double hold_band_c = 0.5;
+    constexpr double step_seconds = 180.0;
+    auto tasks = TaskBuilder::build();
+    auto converter = thermistor_conversion::Conversion<lookups::KS103J2G>(
+        PlateTask::THERMISTOR_CIRCUIT_BIAS_RESISTANCE_KOHM,
+        PlateTask::ADC_BIT_MAX, false);
+    auto plant = PlateWithSample{
+        .sample_tau_s = PlateTask::SAMPLE_TAU_BASE_S +
+                        PlateTask::SAMPLE_TAU_PER_UL_S * sample_volume_ul};
+    auto& queue = tasks->get_thermal_plate_queue().backing_deque;
+    auto& comms = tasks->get_host_comms_queue().backing_deque;
+
+    auto send_temps = [&]() {
+        auto block = converter.backconvert(plant.block);
+        queue.push_back(messages::ThermalPlateTempReadComplete{
+            .heat_sink = converter.backconvert(plant.HEATSINK_TEMP),
+            .front_right = block,
+            .front_center = block,
+            .front_left = block,
+            .back_right = block,
+            .back_center = block,
+            .back_left = block});
+        tasks->run_thermal_plate_task();
+    };
+
+    send_temps();
+    queue.push_back(messages::SetPIDConstantsMessage{
+        .id = 1, .selection = PidSelection::PELTIERS, .p = 0.2, .i = 0.01,
+        .d = 0});
+    tasks->run_thermal_plate_task();
+
+    std::array<StepResult, 2> results{};
+    for (size_t step = 0; step < targets.size(); ++step) {
+        const double target = targets.at(step);
+        const double direction = (target > plant.sample) ? 1.0 : -1.0;
+        queue.push_back(messages::SetPlateTemperatureMessage{
+            .id = 2,
+            .setpoint = target,
+            .hold_time = 0,
+            .volume = commanded_volume_ul});
+        tasks->run_thermal_plate_task();
+        comms.clear();
+        auto& result = results.at(step);
+        result.hold_start_s = -1;
+        double elapsed = 0;
+        while (elapsed < step_seconds) {
+            send_temps();
+            auto output = tasks->get_thermal_plate_policy().get_peltier(
+                PeltierID::PELTIER_CENTER);
+            const double power =
+                (output.first == PeltierDirection::PELTIER_COOLING)
+                    ? -output.second
+                    : output.second;
+            plant.step(power, PlateTask::CONTROL_PERIOD_SECONDS);
+            elapsed += PlateTask::CONTROL_PERIOD_SECONDS;
+            if (std::abs(plant.sample - target) >= hold_band_c) {
+                result.hold_start_s = -1;
+            } else if (result.hold_start_s < 0) {
+                result.hold_start_s = elapsed;
+            }
+            result.sample_overshoot_c = std::max(
+                result.sample_overshoot_c, direction * (plant.sample - target));
+            comms.clear();
+        }
+        result.final_block = plant.block;
+        result.final_sample = plant.sample;
+    }
+    return results;
+}
+
+SCENARIO("plate overshoot for sample volume") {
+    GIVEN("a simulated plate holding a 50uL sample") {
+        constexpr double volume = 50.0;
+        constexpr std::array<double, 2> targets{95.0, 55.0};
+        WHEN("stepping with and without the sample volume in the gcode") {
+            auto plain = run_steps(volume, 0, targets);
+            auto compensated = run_steps(volume, volume, targets);
+            THEN("the sample reaches the hold band sooner") {
+                for (size_t i = 0; i < targets.size(); ++i) {
+                    REQUIRE(plain.at(i).hold_start_s > 0);
+                    REQUIRE(compensated.at(i).hold_start_s > 0);
+                    REQUIRE(compensated.at(i).hold_start_s <
+                            plain.at(i).hold_start_s * 0.9);
+                }
+            }
+            THEN("the sample stays inside the hold band once there") {
+                for (const auto& result : compensated) {
+                    REQUIRE(result.sample_overshoot_c < 0.5);
+                }
+            }
+            THEN("the plate settles back to the real target") {
+                for (size_t i = 0; i < targets.size(); ++i) {
+                    const double target = targets.at(i);
+                    REQUIRE_THAT(compensated.at(i).final_block,
+                                 Catch::Matchers::WithinAbs(target, 0.2));
+                    REQUIRE_THAT(compensated.at(i).final_sample,
+                                 Catch::Matchers::WithinAbs(target, 0.2));
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,255 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "catch2/catch.hpp"
+#include "core/thermistor_conversion.hpp"
+#include "systemwide.h"
+#include "test/task_builder.hpp"
+#include "thermistor_lookups.hpp"
+#include "thermocycler-refresh/messages.hpp"
+#include "thermocycler-refresh/thermal_plate_task.hpp"
+
+using PlateTask = thermal_plate_task::ThermalPlateTask<TestMessageQueue>;
+
+/**
+ * Lumped model of three thermally coupled plate zones. The center zone has
+ * more thermal mass than the edges, so at equal power it lags the edges
+ * during a ramp, and each zone exchanges heat with its neighbors.
+ */
+struct CoupledPlatePlant {
+    static constexpr double PELTIER_MAX_WATTS = 40.0;
+    static constexpr double EDGE_CAPACITY_J_PER_K = 20.0;
+    static constexpr double CENTER_CAPACITY_J_PER_K = 30.0;
+    static constexpr double ZONE_COUPLING_W_PER_K = 1.0;
+    static constexpr double HEATSINK_LEAK_W_PER_K = 0.2;
+    static constexpr double HEATSINK_TEMP = 25.0;
+
+    // Left, center, right
+    std::array<double, 3> temps{HEATSINK_TEMP, HEATSINK_TEMP, HEATSINK_TEMP};
+
+    auto step(const std::array<double, 3>& power, double seconds) -> void {
+        constexpr std::array<double, 3> capacity{EDGE_CAPACITY_J_PER_K,
+                                                 CENTER_CAPACITY_J_PER_K,
+                                                 EDGE_CAPACITY_J_PER_K};
+        auto next = temps;
+        for (size_t i = 0; i < temps.size(); ++i) {
+            const double temp = temps.at(i);
+            double watts = PELTIER_MAX_WATTS * power.at(i) -
+                           HEATSINK_LEAK_W_PER_K * (temp - HEATSINK_TEMP);
+            if (i > 0) {
+                watts += ZONE_COUPLING_W_PER_K * (temps.at(i - 1) - temp);
+            }
+            if (i < temps.size() - 1) {
+                watts += ZONE_COUPLING_W_PER_K * (temps.at(i + 1) - temp);
+            }
+            next.at(i) += watts * seconds / capacity.at(i);
+        }
+        temps = next;
+    }
+
+    [[nodiscard]] auto spread() const -> double {
+        const auto [low, high] =
+            std::minmax_element(temps.cbegin(), temps.cend());
+        return *high - *low;
+    }
+};
+
+struct SpreadResult {
+    double ramp_spread;
+    double settled_spread;
+    std::array<double, 3> final_temps;
+    // Whether the task reported an error at any point
+    bool faulted;
+};
+
+static auto signed_power(std::pair<PeltierDirection, double> output)
+    -> double {
+    return output.first == PeltierDirection::PELTIER_COOLING ? -output.second
+                                                             : output.second;
+}
+
+/** Runs a closed loop ramp from ambient to target and records zone spread */
+static auto run_closed_loop(PlateControlMode mode, double target)
+    -> SpreadResult {
+    constexpr double hold_seconds = 60.0;
+    constexpr double hold_band_c = 0.5;
+    // Far longer than any ramp takes, so a plate that never settles fails
+    // rather than hanging the test
+    constexpr size_t max_steps = static_cast<size_t>(
+        1200.0 / PlateTask::CONTROL_PERIOD_SECONDS);
+    auto tasks = TaskBuilder::build();
+    auto converter = thermistor_conversion::Conversion<lookups::KS103J2G>(
+        PlateTask::THERMISTOR_CIRCUIT_BIAS_RESISTANCE_KOHM,
+        PlateTask::ADC_BIT_MAX, false);
+    auto plant = CoupledPlatePlant();
+    auto& queue = tasks->get_thermal_plate_queue().backing_deque;
+    auto& comms = tasks->get_host_comms_queue().backing_deque;
+
+    auto send_temps = [&]() {
+        auto left = converter.backconvert(plant.temps[0]);
+        auto center = converter.backconvert(plant.temps[1]);
+        auto right = converter.backconvert(plant.temps[2]);
+        queue.push_back(messages::ThermalPlateTempReadComplete{
+            .heat_sink = converter.backconvert(plant.HEATSINK_TEMP),
+            .front_right = right,
+            .front_center = center,
+            .front_left = left,
+            .back_right = right,
+            .back_center = center,
+            .back_left = left});
+        tasks->run_thermal_plate_task();
+    };
+
+    send_temps();
+    queue.push_back(messages::SetPIDConstantsMessage{
+        .id = 1, .selection = PidSelection::PELTIERS, .p = 0.1, .i = 0.005,
+        .d = 0});
+    tasks->run_thermal_plate_task();
+    queue.push_back(
+        messages::SetPlateControlModeMessage{.id = 2, .mode = mode});
+    tasks->run_thermal_plate_task();
+    queue.push_back(messages::SetPlateTemperatureMessage{
+        .id = 3, .setpoint = target, .hold_time = 0});
+    tasks->run_thermal_plate_task();
+    comms.clear();
+
+    auto result = SpreadResult{
+        .ramp_spread = 0, .settled_spread = 0, .final_temps{}, .faulted = false};
+    double held_for = 0;
+    size_t steps = 0;
+    while ((held_for < hold_seconds) && (steps < max_steps)) {
+        ++steps;
+        send_temps();
+        auto& policy = tasks->get_thermal_plate_policy();
+        auto power = std::array<double, 3>{
+            signed_power(policy.get_peltier(PeltierID::PELTIER_LEFT)),
+            signed_power(policy.get_peltier(PeltierID::PELTIER_CENTER)),
+            signed_power(policy.get_peltier(PeltierID::PELTIER_RIGHT))};
+        plant.step(power, PlateTask::CONTROL_PERIOD_SECONDS);
+        bool holding = std::all_of(
+            plant.temps.cbegin(), plant.temps.cend(),
+            [target](double t) { return std::abs(t - target) < hold_band_c; });
+        if (holding || held_for > 0) {
+            held_for += PlateTask::CONTROL_PERIOD_SECONDS;
+        } else {
+            result.ramp_spread = std::max(result.ramp_spread, plant.spread());
+        }
+        result.faulted |= std::any_of(
+            comms.cbegin(), comms.cend(), [](const auto& message) {
+                return std::holds_alternative<messages::ErrorMessage>(message);
+            });
+        comms.clear();
+    }
+    REQUIRE(steps < max_steps);
+    result.settled_spread = plant.spread();
+    result.final_temps = plant.temps;
+    return result;
+}
+
+SCENARIO("plate uniformity control mode") {
+    GIVEN("a thermal plate task") {
+        auto tasks = TaskBuilder::build();
+        WHEN("setting the control mode") {
+            tasks->get_thermal_plate_queue().backing_deque.push_back(
+                messages::SetPlateControlModeMessage{
+                    .id = 42, .mode = PLATE_CONTROL_UNIFORMITY});
+            tasks->run_thermal_plate_task();
+            THEN("the task acknowledges the message") {
+                REQUIRE(!tasks->get_host_comms_queue().backing_deque.empty());
+                auto response =
+                    tasks->get_host_comms_queue().backing_deque.front();
+                REQUIRE(std::holds_alternative<messages::AcknowledgePrevious>(
+                    response));
+                auto ack = std::get<messages::AcknowledgePrevious>(response);
+                REQUIRE(ack.responding_to_id == 42);
+                REQUIRE(ack.with_error == errors::ErrorCode::NO_ERROR);
+            }
+        }
+    }
+    GIVEN("a simulated plate with thermally coupled zones") {
+        constexpr double target = 70.0;
+        WHEN("ramping to a target with independent and uniformity control") {
+            auto independent =
+                run_closed_loop(PLATE_CONTROL_INDEPENDENT, target);
+            auto uniform = run_closed_loop(PLATE_CONTROL_UNIFORMITY, target);
+            THEN("both modes settle at the target") {
+                for (auto temp : independent.final_temps) {
+                    REQUIRE_THAT(temp,
+                                 Catch::Matchers::WithinAbs(target, 0.5));
+                }
+                for (auto temp : uniform.final_temps) {
+                    REQUIRE_THAT(temp,
+                                 Catch::Matchers::WithinAbs(target, 0.5));
+                }
+            }
+            THEN("neither mode trips the thermal fault checks") {
+                REQUIRE(!independent.faulted);
+                REQUIRE(!uniform.faulted);
+            }
+            THEN("uniformity mode reduces the max zone spread") {
+                REQUIRE(uniform.ramp_spread < independent.ramp_spread / 2);
+                REQUIRE(uniform.settled_spread <= independent.settled_spread);
+            }
+        }
+    }
+}
+
+SCENARIO("plate uniformity mode and the runaway check") {
+    GIVEN("a plate in uniformity mode with its center zone ahead") {
+        auto tasks = TaskBuilder::build();
+        auto converter = thermistor_conversion::Conversion<lookups::KS103J2G>(
+            PlateTask::THERMISTOR_CIRCUIT_BIAS_RESISTANCE_KOHM,
+            PlateTask::ADC_BIT_MAX, false);
+        auto& queue = tasks->get_thermal_plate_queue().backing_deque;
+        auto& comms = tasks->get_host_comms_queue().backing_deque;
+        auto send_temps = [&](double edges, double center) {
+            auto edge = converter.backconvert(edges);
+            auto middle = converter.backconvert(center);
+            queue.push_back(messages::ThermalPlateTempReadComplete{
+                .heat_sink = converter.backconvert(25.0),
+                .front_right = edge,
+                .front_center = middle,
+                .front_left = edge,
+                .back_right = edge,
+                .back_center = middle,
+                .back_left = edge});
+            tasks->run_thermal_plate_task();
+        };
+        constexpr double lead_c = 6.0;
+        double edges = 30.0;
+        send_temps(edges, edges + lead_c);
+        queue.push_back(messages::SetPlateControlModeMessage{
+            .id = 1, .mode = PLATE_CONTROL_UNIFORMITY});
+        tasks->run_thermal_plate_task();
+        queue.push_back(messages::SetPlateTemperatureMessage{
+            .id = 2, .setpoint = 90, .hold_time = 0});
+        tasks->run_thermal_plate_task();
+        comms.clear();
+        WHEN("the edges heat the center while it is backed off") {
+            auto& policy = tasks->get_thermal_plate_policy();
+            bool center_backed_off = true;
+            // Well past the runaway check's grace and window
+            const int periods = static_cast<int>(
+                3 * PlateTask::FAULT_LIMITS.window_s /
+                PlateTask::CONTROL_PERIOD_SECONDS);
+            for (int i = 0; i < periods; ++i) {
+                edges += 0.5 * PlateTask::CONTROL_PERIOD_SECONDS;
+                send_temps(edges, edges + lead_c);
+                center_backed_off &=
+                    (signed_power(policy.get_peltier(
+                         PeltierID::PELTIER_CENTER)) <= 0);
+            }
+            THEN("the center was driven to cool the whole time") {
+                REQUIRE(center_backed_off);
+            }
+            THEN("its rise is not taken for a runaway") {
+                REQUIRE(std::none_of(
+                    comms.cbegin(), comms.cend(), [](const auto& message) {
+                        return std::holds_alternative<messages::ErrorMessage>(
+                            message);
+                    }));
+            }
+        }
+    }
+}
@@ -0,0 +1,178 @@
+#include <variant>
+
+#include "catch2/catch.hpp"
+#include "core/thermistor_conversion.hpp"
+#include "simulator/thermal_model.hpp"
+#include "thermistor_lookups.hpp"
+
+using namespace thermal_model;
+
+namespace {
+auto to_celsius(uint16_t counts) -> double {
+    auto converter = thermistor_conversion::Conversion<lookups::KS103J2G>(
+        Plant::THERMISTOR_CIRCUIT_BIAS_RESISTANCE_KOHM, Plant::ADC_BIT_MAX,
+        false);
+    auto result = converter.convert(counts);
+    REQUIRE(std::holds_alternative<double>(result));
+    return std::get<double>(result);
+}
+}  // namespace
+
+SCENARIO("thermal plant model") {
+    auto model = PlantModel();
+    GIVEN("a model with no inputs") {
+        WHEN("stepping it") {
+            model.step(60);
+            THEN("everything stays at ambient") {
+                for (size_t zone = 0; zone < PlantModel::ZONES; ++zone) {
+                    REQUIRE(model.zone_c(zone) ==
+                            Approx(PlantModel::AMBIENT_C));
+                    REQUIRE(model.well_c(zone) ==
+                            Approx(PlantModel::AMBIENT_C));
+                }
+                REQUIRE(model.heatsink_c() == Approx(PlantModel::AMBIENT_C));
+                REQUIRE(model.lid_c() == Approx(PlantModel::AMBIENT_C));
+                REQUIRE(model.elapsed_s() == Approx(60));
+            }
+        }
+    }
+
+    GIVEN("all peltiers heating at full power") {
+        for (size_t zone = 0; zone < PlantModel::ZONES; ++zone) {
+            model.set_peltier(zone, 1.0);
+        }
+        WHEN("stepping for ten seconds") {
+            model.step(10);
+            THEN("the block ramps at a few degrees a second") {
+                REQUIRE(model.zone_c(PELTIER_CENTER) > 40);
+                REQUIRE(model.zone_c(PELTIER_CENTER) < 70);
+            }
+            THEN("the heat is pumped out of the heatsink") {
+                REQUIRE(model.heatsink_c() < PlantModel::AMBIENT_C);
+            }
+            THEN("the samples lag the block") {
+                REQUIRE(model.well_c(PELTIER_CENTER) <
+                        model.zone_c(PELTIER_CENTER));
+                REQUIRE(model.well_c(PELTIER_CENTER) >
+                        PlantModel::AMBIENT_C);
+            }
+        }
+    }
+
+    GIVEN("one outside peltier heating") {
+        model.set_peltier(PELTIER_RIGHT, 1.0);
+        WHEN("stepping for a while") {
+            model.step(20);
+            THEN("the heat spreads through the neighbouring zones") {
+                REQUIRE(model.zone_c(PELTIER_RIGHT) >
+                        model.zone_c(PELTIER_CENTER));
+                REQUIRE(model.zone_c(PELTIER_CENTER) >
+                        model.zone_c(PELTIER_LEFT));
+                REQUIRE(model.zone_c(PELTIER_LEFT) > PlantModel::AMBIENT_C);
+            }
+        }
+    }
+
+    GIVEN("all peltiers cooling at full power") {
+        for (size_t zone = 0; zone < PlantModel::ZONES; ++zone) {
+            model.set_peltier(zone, -1.0);
+        }
+        auto fanned = model;
+        fanned.set_fan(1.0);
+        WHEN("stepping for a minute") {
+            model.step(60);
+            fanned.step(60);
+            THEN("the block cools and the heatsink warms") {
+                REQUIRE(model.zone_c(PELTIER_CENTER) < PlantModel::AMBIENT_C);
+                REQUIRE(model.heatsink_c() > PlantModel::AMBIENT_C);
+            }
+            THEN("the fans keep the heatsink cooler, and so the block") {
+                REQUIRE(fanned.heatsink_c() < model.heatsink_c());
+                REQUIRE(fanned.zone_c(PELTIER_CENTER) <
+                        model.zone_c(PELTIER_CENTER));
+            }
+        }
+    }
+
+    GIVEN("the lid heater on") {
+        model.set_lid_heater(1.0);
+        WHEN("stepping for a minute") {
+            model.step(60);
+            THEN("the lid heats and warms the samples a little") {
+                REQUIRE(model.lid_c() > 40);
+                REQUIRE(model.well_c(PELTIER_CENTER) >
+                        PlantModel::AMBIENT_C);
+                REQUIRE(model.well_c(PELTIER_CENTER) <
+                        PlantModel::AMBIENT_C + 1);
+            }
+        }
+    }
+
+    GIVEN("two models with the same inputs") {
+        model.set_peltier(PELTIER_LEFT, 0.5);
+        model.set_fan(0.3);
+        auto other = model;
+        WHEN("stepping one in one go and the other in small steps") {
+            model.step(1.0);
+            for (int i = 0; i < 100; ++i) {
+                other.step(PlantModel::MAX_STEP_S);
+            }
+            THEN("they agree") {
+                REQUIRE(model.zone_c(PELTIER_LEFT) ==
+                        Approx(other.zone_c(PELTIER_LEFT)));
+                REQUIRE(model.heatsink_c() == Approx(other.heatsink_c()));
+            }
+        }
+    }
+
+    GIVEN("out of range inputs") {
+        model.set_peltier(PELTIER_LEFT, 3.0);
+        model.set_fan(-1.0);
+        model.set_lid_heater(2.0);
+        THEN("they are clamped") {
+            REQUIRE(model.peltier(PELTIER_LEFT) == 1.0);
+            REQUIRE(model.fan() == 0.0);
+            REQUIRE(model.lid_heater() == 1.0);
+        }
+    }
+}
+
+SCENARIO("thermal plant readings") {
+    auto plant = Plant();
+    GIVEN("a plant at rest") {
+        THEN("every thermistor reads ambient") {
+            auto plate = plant.plate_reading();
+            REQUIRE(to_celsius(plate.heat_sink) ==
+                    Approx(PlantModel::AMBIENT_C).margin(0.1));
+            REQUIRE(to_celsius(plate.front_left) ==
+                    Approx(PlantModel::AMBIENT_C).margin(0.1));
+            REQUIRE(to_celsius(plant.lid_reading().lid_temp) ==
+                    Approx(PlantModel::AMBIENT_C).margin(0.1));
+            REQUIRE(plate.timestamp_us == 0);
+        }
+    }
+    GIVEN("one peltier heating and one cooling") {
+        plant.set_peltier(PELTIER_LEFT, 1.0, PELTIER_HEATING);
+        plant.set_peltier(PELTIER_RIGHT, 1.0, PELTIER_COOLING);
+        WHEN("stepping the plant") {
+            plant.step(5);
+            auto plate = plant.plate_reading();
+            auto model = plant.snapshot();
+            THEN("the readings follow the zones under them") {
+                REQUIRE(model.peltier(PELTIER_RIGHT) == -1.0);
+                REQUIRE(to_celsius(plate.front_left) ==
+                        Approx(model.zone_c(PELTIER_LEFT)).margin(0.1));
+                REQUIRE(plate.back_left == plate.front_left);
+                REQUIRE(to_celsius(plate.front_right) ==
+                        Approx(model.zone_c(PELTIER_RIGHT)).margin(0.1));
+                REQUIRE(to_celsius(plate.front_left) >
+                        to_celsius(plate.front_center));
+                REQUIRE(to_celsius(plate.front_center) >
+                        to_celsius(plate.front_right));
+            }
+            THEN("the timestamp is the time stepped") {
+                REQUIRE(plate.timestamp_us == 5000000);
+            }
+        }
+    }
+}
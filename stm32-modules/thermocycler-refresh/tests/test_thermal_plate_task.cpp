@@ -2,10 +2,13 @@
 #include <list>
 
 #include "catch2/catch.hpp"
+#include "core/thermistor_conversion.hpp"
 #include "systemwide.h"
 #include "test/task_builder.hpp"
+#include "thermistor_lookups.hpp"
 #include "thermocycler-refresh/errors.hpp"
 #include "thermocycler-refresh/messages.hpp"
+#include "thermocycler-refresh/power_budget.hpp"
 #include "thermocycler-refresh/thermal_plate_task.hpp"
 
 constexpr int _valid_adc = 6360;  // Gives 50C
@@ -288,6 +291,51 @@ SCENARIO("thermal plate task message passing") {
                 }
             }
         }
+        WHEN("sending a SetPlateAcquisition message") {
+            auto message = messages::SetPlateAcquisitionMessage{
+                .id = 321,
+                .data_rate_sps = 475,
+                .oversample = 2,
+                .filter = AdcFilter::Mode::IIR,
+                .filter_alpha = 0.25};
+            tasks->get_thermal_plate_queue().backing_deque.push_back(
+                messages::ThermalPlateMessage(message));
+            tasks->run_thermal_plate_task();
+            THEN("the settings are passed to the hardware") {
+                auto& policy = tasks->get_thermal_plate_policy();
+                REQUIRE(policy._data_rate_sps == 475);
+                REQUIRE(policy._oversample == 2);
+                REQUIRE(policy._filter == AdcFilter::Mode::IIR);
+                REQUIRE(policy._filter_alpha == 0.25);
+            }
+            THEN("the message is acked") {
+                REQUIRE(!tasks->get_host_comms_queue().backing_deque.empty());
+                auto response = std::get<messages::AcknowledgePrevious>(
+                    tasks->get_host_comms_queue().backing_deque.front());
+                REQUIRE(response.responding_to_id == 321);
+                REQUIRE(response.with_error == errors::ErrorCode::NO_ERROR);
+            }
+        }
+        WHEN("sending a SetPlateAcquisition message the hardware refuses") {
+            tasks->get_thermal_plate_policy()._acquisition_ok = false;
+            auto message = messages::SetPlateAcquisitionMessage{
+                .id = 322,
+                .data_rate_sps = 8,
+                .oversample = 16,
+                .filter = AdcFilter::Mode::NONE,
+                .filter_alpha = 0.5};
+            tasks->get_thermal_plate_queue().backing_deque.push_back(
+                messages::ThermalPlateMessage(message));
+            tasks->run_thermal_plate_task();
+            THEN("the message is acked with an error") {
+                REQUIRE(!tasks->get_host_comms_queue().backing_deque.empty());
+                auto response = std::get<messages::AcknowledgePrevious>(
+                    tasks->get_host_comms_queue().backing_deque.front());
+                REQUIRE(response.responding_to_id == 322);
+                REQUIRE(response.with_error ==
+                        errors::ErrorCode::THERMAL_PLATE_ACQUISITION_INVALID);
+            }
+        }
         WHEN("Sending a SetPlateTemperature message to enable the plate") {
             auto message = messages::SetPlateTemperatureMessage{
                 .id = 123, .setpoint = 90.0F, .hold_time = 10.0F};
@@ -421,6 +469,88 @@ SCENARIO("thermal plate task message passing") {
                 }
             }
         }
+        WHEN("sending a StartAutotune message above the plate temperature") {
+            auto message = messages::StartAutotuneMessage{
+                .id = 900, .selection = PidSelection::PELTIERS, .setpoint = 60};
+            tasks->get_thermal_plate_queue().backing_deque.push_back(
+                messages::ThermalPlateMessage(message));
+            tasks->run_thermal_plate_task();
+            THEN("the task should hold its response until the tune is over") {
+                REQUIRE(tasks->get_thermal_plate_queue().backing_deque.empty());
+                REQUIRE(tasks->get_host_comms_queue().backing_deque.empty());
+            }
+            AND_WHEN("sending updated temperatures") {
+                tasks->get_thermal_plate_queue().backing_deque.push_back(
+                    messages::ThermalPlateMessage(read_message));
+                tasks->run_thermal_plate_task();
+                THEN("all peltiers should heat at full power") {
+                    auto& policy = tasks->get_thermal_plate_policy();
+                    REQUIRE(policy._enabled);
+                    for (auto id : {PeltierID::PELTIER_LEFT,
+                                    PeltierID::PELTIER_CENTER,
+                                    PeltierID::PELTIER_RIGHT}) {
+                        auto peltier = policy.get_peltier(id);
+                        REQUIRE(peltier.first ==
+                                PeltierDirection::PELTIER_HEATING);
+                        REQUIRE(peltier.second == 1.0);
+                    }
+                }
+            }
+            AND_WHEN("sending a SetPlateTemperature message") {
+                tasks->get_thermal_plate_queue().backing_deque.push_back(
+                    messages::SetPlateTemperatureMessage{
+                        .id = 901, .setpoint = 70, .hold_time = 0});
+                tasks->run_thermal_plate_task();
+                THEN("the task should respond with a busy error") {
+                    auto response = std::get<messages::AcknowledgePrevious>(
+                        tasks->get_host_comms_queue().backing_deque.front());
+                    REQUIRE(response.responding_to_id == 901);
+                    REQUIRE(response.with_error ==
+                            errors::ErrorCode::THERMAL_PLATE_BUSY);
+                }
+            }
+            AND_WHEN("sending a second StartAutotune message") {
+                message.id = 902;
+                tasks->get_thermal_plate_queue().backing_deque.push_back(
+                    messages::ThermalPlateMessage(message));
+                tasks->run_thermal_plate_task();
+                THEN("the second tune is rejected as busy") {
+                    auto response = std::get<messages::AutotuneResultResponse>(
+                        tasks->get_host_comms_queue().backing_deque.front());
+                    REQUIRE(response.responding_to_id == 902);
+                    REQUIRE(response.with_error ==
+                            errors::ErrorCode::THERMAL_PLATE_BUSY);
+                }
+            }
+            AND_WHEN("sending a DeactivatePlate message") {
+                tasks->get_thermal_plate_queue().backing_deque.push_back(
+                    messages::DeactivatePlateMessage{.id = 903});
+                tasks->run_thermal_plate_task();
+                THEN("the tune is cancelled and the plate is disabled") {
+                    auto& comms = tasks->get_host_comms_queue().backing_deque;
+                    REQUIRE(comms.size() == 2);
+                    auto tune_response =
+                        std::get<messages::AutotuneResultResponse>(
+                            comms.front());
+                    REQUIRE(tune_response.responding_to_id == 900);
+                    REQUIRE(tune_response.with_error ==
+                            errors::ErrorCode::THERMAL_AUTOTUNE_FAILED);
+                    REQUIRE(!tasks->get_thermal_plate_policy()._enabled);
+                }
+                AND_WHEN("sending a GetPlateTemp query") {
+                    tasks->get_host_comms_queue().backing_deque.clear();
+                    tasks->get_thermal_plate_queue().backing_deque.push_back(
+                        messages::GetPlateTempMessage{.id = 904});
+                    tasks->run_thermal_plate_task();
+                    THEN("the tune's setpoint is gone") {
+                        REQUIRE(std::get<messages::GetPlateTempResponse>(
+                                    tasks->get_host_comms_queue()
+                                        .backing_deque.front())
+                                    .set_temp == 0);
+                    }
+                }
+            }
+        }
     }
     GIVEN("a thermal plate task with shorted thermistors") {
         auto tasks = TaskBuilder::build();
@@ -618,3 +748,438 @@ SCENARIO("thermal plate task message passing") {
         CHECK(tasks->get_host_comms_queue().backing_deque.empty());
     }
 }
+
+SCENARIO("thermal plate and lid heater share the power budget") {
+    GIVEN("a lid heater and thermal plate well below their targets") {
+        auto tasks = TaskBuilder::build();
+        auto plate_read =
+            messages::ThermalPlateTempReadComplete{.heat_sink = _valid_adc,
+                                                   .front_right = _valid_adc,
+                                                   .front_center = _valid_adc,
+                                                   .front_left = _valid_adc,
+                                                   .back_right = _valid_adc,
+                                                   .back_center = _valid_adc,
+                                                   .back_left = _valid_adc};
+        auto lid_read = messages::LidTempReadComplete{.lid_temp = _valid_adc};
+        auto& budget = tasks->get_tasks_aggregator().power_budget;
+        tasks->get_thermal_plate_queue().backing_deque.push_back(plate_read);
+        tasks->run_thermal_plate_task();
+        tasks->get_lid_heater_queue().backing_deque.push_back(lid_read);
+        tasks->run_lid_heater_task();
+        tasks->get_thermal_plate_queue().backing_deque.push_back(
+            messages::SetPlateTemperatureMessage{
+                .id = 1, .setpoint = 100, .hold_time = 0});
+        tasks->run_thermal_plate_task();
+        WHEN("only the plate is running") {
+            tasks->get_thermal_plate_queue().backing_deque.push_back(
+                plate_read);
+            tasks->run_thermal_plate_task();
+            THEN("the plate gets full power and publishes its demand") {
+                auto left = tasks->get_thermal_plate_policy().get_peltier(
+                    PeltierID::PELTIER_LEFT);
+                REQUIRE(left.second == 1.0);
+                REQUIRE(budget.demand(power::THERMAL_PLATE) ==
+                        Approx(1.0).epsilon(0.001));
+            }
+        }
+        WHEN("the lid heater is also ramping") {
+            tasks->get_lid_heater_queue().backing_deque.push_back(
+                messages::SetLidTemperatureMessage{.id = 2, .setpoint = 105});
+            tasks->run_lid_heater_task();
+            tasks->get_lid_heater_queue().backing_deque.push_back(lid_read);
+            tasks->run_lid_heater_task();
+            tasks->get_thermal_plate_queue().backing_deque.push_back(
+                plate_read);
+            tasks->run_thermal_plate_task();
+            THEN("the default budget does not hold the plate back") {
+                REQUIRE(tasks->get_lid_heater_policy().get_heater_power() ==
+                        1.0);
+                for (auto id : {PeltierID::PELTIER_LEFT,
+                                PeltierID::PELTIER_CENTER,
+                                PeltierID::PELTIER_RIGHT}) {
+                    auto peltier =
+                        tasks->get_thermal_plate_policy().get_peltier(id);
+                    REQUIRE(peltier.second == 1.0);
+                }
+            }
+        }
+        WHEN("the supply is limited and the lid heater is also ramping") {
+            const double supply_watts = 200.0;
+            tasks->get_host_comms_queue().backing_deque.clear();
+            tasks->get_thermal_plate_queue().backing_deque.push_back(
+                messages::SetPowerSupplyMessage{.id = 4,
+                                                .watts = supply_watts});
+            tasks->run_thermal_plate_task();
+            auto ack = std::get<messages::AcknowledgePrevious>(
+                tasks->get_host_comms_queue().backing_deque.front());
+            tasks->get_host_comms_queue().backing_deque.pop_front();
+            tasks->get_lid_heater_queue().backing_deque.push_back(
+                messages::SetLidTemperatureMessage{.id = 2, .setpoint = 105});
+            tasks->run_lid_heater_task();
+            tasks->get_lid_heater_queue().backing_deque.push_back(lid_read);
+            tasks->run_lid_heater_task();
+            tasks->get_thermal_plate_queue().backing_deque.push_back(
+                plate_read);
+            tasks->run_thermal_plate_task();
+            THEN("the supply figure is acknowledged") {
+                REQUIRE(ack.responding_to_id == 4);
+                REQUIRE(ack.with_error == errors::ErrorCode::NO_ERROR);
+            }
+            THEN("the lid is served first") {
+                REQUIRE(tasks->get_lid_heater_policy().get_heater_power() ==
+                        1.0);
+                REQUIRE(budget.demand(power::LID_HEATER) ==
+                        Approx(1.0).epsilon(0.001));
+            }
+            THEN("the plate is held to what is left of the supply") {
+                const double ceiling =
+                    (supply_watts - power::LID_HEATER_MAX_WATTS) /
+                    power::THERMAL_PLATE_MAX_WATTS;
+                for (auto id : {PeltierID::PELTIER_LEFT,
+                                PeltierID::PELTIER_CENTER,
+                                PeltierID::PELTIER_RIGHT}) {
+                    auto peltier =
+                        tasks->get_thermal_plate_policy().get_peltier(id);
+                    REQUIRE(peltier.second == Approx(ceiling).epsilon(0.001));
+                }
+            }
+            AND_WHEN("the lid heater is deactivated") {
+                tasks->get_lid_heater_queue().backing_deque.push_back(
+                    messages::DeactivateLidHeatingMessage{.id = 3});
+                tasks->run_lid_heater_task();
+                tasks->get_thermal_plate_queue().backing_deque.push_back(
+                    plate_read);
+                tasks->run_thermal_plate_task();
+                THEN("the plate gets full power again") {
+                    REQUIRE(budget.demand(power::LID_HEATER) == 0.0);
+                    auto left = tasks->get_thermal_plate_policy().get_peltier(
+                        PeltierID::PELTIER_LEFT);
+                    REQUIRE(left.second == 1.0);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("thermal plate fault detection") {
+    using PlateTask = thermal_plate_task::ThermalPlateTask<TestMessageQueue>;
+    auto converter = thermistor_conversion::Conversion<lookups::KS103J2G>(
+        PlateTask::THERMISTOR_CIRCUIT_BIAS_RESISTANCE_KOHM,
+        PlateTask::ADC_BIT_MAX, false);
+    const int window_periods = static_cast<int>(
+        PlateTask::FAULT_LIMITS.window_s / PlateTask::CONTROL_PERIOD_SECONDS);
+    GIVEN("a thermal plate task") {
+        auto tasks = TaskBuilder::build();
+        auto& queue = tasks->get_thermal_plate_queue().backing_deque;
+        auto& comms = tasks->get_host_comms_queue().backing_deque;
+        auto send_temps = [&](double front_left, double rest) {
+            auto adc = converter.backconvert(rest);
+            queue.push_back(messages::ThermalPlateTempReadComplete{
+                .heat_sink = converter.backconvert(30.0),
+                .front_right = adc,
+                .front_center = adc,
+                .front_left = converter.backconvert(front_left),
+                .back_right = adc,
+                .back_center = adc,
+                .back_left = adc});
+            tasks->run_thermal_plate_task();
+        };
+        send_temps(30.0, 30.0);
+        WHEN("one thermistor reads far from its partner") {
+            send_temps(30.0 + PlateTask::THERMISTOR_PAIR_MISMATCH_C + 5.0,
+                       30.0);
+            THEN("a mismatch error is sent") {
+                REQUIRE(!comms.empty());
+                auto error = std::get<messages::ErrorMessage>(comms.front());
+                REQUIRE(error.code ==
+                        errors::ErrorCode::THERMISTOR_PLATE_PAIR_MISMATCH);
+            }
+            AND_WHEN("setting a temperature") {
+                comms.clear();
+                queue.push_back(messages::SetPlateTemperatureMessage{
+                    .id = 1, .setpoint = 90, .hold_time = 0});
+                tasks->run_thermal_plate_task();
+                THEN("the plate refuses with the mismatch error") {
+                    auto ack =
+                        std::get<messages::AcknowledgePrevious>(comms.front());
+                    REQUIRE(ack.with_error ==
+                            errors::ErrorCode::THERMISTOR_PLATE_PAIR_MISMATCH);
+                }
+            }
+            AND_WHEN("the thermistors agree again") {
+                send_temps(30.0, 30.0);
+                comms.clear();
+                queue.push_back(messages::SetPlateTemperatureMessage{
+                    .id = 2, .setpoint = 90, .hold_time = 0});
+                tasks->run_thermal_plate_task();
+                THEN("the error clears") {
+                    auto ack =
+                        std::get<messages::AcknowledgePrevious>(comms.front());
+                    REQUIRE(ack.with_error == errors::ErrorCode::NO_ERROR);
+                }
+            }
+        }
+        WHEN("the plate doesn't move while the peltiers heat it") {
+            queue.push_back(messages::SetPlateTemperatureMessage{
+                .id = 3, .setpoint = 90, .hold_time = 0});
+            tasks->run_thermal_plate_task();
+            comms.clear();
+            // One period to start driving, then a full window without change
+            for (int i = 0; i < window_periods + 2; ++i) {
+                send_temps(30.0, 30.0);
+            }
+            THEN("the peltiers are shut off and an error is sent") {
+                REQUIRE(!tasks->get_thermal_plate_policy()._enabled);
+                REQUIRE(!comms.empty());
+                auto error = std::get<messages::ErrorMessage>(comms.front());
+                REQUIRE(error.code ==
+                        errors::ErrorCode::THERMAL_PLATE_NO_RESPONSE);
+            }
+        }
+        WHEN("the plate follows the peltiers") {
+            queue.push_back(messages::SetPlateTemperatureMessage{
+                .id = 4, .setpoint = 90, .hold_time = 0});
+            tasks->run_thermal_plate_task();
+            comms.clear();
+            double temp = 30.0;
+            for (int i = 0; i < 2 * window_periods; ++i) {
+                temp += 0.5 * PlateTask::CONTROL_PERIOD_SECONDS;
+                send_temps(temp, temp);
+            }
+            THEN("no fault is raised") {
+                REQUIRE(comms.empty());
+                REQUIRE(tasks->get_thermal_plate_policy()._enabled);
+            }
+        }
+    }
+}
+
+SCENARIO("thermal plate sample timing") {
+    GIVEN("a thermal plate task receiving timestamped thermistor scans") {
+        using PlateTask =
+            thermal_plate_task::ThermalPlateTask<TestMessageQueue>;
+        constexpr uint32_t period = PlateTask::CONTROL_PERIOD_US;
+        constexpr std::array<int32_t, 5> lateness_us{0, 300, -200, 1200, 0};
+        auto tasks = TaskBuilder::build();
+        auto read_message =
+            messages::ThermalPlateTempReadComplete{.heat_sink = _valid_adc,
+                                                   .front_right = _valid_adc,
+                                                   .front_center = _valid_adc,
+                                                   .front_left = _valid_adc,
+                                                   .back_right = _valid_adc,
+                                                   .back_center = _valid_adc,
+                                                   .back_left = _valid_adc};
+        uint32_t acquisition = 9000;
+        for (size_t i = 0; i < lateness_us.size(); ++i) {
+            read_message.timestamp_us =
+                static_cast<uint32_t>(i * period + lateness_us.at(i));
+            read_message.acquisition_us = acquisition;
+            acquisition += 500;
+            tasks->get_thermal_plate_queue().backing_deque.push_back(
+                messages::ThermalPlateMessage(read_message));
+            tasks->run_thermal_plate_task();
+        }
+        WHEN("asking for the sample timing") {
+            auto message = messages::GetPlateSampleTimingMessage{.id = 55};
+            tasks->get_thermal_plate_queue().backing_deque.push_back(
+                messages::ThermalPlateMessage(message));
+            tasks->run_thermal_plate_task();
+            THEN("the task reports the intervals between scans") {
+                auto& comms = tasks->get_host_comms_queue().backing_deque;
+                REQUIRE(!comms.empty());
+                REQUIRE(std::holds_alternative<
+                        messages::GetPlateSampleTimingResponse>(comms.front()));
+                auto response =
+                    std::get<messages::GetPlateSampleTimingResponse>(
+                        comms.front());
+                comms.pop_front();
+                REQUIRE(response.responding_to_id == message.id);
+                REQUIRE(response.count == lateness_us.size() - 1);
+                REQUIRE_THAT(response.period_ms,
+                             Catch::Matchers::WithinAbs(50.0, 0.001));
+                // Worst interval is the one from -200us to +1200us
+                REQUIRE_THAT(response.jitter_ms,
+                             Catch::Matchers::WithinAbs(1.4, 0.001));
+                REQUIRE(response.stddev_ms > 0);
+                REQUIRE_THAT(response.acquisition_ms,
+                             Catch::Matchers::WithinAbs(11.0, 0.001));
+                AND_WHEN("asking again without any new scans") {
+                    tasks->get_thermal_plate_queue().backing_deque.push_back(
+                        messages::ThermalPlateMessage(message));
+                    tasks->run_thermal_plate_task();
+                    THEN("the statistics have been cleared") {
+                        REQUIRE(!comms.empty());
+                        auto again =
+                            std::get<messages::GetPlateSampleTimingResponse>(
+                                comms.front());
+                        REQUIRE(again.count == 0);
+                        REQUIRE(again.acquisition_ms == 0);
+                    }
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("thermal plate thermistor noise") {
+    GIVEN("a thermal plate task where one thermistor reads noisily") {
+        using PlateTask =
+            thermal_plate_task::ThermalPlateTask<TestMessageQueue>;
+        constexpr size_t readings = PlateTask::NOISE_WINDOW + 10;
+        auto tasks = TaskBuilder::build();
+        auto read_message =
+            messages::ThermalPlateTempReadComplete{.heat_sink = _valid_adc,
+                                                   .front_right = _valid_adc,
+                                                   .front_center = _valid_adc,
+                                                   .front_left = _valid_adc,
+                                                   .back_right = _valid_adc,
+                                                   .back_center = _valid_adc,
+                                                   .back_left = _valid_adc};
+        for (size_t i = 0; i < readings; ++i) {
+            read_message.front_right =
+                (i % 2 == 0) ? _valid_adc : _valid_adc + 20;
+            tasks->get_thermal_plate_queue().backing_deque.push_back(
+                messages::ThermalPlateMessage(read_message));
+            tasks->run_thermal_plate_task();
+        }
+        WHEN("asking for the thermistor noise") {
+            auto message = messages::GetPlateThermistorNoiseMessage{.id = 12};
+            tasks->get_thermal_plate_queue().backing_deque.push_back(
+                messages::ThermalPlateMessage(message));
+            tasks->run_thermal_plate_task();
+            THEN("only the noisy thermistor reports any noise") {
+                auto& comms = tasks->get_host_comms_queue().backing_deque;
+                REQUIRE(!comms.empty());
+                REQUIRE(std::holds_alternative<
+                        messages::GetPlateThermistorNoiseResponse>(
+                    comms.front()));
+                auto response =
+                    std::get<messages::GetPlateThermistorNoiseResponse>(
+                        comms.front());
+                REQUIRE(response.responding_to_id == message.id);
+                REQUIRE(response.count == PlateTask::NOISE_WINDOW);
+                REQUIRE(response.front_right > 0);
+                REQUIRE(response.front_right < 1.0);
+                REQUIRE_THAT(response.heat_sink,
+                             Catch::Matchers::WithinAbs(0, 1e-9));
+                REQUIRE_THAT(response.front_left,
+                             Catch::Matchers::WithinAbs(0, 1e-9));
+                REQUIRE_THAT(response.front_center,
+                             Catch::Matchers::WithinAbs(0, 1e-9));
+                REQUIRE_THAT(response.back_right,
+                             Catch::Matchers::WithinAbs(0, 1e-9));
+                REQUIRE_THAT(response.back_left,
+                             Catch::Matchers::WithinAbs(0, 1e-9));
+                REQUIRE_THAT(response.back_center,
+                             Catch::Matchers::WithinAbs(0, 1e-9));
+            }
+        }
+    }
+}
+
+SCENARIO("thermal plate thermistor statistics") {
+    GIVEN("a thermal plate task that has read a window of temperatures") {
+        constexpr size_t window = THERMISTOR_STATS_WINDOW;
+        auto tasks = TaskBuilder::build();
+        auto read_message =
+            messages::ThermalPlateTempReadComplete{.heat_sink = _valid_adc,
+                                                   .front_right = _valid_adc,
+                                                   .front_center = _valid_adc,
+                                                   .front_left = _valid_adc,
+                                                   .back_right = _valid_adc,
+                                                   .back_center = _valid_adc,
+                                                   .back_left = _valid_adc};
+        auto read = [&](size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                tasks->get_thermal_plate_queue().backing_deque.push_back(
+                    messages::ThermalPlateMessage(read_message));
+                tasks->run_thermal_plate_task();
+            }
+            tasks->get_host_comms_queue().backing_deque.clear();
+        };
+        auto get_stats = [&](uint8_t thermistor,
+                             uint32_t last = THERMISTOR_STATS_WINDOW) {
+            auto message = messages::GetThermistorStatsMessage{
+                .id = 44, .thermistor = thermistor, .window = last};
+            tasks->get_thermal_plate_queue().backing_deque.push_back(
+                messages::ThermalPlateMessage(message));
+            tasks->run_thermal_plate_task();
+            auto& comms = tasks->get_host_comms_queue().backing_deque;
+            REQUIRE(!comms.empty());
+            REQUIRE(
+                std::holds_alternative<messages::GetThermistorStatsResponse>(
+                    comms.front()));
+            auto response =
+                std::get<messages::GetThermistorStatsResponse>(comms.front());
+            comms.pop_front();
+            REQUIRE(response.responding_to_id == message.id);
+            REQUIRE(response.thermistor == thermistor);
+            return response;
+        };
+        read(window);
+        WHEN("asking for the statistics of a steady thermistor") {
+            auto stats = get_stats(THERM_BACK_RIGHT);
+            THEN("they show a full window at one temperature") {
+                REQUIRE(stats.count == window);
+                REQUIRE(stats.total == window);
+                REQUIRE(stats.invalid == 0);
+                REQUIRE(stats.total_invalid == 0);
+                REQUIRE_THAT(stats.mean,
+                             Catch::Matchers::WithinAbs(_valid_temp, 0.1));
+                REQUIRE_THAT(stats.min,
+                             Catch::Matchers::WithinAbs(stats.max, 1e-9));
+                REQUIRE_THAT(stats.variance,
+                             Catch::Matchers::WithinAbs(0, 1e-9));
+                REQUIRE_THAT(stats.drift, Catch::Matchers::WithinAbs(0, 1e-9));
+            }
+        }
+        WHEN("one thermistor disconnects for a few readings") {
+            read_message.back_left = _disconnected_adc;
+            read(3);
+            read_message.back_left = _valid_adc;
+            auto stats = get_stats(THERM_BACK_LEFT);
+            THEN("the invalid conversions are counted but not averaged") {
+                REQUIRE(stats.count == window);
+                REQUIRE(stats.invalid == 3);
+                REQUIRE(stats.total == window + 3);
+                REQUIRE(stats.total_invalid == 3);
+                REQUIRE_THAT(stats.min,
+                             Catch::Matchers::WithinAbs(_valid_temp, 0.1));
+            }
+            AND_WHEN("it reads properly for another window") {
+                read(window);
+                auto recovered = get_stats(THERM_BACK_LEFT);
+                THEN("only the total remembers the invalid conversions") {
+                    REQUIRE(recovered.invalid == 0);
+                    REQUIRE(recovered.total_invalid == 3);
+                }
+            }
+        }
+        WHEN("one thermistor jumps for the last few readings") {
+            read_message.front_center = _valid_adc - 200;
+            read(4);
+            auto recent = get_stats(THERM_FRONT_CENTER, 4);
+            auto full = get_stats(THERM_FRONT_CENTER);
+            THEN("a short window covers only the jump") {
+                REQUIRE(recent.count == 4);
+                REQUIRE(recent.mean > _valid_temp + 0.1);
+                REQUIRE_THAT(recent.variance,
+                             Catch::Matchers::WithinAbs(0, 1e-9));
+                REQUIRE(full.count == window);
+                REQUIRE(full.min < recent.min);
+                REQUIRE(full.mean < recent.mean);
+            }
+        }
+        WHEN("one thermistor warms up") {
+            read_message.front_left = _valid_adc - 200;
+            read(window);
+            auto warm = get_stats(THERM_FRONT_LEFT);
+            auto steady = get_stats(THERM_FRONT_RIGHT);
+            THEN("only that thermistor drifts") {
+                REQUIRE(warm.drift > 0.1);
+                REQUIRE_THAT(steady.drift,
+                             Catch::Matchers::WithinAbs(0, 1e-9));
+            }
+        }
+    }
+}